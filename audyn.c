@@ -12,6 +12,7 @@
  *      - Supports WAV and Opus output formats
  *      - Implements Rotter-compatible file chunking and naming (archive policy)
  *      - Creates core resources and runs capture until SIGINT/SIGTERM
+ *      - Applies runtime changes from the stdin control channel (--control)
  *
  *  Input Sources:
  *      - AES67: Multicast/unicast RTP audio (default)
@@ -24,6 +25,7 @@
  *  Archive Modes:
  *      - Single file: -o /path/to/file.wav (no rotation)
  *      - Archive: --archive-root /path --archive-layout flat (with rotation)
+ *      - Multi-stream: --streams <file> (many AES67 flows, one process)
  *
  *  Copyright:
  *      (c) 2026 B. Wynne
@@ -35,6 +37,8 @@
  *      GPLv2 or later
  */
 
+#include <ctype.h>
+#include <stdarg.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -43,6 +47,7 @@
 #include <signal.h>
 #include <unistd.h>
 #include <pthread.h>
+#include <stdatomic.h>
 #include <time.h>
 
 #include "log.h"
@@ -50,18 +55,34 @@
 #include "audio_queue.h"
 #include "wav_sink.h"
 #include "opus_sink.h"
+#include "seek_index.h"
+#include "file_writer.h"
+#include "encoder_pool.h"
+#include "sink_helper.h"
+#include "pcm_convert.h"
 #include "aes_input.h"
+#include "aes_mux.h"
 #include "pipewire_input.h"
 #include "ptp_clock.h"
 #include "archive_policy.h"
 #include "level_meter.h"
+#include "level_shm.h"
+#include "pcm_tap.h"
+#include "loudness.h"
 #include "vox.h"
+#include "rt.h"
+#include "metrics.h"
+#include "control.h"
 
 /* -------- Limits -------- */
 
 /* Sample rate limits (must match worker.h) */
 #define AUDYN_MAX_SAMPLE_RATE 384000
 
+/* Channel limits (level meter, WAV and the inputs take 32; Opus and VOX 2) */
+#define AUDYN_MAX_CHANNELS 32
+#define AUDYN_OPUS_MAX_CHANNELS 2
+
 /* Opus bitrate limits (must match opus_sink.c) */
 #define AUDYN_CLI_BITRATE_MIN 6000
 #define AUDYN_CLI_BITRATE_MAX 510000
@@ -70,6 +91,17 @@
 #define AUDYN_LEVELS_INTERVAL_MIN 10
 #define AUDYN_LEVELS_INTERVAL_MAX 5000
 
+/* Durable-mode sync interval limits (ms) */
+#define AUDYN_SYNC_MS_MIN 10
+#define AUDYN_SYNC_MS_MAX 60000
+
+/* Seek index spacing limits (ms) */
+#define AUDYN_SEEK_MS_MIN 100
+#define AUDYN_SEEK_MS_MAX 60000
+
+/* --encoder-threads default: one per CPU, at most one per Opus stream */
+#define AUDYN_ENC_THREADS_AUTO (-1)
+
 /* VOX limits */
 #define AUDYN_VOX_THRESHOLD_MIN -60.0f
 #define AUDYN_VOX_THRESHOLD_MAX -5.0f
@@ -122,12 +154,19 @@ static void usage(const char *argv0)
         "audyn — AES67 Audio Capture & Archival Engine\n\n"
         "Usage:\n"
         "  %s -o <file> [options]           Single file mode\n"
-        "  %s --archive-root <dir> [options] Archive mode with rotation\n\n"
+        "  %s --archive-root <dir> [options] Archive mode with rotation\n"
+        "  %s --streams <file> [options]     Multi-stream archive mode\n\n"
         "Output (choose one):\n"
         "  -o <path>              Output file path (single file, no rotation)\n"
         "                         Format detected from extension: .wav or .opus\n"
         "  --archive-root <dir>   Root directory for archive files\n"
-        "                         Enables time-based file rotation\n\n"
+        "                         Enables time-based file rotation\n"
+        "  --tee <target>         Also write the same audio to another output\n"
+        "                         (repeatable, up to 3). With -o: a file path;\n"
+        "                         with --archive-root/--streams: <suffix>[:<root>],\n"
+        "                         rotated with the primary at the same boundaries\n"
+        "                         (root defaults to the primary's; per stream\n"
+        "                         <root>/<name>)\n\n"
         "Archive Options (with --archive-root):\n"
         "  --archive-layout <L>   Naming layout (default: flat)\n"
         "                         Layouts: flat, hierarchy, combo, dailydir, accurate, custom\n"
@@ -143,38 +182,125 @@ static void usage(const char *argv0)
         "    dailydir:  /root/2026-01-10/2026-01-10-14.opus\n"
         "    accurate:  /root/2026-01-10/2026-01-10-14-30-00-00.opus\n"
         "    custom:    User-defined strftime format\n\n"
+        "Multi-Stream Mode:\n"
+        "  --streams <file>       Record every AES67 stream listed in <file>\n"
+        "                         One line per stream of key=value pairs:\n"
+        "                           name= ip= port= pt= spp= rate= channels=\n"
+        "                           stream_channels= offset= ssrc= jitter_ms=\n"
+        "                           root= suffix=\n"
+        "                         Unset keys use the command-line values; root\n"
+        "                         defaults to <archive-root>/<name>\n"
+        "  --rx-threads <n>       Shared receive threads (default 2, max 16)\n"
+        "                         Archive layout/period/clock options apply to\n"
+        "                         all streams; -o, --pipewire, --levels,\n"
+        "                         --tap-shm and --vox are not available in\n"
+        "                         this mode\n\n"
         "Input Source (default: AES67):\n"
         "  --pipewire             Use PipeWire input instead of AES67\n\n"
+        "PipeWire Options:\n"
+        "  --pw-format <fmt>      Sample format to request: f32 (default), s32,\n"
+        "                         s24_32, s24 or s16; converted to float here\n"
+        "  --pw-quantum <frames>  Frames per PipeWire cycle (16-8192); pool frames\n"
+        "                         are sized to match unless -F is given\n\n"
         "AES67 Options:\n"
         "  -m <ip>                Multicast/source IP address (required for AES67)\n"
         "  -p <port>              UDP port (default 5004)\n"
         "  --interface <if>       Network interface for multicast (e.g., eth0)\n"
         "  --pt <type>            RTP payload type (default 96)\n"
         "  --spp <frames>         Samples per packet (default 48)\n"
-        "  --rcvbuf <bytes>       Socket receive buffer size (default 2097152)\n\n"
+        "  --rcvbuf <bytes>       Socket receive buffer size (default 2097152)\n"
+        "  --rx-batch <n>         Packets drained per recvmmsg() call, 1-64\n"
+        "                         (default: one recvmsg() per packet; 32 for\n"
+        "                         the --streams receive threads)\n"
+        "  --jitter-ms <ms>       Jitter buffer depth 1-200 ms: reorder packets and\n"
+        "                         conceal losses with silence (default 0 = off)\n"
+        "  --redundant <ip>[:<port>]\n"
+        "                         ST 2022-7: also receive the stream on this\n"
+        "                         group (port defaults to -p) and merge the two\n"
+        "                         legs; --jitter-ms defaults to 10 as the window\n"
+        "  --interface-b <if>     Interface for the second leg (default: --interface)\n"
+        "  --leg-threads          Receive each leg on its own thread\n\n"
         "PTP Clock Options (AES67 only):\n"
         "  --ptp-device <path>    Use hardware PTP clock (e.g., /dev/ptp0)\n"
         "  --ptp-interface <if>   Discover PHC from network interface (e.g., eth0)\n"
-        "  --ptp-software         Use software PTP (CLOCK_REALTIME via linuxptp)\n\n"
+        "  --ptp-software         Use software PTP (CLOCK_REALTIME via linuxptp)\n"
+        "  --ptp-cache-ms <n>     Hardware PTP: read the PHC at most every n ms,\n"
+        "                         extrapolating in between (default: every read)\n\n"
         "Audio Parameters:\n"
         "  -r <rate>              Sample rate 1-384000 Hz (default 48000)\n"
-        "  -c <channels>          Channels: 1 or 2 (default 2)\n\n"
+        "  -c <channels>          Channels: 1-32 (default 2); Opus and VOX take 1 or 2\n\n"
+        "WAV Options:\n"
+        "  --wav-format <f>       pcm16, pcm24 or float (default pcm16); pcm24\n"
+        "                         stores AES67 L24 samples without conversion\n"
+        "  --wav-container <c>    riff, rf64 or bw64 (default rf64: plain RIFF\n"
+        "                         below 4 GiB, promoted to RF64 beyond)\n\n"
         "Opus Options (when output is .opus):\n"
         "  --bitrate <bps>        Target bitrate 6000-510000 (default 128000)\n"
         "  --vbr                  Enable VBR (default)\n"
         "  --cbr                  Use CBR instead of VBR\n"
-        "  --complexity <n>       Encoder complexity 0-10 (default 5)\n\n"
+        "  --complexity <n>       Encoder complexity 0-10 (default 5)\n"
+        "  --encoder-threads <n>  Shared Opus encoder threads, 1-32, or 0 to encode\n"
+        "                         in the capture worker (default: one per CPU,\n"
+        "                         at most one per Opus stream)\n\n"
         "Buffer Tuning:\n"
         "  -Q <cap>               Queue capacity (default 1024)\n"
         "  -P <cap>               Pool frame count (default 256)\n"
-        "  -F <size>              Frame size in samples (default 1024)\n\n"
+        "  -F <size>              Frame size in samples (default 1024)\n"
+        "  --coalesce-ms <ms>     Gather audio into blocks of this length before\n"
+        "                         metering/VOX/sink writes, 0-1000; e.g. 20\n"
+        "                         (default 0 = one write per packet)\n\n"
+        "Storage:\n"
+        "  --writer <backend>     File I/O: auto, uring, thread, stdio (default auto:\n"
+        "                         io_uring if available, else shared writer threads)\n"
+        "  --direct-io            Use O_DIRECT for archive files (uring/thread)\n"
+        "  --sparse-silence       Store digital silence cheaply: zero WAV pages\n"
+        "                         become filesystem holes (uring/thread), Opus\n"
+        "                         uses DTX and skips encoding silent frames\n"
+        "  --sync-ms <ms>         Durable mode: fdatasync at least every <ms>,\n"
+        "                         10-60000 (default off: page cache only)\n"
+        "  --sync-mb <MiB>        Durable mode: also fdatasync every <MiB> written\n"
+        "  --seek-index <ms>      Write <file>.seek next to every file: one seek\n"
+        "                         point per <ms> of audio, 100-60000 (default off)\n\n"
+        "Real-Time Mode:\n"
+        "  --rt                   Lock memory (mlockall), pre-fault the pools and\n"
+        "                         run receive/worker threads SCHED_FIFO 70/60;\n"
+        "                         logs which guarantees were obtained\n"
+        "  --rt-rx <spec>         Receive threads, spec [fifo|rr|other][:prio][@cpus]\n"
+        "  --rt-worker <spec>     Capture workers (e.g. fifo:60@2-3)\n"
+        "  --rt-encoder <spec>    Opus encoder threads (default: inherited)\n"
+        "  --rt-hugepages         Back pools with huge pages (reserved, else THP)\n"
+        "  --rt-numa <node|auto>  Place pool memory on a NUMA node (auto: the\n"
+        "                         node of --interface's NIC)\n"
+        "  --rt-strict            Exit if a requested guarantee was not obtained\n"
+        "                         (all --rt-* options imply --rt)\n\n"
         "Logging:\n"
         "  -v                     Debug logging\n"
         "  -q                     Errors only\n"
-        "  --syslog               Log to syslog\n\n"
+        "  --syslog               Log to syslog\n"
+        "  --log-async            Write log messages from a background thread\n"
+        "                         (capture threads never block on stderr/syslog)\n\n"
         "Metering:\n"
         "  --levels               Output JSON audio levels to stdout (~30fps)\n"
-        "  --levels-interval <ms> Level output interval (default 33ms)\n\n"
+        "  --levels-shm <name>    Publish levels to /dev/shm/<name> (binary,\n"
+        "                         seqlock; JSON only if --levels is also given)\n"
+        "  --levels-interval <ms> Level output interval (default 33ms)\n"
+        "  --loudness             EBU R128 loudness and true peak of every file,\n"
+        "                         written to <file>.loudness.json when it closes\n"
+        "  --loudness-layout <l>  Channel weights: 5.1, 7.1 or a list such as\n"
+        "                         L,R,C,LFE,Ls,Rs (default: every channel 1.0)\n\n"
+        "Metrics:\n"
+        "  --metrics-shm <name>   Publish per-stage latency histograms and counters\n"
+        "                         to /dev/shm/<name> (binary, seqlock)\n"
+        "  --metrics-interval <ms> Publish interval (default 1000)\n\n"
+        "Live Tap:\n"
+        "  --tap-shm <name>       Publish the decoded audio to /dev/shm/<name>\n"
+        "                         (float32 ring, lock-free, for live monitoring)\n"
+        "  --tap-ms <ms>          Tap ring length (default 2000, 100-60000)\n\n"
+        "Control:\n"
+        "  --control              Read 'set key=value ...' and 'get' commands on\n"
+        "                         stdin and apply them without restarting (VOX,\n"
+        "                         levels interval, Opus bitrate and complexity,\n"
+        "                         archive period and layout); JSON replies on stdout\n\n"
         "VOX (Voice-Activated Recording):\n"
         "  --vox                  Enable VOX mode (threshold-based recording)\n"
         "  --vox-threshold <dB>   Activation threshold (default -30, range -60 to -5)\n"
@@ -192,10 +318,13 @@ static void usage(const char *argv0)
         "  Archive mode (hourly rotation):\n"
         "    %s --archive-root /var/lib/audyn --archive-layout flat \\\n"
         "       --archive-suffix opus -m 239.69.1.1\n\n"
+        "  Archive mode, WAV master plus Opus browse copy:\n"
+        "    %s --archive-root /var/lib/audyn --wav-format pcm24 \\\n"
+        "       --tee opus:/var/lib/audyn-proxy -m 239.69.1.1\n\n"
         "  Archive mode (daily directories, UTC):\n"
         "    %s --archive-root /mnt/archive --archive-layout dailydir \\\n"
         "       --archive-clock utc --archive-period 3600 -m 239.69.1.1\n",
-        argv0, argv0, argv0, argv0, argv0, argv0
+        argv0, argv0, argv0, argv0, argv0, argv0, argv0, argv0
     );
 }
 
@@ -265,22 +394,106 @@ static const char *get_suffix_from_path(const char *path)
 
 /* -------- Worker context with archive support -------- */
 
+/* Outputs one worker fans its audio out to: the primary plus --tee targets */
+#define AUDYN_MAX_OUTPUTS 4
+
+/* Finished Opus files whose encoder lane is still busy, closed when idle */
+#define AUDYN_MAX_RETIRED 8
+
+/*
+ * One destination of the worker's audio. out[0] is the primary: its
+ * archive policy decides when to rotate and its errors stop the worker.
+ * Tee outputs open, rotate and close at the same boundaries under their
+ * own names; one that fails is logged and skipped until the next file.
+ */
+typedef struct worker_output {
+    output_format_t format;
+
+    /* Naming: archive policy (not owned) or single-file path */
+    audyn_archive_policy_t *archive;
+    const char *file_path;
+
+    /* VOX segment naming */
+    char vox_base_path[512];        /* file_path without its extension */
+    const char *vox_suffix;         /* File suffix (wav, opus) */
+
+    /* Current sink (owned by worker) */
+    audyn_wav_sink_t  *wav_sink;
+    audyn_opus_sink_t *opus_sink;
+    char path[1024];                /* Current file (for the loudness sidecar) */
+    int started;                    /* Start time given to the current file */
+
+    int failed;                     /* Tee: skipped until the next file */
+} worker_output_t;
+
+/* Open the next archive file this long before its rotation boundary */
+#define WORKER_PREPARE_MS 5000
+
+/* One output's file opened ahead of the boundary by the sink helper */
+typedef struct prepared_output {
+    audyn_wav_sink_t  *wav_sink;
+    audyn_opus_sink_t *opus_sink;
+    char path[1024];
+    char error[256];
+    int failed;
+} prepared_output_t;
+
+/*
+ * Next period's files, opened on the sink helper thread. The worker owns
+ * the struct; while 'active' the helper is (or was) running the job and
+ * the worker only reads out[] once the job is done.
+ */
+typedef struct rotation_prep {
+    audyn_sink_job_t job;
+    struct worker_ctx *ctx;
+    int active;                     /* Submitted and not yet taken */
+    uint64_t boundary_ns;           /* Start of the period prepared for */
+    prepared_output_t out[AUDYN_MAX_OUTPUTS];
+} rotation_prep_t;
+
+/* Settings a control-channel request may change (worker_reconf_t.what) */
+#define WORKER_RECONF_VOX       0x1u
+#define WORKER_RECONF_LEVELS    0x2u
+#define WORKER_RECONF_OPUS      0x4u
+#define WORKER_RECONF_ARCHIVE   0x8u
+
+/*
+ * One runtime reconfiguration (--control). The main thread fills it while
+ * reconf_req == reconf_done, then bumps reconf_req (release); the worker
+ * applies it between frames, fills status/error and publishes reconf_done
+ * (release). Values are already validated by the main thread.
+ */
+typedef struct worker_reconf {
+    uint32_t what;                  /* WORKER_RECONF_* */
+    audyn_vox_config_t vox;
+    uint32_t levels_interval_ms;
+    uint32_t opus_bitrate;
+    int opus_complexity;
+    uint32_t archive_period_sec;    /* 0 = unchanged */
+    int archive_layout;             /* < 0 = unchanged */
+    int status;                     /* 0 = applied, -1 = rejected */
+    char error[128];
+} worker_reconf_t;
+
 typedef struct worker_ctx {
     /* Core resources (not owned) */
     audyn_frame_pool_t  *pool;
     audyn_audio_queue_t *queue;
 
-    /* Archive policy (may be NULL for single-file mode) */
+    /* Primary archive policy: drives rotation (NULL for single-file mode) */
     audyn_archive_policy_t *archive;
 
     /* Archive clock source (valid when archive != NULL) */
     audyn_archive_clock_t archive_clock;
 
-    /* Single-file mode path (NULL if using archive) */
-    const char *single_file_path;
+    /* Outputs (out[0] = primary) */
+    worker_output_t out[AUDYN_MAX_OUTPUTS];
+    uint32_t n_outputs;
 
-    /* Output format */
-    output_format_t format;
+    /* Pool-encoded Opus files closed once their encoder catches up, so a
+     * rotation never waits on the slower output */
+    audyn_opus_sink_t *retired[AUDYN_MAX_RETIRED];
+    uint32_t n_retired;
 
     /* Audio parameters */
     uint32_t sample_rate;
@@ -291,6 +504,28 @@ typedef struct worker_ctx {
     int opus_vbr;
     int opus_complexity;
 
+    /* File I/O backend and durability for both sink types */
+    audyn_file_writer_cfg_t writer_cfg;
+    uint32_t seek_index_ms;         /* Seek index spacing (0 = none) */
+
+    /* Shared Opus encoder threads (not owned; NULL = encode in this thread) */
+    audyn_encoder_pool_t *encoder_pool;
+
+    /* Shared sink helper (not owned; NULL = rotate synchronously). Opens
+     * the next archive files ahead of the boundary and finalises the
+     * previous ones */
+    audyn_sink_helper_t *sink_helper;
+    rotation_prep_t prep;
+
+    /* WAV sample format and container (RIFF / RF64 / BW64) */
+    audyn_wav_format_t wav_format;
+    audyn_wav_container_t wav_container;
+
+    /* Queue frames may carry packed S24LE (frame->raw) for a PCM24 WAV;
+     * blocks without it are encoded from the floats */
+    int raw_s24;
+    audyn_pcm_encoder_t raw_enc;
+
     /* PTP clock for TAI timestamps (may be NULL) */
     audyn_ptp_clock_t *ptp_clk;
 
@@ -301,53 +536,86 @@ typedef struct worker_ctx {
     int status;
     char error[256];
 
-    /* Current sinks (owned by worker) */
-    audyn_wav_sink_t  *wav_sink;
-    audyn_opus_sink_t *opus_sink;
+    /* Coalescing: queue frames are gathered into one block of up to
+     * coalesce_frames sample frames before metering, VOX and sink writes
+     * (0 = process every queue frame individually) */
+    uint32_t coalesce_ms;
+    uint32_t coalesce_frames;
+    float   *coalesce_buf;
+    uint8_t *coalesce_raw;          /* S24LE block when raw_s24 */
+    audyn_audio_frame_t coalesce_block;
+    uint32_t last_frame_frames;     /* Sample frames in the last queue frame */
+
+    /* Silence written while the queue is idle: the worker's own zeroed
+     * frame, since the pool is acquired only by the input */
+    float   *silence_buf;
+    audyn_audio_frame_t silence_block;
+
+    /* Media clock (archive mode): archive-clock time of the next sample
+     * frame is media_anchor_ns plus media_samples at the stream rate */
+    uint64_t media_anchor_ns;
+    uint64_t media_samples;
+    uint64_t block_ns;              /* Archive-clock time of the block being written (0 = unknown) */
 
     /* Statistics */
     uint64_t files_written;
-    uint64_t frames_written;
+    uint64_t frames_written;        /* Queue frames consumed */
+    uint64_t sink_writes;           /* Sink write calls */
     uint64_t rotations;
 
     /* Level metering (optional) */
     audyn_level_meter_t *level_meter;
 
+    /* Live PCM tap (optional): every queue frame, before coalescing */
+    audyn_pcm_tap_t *tap;
+
+    /* Loudness (optional): measures what is written, one sidecar per
+     * closed file */
+    audyn_loudness_t *loudness;
+
     /* VOX (optional) */
     audyn_vox_t *vox;
     uint32_t vox_segment_number;
-    char vox_base_path[512];  /* Base path for segment files */
-    const char *vox_suffix;   /* File suffix (wav, opus) */
+
+    /* Runtime reconfiguration handed over by the main thread */
+    worker_reconf_t reconf;
+    _Atomic uint32_t reconf_req;
+    _Atomic uint32_t reconf_done;
 
 } worker_ctx_t;
 
 /* -------- Sink management -------- */
 
-static int open_wav_sink(worker_ctx_t *ctx, const char *path)
+static int open_wav_file(const worker_ctx_t *ctx, const char *path,
+                         audyn_wav_sink_t **out, char *err, size_t err_len)
 {
     audyn_wav_sink_cfg_t wcfg;
     memset(&wcfg, 0, sizeof(wcfg));
-    wcfg.format = AUDYN_WAV_PCM16;
-    wcfg.enable_fsync = 0;
-
-    ctx->wav_sink = audyn_wav_sink_create(&wcfg);
-    if (!ctx->wav_sink) {
-        snprintf(ctx->error, sizeof(ctx->error), "WAV sink create failed");
+    wcfg.format = ctx->wav_format;
+    wcfg.container = ctx->wav_container;
+    wcfg.enable_fsync = ctx->writer_cfg.durable;
+    wcfg.writer = ctx->writer_cfg;
+    wcfg.seek_interval_ms = ctx->seek_index_ms;
+
+    audyn_wav_sink_t *sink = audyn_wav_sink_create(&wcfg);
+    if (!sink) {
+        snprintf(err, err_len, "WAV sink create failed");
         return -1;
     }
 
-    if (audyn_wav_sink_open(ctx->wav_sink, path, ctx->sample_rate, ctx->channels) != 0) {
-        snprintf(ctx->error, sizeof(ctx->error), "WAV sink open failed: %s", path);
-        audyn_wav_sink_destroy(ctx->wav_sink);
-        ctx->wav_sink = NULL;
+    if (audyn_wav_sink_open(sink, path, ctx->sample_rate, ctx->channels) != 0) {
+        snprintf(err, err_len, "WAV sink open failed: %.200s", path);
+        audyn_wav_sink_destroy(sink);
         return -1;
     }
 
     LOG_INFO("Opened WAV file: %s", path);
+    *out = sink;
     return 0;
 }
 
-static int open_opus_sink(worker_ctx_t *ctx, const char *path)
+static int open_opus_file(const worker_ctx_t *ctx, const char *path,
+                          audyn_opus_sink_t **out, char *err, size_t err_len)
 {
     audyn_opus_cfg_t ocfg;
     memset(&ocfg, 0, sizeof(ocfg));
@@ -357,79 +625,550 @@ static int open_opus_sink(worker_ctx_t *ctx, const char *path)
     ocfg.vbr = ctx->opus_vbr;
     ocfg.complexity = ctx->opus_complexity;
     ocfg.application = AUDYN_OPUS_APP_AUDIO;
-    ocfg.enable_fsync = 0;
-
-    ctx->opus_sink = audyn_opus_sink_create(path, &ocfg);
-    if (!ctx->opus_sink) {
-        snprintf(ctx->error, sizeof(ctx->error), "Opus sink create failed: %s", path);
+    ocfg.enable_fsync = ctx->writer_cfg.durable;
+    ocfg.writer = ctx->writer_cfg;
+    ocfg.writer.sparse = 0;             /* Ogg pages are never zero; DTX instead */
+    ocfg.dtx = ctx->writer_cfg.sparse;
+    ocfg.encoder_pool = ctx->encoder_pool;
+    ocfg.seek_interval_ms = ctx->seek_index_ms;
+
+    audyn_opus_sink_t *sink = audyn_opus_sink_create(path, &ocfg);
+    if (!sink) {
+        snprintf(err, err_len, "Opus sink create failed: %.200s", path);
         return -1;
     }
 
     LOG_INFO("Opened Opus file: %s", path);
+    *out = sink;
     return 0;
 }
 
-static void close_current_sink(worker_ctx_t *ctx)
+/* Close retired Opus files whose encoder is idle (all of them if wait). */
+static void reap_retired(worker_ctx_t *ctx, int wait)
+{
+    uint32_t kept = 0;
+
+    for (uint32_t i = 0; i < ctx->n_retired; i++) {
+        audyn_opus_sink_t *sink = ctx->retired[i];
+        if (!wait && audyn_opus_sink_busy(sink)) {
+            ctx->retired[kept++] = sink;
+            continue;
+        }
+        audyn_opus_sink_close(sink);
+        audyn_opus_sink_destroy(sink);
+    }
+    ctx->n_retired = kept;
+}
+
+static void close_opus_sink(worker_ctx_t *ctx, audyn_opus_sink_t *sink)
+{
+    /* Audio still queued for the encoder threads: finish the file later
+     * instead of holding up the other outputs here */
+    if (audyn_opus_sink_busy(sink)) {
+        if (ctx->n_retired == AUDYN_MAX_RETIRED) {
+            reap_retired(ctx, 1);
+        }
+        ctx->retired[ctx->n_retired++] = sink;
+        return;
+    }
+
+    audyn_opus_sink_flush(sink);
+    audyn_opus_sink_close(sink);
+    audyn_opus_sink_destroy(sink);
+}
+
+static void close_output(worker_ctx_t *ctx, worker_output_t *o)
 {
-    if (ctx->wav_sink) {
-        audyn_wav_sink_close(ctx->wav_sink);
-        audyn_wav_sink_destroy(ctx->wav_sink);
-        ctx->wav_sink = NULL;
+    if (o->wav_sink) {
+        audyn_wav_sink_close(o->wav_sink);
+        audyn_wav_sink_destroy(o->wav_sink);
+        o->wav_sink = NULL;
         ctx->files_written++;
     }
 
-    if (ctx->opus_sink) {
-        audyn_opus_sink_flush(ctx->opus_sink);
-        audyn_opus_sink_close(ctx->opus_sink);
-        audyn_opus_sink_destroy(ctx->opus_sink);
-        ctx->opus_sink = NULL;
+    if (o->opus_sink) {
+        close_opus_sink(ctx, o->opus_sink);
+        o->opus_sink = NULL;
         ctx->files_written++;
     }
 }
 
-static int open_sink(worker_ctx_t *ctx, const char *path)
+/* Loudness figures of the file being closed; 1 if sidecars are due */
+static int take_loudness(worker_ctx_t *ctx, audyn_loudness_summary_t *summary)
 {
-    if (ctx->format == OUTPUT_WAV) {
-        return open_wav_sink(ctx, path);
-    } else {
-        return open_opus_sink(ctx, path);
+    if (!ctx->loudness) {
+        return 0;
     }
+    audyn_loudness_get_summary(ctx->loudness, summary);
+    audyn_loudness_reset_file(ctx->loudness);
+    return summary->frames > 0;
 }
 
-static int open_vox_segment(worker_ctx_t *ctx)
+static void close_current_sink(worker_ctx_t *ctx)
 {
-    /* Generate segment filename */
-    char path[1024];
-    snprintf(path, sizeof(path), "%s_%03u.%s",
-             ctx->vox_base_path, ctx->vox_segment_number, ctx->vox_suffix);
+    audyn_loudness_summary_t summary;
+    const int sidecar = take_loudness(ctx, &summary);
+
+    for (uint32_t i = 0; i < ctx->n_outputs; i++) {
+        worker_output_t *o = &ctx->out[i];
+        const int was_open = o->wav_sink || o->opus_sink;
+
+        close_output(ctx, o);
 
+        /* Every output of one file carries the same audio */
+        if (sidecar && was_open) {
+            audyn_loudness_write_sidecar(&summary, o->path,
+                                         ctx->sample_rate, ctx->channels);
+        }
+    }
+}
+
+static int output_is_open(const worker_ctx_t *ctx)
+{
+    return ctx->out[0].wav_sink || ctx->out[0].opus_sink;
+}
+
+/*
+ * Open the next file on every output: the VOX segment, the archive path
+ * for now_ns, or the single-file path. The primary must succeed; a tee
+ * output that fails is skipped until the next file.
+ */
+static int open_sink(worker_ctx_t *ctx, uint64_t now_ns)
+{
+    for (uint32_t i = 0; i < ctx->n_outputs; i++) {
+        worker_output_t *o = &ctx->out[i];
+        char path[1024];
+        int rc = 0;
+
+        o->failed = 0;
+        o->started = 0;
+
+        if (ctx->vox) {
+            snprintf(path, sizeof(path), "%s_%03u.%s",
+                     o->vox_base_path, ctx->vox_segment_number, o->vox_suffix);
+            LOG_INFO("VOX: Opening segment file: %s", path);
+        } else if (o->archive) {
+            if (audyn_archive_policy_next_path(o->archive, now_ns, path, sizeof(path)) != 0) {
+                snprintf(ctx->error, sizeof(ctx->error), "Failed to generate archive path");
+                rc = -1;
+            }
+        } else {
+            snprintf(path, sizeof(path), "%s", o->file_path);
+        }
+
+        if (rc == 0) {
+            rc = (o->format == OUTPUT_WAV)
+                ? open_wav_file(ctx, path, &o->wav_sink, ctx->error, sizeof(ctx->error))
+                : open_opus_file(ctx, path, &o->opus_sink, ctx->error, sizeof(ctx->error));
+        }
+        if (rc == 0) {
+            snprintf(o->path, sizeof(o->path), "%s", path);
+        }
+        if (rc != 0) {
+            if (i == 0) {
+                return -1;
+            }
+            LOG_ERROR("Worker: tee output skipped until the next file: %s", ctx->error);
+            o->failed = 1;
+        }
+    }
+
+    return 0;
+}
+
+static int open_vox_segment(worker_ctx_t *ctx)
+{
+    int rc = open_sink(ctx, 0);
     ctx->vox_segment_number++;
+    return rc;
+}
+
+/* -------- Rotation pipeline (sink helper) -------- */
+
+/*
+ * With a sink helper, archive rotation costs the worker two pointer
+ * swaps: the next period's directories and files are opened on the
+ * helper up to WORKER_PREPARE_MS before the boundary, and the finished
+ * files are closed (header patch, fsync, sidecar) there afterwards.
+ */
+
+/* Sink helper: open every output's file for prep->boundary_ns */
+static void prep_run(audyn_sink_job_t *job)
+{
+    rotation_prep_t *prep = (rotation_prep_t *)job;
+    const worker_ctx_t *ctx = prep->ctx;
+
+    for (uint32_t i = 0; i < ctx->n_outputs; i++) {
+        const worker_output_t *o = &ctx->out[i];
+        prepared_output_t *p = &prep->out[i];
+        int rc = 0;
+
+        if (audyn_archive_policy_peek_path(o->archive, prep->boundary_ns,
+                                           p->path, sizeof(p->path)) != 0) {
+            snprintf(p->error, sizeof(p->error), "Failed to generate archive path");
+            rc = -1;
+        } else if (audyn_archive_policy_make_dirs(o->archive, p->path) != 0) {
+            snprintf(p->error, sizeof(p->error),
+                     "Failed to create archive directory for %.200s", p->path);
+            rc = -1;
+        }
+
+        if (rc == 0) {
+            rc = (o->format == OUTPUT_WAV)
+                ? open_wav_file(ctx, p->path, &p->wav_sink, p->error, sizeof(p->error))
+                : open_opus_file(ctx, p->path, &p->opus_sink, p->error, sizeof(p->error));
+        }
+        p->failed = (rc != 0);
+
+        /* Without the primary the worker opens synchronously anyway */
+        if (p->failed && i == 0) {
+            break;
+        }
+    }
+}
+
+/* Close and remove prepared files that will not be used */
+static void prep_discard(worker_ctx_t *ctx)
+{
+    rotation_prep_t *prep = &ctx->prep;
+    if (!prep->active) {
+        return;
+    }
+
+    audyn_sink_helper_wait(ctx->sink_helper, &prep->job);
+    prep->active = 0;
+
+    for (uint32_t i = 0; i < ctx->n_outputs; i++) {
+        prepared_output_t *p = &prep->out[i];
+        if (p->wav_sink) {
+            audyn_wav_sink_close(p->wav_sink);
+            audyn_wav_sink_destroy(p->wav_sink);
+        } else if (p->opus_sink) {
+            audyn_opus_sink_close(p->opus_sink);
+            audyn_opus_sink_destroy(p->opus_sink);
+        } else {
+            continue;
+        }
+        p->wav_sink = NULL;
+        p->opus_sink = NULL;
+        if (unlink(p->path) == 0) {
+            LOG_DEBUG("Worker: removed unused prepared file %s", p->path);
+        }
+        if (ctx->seek_index_ms > 0) {
+            char seek_path[1024 + sizeof(AUDYN_SEEK_SUFFIX)];
+            snprintf(seek_path, sizeof(seek_path), "%s%s", p->path, AUDYN_SEEK_SUFFIX);
+            (void)unlink(seek_path);
+        }
+    }
+}
+
+/* Ask the helper for the next period's files once the boundary is near */
+static void prep_maybe_start(worker_ctx_t *ctx, uint64_t now_ns)
+{
+    rotation_prep_t *prep = &ctx->prep;
+    if (!ctx->sink_helper || ctx->vox || prep->active) {
+        return;
+    }
+
+    uint64_t boundary = audyn_archive_policy_next_boundary_ns(ctx->archive);
+    if (boundary == 0 || boundary == prep->boundary_ns || now_ns >= boundary ||
+        boundary - now_ns > WORKER_PREPARE_MS * 1000000ULL) {
+        return;
+    }
+
+    /* A layout coarser than the period reuses the name: opening it early
+     * would truncate the file still being written */
+    prep->boundary_ns = boundary;
+    char next[1024];
+    if (audyn_archive_policy_peek_path(ctx->archive, boundary, next, sizeof(next)) != 0 ||
+        strcmp(next, ctx->out[0].path) == 0) {
+        return;
+    }
+
+    memset(prep->out, 0, sizeof(prep->out));
+    prep->ctx = ctx;
+    prep->active = 1;
+    audyn_sink_job_init(&prep->job, prep_run, 0);
+    audyn_sink_helper_submit(ctx->sink_helper, &prep->job);
+}
+
+/*
+ * At the boundary: switch every output to its prepared file if those are
+ * for the period now_ns falls in. Returns 0 if taken, -1 if the caller
+ * must open synchronously.
+ */
+static int prep_take(worker_ctx_t *ctx, uint64_t now_ns)
+{
+    rotation_prep_t *prep = &ctx->prep;
+    if (!prep->active) {
+        return -1;
+    }
+
+    if (!audyn_sink_helper_done(&prep->job)) {
+        LOG_WARN("Worker: next archive file not ready at the boundary, waiting");
+        audyn_sink_helper_wait(ctx->sink_helper, &prep->job);
+    }
+
+    if (prep->out[0].failed) {
+        LOG_WARN("Worker: preparing next file failed (%s), retrying now",
+                 prep->out[0].error);
+        prep_discard(ctx);
+        return -1;
+    }
+
+    /* A clock step can skip the prepared period: name the file for now */
+    uint64_t period_start = 0;
+    if (audyn_archive_policy_enter_period(ctx->out[0].archive, now_ns, &period_start) != 0 ||
+        period_start != prep->boundary_ns) {
+        LOG_WARN("Worker: clock left the prepared period, opening synchronously");
+        prep_discard(ctx);
+        return -1;
+    }
+
+    for (uint32_t i = 0; i < ctx->n_outputs; i++) {
+        worker_output_t *o = &ctx->out[i];
+        prepared_output_t *p = &prep->out[i];
+
+        if (i > 0) {
+            (void)audyn_archive_policy_enter_period(o->archive, now_ns, NULL);
+        }
+
+        o->wav_sink = p->wav_sink;
+        o->opus_sink = p->opus_sink;
+        o->failed = p->failed;
+        o->started = 0;
+        if (p->failed) {
+            LOG_ERROR("Worker: tee output skipped until the next file: %s", p->error);
+        } else {
+            snprintf(o->path, sizeof(o->path), "%s", p->path);
+        }
+        p->wav_sink = NULL;
+        p->opus_sink = NULL;
+    }
+
+    prep->active = 0;
+    return 0;
+}
+
+/* Finished files handed to the sink helper (freed by it) */
+typedef struct close_job {
+    audyn_sink_job_t job;
+    uint32_t n;
+    audyn_wav_sink_t  *wav_sink[AUDYN_MAX_OUTPUTS];
+    audyn_opus_sink_t *opus_sink[AUDYN_MAX_OUTPUTS];
+    char path[AUDYN_MAX_OUTPUTS][1024];
+    int sidecar;
+    audyn_loudness_summary_t summary;
+    uint32_t sample_rate;
+    uint32_t channels;
+} close_job_t;
+
+static void close_job_run(audyn_sink_job_t *job)
+{
+    close_job_t *cj = (close_job_t *)job;
+
+    for (uint32_t i = 0; i < cj->n; i++) {
+        if (cj->wav_sink[i]) {
+            audyn_wav_sink_close(cj->wav_sink[i]);
+            audyn_wav_sink_destroy(cj->wav_sink[i]);
+        } else if (cj->opus_sink[i]) {
+            /* Waits for the encoder threads; only this helper is held up */
+            audyn_opus_sink_close(cj->opus_sink[i]);
+            audyn_opus_sink_destroy(cj->opus_sink[i]);
+        } else {
+            continue;
+        }
+        if (cj->sidecar) {
+            audyn_loudness_write_sidecar(&cj->summary, cj->path[i],
+                                         cj->sample_rate, cj->channels);
+        }
+    }
 
-    LOG_INFO("VOX: Opening segment file: %s", path);
-    return open_sink(ctx, path);
+    free(cj);
 }
 
+/* Hand the current files to the sink helper (closes here without one) */
+static void close_current_sink_async(worker_ctx_t *ctx)
+{
+    close_job_t *cj = ctx->sink_helper ? (close_job_t *)calloc(1, sizeof(*cj)) : NULL;
+    if (!cj) {
+        close_current_sink(ctx);
+        return;
+    }
+
+    audyn_sink_job_init(&cj->job, close_job_run, 1);
+    cj->sidecar = take_loudness(ctx, &cj->summary);
+    cj->sample_rate = ctx->sample_rate;
+    cj->channels = ctx->channels;
+    cj->n = ctx->n_outputs;
+
+    for (uint32_t i = 0; i < ctx->n_outputs; i++) {
+        worker_output_t *o = &ctx->out[i];
+        if (!o->wav_sink && !o->opus_sink) {
+            continue;
+        }
+        cj->wav_sink[i] = o->wav_sink;
+        cj->opus_sink[i] = o->opus_sink;
+        snprintf(cj->path[i], sizeof(cj->path[i]), "%s", o->path);
+        o->wav_sink = NULL;
+        o->opus_sink = NULL;
+        ctx->files_written++;
+    }
+
+    audyn_sink_helper_submit(ctx->sink_helper, &cj->job);
+}
+
+/* Seek index header: when the file's first sample was due */
+static void start_output(worker_ctx_t *ctx, worker_output_t *o, const audyn_audio_frame_t *frame)
+{
+    o->started = 1;
+    if (ctx->seek_index_ms == 0) {
+        return;
+    }
+
+    uint64_t clock_ns = ctx->block_ns;
+    if (clock_ns == 0) {
+        /* Not archiving (system time): the block's last sample has just arrived */
+        struct timespec ts;
+        clock_gettime(CLOCK_REALTIME, &ts);
+        const uint64_t now_ns = (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+        const uint64_t dur = (uint64_t)frame->sample_frames * 1000000000ULL / ctx->sample_rate;
+        clock_ns = (now_ns > dur) ? now_ns - dur : now_ns;
+    }
+
+    if (o->wav_sink) {
+        audyn_wav_sink_set_start(o->wav_sink, clock_ns, frame->media_ns);
+    } else if (o->opus_sink) {
+        audyn_opus_sink_set_start(o->opus_sink, clock_ns, frame->media_ns);
+    }
+}
+
+static int write_output(worker_ctx_t *ctx, worker_output_t *o, audyn_audio_frame_t *frame)
+{
+    if (!o->started) {
+        start_output(ctx, o, frame);
+    }
+
+    if (o->wav_sink) {
+        if (ctx->raw_s24 && frame->raw && frame->raw_frames == frame->sample_frames) {
+            return audyn_wav_sink_write_s24le(o->wav_sink, frame->raw,
+                                              frame->sample_frames, frame->channels);
+        }
+        return audyn_wav_sink_write(o->wav_sink, frame->data,
+                                    frame->sample_frames, frame->channels);
+    }
+    if (o->opus_sink) {
+        return audyn_opus_sink_write(o->opus_sink, frame->data, frame->sample_frames);
+    }
+    return -1;
+}
+
+/* Write one block to every output. Only a primary failure is an error. */
 static int write_to_sink(worker_ctx_t *ctx, audyn_audio_frame_t *frame)
 {
-    int ret = 0;
+    if (ctx->loudness) {
+        audyn_loudness_process(ctx->loudness, frame->data, frame->sample_frames);
+    }
 
-    if (ctx->format == OUTPUT_WAV && ctx->wav_sink) {
-        ret = audyn_wav_sink_write(ctx->wav_sink, frame->data,
-                                   frame->sample_frames, frame->channels);
-    } else if (ctx->format == OUTPUT_OPUS && ctx->opus_sink) {
-        ret = audyn_opus_sink_write(ctx->opus_sink, frame->data, frame->sample_frames);
-    } else {
-        ret = -1;
+    for (uint32_t i = 0; i < ctx->n_outputs; i++) {
+        worker_output_t *o = &ctx->out[i];
+        if (o->failed) {
+            continue;
+        }
+
+        const uint64_t t0 = audyn_metrics_start();
+        const int rc = write_output(ctx, o, frame);
+        audyn_metrics_stage_end(AUDYN_STAGE_SINK_WRITE, t0);
+        if (rc == 0) {
+            ctx->sink_writes++;
+            continue;
+        }
+        if (i == 0) {
+            return -1;
+        }
+
+        LOG_ERROR("Worker: tee output write failed, skipped until the next file");
+        close_output(ctx, o);
+        o->failed = 1;
+    }
+
+    return 0;
+}
+
+/* -------- Processing pipeline -------- */
+
+/*
+ * Level meter, VOX and sink for one block of audio. The frame is not
+ * released here. Returns -1 on a write or segment error (ctx->status set
+ * for VOX segment failures).
+ */
+static int process_block(worker_ctx_t *ctx, audyn_audio_frame_t *frame)
+{
+    /* Process through level meter if enabled */
+    if (ctx->level_meter) {
+        audyn_level_meter_process(ctx->level_meter, frame);
+    }
+
+    if (!ctx->vox) {
+        /* Normal (non-VOX) write */
+        return write_to_sink(ctx, frame);
+    }
+
+    /* Get current levels from meter (VOX runs with 1 or 2 channels) */
+    audyn_channel_level_t levels[AUDYN_METER_MAX_CHANNELS];
+    audyn_level_meter_get_levels(ctx->level_meter, levels);
+
+    float rms_l = levels[0].rms_db;
+    float rms_r = (ctx->channels > 1) ? levels[1].rms_db : rms_l;
+    float peak_l = levels[0].peak_db;
+    float peak_r = (ctx->channels > 1) ? levels[1].peak_db : peak_l;
+
+    /* Process through VOX */
+    const audyn_audio_frame_t *out_frames[256];
+    int n = audyn_vox_process(ctx->vox, frame, rms_l, rms_r, peak_l, peak_r,
+                              out_frames, 256);
+
+    /* Check if we need to open a new segment file */
+    if (audyn_vox_should_open_file(ctx->vox)) {
+        if (open_vox_segment(ctx) != 0) {
+            LOG_ERROR("Worker: VOX segment open failed");
+            ctx->status = -1;
+            return -1;
+        }
     }
 
-    if (ret == 0) {
-        ctx->frames_written++;
+    /* Write output frames (may include pre-roll) */
+    int ret = 0;
+    for (int i = 0; i < n; i++) {
+        /* Cast away const - we're just passing through, not modifying */
+        if (write_to_sink(ctx, (audyn_audio_frame_t *)out_frames[i]) != 0) {
+            ret = -1;
+            break;
+        }
+    }
+
+    /* Check if we need to close the segment file */
+    if (audyn_vox_should_close_file(ctx->vox)) {
+        LOG_INFO("Worker: VOX closing segment (silence detected)");
+        close_current_sink(ctx);
     }
 
     return ret;
 }
 
-/* -------- Worker thread -------- */
+/* -------- Sample-accurate rotation -------- */
+
+/* Frame stamps further than this from the archive clock are in another
+ * timebase (e.g. a PHC against system time) and are not used. Also how
+ * long the archive clock waits for audio to reach a boundary before
+ * rotating on its own. */
+#define WORKER_MEDIA_MAX_SKEW_MS 2000
+#define WORKER_ROTATE_SLACK_MS   WORKER_MEDIA_MAX_SKEW_MS
+
+/* Unstamped audio is timed by counting samples; the count is re-anchored
+ * to the archive clock once it drifts this far (source clock offset,
+ * backlog, lost packets). */
+#define WORKER_MEDIA_MAX_DRIFT_MS 100
 
 static uint64_t get_current_time_ns(worker_ctx_t *ctx)
 {
@@ -448,205 +1187,1712 @@ static uint64_t get_current_time_ns(worker_ctx_t *ctx)
     return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
 }
 
-static int maybe_rotate(worker_ctx_t *ctx)
+/* Duration of 'samples' sample frames in ns, without overflow */
+static uint64_t media_offset_ns(uint64_t samples, uint32_t rate)
+{
+    return (samples / rate) * 1000000000ULL + (samples % rate) * 1000000000ULL / rate;
+}
+
+static uint64_t abs_diff_ns(uint64_t a, uint64_t b)
+{
+    return (a > b) ? a - b : b - a;
+}
+
+/*
+ * Archive-clock time of a block's first sample frame. A block stamped
+ * from the PTP clock's RTP mapping is taken as it is; otherwise it
+ * follows on from the previous block, so files are cut on exact sample
+ * counts.
+ */
+static uint64_t block_start_ns(worker_ctx_t *ctx, const audyn_audio_frame_t *frame)
+{
+    const uint64_t now_ns = get_current_time_ns(ctx);
+    const uint64_t expect = ctx->media_anchor_ns +
+                            media_offset_ns(ctx->media_samples, ctx->sample_rate);
+    uint64_t start;
+
+    if (frame->media_ns != 0 &&
+        abs_diff_ns(frame->media_ns, now_ns) <= WORKER_MEDIA_MAX_SKEW_MS * 1000000ULL) {
+        start = frame->media_ns;
+    } else {
+        /* The block's last sample has just arrived */
+        uint64_t dur = media_offset_ns(frame->sample_frames, ctx->sample_rate);
+        start = (now_ns > dur) ? now_ns - dur : now_ns;
+        if (ctx->media_anchor_ns != 0 &&
+            abs_diff_ns(expect, start) <= WORKER_MEDIA_MAX_DRIFT_MS * 1000000ULL) {
+            start = expect;
+        }
+    }
+
+    if (start != expect) {
+        ctx->media_anchor_ns = start;
+        ctx->media_samples = 0;
+    }
+    return start;
+}
+
+/* Close the current files and open those for the period at now_ns. */
+static int rotate_files(worker_ctx_t *ctx, uint64_t now_ns)
+{
+    const uint64_t t0 = audyn_metrics_start();
+
+    if (output_is_open(ctx)) {
+        LOG_INFO("Rotating archive file");
+        close_current_sink_async(ctx);
+        ctx->rotations++;
+    }
+
+    /* Open the new files: every output shares this boundary */
+    if (prep_take(ctx, now_ns) != 0 && open_sink(ctx, now_ns) != 0) {
+        return -1;
+    }
+
+    /* Advance archive policies */
+    for (uint32_t i = 0; i < ctx->n_outputs; i++) {
+        if (ctx->out[i].archive) {
+            audyn_archive_policy_advance(ctx->out[i].archive);
+        }
+    }
+
+    audyn_metrics_stage_end(AUDYN_STAGE_ROTATION, t0);
+    return 0;
+}
+
+/*
+ * Process one block, rotating on the first sample frame of the next
+ * period: the head goes to the current files, the tail to the next ones.
+ * Both halves are views into the block, so nothing is copied.
+ */
+static int write_block(worker_ctx_t *ctx, audyn_audio_frame_t *frame)
+{
+    if (!ctx->archive || ctx->vox) {
+        ctx->block_ns = 0;
+        return process_block(ctx, frame);
+    }
+
+    const uint32_t total = frame->sample_frames;
+    const uint64_t start = block_start_ns(ctx, frame);
+    ctx->media_samples += total;
+    ctx->block_ns = start;
+
+    uint32_t split = 0;
+    if (!audyn_archive_policy_split_offset(ctx->archive, start, total,
+                                           ctx->sample_rate, &split)) {
+        return process_block(ctx, frame);
+    }
+
+    const int has_raw = frame->raw && frame->raw_frames == total;
+    audyn_audio_frame_t part = *frame;
+
+    if (split > 0) {
+        part.sample_frames = split;
+        part.raw_frames = has_raw ? split : 0;
+        if (process_block(ctx, &part) != 0) {
+            return -1;
+        }
+    }
+
+    /* A block starting well past the boundary (clock step) names the new
+     * file for its own time */
+    uint64_t boundary = audyn_archive_policy_next_boundary_ns(ctx->archive);
+    if (rotate_files(ctx, (start > boundary) ? start : boundary) != 0) {
+        LOG_ERROR("Worker: rotation failed: %s", ctx->error);
+        ctx->status = -1;
+        return -1;
+    }
+
+    const size_t ch = frame->channels;
+    part.data = frame->data + (size_t)split * ch;
+    part.raw = has_raw ? frame->raw + (size_t)split * ch * 3u : NULL;  /* S24LE */
+    part.sample_frames = total - split;
+    part.raw_frames = has_raw ? total - split : 0;
+    part.media_ns = frame->media_ns ? frame->media_ns + media_offset_ns(split, ctx->sample_rate) : 0;
+    ctx->block_ns = start + media_offset_ns(split, ctx->sample_rate);
+    return process_block(ctx, &part);
+}
+
+/* Allocate the idle silence frame (worker thread, before the main loop). */
+static int silence_init(worker_ctx_t *ctx)
+{
+    const uint32_t frames = audyn_frame_pool_frame_capacity(ctx->pool);
+
+    ctx->silence_buf = (float *)calloc((size_t)frames * ctx->channels, sizeof(float));
+    if (!ctx->silence_buf) {
+        snprintf(ctx->error, sizeof(ctx->error), "silence buffer allocation failed");
+        return -1;
+    }
+
+    memset(&ctx->silence_block, 0, sizeof(ctx->silence_block));
+    ctx->silence_block.data = ctx->silence_buf;
+    ctx->silence_block.channels = ctx->channels;
+    return 0;
+}
+
+/* Allocate the coalescing block (worker thread, before the main loop). */
+static int coalesce_init(worker_ctx_t *ctx)
+{
+    ctx->coalesce_frames = 0;
+    if (ctx->coalesce_ms == 0) {
+        return 0;
+    }
+
+    uint32_t frames = (uint32_t)(((uint64_t)ctx->coalesce_ms * ctx->sample_rate) / 1000);
+    if (frames == 0) frames = 1;
+
+    ctx->coalesce_buf = (float *)calloc((size_t)frames * ctx->channels, sizeof(float));
+    if (!ctx->coalesce_buf) {
+        snprintf(ctx->error, sizeof(ctx->error), "coalesce buffer allocation failed");
+        return -1;
+    }
+
+    if (ctx->raw_s24) {
+        ctx->coalesce_raw = (uint8_t *)malloc((size_t)frames * ctx->channels * 3u);
+        if (!ctx->coalesce_raw ||
+            audyn_pcm_encoder_init(&ctx->raw_enc, AUDYN_PCM_OUT_S24LE, AUDYN_PCM_ISA_AUTO) != 0) {
+            snprintf(ctx->error, sizeof(ctx->error), "coalesce buffer allocation failed");
+            return -1;
+        }
+    }
+
+    memset(&ctx->coalesce_block, 0, sizeof(ctx->coalesce_block));
+    ctx->coalesce_block.data = ctx->coalesce_buf;
+    ctx->coalesce_block.raw = ctx->coalesce_raw;
+    ctx->coalesce_block.channels = ctx->channels;
+    ctx->coalesce_block.sample_frames = 0;
+    ctx->coalesce_frames = frames;
+
+    LOG_DEBUG("Worker: coalescing %u sample frames (%ums) per write",
+              frames, ctx->coalesce_ms);
+    return 0;
+}
+
+/* Push out whatever is buffered in the coalescing block. */
+static int flush_coalesced(worker_ctx_t *ctx)
+{
+    if (ctx->coalesce_frames == 0 || ctx->coalesce_block.sample_frames == 0) {
+        return 0;
+    }
+
+    ctx->coalesce_block.raw_frames = ctx->coalesce_raw ? ctx->coalesce_block.sample_frames : 0;
+
+    int ret = write_block(ctx, &ctx->coalesce_block);
+    ctx->coalesce_block.sample_frames = 0;
+    return ret;
+}
+
+/*
+ * Feed one queue frame into the pipeline: straight through when coalescing
+ * is off, otherwise appended to the block (flushing whenever it fills).
+ */
+static int submit_frame(worker_ctx_t *ctx, const audyn_audio_frame_t *frame)
+{
+    ctx->frames_written++;
+
+    if (ctx->tap && frame->channels == ctx->channels) {
+        audyn_pcm_tap_write(ctx->tap, frame->data, frame->sample_frames);
+    }
+
+    if (ctx->coalesce_frames == 0) {
+        return write_block(ctx, (audyn_audio_frame_t *)frame);
+    }
+
+    if (frame->channels != ctx->channels) {
+        snprintf(ctx->error, sizeof(ctx->error), "frame channel count mismatch");
+        return -1;
+    }
+
+    audyn_audio_frame_t *blk = &ctx->coalesce_block;
+    const uint32_t ch = ctx->channels;
+    const int has_raw = frame->raw && frame->raw_frames == frame->sample_frames;
+    uint32_t done = 0;
+
+    while (done < frame->sample_frames) {
+        uint32_t space = ctx->coalesce_frames - blk->sample_frames;
+        uint32_t n = frame->sample_frames - done;
+        if (n > space) n = space;
+
+        if (blk->sample_frames == 0) {
+            blk->media_ns = frame->media_ns
+                          ? frame->media_ns + media_offset_ns(done, ctx->sample_rate)
+                          : 0;
+        }
+
+        memcpy(blk->data + (size_t)blk->sample_frames * ch,
+               frame->data + (size_t)done * ch,
+               (size_t)n * ch * sizeof(float));
+        if (ctx->coalesce_raw) {
+            /* Keep the block's S24LE copy complete: input samples when the
+             * frame has them, otherwise (L16, silence) encoded floats */
+            uint8_t *dst = ctx->coalesce_raw + (size_t)blk->sample_frames * ch * 3u;
+            if (has_raw) {
+                memcpy(dst, frame->raw + (size_t)done * ch * 3u, (size_t)n * ch * 3u);
+            } else {
+                audyn_pcm_encode(&ctx->raw_enc, frame->data + (size_t)done * ch, dst,
+                                 (size_t)n * ch);
+            }
+        }
+        blk->sample_frames += n;
+        done += n;
+
+        if (blk->sample_frames == ctx->coalesce_frames) {
+            if (flush_coalesced(ctx) != 0) return -1;
+        }
+    }
+
+    return 0;
+}
+
+/* -------- Worker thread -------- */
+
+/* Silence is written after this long without input; also the longest the
+ * worker parks on the queue, which bounds rotation-check latency. */
+#define WORKER_SILENCE_MS 50
+
+/* Frames taken from the queue per drain (one index acquire/publish each) */
+#define WORKER_BURST 32
+
+static uint64_t monotonic_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+/*
+ * Queue entries to wait for before waking: enough to fill the rest of the
+ * coalescing block, so a coalescing worker takes one wakeup per block
+ * instead of one per packet.
+ */
+static uint32_t worker_min_fill(const worker_ctx_t *ctx)
+{
+    if (ctx->coalesce_frames == 0 || ctx->last_frame_frames == 0) {
+        return 1;
+    }
+    uint32_t space = ctx->coalesce_frames - ctx->coalesce_block.sample_frames;
+    uint32_t n = space / ctx->last_frame_frames;
+    uint32_t max_fill = audyn_audio_queue_capacity(ctx->queue) / 2;
+    if (n > max_fill) n = max_fill;
+    return (n > 0) ? n : 1;
+}
+
+/*
+ * Rotate on the archive clock: the first file, VOX recordings, and the
+ * fallback when no audio has carried the media clock across the boundary
+ * (write_block() normally rotates on the boundary's own sample).
+ */
+static int maybe_rotate(worker_ctx_t *ctx)
+{
+    if (!ctx->archive) {
+        return 0;  /* No rotation in single-file mode */
+    }
+
+    uint64_t now_ns = get_current_time_ns(ctx);
+    uint64_t check_ns = now_ns;
+    if (!ctx->vox && output_is_open(ctx)) {
+        check_ns -= WORKER_ROTATE_SLACK_MS * 1000000ULL;
+    }
+
+    if (!audyn_archive_policy_should_rotate(ctx->archive, check_ns)) {
+        prep_maybe_start(ctx, now_ns);
+        return 0;  /* No rotation needed */
+    }
+
+    /* Buffered audio belongs to the current files, and may itself cross
+     * the boundary and rotate */
+    if (flush_coalesced(ctx) != 0) {
+        snprintf(ctx->error, sizeof(ctx->error), "write failed before rotation");
+        return -1;
+    }
+    if (!audyn_archive_policy_should_rotate(ctx->archive, check_ns)) {
+        return 0;
+    }
+
+    return rotate_files(ctx, now_ns);
+}
+
+/* -------- Runtime reconfiguration -------- */
+
+/*
+ * Apply a pending control-channel request. Runs between queue frames, so
+ * every block is metered, gated and encoded with one set of settings.
+ * Applied all or nothing: every archive policy is checked first, then the
+ * VOX change (which can still fail allocating its pre-roll ring and then
+ * leaves the detector unchanged); the remaining steps cannot fail.
+ */
+static void worker_reconfigure(worker_ctx_t *ctx)
+{
+    const uint32_t req = atomic_load_explicit(&ctx->reconf_req, memory_order_acquire);
+    if (req == atomic_load_explicit(&ctx->reconf_done, memory_order_relaxed)) {
+        return;
+    }
+
+    worker_reconf_t *r = &ctx->reconf;
+    r->status = 0;
+    r->error[0] = '\0';
+
+    if (r->what & WORKER_RECONF_ARCHIVE) {
+        for (uint32_t i = 0; i < ctx->n_outputs; i++) {
+            const audyn_archive_policy_t *a = ctx->out[i].archive;
+            if (!a) continue;
+            if ((r->archive_period_sec > 0 &&
+                 audyn_archive_policy_check_period(a, r->archive_period_sec) != 0) ||
+                (r->archive_layout >= 0 &&
+                 audyn_archive_policy_check_layout(a, (audyn_archive_layout_t)r->archive_layout) != 0)) {
+                r->status = -1;
+                snprintf(r->error, sizeof(r->error), "archive policy change rejected");
+                goto done;
+            }
+        }
+    }
+
+    if ((r->what & WORKER_RECONF_VOX) && ctx->vox &&
+        audyn_vox_set_config(ctx->vox, &r->vox) != 0) {
+        r->status = -1;
+        snprintf(r->error, sizeof(r->error), "VOX configuration rejected");
+        goto done;
+    }
+
+    /* Files opened ahead of the boundary carry the old encoder settings
+     * and names: drop them, the helper prepares them again */
+    if (r->what & (WORKER_RECONF_OPUS | WORKER_RECONF_ARCHIVE)) {
+        prep_discard(ctx);
+        ctx->prep.boundary_ns = 0;
+    }
+
+    if (r->what & WORKER_RECONF_OPUS) {
+        ctx->opus_bitrate = r->opus_bitrate;
+        ctx->opus_complexity = r->opus_complexity;
+        for (uint32_t i = 0; i < ctx->n_outputs; i++) {
+            if (ctx->out[i].opus_sink) {
+                (void)audyn_opus_sink_set_encoder(ctx->out[i].opus_sink,
+                                                  r->opus_bitrate, r->opus_complexity);
+            }
+        }
+        LOG_INFO("Worker: Opus bitrate=%u complexity=%d",
+                 r->opus_bitrate, r->opus_complexity);
+    }
+
+    if ((r->what & WORKER_RECONF_LEVELS) && ctx->level_meter) {
+        audyn_level_meter_set_interval(ctx->level_meter, r->levels_interval_ms);
+        LOG_INFO("Worker: levels interval %ums", r->levels_interval_ms);
+    }
+
+    if (r->what & WORKER_RECONF_ARCHIVE) {
+        /* Checked above: these cannot fail */
+        for (uint32_t i = 0; i < ctx->n_outputs; i++) {
+            audyn_archive_policy_t *a = ctx->out[i].archive;
+            if (!a) continue;
+            if (r->archive_period_sec > 0) {
+                (void)audyn_archive_policy_set_period(a, r->archive_period_sec);
+            }
+            if (r->archive_layout >= 0) {
+                (void)audyn_archive_policy_set_layout(a, (audyn_archive_layout_t)r->archive_layout);
+            }
+        }
+        if (r->archive_period_sec > 0) {
+            LOG_INFO("Worker: archive period %us from the next aligned boundary",
+                     r->archive_period_sec);
+        }
+        if (r->archive_layout >= 0) {
+            LOG_INFO("Worker: archive layout %s from the next file",
+                     audyn_archive_layout_to_string((audyn_archive_layout_t)r->archive_layout));
+        }
+    }
+
+done:
+    atomic_store_explicit(&ctx->reconf_done, req, memory_order_release);
+}
+
+static void *worker_main(void *arg)
+{
+    worker_ctx_t *ctx = (worker_ctx_t *)arg;
+
+    /* Initial file open */
+    if (ctx->vox) {
+        /* VOX mode - don't open file yet, wait for audio activity */
+        LOG_INFO("Worker: VOX mode, waiting for audio activity");
+    } else if (ctx->archive) {
+        /* Archive mode - open first file */
+        if (maybe_rotate(ctx) != 0) {
+            LOG_ERROR("Worker: failed to open initial archive file");
+            ctx->status = -1;
+            return NULL;
+        }
+    } else if (ctx->n_outputs > 0 && ctx->out[0].file_path) {
+        /* Single file mode */
+        if (open_sink(ctx, 0) != 0) {
+            LOG_ERROR("Worker: failed to open output file");
+            ctx->status = -1;
+            return NULL;
+        }
+    } else {
+        LOG_ERROR("Worker: no output configured");
+        ctx->status = -1;
+        return NULL;
+    }
+
+    if (coalesce_init(ctx) != 0 || silence_init(ctx) != 0) {
+        LOG_ERROR("Worker: %s", ctx->error);
+        close_current_sink(ctx);
+        reap_retired(ctx, 1);
+        ctx->status = -1;
+        return NULL;
+    }
+
+    /* Main processing loop */
+    uint64_t last_audio_ns = monotonic_ns();
+
+    while (!*ctx->stop_flag) {
+        /* Finish Opus files from earlier rotations once encoded */
+        if (ctx->n_retired > 0) {
+            reap_retired(ctx, 0);
+        }
+
+        worker_reconfigure(ctx);
+
+        /* Check for rotation (archive mode only) */
+        if (ctx->archive && maybe_rotate(ctx) != 0) {
+            LOG_ERROR("Worker: rotation failed: %s", ctx->error);
+            ctx->status = -1;
+            break;
+        }
+
+        /* Get next frame from queue (parks on the queue wakeup when idle) */
+        void *burst[WORKER_BURST];
+        burst[0] = audyn_audio_queue_pop_wait(ctx->queue, worker_min_fill(ctx),
+                                              WORKER_SILENCE_MS);
+        if (!burst[0]) {
+            audyn_audio_frame_t *frame;
+            uint64_t now_ns = monotonic_ns();
+
+            /* Generate silence frame if no data for too long */
+            if (now_ns - last_audio_ns >= WORKER_SILENCE_MS * 1000000ULL) {
+                last_audio_ns = now_ns;
+
+                /* As long as the last queue frame (one pool frame at first) */
+                frame = &ctx->silence_block;
+                frame->sample_frames = ctx->last_frame_frames;
+                if (frame->sample_frames == 0 ||
+                    frame->sample_frames > audyn_frame_pool_frame_capacity(ctx->pool)) {
+                    frame->sample_frames = audyn_frame_pool_frame_capacity(ctx->pool);
+                }
+
+                if (submit_frame(ctx, frame) != 0) {
+                    LOG_ERROR("Worker: write failed");
+                    ctx->status = -1;
+                    break;
+                }
+            }
+            continue;
+        }
+
+        /* Take the rest of the burst that is already queued */
+        const uint32_t n = 1u + audyn_audio_queue_pop_bulk(ctx->queue, burst + 1,
+                                                           WORKER_BURST - 1);
+        last_audio_ns = monotonic_ns();
+        audyn_metrics_count(AUDYN_CTR_FRAMES_CONSUMED, n);
+
+        audyn_audio_frame_t *frames[WORKER_BURST];
+        int rc = 0;
+        for (uint32_t i = 0; i < n; i++) {
+            frames[i] = (audyn_audio_frame_t *)burst[i];
+            if (frames[i]->queued_ns != 0 && last_audio_ns > frames[i]->queued_ns) {
+                audyn_metrics_record(AUDYN_STAGE_QUEUE_DWELL, last_audio_ns - frames[i]->queued_ns);
+            }
+            if (rc == 0) {
+                ctx->last_frame_frames = frames[i]->sample_frames;
+                rc = submit_frame(ctx, frames[i]);
+            }
+        }
+        audyn_frame_release_bulk(frames, n);
+        if (rc != 0) {
+            if (ctx->status == 0) {
+                LOG_ERROR("Worker: write failed");
+                ctx->status = -1;
+            }
+            break;
+        }
+    }
+
+    /* Drain remaining frames */
+    for (;;) {
+        void *burst[WORKER_BURST];
+        const uint32_t n = audyn_audio_queue_pop_bulk(ctx->queue, burst, WORKER_BURST);
+        if (n == 0) break;
+        audyn_audio_frame_t *frames[WORKER_BURST];
+        for (uint32_t i = 0; i < n; i++) {
+            frames[i] = (audyn_audio_frame_t *)burst[i];
+            (void)submit_frame(ctx, frames[i]);
+        }
+        audyn_frame_release_bulk(frames, n);
+    }
+    (void)flush_coalesced(ctx);
+
+    /* Close final files (waits for the encoder threads) */
+    close_current_sink(ctx);
+    prep_discard(ctx);
+    reap_retired(ctx, 1);
+    free(ctx->coalesce_buf);
+    ctx->coalesce_buf = NULL;
+    free(ctx->coalesce_raw);
+    ctx->coalesce_raw = NULL;
+    free(ctx->silence_buf);
+    ctx->silence_buf = NULL;
+
+    LOG_INFO("Worker finished: %lu files, %lu frames, %lu writes, %lu rotations",
+             (unsigned long)ctx->files_written,
+             (unsigned long)ctx->frames_written,
+             (unsigned long)ctx->sink_writes,
+             (unsigned long)ctx->rotations);
+
+    return NULL;
+}
+
+/* -------- PTP clock -------- */
+
+/* Hardware mode if a PHC device or interface is given, else software. */
+static audyn_ptp_clock_t *create_ptp_clock(const char *ptp_device,
+                                           const char *ptp_interface,
+                                           uint32_t phc_cache_ms)
+{
+    audyn_ptp_cfg_t pcfg;
+    memset(&pcfg, 0, sizeof(pcfg));
+    pcfg.phc_cache_ms = phc_cache_ms;
+
+    if (ptp_device) {
+        pcfg.mode = AUDYN_PTP_MODE_HARDWARE;
+        pcfg.phc_device = ptp_device;
+    } else if (ptp_interface) {
+        pcfg.mode = AUDYN_PTP_MODE_HARDWARE;
+        pcfg.interface = ptp_interface;
+    } else {
+        pcfg.mode = AUDYN_PTP_MODE_SOFTWARE;
+    }
+
+    return audyn_ptp_clock_create(&pcfg);
+}
+
+/* -------- Real-time mode -------- */
+
+/* Resolve --rt-numa auto against the capture interface, then enter RT mode. */
+static int enter_rt_mode(audyn_rt_cfg_t *cfg, int numa_auto, const char *ifname)
+{
+    if (numa_auto) {
+        cfg->numa_node = audyn_rt_nic_numa_node(ifname);
+        if (cfg->numa_node < 0) {
+            LOG_WARN("rt: NUMA node of %s unknown, pool memory not bound", ifname);
+        } else {
+            LOG_INFO("rt: %s is on NUMA node %d", ifname, cfg->numa_node);
+        }
+    }
+    return audyn_rt_init(cfg);
+}
+
+/* -------- Metrics -------- */
+
+/* Values gathered from the module stats for one publish */
+typedef struct metric_set {
+    audyn_metric_value_t v[AUDYN_METRICS_MAX_VALUES];
+    char names[AUDYN_METRICS_MAX_VALUES][AUDYN_METRICS_NAME_BYTES];
+    uint32_t n;
+} metric_set_t;
+
+static void metric_add(metric_set_t *ms, const char *prefix, const char *name, uint64_t value)
+{
+    if (ms->n >= AUDYN_METRICS_MAX_VALUES) return;
+    snprintf(ms->names[ms->n], AUDYN_METRICS_NAME_BYTES, "%s%s", prefix, name);
+    ms->v[ms->n].name = ms->names[ms->n];
+    ms->v[ms->n].value = value;
+    ms->n++;
+}
+
+static void metric_add_log(metric_set_t *ms)
+{
+    audyn_log_stats_t ls;
+    audyn_log_get_stats(&ls);
+    metric_add(ms, "", "log_errors", ls.error_count);
+    metric_add(ms, "", "log_dropped", ls.dropped_count);
+    metric_add(ms, "", "log_suppressed", ls.suppressed_count);
+}
+
+/* AES67 input counters (and its jitter buffer's, if any) */
+static void metric_add_aes(metric_set_t *ms, const char *prefix, const audyn_aes_input_t *in)
+{
+    audyn_aes_stats_t st;
+    audyn_aes_input_get_stats(in, &st);
+    metric_add(ms, prefix, "aes_packets_rx", st.packets_rx);
+    metric_add(ms, prefix, "aes_packets_dropped", st.packets_dropped);
+    metric_add(ms, prefix, "aes_discontinuities", st.discontinuities);
+    metric_add(ms, prefix, "aes_drops_pool", st.frames_dropped_pool);
+    metric_add(ms, prefix, "aes_drops_queue", st.frames_dropped_queue);
+    metric_add(ms, prefix, "aes_concealed", st.frames_concealed);
+    metric_add(ms, prefix, "aes_rx_syscalls", st.rx_syscalls);
+    metric_add(ms, prefix, "aes_rx_batch_full", st.rx_batch_full);
+    if (st.leg_packets_rx[1] != 0) {
+        metric_add(ms, prefix, "aes_leg_a_lost", st.leg_packets_lost[0]);
+        metric_add(ms, prefix, "aes_leg_b_lost", st.leg_packets_lost[1]);
+        metric_add(ms, prefix, "aes_duplicates", st.duplicates);
+    }
+
+    audyn_jb_stats_t jb;
+    if (audyn_aes_input_get_jb_stats(in, &jb) == 0) {
+        metric_add(ms, prefix, "jb_late", jb.packets_late);
+        metric_add(ms, prefix, "jb_lost", jb.packets_lost);
+        metric_add(ms, prefix, "jb_reordered", jb.packets_reordered);
+        metric_add(ms, prefix, "jb_overflows", jb.buffer_overflows);
+        metric_add(ms, prefix, "jb_depth_max", (uint64_t)(jb.max_depth > 0 ? jb.max_depth : 0));
+    }
+}
+
+static void metric_add_pw(metric_set_t *ms, const audyn_pw_input_t *in)
+{
+    audyn_pw_stats_t st;
+    audyn_pw_input_get_stats(in, &st);
+    metric_add(ms, "", "pw_callbacks", st.callbacks);
+    metric_add(ms, "", "pw_drops_pool", st.drops_pool);
+    metric_add(ms, "", "pw_drops_queue", st.drops_queue);
+    metric_add(ms, "", "pw_drops_empty", st.drops_empty);
+    metric_add(ms, "", "pw_splits", st.splits);
+}
+
+/* 1 when the next publish is due (every interval_ms of the main loop) */
+static int metrics_due(uint64_t *next_ns, uint32_t interval_ms)
+{
+    const uint64_t now = monotonic_ns();
+    if (now < *next_ns) return 0;
+    *next_ns = now + (uint64_t)interval_ms * 1000000ULL;
+    return 1;
+}
+
+/* Enable recording and create the --metrics-shm endpoint. */
+static audyn_metrics_shm_t *start_metrics(const char *name)
+{
+    if (audyn_metrics_init() != 0) {
+        return NULL;
+    }
+    return audyn_metrics_shm_create(name);
+}
+
+/* -------- Encoder pool -------- */
+
+/*
+ * Encoder pool for opus_streams Opus outputs. Returns 0 with *out = NULL
+ * when encoding stays in the workers, -1 if the pool could not start.
+ */
+static int create_encoder_pool(int requested, uint32_t opus_streams,
+                               audyn_encoder_pool_t **out)
+{
+    *out = NULL;
+    if (requested == 0 || opus_streams == 0) {
+        return 0;
+    }
+
+    uint32_t threads = (uint32_t)requested;
+    if (requested == AUDYN_ENC_THREADS_AUTO) {
+        long ncpu = sysconf(_SC_NPROCESSORS_ONLN);
+        threads = (ncpu > 0) ? (uint32_t)ncpu : 1u;
+        if (threads > opus_streams) threads = opus_streams;
+    }
+
+    *out = audyn_encoder_pool_create(threads);
+    return *out ? 0 : -1;
+}
+
+/* -------- Tee outputs -------- */
+
+/*
+ * --tee targets: extra outputs written from the same capture. In single-file
+ * mode each target is a file path; in archive and multi-stream mode it is
+ * "<suffix>[:<root>]", archived with the primary's layout, period and clock
+ * (root defaults to the primary's; in multi-stream mode <root>/<name>).
+ */
+typedef struct tee_opts {
+    int n;
+    const char *target[AUDYN_MAX_OUTPUTS - 1];
+    output_format_t format[AUDYN_MAX_OUTPUTS - 1];
+} tee_opts_t;
+
+/* Split "<suffix>[:<root>]"; *root is NULL when omitted. Returns 0 or -1. */
+static int parse_tee_target(const char *spec, char *suffix, size_t suffix_len,
+                            const char **root)
+{
+    const char *colon = strchr(spec, ':');
+    size_t n = colon ? (size_t)(colon - spec) : strlen(spec);
+
+    if (n == 0 || n >= suffix_len) return -1;
+    for (size_t i = 0; i < n; i++) {
+        if (!isalnum((unsigned char)spec[i])) return -1;
+    }
+    memcpy(suffix, spec, n);
+    suffix[n] = '\0';
+
+    *root = NULL;
+    if (colon) {
+        if (colon[1] == '\0') return -1;
+        *root = colon + 1;
+    }
+    return 0;
+}
+
+/* VOX segments are named <file_path minus extension>_NNN.<suffix> */
+static void set_vox_base_path(worker_output_t *o)
+{
+    const char *ext = strrchr(o->file_path, '.');
+    size_t base_len = ext ? (size_t)(ext - o->file_path) : strlen(o->file_path);
+    if (base_len >= sizeof(o->vox_base_path)) {
+        base_len = sizeof(o->vox_base_path) - 1;
+    }
+    memcpy(o->vox_base_path, o->file_path, base_len);
+    o->vox_base_path[base_len] = '\0';
+    o->vox_suffix = (o->format == OUTPUT_OPUS) ? "opus" : "wav";
+}
+
+/*
+ * Append the tee outputs to a worker whose out[0] is set up. acfg is the
+ * primary's archive config (NULL in single-file mode); each archive tee
+ * gets its own policy in policies[], owned by the caller. name is the
+ * stream name in multi-stream mode, else NULL.
+ * Returns 0, or -1 on error (logged).
+ */
+static int setup_tee_outputs(worker_ctx_t *w, const tee_opts_t *tees,
+                             const audyn_archive_cfg_t *acfg, const char *name,
+                             audyn_archive_policy_t **policies)
+{
+    for (int i = 0; i < tees->n; i++) {
+        worker_output_t *o = &w->out[w->n_outputs];
+        memset(o, 0, sizeof(*o));
+        o->format = tees->format[i];
+
+        if (!acfg) {
+            o->file_path = tees->target[i];
+            for (uint32_t k = 0; k < w->n_outputs; k++) {
+                if (!strcmp(w->out[k].file_path, o->file_path)) {
+                    LOG_ERROR("tee output '%s' is already an output", o->file_path);
+                    return -1;
+                }
+            }
+            LOG_INFO("Tee output: %s", o->file_path);
+        } else {
+            char suffix[16];
+            char root_buf[512];
+            const char *root = NULL;
+
+            if (parse_tee_target(tees->target[i], suffix, sizeof(suffix), &root) != 0) {
+                LOG_ERROR("Invalid tee target '%s'", tees->target[i]);
+                return -1;
+            }
+            if (!root) {
+                root = acfg->root_dir;
+            } else if (name) {
+                snprintf(root_buf, sizeof(root_buf), "%s/%s", root, name);
+                root = root_buf;
+            }
+            if (!strcmp(root, acfg->root_dir) && !strcasecmp(suffix, acfg->suffix)) {
+                LOG_ERROR("tee output '%s' would overwrite the primary archive",
+                          tees->target[i]);
+                return -1;
+            }
+
+            audyn_archive_cfg_t tcfg = *acfg;
+            tcfg.root_dir = root;
+            tcfg.suffix = suffix;
+
+            policies[i] = audyn_archive_policy_create(&tcfg);
+            if (!policies[i]) {
+                LOG_ERROR("archive_policy create failed for tee output '%s'",
+                          tees->target[i]);
+                return -1;
+            }
+            o->archive = policies[i];
+
+            if (name) {
+                LOG_INFO("[%s] tee -> %s (*.%s)", name, root, suffix);
+            } else {
+                LOG_INFO("Tee output: %s (*.%s)", root, suffix);
+            }
+        }
+
+        w->n_outputs++;
+    }
+
+    return 0;
+}
+
+/* -------- Worker setup (single- and multi-stream) -------- */
+
+/*
+ * Worker settings common to both modes. The level meter, PCM tap and VOX
+ * detector are single-stream only (--streams rejects them) and stay NULL
+ * in multi-stream mode. Shared objects are not owned.
+ */
+typedef struct worker_opts {
+    audyn_archive_clock_t clock;
+
+    uint32_t opus_bitrate;
+    int      opus_vbr;
+    int      opus_complexity;
+
+    uint32_t coalesce_ms;
+    audyn_file_writer_cfg_t writer_cfg;
+    uint32_t seek_index_ms;
+    audyn_wav_format_t wav_format;
+    audyn_wav_container_t wav_container;
+
+    const tee_opts_t *tees;
+    int loudness;                   /* --loudness sidecars */
+
+    audyn_encoder_pool_t *encoder_pool;
+    audyn_sink_helper_t *sink_helper;
+    audyn_ptp_clock_t *ptp_clk;
+
+    audyn_level_meter_t *level_meter;
+    uint32_t levels_interval_ms;
+    audyn_pcm_tap_t *tap;
+    audyn_vox_t *vox;
+} worker_opts_t;
+
+/* "[name] " in multi-stream mode, else "" */
+static void stream_tag(char *buf, size_t len, const char *name)
+{
+    if (name) {
+        snprintf(buf, len, "[%s] ", name);
+    } else {
+        buf[0] = '\0';
+    }
+}
+
+/*
+ * Create a frame pool (with S24LE raw buffers if raw_s24) and its queue.
+ * name is the stream name in multi-stream mode, else NULL.
+ * Returns 0, or -1 on error (logged); anything created is left in
+ * *pool / *q for the caller to destroy.
+ */
+static int create_pool_queue(uint32_t pcap, uint16_t channels, uint32_t fcap,
+                             uint32_t qcap, int raw_s24, const char *name,
+                             audyn_frame_pool_t **pool, audyn_audio_queue_t **q)
+{
+    char tag[72];
+    stream_tag(tag, sizeof(tag), name);
+
+    *pool = audyn_frame_pool_create(pcap, channels, fcap);
+    if (!*pool) {
+        LOG_ERROR("%sframe_pool create failed", tag);
+        return -1;
+    }
+    if (raw_s24 && audyn_frame_pool_enable_raw(*pool, 3) != 0) {
+        LOG_ERROR("%sframe_pool raw buffer allocation failed", tag);
+        return -1;
+    }
+
+    *q = audyn_audio_queue_create(qcap);
+    if (!*q) {
+        LOG_ERROR("%saudio_queue create failed", tag);
+        return -1;
+    }
+    if (audyn_audio_queue_enable_wakeup(*q) != 0) {
+        LOG_WARN("%saudio_queue wakeup unavailable, worker will poll", tag);
+    }
+    return 0;
+}
+
+/*
+ * Complete a worker whose pool, queue, out[0], sample_rate, channels and
+ * raw_s24 the caller has set: the shared settings from wo, the loudness
+ * meter (layout NULL or "" = default), the tee outputs and VOX segment
+ * naming. acfg and tee_archive are as for setup_tee_outputs(); name is
+ * the stream name in multi-stream mode, else NULL. The loudness meter is
+ * left in w->loudness for the caller to destroy.
+ * Returns 0, or -1 on error (logged).
+ */
+static int worker_setup(worker_ctx_t *w, const worker_opts_t *wo, const char *name,
+                        const char *loudness_layout, const audyn_archive_cfg_t *acfg,
+                        audyn_archive_policy_t **tee_archive)
+{
+    char tag[72];
+    stream_tag(tag, sizeof(tag), name);
+
+    w->archive = w->out[0].archive;
+    w->archive_clock = wo->clock;
+    w->n_outputs = 1;
+    w->opus_bitrate = wo->opus_bitrate;
+    w->opus_vbr = wo->opus_vbr;
+    w->opus_complexity = wo->opus_complexity;
+    w->writer_cfg = wo->writer_cfg;
+    w->seek_index_ms = wo->seek_index_ms;
+    w->encoder_pool = wo->encoder_pool;
+    w->sink_helper = wo->sink_helper;
+    w->wav_format = wo->wav_format;
+    w->wav_container = wo->wav_container;
+    w->ptp_clk = wo->ptp_clk;
+    w->stop_flag = (volatile int *)&g_stop;
+    w->level_meter = wo->level_meter;
+    w->tap = wo->tap;
+    w->vox = wo->vox;
+
+    /* Keep meter output at its configured rate */
+    w->coalesce_ms = wo->coalesce_ms;
+    if (wo->level_meter && w->coalesce_ms > wo->levels_interval_ms) {
+        w->coalesce_ms = wo->levels_interval_ms;
+    }
+
+    if (wo->loudness) {
+        w->loudness = audyn_loudness_create(w->channels, w->sample_rate);
+        if (!w->loudness) {
+            LOG_ERROR("%sloudness create failed", tag);
+            return -1;
+        }
+        audyn_loudness_layout_t ll;
+        if (loudness_layout && loudness_layout[0] &&
+            (audyn_loudness_parse_layout(loudness_layout, &ll) != 0 ||
+             audyn_loudness_set_layout(w->loudness, &ll) != 0)) {
+            LOG_ERROR("%sloudness layout '%s' does not fit %u channels",
+                      tag, loudness_layout, (unsigned)w->channels);
+            return -1;
+        }
+        if (!name) {
+            LOG_INFO("Loudness measurement enabled (EBU R128 sidecar per file)");
+        }
+    }
+
+    if (setup_tee_outputs(w, wo->tees, acfg, name, tee_archive) != 0) {
+        return -1;
+    }
+
+    /* Set up VOX base paths (remove extension for segment naming) */
+    if (w->vox && w->out[0].file_path) {
+        for (uint32_t o = 0; o < w->n_outputs; o++) {
+            set_vox_base_path(&w->out[o]);
+        }
+        w->vox_segment_number = 1;
+    }
+    return 0;
+}
+
+/* -------- Multi-stream mode -------- */
+
+/*
+ * One line of the --streams file. Keys not given on a line take the
+ * corresponding command-line value (-r, -c, -p, --pt, --spp, --archive-suffix).
+ */
+typedef struct stream_def {
+    char     name[64];
+    char     source_ip[64];
+    uint16_t port;
+    uint8_t  payload_type;
+    uint16_t samples_per_packet;
+    uint32_t sample_rate;
+    uint16_t channels;
+    uint16_t stream_channels;
+    uint16_t channel_offset;
+    uint32_t ssrc;
+    uint32_t jitter_ms;
+    char     archive_root[512];
+    char     suffix[16];
+    char     loudness_layout[64];
+} stream_def_t;
+
+/* Settings shared by every stream in multi-stream mode */
+typedef struct multi_opts {
+    worker_opts_t wo;               /* Per-stream worker settings */
+
+    audyn_archive_layout_t layout;
+    const char *archive_format;
+    uint32_t period;
+
+    uint32_t qcap;
+    uint32_t pcap;
+    uint32_t fcap;
+
+    uint32_t rcvbuf;
+    uint16_t rx_batch;
+    uint16_t rx_threads;
+    const char *interface;
+
+    int rt_strict;                  /* --rt-strict */
+
+    audyn_metrics_shm_t *metrics;   /* --metrics-shm endpoint, or NULL */
+    uint32_t metrics_interval_ms;
+} multi_opts_t;
+
+/* Per-stream runtime state */
+typedef struct stream_rt {
+    stream_def_t            def;
+    audyn_frame_pool_t     *pool;
+    audyn_audio_queue_t    *queue;
+    audyn_archive_policy_t *archive;
+    audyn_archive_policy_t *tee_archive[AUDYN_MAX_OUTPUTS - 1];
+    audyn_aes_input_t      *in;
+    worker_ctx_t            worker;
+    pthread_t               thread;
+    int                     worker_started;
+    int                     failure_reported;
+} stream_rt_t;
+
+static int stream_set_key(stream_def_t *d, const char *key, const char *val)
+{
+    uint32_t v32;
+
+    if (!strcmp(key, "name")) {
+        snprintf(d->name, sizeof(d->name), "%s", val);
+    } else if (!strcmp(key, "ip")) {
+        snprintf(d->source_ip, sizeof(d->source_ip), "%s", val);
+    } else if (!strcmp(key, "port")) {
+        return parse_u16(val, &d->port);
+    } else if (!strcmp(key, "pt")) {
+        return parse_u8(val, &d->payload_type);
+    } else if (!strcmp(key, "spp")) {
+        return parse_u16(val, &d->samples_per_packet);
+    } else if (!strcmp(key, "rate")) {
+        return parse_u32(val, &d->sample_rate);
+    } else if (!strcmp(key, "channels")) {
+        if (parse_u32(val, &v32) != 0 || v32 == 0 || v32 > AUDYN_MAX_CHANNELS) return -1;
+        d->channels = (uint16_t)v32;
+    } else if (!strcmp(key, "stream_channels")) {
+        return parse_u16(val, &d->stream_channels);
+    } else if (!strcmp(key, "offset")) {
+        return parse_u16(val, &d->channel_offset);
+    } else if (!strcmp(key, "ssrc")) {
+        return parse_u32(val, &d->ssrc);
+    } else if (!strcmp(key, "jitter_ms")) {
+        if (parse_u32(val, &v32) != 0 || v32 > 200) return -1;
+        d->jitter_ms = v32;
+    } else if (!strcmp(key, "root")) {
+        snprintf(d->archive_root, sizeof(d->archive_root), "%s", val);
+    } else if (!strcmp(key, "suffix")) {
+        snprintf(d->suffix, sizeof(d->suffix), "%s", val);
+    } else if (!strcmp(key, "loudness_layout")) {
+        audyn_loudness_layout_t ll;
+        if (strlen(val) >= sizeof(d->loudness_layout) ||
+            audyn_loudness_parse_layout(val, &ll) != 0) return -1;
+        snprintf(d->loudness_layout, sizeof(d->loudness_layout), "%s", val);
+    } else {
+        return -1;
+    }
+    return 0;
+}
+
+/*
+ * Parse a streams file. Format: one stream per line, whitespace-separated
+ * key=value pairs, '#' starts a comment:
+ *
+ *   name=studio1 ip=239.69.1.1 port=5004 root=/var/lib/audyn/studio1
+ *   name=madi-3  ip=239.69.2.1 stream_channels=64 offset=4 suffix=opus
+ *
+ * If root= is omitted, <archive_base>/<name> is used.
+ *
+ * Returns number of streams parsed, or -1 on error (message on stderr).
+ */
+static int parse_streams_file(const char *path, const stream_def_t *defaults,
+                              const char *archive_base,
+                              stream_def_t *out, int max)
+{
+    FILE *fp = fopen(path, "r");
+    if (!fp) {
+        fprintf(stderr, "Error: cannot open streams file '%s'\n", path);
+        return -1;
+    }
+
+    char line[1024];
+    int n = 0;
+    int lineno = 0;
+
+    while (fgets(line, sizeof(line), fp)) {
+        lineno++;
+
+        char *hash = strchr(line, '#');
+        if (hash) *hash = '\0';
+
+        char *save = NULL;
+        char *tok = strtok_r(line, " \t\r\n", &save);
+        if (!tok) continue;
+
+        if (n >= max) {
+            fprintf(stderr, "Error: %s:%d: too many streams (max %d)\n", path, lineno, max);
+            fclose(fp);
+            return -1;
+        }
+
+        stream_def_t *d = &out[n];
+        *d = *defaults;
+
+        for (; tok; tok = strtok_r(NULL, " \t\r\n", &save)) {
+            char *eq = strchr(tok, '=');
+            if (!eq || eq == tok || eq[1] == '\0') {
+                fprintf(stderr, "Error: %s:%d: expected key=value, got '%s'\n",
+                        path, lineno, tok);
+                fclose(fp);
+                return -1;
+            }
+            *eq = '\0';
+            if (stream_set_key(d, tok, eq + 1) != 0) {
+                fprintf(stderr, "Error: %s:%d: invalid %s=%s\n", path, lineno, tok, eq + 1);
+                fclose(fp);
+                return -1;
+            }
+        }
+
+        if (d->source_ip[0] == '\0') {
+            fprintf(stderr, "Error: %s:%d: ip= is required\n", path, lineno);
+            fclose(fp);
+            return -1;
+        }
+        if (d->name[0] == '\0') {
+            snprintf(d->name, sizeof(d->name), "stream%d", n + 1);
+        }
+        if (d->archive_root[0] == '\0') {
+            if (!archive_base) {
+                fprintf(stderr, "Error: %s:%d: root= is required without --archive-root\n",
+                        path, lineno);
+                fclose(fp);
+                return -1;
+            }
+            snprintf(d->archive_root, sizeof(d->archive_root), "%s/%s", archive_base, d->name);
+        }
+        if (d->sample_rate == 0 || d->sample_rate > AUDYN_MAX_SAMPLE_RATE) {
+            fprintf(stderr, "Error: %s:%d: sample rate must be 1-%u Hz\n",
+                    path, lineno, AUDYN_MAX_SAMPLE_RATE);
+            fclose(fp);
+            return -1;
+        }
+        if (d->channels > AUDYN_OPUS_MAX_CHANNELS &&
+            detect_output_format(d->suffix) == OUTPUT_OPUS) {
+            fprintf(stderr, "Error: %s:%d: Opus output supports 1-%u channels\n",
+                    path, lineno, AUDYN_OPUS_MAX_CHANNELS);
+            fclose(fp);
+            return -1;
+        }
+
+        n++;
+    }
+
+    fclose(fp);
+
+    if (n == 0) {
+        fprintf(stderr, "Error: no streams defined in '%s'\n", path);
+        return -1;
+    }
+    return n;
+}
+
+static int stream_setup(stream_rt_t *st, const multi_opts_t *mo)
+{
+    const stream_def_t *d = &st->def;
+    const worker_opts_t *wo = &mo->wo;
+
+    /* PCM24 WAV outputs write the L24 payload bytes directly; without an
+     * Opus output or loudness (and no meter or VOX in this mode) the float
+     * decode is skipped */
+    int wav_outputs = (detect_output_format(d->suffix) == OUTPUT_WAV);
+    int opus_outputs = !wav_outputs;
+    for (int i = 0; i < wo->tees->n; i++) {
+        if (wo->tees->format[i] == OUTPUT_WAV) wav_outputs++;
+        else opus_outputs++;
+    }
+    const int raw_s24 = (wav_outputs > 0 && wo->wav_format == AUDYN_WAV_PCM24);
+
+    if (opus_outputs > 0 && d->channels > AUDYN_OPUS_MAX_CHANNELS) {
+        LOG_ERROR("[%s] Opus output needs 1-%u channels (stream has %u)",
+                  d->name, AUDYN_OPUS_MAX_CHANNELS, d->channels);
+        return -1;
+    }
+
+    if (create_pool_queue(mo->pcap, d->channels, mo->fcap, mo->qcap, raw_s24,
+                          d->name, &st->pool, &st->queue) != 0) {
+        return -1;
+    }
+
+    audyn_archive_cfg_t acfg;
+    memset(&acfg, 0, sizeof(acfg));
+    acfg.root_dir = d->archive_root;
+    acfg.suffix = d->suffix;
+    acfg.layout = mo->layout;
+    acfg.custom_format = mo->archive_format;
+    acfg.rotation_period_sec = mo->period;
+    acfg.clock_source = wo->clock;
+    acfg.create_directories = 1;
+
+    st->archive = audyn_archive_policy_create(&acfg);
+    if (!st->archive) {
+        LOG_ERROR("[%s] archive_policy create failed", d->name);
+        return -1;
+    }
+
+    audyn_aes_input_cfg_t aescfg;
+    memset(&aescfg, 0, sizeof(aescfg));
+    aescfg.source_ip = d->source_ip;
+    aescfg.port = d->port;
+    aescfg.payload_type = d->payload_type;
+    aescfg.sample_rate = d->sample_rate;
+    aescfg.channels = d->channels;
+    aescfg.samples_per_packet = d->samples_per_packet;
+    aescfg.stream_channels = d->stream_channels;
+    aescfg.channel_offset = d->channel_offset;
+    aescfg.ssrc = d->ssrc;
+    aescfg.jitter_ms = d->jitter_ms;
+    aescfg.raw_s24 = raw_s24;
+    aescfg.raw_only = raw_s24 && opus_outputs == 0 && !wo->loudness;
+
+    st->in = audyn_aes_input_create(st->pool, st->queue, &aescfg);
+    if (!st->in) {
+        LOG_ERROR("[%s] AES67 input create failed", d->name);
+        return -1;
+    }
+    if (wo->ptp_clk) {
+        audyn_aes_input_set_ptp_clock(st->in, wo->ptp_clk);
+    }
+
+    worker_ctx_t *w = &st->worker;
+    memset(w, 0, sizeof(*w));
+    w->pool = st->pool;
+    w->queue = st->queue;
+    w->out[0].format = detect_output_format(d->suffix);
+    w->out[0].archive = st->archive;
+    w->sample_rate = d->sample_rate;
+    w->channels = d->channels;
+    w->raw_s24 = raw_s24;
+
+    return worker_setup(w, wo, d->name, d->loudness_layout, &acfg, st->tee_archive);
+}
+
+static void stream_teardown(stream_rt_t *st)
+{
+    if (st->worker_started) {
+        pthread_join(st->thread, NULL);
+        st->worker_started = 0;
+    }
+    if (st->in) audyn_aes_input_destroy(st->in);
+    audyn_loudness_destroy(st->worker.loudness);
+    if (st->archive) audyn_archive_policy_destroy(st->archive);
+    for (int i = 0; i < AUDYN_MAX_OUTPUTS - 1; i++) {
+        if (st->tee_archive[i]) audyn_archive_policy_destroy(st->tee_archive[i]);
+    }
+    if (st->queue) audyn_audio_queue_destroy(st->queue);
+    if (st->pool) audyn_frame_pool_destroy(st->pool);
+}
+
+/*
+ * Run many AES67 streams in one process: per-stream pool, queue, archive
+ * policy and worker thread, with all RTP reception done by a shared
+ * aes_mux (a few receive threads, one socket per UDP port).
+ */
+static int run_multi_stream(stream_def_t *defs, int n, const multi_opts_t *mo)
+{
+    int rc = 1;
+    audyn_aes_mux_t *mux = NULL;
+
+    stream_rt_t *streams = (stream_rt_t *)calloc((size_t)n, sizeof(*streams));
+    if (!streams) {
+        LOG_ERROR("Failed to allocate stream table");
+        return 1;
+    }
+
+    audyn_aes_mux_cfg_t mcfg;
+    memset(&mcfg, 0, sizeof(mcfg));
+    mcfg.rx_threads = mo->rx_threads;
+    mcfg.socket_rcvbuf = mo->rcvbuf;
+    mcfg.bind_interface = mo->interface;
+    mcfg.rx_batch = mo->rx_batch;
+
+    mux = audyn_aes_mux_create(&mcfg);
+    if (!mux) {
+        LOG_ERROR("aes_mux create failed");
+        goto cleanup;
+    }
+    if (mo->wo.ptp_clk) {
+        audyn_aes_mux_set_ptp_clock(mux, mo->wo.ptp_clk);
+    }
+
+    for (int i = 0; i < n; i++) {
+        streams[i].def = defs[i];
+        if (stream_setup(&streams[i], mo) != 0) goto cleanup;
+        if (audyn_aes_mux_add(mux, streams[i].in) != 0) goto cleanup;
+
+        LOG_INFO("[%s] %s:%u PT=%u SPP=%u rate=%u ch=%u -> %s (*.%s)",
+                 defs[i].name, defs[i].source_ip, defs[i].port, defs[i].payload_type,
+                 defs[i].samples_per_packet, defs[i].sample_rate, defs[i].channels,
+                 defs[i].archive_root, defs[i].suffix);
+    }
+
+    for (int i = 0; i < n; i++) {
+        if (pthread_create(&streams[i].thread, NULL, worker_main, &streams[i].worker) != 0) {
+            LOG_ERROR("[%s] worker thread create failed", streams[i].def.name);
+            goto cleanup;
+        }
+        streams[i].worker_started = 1;
+        (void)audyn_rt_thread(streams[i].thread, AUDYN_RT_ROLE_WORKER);
+    }
+
+    if (audyn_aes_mux_start(mux) != 0) {
+        LOG_ERROR("aes_mux start failed");
+        goto cleanup;
+    }
+
+    if (audyn_rt_report() > 0 && mo->rt_strict) {
+        LOG_ERROR("rt: --rt-strict: stopping");
+        goto cleanup;
+    }
+
+    LOG_INFO("Audyn running %d streams (Ctrl+C to stop)", n);
+
+    /* A failed stream is reported but does not stop the others */
+    uint64_t metrics_next_ns = 0;
+    while (!g_stop) {
+        usleep(50u * 1000u);
+
+        /* Per-stream values are prefixed "s<index>." (streams file order) */
+        if (mo->metrics && metrics_due(&metrics_next_ns, mo->metrics_interval_ms)) {
+            metric_set_t ms;
+            ms.n = 0;
+            metric_add_log(&ms);
+            for (int i = 0; i < n; i++) {
+                char prefix[16];
+                snprintf(prefix, sizeof(prefix), "s%d.", i);
+                metric_add_aes(&ms, prefix, streams[i].in);
+            }
+            audyn_metrics_shm_publish(mo->metrics, ms.v, ms.n);
+        }
+
+        for (int i = 0; i < n; i++) {
+            if (streams[i].worker.status != 0 && !streams[i].failure_reported) {
+                LOG_ERROR("[%s] worker error: %s", streams[i].def.name, streams[i].worker.error);
+                streams[i].failure_reported = 1;
+            }
+        }
+    }
+
+    LOG_INFO("Stopping...");
+    rc = 0;
+
+cleanup:
+    /* Stop reception before workers drain their queues */
+    if (mux) {
+        audyn_aes_mux_stop(mux);
+    }
+
+    g_stop = 1;
+    for (int i = 0; i < n; i++) {
+        stream_teardown(&streams[i]);
+        if (streams[i].worker.status != 0) rc = 1;
+    }
+
+    audyn_aes_mux_destroy(mux);
+    free(streams);
+    return rc;
+}
+
+/* -------- Main -------- */
+
+/* -------- Control channel -------- */
+
+/* Settings the control channel can read and change */
+typedef struct control_values {
+    audyn_vox_config_t vox;
+    uint32_t levels_interval_ms;
+    uint32_t opus_bitrate;
+    int opus_complexity;
+    uint32_t archive_period_sec;
+    int archive_layout;
+} control_values_t;
+
+typedef struct control_state {
+    audyn_control_t *chan;
+    worker_ctx_t *worker;
+    uint32_t can;                   /* WORKER_RECONF_* this run supports */
+    int custom_layout;              /* --archive-format given */
+    control_values_t cur;           /* In effect */
+    control_values_t next;          /* Handed to the worker, not yet applied */
+    int pending;                    /* Waiting for the worker */
+} control_state_t;
+
+static const char *vox_mode_name(audyn_vox_level_mode_t mode)
 {
-    if (!ctx->archive) {
-        return 0;  /* No rotation in single-file mode */
+    switch (mode) {
+    case AUDYN_VOX_LEVEL_PEAK:        return "peak";
+    case AUDYN_VOX_LEVEL_ANY_CHANNEL: return "any";
+    default:                          return "rms";
     }
+}
 
-    uint64_t now_ns = get_current_time_ns(ctx);
-
-    if (!audyn_archive_policy_should_rotate(ctx->archive, now_ns)) {
-        return 0;  /* No rotation needed */
+/* Reply with an error; messages are short fixed text, keys and numbers */
+static void __attribute__((format(printf, 2, 3)))
+control_error(control_state_t *cs, const char *fmt, ...)
+{
+    char msg[256];
+    va_list ap;
+    va_start(ap, fmt);
+    vsnprintf(msg, sizeof(msg), fmt, ap);
+    va_end(ap);
+
+    /* Echoed user text must not break the JSON string */
+    for (char *p = msg; *p; p++) {
+        if (*p == '"' || *p == '\\' || (unsigned char)*p < 0x20) *p = '\'';
     }
+    audyn_control_reply(cs->chan, "{\"type\":\"control\",\"ok\":false,\"error\":\"%s\"}", msg);
+}
 
-    /* Close current file if open */
-    if (ctx->wav_sink || ctx->opus_sink) {
-        LOG_INFO("Rotating archive file");
-        close_current_sink(ctx);
-        ctx->rotations++;
+/* Reply with every setting this run can change */
+static void control_report(control_state_t *cs)
+{
+    const control_values_t *v = &cs->cur;
+    char buf[512];                  /* Well above the longest report */
+    int n = 0;
+
+    if (cs->can & WORKER_RECONF_VOX) {
+        n += snprintf(buf + n, sizeof(buf) - (size_t)n,
+                      ",\"vox_threshold\":%.1f,\"vox_release\":%.1f,\"vox_detection\":%u,"
+                      "\"vox_hangover\":%u,\"vox_preroll\":%u,\"vox_level\":\"%s\"",
+                      v->vox.threshold_db, v->vox.release_db, v->vox.detection_ms,
+                      v->vox.hangover_ms, v->vox.preroll_ms, vox_mode_name(v->vox.mode));
+    }
+    if (cs->can & WORKER_RECONF_LEVELS) {
+        n += snprintf(buf + n, sizeof(buf) - (size_t)n,
+                      ",\"levels_interval\":%u", v->levels_interval_ms);
+    }
+    if (cs->can & WORKER_RECONF_OPUS) {
+        n += snprintf(buf + n, sizeof(buf) - (size_t)n,
+                      ",\"bitrate\":%u,\"complexity\":%d", v->opus_bitrate, v->opus_complexity);
+    }
+    if (cs->can & WORKER_RECONF_ARCHIVE) {
+        if (v->archive_period_sec > 0) {
+            n += snprintf(buf + n, sizeof(buf) - (size_t)n,
+                          ",\"archive_period\":%u", v->archive_period_sec);
+        }
+        n += snprintf(buf + n, sizeof(buf) - (size_t)n, ",\"archive_layout\":\"%s\"",
+                      audyn_archive_layout_to_string((audyn_archive_layout_t)v->archive_layout));
     }
 
-    /* Generate new path */
-    char path[1024];
-    if (audyn_archive_policy_next_path(ctx->archive, now_ns, path, sizeof(path)) != 0) {
-        snprintf(ctx->error, sizeof(ctx->error), "Failed to generate archive path");
+    audyn_control_reply(cs->chan, "{\"type\":\"control\",\"ok\":true,\"settings\":{%s}}",
+                        n > 0 ? buf + 1 : "");
+}
+
+/*
+ * Parse one key=value into v and mark its group in *what.
+ * Returns 0, or -1 after replying with the error.
+ */
+static int control_set_key(control_state_t *cs, control_values_t *v, uint32_t *what,
+                           const char *key, const char *val)
+{
+    uint32_t group;
+    if (!strncmp(key, "vox_", 4)) {
+        group = WORKER_RECONF_VOX;
+    } else if (!strcmp(key, "levels_interval")) {
+        group = WORKER_RECONF_LEVELS;
+    } else if (!strcmp(key, "bitrate") || !strcmp(key, "complexity")) {
+        group = WORKER_RECONF_OPUS;
+    } else if (!strncmp(key, "archive_", 8)) {
+        group = WORKER_RECONF_ARCHIVE;
+    } else {
+        control_error(cs, "unknown key %s", key);
         return -1;
     }
-
-    /* Open new file */
-    if (open_sink(ctx, path) != 0) {
+    if (!(cs->can & group)) {
+        control_error(cs, "%s does not apply to this recorder", key);
         return -1;
     }
 
-    /* Advance archive policy */
-    audyn_archive_policy_advance(ctx->archive);
+    uint32_t u = 0;
+    float f = 0.0f;
+
+    if (!strcmp(key, "vox_threshold")) {
+        if (parse_float(val, &f) != 0 ||
+            !(f >= AUDYN_VOX_THRESHOLD_MIN && f <= AUDYN_VOX_THRESHOLD_MAX)) {
+            control_error(cs, "vox_threshold must be %.0f to %.0f dB",
+                          AUDYN_VOX_THRESHOLD_MIN, AUDYN_VOX_THRESHOLD_MAX);
+            return -1;
+        }
+        v->vox.threshold_db = f;
+    } else if (!strcmp(key, "vox_release")) {
+        if (parse_float(val, &f) != 0 || !(f >= -100.0f && f <= 0.0f)) {
+            control_error(cs, "vox_release must be 0 (auto) or a negative dB level");
+            return -1;
+        }
+        v->vox.release_db = f;
+    } else if (!strcmp(key, "vox_detection")) {
+        if (parse_u32(val, &u) != 0 ||
+            u < AUDYN_VOX_DETECTION_MIN || u > AUDYN_VOX_DETECTION_MAX) {
+            control_error(cs, "vox_detection must be %u-%u ms",
+                          AUDYN_VOX_DETECTION_MIN, AUDYN_VOX_DETECTION_MAX);
+            return -1;
+        }
+        v->vox.detection_ms = u;
+    } else if (!strcmp(key, "vox_hangover")) {
+        if (parse_u32(val, &u) != 0 ||
+            u < AUDYN_VOX_HANGOVER_MIN || u > AUDYN_VOX_HANGOVER_MAX) {
+            control_error(cs, "vox_hangover must be %u-%u ms",
+                          AUDYN_VOX_HANGOVER_MIN, AUDYN_VOX_HANGOVER_MAX);
+            return -1;
+        }
+        v->vox.hangover_ms = u;
+    } else if (!strcmp(key, "vox_preroll")) {
+        if (parse_u32(val, &u) != 0 || u > AUDYN_VOX_PREROLL_MAX) {
+            control_error(cs, "vox_preroll must be 0-%u ms", AUDYN_VOX_PREROLL_MAX);
+            return -1;
+        }
+        v->vox.preroll_ms = u;
+    } else if (!strcmp(key, "vox_level")) {
+        if (!strcasecmp(val, "rms")) {
+            v->vox.mode = AUDYN_VOX_LEVEL_RMS;
+        } else if (!strcasecmp(val, "peak")) {
+            v->vox.mode = AUDYN_VOX_LEVEL_PEAK;
+        } else if (!strcasecmp(val, "any")) {
+            v->vox.mode = AUDYN_VOX_LEVEL_ANY_CHANNEL;
+        } else {
+            control_error(cs, "vox_level must be rms, peak or any");
+            return -1;
+        }
+    } else if (!strcmp(key, "levels_interval")) {
+        if (parse_u32(val, &u) != 0 ||
+            u < AUDYN_LEVELS_INTERVAL_MIN || u > AUDYN_LEVELS_INTERVAL_MAX) {
+            control_error(cs, "levels_interval must be %u-%u ms",
+                          AUDYN_LEVELS_INTERVAL_MIN, AUDYN_LEVELS_INTERVAL_MAX);
+            return -1;
+        }
+        /* Blocks are coalesced up to the startup interval */
+        if (u < cs->worker->coalesce_ms) {
+            control_error(cs, "levels_interval below %u ms needs a restart",
+                          cs->worker->coalesce_ms);
+            return -1;
+        }
+        v->levels_interval_ms = u;
+    } else if (!strcmp(key, "bitrate")) {
+        if (parse_u32(val, &u) != 0 ||
+            u < AUDYN_CLI_BITRATE_MIN || u > AUDYN_CLI_BITRATE_MAX) {
+            control_error(cs, "bitrate must be %u-%u bps",
+                          AUDYN_CLI_BITRATE_MIN, AUDYN_CLI_BITRATE_MAX);
+            return -1;
+        }
+        v->opus_bitrate = u;
+    } else if (!strcmp(key, "complexity")) {
+        if (parse_u32(val, &u) != 0 || u > 10) {
+            control_error(cs, "complexity must be 0-10");
+            return -1;
+        }
+        v->opus_complexity = (int)u;
+    } else if (!strcmp(key, "archive_period")) {
+        if (cs->cur.archive_period_sec == 0) {
+            control_error(cs, "archive_period needs rotation (restart to enable it)");
+            return -1;
+        }
+        if (parse_u32(val, &u) != 0 ||
+            u < AUDYN_ARCHIVE_MIN_ROTATION_SEC || u > AUDYN_ARCHIVE_MAX_ROTATION_SEC) {
+            control_error(cs, "archive_period must be %u-%u s",
+                          AUDYN_ARCHIVE_MIN_ROTATION_SEC, AUDYN_ARCHIVE_MAX_ROTATION_SEC);
+            return -1;
+        }
+        v->archive_period_sec = u;
+    } else if (!strcmp(key, "archive_layout")) {
+        int layout = audyn_archive_layout_from_string(val);
+        if (layout < 0 || (layout == AUDYN_ARCHIVE_LAYOUT_CUSTOM && !cs->custom_layout)) {
+            control_error(cs, "archive_layout must be flat, hierarchy, combo, dailydir or "
+                              "accurate%s", cs->custom_layout ? " or custom" : "");
+            return -1;
+        }
+        v->archive_layout = layout;
+    } else {
+        control_error(cs, "unknown key %s", key);
+        return -1;
+    }
 
+    *what |= group;
     return 0;
 }
 
-static void *worker_main(void *arg)
+/* set key=value ...: validate every key, then hand them over together */
+static void control_set(control_state_t *cs, char **words, int n)
 {
-    worker_ctx_t *ctx = (worker_ctx_t *)arg;
+    if (n < 2) {
+        control_error(cs, "set needs key=value arguments");
+        return;
+    }
 
-    /* Initial file open */
-    if (ctx->vox) {
-        /* VOX mode - don't open file yet, wait for audio activity */
-        LOG_INFO("Worker: VOX mode, waiting for audio activity");
-    } else if (ctx->archive) {
-        /* Archive mode - open first file */
-        if (maybe_rotate(ctx) != 0) {
-            LOG_ERROR("Worker: failed to open initial archive file");
-            ctx->status = -1;
-            return NULL;
+    control_values_t v = cs->cur;
+    uint32_t what = 0;
+    for (int i = 1; i < n; i++) {
+        char *eq = strchr(words[i], '=');
+        if (!eq || eq == words[i]) {
+            control_error(cs, "expected key=value, got %.64s", words[i]);
+            return;
         }
-    } else if (ctx->single_file_path) {
-        /* Single file mode */
-        if (open_sink(ctx, ctx->single_file_path) != 0) {
-            LOG_ERROR("Worker: failed to open output file");
-            ctx->status = -1;
-            return NULL;
+        *eq = '\0';
+        if (control_set_key(cs, &v, &what, words[i], eq + 1) != 0) {
+            return;
         }
-    } else {
-        LOG_ERROR("Worker: no output configured");
-        ctx->status = -1;
-        return NULL;
     }
 
-    /* Main processing loop */
-    uint32_t silence_counter = 0;
-    const uint32_t silence_threshold = 50; /* Generate silence after 50ms of no data */
-
-    while (!*ctx->stop_flag) {
-        /* Check for rotation (archive mode only) */
-        if (ctx->archive && maybe_rotate(ctx) != 0) {
-            LOG_ERROR("Worker: rotation failed: %s", ctx->error);
-            ctx->status = -1;
-            break;
-        }
+    /* The worker only reads the request after the release below */
+    worker_reconf_t *r = &cs->worker->reconf;
+    r->what = what;
+    r->vox = v.vox;
+    r->levels_interval_ms = v.levels_interval_ms;
+    r->opus_bitrate = v.opus_bitrate;
+    r->opus_complexity = v.opus_complexity;
+    r->archive_period_sec = v.archive_period_sec != cs->cur.archive_period_sec ?
+                            v.archive_period_sec : 0;
+    r->archive_layout = v.archive_layout != cs->cur.archive_layout ? v.archive_layout : -1;
+
+    cs->next = v;
+    cs->pending = 1;
+    atomic_fetch_add_explicit(&cs->worker->reconf_req, 1u, memory_order_release);
+}
 
-        /* Get next frame from queue */
-        audyn_audio_frame_t *frame = (audyn_audio_frame_t *)audyn_audio_queue_pop(ctx->queue);
-        if (!frame) {
-            usleep(1000);
-            silence_counter++;
+/* Run one command line */
+static void control_command(control_state_t *cs, char *line)
+{
+    char *words[AUDYN_CONTROL_MAX_ARGS];
+    int n = audyn_control_split(line, words, AUDYN_CONTROL_MAX_ARGS);
+    if (n < 0) {
+        control_error(cs, "too many arguments (max %d)", AUDYN_CONTROL_MAX_ARGS - 1);
+        return;
+    }
+    if (n == 0) {
+        return;
+    }
 
-            /* Generate silence frame if no data for too long */
-            if (silence_counter >= silence_threshold) {
-                silence_counter = 0;
-
-                /* Acquire a frame for silence */
-                frame = audyn_frame_acquire(ctx->pool);
-                if (frame) {
-                    /* Fill with silence (zeros) */
-                    memset(frame->data, 0, frame->sample_frames * frame->channels * sizeof(float));
-
-                    /* Process through level meter */
-                    if (ctx->level_meter) {
-                        audyn_level_meter_process(ctx->level_meter, frame);
-                    }
-
-                    /* Write silence to sink */
-                    if (write_to_sink(ctx, frame) != 0) {
-                        LOG_ERROR("Worker: write failed");
-                        ctx->status = -1;
-                        audyn_frame_release(frame);
-                        break;
-                    }
-
-                    audyn_frame_release(frame);
-                }
-            }
-            continue;
+    if (!strcmp(words[0], "get")) {
+        if (n > 1) {
+            control_error(cs, "get takes no arguments");
+            return;
         }
+        control_report(cs);
+    } else if (!strcmp(words[0], "set")) {
+        control_set(cs, words, n);
+    } else {
+        control_error(cs, "unknown command %.32s (set, get)", words[0]);
+    }
+}
 
-        silence_counter = 0;
-
-        /* Process through level meter if enabled */
-        if (ctx->level_meter) {
-            audyn_level_meter_process(ctx->level_meter, frame);
+/*
+ * Main-loop step: reply to the request in flight once the worker has
+ * applied it, then run buffered commands up to the next 'set'.
+ */
+static void control_step(control_state_t *cs)
+{
+    if (cs->pending) {
+        worker_ctx_t *w = cs->worker;
+        if (atomic_load_explicit(&w->reconf_done, memory_order_acquire) !=
+            atomic_load_explicit(&w->reconf_req, memory_order_relaxed)) {
+            return;
         }
-
-        /* VOX processing */
-        if (ctx->vox) {
-            /* Get current levels from meter */
-            audyn_channel_level_t levels[2];
-            audyn_level_meter_get_levels(ctx->level_meter, levels);
-
-            float rms_l = levels[0].rms_db;
-            float rms_r = (ctx->channels > 1) ? levels[1].rms_db : rms_l;
-            float peak_l = levels[0].peak_db;
-            float peak_r = (ctx->channels > 1) ? levels[1].peak_db : peak_l;
-
-            /* Process through VOX */
-            const audyn_audio_frame_t *out_frames[256];
-            int n = audyn_vox_process(ctx->vox, frame, rms_l, rms_r, peak_l, peak_r,
-                                      out_frames, 256);
-
-            /* Check if we need to open a new segment file */
-            if (audyn_vox_should_open_file(ctx->vox)) {
-                if (open_vox_segment(ctx) != 0) {
-                    LOG_ERROR("Worker: VOX segment open failed");
-                    ctx->status = -1;
-                    audyn_frame_release(frame);
-                    break;
-                }
-            }
-
-            /* Write output frames (may include pre-roll) */
-            for (int i = 0; i < n; i++) {
-                /* Cast away const - we're just passing through, not modifying */
-                if (write_to_sink(ctx, (audyn_audio_frame_t *)out_frames[i]) != 0) {
-                    LOG_ERROR("Worker: write failed");
-                    ctx->status = -1;
-                    break;
-                }
-            }
-
-            /* Check if we need to close the segment file */
-            if (audyn_vox_should_close_file(ctx->vox)) {
-                LOG_INFO("Worker: VOX closing segment (silence detected)");
-                close_current_sink(ctx);
-            }
-
-            audyn_frame_release(frame);
-
-            if (ctx->status != 0) {
-                break;
-            }
+        cs->pending = 0;
+        if (w->reconf.status != 0) {
+            control_error(cs, "%s", w->reconf.error);
         } else {
-            /* Normal (non-VOX) write */
-            if (write_to_sink(ctx, frame) != 0) {
-                LOG_ERROR("Worker: write failed");
-                ctx->status = -1;
-                audyn_frame_release(frame);
-                break;
-            }
-            audyn_frame_release(frame);
+            cs->cur = cs->next;
+            control_report(cs);
         }
     }
 
-    /* Drain remaining frames */
-    while (1) {
-        audyn_audio_frame_t *frame = (audyn_audio_frame_t *)audyn_audio_queue_pop(ctx->queue);
-        if (!frame) break;
-        (void)write_to_sink(ctx, frame);
-        audyn_frame_release(frame);
+    char line[AUDYN_CONTROL_LINE_MAX];
+    int rc;
+    while (!cs->pending && (rc = audyn_control_next(cs->chan, line, sizeof(line))) != 0) {
+        if (rc < 0) {
+            control_error(cs, "line too long (max %d bytes)", AUDYN_CONTROL_LINE_MAX - 1);
+            continue;
+        }
+        control_command(cs, line);
     }
-
-    /* Close final file */
-    close_current_sink(ctx);
-
-    LOG_INFO("Worker finished: %lu files, %lu frames, %lu rotations",
-             (unsigned long)ctx->files_written,
-             (unsigned long)ctx->frames_written,
-             (unsigned long)ctx->rotations);
-
-    return NULL;
 }
 
-/* -------- Main -------- */
-
 int main(int argc, char **argv)
 {
     /* Defaults */
@@ -662,12 +2908,22 @@ int main(int argc, char **argv)
     uint8_t  payload_type = 96;
     uint16_t samples_per_packet = 48;
     uint32_t rcvbuf = 2097152;
+    uint16_t rx_batch = 0;             /* 0 = recvmsg(); mux picks its own */
+    uint32_t jitter_ms = 0;
+    uint32_t coalesce_ms = 0;
+    const char *streams_file = NULL;   /* Multi-stream mode */
+    uint16_t rx_threads = 2;
     const char *aes_interface = NULL;  /* Network interface for multicast */
+    char source_ip_b[64] = "";         /* ST 2022-7 second leg */
+    uint16_t port_b = 0;
+    const char *aes_interface_b = NULL;
+    int leg_threads = 0;
 
     /* PTP defaults */
     const char *ptp_device = NULL;
     const char *ptp_interface = NULL;
     int ptp_software = 0;
+    uint32_t ptp_cache_ms = 0;
 
     /* Archive defaults */
     const char *archive_root = NULL;
@@ -677,23 +2933,63 @@ int main(int argc, char **argv)
     const char *archive_clock_str = "localtime";
     uint32_t archive_period = 3600;
 
+    /* Extra outputs from the same capture */
+    tee_opts_t tees;
+    memset(&tees, 0, sizeof(tees));
+
+    /* WAV defaults */
+    audyn_wav_format_t wav_format = AUDYN_WAV_PCM16;
+    audyn_wav_container_t wav_container = AUDYN_WAV_RF64;
+
     /* Opus defaults */
     uint32_t opus_bitrate = 128000;
     int      opus_vbr = 1;
     int      opus_complexity = 5;
+    int      encoder_threads = AUDYN_ENC_THREADS_AUTO;
 
     /* Buffer defaults */
     uint32_t qcap = 1024;
     uint32_t pcap = 256;
     uint32_t fcap = 1024;
+    int fcap_set = 0;
+
+    /* PipeWire defaults */
+    audyn_pw_format_t pw_format = AUDYN_PW_FORMAT_F32;
+    uint32_t pw_quantum = 0;
+    int pw_opts = 0;
+
+    /* Storage defaults */
+    audyn_file_writer_cfg_t writer_cfg;
+    memset(&writer_cfg, 0, sizeof(writer_cfg));
+    writer_cfg.backend = AUDYN_FW_AUTO;
+
+    /* Real-time mode */
+    int rt_mode = 0;
+    int rt_strict = 0;
+    int rt_numa_auto = 0;
+    audyn_rt_cfg_t rt_cfg;
+    audyn_rt_cfg_defaults(&rt_cfg);
 
     /* Logging */
     int use_syslog = 0;
+    int log_async = 0;
     audyn_log_level_t lvl = AUDYN_LOG_INFO;
 
     /* Level metering */
     int enable_levels = 0;
+    int levels_json = 0;
+    const char *levels_shm_name = NULL;
     uint32_t levels_interval_ms = 33;
+    const char *metrics_shm_name = NULL;
+    uint32_t metrics_interval_ms = 1000;
+    const char *tap_shm_name = NULL;
+    uint32_t tap_ms = 2000;
+    uint32_t seek_index_ms = 0;
+    int enable_loudness = 0;
+    const char *loudness_layout = NULL;
+
+    /* Control channel */
+    int enable_control = 0;
 
     /* VOX defaults */
     int enable_vox = 0;
@@ -718,12 +3014,40 @@ int main(int argc, char **argv)
             if (parse_u16(argv[++i], &samples_per_packet) != 0) { usage(argv[0]); return 2; }
         } else if (!strcmp(argv[i], "--rcvbuf") && i + 1 < argc) {
             if (parse_u32(argv[++i], &rcvbuf) != 0) { usage(argv[0]); return 2; }
+        } else if (!strcmp(argv[i], "--rx-batch") && i + 1 < argc) {
+            if (parse_u16(argv[++i], &rx_batch) != 0 || rx_batch == 0 || rx_batch > 64) {
+                usage(argv[0]); return 2;
+            }
+        } else if (!strcmp(argv[i], "--jitter-ms") && i + 1 < argc) {
+            if (parse_u32(argv[++i], &jitter_ms) != 0 || jitter_ms > 200) {
+                usage(argv[0]); return 2;
+            }
         } else if (!strcmp(argv[i], "-r") && i + 1 < argc) {
             if (parse_u32(argv[++i], &rate) != 0) { usage(argv[0]); return 2; }
         } else if (!strcmp(argv[i], "-c") && i + 1 < argc) {
             uint32_t ch;
-            if (parse_u32(argv[++i], &ch) != 0 || ch > 2 || ch == 0) { usage(argv[0]); return 2; }
+            if (parse_u32(argv[++i], &ch) != 0 || ch > AUDYN_MAX_CHANNELS || ch == 0) {
+                usage(argv[0]); return 2;
+            }
             channels = (uint16_t)ch;
+        } else if (!strcmp(argv[i], "--wav-format") && i + 1 < argc) {
+            const char *f = argv[++i];
+            if (!strcmp(f, "pcm16")) wav_format = AUDYN_WAV_PCM16;
+            else if (!strcmp(f, "pcm24")) wav_format = AUDYN_WAV_PCM24;
+            else if (!strcmp(f, "float")) wav_format = AUDYN_WAV_FLOAT32;
+            else {
+                fprintf(stderr, "Error: Unknown WAV format '%s'\n", f);
+                return 2;
+            }
+        } else if (!strcmp(argv[i], "--wav-container") && i + 1 < argc) {
+            const char *c = argv[++i];
+            if (!strcmp(c, "riff")) wav_container = AUDYN_WAV_RIFF;
+            else if (!strcmp(c, "rf64")) wav_container = AUDYN_WAV_RF64;
+            else if (!strcmp(c, "bw64")) wav_container = AUDYN_WAV_BW64;
+            else {
+                fprintf(stderr, "Error: Unknown WAV container '%s'\n", c);
+                return 2;
+            }
         } else if (!strcmp(argv[i], "--bitrate") && i + 1 < argc) {
             if (parse_u32(argv[++i], &opus_bitrate) != 0) { usage(argv[0]); return 2; }
         } else if (!strcmp(argv[i], "--vbr")) {
@@ -734,22 +3058,77 @@ int main(int argc, char **argv)
             uint32_t c;
             if (parse_u32(argv[++i], &c) != 0 || c > 10) { usage(argv[0]); return 2; }
             opus_complexity = (int)c;
+        } else if (!strcmp(argv[i], "--encoder-threads") && i + 1 < argc) {
+            uint32_t t;
+            if (parse_u32(argv[++i], &t) != 0 || t > AUDYN_ENC_POOL_MAX_THREADS) {
+                usage(argv[0]); return 2;
+            }
+            encoder_threads = (int)t;
         } else if (!strcmp(argv[i], "-Q") && i + 1 < argc) {
             if (parse_u32(argv[++i], &qcap) != 0) { usage(argv[0]); return 2; }
         } else if (!strcmp(argv[i], "-P") && i + 1 < argc) {
             if (parse_u32(argv[++i], &pcap) != 0) { usage(argv[0]); return 2; }
         } else if (!strcmp(argv[i], "-F") && i + 1 < argc) {
             if (parse_u32(argv[++i], &fcap) != 0) { usage(argv[0]); return 2; }
+            fcap_set = 1;
+        } else if (!strcmp(argv[i], "--streams") && i + 1 < argc) {
+            streams_file = argv[++i];
+        } else if (!strcmp(argv[i], "--rx-threads") && i + 1 < argc) {
+            if (parse_u16(argv[++i], &rx_threads) != 0 || rx_threads == 0 ||
+                rx_threads > AUDYN_AES_MUX_MAX_THREADS) {
+                usage(argv[0]); return 2;
+            }
         } else if (!strcmp(argv[i], "--pipewire")) {
             input_src = INPUT_PIPEWIRE;
+        } else if (!strcmp(argv[i], "--pw-format") && i + 1 < argc) {
+            const char *v = argv[++i];
+            if (!strcmp(v, "f32")) pw_format = AUDYN_PW_FORMAT_F32;
+            else if (!strcmp(v, "s32")) pw_format = AUDYN_PW_FORMAT_S32;
+            else if (!strcmp(v, "s24_32")) pw_format = AUDYN_PW_FORMAT_S24_32;
+            else if (!strcmp(v, "s24")) pw_format = AUDYN_PW_FORMAT_S24;
+            else if (!strcmp(v, "s16")) pw_format = AUDYN_PW_FORMAT_S16;
+            else {
+                fprintf(stderr, "Error: --pw-format must be f32, s32, s24_32, s24 or s16\n");
+                return 2;
+            }
+            pw_opts = 1;
+        } else if (!strcmp(argv[i], "--pw-quantum") && i + 1 < argc) {
+            if (parse_u32(argv[++i], &pw_quantum) != 0 ||
+                pw_quantum < AUDYN_PW_QUANTUM_MIN || pw_quantum > AUDYN_PW_QUANTUM_MAX) {
+                fprintf(stderr, "Error: --pw-quantum must be %u-%u\n",
+                        AUDYN_PW_QUANTUM_MIN, AUDYN_PW_QUANTUM_MAX);
+                return 2;
+            }
+            pw_opts = 1;
         } else if (!strcmp(argv[i], "--interface") && i + 1 < argc) {
             aes_interface = argv[++i];
+        } else if (!strcmp(argv[i], "--redundant") && i + 1 < argc) {
+            const char *v = argv[++i];
+            const char *colon = strchr(v, ':');
+            size_t n = colon ? (size_t)(colon - v) : strlen(v);
+            if (n == 0 || n >= sizeof(source_ip_b) ||
+                (colon && (parse_u16(colon + 1, &port_b) != 0 || port_b == 0))) {
+                fprintf(stderr, "Error: --redundant expects <ip>[:<port>]\n");
+                return 2;
+            }
+            memcpy(source_ip_b, v, n);
+            source_ip_b[n] = '\0';
+        } else if (!strcmp(argv[i], "--interface-b") && i + 1 < argc) {
+            aes_interface_b = argv[++i];
+        } else if (!strcmp(argv[i], "--leg-threads")) {
+            leg_threads = 1;
         } else if (!strcmp(argv[i], "--ptp-device") && i + 1 < argc) {
             ptp_device = argv[++i];
         } else if (!strcmp(argv[i], "--ptp-interface") && i + 1 < argc) {
             ptp_interface = argv[++i];
         } else if (!strcmp(argv[i], "--ptp-software")) {
             ptp_software = 1;
+        } else if (!strcmp(argv[i], "--ptp-cache-ms") && i + 1 < argc) {
+            if (parse_u32(argv[++i], &ptp_cache_ms) != 0 || ptp_cache_ms == 0 ||
+                ptp_cache_ms > 1000) {
+                fprintf(stderr, "Error: --ptp-cache-ms must be 1-1000\n");
+                return 2;
+            }
         } else if (!strcmp(argv[i], "--archive-root") && i + 1 < argc) {
             archive_root = argv[++i];
         } else if (!strcmp(argv[i], "--archive-layout") && i + 1 < argc) {
@@ -758,20 +3137,140 @@ int main(int argc, char **argv)
             archive_format = argv[++i];
         } else if (!strcmp(argv[i], "--archive-suffix") && i + 1 < argc) {
             archive_suffix = argv[++i];
+        } else if (!strcmp(argv[i], "--tee") && i + 1 < argc) {
+            if (tees.n == AUDYN_MAX_OUTPUTS - 1) {
+                fprintf(stderr, "Error: At most %d --tee outputs\n", AUDYN_MAX_OUTPUTS - 1);
+                return 2;
+            }
+            tees.target[tees.n++] = argv[++i];
         } else if (!strcmp(argv[i], "--archive-clock") && i + 1 < argc) {
             archive_clock_str = argv[++i];
         } else if (!strcmp(argv[i], "--archive-period") && i + 1 < argc) {
             if (parse_u32(argv[++i], &archive_period) != 0) { usage(argv[0]); return 2; }
+        } else if (!strcmp(argv[i], "--rt")) {
+            rt_mode = 1;
+        } else if ((!strcmp(argv[i], "--rt-rx") || !strcmp(argv[i], "--rt-worker") ||
+                    !strcmp(argv[i], "--rt-encoder")) && i + 1 < argc) {
+            const audyn_rt_role_t role = !strcmp(argv[i], "--rt-rx") ? AUDYN_RT_ROLE_RX :
+                                         !strcmp(argv[i], "--rt-worker") ? AUDYN_RT_ROLE_WORKER :
+                                         AUDYN_RT_ROLE_ENCODER;
+            if (audyn_rt_parse_thread_spec(argv[i + 1], &rt_cfg.role[role]) != 0) {
+                fprintf(stderr, "Error: Invalid %s spec '%s' (expected "
+                                "[fifo|rr|other][:prio][@cpus])\n", argv[i], argv[i + 1]);
+                return 2;
+            }
+            i++;
+            rt_mode = 1;
+        } else if (!strcmp(argv[i], "--rt-hugepages")) {
+            rt_cfg.hugepages = 1;
+            rt_mode = 1;
+        } else if (!strcmp(argv[i], "--rt-numa") && i + 1 < argc) {
+            uint32_t node;
+            if (!strcmp(argv[++i], "auto")) {
+                rt_numa_auto = 1;
+            } else if (parse_u32(argv[i], &node) == 0 && node <= 63) {
+                rt_cfg.numa_node = (int)node;
+            } else {
+                fprintf(stderr, "Error: --rt-numa takes a node number 0-63 or 'auto'\n");
+                return 2;
+            }
+            rt_mode = 1;
+        } else if (!strcmp(argv[i], "--rt-strict")) {
+            rt_strict = 1;
+            rt_mode = 1;
         } else if (!strcmp(argv[i], "--syslog")) {
             use_syslog = 1;
+        } else if (!strcmp(argv[i], "--log-async")) {
+            log_async = 1;
         } else if (!strcmp(argv[i], "-v")) {
             lvl = AUDYN_LOG_DEBUG;
         } else if (!strcmp(argv[i], "-q")) {
             lvl = AUDYN_LOG_ERROR;
+        } else if (!strcmp(argv[i], "--coalesce-ms") && i + 1 < argc) {
+            if (parse_u32(argv[++i], &coalesce_ms) != 0 || coalesce_ms > 1000) {
+                usage(argv[0]); return 2;
+            }
+        } else if (!strcmp(argv[i], "--writer") && i + 1 < argc) {
+            if (audyn_file_writer_parse_backend(argv[++i], &writer_cfg.backend) != 0) {
+                fprintf(stderr, "Error: Unknown writer backend '%s'\n", argv[i]);
+                return 2;
+            }
+        } else if (!strcmp(argv[i], "--direct-io")) {
+            writer_cfg.direct = 1;
+        } else if (!strcmp(argv[i], "--sparse-silence")) {
+            writer_cfg.sparse = 1;
+        } else if (!strcmp(argv[i], "--sync-ms") && i + 1 < argc) {
+            if (parse_u32(argv[++i], &writer_cfg.sync_interval_ms) != 0 ||
+                writer_cfg.sync_interval_ms < AUDYN_SYNC_MS_MIN ||
+                writer_cfg.sync_interval_ms > AUDYN_SYNC_MS_MAX) {
+                fprintf(stderr, "Error: --sync-ms must be %u-%u\n",
+                        AUDYN_SYNC_MS_MIN, AUDYN_SYNC_MS_MAX);
+                return 2;
+            }
+            writer_cfg.durable = 1;
+        } else if (!strcmp(argv[i], "--sync-mb") && i + 1 < argc) {
+            uint32_t mb;
+            if (parse_u32(argv[++i], &mb) != 0 || mb == 0) { usage(argv[0]); return 2; }
+            writer_cfg.sync_bytes = (uint64_t)mb * 1024u * 1024u;
+            writer_cfg.durable = 1;
+        } else if (!strcmp(argv[i], "--seek-index") && i + 1 < argc) {
+            if (parse_u32(argv[++i], &seek_index_ms) != 0 ||
+                seek_index_ms < AUDYN_SEEK_MS_MIN || seek_index_ms > AUDYN_SEEK_MS_MAX) {
+                fprintf(stderr, "Error: --seek-index must be %u-%u\n",
+                        AUDYN_SEEK_MS_MIN, AUDYN_SEEK_MS_MAX);
+                return 2;
+            }
         } else if (!strcmp(argv[i], "--levels")) {
             enable_levels = 1;
+            levels_json = 1;
+        } else if (!strcmp(argv[i], "--levels-shm") && i + 1 < argc) {
+            levels_shm_name = argv[++i];
+            if (audyn_level_shm_check_name(levels_shm_name) != 0) {
+                fprintf(stderr, "Error: --levels-shm expects a name of 1-%d characters without '/'\n",
+                        AUDYN_LEVEL_SHM_NAME_MAX);
+                return 2;
+            }
+            enable_levels = 1;
         } else if (!strcmp(argv[i], "--levels-interval") && i + 1 < argc) {
             if (parse_u32(argv[++i], &levels_interval_ms) != 0) { usage(argv[0]); return 2; }
+        } else if (!strcmp(argv[i], "--tap-shm") && i + 1 < argc) {
+            tap_shm_name = argv[++i];
+            if (audyn_pcm_tap_check_name(tap_shm_name) != 0) {
+                fprintf(stderr, "Error: --tap-shm expects a name of 1-%d characters without '/'\n",
+                        AUDYN_PCM_TAP_NAME_MAX);
+                return 2;
+            }
+        } else if (!strcmp(argv[i], "--tap-ms") && i + 1 < argc) {
+            if (parse_u32(argv[++i], &tap_ms) != 0 ||
+                tap_ms < AUDYN_PCM_TAP_MS_MIN || tap_ms > AUDYN_PCM_TAP_MS_MAX) {
+                fprintf(stderr, "Error: --tap-ms must be %u-%u\n",
+                        AUDYN_PCM_TAP_MS_MIN, AUDYN_PCM_TAP_MS_MAX);
+                return 2;
+            }
+        } else if (!strcmp(argv[i], "--metrics-shm") && i + 1 < argc) {
+            metrics_shm_name = argv[++i];
+            if (audyn_metrics_shm_check_name(metrics_shm_name) != 0) {
+                fprintf(stderr, "Error: --metrics-shm expects a name of 1-%d characters without '/'\n",
+                        AUDYN_METRICS_SHM_NAME_MAX);
+                return 2;
+            }
+        } else if (!strcmp(argv[i], "--metrics-interval") && i + 1 < argc) {
+            if (parse_u32(argv[++i], &metrics_interval_ms) != 0 || metrics_interval_ms == 0) {
+                usage(argv[0]);
+                return 2;
+            }
+        } else if (!strcmp(argv[i], "--loudness")) {
+            enable_loudness = 1;
+        } else if (!strcmp(argv[i], "--loudness-layout") && i + 1 < argc) {
+            audyn_loudness_layout_t ll;
+            loudness_layout = argv[++i];
+            if (strlen(loudness_layout) >= sizeof(((stream_def_t *)0)->loudness_layout) ||
+                audyn_loudness_parse_layout(loudness_layout, &ll) != 0) {
+                fprintf(stderr, "Error: --loudness-layout: bad layout '%s'\n", loudness_layout);
+                return 2;
+            }
+        } else if (!strcmp(argv[i], "--control")) {
+            enable_control = 1;
         } else if (!strcmp(argv[i], "--vox")) {
             enable_vox = 1;
         } else if (!strcmp(argv[i], "--vox-threshold") && i + 1 < argc) {
@@ -796,25 +3295,57 @@ int main(int argc, char **argv)
         }
     }
 
-    /* Validate: must have either -o or --archive-root */
-    if (!out_path && !archive_root) {
+    /* Validate: must have either -o, --archive-root or --streams */
+    if (!out_path && !archive_root && !streams_file) {
         fprintf(stderr, "Error: Either -o <path> or --archive-root <dir> is required.\n\n");
         usage(argv[0]);
         return 2;
     }
 
+    if (streams_file) {
+        if (out_path || input_src != INPUT_AES67 || enable_levels || enable_vox ||
+            tap_shm_name || enable_control) {
+            fprintf(stderr, "Error: --streams cannot be combined with -o, --pipewire, --levels,\n"
+                            "       --levels-shm, --tap-shm, --vox or --control.\n\n");
+            usage(argv[0]);
+            return 2;
+        }
+    }
+
+    if (source_ip_b[0] || aes_interface_b || leg_threads) {
+        if (!source_ip_b[0] || input_src != INPUT_AES67 || streams_file) {
+            fprintf(stderr, "Error: --interface-b and --leg-threads need --redundant, which\n"
+                            "       applies to single-stream AES67 input only.\n");
+            return 2;
+        }
+        /* The jitter buffer is the merge window across legs */
+        if (jitter_ms == 0) jitter_ms = 10;
+    }
+
+    if (rt_numa_auto && !aes_interface) {
+        fprintf(stderr, "Error: --rt-numa auto needs --interface to find the NIC's node\n");
+        return 2;
+    }
+
     if (out_path && archive_root) {
         fprintf(stderr, "Error: Cannot use both -o and --archive-root.\n\n");
         usage(argv[0]);
         return 2;
     }
 
-    if (input_src == INPUT_AES67 && !source_ip) {
+    if (input_src == INPUT_AES67 && !source_ip && !streams_file) {
         fprintf(stderr, "Error: Source IP (-m) is required for AES67 input.\n\n");
         usage(argv[0]);
         return 2;
     }
 
+    if (pw_opts && input_src != INPUT_PIPEWIRE) {
+        fprintf(stderr, "Error: --pw-format and --pw-quantum require --pipewire\n");
+        return 2;
+    }
+    /* One pool frame per PipeWire cycle */
+    if (pw_quantum && !fcap_set) fcap = pw_quantum;
+
     if (qcap < 2) { fprintf(stderr, "Error: Queue capacity must be >= 2\n"); return 2; }
     if (pcap == 0) { fprintf(stderr, "Error: Pool frames must be > 0\n"); return 2; }
     if (fcap == 0) { fprintf(stderr, "Error: Frame capacity must be > 0\n"); return 2; }
@@ -855,6 +3386,11 @@ int main(int argc, char **argv)
             return 2;
         }
 
+        if (channels > 2) {
+            fprintf(stderr, "Error: VOX mode supports 1 or 2 channels.\n");
+            return 2;
+        }
+
         if (vox_threshold_db < AUDYN_VOX_THRESHOLD_MIN ||
             vox_threshold_db > AUDYN_VOX_THRESHOLD_MAX) {
             fprintf(stderr, "Error: VOX threshold must be %.0f to %.0f dB\n",
@@ -902,6 +3438,10 @@ int main(int argc, char **argv)
         fprintf(stderr, "Error: Only one of --ptp-device, --ptp-interface, --ptp-software allowed\n");
         return 2;
     }
+    if (ptp_cache_ms > 0 && !ptp_device && !ptp_interface) {
+        fprintf(stderr, "Error: --ptp-cache-ms requires --ptp-device or --ptp-interface\n");
+        return 2;
+    }
     if (ptp_opts > 0 && input_src != INPUT_AES67) {
         fprintf(stderr, "Error: PTP options only apply to AES67 input\n");
         return 2;
@@ -909,7 +3449,7 @@ int main(int argc, char **argv)
 
     /* Validate archive layout */
     int archive_layout = AUDYN_ARCHIVE_LAYOUT_FLAT;
-    if (archive_root) {
+    if (archive_root || streams_file) {
         archive_layout = audyn_archive_layout_from_string(archive_layout_str);
         if (archive_layout < 0) {
             fprintf(stderr, "Error: Unknown archive layout '%s'\n", archive_layout_str);
@@ -925,7 +3465,7 @@ int main(int argc, char **argv)
 
     /* Validate archive clock */
     int archive_clock = AUDYN_ARCHIVE_CLOCK_LOCALTIME;
-    if (archive_root) {
+    if (archive_root || streams_file) {
         archive_clock = audyn_archive_clock_from_string(archive_clock_str);
         if (archive_clock < 0) {
             fprintf(stderr, "Error: Unknown archive clock '%s'\n", archive_clock_str);
@@ -934,6 +3474,151 @@ int main(int argc, char **argv)
         }
     }
 
+    /* Validate tee targets */
+    uint32_t tee_opus = 0;
+    for (int t = 0; t < tees.n; t++) {
+        if (out_path) {
+            tees.format[t] = detect_output_format(get_suffix_from_path(tees.target[t]));
+        } else {
+            char suffix[16];
+            const char *root;
+            if (parse_tee_target(tees.target[t], suffix, sizeof(suffix), &root) != 0) {
+                fprintf(stderr, "Error: --tee expects <suffix>[:<root>] in archive mode, got '%s'\n",
+                        tees.target[t]);
+                return 2;
+            }
+            tees.format[t] = detect_output_format(suffix);
+        }
+        if (tees.format[t] == OUTPUT_OPUS) tee_opus++;
+    }
+
+    /* Worker settings for either mode; the shared objects are filled in
+     * once created */
+    worker_opts_t wo;
+    memset(&wo, 0, sizeof(wo));
+    wo.clock = (audyn_archive_clock_t)archive_clock;
+    wo.opus_bitrate = opus_bitrate;
+    wo.opus_vbr = opus_vbr;
+    wo.opus_complexity = opus_complexity;
+    wo.coalesce_ms = coalesce_ms;
+    wo.writer_cfg = writer_cfg;
+    wo.seek_index_ms = seek_index_ms;
+    wo.wav_format = wav_format;
+    wo.wav_container = wav_container;
+    wo.tees = &tees;
+    wo.loudness = enable_loudness;
+    wo.levels_interval_ms = levels_interval_ms;
+
+    /* --- Multi-stream mode (separate orchestration, returns here) --- */
+    if (streams_file) {
+        stream_def_t defaults;
+        memset(&defaults, 0, sizeof(defaults));
+        defaults.port = port;
+        defaults.payload_type = payload_type;
+        defaults.samples_per_packet = samples_per_packet;
+        defaults.sample_rate = rate;
+        defaults.channels = channels;
+        defaults.jitter_ms = jitter_ms;
+        snprintf(defaults.suffix, sizeof(defaults.suffix), "%s", archive_suffix);
+        if (loudness_layout) {
+            snprintf(defaults.loudness_layout, sizeof(defaults.loudness_layout),
+                     "%s", loudness_layout);
+        }
+
+        stream_def_t *defs = (stream_def_t *)calloc(AUDYN_AES_MUX_MAX_SESSIONS, sizeof(*defs));
+        if (!defs) {
+            fprintf(stderr, "Error: out of memory\n");
+            return 1;
+        }
+        int nstreams = parse_streams_file(streams_file, &defaults, archive_root,
+                                          defs, AUDYN_AES_MUX_MAX_SESSIONS);
+        if (nstreams < 0) {
+            free(defs);
+            return 2;
+        }
+
+        audyn_log_init(lvl, use_syslog);
+        if (log_async) {
+            (void)audyn_log_start_async();
+        }
+        if (install_signal_handlers() != 0) {
+            LOG_ERROR("Failed to install signal handlers.");
+            free(defs);
+            audyn_log_shutdown();
+            return 1;
+        }
+
+        LOG_INFO("Audyn starting: multi-stream (%d streams from %s, layout=%s period=%us)",
+                 nstreams, streams_file, archive_layout_str, archive_period);
+
+        multi_opts_t mo;
+        memset(&mo, 0, sizeof(mo));
+        mo.wo = wo;
+        mo.layout = (audyn_archive_layout_t)archive_layout;
+        mo.archive_format = archive_format;
+        mo.period = archive_period;
+        mo.qcap = qcap;
+        mo.pcap = pcap;
+        mo.fcap = fcap;
+        mo.rcvbuf = rcvbuf;
+        mo.rx_batch = rx_batch;
+        mo.rx_threads = rx_threads;
+        mo.interface = aes_interface;
+
+        uint32_t opus_streams = 0;
+        for (int s = 0; s < nstreams; s++) {
+            if (detect_output_format(defs[s].suffix) == OUTPUT_OPUS) opus_streams++;
+            opus_streams += tee_opus;
+        }
+
+        int mrc = 1;
+        int setup_ok = 1;
+        mo.rt_strict = rt_strict;
+        if (rt_mode && enter_rt_mode(&rt_cfg, rt_numa_auto, aes_interface) != 0) {
+            LOG_ERROR("Real-time mode setup failed");
+            setup_ok = 0;
+        }
+        mo.metrics_interval_ms = metrics_interval_ms;
+        if (setup_ok && metrics_shm_name) {
+            mo.metrics = start_metrics(metrics_shm_name);
+            if (!mo.metrics) {
+                LOG_ERROR("Metrics endpoint creation failed");
+                setup_ok = 0;
+            }
+        }
+        if (setup_ok && create_encoder_pool(encoder_threads, opus_streams, &mo.wo.encoder_pool) != 0) {
+            LOG_ERROR("Encoder pool creation failed");
+            setup_ok = 0;
+        }
+        if (setup_ok) {
+            mo.wo.sink_helper = audyn_sink_helper_create();
+            if (!mo.wo.sink_helper) {
+                LOG_ERROR("Sink helper creation failed");
+                setup_ok = 0;
+            }
+        }
+        if (setup_ok && (ptp_device || ptp_interface || ptp_software)) {
+            mo.wo.ptp_clk = create_ptp_clock(ptp_device, ptp_interface, ptp_cache_ms);
+            if (!mo.wo.ptp_clk) {
+                LOG_ERROR("PTP clock creation failed");
+                setup_ok = 0;
+            }
+        }
+        if (setup_ok) {
+            mrc = run_multi_stream(defs, nstreams, &mo);
+        }
+
+        /* Workers are gone: finish their handed-off files, then no lanes
+         * are left */
+        audyn_sink_helper_destroy(mo.wo.sink_helper);
+        audyn_encoder_pool_destroy(mo.wo.encoder_pool);
+        if (mo.wo.ptp_clk) audyn_ptp_clock_destroy(mo.wo.ptp_clk);
+        audyn_metrics_shm_destroy(mo.metrics);
+        free(defs);
+        audyn_log_shutdown();
+        return mrc;
+    }
+
     /* Determine output format */
     output_format_t out_fmt;
     if (archive_root) {
@@ -941,9 +3626,17 @@ int main(int argc, char **argv)
     } else {
         out_fmt = detect_output_format(get_suffix_from_path(out_path));
     }
+    if (channels > AUDYN_OPUS_MAX_CHANNELS && (out_fmt == OUTPUT_OPUS || tee_opus > 0)) {
+        fprintf(stderr, "Error: Opus output supports 1-%u channels; use WAV for %u channels\n",
+                AUDYN_OPUS_MAX_CHANNELS, channels);
+        return 2;
+    }
 
     /* --- Init logging & signals --- */
     audyn_log_init(lvl, use_syslog);
+    if (log_async) {
+        (void)audyn_log_start_async();
+    }
 
     if (install_signal_handlers() != 0) {
         LOG_ERROR("Failed to install signal handlers.");
@@ -971,7 +3664,8 @@ int main(int argc, char **argv)
     }
 
     LOG_DEBUG("Buffer config: queue=%u pool=%u frames=%u", qcap, pcap, fcap);
-    if (out_fmt == OUTPUT_OPUS) {
+    const uint32_t opus_outputs = (out_fmt == OUTPUT_OPUS ? 1u : 0u) + tee_opus;
+    if (opus_outputs > 0) {
         LOG_DEBUG("Opus config: bitrate=%u vbr=%d complexity=%d",
                   opus_bitrate, opus_vbr, opus_complexity);
     }
@@ -980,33 +3674,48 @@ int main(int argc, char **argv)
     audyn_frame_pool_t *pool = NULL;
     audyn_audio_queue_t *q = NULL;
     audyn_archive_policy_t *archive_policy = NULL;
+    audyn_archive_policy_t *tee_archive[AUDYN_MAX_OUTPUTS - 1] = { NULL };
+    audyn_archive_cfg_t acfg;
     audyn_ptp_clock_t *ptp_clk = NULL;
     audyn_level_meter_t *level_meter = NULL;
+    audyn_level_shm_t *level_shm = NULL;
+    audyn_metrics_shm_t *metrics_shm = NULL;
+    audyn_pcm_tap_t *pcm_tap = NULL;
+    audyn_control_t *control = NULL;
+    control_state_t ctl;
     audyn_vox_t *vox = NULL;
+    audyn_encoder_pool_t *encoder_pool = NULL;
+    audyn_sink_helper_t *sink_helper = NULL;
     audyn_aes_input_t *aes_in = NULL;
     audyn_pw_input_t *pw_in = NULL;
+    worker_ctx_t worker_ctx;
     pthread_t worker_thread;
     int worker_started = 0;
 
-    pool = audyn_frame_pool_create(pcap, channels, fcap);
-    if (!pool) {
-        LOG_ERROR("frame_pool create failed");
+    memset(&worker_ctx, 0, sizeof(worker_ctx));
+
+    if (rt_mode && enter_rt_mode(&rt_cfg, rt_numa_auto, aes_interface) != 0) {
+        LOG_ERROR("Real-time mode setup failed");
         audyn_log_shutdown();
         return 1;
     }
 
-    q = audyn_audio_queue_create(qcap);
-    if (!q) {
-        LOG_ERROR("audio_queue create failed");
-        audyn_frame_pool_destroy(pool);
+    /* PCM24 WAV from AES67 (L24) or PipeWire S24: input bytes go to the
+     * file(s) as-is */
+    const int wav_outputs = (out_fmt == OUTPUT_WAV ? 1 : 0) + tees.n - (int)tee_opus;
+    const int raw_s24 = ((input_src == INPUT_AES67 ||
+                          (input_src == INPUT_PIPEWIRE && pw_format == AUDYN_PW_FORMAT_S24)) &&
+                         wav_outputs > 0 && wav_format == AUDYN_WAV_PCM24);
+    if (create_pool_queue(pcap, channels, fcap, qcap, raw_s24, NULL, &pool, &q) != 0) {
+        if (q) audyn_audio_queue_destroy(q);
+        if (pool) audyn_frame_pool_destroy(pool);
         audyn_log_shutdown();
         return 1;
     }
 
     /* --- Create archive policy (if archive mode) --- */
+    memset(&acfg, 0, sizeof(acfg));
     if (archive_root) {
-        audyn_archive_cfg_t acfg;
-        memset(&acfg, 0, sizeof(acfg));
         acfg.root_dir = archive_root;
         acfg.suffix = archive_suffix;
         acfg.layout = (audyn_archive_layout_t)archive_layout;
@@ -1024,26 +3733,28 @@ int main(int argc, char **argv)
 
     /* --- Create PTP clock (if configured) --- */
     if (ptp_device || ptp_interface || ptp_software) {
-        audyn_ptp_cfg_t pcfg;
-        memset(&pcfg, 0, sizeof(pcfg));
-
-        if (ptp_device) {
-            pcfg.mode = AUDYN_PTP_MODE_HARDWARE;
-            pcfg.phc_device = ptp_device;
-        } else if (ptp_interface) {
-            pcfg.mode = AUDYN_PTP_MODE_HARDWARE;
-            pcfg.interface = ptp_interface;
-        } else {
-            pcfg.mode = AUDYN_PTP_MODE_SOFTWARE;
-        }
-
-        ptp_clk = audyn_ptp_clock_create(&pcfg);
+        ptp_clk = create_ptp_clock(ptp_device, ptp_interface, ptp_cache_ms);
         if (!ptp_clk) {
             LOG_ERROR("PTP clock creation failed");
             goto cleanup;
         }
     }
 
+    /* --- Create Opus encoder pool (if Opus output) --- */
+    if (create_encoder_pool(encoder_threads, opus_outputs, &encoder_pool) != 0) {
+        LOG_ERROR("Encoder pool creation failed");
+        goto cleanup;
+    }
+
+    /* --- Create sink helper (archive rotation off the worker) --- */
+    if (archive_root && !enable_vox) {
+        sink_helper = audyn_sink_helper_create();
+        if (!sink_helper) {
+            LOG_ERROR("Sink helper creation failed");
+            goto cleanup;
+        }
+    }
+
     /* --- Create level meter (if enabled) --- */
     if (enable_levels) {
         level_meter = audyn_level_meter_create(channels, rate, levels_interval_ms);
@@ -1051,9 +3762,36 @@ int main(int argc, char **argv)
             LOG_ERROR("level_meter create failed");
             goto cleanup;
         }
+        if (levels_shm_name) {
+            level_shm = audyn_level_shm_create(levels_shm_name, channels, rate,
+                                               levels_interval_ms);
+            if (!level_shm) {
+                LOG_ERROR("Level feed create failed");
+                goto cleanup;
+            }
+        }
+        /* With a shared-memory feed, JSON lines only on request */
+        audyn_level_meter_set_outputs(level_meter, levels_json || !level_shm, level_shm);
         LOG_INFO("Level metering enabled (interval=%ums)", levels_interval_ms);
     }
 
+    if (metrics_shm_name) {
+        metrics_shm = start_metrics(metrics_shm_name);
+        if (!metrics_shm) {
+            LOG_ERROR("Metrics endpoint creation failed");
+            goto cleanup;
+        }
+    }
+
+    /* --- Create live PCM tap (if enabled) --- */
+    if (tap_shm_name) {
+        pcm_tap = audyn_pcm_tap_create(tap_shm_name, rate, channels, tap_ms);
+        if (!pcm_tap) {
+            LOG_ERROR("PCM tap creation failed");
+            goto cleanup;
+        }
+    }
+
     /* --- Create VOX detector (if enabled) --- */
     if (enable_vox) {
         audyn_vox_config_t vcfg;
@@ -1077,39 +3815,25 @@ int main(int argc, char **argv)
     }
 
     /* --- Create worker context --- */
-    worker_ctx_t worker_ctx;
-    memset(&worker_ctx, 0, sizeof(worker_ctx));
+    wo.encoder_pool = encoder_pool;
+    wo.sink_helper = sink_helper;
+    wo.ptp_clk = ptp_clk;
+    wo.level_meter = level_meter;
+    wo.tap = pcm_tap;
+    wo.vox = vox;
+
     worker_ctx.pool = pool;
     worker_ctx.queue = q;
-    worker_ctx.archive = archive_policy;
-    worker_ctx.archive_clock = (audyn_archive_clock_t)archive_clock;
-    worker_ctx.single_file_path = out_path;
-    worker_ctx.format = out_fmt;
+    worker_ctx.out[0].format = out_fmt;
+    worker_ctx.out[0].archive = archive_policy;
+    worker_ctx.out[0].file_path = out_path;
     worker_ctx.sample_rate = rate;
     worker_ctx.channels = channels;
-    worker_ctx.opus_bitrate = opus_bitrate;
-    worker_ctx.opus_vbr = opus_vbr;
-    worker_ctx.opus_complexity = opus_complexity;
-    worker_ctx.ptp_clk = ptp_clk;
-    worker_ctx.stop_flag = (volatile int *)&g_stop;
-    worker_ctx.level_meter = level_meter;
-    worker_ctx.vox = vox;
-
-    /* Set up VOX base path (remove extension for segment naming) */
-    if (vox && out_path) {
-        const char *ext = strrchr(out_path, '.');
-        if (ext) {
-            size_t base_len = ext - out_path;
-            if (base_len >= sizeof(worker_ctx.vox_base_path)) {
-                base_len = sizeof(worker_ctx.vox_base_path) - 1;
-            }
-            strncpy(worker_ctx.vox_base_path, out_path, base_len);
-            worker_ctx.vox_base_path[base_len] = '\0';
-        } else {
-            strncpy(worker_ctx.vox_base_path, out_path, sizeof(worker_ctx.vox_base_path) - 1);
-        }
-        worker_ctx.vox_suffix = (out_fmt == OUTPUT_OPUS) ? "opus" : "wav";
-        worker_ctx.vox_segment_number = 1;
+    worker_ctx.raw_s24 = raw_s24;
+
+    if (worker_setup(&worker_ctx, &wo, NULL, loudness_layout,
+                     archive_root ? &acfg : NULL, tee_archive) != 0) {
+        goto cleanup;
     }
 
     /* --- Start worker thread --- */
@@ -1118,6 +3842,7 @@ int main(int argc, char **argv)
         goto cleanup;
     }
     worker_started = 1;
+    (void)audyn_rt_thread(worker_thread, AUDYN_RT_ROLE_WORKER);
 
     /* --- Create input --- */
     if (input_src == INPUT_AES67) {
@@ -1131,6 +3856,16 @@ int main(int argc, char **argv)
         aescfg.samples_per_packet = samples_per_packet;
         aescfg.socket_rcvbuf = rcvbuf;
         aescfg.bind_interface = aes_interface;
+        aescfg.rx_batch = rx_batch;
+        aescfg.jitter_ms = jitter_ms;
+        aescfg.source_ip_b = source_ip_b[0] ? source_ip_b : NULL;
+        aescfg.port_b = port_b;
+        aescfg.bind_interface_b = aes_interface_b;
+        aescfg.leg_threads = leg_threads;
+        aescfg.raw_s24 = raw_s24;
+        /* Floats are still needed for the meters, VOX, the tap and Opus outputs */
+        aescfg.raw_only = raw_s24 && !level_meter && !enable_loudness && !vox &&
+                          !pcm_tap && opus_outputs == 0;
 
         aes_in = audyn_aes_input_create(pool, q, &aescfg);
         if (!aes_in) {
@@ -1148,7 +3883,14 @@ int main(int argc, char **argv)
         }
 
     } else {
-        pw_in = audyn_pw_input_create(pool, q, rate, channels);
+        audyn_pw_input_cfg_t pwcfg;
+        memset(&pwcfg, 0, sizeof(pwcfg));
+        pwcfg.sample_rate = rate;
+        pwcfg.channels = channels;
+        pwcfg.format = pw_format;
+        pwcfg.quantum = pw_quantum;
+
+        pw_in = audyn_pw_input_create(pool, q, &pwcfg);
         if (!pw_in) {
             LOG_ERROR("PipeWire input create failed");
             goto cleanup;
@@ -1160,17 +3902,78 @@ int main(int argc, char **argv)
         }
     }
 
+    if (audyn_rt_report() > 0 && rt_strict) {
+        LOG_ERROR("rt: --rt-strict: stopping");
+        goto cleanup;
+    }
+
+    /* --- Control channel (if enabled) --- */
+    memset(&ctl, 0, sizeof(ctl));
+    int control_open = 0;
+    if (enable_control) {
+        control = audyn_control_create(STDIN_FILENO);
+        if (!control) {
+            LOG_ERROR("Control channel creation failed");
+            goto cleanup;
+        }
+        control_open = 1;
+        ctl.chan = control;
+        ctl.worker = &worker_ctx;
+        ctl.can = (vox ? WORKER_RECONF_VOX : 0u) |
+                  (level_meter ? WORKER_RECONF_LEVELS : 0u) |
+                  (opus_outputs > 0 ? WORKER_RECONF_OPUS : 0u) |
+                  (archive_policy ? WORKER_RECONF_ARCHIVE : 0u);
+        ctl.custom_layout = archive_format != NULL;
+        ctl.cur.vox.threshold_db = vox_threshold_db;
+        ctl.cur.vox.release_db = vox_release_db;
+        ctl.cur.vox.detection_ms = vox_detection_ms;
+        ctl.cur.vox.hangover_ms = vox_hangover_ms;
+        ctl.cur.vox.preroll_ms = vox_preroll_ms;
+        ctl.cur.vox.mode = vox_level_mode;
+        ctl.cur.vox.sample_rate = rate;
+        ctl.cur.vox.channels = channels;
+        ctl.cur.levels_interval_ms = levels_interval_ms;
+        ctl.cur.opus_bitrate = opus_bitrate;
+        ctl.cur.opus_complexity = opus_complexity;
+        ctl.cur.archive_period_sec = archive_policy ? archive_period : 0;
+        ctl.cur.archive_layout = archive_layout;
+        LOG_INFO("Control channel on stdin");
+    }
+
     LOG_INFO("Audyn running (Ctrl+C to stop)");
 
     /* --- Main loop --- */
+    uint64_t metrics_next_ns = 0;
     while (!g_stop) {
-        usleep(50u * 1000u);
+        /* Waits on stdin in place of the idle sleep; shorter while a
+         * request is with the worker */
+        const uint32_t wait_ms = ctl.pending ? 5u : 50u;
+        if (control_open) {
+            if (audyn_control_poll(control, wait_ms) < 0) {
+                LOG_INFO("Control: stdin closed, no further commands");
+                control_open = 0;
+            }
+        } else {
+            usleep(wait_ms * 1000u);
+        }
+        if (control) {
+            control_step(&ctl);
+        }
 
         /* Output level data even if no audio (shows silence) */
         if (level_meter) {
             audyn_level_meter_process(level_meter, NULL);
         }
 
+        if (metrics_shm && metrics_due(&metrics_next_ns, metrics_interval_ms)) {
+            metric_set_t ms;
+            ms.n = 0;
+            metric_add_log(&ms);
+            if (aes_in) metric_add_aes(&ms, "", aes_in);
+            if (pw_in) metric_add_pw(&ms, pw_in);
+            audyn_metrics_shm_publish(metrics_shm, ms.v, ms.n);
+        }
+
         /* Check worker status */
         if (worker_ctx.status != 0) {
             LOG_ERROR("Worker error: %s", worker_ctx.error);
@@ -1193,13 +3996,13 @@ cleanup:
         /* Log PipeWire capture statistics */
         audyn_pw_stats_t pw_stats;
         audyn_pw_input_get_stats(pw_in, &pw_stats);
-        LOG_INFO("PipeWire stats: captured=%lu callbacks=%lu drops(pool=%lu queue=%lu empty=%lu) truncations=%lu",
+        LOG_INFO("PipeWire stats: captured=%lu callbacks=%lu drops(pool=%lu queue=%lu empty=%lu) splits=%lu",
                  (unsigned long)pw_stats.frames_captured,
                  (unsigned long)pw_stats.callbacks,
                  (unsigned long)pw_stats.drops_pool,
                  (unsigned long)pw_stats.drops_queue,
                  (unsigned long)pw_stats.drops_empty,
-                 (unsigned long)pw_stats.truncations);
+                 (unsigned long)pw_stats.splits);
         audyn_pw_input_destroy(pw_in);
     }
 
@@ -1209,6 +4012,11 @@ cleanup:
         pthread_join(worker_thread, NULL);
     }
 
+    /* Files handed to the helper are finished before the pool goes: then
+     * no lane is left on it */
+    audyn_sink_helper_destroy(sink_helper);
+    audyn_encoder_pool_destroy(encoder_pool);
+
     /* Destroy PTP clock (after input is stopped) */
     if (ptp_clk) {
         audyn_ptp_clock_destroy(ptp_clk);
@@ -1219,16 +4027,24 @@ cleanup:
         audyn_level_meter_flush(level_meter);
         audyn_level_meter_destroy(level_meter);
     }
+    audyn_level_shm_destroy(level_shm);
+    audyn_metrics_shm_destroy(metrics_shm);
+    audyn_pcm_tap_destroy(pcm_tap);
+    audyn_loudness_destroy(worker_ctx.loudness);
+    audyn_control_destroy(control);
 
     /* Destroy VOX detector */
     if (vox) {
         audyn_vox_destroy(vox);
     }
 
-    /* Destroy archive policy */
+    /* Destroy archive policies */
     if (archive_policy) {
         audyn_archive_policy_destroy(archive_policy);
     }
+    for (int t = 0; t < AUDYN_MAX_OUTPUTS - 1; t++) {
+        if (tee_archive[t]) audyn_archive_policy_destroy(tee_archive[t]);
+    }
 
     /* Destroy core objects */
     if (q) audyn_audio_queue_destroy(q);
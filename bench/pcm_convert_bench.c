@@ -0,0 +1,442 @@
+/*
+ *  Audyn — Professional Audio Capture & Archival Engine
+ *
+ *  File:
+ *      pcm_convert_bench.c
+ *
+ *  Purpose:
+ *      Micro-benchmark for the PCM kernels (core/pcm_convert.c).
+ *
+ *      For a set of common AES67 packet layouts, compares the original
+ *      per-sample aes_input conversion loop (format branch per sample)
+ *      against every kernel family available on this CPU. Each kernel's
+ *      output is first checked bit-exact against the reference. L24
+ *      layouts also check the S24LE passthrough, the file encoders are
+ *      compared against the historical WAV conversion loop, and the host
+ *      PCM unpackers (PipeWire capture) against a per-sample loop.
+ *
+ *  Usage:
+ *      make bench
+ *      bench/pcm_convert_bench [iterations]
+ *
+ *  Copyright:
+ *      (c) 2026 B. Wynne
+ *
+ *  Author:
+ *      B. Wynne
+ *
+ *  License:
+ *      GPLv2 or later
+ */
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+
+#include "pcm_convert.h"
+
+#define BENCH_DEFAULT_ITERS 200000U
+#define BENCH_MAX_BYTES     (1024U * 32U * 3U)
+
+typedef struct bench_layout {
+    const char *label;
+    audyn_pcm_format_t fmt;
+    uint16_t stream_ch;
+    uint16_t ch_offset;
+    uint16_t out_ch;
+    uint32_t spp;
+} bench_layout_t;
+
+static const bench_layout_t layouts[] = {
+    { "L16  2ch  48spp",           AUDYN_PCM_L16,  2,  0, 2,  48 },
+    { "L24  2ch  48spp",           AUDYN_PCM_L24,  2,  0, 2,  48 },
+    { "L24  2ch   6spp (125us)",   AUDYN_PCM_L24,  2,  0, 2,   6 },
+    { "L24  8ch  48spp",           AUDYN_PCM_L24,  8,  0, 8,  48 },
+    { "L16  8ch  48spp",           AUDYN_PCM_L16,  8,  0, 8,  48 },
+    { "L24 8->2 off 4 48spp",      AUDYN_PCM_L24,  8,  4, 2,  48 },
+    { "L24 32->2 off 4 48spp",     AUDYN_PCM_L24, 32,  4, 2,  48 },
+    { "L16 32->2 off 4 48spp",     AUDYN_PCM_L16, 32,  4, 2,  48 },
+    { "L24 16->1 off 7 48spp",     AUDYN_PCM_L24, 16,  7, 1,  48 },
+    { "L24 32->8 off 8 48spp",     AUDYN_PCM_L24, 32,  8, 8,  48 },
+};
+
+static const audyn_pcm_isa_t isas[] = {
+    AUDYN_PCM_ISA_SCALAR, AUDYN_PCM_ISA_SSE4, AUDYN_PCM_ISA_AVX2, AUDYN_PCM_ISA_NEON
+};
+
+/* -------- Reference: pre-kernel aes_input conversion loop -------- */
+
+static inline uint16_t rd_be16(const uint8_t *p) {
+    return (uint16_t)((uint16_t)p[0] << 8) | (uint16_t)p[1];
+}
+
+static inline int32_t rd_be24s(const uint8_t *p) {
+    int32_t v = ((int32_t)p[0] << 16) | ((int32_t)p[1] << 8) | (int32_t)p[2];
+    if (v & 0x00800000) v |= (int32_t)0xFF000000;
+    return v;
+}
+
+__attribute__((noinline))
+static void reference_decode(const bench_layout_t *l, const uint8_t *p, float *out)
+{
+    const size_t bytes_per_sample = (l->fmt == AUDYN_PCM_L16) ? 2U : 3U;
+
+    for (uint32_t i = 0; i < l->spp; i++) {
+        for (uint32_t c = 0; c < l->out_ch; c++) {
+            size_t stream_idx = ((size_t)i * l->stream_ch + (size_t)(l->ch_offset + c)) * bytes_per_sample;
+            float outv;
+            if (l->fmt == AUDYN_PCM_L16) {
+                outv = (float)(int16_t)rd_be16(p + stream_idx) / 32768.0f;
+            } else {
+                outv = (float)rd_be24s(p + stream_idx) / 8388608.0f;
+            }
+            out[(size_t)i * l->out_ch + c] = outv;
+        }
+    }
+}
+
+/* -------- Helpers -------- */
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static void fill_payload(uint8_t *buf, size_t len)
+{
+    /* Deterministic pseudo-random bytes: covers full range and sign bits */
+    uint32_t x = 0x12345678U;
+    for (size_t i = 0; i < len; i++) {
+        x ^= x << 13; x ^= x >> 17; x ^= x << 5;
+        buf[i] = (uint8_t)x;
+    }
+}
+
+/* Pre-encoder wav_sink conversion (float -> S16LE) */
+__attribute__((noinline))
+static void reference_encode16(const float *in, uint8_t *out, size_t n)
+{
+    for (size_t i = 0; i < n; i++) {
+        float x = in[i];
+        if (x > 1.0f) x = 1.0f;
+        if (x < -1.0f) x = -1.0f;
+        int16_t v = (int16_t)(x * 32767.0f);
+        memcpy(out + 2 * i, &v, 2);
+    }
+}
+
+static void reference_extract(const bench_layout_t *l, const uint8_t *p, uint8_t *out)
+{
+    for (uint32_t i = 0; i < l->spp; i++) {
+        for (uint32_t c = 0; c < l->out_ch; c++) {
+            const uint8_t *s = p + ((size_t)i * l->stream_ch + l->ch_offset + c) * 3U;
+            *out++ = s[2];
+            *out++ = s[1];
+            *out++ = s[0];
+        }
+    }
+}
+
+static volatile float sink_val;
+static volatile uint8_t sink_byte;
+
+/* Encoder checks and timing over one 48-sample 8-channel block */
+static int bench_encoders(uint32_t iters, uint8_t *payload, float *out)
+{
+    const size_t n = 48U * 8U;
+    const size_t ne = n + 13U;                  /* Odd tail for the scalar fix-up */
+    float *in = malloc(ne * sizeof(float));
+    uint8_t *ref = malloc(ne * 4U);
+    uint8_t *enc_out = malloc(ne * 4U);
+    uint8_t *raw = malloc(ne * 3U);
+    int failures = 0;
+
+    if (!in || !ref || !enc_out || !raw) return 1;
+
+    /* Decoded L24 audio plus out-of-range values to exercise the clamp */
+    audyn_pcm_decoder_t dec;
+    audyn_pcm_decoder_init(&dec, AUDYN_PCM_L24, 1, 0, 1, AUDYN_PCM_ISA_SCALAR);
+    fill_payload(payload, ne * 3U);
+    audyn_pcm_decode(&dec, payload, in, (uint32_t)ne);
+    audyn_pcm_extract_s24le(&dec, payload, raw, (uint32_t)ne);
+    memcpy(out, in, ne * sizeof(float));
+    in[3] = 1.0f; in[17] = 1.5f; in[29] = -1.0f; in[40] = -3.0f; in[ne - 1] = 2.0f;
+
+    printf("\n%-26s %-22s %10s %8s\n", "encoder (384 samples)", "kernel", "ns/block", "speedup");
+
+    reference_encode16(in, ref, ne);
+    uint64_t t0 = now_ns();
+    for (uint32_t k = 0; k < iters; k++) {
+        reference_encode16(in, enc_out, n);
+        sink_byte = enc_out[k % n];
+    }
+    const double ref_ns = (double)(now_ns() - t0) / iters;
+    printf("%-26s %-22s %10.1f %8s\n", "S16LE", "reference", ref_ns, "1.00x");
+
+    const audyn_pcm_out_format_t fmts[] = { AUDYN_PCM_OUT_S16LE, AUDYN_PCM_OUT_S24LE };
+    for (size_t f = 0; f < 2; f++) {
+        audyn_pcm_encoder_t base;
+        audyn_pcm_encoder_init(&base, fmts[f], AUDYN_PCM_ISA_SCALAR);
+        if (fmts[f] == AUDYN_PCM_OUT_S24LE) {
+            /* Decoded L24 must re-encode to the original samples */
+            audyn_pcm_encode(&base, out, ref, ne);
+            if (memcmp(ref, raw, ne * 3U) != 0) {
+                printf("%-26s %-22s %10s %8s\n", "S24LE round trip", base.name, "MISMATCH", "-");
+                failures++;
+            }
+            audyn_pcm_encode(&base, in, ref, ne);
+        }
+
+        const char *last_name = NULL;
+        for (size_t k = 0; k < sizeof(isas) / sizeof(isas[0]); k++) {
+            audyn_pcm_encoder_t enc;
+            audyn_pcm_encoder_init(&enc, fmts[f], isas[k]);
+            if (last_name && strcmp(last_name, enc.name) == 0) continue;
+            if (k > 0 && strstr(enc.name, "scalar")) continue;
+            last_name = enc.name;
+
+            const size_t bytes = ne * enc.bytes_per_sample;
+            memset(enc_out, 0xA5, bytes);
+            audyn_pcm_encode(&enc, in, enc_out, ne);
+            if (memcmp(enc_out, ref, bytes) != 0) {
+                printf("%-26s %-22s %10s %8s\n", f ? "S24LE" : "S16LE", enc.name, "MISMATCH", "-");
+                failures++;
+                continue;
+            }
+
+            t0 = now_ns();
+            for (uint32_t i = 0; i < iters; i++) {
+                audyn_pcm_encode(&enc, in, enc_out, n);
+                sink_byte = enc_out[i % n];
+            }
+            const double ns = (double)(now_ns() - t0) / iters;
+            printf("%-26s %-22s %10.1f %7.2fx\n", f ? "S24LE" : "S16LE", enc.name, ns,
+                   ns > 0.0 ? ref_ns / ns : 0.0);
+        }
+    }
+
+    free(in);
+    free(ref);
+    free(enc_out);
+    free(raw);
+    return failures;
+}
+
+/* Plain per-sample host PCM conversion, for the unpack kernels */
+__attribute__((noinline))
+static void reference_unpack(audyn_pcm_in_format_t fmt, const uint8_t *p, float *out, size_t n)
+{
+    for (size_t i = 0; i < n; i++) {
+        int32_t v;
+        switch (fmt) {
+            case AUDYN_PCM_IN_S16LE:
+                out[i] = (float)(int16_t)(p[2 * i] | (p[2 * i + 1] << 8)) / 32768.0f;
+                break;
+            case AUDYN_PCM_IN_S24LE:
+                v = p[3 * i] | (p[3 * i + 1] << 8) | (p[3 * i + 2] << 16);
+                if (v & 0x00800000) v -= 0x01000000;
+                out[i] = (float)v / 8388608.0f;
+                break;
+            case AUDYN_PCM_IN_S24_32LE:
+                v = p[4 * i] | (p[4 * i + 1] << 8) | (p[4 * i + 2] << 16);
+                if (v & 0x00800000) v -= 0x01000000;
+                out[i] = (float)v / 8388608.0f;
+                break;
+            default:
+                memcpy(&v, p + 4 * i, 4);
+                out[i] = (float)v / 2147483648.0f;
+                break;
+        }
+    }
+}
+
+/* Unpack checks and timing over one PipeWire-sized block (256 frames, 8ch) */
+static int bench_unpackers(uint32_t iters, uint8_t *payload, float *ref, float *out)
+{
+    const size_t n = 256U * 8U;
+    const size_t nu = n + 7U;                   /* Odd tail for the scalar fix-up */
+    int failures = 0;
+
+    static const struct {
+        const char *label;
+        audyn_pcm_in_format_t fmt;
+    } fmts[] = {
+        { "S16LE",    AUDYN_PCM_IN_S16LE },
+        { "S24LE",    AUDYN_PCM_IN_S24LE },
+        { "S24_32LE", AUDYN_PCM_IN_S24_32LE },
+        { "S32LE",    AUDYN_PCM_IN_S32LE },
+    };
+
+    printf("\n%-26s %-22s %10s %8s\n", "unpack (2048 samples)", "kernel", "ns/block", "speedup");
+
+    for (size_t f = 0; f < sizeof(fmts) / sizeof(fmts[0]); f++) {
+        audyn_pcm_unpacker_t base;
+        audyn_pcm_unpacker_init(&base, fmts[f].fmt, AUDYN_PCM_ISA_SCALAR);
+
+        /* Exact-sized copy so out-of-bounds reads show up under ASan */
+        const size_t len = nu * base.bytes_per_sample;
+        uint8_t *buf = malloc(len);
+        if (!buf) return failures + 1;
+        fill_payload(payload, len);
+        memcpy(buf, payload, len);
+
+        reference_unpack(fmts[f].fmt, buf, ref, nu);
+        uint64_t t0 = now_ns();
+        for (uint32_t k = 0; k < iters; k++) {
+            reference_unpack(fmts[f].fmt, buf, out, n);
+            sink_val = out[k % n];
+        }
+        const double ref_ns = (double)(now_ns() - t0) / iters;
+        printf("%-26s %-22s %10.1f %8s\n", fmts[f].label, "reference", ref_ns, "1.00x");
+
+        const char *last_name = NULL;
+        for (size_t k = 0; k < sizeof(isas) / sizeof(isas[0]); k++) {
+            audyn_pcm_unpacker_t up;
+            audyn_pcm_unpacker_init(&up, fmts[f].fmt, isas[k]);
+            if (last_name && strcmp(last_name, up.name) == 0) continue;
+            if (k > 0 && strstr(up.name, "scalar")) continue;
+            last_name = up.name;
+
+            memset(out, 0, nu * sizeof(float));
+            audyn_pcm_unpack(&up, buf, out, nu);
+            if (memcmp(out, ref, nu * sizeof(float)) != 0) {
+                printf("%-26s %-22s %10s %8s\n", fmts[f].label, up.name, "MISMATCH", "-");
+                failures++;
+                continue;
+            }
+
+            t0 = now_ns();
+            for (uint32_t i = 0; i < iters; i++) {
+                audyn_pcm_unpack(&up, buf, out, n);
+                sink_val = out[i % n];
+            }
+            const double ns = (double)(now_ns() - t0) / iters;
+            printf("%-26s %-22s %10.1f %7.2fx\n", fmts[f].label, up.name, ns,
+                   ns > 0.0 ? ref_ns / ns : 0.0);
+        }
+        free(buf);
+    }
+
+    return failures;
+}
+
+int main(int argc, char **argv)
+{
+    uint32_t iters = BENCH_DEFAULT_ITERS;
+    if (argc > 1) {
+        iters = (uint32_t)strtoul(argv[1], NULL, 10);
+        if (iters == 0) iters = BENCH_DEFAULT_ITERS;
+    }
+
+    uint8_t *payload = malloc(BENCH_MAX_BYTES);
+    float *ref = malloc(BENCH_MAX_BYTES * sizeof(float));
+    float *out = malloc(BENCH_MAX_BYTES * sizeof(float));
+    if (!payload || !ref || !out) {
+        fprintf(stderr, "pcm_convert_bench: allocation failed\n");
+        return 1;
+    }
+
+    printf("pcm_convert_bench: best ISA = %s, %u iterations per case\n\n",
+           audyn_pcm_isa_name(audyn_pcm_best_isa()), (unsigned)iters);
+    printf("%-26s %-22s %10s %8s\n", "layout", "kernel", "ns/packet", "speedup");
+
+    int failures = 0;
+
+    for (size_t li = 0; li < sizeof(layouts) / sizeof(layouts[0]); li++) {
+        const bench_layout_t *l = &layouts[li];
+        const size_t bps = (l->fmt == AUDYN_PCM_L16) ? 2U : 3U;
+        const size_t len = (size_t)l->spp * l->stream_ch * bps;
+        const size_t nout = (size_t)l->spp * l->out_ch;
+
+        /* Exact-sized copy so out-of-bounds reads show up under ASan */
+        uint8_t *pkt = malloc(len);
+        if (!pkt) return 1;
+        fill_payload(payload, len);
+        memcpy(pkt, payload, len);
+
+        reference_decode(l, pkt, ref);
+
+        uint64_t t0 = now_ns();
+        for (uint32_t n = 0; n < iters; n++) {
+            reference_decode(l, pkt, out);
+            sink_val = out[n % nout];
+        }
+        const double ref_ns = (double)(now_ns() - t0) / iters;
+        printf("%-26s %-22s %10.1f %8s\n", l->label, "reference", ref_ns, "1.00x");
+
+        const char *last_name = NULL;
+        for (size_t k = 0; k < sizeof(isas) / sizeof(isas[0]); k++) {
+            audyn_pcm_decoder_t dec;
+            if (audyn_pcm_decoder_init(&dec, l->fmt, l->stream_ch, l->ch_offset,
+                                       l->out_ch, isas[k]) != 0) {
+                fprintf(stderr, "pcm_convert_bench: init failed for %s\n", l->label);
+                return 1;
+            }
+            /* Unavailable ISAs fall back to an already measured kernel */
+            if (last_name && strcmp(last_name, dec.name) == 0) continue;
+            if (k > 0 && strstr(dec.name, "scalar")) continue;
+            last_name = dec.name;
+
+            memset(out, 0, nout * sizeof(float));
+            audyn_pcm_decode(&dec, pkt, out, l->spp);
+            if (memcmp(out, ref, nout * sizeof(float)) != 0) {
+                printf("%-26s %-22s %10s %8s\n", l->label, dec.name, "MISMATCH", "-");
+                failures++;
+                continue;
+            }
+
+            t0 = now_ns();
+            for (uint32_t n = 0; n < iters; n++) {
+                audyn_pcm_decode(&dec, pkt, out, l->spp);
+                sink_val = out[n % nout];
+            }
+            const double ns = (double)(now_ns() - t0) / iters;
+            printf("%-26s %-22s %10.1f %7.2fx\n", l->label, dec.name, ns,
+                   ns > 0.0 ? ref_ns / ns : 0.0);
+
+            if (l->fmt != AUDYN_PCM_L24) continue;
+
+            /* S24LE passthrough (reuses the float buffers as byte storage) */
+            uint8_t *xref = (uint8_t *)ref;
+            uint8_t *xout = (uint8_t *)out;
+            reference_extract(l, pkt, xref);
+            memset(xout, 0, nout * 3U);
+            audyn_pcm_extract_s24le(&dec, pkt, xout, l->spp);
+            if (memcmp(xout, xref, nout * 3U) != 0) {
+                printf("%-26s %-22s %10s %8s\n", l->label, "s24le passthrough", "MISMATCH", "-");
+                failures++;
+            } else {
+                t0 = now_ns();
+                for (uint32_t n = 0; n < iters; n++) {
+                    audyn_pcm_extract_s24le(&dec, pkt, xout, l->spp);
+                    sink_byte = xout[n % nout];
+                }
+                const double xns = (double)(now_ns() - t0) / iters;
+                printf("%-26s %-22s %10.1f %7.2fx\n", l->label, "  s24le passthrough", xns,
+                       xns > 0.0 ? ref_ns / xns : 0.0);
+            }
+            reference_decode(l, pkt, ref);
+        }
+
+        free(pkt);
+    }
+
+    failures += bench_encoders(iters, payload, out);
+    failures += bench_unpackers(iters / 8U, payload, ref, out);
+
+    free(payload);
+    free(ref);
+    free(out);
+
+    if (failures) {
+        printf("\n%d kernel(s) did not match the reference\n", failures);
+        return 1;
+    }
+    return 0;
+}
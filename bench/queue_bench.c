@@ -0,0 +1,623 @@
+/*
+ *  Audyn — Professional Audio Capture & Archival Engine
+ *
+ *  File:
+ *      queue_bench.c
+ *
+ *  Purpose:
+ *      Micro-benchmark for the SPSC audio queue (core/audio_queue.c) and
+ *      the frame pool free list (core/frame_pool.c).
+ *
+ *      Queue: the original layout (head and tail on one cache line, an
+ *      acquire load of the other side's index on every operation) against
+ *      the padded queue with cached indices, one item at a time and in
+ *      bursts of BENCH_BURST with push_bulk()/pop_bulk(). Reported as
+ *      the cost per item with both ends on one thread, items/s between two
+ *      threads and one-way latency (half a ping-pong round trip). Every
+ *      run checks that items arrive in order.
+ *
+ *      Pool: acquire + release cost on one thread for the original free
+ *      stack and the SPSC ring, then the ring in the capture pattern
+ *      (acquire on one thread, release in bursts on the other), checking
+ *      that no frame is handed out twice. The original stack is not run
+ *      across threads: its load/store updates of 'top' lose or duplicate
+ *      frames when both ends overlap.
+ *
+ *      With two or more CPUs the threads are pinned to the first two
+ *      allowed CPUs; on one CPU they share it and the cross-thread
+ *      figures mostly measure scheduler handoffs.
+ *
+ *  Usage:
+ *      make bench
+ *      bench/queue_bench [items]
+ *
+ *  Copyright:
+ *      (c) 2026 B. Wynne
+ *
+ *  Author:
+ *      B. Wynne
+ *
+ *  License:
+ *      GPLv2 or later
+ */
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include <sched.h>
+#include <time.h>
+
+#include "audio_queue.h"
+#include "frame_pool.h"
+
+#define BENCH_DEFAULT_ITEMS 2000000U
+#define BENCH_QUEUE_CAP     1024U
+#define BENCH_BURST         32U
+#define BENCH_POOL_FRAMES   256U
+
+/* -------- Reference: original audyn_audio_queue -------- */
+
+typedef struct ref_queue {
+    uint32_t cap;
+    void **slots;
+    _Atomic uint32_t head;
+    _Atomic uint32_t tail;
+} ref_queue_t;
+
+static ref_queue_t *ref_queue_create(uint32_t cap)
+{
+    ref_queue_t *q = calloc(1, sizeof(*q));
+    if (!q) return NULL;
+    q->cap = cap;
+    q->slots = calloc(cap, sizeof(void *));
+    if (!q->slots) { free(q); return NULL; }
+    return q;
+}
+
+static void ref_queue_destroy(ref_queue_t *q)
+{
+    if (!q) return;
+    free(q->slots);
+    free(q);
+}
+
+static inline uint32_t ref_next(uint32_t cur, uint32_t cap)
+{
+    cur++;
+    return (cur == cap) ? 0u : cur;
+}
+
+__attribute__((noinline))
+static int ref_queue_push(ref_queue_t *q, void *ptr)
+{
+    uint32_t tail = atomic_load_explicit(&q->tail, memory_order_relaxed);
+    uint32_t head = atomic_load_explicit(&q->head, memory_order_acquire);
+    uint32_t nt = ref_next(tail, q->cap);
+    if (nt == head) return 0;
+    q->slots[tail] = ptr;
+    atomic_store_explicit(&q->tail, nt, memory_order_release);
+    return 1;
+}
+
+__attribute__((noinline))
+static void *ref_queue_pop(ref_queue_t *q)
+{
+    uint32_t head = atomic_load_explicit(&q->head, memory_order_relaxed);
+    uint32_t tail = atomic_load_explicit(&q->tail, memory_order_acquire);
+    if (head == tail) return NULL;
+    void *ptr = q->slots[head];
+    atomic_store_explicit(&q->head, ref_next(head, q->cap), memory_order_release);
+    return ptr;
+}
+
+/* -------- Reference: original audyn_frame_pool free stack -------- */
+
+typedef struct ref_pool {
+    void **stack;
+    uint32_t capacity;
+    _Atomic uint32_t top;
+} ref_pool_t;
+
+__attribute__((noinline))
+static void *ref_pool_acquire(ref_pool_t *p)
+{
+    uint32_t t = atomic_load_explicit(&p->top, memory_order_acquire);
+    if (t == 0) return NULL;
+    void *f = p->stack[t - 1];
+    atomic_store_explicit(&p->top, t - 1, memory_order_relaxed);
+    return f;
+}
+
+__attribute__((noinline))
+static void ref_pool_release(ref_pool_t *p, void *f)
+{
+    uint32_t t = atomic_load_explicit(&p->top, memory_order_relaxed);
+    if (t >= p->capacity) return;
+    p->stack[t] = f;
+    atomic_store_explicit(&p->top, t + 1, memory_order_release);
+}
+
+/* -------- Queue under test -------- */
+
+typedef enum { Q_REF, Q_NEW, Q_NEW_BULK } queue_kind_t;
+
+static const char *const kind_names[] = { "original", "padded", "padded bulk" };
+
+typedef struct bench_queue {
+    queue_kind_t kind;
+    ref_queue_t *ref;
+    audyn_audio_queue_t *q;
+} bench_queue_t;
+
+static int bq_create(bench_queue_t *b, queue_kind_t kind)
+{
+    memset(b, 0, sizeof(*b));
+    b->kind = kind;
+    if (kind == Q_REF) {
+        b->ref = ref_queue_create(BENCH_QUEUE_CAP);
+        return b->ref ? 0 : -1;
+    }
+    b->q = audyn_audio_queue_create(BENCH_QUEUE_CAP);
+    return b->q ? 0 : -1;
+}
+
+static void bq_destroy(bench_queue_t *b)
+{
+    ref_queue_destroy(b->ref);
+    audyn_audio_queue_destroy(b->q);
+}
+
+/* -------- Helpers -------- */
+
+static int g_single_cpu = 0;
+static int g_cpu[2] = { -1, -1 };
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static inline void spin_wait(void)
+{
+    if (g_single_cpu) {
+        sched_yield();
+    } else {
+#if defined(__x86_64__) || defined(__i386__)
+        __builtin_ia32_pause();
+#elif defined(__aarch64__)
+        __asm__ __volatile__("yield");
+#endif
+    }
+}
+
+static void pick_cpus(void)
+{
+    cpu_set_t set;
+    int n = 0;
+
+    if (sched_getaffinity(0, sizeof(set), &set) != 0) {
+        g_single_cpu = 1;
+        return;
+    }
+    for (int c = 0; c < CPU_SETSIZE && n < 2; c++) {
+        if (CPU_ISSET(c, &set)) g_cpu[n++] = c;
+    }
+    g_single_cpu = (n < 2);
+}
+
+static void pin_self(int which)
+{
+    if (g_single_cpu || g_cpu[which] < 0) return;
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(g_cpu[which], &set);
+    (void)pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+}
+
+static _Atomic int g_go;
+
+/* -------- Throughput -------- */
+
+typedef struct tp_ctx {
+    bench_queue_t *bq;
+    uint32_t items;
+    int bad;
+} tp_ctx_t;
+
+static void *tp_producer(void *arg)
+{
+    tp_ctx_t *c = (tp_ctx_t *)arg;
+    bench_queue_t *b = c->bq;
+
+    pin_self(0);
+    while (!atomic_load_explicit(&g_go, memory_order_acquire)) spin_wait();
+
+    uintptr_t next = 1;
+    const uintptr_t end = (uintptr_t)c->items + 1;
+
+    while (next < end) {
+        if (b->kind == Q_NEW_BULK) {
+            void *batch[BENCH_BURST];
+            uint32_t n = 0;
+            while (n < BENCH_BURST && next + n < end) {
+                batch[n] = (void *)(next + n);
+                n++;
+            }
+            uint32_t done = audyn_audio_queue_push_bulk(b->q, batch, n);
+            next += done;
+            if (done == 0) spin_wait();
+        } else {
+            int ok = (b->kind == Q_REF) ? ref_queue_push(b->ref, (void *)next)
+                                        : audyn_audio_queue_push(b->q, (void *)next);
+            if (ok) next++;
+            else spin_wait();
+        }
+    }
+    return NULL;
+}
+
+static void *tp_consumer(void *arg)
+{
+    tp_ctx_t *c = (tp_ctx_t *)arg;
+    bench_queue_t *b = c->bq;
+
+    pin_self(1);
+    while (!atomic_load_explicit(&g_go, memory_order_acquire)) spin_wait();
+
+    uintptr_t expect = 1;
+    const uintptr_t end = (uintptr_t)c->items + 1;
+
+    while (expect < end) {
+        if (b->kind == Q_NEW_BULK) {
+            void *batch[BENCH_BURST];
+            uint32_t n = audyn_audio_queue_pop_bulk(b->q, batch, BENCH_BURST);
+            if (n == 0) { spin_wait(); continue; }
+            for (uint32_t i = 0; i < n; i++) {
+                if ((uintptr_t)batch[i] != expect) c->bad++;
+                expect++;
+            }
+        } else {
+            void *p = (b->kind == Q_REF) ? ref_queue_pop(b->ref) : audyn_audio_queue_pop(b->q);
+            if (!p) { spin_wait(); continue; }
+            if ((uintptr_t)p != expect) c->bad++;
+            expect++;
+        }
+    }
+    return NULL;
+}
+
+static int run_throughput(queue_kind_t kind, uint32_t items, double *mops)
+{
+    bench_queue_t b;
+    pthread_t tp, tc;
+    tp_ctx_t c = { &b, items, 0 };
+
+    if (bq_create(&b, kind) != 0) return -1;
+    atomic_store(&g_go, 0);
+    if (pthread_create(&tc, NULL, tp_consumer, &c) != 0) { bq_destroy(&b); return -1; }
+    if (pthread_create(&tp, NULL, tp_producer, &c) != 0) {
+        atomic_store(&g_go, 1);
+        c.items = 0;
+        pthread_join(tc, NULL);
+        bq_destroy(&b);
+        return -1;
+    }
+
+    const uint64_t t0 = now_ns();
+    atomic_store_explicit(&g_go, 1, memory_order_release);
+    pthread_join(tp, NULL);
+    pthread_join(tc, NULL);
+    const uint64_t dt = now_ns() - t0;
+
+    bq_destroy(&b);
+    *mops = (double)items * 1e3 / (double)dt;
+    return c.bad ? -1 : 0;
+}
+
+/* -------- Latency (ping-pong) -------- */
+
+typedef struct pp_ctx {
+    bench_queue_t *there;
+    bench_queue_t *back;
+    uint32_t rounds;
+} pp_ctx_t;
+
+static inline int bq_push1(bench_queue_t *b, void *p)
+{
+    return (b->kind == Q_REF) ? ref_queue_push(b->ref, p) : audyn_audio_queue_push(b->q, p);
+}
+
+static inline void *bq_pop1(bench_queue_t *b)
+{
+    if (b->kind == Q_NEW_BULK) {
+        void *p;
+        return audyn_audio_queue_pop_bulk(b->q, &p, 1) ? p : NULL;
+    }
+    return (b->kind == Q_REF) ? ref_queue_pop(b->ref) : audyn_audio_queue_pop(b->q);
+}
+
+static void *pp_echo(void *arg)
+{
+    pp_ctx_t *c = (pp_ctx_t *)arg;
+
+    pin_self(1);
+    for (uint32_t i = 0; i < c->rounds; i++) {
+        void *p;
+        while (!(p = bq_pop1(c->there))) spin_wait();
+        while (!bq_push1(c->back, p)) spin_wait();
+    }
+    return NULL;
+}
+
+static int run_latency(queue_kind_t kind, uint32_t rounds, double *one_way_ns)
+{
+    bench_queue_t there, back;
+    pthread_t te;
+    int bad = 0;
+
+    if (bq_create(&there, kind) != 0) return -1;
+    if (bq_create(&back, kind) != 0) { bq_destroy(&there); return -1; }
+
+    pp_ctx_t c = { &there, &back, rounds };
+    if (pthread_create(&te, NULL, pp_echo, &c) != 0) {
+        bq_destroy(&there);
+        bq_destroy(&back);
+        return -1;
+    }
+
+    pin_self(0);
+    const uint64_t t0 = now_ns();
+    for (uint32_t i = 0; i < rounds; i++) {
+        void *tok = (void *)(uintptr_t)(i + 1u);
+        void *p;
+        while (!bq_push1(&there, tok)) spin_wait();
+        while (!(p = bq_pop1(&back))) spin_wait();
+        if (p != tok) bad++;
+    }
+    const uint64_t dt = now_ns() - t0;
+
+    pthread_join(te, NULL);
+    bq_destroy(&there);
+    bq_destroy(&back);
+
+    *one_way_ns = (double)dt / (double)rounds / 2.0;
+    return bad ? -1 : 0;
+}
+
+/* -------- Single-thread cost -------- */
+
+/* Push then pop BENCH_BURST items per step: no cross-core traffic */
+static int run_single(queue_kind_t kind, uint32_t items, double *ns_per_item)
+{
+    bench_queue_t b;
+    void *batch[BENCH_BURST];
+    int bad = 0;
+
+    if (bq_create(&b, kind) != 0) return -1;
+
+    const uint32_t steps = items / BENCH_BURST;
+    uintptr_t next = 1, expect = 1;
+    const uint64_t t0 = now_ns();
+    for (uint32_t s = 0; s < steps; s++) {
+        if (kind == Q_NEW_BULK) {
+            for (uint32_t i = 0; i < BENCH_BURST; i++) batch[i] = (void *)(next++);
+            if (audyn_audio_queue_push_bulk(b.q, batch, BENCH_BURST) != BENCH_BURST) bad++;
+            uint32_t n = audyn_audio_queue_pop_bulk(b.q, batch, BENCH_BURST);
+            for (uint32_t i = 0; i < n; i++) {
+                if ((uintptr_t)batch[i] != expect++) bad++;
+            }
+        } else {
+            for (uint32_t i = 0; i < BENCH_BURST; i++) {
+                if (!bq_push1(&b, (void *)(next++))) bad++;
+            }
+            for (uint32_t i = 0; i < BENCH_BURST; i++) {
+                if ((uintptr_t)bq_pop1(&b) != expect++) bad++;
+            }
+        }
+    }
+    const uint64_t dt = now_ns() - t0;
+
+    bq_destroy(&b);
+    *ns_per_item = steps ? (double)dt / (double)(steps * BENCH_BURST) : 0.0;
+    return bad ? -1 : 0;
+}
+
+/* -------- Pool -------- */
+
+static double pool_ref_single(uint32_t items)
+{
+    static void *frames[BENCH_POOL_FRAMES];
+    static uint8_t objs[BENCH_POOL_FRAMES];
+    ref_pool_t p = { frames, BENCH_POOL_FRAMES, BENCH_POOL_FRAMES };
+
+    for (uint32_t i = 0; i < BENCH_POOL_FRAMES; i++) frames[i] = &objs[i];
+
+    const uint64_t t0 = now_ns();
+    for (uint32_t i = 0; i < items; i++) {
+        void *f = ref_pool_acquire(&p);
+        ref_pool_release(&p, f);
+    }
+    return (double)(now_ns() - t0) / (double)items;
+}
+
+static double pool_new_single(audyn_frame_pool_t *pool, uint32_t items)
+{
+    const uint64_t t0 = now_ns();
+    for (uint32_t i = 0; i < items; i++) {
+        audyn_audio_frame_t *f = audyn_frame_acquire(pool);
+        audyn_frame_release(f);
+    }
+    return (double)(now_ns() - t0) / (double)items;
+}
+
+typedef struct pool_ctx {
+    audyn_frame_pool_t *pool;
+    audyn_audio_queue_t *q;
+    uint32_t items;
+    _Atomic int done;
+    int dup;
+} pool_ctx_t;
+
+/* One in-use flag per frame, keyed by its (stable) data pointer slot */
+static _Atomic uint8_t g_in_use[BENCH_POOL_FRAMES];
+static float *g_data_base;
+static size_t g_data_stride;
+
+static unsigned frame_index(const audyn_audio_frame_t *f)
+{
+    return (unsigned)(((uintptr_t)f->data - (uintptr_t)g_data_base) / g_data_stride);
+}
+
+static void *pool_producer(void *arg)
+{
+    pool_ctx_t *c = (pool_ctx_t *)arg;
+
+    pin_self(0);
+    for (uint32_t i = 0; i < c->items; ) {
+        audyn_audio_frame_t *f = audyn_frame_acquire(c->pool);
+        if (!f) { spin_wait(); continue; }
+        if (atomic_exchange_explicit(&g_in_use[frame_index(f)], 1, memory_order_relaxed))
+            c->dup++;
+        while (!audyn_audio_queue_push(c->q, f)) spin_wait();
+        i++;
+    }
+    atomic_store_explicit(&c->done, 1, memory_order_release);
+    return NULL;
+}
+
+static void *pool_consumer(void *arg)
+{
+    pool_ctx_t *c = (pool_ctx_t *)arg;
+    uint32_t got = 0;
+
+    pin_self(1);
+    while (got < c->items) {
+        void *burst[BENCH_BURST];
+        audyn_audio_frame_t *frames[BENCH_BURST];
+        uint32_t n = audyn_audio_queue_pop_bulk(c->q, burst, BENCH_BURST);
+        if (n == 0) { spin_wait(); continue; }
+        for (uint32_t i = 0; i < n; i++) {
+            frames[i] = (audyn_audio_frame_t *)burst[i];
+            atomic_store_explicit(&g_in_use[frame_index(frames[i])], 0, memory_order_relaxed);
+        }
+        audyn_frame_release_bulk(frames, n);
+        got += n;
+    }
+    return NULL;
+}
+
+static int pool_new_pipeline(audyn_frame_pool_t *pool, uint32_t items, double *mops)
+{
+    pool_ctx_t c;
+    pthread_t tp, tc;
+
+    memset(&c, 0, sizeof(c));
+    c.pool = pool;
+    c.items = items;
+    c.q = audyn_audio_queue_create(BENCH_QUEUE_CAP);
+    if (!c.q) return -1;
+    for (uint32_t i = 0; i < BENCH_POOL_FRAMES; i++) atomic_store(&g_in_use[i], 0);
+
+    const uint64_t t0 = now_ns();
+    if (pthread_create(&tc, NULL, pool_consumer, &c) != 0) {
+        audyn_audio_queue_destroy(c.q);
+        return -1;
+    }
+    if (pthread_create(&tp, NULL, pool_producer, &c) != 0) {
+        /* Consumer cannot finish without a producer */
+        exit(1);
+    }
+    pthread_join(tp, NULL);
+    pthread_join(tc, NULL);
+    const uint64_t dt = now_ns() - t0;
+
+    audyn_audio_queue_destroy(c.q);
+    *mops = (double)items * 1e3 / (double)dt;
+    return c.dup ? -1 : 0;
+}
+
+/* -------- Main -------- */
+
+int main(int argc, char **argv)
+{
+    uint32_t items = BENCH_DEFAULT_ITEMS;
+    if (argc > 1) {
+        items = (uint32_t)strtoul(argv[1], NULL, 10);
+        if (items == 0) items = BENCH_DEFAULT_ITEMS;
+    }
+
+    pick_cpus();
+    /* Each ping-pong round trip is two handoffs; keep runs short on one CPU */
+    const uint32_t rounds = g_single_cpu ? items / 100u : items / 10u;
+
+    if (g_single_cpu) {
+        printf("queue_bench: 1 CPU available, threads share it (handoffs are context switches)\n");
+    } else {
+        printf("queue_bench: threads pinned to CPUs %d and %d\n", g_cpu[0], g_cpu[1]);
+    }
+    printf("queue capacity %u, burst %u, %u items, %u ping-pong rounds\n\n",
+           BENCH_QUEUE_CAP, BENCH_BURST, (unsigned)items, (unsigned)rounds);
+
+    int failed = 0;
+    double base_mops = 0.0;
+
+    printf("%-14s %14s %12s %8s %14s\n", "queue", "1-thread ns", "Mitems/s", "speedup",
+           "one-way ns");
+    for (int k = Q_REF; k <= Q_NEW_BULK; k++) {
+        double single = 0.0, mops = 0.0, lat = 0.0;
+        int rc = run_single((queue_kind_t)k, items, &single);
+        rc |= run_throughput((queue_kind_t)k, items, &mops);
+        rc |= run_latency((queue_kind_t)k, rounds ? rounds : 1u, &lat);
+        if (k == Q_REF) base_mops = mops;
+        printf("%-14s %14.2f %12.2f %7.2fx %14.1f%s\n", kind_names[k], single, mops,
+               base_mops > 0 ? mops / base_mops : 0.0, lat, rc ? "  ORDER MISMATCH" : "");
+        if (rc) failed = 1;
+    }
+
+    audyn_frame_pool_t *pool = audyn_frame_pool_create(BENCH_POOL_FRAMES, 1, 1);
+    if (!pool) {
+        fprintf(stderr, "queue_bench: frame pool create failed\n");
+        return 1;
+    }
+
+    /* Frame data slots are evenly spaced: find the spacing for frame_index() */
+    {
+        audyn_audio_frame_t *a = audyn_frame_acquire(pool);
+        audyn_audio_frame_t *b = audyn_frame_acquire(pool);
+        g_data_base = a->data < b->data ? a->data : b->data;
+        g_data_stride = (size_t)((a->data > b->data ? (uintptr_t)a->data - (uintptr_t)b->data
+                                                     : (uintptr_t)b->data - (uintptr_t)a->data));
+        audyn_frame_release(a);
+        audyn_frame_release(b);
+        /* Lowest data pointer among all frames */
+        audyn_audio_frame_t *all[BENCH_POOL_FRAMES];
+        uint32_t n = 0;
+        while (n < BENCH_POOL_FRAMES && (all[n] = audyn_frame_acquire(pool)) != NULL) {
+            if (all[n]->data < g_data_base) g_data_base = all[n]->data;
+            n++;
+        }
+        audyn_frame_release_bulk(all, n);
+    }
+
+    const double ref_ns = pool_ref_single(items);
+    const double new_ns = pool_new_single(pool, items);
+    double pipe_mops = 0.0;
+    const int prc = pool_new_pipeline(pool, items, &pipe_mops);
+
+    printf("\n%-28s %12s\n", "frame pool", "ns/op");
+    printf("%-28s %12.1f\n", "original stack, 1 thread", ref_ns);
+    printf("%-28s %12.1f\n", "SPSC ring, 1 thread", new_ns);
+    printf("%-28s %9.2f Mframes/s%s\n", "SPSC ring, 2 threads", pipe_mops,
+           prc ? "  DUPLICATE HANDOUT" : "");
+    if (prc) failed = 1;
+
+    audyn_frame_pool_destroy(pool);
+    return failed;
+}
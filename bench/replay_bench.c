@@ -0,0 +1,935 @@
+/*
+ *  Audyn — Professional Audio Capture & Archival Engine
+ *
+ *  File:
+ *      replay_bench.c
+ *
+ *  Purpose:
+ *      Replay harness and throughput benchmark for the AES67 capture
+ *      chain: RTP datagrams go through audyn_aes_input_feed() (the same
+ *      parse, merge, jitter buffer and decode path as a socket), the
+ *      frame pool and audio queue, to a worker thread that writes them
+ *      to a WAV sink, faster than real time.
+ *
+ *      Packets come from a libpcap capture (--pcap) or a synthetic L16 /
+ *      L24 generator with configurable channel count, packet time, loss
+ *      and reorder rates. Every packet is built (or loaded) before the
+ *      clock starts, and arrival stamps are virtual (capture time, or the
+ *      nominal packet time), so the jitter buffer plays out as it would
+ *      live regardless of replay speed. The generator is seeded: the
+ *      same options give the same packet sequence on every run.
+ *
+ *      By default the producer holds back while the audio queue is half
+ *      full, so the run measures the chain's capacity and should end with
+ *      no pool or queue drops. With --speed X packets are released at X
+ *      times real time instead, without backpressure, and the drop counts
+ *      show whether the chain keeps up at that rate.
+ *
+ *      Reported per case (median of --reps runs):
+ *          - packets/s through the whole chain and x real time
+ *          - input ns/packet (feed: parse, reorder, decode, queue push)
+ *          - sink ns/frame (worker: WAV conversion and write, release)
+ *          - frames out, concealed, pool / queue drops
+ *      With --min-pps the exit status is 1 when the median rate is lower,
+ *      so a run can gate a performance regression.
+ *
+ *      Without arguments a fixed suite of stream layouts runs, as part of
+ *      `make bench`.
+ *
+ *  Usage:
+ *      make bench
+ *      bench/replay_bench [options]       (--help for the list)
+ *
+ *  Copyright:
+ *      (c) 2026 B. Wynne
+ *
+ *  Author:
+ *      B. Wynne
+ *
+ *  License:
+ *      GPLv2 or later
+ */
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include <sched.h>
+#include <time.h>
+
+#include "aes_input.h"
+#include "audio_queue.h"
+#include "frame_pool.h"
+#include "metrics.h"
+#include "wav_sink.h"
+#include "log.h"
+
+#define BENCH_QUEUE_CAP         1024U
+#define BENCH_BURST             32U
+#define BENCH_DEFAULT_SECONDS   60U
+#define BENCH_DEFAULT_REPS      3U
+
+/* Synthetic streams start at this (arbitrary, fixed) PTP time */
+#define BENCH_EPOCH_NS          1700000000000000000ULL
+#define BENCH_PAYLOAD_TYPE      96U
+#define BENCH_SSRC              0x41594442U
+
+/* -------- Case description -------- */
+
+typedef struct bench_case {
+    const char *name;
+    const char *pcap;           /* NULL = synthetic */
+    uint16_t pcap_port;         /* 0 = first RTP flow in the capture */
+    uint32_t bits;              /* 16 or 24 */
+    uint32_t rate;
+    uint16_t stream_ch;
+    uint16_t out_ch;            /* 0 = stream_ch */
+    uint32_t ptime_us;
+    uint32_t seconds;
+    double   loss_pct;
+    double   reorder_pct;
+    uint32_t jitter_ms;
+    int      raw;               /* L24 passthrough (PCM24 sink only) */
+} bench_case_t;
+
+/* Default suite: layouts seen in the field plus one lossy network */
+static const bench_case_t suite[] = {
+    { "L24 2ch 1ms",           NULL, 0, 24, 48000,  2, 0, 1000, 0, 0.0, 0.0, 0, 0 },
+    { "L24 8ch 1ms",           NULL, 0, 24, 48000,  8, 0, 1000, 0, 0.0, 0.0, 0, 0 },
+    { "L16 2ch 125us",         NULL, 0, 16, 48000,  2, 0,  125, 0, 0.0, 0.0, 0, 0 },
+    { "L24 32->2ch 1ms",       NULL, 0, 24, 48000, 32, 2, 1000, 0, 0.0, 0.0, 0, 0 },
+    { "L24 2ch 1ms raw",       NULL, 0, 24, 48000,  2, 0, 1000, 0, 0.0, 0.0, 0, 1 },
+    { "L24 2ch 1ms lossy jb4", NULL, 0, 24, 48000,  2, 0, 1000, 0, 1.0, 1.0, 4, 0 },
+};
+
+typedef struct bench_opts {
+    uint32_t reps;
+    uint64_t seed;
+    double   speed;             /* 0 = as fast as the chain allows */
+    const char *out_path;
+    int      null_sink;
+    audyn_wav_format_t wav_format;
+    audyn_fw_backend_t backend;
+    int      metrics;
+    double   min_pps;
+} bench_opts_t;
+
+/* -------- Packet store -------- */
+
+typedef struct replay_pkt {
+    size_t   off;               /* Into replay_t.bytes */
+    uint32_t len;
+    uint64_t arrival_ns;        /* Virtual arrival stamp */
+} replay_pkt_t;
+
+typedef struct replay {
+    uint8_t *bytes;
+    size_t   bytes_len, bytes_cap;
+    replay_pkt_t *pkts;
+    size_t   n, cap;
+
+    /* Stream layout found or generated */
+    uint8_t  payload_type;
+    uint16_t spp;
+    uint64_t media_frames;      /* Sample frames the stream covers */
+} replay_t;
+
+static int replay_add(replay_t *r, const uint8_t *data, uint32_t len, uint64_t arrival_ns)
+{
+    if (r->n == r->cap) {
+        size_t cap = r->cap ? r->cap * 2 : 4096;
+        replay_pkt_t *p = realloc(r->pkts, cap * sizeof(*p));
+        if (!p) return -1;
+        r->pkts = p;
+        r->cap = cap;
+    }
+    if (r->bytes_len + len > r->bytes_cap) {
+        size_t cap = r->bytes_cap ? r->bytes_cap : 1u << 20;
+        while (cap < r->bytes_len + len) cap *= 2;
+        uint8_t *b = realloc(r->bytes, cap);
+        if (!b) return -1;
+        r->bytes = b;
+        r->bytes_cap = cap;
+    }
+    memcpy(r->bytes + r->bytes_len, data, len);
+    r->pkts[r->n].off = r->bytes_len;
+    r->pkts[r->n].len = len;
+    r->pkts[r->n].arrival_ns = arrival_ns;
+    r->bytes_len += len;
+    r->n++;
+    return 0;
+}
+
+static void replay_free(replay_t *r)
+{
+    free(r->bytes);
+    free(r->pkts);
+    memset(r, 0, sizeof(*r));
+}
+
+/* xorshift64*: fixed sequence per seed, the same across platforms */
+static uint64_t rng_next(uint64_t *s)
+{
+    uint64_t x = *s;
+    x ^= x >> 12;
+    x ^= x << 25;
+    x ^= x >> 27;
+    *s = x;
+    return x * 0x2545F4914F6CDD1DULL;
+}
+
+/* Uniform in [0, 100) */
+static double rng_pct(uint64_t *s)
+{
+    return (double)(rng_next(s) >> 11) * (100.0 / 9007199254740992.0);
+}
+
+static void wr_be16(uint8_t *p, uint16_t v) { p[0] = (uint8_t)(v >> 8); p[1] = (uint8_t)v; }
+static void wr_be32(uint8_t *p, uint32_t v)
+{
+    p[0] = (uint8_t)(v >> 24); p[1] = (uint8_t)(v >> 16);
+    p[2] = (uint8_t)(v >> 8);  p[3] = (uint8_t)v;
+}
+
+/* -------- Synthetic generator -------- */
+
+static int generate(replay_t *r, const bench_case_t *c, uint64_t seed)
+{
+    const uint64_t samples = (uint64_t)c->rate * c->ptime_us;
+    if (samples % 1000000u != 0) {
+        fprintf(stderr, "replay_bench: %u us is not a whole number of samples at %u Hz\n",
+                c->ptime_us, c->rate);
+        return -1;
+    }
+    const uint32_t spp = (uint32_t)(samples / 1000000u);
+    const uint32_t bps = c->bits / 8u;
+    const size_t len = 12u + (size_t)spp * c->stream_ch * bps;
+    const uint64_t n = (uint64_t)c->seconds * 1000000u / c->ptime_us;
+
+    uint8_t *buf = malloc(2 * len);
+    if (!buf) return -1;
+    uint8_t *cur = buf, *held = buf + len;
+    int have_held = 0;
+    uint64_t rng = seed ? seed : 1;
+
+    r->payload_type = BENCH_PAYLOAD_TYPE;
+    r->spp = (uint16_t)spp;
+    r->media_frames = n * spp;
+
+    for (uint64_t i = 0; i < n; i++) {
+        /* RTP header; the payload is a per-channel ramp, so every frame differs */
+        cur[0] = 0x80;
+        cur[1] = BENCH_PAYLOAD_TYPE;
+        wr_be16(cur + 2, (uint16_t)i);
+        wr_be32(cur + 4, (uint32_t)(i * spp));
+        wr_be32(cur + 8, BENCH_SSRC);
+        uint8_t *p = cur + 12;
+        for (uint32_t s = 0; s < spp; s++) {
+            for (uint32_t ch = 0; ch < c->stream_ch; ch++) {
+                const uint32_t v = (uint32_t)((i * spp + s) * 2731u + ch * 524287u);
+                if (bps == 3) {
+                    p[0] = (uint8_t)(v >> 16); p[1] = (uint8_t)(v >> 8); p[2] = (uint8_t)v;
+                } else {
+                    p[0] = (uint8_t)(v >> 8);  p[1] = (uint8_t)v;
+                }
+                p += bps;
+            }
+        }
+
+        /* Nominal arrival: the packet's own media time */
+        const uint64_t arrival = BENCH_EPOCH_NS + i * (uint64_t)c->ptime_us * 1000u;
+
+        if (c->loss_pct > 0.0 && rng_pct(&rng) < c->loss_pct) continue;
+
+        if (have_held) {
+            /* A held packet goes out one slot late, behind this one */
+            if (replay_add(r, cur, (uint32_t)len, arrival) != 0 ||
+                replay_add(r, held, (uint32_t)len, arrival) != 0) {
+                free(buf);
+                return -1;
+            }
+            have_held = 0;
+            continue;
+        }
+        if (c->reorder_pct > 0.0 && rng_pct(&rng) < c->reorder_pct) {
+            uint8_t *t = held; held = cur; cur = t;
+            have_held = 1;
+            continue;
+        }
+        if (replay_add(r, cur, (uint32_t)len, arrival) != 0) {
+            free(buf);
+            return -1;
+        }
+    }
+    free(buf);
+    return 0;
+}
+
+/* -------- pcap reader -------- */
+
+#define PCAP_MAGIC_US       0xA1B2C3D4U
+#define PCAP_MAGIC_NS       0xA1B23C4DU
+#define LINKTYPE_NULL       0
+#define LINKTYPE_ETHERNET   1
+#define LINKTYPE_RAW        101
+#define LINKTYPE_LINUX_SLL  113
+#define LINKTYPE_IPV4       228
+#define LINKTYPE_LINUX_SLL2 276
+
+static uint32_t rd32(const uint8_t *p, int swap)
+{
+    uint32_t v;
+    memcpy(&v, p, 4);
+    return swap ? __builtin_bswap32(v) : v;
+}
+
+static uint16_t rd_be16(const uint8_t *p) { return (uint16_t)((p[0] << 8) | p[1]); }
+
+/* Offset of the IPv4 header in a link-layer frame, or -1 if not IPv4 */
+static long ipv4_offset(uint32_t linktype, const uint8_t *f, size_t len, int swap)
+{
+    switch (linktype) {
+    case LINKTYPE_NULL:
+        return (len >= 4 && rd32(f, swap) == 2) ? 4 : -1;     /* AF_INET */
+    case LINKTYPE_RAW:
+    case LINKTYPE_IPV4:
+        return 0;
+    case LINKTYPE_LINUX_SLL:
+        return (len >= 16 && rd_be16(f + 14) == 0x0800) ? 16 : -1;
+    case LINKTYPE_LINUX_SLL2:
+        return (len >= 20 && rd_be16(f) == 0x0800) ? 20 : -1;
+    case LINKTYPE_ETHERNET: {
+        size_t off = 12;
+        while (len >= off + 2 && (rd_be16(f + off) == 0x8100 || rd_be16(f + off) == 0x88A8)) {
+            off += 4;       /* VLAN tags */
+        }
+        return (len >= off + 2 && rd_be16(f + off) == 0x0800) ? (long)(off + 2) : -1;
+    }
+    default:
+        return -1;
+    }
+}
+
+static int load_pcap(replay_t *r, const bench_case_t *c)
+{
+    FILE *fp = fopen(c->pcap, "rb");
+    if (!fp) {
+        perror(c->pcap);
+        return -1;
+    }
+
+    uint8_t gh[24];
+    if (fread(gh, 1, sizeof(gh), fp) != sizeof(gh)) {
+        fprintf(stderr, "replay_bench: %s: short pcap header\n", c->pcap);
+        fclose(fp);
+        return -1;
+    }
+    uint32_t magic;
+    memcpy(&magic, gh, 4);
+    const int swap = (magic == __builtin_bswap32(PCAP_MAGIC_US) ||
+                      magic == __builtin_bswap32(PCAP_MAGIC_NS));
+    magic = swap ? __builtin_bswap32(magic) : magic;
+    if (magic != PCAP_MAGIC_US && magic != PCAP_MAGIC_NS) {
+        fprintf(stderr, "replay_bench: %s: not a libpcap file (pcapng is not supported)\n",
+                c->pcap);
+        fclose(fp);
+        return -1;
+    }
+    const uint64_t frac_ns = (magic == PCAP_MAGIC_NS) ? 1u : 1000u;
+    const uint32_t snaplen = rd32(gh + 16, swap);
+    const uint32_t linktype = rd32(gh + 20, swap) & 0x0FFFFFFFu;
+
+    uint8_t *f = malloc(snaplen > 65535 ? snaplen : 65535);
+    if (!f) {
+        fclose(fp);
+        return -1;
+    }
+
+    uint32_t flow_ip = 0;
+    uint16_t flow_port = c->pcap_port;
+    int locked = 0;
+    uint32_t payload_bytes = 0;
+    uint8_t rh[16];
+    int rc = 0;
+
+    while (fread(rh, 1, sizeof(rh), fp) == sizeof(rh)) {
+        const uint32_t caplen = rd32(rh + 8, swap);
+        if (caplen > (snaplen > 65535 ? snaplen : 65535) || fread(f, 1, caplen, fp) != caplen) {
+            fprintf(stderr, "replay_bench: %s: truncated record\n", c->pcap);
+            rc = -1;
+            break;
+        }
+        long ip = ipv4_offset(linktype, f, caplen, swap);
+        if (ip < 0 || caplen < (size_t)ip + 20) continue;
+        const uint8_t *h = f + ip;
+        const size_t ihl = (size_t)(h[0] & 0x0F) * 4u;
+        if ((h[0] >> 4) != 4 || h[9] != 17 || (rd_be16(h + 6) & 0x3FFF) != 0) continue;
+        if (caplen < (size_t)ip + ihl + 8) continue;
+        const uint8_t *u = h + ihl;
+        const size_t udp_len = rd_be16(u + 4);
+        if (udp_len < 8 + 12 || caplen < (size_t)ip + ihl + udp_len) continue;
+        const uint8_t *rtp = u + 8;
+        const uint32_t rtp_len = (uint32_t)(udp_len - 8);
+        const uint32_t dst_ip = rd32(h + 16, 0);
+        const uint16_t dst_port = rd_be16(u + 2);
+
+        if (!locked) {
+            if ((flow_port && dst_port != flow_port) || (rtp[0] >> 6) != 2) continue;
+            flow_ip = dst_ip;
+            flow_port = dst_port;
+            locked = 1;
+            r->payload_type = rtp[1] & 0x7F;
+            size_t off = 12u + (size_t)(rtp[0] & 0x0F) * 4u;
+            if ((rtp[0] & 0x10) && rtp_len >= off + 4) off += 4u + (size_t)rd_be16(rtp + off + 2) * 4u;
+            size_t pad = (rtp[0] & 0x20) ? rtp[rtp_len - 1] : 0;
+            payload_bytes = (off + pad < rtp_len) ? (uint32_t)(rtp_len - off - pad) : 0;
+        } else if (dst_ip != flow_ip || dst_port != flow_port) {
+            continue;
+        }
+
+        const uint64_t arrival = (uint64_t)rd32(rh, swap) * 1000000000ULL +
+                                 (uint64_t)rd32(rh + 4, swap) * frac_ns;
+        if (replay_add(r, rtp, rtp_len, arrival) != 0) {
+            rc = -1;
+            break;
+        }
+    }
+    free(f);
+    fclose(fp);
+    if (rc != 0) return -1;
+
+    const uint32_t stride = (uint32_t)c->stream_ch * (c->bits / 8u);
+    if (!locked || r->n == 0) {
+        fprintf(stderr, "replay_bench: %s: no RTP flow found\n", c->pcap);
+        return -1;
+    }
+    if (payload_bytes == 0 || payload_bytes % stride != 0) {
+        fprintf(stderr, "replay_bench: %s: %u-byte payload is not %u channels of L%u\n",
+                c->pcap, payload_bytes, (unsigned)c->stream_ch, c->bits);
+        return -1;
+    }
+    r->spp = (uint16_t)(payload_bytes / stride);
+    r->media_frames = (uint64_t)r->n * r->spp;
+    return 0;
+}
+
+/* -------- Threads -------- */
+
+static int g_single_cpu = 0;
+static int g_cpu[2] = { -1, -1 };
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static inline void spin_wait(void)
+{
+    if (g_single_cpu) {
+        sched_yield();
+    } else {
+#if defined(__x86_64__) || defined(__i386__)
+        __builtin_ia32_pause();
+#elif defined(__aarch64__)
+        __asm__ __volatile__("yield");
+#endif
+    }
+}
+
+static void pick_cpus(void)
+{
+    cpu_set_t set;
+    int n = 0;
+
+    if (sched_getaffinity(0, sizeof(set), &set) != 0) {
+        g_single_cpu = 1;
+        return;
+    }
+    for (int c = 0; c < CPU_SETSIZE && n < 2; c++) {
+        if (CPU_ISSET(c, &set)) g_cpu[n++] = c;
+    }
+    g_single_cpu = (n < 2);
+}
+
+static void pin_self(int which)
+{
+    if (g_single_cpu || g_cpu[which] < 0) return;
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(g_cpu[which], &set);
+    (void)pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+}
+
+typedef struct run_ctx {
+    const replay_t *r;
+    const bench_opts_t *o;
+    audyn_aes_input_t *in;
+    audyn_audio_queue_t *q;
+    audyn_wav_sink_t *sink;     /* NULL = release only */
+    uint16_t out_ch;
+    int raw;
+
+    _Atomic int go;
+    _Atomic int done;
+    int failed;
+
+    /* Results */
+    uint64_t in_ns;             /* Producer time inside feed() */
+    uint64_t sink_ns;           /* Worker time writing and releasing */
+    uint64_t consumed;
+} run_ctx_t;
+
+static void *producer_main(void *arg)
+{
+    run_ctx_t *c = (run_ctx_t *)arg;
+    const replay_t *r = c->r;
+    const uint32_t gate = BENCH_QUEUE_CAP / 2;
+    const double speed = c->o->speed;
+
+    pin_self(0);
+    while (!atomic_load_explicit(&c->go, memory_order_acquire)) spin_wait();
+
+    const uint64_t start = now_ns();
+    const uint64_t first = r->n ? r->pkts[0].arrival_ns : 0;
+    size_t i = 0;
+
+    while (i < r->n) {
+        size_t end = i + BENCH_BURST;
+        if (speed > 0.0) {
+            /* Release at the packet's virtual arrival, scaled */
+            const uint64_t due = start + (uint64_t)((double)(r->pkts[i].arrival_ns - first) / speed);
+            uint64_t t;
+            while ((t = now_ns()) < due) {
+                if (due - t > 50000) {
+                    struct timespec ts = { 0, (long)(due - t - 20000) };
+                    nanosleep(&ts, NULL);
+                } else {
+                    spin_wait();
+                }
+            }
+            end = i + 1;
+        } else {
+            /* Backpressure: measure capacity, not drop behaviour */
+            while (audyn_audio_queue_depth(c->q) > gate) spin_wait();
+        }
+        if (end > r->n) end = r->n;
+
+        const uint64_t t0 = now_ns();
+        for (; i < end; i++) {
+            const replay_pkt_t *p = &r->pkts[i];
+            if (audyn_aes_input_feed(c->in, r->bytes + p->off, p->len, p->arrival_ns) != 0) {
+                c->failed = 1;
+                i = r->n;
+                break;
+            }
+        }
+        c->in_ns += now_ns() - t0;
+    }
+
+    atomic_store_explicit(&c->done, 1, memory_order_release);
+    return NULL;
+}
+
+static int write_frame(run_ctx_t *c, const audyn_audio_frame_t *f)
+{
+    if (c->raw && f->raw && f->raw_frames == f->sample_frames) {
+        return audyn_wav_sink_write_s24le(c->sink, f->raw, f->sample_frames, c->out_ch);
+    }
+    return audyn_wav_sink_write(c->sink, f->data, f->sample_frames, c->out_ch);
+}
+
+static void *worker_main(void *arg)
+{
+    run_ctx_t *c = (run_ctx_t *)arg;
+    audyn_audio_frame_t *frames[BENCH_BURST];
+
+    pin_self(1);
+    while (!atomic_load_explicit(&c->go, memory_order_acquire)) spin_wait();
+
+    for (;;) {
+        uint32_t n = audyn_audio_queue_pop_bulk(c->q, (void **)frames, BENCH_BURST);
+        if (n == 0) {
+            if (atomic_load_explicit(&c->done, memory_order_acquire) &&
+                audyn_audio_queue_depth(c->q) == 0) {
+                break;
+            }
+            spin_wait();
+            continue;
+        }
+
+        const uint64_t t0 = now_ns();
+        if (c->sink) {
+            for (uint32_t k = 0; k < n; k++) {
+                if (write_frame(c, frames[k]) != 0) c->failed = 1;
+            }
+        }
+        audyn_frame_release_bulk(frames, n);
+        c->sink_ns += now_ns() - t0;
+        c->consumed += n;
+    }
+
+    /* Closing drains the file writer: part of the sink's cost */
+    if (c->sink) {
+        const uint64_t t0 = now_ns();
+        if (audyn_wav_sink_close(c->sink) != 0) c->failed = 1;
+        c->sink_ns += now_ns() - t0;
+    }
+    return NULL;
+}
+
+/* -------- One run -------- */
+
+typedef struct run_result {
+    double   pps;
+    double   in_ns_pkt;
+    double   sink_ns_frame;
+    uint64_t frames_out;
+    uint64_t concealed;
+    uint64_t drops_pool;
+    uint64_t drops_queue;
+    uint64_t pkts_dropped;      /* Rejected by the input (late, invalid) */
+    uint64_t wall_ns;
+} run_result_t;
+
+static int run_once(const bench_case_t *bc, const replay_t *r, const bench_opts_t *o,
+                    run_result_t *res)
+{
+    const uint16_t out_ch = bc->out_ch ? bc->out_ch : bc->stream_ch;
+    const int raw = bc->raw && bc->bits == 24 && o->wav_format == AUDYN_WAV_PCM24;
+    int rc = -1;
+
+    audyn_frame_pool_t *pool = audyn_frame_pool_create(BENCH_QUEUE_CAP + 4 * BENCH_BURST,
+                                                       out_ch, r->spp);
+    audyn_audio_queue_t *q = audyn_audio_queue_create(BENCH_QUEUE_CAP);
+    audyn_aes_input_t *in = NULL;
+    audyn_wav_sink_t *sink = NULL;
+    if (!pool || !q || (raw && audyn_frame_pool_enable_raw(pool, 3) != 0)) goto out;
+
+    audyn_aes_input_cfg_t cfg;
+    memset(&cfg, 0, sizeof(cfg));
+    cfg.source_ip = "127.0.0.1";        /* Not bound: packets come through feed() */
+    cfg.port = 5004;
+    cfg.payload_type = r->payload_type;
+    cfg.sample_rate = bc->rate;
+    cfg.channels = out_ch;
+    cfg.stream_channels = bc->stream_ch;
+    cfg.samples_per_packet = r->spp;
+    cfg.jitter_ms = bc->jitter_ms;
+    cfg.raw_s24 = raw;
+    in = audyn_aes_input_create(pool, q, &cfg);
+    if (!in) goto out;
+
+    if (!o->null_sink) {
+        audyn_wav_sink_cfg_t scfg;
+        memset(&scfg, 0, sizeof(scfg));
+        scfg.format = o->wav_format;
+        scfg.container = AUDYN_WAV_RF64;
+        scfg.writer.backend = o->backend;
+        sink = audyn_wav_sink_create(&scfg);
+        if (!sink || audyn_wav_sink_open(sink, o->out_path, bc->rate, out_ch) != 0) goto out;
+    }
+
+    run_ctx_t c;
+    memset(&c, 0, sizeof(c));
+    c.r = r;
+    c.o = o;
+    c.in = in;
+    c.q = q;
+    c.sink = sink;
+    c.out_ch = out_ch;
+    c.raw = raw;
+
+    pthread_t tp, tw;
+    if (pthread_create(&tw, NULL, worker_main, &c) != 0) goto out;
+    if (pthread_create(&tp, NULL, producer_main, &c) != 0) {
+        atomic_store(&c.done, 1);
+        atomic_store(&c.go, 1);
+        pthread_join(tw, NULL);
+        goto out;
+    }
+
+    const uint64_t t0 = now_ns();
+    atomic_store_explicit(&c.go, 1, memory_order_release);
+    pthread_join(tp, NULL);
+    pthread_join(tw, NULL);
+    const uint64_t dt = now_ns() - t0;
+
+    audyn_aes_stats_t st;
+    audyn_aes_input_get_stats(in, &st);
+    audyn_jb_stats_t js;
+    uint64_t late = 0;
+    if (audyn_aes_input_get_jb_stats(in, &js) == 0) late = js.packets_late;
+
+    res->wall_ns = dt;
+    res->pps = (double)r->n * 1e9 / (double)dt;
+    res->in_ns_pkt = (double)c.in_ns / (double)(r->n ? r->n : 1);
+    res->sink_ns_frame = (double)c.sink_ns / (double)(c.consumed ? c.consumed : 1);
+    res->frames_out = c.consumed;
+    res->concealed = st.frames_concealed;
+    res->drops_pool = st.frames_dropped_pool;
+    res->drops_queue = st.frames_dropped_queue;
+    res->pkts_dropped = st.packets_dropped + late;
+    rc = (c.failed || c.consumed != st.frames_pushed) ? -1 : 0;
+    if (c.consumed != st.frames_pushed) {
+        fprintf(stderr, "replay_bench: %llu frames pushed, %llu consumed\n",
+                (unsigned long long)st.frames_pushed, (unsigned long long)c.consumed);
+    }
+
+out:
+    audyn_wav_sink_destroy(sink);       /* Closes it unless the worker did */
+    audyn_aes_input_destroy(in);
+    audyn_audio_queue_destroy(q);
+    audyn_frame_pool_destroy(pool);
+    return rc;
+}
+
+/* -------- Case driver -------- */
+
+static int cmp_double(const void *a, const void *b)
+{
+    const double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+static double median(double *v, uint32_t n)
+{
+    qsort(v, n, sizeof(*v), cmp_double);
+    return (n & 1) ? v[n / 2] : 0.5 * (v[n / 2 - 1] + v[n / 2]);
+}
+
+static void print_header(void)
+{
+    printf("%-24s %9s %10s %7s %8s %10s %10s %9s %8s %7s %7s\n",
+           "case", "packets", "Mpkt/s", "spread", "x rt", "in ns/pkt", "sink ns/fr",
+           "frames", "conceal", "d.pool", "d.queue");
+}
+
+/*
+ * Build the case's packets once, run it o->reps times and print the
+ * medians. Returns 0, or -1 when a run failed, dropped frames under
+ * backpressure or fell below --min-pps.
+ */
+static int run_case(const bench_case_t *bc, const bench_opts_t *o)
+{
+    replay_t r;
+    memset(&r, 0, sizeof(r));
+    if ((bc->pcap ? load_pcap(&r, bc) : generate(&r, bc, o->seed)) != 0) {
+        replay_free(&r);
+        return -1;
+    }
+
+    double pps[64], in_ns[64], sink_ns[64];
+    const uint32_t reps = o->reps < 64 ? o->reps : 64;
+    run_result_t last;
+    memset(&last, 0, sizeof(last));
+    int failed = 0;
+
+    for (uint32_t k = 0; k < reps; k++) {
+        run_result_t res;
+        memset(&res, 0, sizeof(res));
+        if (run_once(bc, &r, o, &res) != 0) failed = 1;
+        pps[k] = res.pps;
+        in_ns[k] = res.in_ns_pkt;
+        sink_ns[k] = res.sink_ns_frame;
+        /* Same input every run: counts differ only if the chain dropped */
+        if (k > 0 && res.frames_out != last.frames_out) failed = 1;
+        last = res;
+    }
+
+    double lo = pps[0], hi = pps[0];
+    for (uint32_t k = 1; k < reps; k++) {
+        if (pps[k] < lo) lo = pps[k];
+        if (pps[k] > hi) hi = pps[k];
+    }
+    const double m_pps = median(pps, reps);
+    const double media_s = (double)r.media_frames / (double)bc->rate;
+    const double pkt_s = media_s / (double)(r.n ? r.n : 1);
+
+    char spread[16];
+    snprintf(spread, sizeof(spread), "%.1f%%", m_pps > 0 ? 100.0 * (hi - lo) / m_pps : 0.0);
+    printf("%-24s %9zu %10.3f %7s %8.0f %10.1f %10.1f %9llu %8llu %7llu %7llu\n",
+           bc->name, r.n, m_pps / 1e6, spread, m_pps * pkt_s,
+           median(in_ns, reps), median(sink_ns, reps),
+           (unsigned long long)last.frames_out, (unsigned long long)last.concealed,
+           (unsigned long long)last.drops_pool, (unsigned long long)last.drops_queue);
+
+    if (o->speed == 0.0 && (last.drops_pool || last.drops_queue)) {
+        printf("  %s: frames dropped under backpressure\n", bc->name);
+        failed = 1;
+    }
+    if (o->min_pps > 0.0 && m_pps < o->min_pps) {
+        printf("  %s: %.0f packets/s is below --min-pps %.0f\n", bc->name, m_pps, o->min_pps);
+        failed = 1;
+    }
+
+    replay_free(&r);
+    return failed ? -1 : 0;
+}
+
+/* -------- Options -------- */
+
+static void usage(void)
+{
+    printf(
+        "Usage: replay_bench [options]\n"
+        "Without stream options, runs the built-in suite.\n\n"
+        "Stream:\n"
+        "  --pcap <file>          Replay the first RTP flow of a libpcap capture\n"
+        "  --port <n>             With --pcap: UDP destination port of the flow\n"
+        "  --format <l16|l24>     Sample format (default l24)\n"
+        "  --rate <hz>            Sample rate (default 48000)\n"
+        "  --channels <n>         Stream channels (default 2)\n"
+        "  --out-channels <n>     Channels kept, from the first (default: all)\n"
+        "  --ptime-us <us>        Synthetic packet time (default 1000)\n"
+        "  --seconds <s>          Synthetic stream length in media time (default %u)\n"
+        "  --loss <pct>           Synthetic packet loss (default 0)\n"
+        "  --reorder <pct>        Packets swapped with their successor (default 0)\n"
+        "  --jitter-ms <ms>       Jitter buffer depth (default 0 = off)\n"
+        "  --raw                  L24 passthrough into a PCM24 sink\n\n"
+        "Run:\n"
+        "  --reps <n>             Runs per case, median reported (default %u)\n"
+        "  --seed <n>             Generator seed (default 1)\n"
+        "  --speed <x>            Release packets at x times real time, no backpressure\n"
+        "  --sink <wav|null>      Worker writes a WAV file or only releases (default wav)\n"
+        "  --out <path>           WAV output (default /dev/null)\n"
+        "  --wav-format <f>       pcm16, pcm24 or float (default pcm24)\n"
+        "  --writer <backend>     auto, stdio, thread or uring (default auto)\n"
+        "  --metrics              Enable latency metrics recording (cost check)\n"
+        "  --min-pps <n>          Fail when the median packets/s is lower\n",
+        BENCH_DEFAULT_SECONDS, BENCH_DEFAULT_REPS);
+}
+
+int main(int argc, char **argv)
+{
+    bench_case_t one = suite[0];
+    one.name = "custom";
+    int custom = 0;
+
+    bench_opts_t o;
+    memset(&o, 0, sizeof(o));
+    o.reps = BENCH_DEFAULT_REPS;
+    o.seed = 1;
+    o.out_path = "/dev/null";
+    o.wav_format = AUDYN_WAV_PCM24;
+    o.backend = AUDYN_FW_AUTO;
+
+    for (int i = 1; i < argc; i++) {
+        const char *a = argv[i];
+        const char *v = (i + 1 < argc) ? argv[i + 1] : NULL;
+        int takes = 1;
+
+        if (!strcmp(a, "--help") || !strcmp(a, "-h")) {
+            usage();
+            return 0;
+        } else if (!strcmp(a, "--raw")) {
+            one.raw = 1; custom = 1; takes = 0;
+        } else if (!strcmp(a, "--metrics")) {
+            o.metrics = 1; takes = 0;
+        } else if (!v) {
+            fprintf(stderr, "Error: %s needs a value (see --help)\n", a);
+            return 2;
+        } else if (!strcmp(a, "--pcap")) {
+            one.pcap = v; custom = 1;
+        } else if (!strcmp(a, "--port")) {
+            one.pcap_port = (uint16_t)strtoul(v, NULL, 10);
+        } else if (!strcmp(a, "--format")) {
+            if (!strcmp(v, "l16")) one.bits = 16;
+            else if (!strcmp(v, "l24")) one.bits = 24;
+            else { fprintf(stderr, "Error: --format expects l16 or l24\n"); return 2; }
+            custom = 1;
+        } else if (!strcmp(a, "--rate")) {
+            one.rate = (uint32_t)strtoul(v, NULL, 10); custom = 1;
+        } else if (!strcmp(a, "--channels")) {
+            one.stream_ch = (uint16_t)strtoul(v, NULL, 10); custom = 1;
+        } else if (!strcmp(a, "--out-channels")) {
+            one.out_ch = (uint16_t)strtoul(v, NULL, 10); custom = 1;
+        } else if (!strcmp(a, "--ptime-us")) {
+            one.ptime_us = (uint32_t)strtoul(v, NULL, 10); custom = 1;
+        } else if (!strcmp(a, "--seconds")) {
+            one.seconds = (uint32_t)strtoul(v, NULL, 10);
+        } else if (!strcmp(a, "--loss")) {
+            one.loss_pct = strtod(v, NULL); custom = 1;
+        } else if (!strcmp(a, "--reorder")) {
+            one.reorder_pct = strtod(v, NULL); custom = 1;
+        } else if (!strcmp(a, "--jitter-ms")) {
+            one.jitter_ms = (uint32_t)strtoul(v, NULL, 10); custom = 1;
+        } else if (!strcmp(a, "--reps")) {
+            o.reps = (uint32_t)strtoul(v, NULL, 10);
+        } else if (!strcmp(a, "--seed")) {
+            o.seed = strtoull(v, NULL, 10);
+        } else if (!strcmp(a, "--speed")) {
+            o.speed = strtod(v, NULL);
+        } else if (!strcmp(a, "--sink")) {
+            if (!strcmp(v, "null")) o.null_sink = 1;
+            else if (strcmp(v, "wav") != 0) {
+                fprintf(stderr, "Error: --sink expects wav or null\n");
+                return 2;
+            }
+        } else if (!strcmp(a, "--out")) {
+            o.out_path = v;
+        } else if (!strcmp(a, "--wav-format")) {
+            if (!strcmp(v, "pcm16")) o.wav_format = AUDYN_WAV_PCM16;
+            else if (!strcmp(v, "pcm24")) o.wav_format = AUDYN_WAV_PCM24;
+            else if (!strcmp(v, "float")) o.wav_format = AUDYN_WAV_FLOAT32;
+            else { fprintf(stderr, "Error: --wav-format expects pcm16, pcm24 or float\n"); return 2; }
+        } else if (!strcmp(a, "--writer")) {
+            if (audyn_file_writer_parse_backend(v, &o.backend) != 0) {
+                fprintf(stderr, "Error: --writer expects auto, stdio, thread or uring\n");
+                return 2;
+            }
+        } else if (!strcmp(a, "--min-pps")) {
+            o.min_pps = strtod(v, NULL);
+        } else {
+            fprintf(stderr, "Error: unknown option %s (see --help)\n", a);
+            return 2;
+        }
+        i += takes;
+    }
+
+    if (o.reps == 0 || o.speed < 0.0 || one.rate == 0 || one.ptime_us == 0 ||
+        one.stream_ch == 0 || one.stream_ch > 32 || one.out_ch > one.stream_ch ||
+        one.loss_pct < 0.0 || one.loss_pct >= 100.0 ||
+        one.reorder_pct < 0.0 || one.reorder_pct > 100.0) {
+        fprintf(stderr, "Error: option out of range (see --help)\n");
+        return 2;
+    }
+
+    /* Drop and discontinuity warnings are expected here; keep errors */
+    audyn_log_init(AUDYN_LOG_ERROR, 0);
+    if (o.metrics && audyn_metrics_init() != 0) return 1;
+
+    pick_cpus();
+    if (g_single_cpu) {
+        printf("replay_bench: 1 CPU available, producer and worker share it\n");
+    } else {
+        printf("replay_bench: producer on CPU %d, worker on CPU %d\n", g_cpu[0], g_cpu[1]);
+    }
+    printf("%u runs per case, seed %llu, %s, sink %s%s%s\n\n", (unsigned)o.reps,
+           (unsigned long long)o.seed,
+           o.speed > 0.0 ? "paced" : "backpressure",
+           o.null_sink ? "null" : audyn_wav_format_name(o.wav_format),
+           o.null_sink ? "" : " -> ", o.null_sink ? "" : o.out_path);
+    print_header();
+
+    int failed = 0;
+    if (custom) {
+        if (one.seconds == 0) one.seconds = BENCH_DEFAULT_SECONDS;
+        if (one.pcap) one.name = "pcap";
+        if (run_case(&one, &o) != 0) failed = 1;
+    } else {
+        for (size_t k = 0; k < sizeof(suite) / sizeof(suite[0]); k++) {
+            bench_case_t c = suite[k];
+            c.seconds = one.seconds ? one.seconds : BENCH_DEFAULT_SECONDS;
+            if (run_case(&c, &o) != 0) failed = 1;
+        }
+    }
+
+    audyn_log_shutdown();
+    return failed;
+}
@@ -24,7 +24,9 @@
  *      Files are named for the period start time.
  *
  *  Threading Model:
- *      - NOT thread-safe. Single worker thread only.
+ *      - NOT thread-safe. Single worker thread only, except that
+ *        peek_path() and make_dirs() only read the configuration and may
+ *        run on a helper thread while the worker owns the policy.
  *
  *  Dependencies:
  *      - Standard C: stdio, stdlib, string, time
@@ -78,6 +80,7 @@ struct audyn_archive_policy {
     audyn_archive_layout_t layout;
     audyn_archive_clock_t clock_source;
     uint32_t rotation_period_sec;
+    uint32_t pending_period_sec;  /* set_period(): adopted at an aligned boundary (0 = none) */
     int create_directories;
 
     /* Runtime state */
@@ -675,22 +678,62 @@ int audyn_archive_policy_should_rotate(
     return 0;
 }
 
-int audyn_archive_policy_next_path(
-    audyn_archive_policy_t *p,
-    uint64_t now_ns,
-    char *out_path,
-    size_t out_size)
+/*
+ * Rotation period for the period containing now_ns: a pending period once
+ * its boundaries line up with the current one there (so the new file
+ * starts where the old one ends and never reuses an earlier name).
+ * Reads configuration only.
+ */
+static uint32_t period_for(const audyn_archive_policy_t *p, uint64_t now_ns)
 {
-    if (!p || !out_path || out_size == 0) {
-        return -1;
+    if (p->pending_period_sec == 0) {
+        return p->rotation_period_sec;
+    }
+
+    uint64_t cur_start = 0, new_start = 1;
+    if (calculate_period_boundary(now_ns, p->rotation_period_sec, p->clock_source,
+                                  &cur_start, NULL, NULL, NULL) != 0 ||
+        calculate_period_boundary(now_ns, p->pending_period_sec, p->clock_source,
+                                  &new_start, NULL, NULL, NULL) != 0 ||
+        cur_start != new_start) {
+        return p->rotation_period_sec;
     }
+    return p->pending_period_sec;
+}
 
+/*
+ * Make the period used for a new file current.
+ */
+static void commit_period(audyn_archive_policy_t *p, uint32_t period_sec)
+{
+    if (p->pending_period_sec == 0 || period_sec != p->pending_period_sec) {
+        return;
+    }
+    LOG_INFO("archive: rotation period %us -> %us", p->rotation_period_sec, period_sec);
+    p->rotation_period_sec = period_sec;
+    p->pending_period_sec = 0;
+}
+
+/*
+ * Path and period for now_ns. Reads configuration only.
+ */
+static int build_path(
+    const audyn_archive_policy_t *p,
+    uint64_t now_ns,
+    uint32_t period_sec,
+    char *out_path,
+    size_t out_size,
+    uint64_t *out_start,
+    uint64_t *out_end,
+    struct tm *out_tm,
+    uint32_t *out_csec)
+{
     /* Calculate period boundary and get struct tm */
     uint64_t period_start, period_end;
     struct tm tm;
     uint32_t csec = 0;
 
-    if (calculate_period_boundary(now_ns, p->rotation_period_sec, p->clock_source,
+    if (calculate_period_boundary(now_ns, period_sec, p->clock_source,
                                   &period_start, &period_end, &tm, &csec) != 0) {
         LOG_ERROR("archive: failed to calculate period boundary");
         return -1;
@@ -741,35 +784,88 @@ int audyn_archive_policy_next_path(
         return -1;
     }
 
+    if (out_start) *out_start = period_start;
+    if (out_end) *out_end = period_end;
+    if (out_tm) *out_tm = tm;
+    if (out_csec) *out_csec = csec;
+    return 0;
+}
+
+/*
+ * Create the parent directories of path. Sets *created if the directory
+ * did not exist before.
+ */
+static int create_parent_dirs(const char *path, int *created)
+{
+    char *dir = get_directory(path);
+    if (!dir) {
+        return 0;
+    }
+
+    /* Check if directory exists before mkdir to track creations */
+    struct stat st;
+    int dir_existed = (stat(dir, &st) == 0 && S_ISDIR(st.st_mode));
+
+    if (mkdir_recursive(dir, 0755) != 0) {
+        LOG_ERROR("archive: failed to create directory '%s': %s",
+                  dir, strerror(errno));
+        free(dir);
+        return -1;
+    }
+
+    if (created) *created = !dir_existed;
+    free(dir);
+    return 0;
+}
+
+/*
+ * Store the period for advance() and the next boundary.
+ */
+static void set_period(audyn_archive_policy_t *p, uint64_t period_start,
+                       uint64_t period_end, const struct tm *tm, uint32_t csec)
+{
+    p->current_period_ns = period_start;
+    p->next_boundary_ns = period_end;
+    p->current_tm = *tm;
+    p->current_centisec = csec;
+}
+
+int audyn_archive_policy_next_path(
+    audyn_archive_policy_t *p,
+    uint64_t now_ns,
+    char *out_path,
+    size_t out_size)
+{
+    if (!p || !out_path || out_size == 0) {
+        return -1;
+    }
+
+    uint64_t period_start, period_end;
+    struct tm tm;
+    uint32_t csec = 0;
+    const uint32_t period_sec = period_for(p, now_ns);
+
+    if (build_path(p, now_ns, period_sec, out_path, out_size,
+                   &period_start, &period_end, &tm, &csec) != 0) {
+        return -1;
+    }
+
     /* Create directories if needed */
     if (p->create_directories) {
-        char *dir = get_directory(out_path);
-        if (dir) {
-            /* Check if directory exists before mkdir to track creations */
-            struct stat st;
-            int dir_existed = (stat(dir, &st) == 0 && S_ISDIR(st.st_mode));
-
-            if (mkdir_recursive(dir, 0755) != 0) {
-                LOG_ERROR("archive: failed to create directory '%s': %s",
-                          dir, strerror(errno));
-                free(dir);
-                return -1;
-            }
-
-            if (!dir_existed) {
-                p->directories_created++;
-            }
-            free(dir);
+        int created = 0;
+        if (create_parent_dirs(out_path, &created) != 0) {
+            return -1;
+        }
+        if (created) {
+            p->directories_created++;
         }
     }
 
     p->paths_generated++;
 
     /* Store period info for advance() */
-    p->current_period_ns = period_start;
-    p->next_boundary_ns = period_end;
-    p->current_tm = tm;
-    p->current_centisec = csec;
+    commit_period(p, period_sec);
+    set_period(p, period_start, period_end, &tm, csec);
 
     LOG_DEBUG("archive: next path '%s' (period %lu-%lu)",
               out_path,
@@ -779,6 +875,62 @@ int audyn_archive_policy_next_path(
     return 0;
 }
 
+int audyn_archive_policy_peek_path(
+    const audyn_archive_policy_t *p,
+    uint64_t at_ns,
+    char *out_path,
+    size_t out_size)
+{
+    if (!p || !out_path || out_size == 0) {
+        return -1;
+    }
+
+    return build_path(p, at_ns, period_for(p, at_ns), out_path, out_size,
+                      NULL, NULL, NULL, NULL);
+}
+
+int audyn_archive_policy_make_dirs(
+    const audyn_archive_policy_t *p,
+    const char *path)
+{
+    if (!p || !path) {
+        return -1;
+    }
+    if (!p->create_directories) {
+        return 0;
+    }
+
+    return create_parent_dirs(path, NULL);
+}
+
+int audyn_archive_policy_enter_period(
+    audyn_archive_policy_t *p,
+    uint64_t now_ns,
+    uint64_t *period_start_ns)
+{
+    if (!p) {
+        return -1;
+    }
+
+    uint64_t period_start, period_end;
+    struct tm tm;
+    uint32_t csec = 0;
+    const uint32_t period_sec = period_for(p, now_ns);
+
+    if (calculate_period_boundary(now_ns, period_sec, p->clock_source,
+                                  &period_start, &period_end, &tm, &csec) != 0) {
+        LOG_ERROR("archive: failed to calculate period boundary");
+        return -1;
+    }
+
+    p->paths_generated++;
+    commit_period(p, period_sec);
+    set_period(p, period_start, period_end, &tm, csec);
+
+    if (period_start_ns) *period_start_ns = period_start;
+    return 0;
+}
+
 void audyn_archive_policy_advance(audyn_archive_policy_t *p)
 {
     if (!p) return;
@@ -796,6 +948,60 @@ void audyn_archive_policy_advance(audyn_archive_policy_t *p)
               (unsigned long)p->rotations);
 }
 
+int audyn_archive_policy_check_period(const audyn_archive_policy_t *p, uint32_t period_sec)
+{
+    if (!p) return -1;
+
+    if (p->rotation_period_sec == 0) {
+        LOG_ERROR("archive: rotation is off; the period cannot change at runtime");
+        return -1;
+    }
+    if (period_sec < AUDYN_ARCHIVE_MIN_ROTATION_SEC ||
+        period_sec > AUDYN_ARCHIVE_MAX_ROTATION_SEC) {
+        LOG_ERROR("archive: rotation period %u out of range (%u-%u)",
+                  period_sec, AUDYN_ARCHIVE_MIN_ROTATION_SEC, AUDYN_ARCHIVE_MAX_ROTATION_SEC);
+        return -1;
+    }
+    return 0;
+}
+
+int audyn_archive_policy_set_period(audyn_archive_policy_t *p, uint32_t period_sec)
+{
+    if (audyn_archive_policy_check_period(p, period_sec) != 0) return -1;
+
+    p->pending_period_sec = (period_sec == p->rotation_period_sec) ? 0 : period_sec;
+    return 0;
+}
+
+int audyn_archive_policy_check_layout(const audyn_archive_policy_t *p,
+                                      audyn_archive_layout_t layout)
+{
+    if (!p) return -1;
+
+    if (layout < AUDYN_ARCHIVE_LAYOUT_FLAT || layout > AUDYN_ARCHIVE_LAYOUT_CUSTOM) {
+        LOG_ERROR("archive: invalid layout %d", layout);
+        return -1;
+    }
+    if (layout == AUDYN_ARCHIVE_LAYOUT_CUSTOM && !p->custom_format) {
+        LOG_ERROR("archive: custom layout requires custom_format");
+        return -1;
+    }
+    return 0;
+}
+
+int audyn_archive_policy_set_layout(audyn_archive_policy_t *p, audyn_archive_layout_t layout)
+{
+    if (audyn_archive_policy_check_layout(p, layout) != 0) return -1;
+
+    if (layout != p->layout) {
+        LOG_INFO("archive: layout %s -> %s from the next file",
+                 audyn_archive_layout_to_string(p->layout),
+                 audyn_archive_layout_to_string(layout));
+        p->layout = layout;
+    }
+    return 0;
+}
+
 uint64_t audyn_archive_policy_next_boundary_ns(const audyn_archive_policy_t *p)
 {
     if (!p || p->rotation_period_sec == 0) {
@@ -804,6 +1010,39 @@ uint64_t audyn_archive_policy_next_boundary_ns(const audyn_archive_policy_t *p)
     return p->next_boundary_ns;
 }
 
+int audyn_archive_policy_split_offset(
+    const audyn_archive_policy_t *p,
+    uint64_t start_ns,
+    uint32_t frames,
+    uint32_t sample_rate,
+    uint32_t *offset)
+{
+    if (!p || !offset || !p->initialized || p->rotation_period_sec == 0 ||
+        sample_rate == 0 || frames == 0) {
+        return 0;
+    }
+
+    if (start_ns >= p->next_boundary_ns) {
+        *offset = 0;
+        return 1;
+    }
+
+    /* ceil(delta * rate / 1e9), split so the product cannot overflow */
+    uint64_t delta = p->next_boundary_ns - start_ns;
+    uint64_t secs = delta / NS_PER_SEC;
+    if (secs >= (uint64_t)frames / sample_rate + 1) {
+        return 0;
+    }
+    uint64_t k = secs * sample_rate +
+                 ((delta % NS_PER_SEC) * sample_rate + NS_PER_SEC - 1) / NS_PER_SEC;
+    if (k >= frames) {
+        return 0;
+    }
+
+    *offset = (uint32_t)k;
+    return 1;
+}
+
 int audyn_archive_policy_current_time(
     const audyn_archive_policy_t *p,
     struct tm *out_tm)
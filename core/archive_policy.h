@@ -205,6 +205,66 @@ int audyn_archive_policy_next_path(
     char *out_path,
     size_t out_size);
 
+/*
+ * Generate the archive path for the period containing at_ns, without
+ * creating directories or changing the policy state.
+ *
+ * Parameters:
+ *   p         - Archive policy instance
+ *   at_ns     - Time in the period (e.g., the next rotation boundary)
+ *   out_path  - Buffer to receive the generated path
+ *   out_size  - Size of out_path buffer
+ *
+ * Returns:
+ *   0 on success, -1 on failure.
+ *
+ * Notes:
+ *   - Used to open the next file ahead of its boundary
+ *   - Reads configuration only: may run on a helper thread while the
+ *     worker uses the policy
+ *   - The accurate layout names the file for at_ns itself
+ */
+int audyn_archive_policy_peek_path(
+    const audyn_archive_policy_t *p,
+    uint64_t at_ns,
+    char *out_path,
+    size_t out_size);
+
+/*
+ * Create the parent directories of path (if create_directories is set).
+ *
+ * Returns:
+ *   0 on success, -1 if a directory could not be created.
+ *
+ * Notes:
+ *   - Reads configuration only (same threading rule as peek_path)
+ *   - Not counted in directories_created
+ */
+int audyn_archive_policy_make_dirs(
+    const audyn_archive_policy_t *p,
+    const char *path);
+
+/*
+ * Enter the period containing now_ns, as next_path() does, without
+ * generating a path or creating directories.
+ *
+ * Parameters:
+ *   p               - Archive policy instance
+ *   now_ns          - Current time (same semantics as should_rotate)
+ *   period_start_ns - Receives the start of that period (may be NULL)
+ *
+ * Returns:
+ *   0 on success, -1 on failure.
+ *
+ * Notes:
+ *   - For a file opened ahead of time with peek_path(); call advance()
+ *     afterwards as usual
+ */
+int audyn_archive_policy_enter_period(
+    audyn_archive_policy_t *p,
+    uint64_t now_ns,
+    uint64_t *period_start_ns);
+
 /*
  * Advance to the next rotation period.
  *
@@ -219,6 +279,50 @@ int audyn_archive_policy_next_path(
  */
 void audyn_archive_policy_advance(audyn_archive_policy_t *p);
 
+/*
+ * Change the rotation period of a running policy.
+ *
+ * Parameters:
+ *   p          - Archive policy instance (rotation enabled)
+ *   period_sec - New period (AUDYN_ARCHIVE_MIN/MAX_ROTATION_SEC)
+ *
+ * Returns:
+ *   0 on success, -1 if rotation is off or the period is out of range.
+ *
+ * Notes:
+ *   - The current file keeps its boundary. The new period is adopted at
+ *     the first boundary that is also one of its own (e.g. 3600 -> 900
+ *     at the next hour, 3600 -> 7200 at the next even hour), so files
+ *     never overlap or reuse a name
+ *   - Not safe while peek_path()/make_dirs() run on another thread
+ */
+int audyn_archive_policy_set_period(audyn_archive_policy_t *p, uint32_t period_sec);
+
+/*
+ * Validate a set_period() argument without changing anything.
+ * Returns 0 if set_period(p, period_sec) would succeed, -1 otherwise (logged).
+ */
+int audyn_archive_policy_check_period(const audyn_archive_policy_t *p, uint32_t period_sec);
+
+/*
+ * Change the naming layout from the next generated path on.
+ *
+ * Returns:
+ *   0 on success, -1 on an invalid layout (CUSTOM needs the custom_format
+ *   given at create).
+ *
+ * Notes:
+ *   - Same threading rule as set_period()
+ */
+int audyn_archive_policy_set_layout(audyn_archive_policy_t *p, audyn_archive_layout_t layout);
+
+/*
+ * Validate a set_layout() argument without changing anything.
+ * Returns 0 if set_layout(p, layout) would succeed, -1 otherwise (logged).
+ */
+int audyn_archive_policy_check_layout(const audyn_archive_policy_t *p,
+                                      audyn_archive_layout_t layout);
+
 /*
  * Get the current rotation boundary time.
  *
@@ -230,6 +334,35 @@ void audyn_archive_policy_advance(audyn_archive_policy_t *p);
  */
 uint64_t audyn_archive_policy_next_boundary_ns(const audyn_archive_policy_t *p);
 
+/*
+ * Locate the next rotation boundary inside a block of audio.
+ *
+ * Parameters:
+ *   p           - Archive policy instance
+ *   start_ns    - Time of the block's first sample frame (same semantics
+ *                 as should_rotate)
+ *   frames      - Sample frames in the block
+ *   sample_rate - Audio sample rate
+ *   offset      - Receives the index of the first sample frame due at or
+ *                 after the boundary (0 if the block starts past it)
+ *
+ * Returns:
+ *   1 if the boundary falls before the end of the block, 0 otherwise
+ *   (also before the first file and with rotation disabled).
+ *
+ * Notes:
+ *   - Sample frame k is due at start_ns + k / sample_rate: frames
+ *     [0, offset) belong to the current file, the rest to the next
+ *   - Consecutive files therefore meet on one sample, with no gap or
+ *     overlap
+ */
+int audyn_archive_policy_split_offset(
+    const audyn_archive_policy_t *p,
+    uint64_t start_ns,
+    uint32_t frames,
+    uint32_t sample_rate,
+    uint32_t *offset);
+
 /*
  * Get current period start time as struct tm.
  *
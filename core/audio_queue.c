@@ -13,6 +13,26 @@
  *      - Consumer acquires tail then reads slots[head] and advances head.
  *      - Head is written only by the consumer; tail is written only by producer.
  *
+ *  Layout:
+ *      - tail (with the producer's cached copy of head), head (with the
+ *        consumer's cached copy of tail) and wake_at each own a cache
+ *        line, so the two sides do not false-share.
+ *      - A side reloads the other's index (one acquire load) only when its
+ *        cached copy says full/empty. A burst drained with pop_bulk() costs
+ *        one acquire and one release.
+ *
+ *  Wakeup:
+ *      - The consumer publishes wake_at (the fill level it waits for), then
+ *        re-checks the ring before parking in poll() on the eventfd.
+ *      - The producer publishes tail, then reads wake_at. Both sides use a
+ *        seq_cst fence between their store and load, so at least one of
+ *        them sees the other (no lost wakeup). The exchange on wake_at
+ *        ensures one eventfd write per park.
+ *
+ *  Memory:
+ *      - The slot ring comes from audyn_rt_alloc() (pre-faulted; locked and
+ *        NUMA-local in RT mode).
+ *
  *  Copyright:
  *      (c) 2026 B. Wynne
  *
@@ -24,16 +44,34 @@
  */
 
 #include "audio_queue.h"
+#include "rt.h"
 
+#include <stdalign.h>
 #include <stdlib.h>
 #include <stdatomic.h>
+#include <string.h>
+#include <errno.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/eventfd.h>
+
+#define QUEUE_CACHE_LINE 64
 
 struct audyn_audio_queue {
+    /* Read-only after create */
     uint32_t cap;        /* Total slots in ring; usable capacity is cap-1 */
     void   **slots;
+    int wake_fd;             /* eventfd, -1 if wakeup disabled */
+
+    /* Producer line */
+    alignas(QUEUE_CACHE_LINE) _Atomic uint32_t tail; /* producer-owned index */
+    uint32_t head_cache;     /* Producer's last view of head */
+
+    /* Consumer line */
+    alignas(QUEUE_CACHE_LINE) _Atomic uint32_t head; /* consumer-owned index */
+    uint32_t tail_cache;     /* Consumer's last view of tail */
 
-    _Atomic uint32_t head; /* consumer-owned index */
-    _Atomic uint32_t tail; /* producer-owned index */
+    alignas(QUEUE_CACHE_LINE) _Atomic uint32_t wake_at; /* 0 = consumer running, else fill it waits for */
 };
 
 static inline uint32_t next_idx(uint32_t cur, uint32_t cap)
@@ -42,24 +80,63 @@ static inline uint32_t next_idx(uint32_t cur, uint32_t cap)
     return (cur == cap) ? 0u : cur;
 }
 
+static inline uint32_t fill_of(uint32_t head, uint32_t tail, uint32_t cap)
+{
+    return (tail >= head) ? (tail - head) : (cap - head + tail);
+}
+
+/* Free slots the producer may fill, reloading head only if the cache says full */
+static inline uint32_t producer_room(audyn_audio_queue_t *q, uint32_t tail, uint32_t want)
+{
+    uint32_t room = q->cap - 1u - fill_of(q->head_cache, tail, q->cap);
+    if (room < want) {
+        q->head_cache = atomic_load_explicit(&q->head, memory_order_acquire);
+        room = q->cap - 1u - fill_of(q->head_cache, tail, q->cap);
+    }
+    return room;
+}
+
+/* Entries the consumer may take, reloading tail only if the cache says empty */
+static inline uint32_t consumer_avail(audyn_audio_queue_t *q, uint32_t head, uint32_t want)
+{
+    uint32_t avail = fill_of(head, q->tail_cache, q->cap);
+    if (avail < want) {
+        q->tail_cache = atomic_load_explicit(&q->tail, memory_order_acquire);
+        avail = fill_of(head, q->tail_cache, q->cap);
+    }
+    return avail;
+}
+
+static void signal_consumer(audyn_audio_queue_t *q)
+{
+    uint64_t one = 1;
+    ssize_t n;
+    do {
+        n = write(q->wake_fd, &one, sizeof(one));
+    } while (n < 0 && errno == EINTR);
+}
+
 audyn_audio_queue_t *audyn_audio_queue_create(uint32_t capacity)
 {
     if (capacity < 2)
         return NULL;
 
-    audyn_audio_queue_t *q = calloc(1, sizeof(*q));
+    /* Zeroed and 64-byte aligned, as the padded layout needs */
+    audyn_audio_queue_t *q = audyn_rt_alloc(sizeof(*q));
     if (!q)
         return NULL;
 
     q->cap = capacity;
-    q->slots = calloc((size_t)capacity, sizeof(void *));
+    q->slots = audyn_rt_alloc((size_t)capacity * sizeof(void *));
     if (!q->slots) {
-        free(q);
+        audyn_rt_free(q);
         return NULL;
     }
 
     atomic_init(&q->head, 0u);
     atomic_init(&q->tail, 0u);
+    atomic_init(&q->wake_at, 0u);
+    q->wake_fd = -1;
 
     return q;
 }
@@ -69,9 +146,28 @@ void audyn_audio_queue_destroy(audyn_audio_queue_t *q)
     if (!q)
         return;
 
-    free(q->slots);
+    if (q->wake_fd >= 0)
+        close(q->wake_fd);
+    audyn_rt_free(q->slots);
     q->slots = NULL;
-    free(q);
+    audyn_rt_free(q);
+}
+
+/* Producer side after publishing nt: wake a parked consumer if its fill is
+ * met. Out of line so push() keeps a frameless fast path without wakeup. */
+__attribute__((noinline))
+static void wake_parked(audyn_audio_queue_t *q, uint32_t nt)
+{
+    /* Pairs with the fence in pop_wait(): tail store vs wake_at load */
+    atomic_thread_fence(memory_order_seq_cst);
+    uint32_t want = atomic_load_explicit(&q->wake_at, memory_order_relaxed);
+    if (want != 0) {
+        uint32_t head = atomic_load_explicit(&q->head, memory_order_relaxed);
+        if (fill_of(head, nt, q->cap) >= want &&
+            atomic_exchange_explicit(&q->wake_at, 0u, memory_order_relaxed) != 0) {
+            signal_consumer(q);
+        }
+    }
 }
 
 int audyn_audio_queue_push(audyn_audio_queue_t *q, void *ptr)
@@ -80,29 +176,68 @@ int audyn_audio_queue_push(audyn_audio_queue_t *q, void *ptr)
         return 0;
 
     uint32_t tail = atomic_load_explicit(&q->tail, memory_order_relaxed);
-    uint32_t head = atomic_load_explicit(&q->head, memory_order_acquire);
-
     uint32_t nt = next_idx(tail, q->cap);
-    if (nt == head)
-        return 0; /* full */
+    if (nt == q->head_cache) {
+        q->head_cache = atomic_load_explicit(&q->head, memory_order_acquire);
+        if (nt == q->head_cache)
+            return 0; /* full */
+    }
 
     q->slots[tail] = ptr;
 
     /* Publish the new tail after writing the slot. */
     atomic_store_explicit(&q->tail, nt, memory_order_release);
+
+    if (q->wake_fd >= 0)
+        wake_parked(q, nt);
     return 1;
 }
 
+uint32_t audyn_audio_queue_push_bulk(audyn_audio_queue_t *q, void *const *ptrs, uint32_t n)
+{
+    if (!q || !ptrs || n == 0)
+        return 0;
+
+    uint32_t tail = atomic_load_explicit(&q->tail, memory_order_relaxed);
+    uint32_t room = producer_room(q, tail, n);
+    if (n > room)
+        n = room;
+
+    /* NULL is reserved: stop before the first one */
+    for (uint32_t i = 0; i < n; i++) {
+        if (!ptrs[i]) {
+            n = i;
+            break;
+        }
+    }
+    if (n == 0)
+        return 0;
+
+    uint32_t first = q->cap - tail;
+    if (first > n) first = n;
+    memcpy(&q->slots[tail], ptrs, (size_t)first * sizeof(void *));
+    memcpy(&q->slots[0], ptrs + first, (size_t)(n - first) * sizeof(void *));
+
+    uint32_t nt = tail + n;
+    if (nt >= q->cap) nt -= q->cap;
+    atomic_store_explicit(&q->tail, nt, memory_order_release);
+
+    if (q->wake_fd >= 0)
+        wake_parked(q, nt);
+    return n;
+}
+
 void *audyn_audio_queue_pop(audyn_audio_queue_t *q)
 {
     if (!q)
         return NULL;
 
     uint32_t head = atomic_load_explicit(&q->head, memory_order_relaxed);
-    uint32_t tail = atomic_load_explicit(&q->tail, memory_order_acquire);
-
-    if (head == tail)
-        return NULL; /* empty */
+    if (head == q->tail_cache) {
+        q->tail_cache = atomic_load_explicit(&q->tail, memory_order_acquire);
+        if (head == q->tail_cache)
+            return NULL; /* empty */
+    }
 
     void *ptr = q->slots[head];
 
@@ -111,6 +246,97 @@ void *audyn_audio_queue_pop(audyn_audio_queue_t *q)
     return ptr;
 }
 
+uint32_t audyn_audio_queue_pop_bulk(audyn_audio_queue_t *q, void **out, uint32_t max)
+{
+    if (!q || !out || max == 0)
+        return 0;
+
+    uint32_t head = atomic_load_explicit(&q->head, memory_order_relaxed);
+    uint32_t n = consumer_avail(q, head, max);
+    if (n > max)
+        n = max;
+    if (n == 0)
+        return 0;
+
+    uint32_t first = q->cap - head;
+    if (first > n) first = n;
+    memcpy(out, &q->slots[head], (size_t)first * sizeof(void *));
+    memcpy(out + first, &q->slots[0], (size_t)(n - first) * sizeof(void *));
+
+    uint32_t nh = head + n;
+    if (nh >= q->cap) nh -= q->cap;
+    atomic_store_explicit(&q->head, nh, memory_order_release);
+    return n;
+}
+
+int audyn_audio_queue_enable_wakeup(audyn_audio_queue_t *q)
+{
+    if (!q)
+        return -1;
+    if (q->wake_fd >= 0)
+        return 0;
+
+    q->wake_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    return (q->wake_fd >= 0) ? 0 : -1;
+}
+
+void *audyn_audio_queue_pop_wait(audyn_audio_queue_t *q, uint32_t min_fill,
+                                 uint32_t timeout_ms)
+{
+    if (!q)
+        return NULL;
+
+    if (min_fill < 1)
+        min_fill = 1;
+    if (min_fill > q->cap - 1)
+        min_fill = q->cap - 1;
+
+    uint32_t head = atomic_load_explicit(&q->head, memory_order_relaxed);
+    if (consumer_avail(q, head, min_fill) >= min_fill)
+        return audyn_audio_queue_pop(q);
+
+    if (q->wake_fd < 0) {
+        /* No eventfd: bounded polling fallback */
+        void *ptr = audyn_audio_queue_pop(q);
+        if (ptr)
+            return ptr;
+        usleep((timeout_ms < 1) ? 0 : 1000);
+        return audyn_audio_queue_pop(q);
+    }
+
+    atomic_store_explicit(&q->wake_at, min_fill, memory_order_relaxed);
+    /* Pairs with the fence in push(): wake_at store vs tail load */
+    atomic_thread_fence(memory_order_seq_cst);
+
+    if (consumer_avail(q, head, min_fill) < min_fill) {
+        struct pollfd pfd = { .fd = q->wake_fd, .events = POLLIN, .revents = 0 };
+        (void)poll(&pfd, 1, (int)timeout_ms);
+    }
+
+    atomic_store_explicit(&q->wake_at, 0u, memory_order_relaxed);
+
+    /* Consume the signal (may be stale from an earlier park) */
+    uint64_t v;
+    (void)read(q->wake_fd, &v, sizeof(v));
+
+    return audyn_audio_queue_pop(q);
+}
+
+void audyn_audio_queue_wake(audyn_audio_queue_t *q)
+{
+    if (q && q->wake_fd >= 0)
+        signal_consumer(q);
+}
+
+uint32_t audyn_audio_queue_depth(const audyn_audio_queue_t *q)
+{
+    if (!q)
+        return 0u;
+    uint32_t head = atomic_load_explicit(&q->head, memory_order_acquire);
+    uint32_t tail = atomic_load_explicit(&q->tail, memory_order_acquire);
+    return fill_of(head, tail, q->cap);
+}
+
 uint32_t audyn_audio_queue_capacity(const audyn_audio_queue_t *q)
 {
     return q ? q->cap : 0u;
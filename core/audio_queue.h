@@ -18,8 +18,21 @@
  *        uses NULL to signal an empty queue.
  *      - The queue is bounded. With capacity N, usable slots are N-1.
  *
+ *  Bulk:
+ *      - push_bulk()/pop_bulk() move a burst with one index publication;
+ *        each side re-reads the other's index only when its cached copy
+ *        shows the ring full (producer) or empty (consumer).
+ *
+ *  Consumer Wakeup (optional):
+ *      - audyn_audio_queue_enable_wakeup() attaches an eventfd. The consumer
+ *        then blocks in audyn_audio_queue_pop_wait() instead of polling.
+ *      - The producer only signals when the consumer is parked and the
+ *        requested fill level has been reached; otherwise push() costs one
+ *        extra fence and atomic load, and never a syscall.
+ *
  *  Dependencies:
  *      - Standard C: stdint.h
+ *      - Linux eventfd (wakeup only)
  *
  *  Copyright:
  *      (c) 2026 B. Wynne
@@ -68,6 +81,59 @@ int   audyn_audio_queue_push(audyn_audio_queue_t *q, void *ptr);
  */
 void *audyn_audio_queue_pop(audyn_audio_queue_t *q);
 
+/*
+ * Push up to n pointers in one publication (producer only).
+ *
+ * Real-time safe. Entries go in order; a NULL entry ends the batch.
+ *
+ * Returns the number pushed (0..n; fewer when the queue fills).
+ */
+uint32_t audyn_audio_queue_push_bulk(audyn_audio_queue_t *q, void *const *ptrs, uint32_t n);
+
+/*
+ * Pop up to max pointers into out[] in one step (consumer only).
+ *
+ * Real-time safe. At most one acquire load of the producer's index per
+ * call, however many entries are taken.
+ *
+ * Returns the number popped (0 if the queue is empty).
+ */
+uint32_t audyn_audio_queue_pop_bulk(audyn_audio_queue_t *q, void **out, uint32_t max);
+
+/*
+ * Enable blocking consumer wakeup (NOT real-time safe).
+ *
+ * Call before producer/consumer start. Idempotent.
+ *
+ * Returns 0 on success, -1 if the eventfd could not be created (the queue
+ * keeps working; pop_wait() then falls back to short sleeps).
+ */
+int audyn_audio_queue_enable_wakeup(audyn_audio_queue_t *q);
+
+/*
+ * Pop a pointer, blocking until one is available (consumer only).
+ *
+ * Parameters:
+ *   q          - queue
+ *   min_fill   - park until at least this many entries are queued (<= 1 =
+ *                any); lets a batching consumer take fewer wakeups
+ *   timeout_ms - maximum time to park
+ *
+ * Returns a pointer, or NULL on timeout / spurious wakeup. Entries already
+ * queued are returned without waiting for min_fill.
+ */
+void *audyn_audio_queue_pop_wait(audyn_audio_queue_t *q, uint32_t min_fill,
+                                 uint32_t timeout_ms);
+
+/*
+ * Wake a parked consumer unconditionally (e.g. on shutdown).
+ * Not intended for the real-time producer path.
+ */
+void audyn_audio_queue_wake(audyn_audio_queue_t *q);
+
+/* Number of queued entries (approximate while the other side runs). */
+uint32_t audyn_audio_queue_depth(const audyn_audio_queue_t *q);
+
 /* Returns the configured capacity (0 if q is NULL). */
 uint32_t audyn_audio_queue_capacity(const audyn_audio_queue_t *q);
 
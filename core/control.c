@@ -0,0 +1,157 @@
+/*
+ *  Audyn — Professional Audio Capture & Archival Engine
+ *
+ *  File:
+ *      control.c
+ *
+ *  Purpose:
+ *      Line-based control channel (see control.h).
+ *
+ *  Copyright:
+ *      (c) 2026 B. Wynne
+ *
+ *  Author:
+ *      B. Wynne
+ *
+ *  License:
+ *      GPLv2 or later
+ */
+
+#define _GNU_SOURCE
+
+#include "control.h"
+#include "log.h"
+
+#include <ctype.h>
+#include <errno.h>
+#include <poll.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+struct audyn_control {
+    int fd;
+    int closed;
+    int discarding;             /* Inside an overlong line: drop up to its newline */
+    size_t len;                 /* Bytes buffered */
+    char buf[AUDYN_CONTROL_LINE_MAX];
+};
+
+audyn_control_t *audyn_control_create(int fd)
+{
+    audyn_control_t *c = calloc(1, sizeof(*c));
+    if (!c) {
+        LOG_ERROR("control: failed to allocate structure");
+        return NULL;
+    }
+    c->fd = fd;
+    return c;
+}
+
+int audyn_control_poll(audyn_control_t *c, uint32_t timeout_ms)
+{
+    if (!c || c->closed) return -1;
+
+    /* Full buffer: nothing more fits until next() takes a line */
+    if (c->len == sizeof(c->buf)) {
+        (void)poll(NULL, 0, (int)timeout_ms);
+        return 0;
+    }
+
+    struct pollfd pfd = { .fd = c->fd, .events = POLLIN };
+    int rc = poll(&pfd, 1, (int)timeout_ms);
+    if (rc < 0) {
+        if (errno == EINTR) return 0;
+        LOG_ERROR("control: poll failed: %s", strerror(errno));
+        c->closed = 1;
+        return -1;
+    }
+    if (rc == 0) return 0;
+
+    /* A readable fd does not block read() for what is there */
+    ssize_t n = read(c->fd, c->buf + c->len, sizeof(c->buf) - c->len);
+    if (n < 0) {
+        if (errno == EINTR || errno == EAGAIN) return 0;
+        LOG_ERROR("control: read failed: %s", strerror(errno));
+        c->closed = 1;
+        return -1;
+    }
+    if (n == 0) {
+        c->closed = 1;
+        return -1;
+    }
+
+    c->len += (size_t)n;
+    return 1;
+}
+
+int audyn_control_next(audyn_control_t *c, char *line, size_t line_len)
+{
+    if (!c || !line || line_len == 0) return 0;
+
+    for (;;) {
+        char *nl = memchr(c->buf, '\n', c->len);
+        if (!nl) {
+            /* No room left for the rest of this line */
+            if (c->len == sizeof(c->buf)) {
+                c->len = 0;
+                c->discarding = 1;
+            }
+            return 0;
+        }
+
+        const size_t n = (size_t)(nl - c->buf);
+        const int discarded = c->discarding;
+        if (!discarded) {
+            size_t copy = n < line_len - 1 ? n : line_len - 1;
+            memcpy(line, c->buf, copy);
+            line[copy] = '\0';
+            if (copy > 0 && line[copy - 1] == '\r') line[copy - 1] = '\0';
+        }
+
+        c->len -= n + 1;
+        memmove(c->buf, nl + 1, c->len);
+        c->discarding = 0;
+
+        if (discarded) return -1;
+
+        /* Skip blank lines and comments */
+        const char *p = line;
+        while (isspace((unsigned char)*p)) p++;
+        if (*p == '\0' || *p == '#') continue;
+        return 1;
+    }
+}
+
+int audyn_control_split(char *line, char **words, int max)
+{
+    int n = 0;
+    char *save = NULL;
+    for (char *w = strtok_r(line, " \t", &save); w;
+         w = strtok_r(NULL, " \t", &save)) {
+        if (n == max) return -1;
+        words[n++] = w;
+    }
+    return n;
+}
+
+void audyn_control_reply(audyn_control_t *c, const char *fmt, ...)
+{
+    (void)c;
+
+    va_list ap;
+    va_start(ap, fmt);
+    flockfile(stdout);
+    vfprintf(stdout, fmt, ap);
+    fputc('\n', stdout);
+    fflush(stdout);
+    funlockfile(stdout);
+    va_end(ap);
+}
+
+void audyn_control_destroy(audyn_control_t *c)
+{
+    free(c);
+}
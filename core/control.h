@@ -0,0 +1,105 @@
+/*
+ *  Audyn — Professional Audio Capture & Archival Engine
+ *
+ *  File:
+ *      control.h
+ *
+ *  Purpose:
+ *      Line-based control channel (enabled with --control).
+ *
+ *      The supervising process writes one command per line to audyn's
+ *      stdin and reads one JSON reply per command from stdout, tagged
+ *      "type":"control" so it can share the stream with the JSON level
+ *      lines. The main thread polls the channel in place of its idle
+ *      sleep; commands are parsed there and handed to the worker, which
+ *      applies them between frames (see audyn.c).
+ *
+ *  Protocol:
+ *      set <key>=<value> [<key>=<value> ...]   Change settings (all or none)
+ *      get                                      Report the current settings
+ *
+ *      Lines are at most AUDYN_CONTROL_LINE_MAX - 1 bytes; blank lines and
+ *      lines starting with '#' are ignored. EOF on stdin closes the
+ *      channel but does not stop capture.
+ *
+ *  Threading:
+ *      - One thread (the main loop); not real-time safe
+ *
+ *  Dependencies:
+ *      - POSIX poll/read
+ *      - Audyn: log
+ *
+ *  Copyright:
+ *      (c) 2026 B. Wynne
+ *
+ *  Author:
+ *      B. Wynne
+ *
+ *  License:
+ *      GPLv2 or later
+ */
+
+#ifndef AUDYN_CONTROL_H
+#define AUDYN_CONTROL_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Longest command line, including the terminating NUL */
+#define AUDYN_CONTROL_LINE_MAX  1024
+
+/* Most key=value arguments in one command */
+#define AUDYN_CONTROL_MAX_ARGS  32
+
+typedef struct audyn_control audyn_control_t;
+
+/*
+ * Read commands from fd (not owned; normally STDIN_FILENO).
+ * Returns NULL on allocation failure (logged).
+ */
+audyn_control_t *audyn_control_create(int fd);
+
+/*
+ * Wait up to timeout_ms for input and buffer whatever has arrived.
+ *
+ * Returns:
+ *   1 if input was read, 0 on timeout, -1 once the input is closed
+ *   (EOF or error; later calls return -1 immediately)
+ */
+int audyn_control_poll(audyn_control_t *c, uint32_t timeout_ms);
+
+/*
+ * Take the next complete line from the buffered input, without its
+ * newline. Does not read.
+ *
+ * Returns:
+ *   1 with the line in 'line', 0 if no complete line is buffered, -1 if
+ *   an overlong line was discarded (reply with an error)
+ */
+int audyn_control_next(audyn_control_t *c, char *line, size_t line_len);
+
+/*
+ * Split a line in place on whitespace into at most max words.
+ * Returns the number of words, or -1 if there are more than max.
+ */
+int audyn_control_split(char *line, char **words, int max);
+
+/*
+ * Write one reply line (printf-style, newline added) to stdout and flush.
+ * The line is written in one piece with respect to other stdio output.
+ */
+void audyn_control_reply(audyn_control_t *c, const char *fmt, ...)
+    __attribute__((format(printf, 2, 3)));
+
+/* Free the channel (safe with NULL). Does not close the fd. */
+void audyn_control_destroy(audyn_control_t *c);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* AUDYN_CONTROL_H */
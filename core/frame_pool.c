@@ -16,18 +16,33 @@
  *  Threading Model:
  *      - Single consumer of the pool ("acquire" thread; typically RT)
  *      - Single producer returning frames ("release" thread; typically non-RT)
+ *      - A frame the acquire thread could not hand on goes back with
+ *        audyn_frame_return() onto a stack only that thread touches, so
+ *        neither end ever has a second writer.
  *
- *  Correctness Notes:
- *      - Frames are stable objects stored in pool->frames[]
- *      - The free list stores pointers to those stable objects
- *      - Publication order is critical: release must store the pointer
- *        before advertising it via the atomic 'top' count.
+ *  Free List:
+ *      - A ring of pointers to the stable objects in pool->frames[], with
+ *        free-running indices: head (acquire side) and tail (release side)
+ *        on separate cache lines, each next to its side's cached copy of
+ *        the other index. A side reloads the other's index (one acquire
+ *        load) only when its copy says empty/full.
+ *      - Publication order: release stores the pointers before the release
+ *        store of tail; acquire reads a slot only after the acquire load of
+ *        tail that covers it.
+ *      - release_bulk() returns a burst with one tail update.
+ *
+ *  Memory:
+ *      - Frame objects, the free ring, the PCM buffers and the optional
+ *        raw buffers are four slabs from audyn_rt_alloc(): zeroed and
+ *        pre-faulted at create time (locked, huge-page or NUMA-local in RT
+ *        mode). Per-frame buffers start on 64-byte boundaries.
  *
  *  Debug Features (optional):
- *      - Ownership assertion and buffer poisoning (AUDYN_DEBUG)
+ *      - Buffer poisoning on release (AUDYN_DEBUG)
  *
  *  Dependencies:
  *      - C11 atomics (<stdatomic.h>)
+ *      - Audyn: rt
  *
  *  Copyright:
  *      (c) 2026 B. Wynne
@@ -40,22 +55,49 @@
  */
 
 #include "frame_pool.h"
+#include "rt.h"
 
+#include <stdalign.h>
 #include <stdlib.h>
 #include <stdatomic.h>
 
 #ifdef AUDYN_DEBUG
-#include <assert.h>
 #include <math.h>
 #endif
 
+#define POOL_CACHE_LINE 64
+
+/* Largest ring: indices are free-running 32-bit counters */
+#define POOL_MAX_RING (1u << 30)
+
 struct audyn_frame_pool {
+    /* Read-only after create */
     audyn_audio_frame_t *frames;          /* Stable frame objects */
-    audyn_audio_frame_t **free_stack;     /* Stack of available frames (pointers) */
+    audyn_audio_frame_t **ring;           /* Free ring */
+    uint32_t mask;                        /* Ring size - 1 (power of two) */
     uint32_t capacity;                    /* Total frame count */
-    _Atomic uint32_t top;                 /* Number of free frames (SPSC) */
+    uint32_t frame_samples;               /* sample_frames * channels per buffer */
+    uint32_t frame_frames;                /* sample_frames per buffer */
+    float *data_slab;                     /* All frames' PCM buffers */
+    uint8_t *raw_slab;                    /* All frames' raw buffers, or NULL */
+
+    /* Acquire side */
+    alignas(POOL_CACHE_LINE) _Atomic uint32_t head;
+    uint32_t tail_cache;                  /* Acquire side's last view of tail */
+    uint32_t returned_n;                  /* Frames on the returned stack */
+    audyn_audio_frame_t **returned;       /* Given back by the acquire thread */
+
+    /* Release side */
+    alignas(POOL_CACHE_LINE) _Atomic uint32_t tail;
+    uint32_t head_cache;                  /* Release side's last view of head */
 };
 
+/* Bytes per frame buffer, rounded up to a cache line */
+static size_t slab_stride(size_t bytes)
+{
+    return (bytes + 63u) & ~(size_t)63u;
+}
+
 audyn_frame_pool_t *
 audyn_frame_pool_create(uint32_t pool_size,
                         uint32_t channels,
@@ -67,19 +109,38 @@ audyn_frame_pool_create(uint32_t pool_size,
     if (pool_size == 0 || channels == 0 || sample_frames_per_buffer == 0)
         return NULL;
 
-    pool = calloc(1, sizeof(*pool));
+    if (pool_size > POOL_MAX_RING)
+        return NULL;
+
+    uint32_t ring = 1;
+    while (ring < pool_size)
+        ring <<= 1;
+
+    /* Zeroed and 64-byte aligned, as the padded layout needs */
+    pool = audyn_rt_alloc(sizeof(*pool));
     if (!pool)
         return NULL;
 
-    pool->frames = calloc(pool_size, sizeof(audyn_audio_frame_t));
-    pool->free_stack = calloc(pool_size, sizeof(audyn_audio_frame_t *));
-    if (!pool->frames || !pool->free_stack) {
+    const size_t samples = (size_t)sample_frames_per_buffer * (size_t)channels;
+    const size_t stride = slab_stride(samples * sizeof(float));
+
+    pool->frames = audyn_rt_alloc((size_t)pool_size * sizeof(audyn_audio_frame_t));
+    pool->ring = audyn_rt_alloc((size_t)ring * sizeof(audyn_audio_frame_t *));
+    pool->returned = audyn_rt_alloc((size_t)pool_size * sizeof(audyn_audio_frame_t *));
+    pool->data_slab = audyn_rt_alloc((size_t)pool_size * stride);
+    if (!pool->frames || !pool->ring || !pool->returned || !pool->data_slab) {
         audyn_frame_pool_destroy(pool);
         return NULL;
     }
 
+    pool->mask = ring - 1;
     pool->capacity = pool_size;
-    atomic_init(&pool->top, pool_size);
+    pool->frame_samples = sample_frames_per_buffer * channels;
+    pool->frame_frames = sample_frames_per_buffer;
+    atomic_init(&pool->head, 0u);
+    atomic_init(&pool->tail, pool_size);
+    pool->tail_cache = pool_size;
+    pool->head_cache = 0;
 
     for (i = 0; i < pool_size; ++i) {
         audyn_audio_frame_t *frame = &pool->frames[i];
@@ -87,52 +148,107 @@ audyn_frame_pool_create(uint32_t pool_size,
         frame->sample_frames = sample_frames_per_buffer;
         frame->channels = channels;
         frame->pool = pool;
-
-        frame->data = calloc(
-            (size_t)sample_frames_per_buffer * (size_t)channels,
-            sizeof(float)
-        );
-
-        if (!frame->data) {
-            audyn_frame_pool_destroy(pool);
-            return NULL;
-        }
+        frame->data = (float *)((uint8_t *)pool->data_slab + (size_t)i * stride);
 
         /* Initially, all frames are free. */
-        pool->free_stack[i] = frame;
+        pool->ring[i] = frame;
     }
 
     return pool;
 }
 
+int
+audyn_frame_pool_enable_raw(audyn_frame_pool_t *pool, uint32_t bytes_per_sample)
+{
+    uint32_t i;
+
+    if (!pool || bytes_per_sample == 0 || bytes_per_sample > 4)
+        return -1;
+
+    if (pool->raw_slab)
+        return 0;
+
+    const size_t stride = slab_stride((size_t)pool->frame_samples * bytes_per_sample);
+    pool->raw_slab = audyn_rt_alloc((size_t)pool->capacity * stride);
+    if (!pool->raw_slab)
+        return -1;
+
+    for (i = 0; i < pool->capacity; ++i) {
+        audyn_audio_frame_t *frame = &pool->frames[i];
+
+        frame->raw = pool->raw_slab + (size_t)i * stride;
+        frame->raw_frames = 0;
+    }
+
+    return 0;
+}
+
+uint32_t
+audyn_frame_pool_frame_capacity(const audyn_frame_pool_t *pool)
+{
+    return pool ? pool->frame_frames : 0;
+}
+
 audyn_audio_frame_t *
 audyn_frame_acquire(audyn_frame_pool_t *pool)
 {
-    uint32_t t;
-
     if (!pool)
         return NULL;
 
-    /*
-     * SPSC pop:
-     *  - Acquire load of 'top' synchronizes with producer's release store,
-     *    ensuring free_stack[t-1] is fully published before we read it.
-     */
-    t = atomic_load_explicit(&pool->top, memory_order_acquire);
-    if (t == 0)
-        return NULL;
+    /* Frames this thread gave back are reused first */
+    if (pool->returned_n > 0)
+        return pool->returned[--pool->returned_n];
+
+    uint32_t head = atomic_load_explicit(&pool->head, memory_order_relaxed);
+    if (head == pool->tail_cache) {
+        /* Acquire pairs with the release store of tail in release_n() */
+        pool->tail_cache = atomic_load_explicit(&pool->tail, memory_order_acquire);
+        if (head == pool->tail_cache)
+            return NULL;    /* Exhausted */
+    }
 
-    /* Read pointer then decrement count. */
-    audyn_audio_frame_t *frame = pool->free_stack[t - 1];
-    atomic_store_explicit(&pool->top, t - 1, memory_order_relaxed);
+    audyn_audio_frame_t *frame = pool->ring[head & pool->mask];
+
+    /* Free the slot for the release side after reading it */
+    atomic_store_explicit(&pool->head, head + 1u, memory_order_release);
     return frame;
 }
 
+#ifdef AUDYN_DEBUG
+static void poison(audyn_audio_frame_t *frame)
+{
+    for (uint32_t i = 0; i < frame->sample_frames * frame->channels; ++i) {
+        frame->data[i] = NAN;
+    }
+}
+#endif
+
+/* Return n frames of this pool with one tail update. */
+static void release_n(audyn_frame_pool_t *pool, audyn_audio_frame_t *const *frames, uint32_t n)
+{
+    const uint32_t size = pool->mask + 1u;
+    uint32_t tail = atomic_load_explicit(&pool->tail, memory_order_relaxed);
+
+    if (tail - pool->head_cache + n > size) {
+        pool->head_cache = atomic_load_explicit(&pool->head, memory_order_acquire);
+        if (tail - pool->head_cache + n > size) {
+            /* Defensive: overflow indicates misuse (double-release, wrong pool, etc.) */
+            n = size - (tail - pool->head_cache);
+        }
+    }
+
+    for (uint32_t i = 0; i < n; ++i)
+        pool->ring[(tail + i) & pool->mask] = frames[i];
+
+    /* Publish the pointers before the new tail */
+    atomic_store_explicit(&pool->tail, tail + n, memory_order_release);
+}
+
 void
 audyn_frame_release(audyn_audio_frame_t *frame)
 {
     audyn_frame_pool_t *pool;
-    uint32_t t;
+    uint32_t tail;
 
     if (!frame)
         return;
@@ -141,50 +257,84 @@ audyn_frame_release(audyn_audio_frame_t *frame)
     if (!pool)
         return;
 
+    tail = atomic_load_explicit(&pool->tail, memory_order_relaxed);
+    if (tail - pool->head_cache > pool->mask) {
+        pool->head_cache = atomic_load_explicit(&pool->head, memory_order_acquire);
+        if (tail - pool->head_cache > pool->mask) {
+            /* Defensive: overflow indicates misuse (double-release, wrong pool, etc.) */
+            return;
+        }
+    }
+
 #ifdef AUDYN_DEBUG
-    assert(frame->pool == pool);
+    poison(frame);
 #endif
 
-    /*
-     * SPSC push:
-     *  - Store the pointer into free_stack[t] first
-     *  - Then release-store the updated 'top' so the consumer sees the pointer
-     */
-    t = atomic_load_explicit(&pool->top, memory_order_relaxed);
-    if (t >= pool->capacity) {
-        /* Defensive: overflow indicates misuse (double-release, wrong pool, etc.) */
+    /* Store the pointer, then publish it with the new tail */
+    pool->ring[tail & pool->mask] = frame;
+    atomic_store_explicit(&pool->tail, tail + 1u, memory_order_release);
+}
+
+void
+audyn_frame_release_bulk(audyn_audio_frame_t *const *frames, uint32_t n)
+{
+    uint32_t i = 0;
+
+    if (!frames)
         return;
-    }
+
+    /* Runs of frames from the same pool go back together */
+    while (i < n) {
+        if (!frames[i] || !frames[i]->pool) {
+            i++;
+            continue;
+        }
+
+        audyn_frame_pool_t *pool = frames[i]->pool;
+        uint32_t j = i + 1;
+        while (j < n && frames[j] && frames[j]->pool == pool)
+            j++;
 
 #ifdef AUDYN_DEBUG
-    for (uint32_t i = 0; i < frame->sample_frames * frame->channels; ++i) {
-        frame->data[i] = NAN;
+        for (uint32_t k = i; k < j; ++k)
+            poison(frames[k]);
+#endif
+
+        release_n(pool, frames + i, j - i);
+        i = j;
     }
+}
+
+void
+audyn_frame_return(audyn_audio_frame_t *frame)
+{
+    if (!frame || !frame->pool)
+        return;
+
+    audyn_frame_pool_t *pool = frame->pool;
+
+    /* Defensive: more than the pool holds indicates misuse */
+    if (pool->returned_n >= pool->capacity)
+        return;
+
+#ifdef AUDYN_DEBUG
+    poison(frame);
 #endif
 
-    pool->free_stack[t] = frame;
-    atomic_store_explicit(&pool->top, t + 1, memory_order_release);
+    pool->returned[pool->returned_n++] = frame;
 }
 
 void
 audyn_frame_pool_destroy(audyn_frame_pool_t *pool)
 {
-    uint32_t i;
-
     if (!pool)
         return;
 
-    if (pool->frames) {
-        for (i = 0; i < pool->capacity; ++i) {
-            free(pool->frames[i].data);
-            pool->frames[i].data = NULL;
-        }
-        free(pool->frames);
-        pool->frames = NULL;
-    }
-
-    free(pool->free_stack);
-    pool->free_stack = NULL;
+    audyn_rt_free(pool->raw_slab);
+    audyn_rt_free(pool->data_slab);
+    audyn_rt_free(pool->frames);
+    audyn_rt_free(pool->returned);
+    audyn_rt_free(pool->ring);
 
-    free(pool);
+    audyn_rt_free(pool);
 }
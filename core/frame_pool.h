@@ -57,6 +57,21 @@ typedef struct audyn_audio_frame {
     uint32_t sample_frames;         /* Number of sample frames */
     uint32_t channels;              /* Channel count */
     audyn_frame_pool_t *pool;       /* Owning pool (internal use) */
+
+    /* Optional packed integer copy of the same audio, in file byte order
+     * (see audyn_frame_pool_enable_raw). Valid only when raw_frames ==
+     * sample_frames; producers set raw_frames = 0 when they fill data only. */
+    uint8_t *raw;                   /* NULL unless enabled on the pool */
+    uint32_t raw_frames;
+
+    /* When the first sample frame was due, in the producer's PTP timebase
+     * (nanoseconds), or 0 if unknown. Producers set it on every fill. */
+    uint64_t media_ns;
+
+    /* CLOCK_MONOTONIC when the producer queued the frame, or 0 when
+     * metrics are off (audyn_metrics_start()). Feeds the queue dwell
+     * histogram. */
+    uint64_t queued_ns;
 } audyn_audio_frame_t;
 
 /*
@@ -73,11 +88,33 @@ audyn_frame_pool_t *audyn_frame_pool_create(
     uint32_t sample_frames_per_buffer
 );
 
+/*
+ * Give every frame a raw buffer of sample_frames_per_buffer * channels *
+ * bytes_per_sample bytes (e.g. 3 for packed 24-bit passthrough).
+ *
+ * Must be called before the first acquire. NOT real-time safe.
+ *
+ * Returns 0 on success, -1 on error.
+ */
+int audyn_frame_pool_enable_raw(
+    audyn_frame_pool_t *pool,
+    uint32_t bytes_per_sample
+);
+
+/*
+ * Sample frames each buffer holds (sample_frames_per_buffer at create).
+ * Producers that fill frames partially size their copies with this, not
+ * with frame->sample_frames, which holds the previous fill.
+ */
+uint32_t audyn_frame_pool_frame_capacity(
+    const audyn_frame_pool_t *pool
+);
+
 /*
  * Acquire an audio frame object from the pool.
  *
  * Real-time safe:
- *      - Lock-free (SPSC)
+ *      - Lock-free (SPSC: one acquiring thread at a time)
  *      - Constant time
  *      - Non-blocking
  *
@@ -92,13 +129,33 @@ audyn_audio_frame_t *audyn_frame_acquire(
 /*
  * Release an audio frame object back to its owning pool.
  *
- * Lock-free (SPSC). The frame must originate from audyn_frame_acquire().
+ * Lock-free (SPSC: one releasing thread at a time, usually the consumer of
+ * the audio queue). The frame must originate from audyn_frame_acquire().
  * The frame's owning pool is frame->pool.
  */
 void audyn_frame_release(
     audyn_audio_frame_t *frame
 );
 
+/*
+ * Release n frames (e.g. a drained burst). Consecutive frames of the same
+ * pool go back with one index update. NULL entries are skipped. Same
+ * thread rules as audyn_frame_release().
+ */
+void audyn_frame_release_bulk(
+    audyn_audio_frame_t *const *frames,
+    uint32_t n
+);
+
+/*
+ * Give back a frame the acquiring thread did not hand on (e.g. the audio
+ * queue was full). Call from the thread that acquired it; the next
+ * audyn_frame_acquire() reuses it. Real-time safe.
+ */
+void audyn_frame_return(
+    audyn_audio_frame_t *frame
+);
+
 /*
  * Destroy a frame pool and free all associated memory.
  *
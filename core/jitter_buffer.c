@@ -52,6 +52,8 @@ struct audyn_jitter_buffer {
 
     /* Packet storage */
     audyn_jb_packet_t *packets; /* Circular buffer */
+    uint8_t *payloads;          /* buffer_size * slot_bytes, slots point here */
+    uint32_t slot_bytes;        /* Maximum payload per packet */
 
     /* Sequence tracking */
     int initialized;            /* 1 if we've received first packet */
@@ -60,6 +62,8 @@ struct audyn_jitter_buffer {
 
     /* Timing */
     uint64_t playout_time_ns;   /* PTP time for next playout */
+    uint64_t playout_base_ns;   /* Whole-second playout reference */
+    uint64_t playout_samples;   /* Samples since playout_base_ns (< sample_rate) */
     uint64_t packet_duration_ns;/* Duration of one packet in ns */
 
     /* Thread safety */
@@ -69,6 +73,29 @@ struct audyn_jitter_buffer {
     audyn_jb_stats_t stats;
 };
 
+/*
+ * Playout clock. Slot times are derived from a sample count rebased every
+ * second rather than accumulated per packet, so non-integer packet
+ * durations (e.g. 48 samples at 44.1 kHz) do not drift.
+ */
+static inline void playout_start(audyn_jitter_buffer_t *jb, uint64_t start_ns)
+{
+    jb->playout_base_ns = start_ns;
+    jb->playout_samples = 0;
+    jb->playout_time_ns = start_ns;
+}
+
+static inline void playout_advance(audyn_jitter_buffer_t *jb)
+{
+    jb->playout_samples += jb->cfg.samples_per_packet;
+    while (jb->playout_samples >= jb->cfg.sample_rate) {
+        jb->playout_samples -= jb->cfg.sample_rate;
+        jb->playout_base_ns += 1000000000ULL;
+    }
+    jb->playout_time_ns = jb->playout_base_ns +
+        jb->playout_samples * 1000000000ULL / jb->cfg.sample_rate;
+}
+
 /*
  * Create a jitter buffer instance.
  */
@@ -103,16 +130,27 @@ audyn_jitter_buffer_t *audyn_jb_create(const audyn_jb_cfg_t *cfg)
     if (jb->buffer_size < 16) jb->buffer_size = 16;
     if (jb->buffer_size > 1024) jb->buffer_size = 1024;
 
+    /* Slot payload size: one full packet of the configured layout */
+    uint32_t bytes_per_sample = (cfg->bits_per_sample > 16) ? 3U : 2U;
+    jb->slot_bytes = cfg->channels * cfg->samples_per_packet * bytes_per_sample;
+
     jb->packets = calloc(jb->buffer_size, sizeof(audyn_jb_packet_t));
-    if (!jb->packets) {
+    jb->payloads = calloc(jb->buffer_size, jb->slot_bytes);
+    if (!jb->packets || !jb->payloads) {
         LOG_ERROR("JB: Failed to allocate packet buffer");
+        free(jb->payloads);
+        free(jb->packets);
         free(jb);
         return NULL;
     }
+    for (uint32_t i = 0; i < jb->buffer_size; i++) {
+        jb->packets[i].payload = jb->payloads + (size_t)i * jb->slot_bytes;
+    }
 
     /* Initialize mutex */
     if (pthread_mutex_init(&jb->lock, NULL) != 0) {
         LOG_ERROR("JB: Failed to initialize mutex");
+        free(jb->payloads);
         free(jb->packets);
         free(jb);
         return NULL;
@@ -154,6 +192,7 @@ void audyn_jb_destroy(audyn_jitter_buffer_t *jb)
               (unsigned long)jb->stats.packets_reordered);
 
     pthread_mutex_destroy(&jb->lock);
+    free(jb->payloads);
     free(jb->packets);
     free(jb);
 }
@@ -180,8 +219,8 @@ int audyn_jb_insert(audyn_jitter_buffer_t *jb,
         return -1;
     }
 
-    if (payload_len > AUDYN_JB_MAX_PAYLOAD) {
-        LOG_ERROR("JB: Payload too large: %u > %u", payload_len, AUDYN_JB_MAX_PAYLOAD);
+    if (payload_len > jb->slot_bytes) {
+        LOG_ERROR("JB: Payload too large: %u > %u", payload_len, jb->slot_bytes);
         return -1;
     }
 
@@ -193,7 +232,7 @@ int audyn_jb_insert(audyn_jitter_buffer_t *jb,
     if (!jb->initialized) {
         jb->next_seq = seq;
         jb->highest_seq = seq;
-        jb->playout_time_ns = arrival_ns + (jb->cfg.depth_ms * NS_PER_MS);
+        playout_start(jb, arrival_ns + (jb->cfg.depth_ms * NS_PER_MS));
         jb->initialized = 1;
         LOG_DEBUG("JB: First packet - seq=%u, playout starts at +%ums",
                   seq, jb->cfg.depth_ms);
@@ -215,7 +254,7 @@ int audyn_jb_insert(audyn_jitter_buffer_t *jb,
             jb_reset_unlocked(jb);
             jb->next_seq = seq;
             jb->highest_seq = seq;
-            jb->playout_time_ns = arrival_ns + (jb->cfg.depth_ms * NS_PER_MS);
+            playout_start(jb, arrival_ns + (jb->cfg.depth_ms * NS_PER_MS));
             jb->initialized = 1;
         }
     }
@@ -245,7 +284,7 @@ int audyn_jb_insert(audyn_jitter_buffer_t *jb,
             }
             jb->packets[skip_index].valid = 0;
             jb->next_seq++;
-            jb->playout_time_ns += jb->packet_duration_ns;
+            playout_advance(jb);
         }
         jb->stats.buffer_overflows++;
     }
@@ -312,7 +351,7 @@ audyn_jb_packet_t *audyn_jb_get(audyn_jitter_buffer_t *jb)
         /* Got the expected packet */
         slot->valid = 0;  /* Mark as consumed */
         jb->next_seq++;
-        jb->playout_time_ns += jb->packet_duration_ns;
+        playout_advance(jb);
         jb->stats.packets_played++;
 
         /* Update depth */
@@ -332,7 +371,7 @@ audyn_jb_packet_t *audyn_jb_get(audyn_jitter_buffer_t *jb)
         jb->stats.packets_lost++;
         LOG_DEBUG("JB: Lost packet seq=%u (highest=%u)", jb->next_seq, jb->highest_seq);
         jb->next_seq++;
-        jb->playout_time_ns += jb->packet_duration_ns;
+        playout_advance(jb);
         /* Return NULL - caller should insert silence */
     }
 
@@ -382,6 +421,54 @@ int audyn_jb_ready(audyn_jitter_buffer_t *jb, uint64_t current_ns)
     return 0;  /* Still waiting */
 }
 
+/*
+ * Time-driven playout: ready() + get() under one lock.
+ */
+int audyn_jb_poll(audyn_jitter_buffer_t *jb, uint64_t current_ns,
+                  audyn_jb_packet_t **pkt)
+{
+    if (!jb || !pkt) {
+        return 0;
+    }
+
+    *pkt = NULL;
+
+    pthread_mutex_lock(&jb->lock);
+
+    if (!jb->initialized || current_ns < jb->playout_time_ns) {
+        pthread_mutex_unlock(&jb->lock);
+        return 0;
+    }
+
+    uint32_t index = seq_to_index(jb, jb->next_seq);
+    audyn_jb_packet_t *slot = &jb->packets[index];
+    int played = 0;
+
+    if (slot->valid && slot->seq == jb->next_seq) {
+        slot->valid = 0;
+        jb->stats.packets_played++;
+        *pkt = slot;
+        played = 1;
+    } else if (seq_compare(jb->highest_seq, jb->next_seq) > 0) {
+        /* Deadline passed and later packets exist - conceal */
+        jb->stats.packets_lost++;
+        LOG_DEBUG("JB: Lost packet seq=%u (highest=%u)", jb->next_seq, jb->highest_seq);
+        played = 1;
+    }
+
+    if (played) {
+        jb->next_seq++;
+        playout_advance(jb);
+
+        int32_t depth = seq_compare(jb->highest_seq, jb->next_seq) + 1;
+        if (depth < 0) depth = 0;
+        jb->stats.current_depth = depth;
+    }
+
+    pthread_mutex_unlock(&jb->lock);
+    return played;
+}
+
 /*
  * Internal reset - called with lock already held.
  */
@@ -395,7 +482,7 @@ static void jb_reset_unlocked(audyn_jitter_buffer_t *jb)
     jb->initialized = 0;
     jb->next_seq = 0;
     jb->highest_seq = 0;
-    jb->playout_time_ns = 0;
+    playout_start(jb, 0);
 
     /* Keep cumulative stats but reset current depth */
     jb->stats.current_depth = 0;
@@ -13,6 +13,9 @@
  *        3. Provides timing-correct playout based on RTP timestamps
  *        4. Thread-safe: insert() and get() can be called from different threads
  *
+ *      All packet storage is allocated at create time (sized from the
+ *      configured stream layout); insert/get/poll never allocate.
+ *
  *      For AES67:
  *        - Packets are 1ms nominal (48 samples @ 48kHz)
  *        - Jitter buffer depth typically 1-4ms for low latency
@@ -38,14 +41,11 @@
 extern "C" {
 #endif
 
-/* Maximum packet payload size (enough for 48 samples * 8 channels * 3 bytes) */
-#define AUDYN_JB_MAX_PAYLOAD 1152
-
 /* Jitter buffer configuration */
 typedef struct audyn_jb_cfg {
     uint32_t sample_rate;       /* Audio sample rate (e.g., 48000) */
-    uint32_t channels;          /* Number of audio channels */
-    uint32_t bits_per_sample;   /* Bits per sample (16 or 24) */
+    uint32_t channels;          /* Number of audio channels in the RTP stream */
+    uint32_t bits_per_sample;   /* Bits per sample (16 or 24); sizes slot payloads */
     uint32_t samples_per_packet;/* Samples per RTP packet (e.g., 48) */
     uint32_t depth_ms;          /* Buffer depth in milliseconds (e.g., 4) */
 } audyn_jb_cfg_t;
@@ -57,7 +57,7 @@ typedef struct audyn_jb_packet {
     uint32_t rtp_ts;            /* RTP timestamp */
     uint64_t arrival_ptp_ns;    /* PTP arrival time (nanoseconds) */
     uint32_t payload_len;       /* Payload length in bytes */
-    uint8_t payload[AUDYN_JB_MAX_PAYLOAD];
+    uint8_t *payload;           /* Slot storage (owned by the jitter buffer) */
 } audyn_jb_packet_t;
 
 /* Jitter buffer statistics */
@@ -98,6 +98,9 @@ void audyn_jb_destroy(audyn_jitter_buffer_t *jb);
  *   payload       - Packet audio payload
  *   payload_len   - Payload length in bytes
  *
+ * The payload may be at most channels * samples_per_packet *
+ * bits_per_sample / 8 bytes.
+ *
  * Returns 0 on success, -1 on failure (e.g., buffer full, packet too late).
  */
 int audyn_jb_insert(audyn_jitter_buffer_t *jb,
@@ -131,6 +134,28 @@ audyn_jb_packet_t *audyn_jb_get(audyn_jitter_buffer_t *jb);
  */
 int audyn_jb_ready(audyn_jitter_buffer_t *jb, uint64_t current_ns);
 
+/*
+ * Time-driven playout: pop the next slot if its playout time has come.
+ *
+ * Combines audyn_jb_ready() and audyn_jb_get() under one lock. Once the
+ * playout time of the next sequence number has passed, a missing packet
+ * is declared lost as soon as any later packet has been received (rather
+ * than waiting for the sequence-gap threshold), so gaps are concealed on
+ * schedule. If nothing later has arrived (stream stalled), nothing is
+ * reported.
+ *
+ * Parameters:
+ *   jb            - Jitter buffer instance
+ *   current_ns    - Current time, same timebase as insert() arrival_ns
+ *   pkt           - Receives the packet, or NULL for a lost packet
+ *                   (caller should insert silence). Valid until the next
+ *                   get()/poll() call.
+ *
+ * Returns 1 if a slot was played out (packet or loss), 0 if nothing is due.
+ */
+int audyn_jb_poll(audyn_jitter_buffer_t *jb, uint64_t current_ns,
+                  audyn_jb_packet_t **pkt);
+
 /*
  * Reset the jitter buffer.
  *
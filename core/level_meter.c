@@ -7,6 +7,21 @@
  *  Purpose:
  *      Real-time audio level metering with RMS and peak detection.
  *
+ *  Kernels:
+ *      Interleaved input is scanned in "periods" of P floats, P a multiple
+ *      of both the channel count and the vector width, so every vector lane
+ *      always sees the same channel and no shuffling is needed. Each kernel
+ *      keeps four vector accumulator pairs (sum of squares, abs peak) in
+ *      registers and walks down the block one period at a time.
+ *
+ *      Partials are per period position, float, and persist across blocks;
+ *      they are folded into the per-channel double sums once
+ *      AUDYN_METER_FOLD_SAMPLES periods have been added and whenever levels
+ *      are computed, so small blocks pay no per-block fold.
+ *
+ *      Without SIMD the meter keeps the plain per-sample loop, which adds
+ *      each square straight into the double sums.
+ *
  *  Copyright:
  *      (c) 2026 B. Wynne
  *
@@ -15,6 +30,7 @@
  */
 
 #include "level_meter.h"
+#include "level_shm.h"
 #include "log.h"
 
 #include <stdio.h>
@@ -23,6 +39,17 @@
 #include <math.h>
 #include <time.h>
 
+#if !defined(AUDYN_PCM_NO_SIMD) && (defined(__x86_64__) || defined(__i386__)) && \
+    (defined(__GNUC__) || defined(__clang__))
+#define LVL_HAVE_X86 1
+#include <immintrin.h>
+#endif
+
+#if !defined(AUDYN_PCM_NO_SIMD) && (defined(__ARM_NEON) || defined(__ARM_NEON__))
+#define LVL_HAVE_NEON 1
+#include <arm_neon.h>
+#endif
+
 /* Minimum dB value (silence threshold) */
 #define MIN_DB -60.0f
 
@@ -32,6 +59,13 @@
 /* Clipping threshold (slightly below 1.0 to catch near-clips) */
 #define CLIP_THRESHOLD 0.99f
 
+static uint64_t monotonic_ms(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000 + (uint64_t)ts.tv_nsec / 1000000;
+}
+
 /* Convert linear to dB, clamped to MIN_DB */
 static float linear_to_db(float linear)
 {
@@ -42,6 +76,255 @@ static float linear_to_db(float linear)
     return (db < MIN_DB) ? MIN_DB : db;
 }
 
+/* -------- Kernels -------- */
+
+#ifdef LVL_HAVE_X86
+
+/* period is a multiple of 4 and at least 16 */
+__attribute__((target("sse4.1")))
+static void level_sse4(const float *x, uint32_t periods, uint32_t period,
+                       float *sq, float *pk)
+{
+    const __m128 absmask = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+
+    uint32_t v = 0;
+    for (; v + 16 <= period; v += 16) {
+        __m128 s0 = _mm_loadu_ps(sq + v),      p0 = _mm_loadu_ps(pk + v);
+        __m128 s1 = _mm_loadu_ps(sq + v + 4),  p1 = _mm_loadu_ps(pk + v + 4);
+        __m128 s2 = _mm_loadu_ps(sq + v + 8),  p2 = _mm_loadu_ps(pk + v + 8);
+        __m128 s3 = _mm_loadu_ps(sq + v + 12), p3 = _mm_loadu_ps(pk + v + 12);
+        const float *px = x + v;
+
+        for (uint32_t i = 0; i < periods; i++, px += period) {
+            const __m128 a0 = _mm_loadu_ps(px);
+            const __m128 a1 = _mm_loadu_ps(px + 4);
+            const __m128 a2 = _mm_loadu_ps(px + 8);
+            const __m128 a3 = _mm_loadu_ps(px + 12);
+            s0 = _mm_add_ps(s0, _mm_mul_ps(a0, a0));
+            s1 = _mm_add_ps(s1, _mm_mul_ps(a1, a1));
+            s2 = _mm_add_ps(s2, _mm_mul_ps(a2, a2));
+            s3 = _mm_add_ps(s3, _mm_mul_ps(a3, a3));
+            /* max(|a|, p) returns p for NaN input, as the scalar compare does */
+            p0 = _mm_max_ps(_mm_and_ps(a0, absmask), p0);
+            p1 = _mm_max_ps(_mm_and_ps(a1, absmask), p1);
+            p2 = _mm_max_ps(_mm_and_ps(a2, absmask), p2);
+            p3 = _mm_max_ps(_mm_and_ps(a3, absmask), p3);
+        }
+
+        _mm_storeu_ps(sq + v, s0);      _mm_storeu_ps(pk + v, p0);
+        _mm_storeu_ps(sq + v + 4, s1);  _mm_storeu_ps(pk + v + 4, p1);
+        _mm_storeu_ps(sq + v + 8, s2);  _mm_storeu_ps(pk + v + 8, p2);
+        _mm_storeu_ps(sq + v + 12, s3); _mm_storeu_ps(pk + v + 12, p3);
+    }
+
+    /* Remaining columns one vector at a time */
+    for (; v < period; v += 4) {
+        __m128 s0 = _mm_loadu_ps(sq + v), p0 = _mm_loadu_ps(pk + v);
+        const float *px = x + v;
+        for (uint32_t i = 0; i < periods; i++, px += period) {
+            const __m128 a0 = _mm_loadu_ps(px);
+            s0 = _mm_add_ps(s0, _mm_mul_ps(a0, a0));
+            p0 = _mm_max_ps(_mm_and_ps(a0, absmask), p0);
+        }
+        _mm_storeu_ps(sq + v, s0); _mm_storeu_ps(pk + v, p0);
+    }
+}
+
+/* period is a multiple of 8 and at least 32 */
+__attribute__((target("avx2")))
+static void level_avx2(const float *x, uint32_t periods, uint32_t period,
+                       float *sq, float *pk)
+{
+    const __m256 absmask = _mm256_castsi256_ps(_mm256_set1_epi32(0x7fffffff));
+
+    uint32_t v = 0;
+    for (; v + 32 <= period; v += 32) {
+        __m256 s0 = _mm256_loadu_ps(sq + v),      p0 = _mm256_loadu_ps(pk + v);
+        __m256 s1 = _mm256_loadu_ps(sq + v + 8),  p1 = _mm256_loadu_ps(pk + v + 8);
+        __m256 s2 = _mm256_loadu_ps(sq + v + 16), p2 = _mm256_loadu_ps(pk + v + 16);
+        __m256 s3 = _mm256_loadu_ps(sq + v + 24), p3 = _mm256_loadu_ps(pk + v + 24);
+        const float *px = x + v;
+
+        for (uint32_t i = 0; i < periods; i++, px += period) {
+            const __m256 a0 = _mm256_loadu_ps(px);
+            const __m256 a1 = _mm256_loadu_ps(px + 8);
+            const __m256 a2 = _mm256_loadu_ps(px + 16);
+            const __m256 a3 = _mm256_loadu_ps(px + 24);
+            s0 = _mm256_add_ps(s0, _mm256_mul_ps(a0, a0));
+            s1 = _mm256_add_ps(s1, _mm256_mul_ps(a1, a1));
+            s2 = _mm256_add_ps(s2, _mm256_mul_ps(a2, a2));
+            s3 = _mm256_add_ps(s3, _mm256_mul_ps(a3, a3));
+            p0 = _mm256_max_ps(_mm256_and_ps(a0, absmask), p0);
+            p1 = _mm256_max_ps(_mm256_and_ps(a1, absmask), p1);
+            p2 = _mm256_max_ps(_mm256_and_ps(a2, absmask), p2);
+            p3 = _mm256_max_ps(_mm256_and_ps(a3, absmask), p3);
+        }
+
+        _mm256_storeu_ps(sq + v, s0);      _mm256_storeu_ps(pk + v, p0);
+        _mm256_storeu_ps(sq + v + 8, s1);  _mm256_storeu_ps(pk + v + 8, p1);
+        _mm256_storeu_ps(sq + v + 16, s2); _mm256_storeu_ps(pk + v + 16, p2);
+        _mm256_storeu_ps(sq + v + 24, s3); _mm256_storeu_ps(pk + v + 24, p3);
+    }
+
+    for (; v < period; v += 8) {
+        __m256 s0 = _mm256_loadu_ps(sq + v), p0 = _mm256_loadu_ps(pk + v);
+        const float *px = x + v;
+        for (uint32_t i = 0; i < periods; i++, px += period) {
+            const __m256 a0 = _mm256_loadu_ps(px);
+            s0 = _mm256_add_ps(s0, _mm256_mul_ps(a0, a0));
+            p0 = _mm256_max_ps(_mm256_and_ps(a0, absmask), p0);
+        }
+        _mm256_storeu_ps(sq + v, s0); _mm256_storeu_ps(pk + v, p0);
+    }
+}
+
+#endif /* LVL_HAVE_X86 */
+
+#ifdef LVL_HAVE_NEON
+
+/* period is a multiple of 4 and at least 16 */
+static void level_neon(const float *x, uint32_t periods, uint32_t period,
+                       float *sq, float *pk)
+{
+    uint32_t v = 0;
+    for (; v + 16 <= period; v += 16) {
+        float32x4_t s0 = vld1q_f32(sq + v),      p0 = vld1q_f32(pk + v);
+        float32x4_t s1 = vld1q_f32(sq + v + 4),  p1 = vld1q_f32(pk + v + 4);
+        float32x4_t s2 = vld1q_f32(sq + v + 8),  p2 = vld1q_f32(pk + v + 8);
+        float32x4_t s3 = vld1q_f32(sq + v + 12), p3 = vld1q_f32(pk + v + 12);
+        const float *px = x + v;
+
+        for (uint32_t i = 0; i < periods; i++, px += period) {
+            const float32x4_t a0 = vld1q_f32(px);
+            const float32x4_t a1 = vld1q_f32(px + 4);
+            const float32x4_t a2 = vld1q_f32(px + 8);
+            const float32x4_t a3 = vld1q_f32(px + 12);
+            s0 = vmlaq_f32(s0, a0, a0);
+            s1 = vmlaq_f32(s1, a1, a1);
+            s2 = vmlaq_f32(s2, a2, a2);
+            s3 = vmlaq_f32(s3, a3, a3);
+            /* Select on |a| > p so NaN input keeps the peak (vmaxq propagates NaN) */
+            const float32x4_t b0 = vabsq_f32(a0), b1 = vabsq_f32(a1);
+            const float32x4_t b2 = vabsq_f32(a2), b3 = vabsq_f32(a3);
+            p0 = vbslq_f32(vcgtq_f32(b0, p0), b0, p0);
+            p1 = vbslq_f32(vcgtq_f32(b1, p1), b1, p1);
+            p2 = vbslq_f32(vcgtq_f32(b2, p2), b2, p2);
+            p3 = vbslq_f32(vcgtq_f32(b3, p3), b3, p3);
+        }
+
+        vst1q_f32(sq + v, s0);      vst1q_f32(pk + v, p0);
+        vst1q_f32(sq + v + 4, s1);  vst1q_f32(pk + v + 4, p1);
+        vst1q_f32(sq + v + 8, s2);  vst1q_f32(pk + v + 8, p2);
+        vst1q_f32(sq + v + 12, s3); vst1q_f32(pk + v + 12, p3);
+    }
+
+    for (; v < period; v += 4) {
+        float32x4_t s0 = vld1q_f32(sq + v), p0 = vld1q_f32(pk + v);
+        const float *px = x + v;
+        for (uint32_t i = 0; i < periods; i++, px += period) {
+            const float32x4_t a0 = vld1q_f32(px);
+            const float32x4_t b0 = vabsq_f32(a0);
+            s0 = vmlaq_f32(s0, a0, a0);
+            p0 = vbslq_f32(vcgtq_f32(b0, p0), b0, p0);
+        }
+        vst1q_f32(sq + v, s0); vst1q_f32(pk + v, p0);
+    }
+}
+
+#endif /* LVL_HAVE_NEON */
+
+static uint32_t gcd_u32(uint32_t a, uint32_t b)
+{
+    while (b) {
+        uint32_t t = a % b;
+        a = b;
+        b = t;
+    }
+    return a;
+}
+
+/*
+ * Bind the kernel for isa. The period is the smallest multiple of both the
+ * channel count and the vector width, doubled until it holds four vectors
+ * so the kernel has independent accumulators. Scalar has no kernel: it
+ * runs the per-sample loop straight into the double sums.
+ */
+static void select_kernel(audyn_level_meter_t *meter, audyn_pcm_isa_t isa)
+{
+    uint32_t width = 1;
+
+    meter->kernel = NULL;
+    meter->kernel_name = "level-scalar";
+
+    switch (isa) {
+#ifdef LVL_HAVE_X86
+        case AUDYN_PCM_ISA_AVX2:
+            meter->kernel = level_avx2;
+            meter->kernel_name = "level-avx2";
+            width = 8;
+            break;
+        case AUDYN_PCM_ISA_SSE4:
+            meter->kernel = level_sse4;
+            meter->kernel_name = "level-sse4.1";
+            width = 4;
+            break;
+#endif
+#ifdef LVL_HAVE_NEON
+        case AUDYN_PCM_ISA_NEON:
+            meter->kernel = level_neon;
+            meter->kernel_name = "level-neon";
+            width = 4;
+            break;
+#endif
+        default:
+            break;
+    }
+
+    uint32_t period = meter->channels / gcd_u32(meter->channels, width) * width;
+    const uint32_t min_period = 4 * width;
+    while (period < min_period) {
+        period *= 2;
+    }
+    meter->period = period;
+    meter->width = width;
+}
+
+/* Fold the float partials into the per-channel double sums */
+static void fold_partials(audyn_level_meter_t *meter)
+{
+    if (meter->pending_periods == 0) {
+        return;
+    }
+
+    const uint32_t ch = meter->channels;
+    for (uint32_t j = 0, c = 0; j < meter->period; j++) {
+        meter->sum_sq[c] += (double)meter->sq_part[j];
+        if (meter->pk_part[j] > meter->peak[c]) meter->peak[c] = meter->pk_part[j];
+        if (++c == ch) c = 0;
+    }
+    memset(meter->sq_part, 0, meter->period * sizeof(float));
+    memset(meter->pk_part, 0, meter->period * sizeof(float));
+    meter->pending_periods = 0;
+}
+
+int audyn_level_meter_set_isa(audyn_level_meter_t *meter, audyn_pcm_isa_t isa)
+{
+    if (!meter) return -1;
+
+    audyn_pcm_isa_t best = audyn_pcm_best_isa();
+    if (isa == AUDYN_PCM_ISA_AUTO) {
+        isa = best;
+    } else if (isa != AUDYN_PCM_ISA_SCALAR && isa != best &&
+               !(isa == AUDYN_PCM_ISA_SSE4 && best == AUDYN_PCM_ISA_AVX2)) {
+        return -1;
+    }
+
+    /* Partials are laid out by the old period */
+    fold_partials(meter);
+    select_kernel(meter, isa);
+    return 0;
+}
+
 audyn_level_meter_t *audyn_level_meter_create(
     uint32_t channels,
     uint32_t sample_rate,
@@ -68,6 +351,8 @@ audyn_level_meter_t *audyn_level_meter_create(
     meter->sample_rate = sample_rate;
     meter->output_interval_ms = output_interval_ms > 0 ? output_interval_ms : 33;
     meter->peak_hold_samples = (uint64_t)(PEAK_HOLD_TIME * sample_rate);
+    meter->json = 1;
+    select_kernel(meter, audyn_pcm_best_isa());
 
     /* Initialize levels to silence */
     for (uint32_t i = 0; i < channels; i++) {
@@ -78,8 +363,8 @@ audyn_level_meter_t *audyn_level_meter_create(
         meter->levels[i].clipping = 0;
     }
 
-    LOG_DEBUG("level_meter: created (channels=%u rate=%u interval=%ums)",
-              channels, sample_rate, meter->output_interval_ms);
+    LOG_DEBUG("level_meter: created (channels=%u rate=%u interval=%ums kernel=%s)",
+              channels, sample_rate, meter->output_interval_ms, meter->kernel_name);
 
     return meter;
 }
@@ -104,11 +389,16 @@ void audyn_level_meter_reset(audyn_level_meter_t *meter)
         meter->peak[i] = 0.0f;
         meter->peak_hold[i] = 0.0f;
     }
+    memset(meter->sq_part, 0, sizeof(meter->sq_part));
+    memset(meter->pk_part, 0, sizeof(meter->pk_part));
+    meter->pending_periods = 0;
     meter->sample_count = 0;
 }
 
 static void compute_levels(audyn_level_meter_t *meter)
 {
+    fold_partials(meter);
+
     if (meter->sample_count == 0) {
         return;
     }
@@ -142,27 +432,89 @@ static void compute_levels(audyn_level_meter_t *meter)
     }
 }
 
+static void print_level(const audyn_channel_level_t *l)
+{
+    printf("{\"rms_db\":%.1f,\"peak_db\":%.1f,\"clipping\":%s}",
+           l->rms_db, l->peak_db, l->clipping ? "true" : "false");
+}
+
 static void output_json(audyn_level_meter_t *meter)
 {
-    /* Output JSON to stdout for the backend to parse */
-    if (meter->channels == 1) {
-        printf("{\"type\":\"levels\",\"channels\":1,"
-               "\"left\":{\"rms_db\":%.1f,\"peak_db\":%.1f,\"clipping\":%s}}\n",
-               meter->levels[0].rms_db,
-               meter->levels[0].peak_db,
-               meter->levels[0].clipping ? "true" : "false");
-    } else {
-        printf("{\"type\":\"levels\",\"channels\":2,"
-               "\"left\":{\"rms_db\":%.1f,\"peak_db\":%.1f,\"clipping\":%s},"
-               "\"right\":{\"rms_db\":%.1f,\"peak_db\":%.1f,\"clipping\":%s}}\n",
-               meter->levels[0].rms_db,
-               meter->levels[0].peak_db,
-               meter->levels[0].clipping ? "true" : "false",
-               meter->levels[1].rms_db,
-               meter->levels[1].peak_db,
-               meter->levels[1].clipping ? "true" : "false");
+    /* Output JSON to stdout for the backend to parse; one line under the
+     * stdio lock so control replies never land inside it */
+    flockfile(stdout);
+    printf("{\"type\":\"levels\",\"channels\":%u,\"left\":", meter->channels);
+    print_level(&meter->levels[0]);
+    if (meter->channels > 1) {
+        printf(",\"right\":");
+        print_level(&meter->levels[1]);
     }
+    if (meter->channels > 2) {
+        printf(",\"levels\":[");
+        for (uint32_t ch = 0; ch < meter->channels; ch++) {
+            if (ch) putchar(',');
+            print_level(&meter->levels[ch]);
+        }
+        putchar(']');
+    }
+    printf("}\n");
     fflush(stdout);
+    funlockfile(stdout);
+}
+
+/* Hand the current levels to every enabled consumer */
+static void emit_levels(audyn_level_meter_t *meter)
+{
+    if (meter->shm) {
+        audyn_level_shm_publish(meter->shm, meter->levels);
+    }
+    if (meter->json) {
+        output_json(meter);
+    }
+}
+
+/* Accumulate interleaved samples whose layout matches the meter */
+static void accumulate(audyn_level_meter_t *meter, const float *x, size_t n)
+{
+    const uint32_t ch = meter->channels;
+    const uint32_t period = meter->period;
+
+    size_t periods = n / period;
+    while (periods > 0) {
+        if (meter->pending_periods >= AUDYN_METER_FOLD_SAMPLES) {
+            fold_partials(meter);
+        }
+        uint32_t chunk = AUDYN_METER_FOLD_SAMPLES - meter->pending_periods;
+        if (chunk > periods) chunk = (uint32_t)periods;
+
+        meter->kernel(x, chunk, period, meter->sq_part, meter->pk_part);
+        meter->pending_periods += chunk;
+        x += (size_t)chunk * period;
+        n -= (size_t)chunk * period;
+        periods -= chunk;
+    }
+
+    /* The remainder starts on channel 0, so its whole vectors run as one
+     * shorter period over the same partials (kernels take any multiple of
+     * the vector width) */
+    const uint32_t rest = (uint32_t)n - (uint32_t)n % meter->width;
+    if (rest > 0) {
+        if (meter->pending_periods >= AUDYN_METER_FOLD_SAMPLES) {
+            fold_partials(meter);
+        }
+        meter->kernel(x, 1, rest, meter->sq_part, meter->pk_part);
+        meter->pending_periods++;
+        x += rest;
+        n -= rest;
+    }
+
+    /* Tail shorter than a vector: channel = position % channels */
+    for (size_t j = 0, c = (rest % ch); j < n; j++) {
+        const float a = fabsf(x[j]);
+        meter->sum_sq[c] += (double)(x[j] * x[j]);
+        if (a > meter->peak[c]) meter->peak[c] = a;
+        if (++c == ch) c = 0;
+    }
 }
 
 int audyn_level_meter_process(
@@ -175,12 +527,12 @@ int audyn_level_meter_process(
 
     /* Handle NULL frame - just check if we need to output silence */
     if (!frame || !frame->data) {
-        /* Still need to output periodically for UI responsiveness */
-        struct timespec ts;
-        clock_gettime(CLOCK_MONOTONIC, &ts);
-        uint64_t now_ms = (uint64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+        /* Still need to output periodically for UI responsiveness, but
+         * only once audio has stopped for two intervals */
+        uint64_t now_ms = monotonic_ms();
 
-        if (now_ms - meter->last_output_time_ms >= meter->output_interval_ms) {
+        if (now_ms - meter->last_audio_time_ms >= 2u * (uint64_t)meter->output_interval_ms &&
+            now_ms - meter->last_output_time_ms >= meter->output_interval_ms) {
             /* Output silence levels */
             for (uint32_t ch = 0; ch < meter->channels; ch++) {
                 meter->levels[ch].rms_db = MIN_DB;
@@ -189,7 +541,7 @@ int audyn_level_meter_process(
                 meter->levels[ch].peak_linear = 0.0f;
                 meter->levels[ch].clipping = 0;
             }
-            output_json(meter);
+            emit_levels(meter);
             meter->last_output_time_ms = now_ms;
             meter->outputs_sent++;
             return 1;
@@ -197,25 +549,25 @@ int audyn_level_meter_process(
         return 0;
     }
 
-    uint32_t channels = frame->channels;
-    if (channels > meter->channels) {
-        channels = meter->channels;
-    }
-
-    /* Process all samples in the frame */
-    for (uint32_t i = 0; i < frame->sample_frames; i++) {
-        for (uint32_t ch = 0; ch < channels; ch++) {
-            float sample = frame->data[i * frame->channels + ch];
-
-            /* Absolute value for peak detection */
-            float abs_sample = fabsf(sample);
+    if (meter->kernel && frame->channels == meter->channels) {
+        accumulate(meter, frame->data,
+                   (size_t)frame->sample_frames * frame->channels);
+    } else {
+        /* Scalar, or a layout mismatch: meter the channels both sides have */
+        uint32_t channels = frame->channels;
+        if (channels > meter->channels) {
+            channels = meter->channels;
+        }
 
-            /* Accumulate sum of squares for RMS */
-            meter->sum_sq[ch] += (double)(sample * sample);
+        for (uint32_t i = 0; i < frame->sample_frames; i++) {
+            for (uint32_t ch = 0; ch < channels; ch++) {
+                float sample = frame->data[i * frame->channels + ch];
+                float abs_sample = fabsf(sample);
 
-            /* Track peak */
-            if (abs_sample > meter->peak[ch]) {
-                meter->peak[ch] = abs_sample;
+                meter->sum_sq[ch] += (double)(sample * sample);
+                if (abs_sample > meter->peak[ch]) {
+                    meter->peak[ch] = abs_sample;
+                }
             }
         }
     }
@@ -227,16 +579,16 @@ int audyn_level_meter_process(
     uint64_t output_samples = (uint64_t)meter->sample_rate *
                               meter->output_interval_ms / 1000;
 
-    if (meter->sample_count - meter->last_output_samples >= output_samples) {
+    if (meter->sample_count >= output_samples) {
         compute_levels(meter);
-        output_json(meter);
+        emit_levels(meter);
+        meter->last_audio_time_ms = meter->last_output_time_ms = monotonic_ms();
 
         /* Reset for next interval */
         for (uint32_t ch = 0; ch < meter->channels; ch++) {
             meter->sum_sq[ch] = 0.0;
             meter->peak[ch] = 0.0f;
         }
-        meter->last_output_samples = meter->sample_count;
         meter->sample_count = 0;
         meter->outputs_sent++;
 
@@ -253,7 +605,7 @@ void audyn_level_meter_flush(audyn_level_meter_t *meter)
     }
 
     compute_levels(meter);
-    output_json(meter);
+    emit_levels(meter);
     meter->outputs_sent++;
 
     /* Reset */
@@ -277,6 +629,26 @@ void audyn_level_meter_get_levels(
            meter->channels * sizeof(audyn_channel_level_t));
 }
 
+void audyn_level_meter_set_outputs(audyn_level_meter_t *meter, int json,
+                                   struct audyn_level_shm *shm)
+{
+    if (!meter) return;
+
+    meter->json = json ? 1 : 0;
+    meter->shm = shm;
+}
+
+void audyn_level_meter_set_interval(audyn_level_meter_t *meter, uint32_t interval_ms)
+{
+    if (!meter || interval_ms == 0) return;
+
+    meter->output_interval_ms = interval_ms;
+    if (meter->shm) {
+        audyn_level_shm_set_interval(meter->shm, interval_ms);
+    }
+    LOG_DEBUG("level_meter: interval %ums", interval_ms);
+}
+
 void audyn_level_meter_get_stats(const audyn_level_meter_t *meter,
                                   audyn_meter_stats_t *stats)
 {
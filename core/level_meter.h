@@ -8,6 +8,22 @@
  *      Real-time audio level metering with RMS and peak detection.
  *      Outputs JSON to stdout for integration with web backend.
  *
+ *      Any channel count up to AUDYN_METER_MAX_CHANNELS. The per-block
+ *      sum-of-squares / abs-peak pass is a vector kernel (AVX2 on x86,
+ *      runtime-detected; NEON on ARM; scalar otherwise) chosen at create.
+ *      Kernels accumulate in float and the partials are folded into the
+ *      double per-channel sums at least every AUDYN_METER_FOLD_SAMPLES
+ *      samples per partial, so RMS precision does not depend on interval
+ *      length.
+ *
+ *      Each interval's levels go to a JSON line on stdout and/or the
+ *      shared-memory feed (level_shm.h).
+ *
+ *  JSON:
+ *      1-2 channels: {"type":"levels","channels":N,"left":{..},"right":{..}}
+ *      More channels add "levels":[{..},...] with every channel; "left"
+ *      and "right" (channels 1 and 2) stay for existing consumers.
+ *
  *  Copyright:
  *      (c) 2026 B. Wynne
  *
@@ -20,13 +36,22 @@
 
 #include <stdint.h>
 #include "frame_pool.h"
+#include "pcm_convert.h"
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
-/* Maximum supported channels */
-#define AUDYN_METER_MAX_CHANNELS 2
+struct audyn_level_shm;
+
+/* Maximum supported channels (matches the AES67/PipeWire inputs and WAV sink) */
+#define AUDYN_METER_MAX_CHANNELS 32
+
+/* Longest run of samples a float partial sum covers before double folding */
+#define AUDYN_METER_FOLD_SAMPLES 1024
+
+/* Largest kernel period: lcm(31, 8) = 248 floats for AVX2 */
+#define AUDYN_METER_MAX_PERIOD 256
 
 /* Sample rate limits */
 #define AUDYN_METER_MAX_SAMPLE_RATE 384000
@@ -40,11 +65,28 @@ typedef struct audyn_channel_level {
     int clipping;           /* Non-zero if clipping detected */
 } audyn_channel_level_t;
 
+/*
+ * Accumulate 'periods' x 'period' interleaved floats: for each position j
+ * in a period, sq[j] += x^2 and pk[j] = max(pk[j], |x|). The period is a
+ * multiple of the channel count, so position j is channel j % channels.
+ */
+typedef void (*audyn_level_kernel_fn)(const float *x, uint32_t periods,
+                                      uint32_t period, float *sq, float *pk);
+
 /* Level meter state */
 typedef struct audyn_level_meter {
     uint32_t channels;
     uint32_t sample_rate;
 
+    /* Accumulation kernel */
+    audyn_level_kernel_fn kernel;       /* NULL = scalar per-sample loop */
+    uint32_t period;                    /* Floats per kernel period */
+    uint32_t width;                     /* Floats per vector (1 = scalar) */
+    uint32_t pending_periods;           /* Periods in the partials since the last fold */
+    float sq_part[AUDYN_METER_MAX_PERIOD];  /* Float partials per period position */
+    float pk_part[AUDYN_METER_MAX_PERIOD];
+    const char *kernel_name;            /* e.g. "level-avx2" */
+
     /* Per-channel accumulators */
     double sum_sq[AUDYN_METER_MAX_CHANNELS];    /* Sum of squares for RMS */
     float peak[AUDYN_METER_MAX_CHANNELS];       /* Peak value */
@@ -56,17 +98,21 @@ typedef struct audyn_level_meter {
 
     /* Output interval */
     uint32_t output_interval_ms;
-    uint64_t last_output_samples;
 
     /* Computed levels (updated on output) */
     audyn_channel_level_t levels[AUDYN_METER_MAX_CHANNELS];
 
+    /* Consumers of each interval's levels */
+    int json;                           /* JSON line on stdout (default on) */
+    struct audyn_level_shm *shm;        /* Shared-memory feed, or NULL (not owned) */
+
     /* Statistics */
     uint64_t frames_processed;          /* Total audio frames processed */
     uint64_t outputs_sent;              /* Total JSON outputs sent */
 
-    /* Wall clock time for NULL frame handling */
-    uint64_t last_output_time_ms;
+    /* Monotonic time for NULL frame handling */
+    uint64_t last_output_time_ms;       /* Any output */
+    uint64_t last_audio_time_ms;        /* Output computed from audio */
 
 } audyn_level_meter_t;
 
@@ -81,7 +127,7 @@ typedef struct audyn_meter_stats {
 /*
  * Create a level meter.
  *
- * channels: Number of audio channels (1 or 2)
+ * channels: Number of audio channels (1 to AUDYN_METER_MAX_CHANNELS)
  * sample_rate: Audio sample rate in Hz
  * output_interval_ms: How often to output levels (default 33ms = ~30fps)
  *
@@ -134,6 +180,28 @@ void audyn_level_meter_get_levels(
  */
 void audyn_level_meter_reset(audyn_level_meter_t *meter);
 
+/*
+ * Select the accumulation kernel family (AUDYN_PCM_ISA_AUTO = best on this
+ * CPU; benchmarks force others). Returns 0, or -1 if the ISA is not
+ * available (the current kernel is kept).
+ */
+int audyn_level_meter_set_isa(audyn_level_meter_t *meter, audyn_pcm_isa_t isa);
+
+/*
+ * Choose where each interval's levels go: a JSON line on stdout (json) and/or
+ * a shared-memory feed (shm, may be NULL; must outlive the meter). The
+ * default is JSON only.
+ */
+void audyn_level_meter_set_outputs(audyn_level_meter_t *meter, int json,
+                                   struct audyn_level_shm *shm);
+
+/*
+ * Change the output interval (ms, > 0) from the next output on; the
+ * shared-memory feed header follows. Call from the thread that processes
+ * audio.
+ */
+void audyn_level_meter_set_interval(audyn_level_meter_t *meter, uint32_t interval_ms);
+
 /*
  * Get meter statistics.
  */
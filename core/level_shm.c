@@ -0,0 +1,193 @@
+/*
+ *  Audyn — Professional Audio Capture & Archival Engine
+ *
+ *  File:
+ *      level_shm.c
+ *
+ *  Purpose:
+ *      Binary level feed in POSIX shared memory (see level_shm.h).
+ *
+ *  Copyright:
+ *      (c) 2026 B. Wynne
+ *
+ *  Author:
+ *      B. Wynne
+ *
+ *  License:
+ *      GPLv2 or later
+ */
+
+#define _GNU_SOURCE
+
+#include "level_shm.h"
+#include "log.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+/* Fixed offsets promised to readers (level_shm.h) */
+_Static_assert(offsetof(audyn_level_shm_layout_t, seq) == 32, "level_shm: seq offset");
+_Static_assert(offsetof(audyn_level_shm_layout_t, update_ns) == 40, "level_shm: update_ns offset");
+_Static_assert(offsetof(audyn_level_shm_layout_t, levels) == 48, "level_shm: levels offset");
+_Static_assert(sizeof(audyn_channel_level_t) == 20, "level_shm: level entry size");
+
+struct audyn_level_shm {
+    audyn_level_shm_layout_t *map;
+    uint32_t channels;
+    char name[AUDYN_LEVEL_SHM_NAME_MAX + 2];    /* Leading '/' + NUL */
+};
+
+static uint64_t monotonic_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+/* Canonical "/name" into out; -1 if the name is unusable */
+static int canon_name(const char *name, char *out, size_t out_len)
+{
+    if (!name) return -1;
+    if (name[0] == '/') name++;
+
+    size_t len = strlen(name);
+    if (len == 0 || len > AUDYN_LEVEL_SHM_NAME_MAX) return -1;
+    if (strchr(name, '/')) return -1;
+    if (!strcmp(name, ".") || !strcmp(name, "..")) return -1;
+
+    snprintf(out, out_len, "/%s", name);
+    return 0;
+}
+
+int audyn_level_shm_check_name(const char *name)
+{
+    char tmp[AUDYN_LEVEL_SHM_NAME_MAX + 2];
+    return canon_name(name, tmp, sizeof(tmp));
+}
+
+audyn_level_shm_t *audyn_level_shm_create(const char *name,
+                                          uint32_t channels,
+                                          uint32_t sample_rate,
+                                          uint32_t interval_ms)
+{
+    if (channels == 0 || channels > AUDYN_METER_MAX_CHANNELS) {
+        LOG_ERROR("level_shm: invalid channels %u (must be 1-%u)",
+                  channels, AUDYN_METER_MAX_CHANNELS);
+        return NULL;
+    }
+
+    audyn_level_shm_t *shm = calloc(1, sizeof(*shm));
+    if (!shm) {
+        LOG_ERROR("level_shm: failed to allocate structure");
+        return NULL;
+    }
+    if (canon_name(name, shm->name, sizeof(shm->name)) != 0) {
+        LOG_ERROR("level_shm: invalid feed name '%s' (1-%d characters, no '/')",
+                  name ? name : "", AUDYN_LEVEL_SHM_NAME_MAX);
+        free(shm);
+        return NULL;
+    }
+
+    /* World-readable: the web backend may run as another user */
+    int fd = shm_open(shm->name, O_CREAT | O_RDWR | O_TRUNC, 0644);
+    if (fd < 0) {
+        LOG_ERROR("level_shm: shm_open(%s) failed: %s", shm->name, strerror(errno));
+        free(shm);
+        return NULL;
+    }
+    if (ftruncate(fd, (off_t)sizeof(audyn_level_shm_layout_t)) != 0) {
+        LOG_ERROR("level_shm: ftruncate(%s) failed: %s", shm->name, strerror(errno));
+        close(fd);
+        shm_unlink(shm->name);
+        free(shm);
+        return NULL;
+    }
+
+    void *p = mmap(NULL, sizeof(audyn_level_shm_layout_t), PROT_READ | PROT_WRITE,
+                   MAP_SHARED, fd, 0);
+    close(fd);
+    if (p == MAP_FAILED) {
+        LOG_ERROR("level_shm: mmap(%s) failed: %s", shm->name, strerror(errno));
+        shm_unlink(shm->name);
+        free(shm);
+        return NULL;
+    }
+
+    shm->map = (audyn_level_shm_layout_t *)p;
+    shm->channels = channels;
+
+    /* Fresh (zeroed) mapping; publish the header with magic last */
+    audyn_level_shm_layout_t *m = shm->map;
+    m->version = AUDYN_LEVEL_SHM_VERSION;
+    m->header_bytes = (uint32_t)sizeof(*m);
+    m->channels = channels;
+    m->sample_rate = sample_rate;
+    m->interval_ms = interval_ms;
+    m->pid = (uint32_t)getpid();
+    m->update_ns = monotonic_ns();
+    for (uint32_t i = 0; i < channels; i++) {
+        m->levels[i].rms_db = -60.0f;
+        m->levels[i].peak_db = -60.0f;
+    }
+    atomic_store_explicit(&m->state, 1u, memory_order_relaxed);
+    atomic_store_explicit(&m->seq, 0u, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    m->magic = AUDYN_LEVEL_SHM_MAGIC;
+
+    LOG_INFO("Level feed: /dev/shm%s (%u channels, %zu bytes)",
+             shm->name, channels, sizeof(*m));
+    return shm;
+}
+
+int audyn_level_shm_publish(audyn_level_shm_t *shm,
+                            const audyn_channel_level_t *levels)
+{
+    if (!shm || !levels) return 1;
+
+    audyn_level_shm_layout_t *m = shm->map;
+
+    /* Claim the writer slot: even -> odd. A concurrent publisher holds it
+     * odd, so this one is dropped (the other carries the same meter). */
+    uint64_t seq = atomic_load_explicit(&m->seq, memory_order_relaxed);
+    if ((seq & 1u) ||
+        !atomic_compare_exchange_strong_explicit(&m->seq, &seq, seq + 1u,
+                                                 memory_order_relaxed,
+                                                 memory_order_relaxed)) {
+        return 1;
+    }
+    atomic_thread_fence(memory_order_release);
+
+    memcpy(m->levels, levels, shm->channels * sizeof(audyn_channel_level_t));
+    m->update_ns = monotonic_ns();
+
+    atomic_store_explicit(&m->seq, seq + 2u, memory_order_release);
+    return 0;
+}
+
+void audyn_level_shm_set_interval(audyn_level_shm_t *shm, uint32_t interval_ms)
+{
+    if (!shm) return;
+    shm->map->interval_ms = interval_ms;
+}
+
+void audyn_level_shm_destroy(audyn_level_shm_t *shm)
+{
+    if (!shm) return;
+
+    if (shm->map) {
+        atomic_store_explicit(&shm->map->state, 0u, memory_order_release);
+        munmap(shm->map, sizeof(audyn_level_shm_layout_t));
+    }
+    shm_unlink(shm->name);
+
+    LOG_DEBUG("level_shm: removed %s", shm->name);
+    free(shm);
+}
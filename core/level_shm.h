@@ -0,0 +1,122 @@
+/*
+ *  Audyn — Professional Audio Capture & Archival Engine
+ *
+ *  File:
+ *      level_shm.h
+ *
+ *  Purpose:
+ *      Binary level feed in POSIX shared memory (/dev/shm/<name>).
+ *
+ *      The level meter publishes each interval's audyn_channel_level_t
+ *      values into a fixed struct that other processes mmap read-only and
+ *      poll at their own rate: no pipe, no text formatting, no syscall per
+ *      update on either side.
+ *
+ *  Layout:
+ *      audyn_level_shm_layout_t below, little-endian native, version 1.
+ *      Readers should check magic, version and header_bytes, then read
+ *      channels and the level array under the sequence protocol.
+ *
+ *  Sequence protocol (seqlock):
+ *      Writer: seq becomes odd, fields are written, seq becomes even
+ *      (release). Reader: load seq (acquire); if odd, retry; copy the
+ *      fields; load seq again; if it changed, retry. seq / 2 is the
+ *      generation: the number of completed updates. A reader that sees the
+ *      same even seq twice has nothing new.
+ *
+ *      state is 1 while the writer runs and 0 after a clean shutdown; the
+ *      name is unlinked on shutdown, so a reader holding an old mapping
+ *      should reopen when state drops to 0 or update_ns goes stale.
+ *
+ *  Threading:
+ *      publish() may be called from several threads; a publish that finds
+ *      another one in progress is skipped rather than waiting.
+ *
+ *  Dependencies:
+ *      - POSIX shm_open/mmap, C11 atomics
+ *
+ *  Copyright:
+ *      (c) 2026 B. Wynne
+ *
+ *  Author:
+ *      B. Wynne
+ *
+ *  License:
+ *      GPLv2 or later
+ */
+
+#ifndef AUDYN_LEVEL_SHM_H
+#define AUDYN_LEVEL_SHM_H
+
+#include <stdint.h>
+#include <stdatomic.h>
+#include "level_meter.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define AUDYN_LEVEL_SHM_MAGIC   0x4C565941u     /* "AYVL" little-endian */
+#define AUDYN_LEVEL_SHM_VERSION 1u
+
+/* Longest accepted feed name, without the leading '/' */
+#define AUDYN_LEVEL_SHM_NAME_MAX 64
+
+/*
+ * Shared layout. Offsets are fixed for version 1:
+ *   0  magic, 4 version, 8 header_bytes, 12 channels, 16 sample_rate,
+ *   20 interval_ms, 24 pid, 28 state, 32 seq, 40 update_ns,
+ *   48 levels[32] (audyn_channel_level_t, 20 bytes each: rms_linear,
+ *   rms_db, peak_linear, peak_db as float32, clipping as int32)
+ */
+typedef struct audyn_level_shm_layout {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t header_bytes;              /* sizeof(audyn_level_shm_layout_t) */
+    uint32_t channels;                  /* Valid entries in levels[] */
+    uint32_t sample_rate;
+    uint32_t interval_ms;               /* Meter interval */
+    uint32_t pid;                       /* Writer process */
+    _Atomic uint32_t state;             /* 1 = running, 0 = stopped */
+    _Atomic uint64_t seq;               /* Even = stable; seq / 2 = generation */
+    uint64_t update_ns;                 /* CLOCK_MONOTONIC of the last update */
+    audyn_channel_level_t levels[AUDYN_METER_MAX_CHANNELS];
+} audyn_level_shm_layout_t;
+
+typedef struct audyn_level_shm audyn_level_shm_t;
+
+/*
+ * Create (or replace) /dev/shm/<name> and map it.
+ *
+ * name may carry a leading '/'; otherwise it must be 1 to
+ * AUDYN_LEVEL_SHM_NAME_MAX characters without '/'.
+ *
+ * Returns feed or NULL on error (logged). NOT real-time safe.
+ */
+audyn_level_shm_t *audyn_level_shm_create(const char *name,
+                                          uint32_t channels,
+                                          uint32_t sample_rate,
+                                          uint32_t interval_ms);
+
+/*
+ * Publish one update. Real-time safe (no syscalls, no locks).
+ * Returns 0 if published, 1 if skipped because another publish was in
+ * progress.
+ */
+int audyn_level_shm_publish(audyn_level_shm_t *shm,
+                            const audyn_channel_level_t *levels);
+
+/* Update the interval_ms readers see (the meter's interval changed). */
+void audyn_level_shm_set_interval(audyn_level_shm_t *shm, uint32_t interval_ms);
+
+/* Check a feed name without creating it. Returns 0 if usable, -1 if not. */
+int audyn_level_shm_check_name(const char *name);
+
+/* Mark stopped, unmap and unlink (safe with NULL). */
+void audyn_level_shm_destroy(audyn_level_shm_t *shm);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* AUDYN_LEVEL_SHM_H */
@@ -7,6 +7,21 @@
  *  Purpose:
  *      Simple logging implementation with optional syslog support.
  *
+ *  Asynchronous rings:
+ *      Each logging thread gets its own SPSC ring of fixed-size records
+ *      on its first message (the only allocation). head/tail are
+ *      free-running record counters (owner thread / log thread); a record
+ *      is published by the release store of head and returned by the
+ *      release store of tail. Rings live on an append-only list; when a
+ *      thread exits its ring is released (pthread key destructor) and a
+ *      later thread may claim it once drained. The log thread merges the
+ *      rings by the global sequence number taken at each call.
+ *
+ *  Wakeup:
+ *      A producer never blocks: it signals the log thread only if it gets
+ *      the mutex with trylock. Otherwise the pending flag is picked up
+ *      within LOG_DRAIN_MS.
+ *
  *  Copyright:
  *      (c) 2026 B. Wynne
  *
@@ -17,8 +32,11 @@
  *      GPLv2 or later
  */
 
+#define _GNU_SOURCE
+
 #include "log.h"
 
+#include <pthread.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdarg.h>
@@ -27,18 +45,309 @@
 #include <strings.h>  /* For strcasecmp */
 
 #ifdef __linux__
-#include <syslog.h>
+#include <syslog.h>     /* Its LOG_* priorities shadow log.h's macros here */
 #endif
 
+/* Records per thread ring (power of two) */
+#define LOG_RING_SLOTS 256
+
+/* Longest message kept by a record (longer ones are truncated) */
+#define LOG_MSG_MAX 480
+
+/* Longest message in synchronous mode */
+#define LOG_LINE_MAX 1024
+
+/* Log thread poll interval when no wakeup got through */
+#define LOG_DRAIN_MS 20
+
+#define NS_PER_SEC 1000000000ULL
+
 static audyn_log_level_t g_level = AUDYN_LOG_INFO;
 static int g_use_syslog = 0;
 static int g_initialized = 0;
 
 /* Statistics counters */
-static uint64_t g_debug_count = 0;
-static uint64_t g_info_count = 0;
-static uint64_t g_warn_count = 0;
-static uint64_t g_error_count = 0;
+static _Atomic uint64_t g_debug_count = 0;
+static _Atomic uint64_t g_info_count = 0;
+static _Atomic uint64_t g_warn_count = 0;
+static _Atomic uint64_t g_error_count = 0;
+static _Atomic uint64_t g_dropped_count = 0;
+static _Atomic uint64_t g_suppressed_count = 0;
+
+/* Per-call-site limit (messages per second, 0 = off) */
+static _Atomic uint32_t g_rate_limit = AUDYN_LOG_DEFAULT_RATE;
+
+/* -------- Asynchronous mode state -------- */
+
+typedef struct log_record {
+    uint64_t seq;                   /* Global call order */
+    uint64_t time_ns;               /* CLOCK_REALTIME at the call */
+    uint32_t level;
+    uint32_t suppressed;            /* Messages dropped at this site before it */
+    char msg[LOG_MSG_MAX];
+} log_record_t;
+
+typedef struct log_ring {
+    log_record_t slots[LOG_RING_SLOTS];
+    _Atomic uint32_t head;          /* Records written (owner thread) */
+    _Atomic uint32_t tail;          /* Records output (log thread) */
+    _Atomic int owned;              /* A live thread writes here */
+    struct log_ring *next;          /* Registry link (set before publish) */
+} log_ring_t;
+
+static _Atomic(log_ring_t *) g_rings = NULL;
+static _Atomic int g_async = 0;
+static _Atomic uint64_t g_seq = 0;
+static _Atomic int g_wake = 0;              /* Records pending a wakeup */
+
+static pthread_t g_thread;
+static pthread_mutex_t g_mu = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t g_cv = PTHREAD_COND_INITIALIZER;
+static int g_stop_thread = 0;
+
+static pthread_once_t g_key_once = PTHREAD_ONCE_INIT;
+static pthread_key_t g_ring_key;
+
+/* Rings are never freed: a thread's pointer (t_ring, and g_ring_key for its
+ * exit destructor) stays valid for the life of the process, whatever the
+ * order of thread exit and audyn_log_shutdown(). A released ring is reused
+ * by the next thread that starts logging. */
+static _Thread_local log_ring_t *t_ring = NULL;
+
+/* -------- Output -------- */
+
+static uint64_t clock_ns(clockid_t id)
+{
+    struct timespec ts;
+    clock_gettime(id, &ts);
+    return (uint64_t)ts.tv_sec * NS_PER_SEC + (uint64_t)ts.tv_nsec;
+}
+
+/* Write one finished message (either mode). */
+static void emit(audyn_log_level_t level, uint64_t time_ns, uint32_t suppressed,
+                 const char *msg)
+{
+    char note[64] = "";
+    if (suppressed > 0) {
+        snprintf(note, sizeof(note), " (%u similar messages suppressed)", suppressed);
+    }
+
+#ifdef __linux__
+    if (g_use_syslog) {
+        int priority;
+        switch (level) {
+            case AUDYN_LOG_DEBUG: priority = LOG_DEBUG;   break;
+            case AUDYN_LOG_INFO:  priority = LOG_INFO;    break;
+            case AUDYN_LOG_WARN:  priority = LOG_WARNING; break;
+            case AUDYN_LOG_ERROR: priority = LOG_ERR;     break;
+            default:              priority = LOG_INFO;    break;
+        }
+        syslog(priority, "%s%s", msg, note);
+        return;
+    }
+#endif
+
+    const char *level_str;
+    switch (level) {
+        case AUDYN_LOG_DEBUG: level_str = "DEBUG"; break;
+        case AUDYN_LOG_INFO:  level_str = "INFO";  break;
+        case AUDYN_LOG_WARN:  level_str = "WARN";  break;
+        case AUDYN_LOG_ERROR: level_str = "ERROR"; break;
+        default:              level_str = "???";   break;
+    }
+
+    time_t now = (time_t)(time_ns / NS_PER_SEC);
+    struct tm tm_buf;
+    struct tm *tm_info = localtime_r(&now, &tm_buf);
+    char time_buf[24];
+    if (tm_info) {
+        strftime(time_buf, sizeof(time_buf), "%Y-%m-%d %H:%M:%S", tm_info);
+    } else {
+        snprintf(time_buf, sizeof(time_buf), "0000-00-00 00:00:00");
+    }
+
+    fprintf(stderr, "[%s] [%-5s] %s%s\n", time_buf, level_str, msg, note);
+    fflush(stderr);
+}
+
+/* -------- Thread rings -------- */
+
+static void ring_release(void *arg)
+{
+    log_ring_t *r = (log_ring_t *)arg;
+    atomic_store_explicit(&r->owned, 0, memory_order_release);
+}
+
+static void key_create(void)
+{
+    (void)pthread_key_create(&g_ring_key, ring_release);
+}
+
+/* The calling thread's ring: claimed or allocated on first use. */
+static log_ring_t *thread_ring(void)
+{
+    if (t_ring) {
+        return t_ring;
+    }
+
+    /* A drained ring left by a thread that has exited */
+    log_ring_t *r = atomic_load_explicit(&g_rings, memory_order_acquire);
+    for (; r; r = r->next) {
+        int expect = 0;
+        if (atomic_load_explicit(&r->owned, memory_order_acquire) == 0 &&
+            atomic_load_explicit(&r->head, memory_order_relaxed) ==
+                atomic_load_explicit(&r->tail, memory_order_acquire) &&
+            atomic_compare_exchange_strong(&r->owned, &expect, 1)) {
+            break;
+        }
+    }
+
+    if (!r) {
+        r = (log_ring_t *)calloc(1, sizeof(*r));
+        if (!r) {
+            return NULL;
+        }
+        atomic_store_explicit(&r->owned, 1, memory_order_relaxed);
+
+        log_ring_t *head = atomic_load_explicit(&g_rings, memory_order_relaxed);
+        do {
+            r->next = head;
+        } while (!atomic_compare_exchange_weak_explicit(&g_rings, &head, r,
+                                                        memory_order_release,
+                                                        memory_order_relaxed));
+    }
+
+    (void)pthread_setspecific(g_ring_key, r);
+    t_ring = r;
+    return r;
+}
+
+/* Queue one message for the log thread. Never blocks. */
+static void async_push(audyn_log_level_t level, uint32_t suppressed,
+                       const char *fmt, va_list args)
+{
+    log_ring_t *r = thread_ring();
+    if (!r) {
+        atomic_fetch_add_explicit(&g_dropped_count, 1, memory_order_relaxed);
+        return;
+    }
+
+    uint32_t head = atomic_load_explicit(&r->head, memory_order_relaxed);
+    uint32_t tail = atomic_load_explicit(&r->tail, memory_order_acquire);
+    if (head - tail >= LOG_RING_SLOTS) {
+        atomic_fetch_add_explicit(&g_dropped_count, 1, memory_order_relaxed);
+        return;
+    }
+
+    log_record_t *rec = &r->slots[head % LOG_RING_SLOTS];
+    rec->seq = atomic_fetch_add_explicit(&g_seq, 1, memory_order_relaxed);
+    rec->time_ns = clock_ns(CLOCK_REALTIME);
+    rec->level = (uint32_t)level;
+    rec->suppressed = suppressed;
+    vsnprintf(rec->msg, sizeof(rec->msg), fmt, args);
+
+    atomic_store_explicit(&r->head, head + 1, memory_order_release);
+
+    if (!atomic_exchange_explicit(&g_wake, 1, memory_order_acq_rel) &&
+        pthread_mutex_trylock(&g_mu) == 0) {
+        pthread_cond_signal(&g_cv);
+        pthread_mutex_unlock(&g_mu);
+    }
+}
+
+/* Output the oldest pending record across all rings. Returns 1 if one was. */
+static int drain_one(void)
+{
+    log_ring_t *best = NULL;
+    uint64_t best_seq = 0;
+
+    log_ring_t *r = atomic_load_explicit(&g_rings, memory_order_acquire);
+    for (; r; r = r->next) {
+        uint32_t tail = atomic_load_explicit(&r->tail, memory_order_relaxed);
+        if (tail == atomic_load_explicit(&r->head, memory_order_acquire)) {
+            continue;
+        }
+        uint64_t seq = r->slots[tail % LOG_RING_SLOTS].seq;
+        if (!best || seq < best_seq) {
+            best = r;
+            best_seq = seq;
+        }
+    }
+
+    if (!best) {
+        return 0;
+    }
+
+    uint32_t tail = atomic_load_explicit(&best->tail, memory_order_relaxed);
+    const log_record_t *rec = &best->slots[tail % LOG_RING_SLOTS];
+    emit((audyn_log_level_t)rec->level, rec->time_ns, rec->suppressed, rec->msg);
+    atomic_store_explicit(&best->tail, tail + 1, memory_order_release);
+    return 1;
+}
+
+static void *log_thread(void *arg)
+{
+    (void)arg;
+    (void)pthread_setname_np(pthread_self(), "audyn-log");
+
+    for (;;) {
+        atomic_store_explicit(&g_wake, 0, memory_order_release);
+        while (drain_one()) {
+        }
+
+        pthread_mutex_lock(&g_mu);
+        if (g_stop_thread) {
+            pthread_mutex_unlock(&g_mu);
+            while (drain_one()) {
+            }
+            break;
+        }
+        if (!atomic_load_explicit(&g_wake, memory_order_acquire)) {
+            struct timespec ts;
+            clock_gettime(CLOCK_REALTIME, &ts);
+            ts.tv_nsec += LOG_DRAIN_MS * 1000000L;
+            if (ts.tv_nsec >= 1000000000L) {
+                ts.tv_sec++;
+                ts.tv_nsec -= 1000000000L;
+            }
+            (void)pthread_cond_timedwait(&g_cv, &g_mu, &ts);
+        }
+        pthread_mutex_unlock(&g_mu);
+    }
+
+    return NULL;
+}
+
+/* -------- Rate limiting -------- */
+
+/* 1 if the site may log now; *suppressed receives its unreported drops. */
+static int site_allow(audyn_log_site_t *site, uint32_t *suppressed)
+{
+    *suppressed = 0;
+
+    const uint32_t limit = atomic_load_explicit(&g_rate_limit, memory_order_relaxed);
+    if (!site || limit == 0) {
+        return 1;
+    }
+
+    const uint64_t now = clock_ns(CLOCK_MONOTONIC);
+    uint64_t win = atomic_load_explicit(&site->window_ns, memory_order_relaxed);
+    if (now - win >= NS_PER_SEC &&
+        atomic_compare_exchange_strong(&site->window_ns, &win, now)) {
+        atomic_store_explicit(&site->count, 0, memory_order_relaxed);
+    }
+
+    if (atomic_fetch_add_explicit(&site->count, 1, memory_order_relaxed) >= limit) {
+        atomic_fetch_add_explicit(&site->suppressed, 1, memory_order_relaxed);
+        atomic_fetch_add_explicit(&g_suppressed_count, 1, memory_order_relaxed);
+        return 0;
+    }
+
+    *suppressed = atomic_exchange_explicit(&site->suppressed, 0, memory_order_relaxed);
+    return 1;
+}
+
+/* -------- Public API -------- */
 
 void audyn_log_init(audyn_log_level_t level, int use_syslog)
 {
@@ -47,10 +356,12 @@ void audyn_log_init(audyn_log_level_t level, int use_syslog)
     g_initialized = 1;
 
     /* Reset statistics */
-    g_debug_count = 0;
-    g_info_count = 0;
-    g_warn_count = 0;
-    g_error_count = 0;
+    atomic_store(&g_debug_count, 0);
+    atomic_store(&g_info_count, 0);
+    atomic_store(&g_warn_count, 0);
+    atomic_store(&g_error_count, 0);
+    atomic_store(&g_dropped_count, 0);
+    atomic_store(&g_suppressed_count, 0);
 
 #ifdef __linux__
     if (use_syslog) {
@@ -59,8 +370,53 @@ void audyn_log_init(audyn_log_level_t level, int use_syslog)
 #endif
 }
 
+int audyn_log_start_async(void)
+{
+    if (atomic_load(&g_async)) {
+        return 0;
+    }
+
+    (void)pthread_once(&g_key_once, key_create);
+
+    g_stop_thread = 0;
+    if (pthread_create(&g_thread, NULL, log_thread, NULL) != 0) {
+        audyn_log_write(AUDYN_LOG_ERROR, "log: failed to start thread, logging synchronously");
+        return -1;
+    }
+
+    atomic_store(&g_async, 1);
+    audyn_log_write(AUDYN_LOG_DEBUG, "log: asynchronous (%u records per thread)",
+                    (unsigned)LOG_RING_SLOTS);
+    return 0;
+}
+
+void audyn_log_set_rate_limit(uint32_t per_second)
+{
+    atomic_store(&g_rate_limit, per_second);
+}
+
 void audyn_log_shutdown(void)
 {
+    if (atomic_exchange(&g_async, 0)) {
+        pthread_mutex_lock(&g_mu);
+        g_stop_thread = 1;
+        pthread_cond_signal(&g_cv);
+        pthread_mutex_unlock(&g_mu);
+        pthread_join(g_thread, NULL);
+
+        /* The rings stay allocated: threads still running keep theirs
+         * (later calls log synchronously) and release them on exit */
+    }
+
+    uint64_t dropped = atomic_load(&g_dropped_count);
+    uint64_t suppressed = atomic_load(&g_suppressed_count);
+    if (g_initialized && (dropped > 0 || suppressed > 0)) {
+        char msg[128];
+        snprintf(msg, sizeof(msg), "log: %llu messages dropped (ring full), %llu rate-limited",
+                 (unsigned long long)dropped, (unsigned long long)suppressed);
+        emit(AUDYN_LOG_INFO, clock_ns(CLOCK_REALTIME), 0, msg);
+    }
+
 #ifdef __linux__
     if (g_use_syslog) {
         closelog();
@@ -84,7 +440,8 @@ void audyn_log_set_level(audyn_log_level_t level)
     g_level = level;
 }
 
-void audyn_log_write(audyn_log_level_t level, const char *fmt, ...)
+static void log_vwrite(audyn_log_site_t *site, audyn_log_level_t level,
+                       const char *fmt, va_list args)
 {
     if (level < g_level) {
         return;
@@ -92,55 +449,42 @@ void audyn_log_write(audyn_log_level_t level, const char *fmt, ...)
 
     /* Update statistics */
     switch (level) {
-        case AUDYN_LOG_DEBUG: g_debug_count++; break;
-        case AUDYN_LOG_INFO:  g_info_count++;  break;
-        case AUDYN_LOG_WARN:  g_warn_count++;  break;
-        case AUDYN_LOG_ERROR: g_error_count++; break;
+        case AUDYN_LOG_DEBUG: atomic_fetch_add_explicit(&g_debug_count, 1, memory_order_relaxed); break;
+        case AUDYN_LOG_INFO:  atomic_fetch_add_explicit(&g_info_count, 1, memory_order_relaxed);  break;
+        case AUDYN_LOG_WARN:  atomic_fetch_add_explicit(&g_warn_count, 1, memory_order_relaxed);  break;
+        case AUDYN_LOG_ERROR: atomic_fetch_add_explicit(&g_error_count, 1, memory_order_relaxed); break;
         default: break;
     }
 
-    va_list args;
-    va_start(args, fmt);
+    uint32_t suppressed;
+    if (!site_allow(site, &suppressed)) {
+        return;
+    }
 
-#ifdef __linux__
-    if (g_use_syslog) {
-        int priority;
-        switch (level) {
-            case AUDYN_LOG_DEBUG: priority = LOG_DEBUG;   break;
-            case AUDYN_LOG_INFO:  priority = LOG_INFO;    break;
-            case AUDYN_LOG_WARN:  priority = LOG_WARNING; break;
-            case AUDYN_LOG_ERROR: priority = LOG_ERR;     break;
-            default:              priority = LOG_INFO;    break;
-        }
-        vsyslog(priority, fmt, args);
-    } else
-#endif
-    {
-        const char *level_str;
-        switch (level) {
-            case AUDYN_LOG_DEBUG: level_str = "DEBUG"; break;
-            case AUDYN_LOG_INFO:  level_str = "INFO";  break;
-            case AUDYN_LOG_WARN:  level_str = "WARN";  break;
-            case AUDYN_LOG_ERROR: level_str = "ERROR"; break;
-            default:              level_str = "???";   break;
-        }
+    if (atomic_load_explicit(&g_async, memory_order_acquire)) {
+        async_push(level, suppressed, fmt, args);
+        return;
+    }
 
-        time_t now = time(NULL);
-        struct tm tm_buf;
-        struct tm *tm_info = localtime_r(&now, &tm_buf);
-        char time_buf[24];
-        if (tm_info) {
-            strftime(time_buf, sizeof(time_buf), "%Y-%m-%d %H:%M:%S", tm_info);
-        } else {
-            snprintf(time_buf, sizeof(time_buf), "0000-00-00 00:00:00");
-        }
+    char msg[LOG_LINE_MAX];
+    vsnprintf(msg, sizeof(msg), fmt, args);
+    emit(level, clock_ns(CLOCK_REALTIME), suppressed, msg);
+}
 
-        fprintf(stderr, "[%s] [%-5s] ", time_buf, level_str);
-        vfprintf(stderr, fmt, args);
-        fprintf(stderr, "\n");
-        fflush(stderr);
-    }
+void audyn_log_write(audyn_log_level_t level, const char *fmt, ...)
+{
+    va_list args;
+    va_start(args, fmt);
+    log_vwrite(NULL, level, fmt, args);
+    va_end(args);
+}
 
+void audyn_log_write_at(audyn_log_site_t *site, audyn_log_level_t level,
+                        const char *fmt, ...)
+{
+    va_list args;
+    va_start(args, fmt);
+    log_vwrite(site, level, fmt, args);
     va_end(args);
 }
 
@@ -148,11 +492,14 @@ void audyn_log_get_stats(audyn_log_stats_t *stats)
 {
     if (!stats) return;
 
-    stats->debug_count = g_debug_count;
-    stats->info_count = g_info_count;
-    stats->warn_count = g_warn_count;
-    stats->error_count = g_error_count;
-    stats->total_count = g_debug_count + g_info_count + g_warn_count + g_error_count;
+    stats->debug_count = atomic_load_explicit(&g_debug_count, memory_order_relaxed);
+    stats->info_count = atomic_load_explicit(&g_info_count, memory_order_relaxed);
+    stats->warn_count = atomic_load_explicit(&g_warn_count, memory_order_relaxed);
+    stats->error_count = atomic_load_explicit(&g_error_count, memory_order_relaxed);
+    stats->total_count = stats->debug_count + stats->info_count +
+                         stats->warn_count + stats->error_count;
+    stats->dropped_count = atomic_load_explicit(&g_dropped_count, memory_order_relaxed);
+    stats->suppressed_count = atomic_load_explicit(&g_suppressed_count, memory_order_relaxed);
 }
 
 int audyn_log_level_from_string(const char *name)
@@ -7,6 +7,19 @@
  *  Purpose:
  *      Simple logging interface with optional syslog support.
  *
+ *  Asynchronous mode:
+ *      After audyn_log_start_async(), a call formats its message into a
+ *      fixed-size record in the calling thread's own ring and returns:
+ *      no I/O, no locks. A background thread time-stamps, merges the
+ *      rings in call order and writes to stderr or syslog, so a slow
+ *      journald never stalls packet receive. A full ring drops the record
+ *      (counted in dropped_count).
+ *
+ *  Rate limiting:
+ *      Each LOG_* call site passes at most AUDYN_LOG_DEFAULT_RATE messages
+ *      per second (see audyn_log_set_rate_limit); the rest are counted in
+ *      suppressed_count and reported with the site's next message.
+ *
  *  Copyright:
  *      (c) 2026 B. Wynne
  *
@@ -21,6 +34,7 @@
 #define AUDYN_LOG_H
 
 #include <stdint.h>
+#include <stdatomic.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -42,8 +56,20 @@ typedef struct audyn_log_stats {
     uint64_t warn_count;
     uint64_t error_count;
     uint64_t total_count;
+    uint64_t dropped_count;         /* Async: ring full */
+    uint64_t suppressed_count;      /* Over a call site's rate limit */
 } audyn_log_stats_t;
 
+/* Default per-call-site limit, messages per second */
+#define AUDYN_LOG_DEFAULT_RATE 50
+
+/* Rate limit state of one call site (a static in each LOG_* expansion) */
+typedef struct audyn_log_site {
+    _Atomic uint64_t window_ns;     /* Start of the current second */
+    _Atomic uint32_t count;         /* Messages in this window */
+    _Atomic uint32_t suppressed;    /* Not yet reported */
+} audyn_log_site_t;
+
 /*
  * Initialize the logging subsystem.
  *
@@ -53,8 +79,27 @@ typedef struct audyn_log_stats {
  */
 void audyn_log_init(audyn_log_level_t level, int use_syslog);
 
+/*
+ * Switch to asynchronous logging (see above). Call after audyn_log_init().
+ *
+ * Returns: 0 on success, -1 if the thread could not be started (logging
+ * stays synchronous).
+ */
+int audyn_log_start_async(void);
+
+/*
+ * Set the per-call-site limit in messages per second (0 = unlimited).
+ */
+void audyn_log_set_rate_limit(uint32_t per_second);
+
 /*
  * Shutdown the logging subsystem.
+ *
+ * In asynchronous mode, writes every queued record and stops the thread.
+ * Threads that log afterwards write synchronously; a record queued while
+ * shutdown runs may be lost. The per-thread rings stay allocated until
+ * the process exits, so threads still alive, or exiting later, never
+ * touch freed memory.
  */
 void audyn_log_shutdown(void);
 
@@ -86,6 +131,13 @@ void audyn_log_set_level(audyn_log_level_t level);
 void audyn_log_write(audyn_log_level_t level, const char *fmt, ...)
     __attribute__((format(printf, 2, 3)));
 
+/*
+ * Write a log message from a rate-limited call site (site may be NULL).
+ */
+void audyn_log_write_at(audyn_log_site_t *site, audyn_log_level_t level,
+                        const char *fmt, ...)
+    __attribute__((format(printf, 3, 4)));
+
 /*
  * Get log statistics.
  *
@@ -114,11 +166,17 @@ int audyn_log_level_from_string(const char *name);
  */
 const char *audyn_log_level_to_string(audyn_log_level_t level);
 
-/* Convenience macros */
-#define LOG_DEBUG(...) audyn_log_write(AUDYN_LOG_DEBUG, __VA_ARGS__)
-#define LOG_INFO(...)  audyn_log_write(AUDYN_LOG_INFO,  __VA_ARGS__)
-#define LOG_WARN(...)  audyn_log_write(AUDYN_LOG_WARN,  __VA_ARGS__)
-#define LOG_ERROR(...) audyn_log_write(AUDYN_LOG_ERROR, __VA_ARGS__)
+/* Convenience macros: each expansion is its own rate-limited call site */
+#define AUDYN_LOG_AT(level, ...)                                    \
+    do {                                                            \
+        static audyn_log_site_t audyn_log_site_;                    \
+        audyn_log_write_at(&audyn_log_site_, (level), __VA_ARGS__); \
+    } while (0)
+
+#define LOG_DEBUG(...) AUDYN_LOG_AT(AUDYN_LOG_DEBUG, __VA_ARGS__)
+#define LOG_INFO(...)  AUDYN_LOG_AT(AUDYN_LOG_INFO,  __VA_ARGS__)
+#define LOG_WARN(...)  AUDYN_LOG_AT(AUDYN_LOG_WARN,  __VA_ARGS__)
+#define LOG_ERROR(...) AUDYN_LOG_AT(AUDYN_LOG_ERROR, __VA_ARGS__)
 
 #ifdef __cplusplus
 }
@@ -0,0 +1,575 @@
+/*
+ *  Audyn — Professional Audio Capture & Archival Engine
+ *
+ *  File:
+ *      loudness.c
+ *
+ *  Purpose:
+ *      Streaming EBU R128 / ITU-R BS.1770-4 loudness and true-peak
+ *      measurement (see loudness.h).
+ *
+ *  Copyright:
+ *      (c) 2026 B. Wynne
+ *
+ *  Author:
+ *      B. Wynne
+ *
+ *  License:
+ *      GPLv2 or later
+ */
+
+#define _GNU_SOURCE
+
+#include "loudness.h"
+#include "log.h"
+
+#include <errno.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <unistd.h>
+
+/* -------- Constants -------- */
+
+#define SUBBLOCKS_MOMENTARY  4          /* 400 ms */
+#define SUBBLOCKS_SHORT_TERM 30         /* 3 s */
+
+#define ABSOLUTE_GATE_LUFS   (-70.0)
+#define RELATIVE_GATE_LU     (-10.0)    /* Integrated (BS.1770-4) */
+#define LRA_GATE_LU          (-20.0)    /* Loudness range (Tech 3342) */
+
+/* Block histograms: 0.1 LU bins from the absolute gate to +30 LUFS */
+#define HIST_MIN_LUFS        ABSOLUTE_GATE_LUFS
+#define HIST_BINS            1000
+#define HIST_STEP            0.1
+
+/* True-peak interpolator (BS.1770-4 Annex 2): 4 phases x 12 taps */
+#define TP_TAPS              12
+#define TP_PHASES            4
+
+static const float tp_coeffs[TP_PHASES][TP_TAPS] = {
+    {  0.0017089843750f,  0.0109863281250f, -0.0196533203125f,  0.0332031250000f,
+      -0.0594482421875f,  0.1373291015625f,  0.9721679687500f, -0.1022949218750f,
+       0.0476074218750f, -0.0266113281250f,  0.0148925781250f, -0.0083007812500f },
+    { -0.0291748046875f,  0.0292968750000f, -0.0517578125000f,  0.0891113281250f,
+      -0.1665039062500f,  0.4650878906250f,  0.7797851562500f, -0.2003173828125f,
+       0.1015625000000f, -0.0582275390625f,  0.0330810546875f, -0.0189208984375f },
+    { -0.0189208984375f,  0.0330810546875f, -0.0582275390625f,  0.1015625000000f,
+      -0.2003173828125f,  0.7797851562500f,  0.4650878906250f, -0.1665039062500f,
+       0.0891113281250f, -0.0517578125000f,  0.0292968750000f, -0.0291748046875f },
+    { -0.0083007812500f,  0.0148925781250f, -0.0266113281250f,  0.0476074218750f,
+      -0.1022949218750f,  0.9721679687500f,  0.1373291015625f, -0.0594482421875f,
+       0.0332031250000f, -0.0196533203125f,  0.0109863281250f,  0.0017089843750f },
+};
+
+/* -------- Types -------- */
+
+typedef struct biquad {
+    double b0, b1, b2, a1, a2;
+} biquad_t;
+
+typedef struct channel_state {
+    double z1[2], z2[2];                /* Biquad state (direct form II transposed) */
+    float hist[2 * TP_TAPS];            /* True-peak window, written twice */
+    uint32_t hist_pos;
+    float true_peak;                    /* Per file, linear */
+    float sample_peak;
+} channel_state_t;
+
+typedef struct histogram {
+    uint64_t count[HIST_BINS];
+    double energy[HIST_BINS];           /* Sum of block energies per bin */
+} histogram_t;
+
+struct audyn_loudness {
+    uint32_t channels;
+    uint32_t sample_rate;
+    uint32_t oversampling;
+    uint32_t tp_stride;                 /* Phase step into tp_coeffs */
+
+    biquad_t stage[2];                  /* Pre-filter, RLB high-pass */
+    channel_state_t ch[AUDYN_LOUDNESS_MAX_CHANNELS];
+    double weight[AUDYN_LOUDNESS_MAX_CHANNELS];     /* G_i (BS.1770-4 Table 3) */
+
+    /* Current 100 ms sub-block */
+    uint32_t sub_len;                   /* Frames per sub-block */
+    uint32_t sub_frames;                /* Frames accumulated so far */
+    double sub_energy;                  /* Sum over channels of G_i * y^2 */
+
+    /* Last 3 s of sub-block mean energies */
+    double ring[SUBBLOCKS_SHORT_TERM];
+    uint32_t ring_pos;
+    uint64_t subblocks;                 /* Completed since create() */
+
+    double momentary;                   /* LUFS, latest */
+    double short_term;
+
+    /* Per file */
+    uint64_t frames;
+    double max_momentary;
+    double max_short_term;
+    histogram_t integrated;             /* 400 ms blocks */
+    histogram_t range;                  /* 3 s blocks */
+};
+
+/* -------- Helpers -------- */
+
+static inline double energy_to_lufs(double e)
+{
+    return e > 0.0 ? -0.691 + 10.0 * log10(e) : -INFINITY;
+}
+
+static inline double lin_to_db(double v)
+{
+    return v > 0.0 ? 20.0 * log10(v) : -INFINITY;
+}
+
+/*
+ * K-weighting for any sample rate: the BS.1770 48 kHz filters expressed
+ * as analogue prototypes and re-derived with the bilinear transform.
+ */
+static void init_k_weighting(biquad_t st[2], double fs)
+{
+    /* Stage 1: high shelf, +4 dB above ~1.7 kHz */
+    double f0 = 1681.974450955533;
+    double G  = 3.999843853973347;
+    double Q  = 0.7071752369554196;
+    double K  = tan(M_PI * f0 / fs);
+    double Vh = pow(10.0, G / 20.0);
+    double Vb = pow(Vh, 0.4996667741545416);
+    double a0 = 1.0 + K / Q + K * K;
+
+    st[0].b0 = (Vh + Vb * K / Q + K * K) / a0;
+    st[0].b1 = 2.0 * (K * K - Vh) / a0;
+    st[0].b2 = (Vh - Vb * K / Q + K * K) / a0;
+    st[0].a1 = 2.0 * (K * K - 1.0) / a0;
+    st[0].a2 = (1.0 - K / Q + K * K) / a0;
+
+    /* Stage 2: RLB high-pass, ~38 Hz */
+    f0 = 38.13547087602444;
+    Q  = 0.5003270373238773;
+    K  = tan(M_PI * f0 / fs);
+    a0 = 1.0 + K / Q + K * K;
+
+    st[1].b0 = 1.0;
+    st[1].b1 = -2.0;
+    st[1].b2 = 1.0;
+    st[1].a1 = 2.0 * (K * K - 1.0) / a0;
+    st[1].a2 = (1.0 - K / Q + K * K) / a0;
+}
+
+static inline int hist_bin(double lufs)
+{
+    int bin = (int)floor((lufs - HIST_MIN_LUFS) / HIST_STEP);
+    if (bin < 0) return 0;
+    if (bin >= HIST_BINS) return HIST_BINS - 1;
+    return bin;
+}
+
+/* Blocks below the absolute gate are not passed in */
+static void hist_add(histogram_t *h, double energy, double lufs)
+{
+    int bin = hist_bin(lufs);
+    h->count[bin]++;
+    h->energy[bin] += energy;
+}
+
+/* Mean energy of every block at or above bin 'from' */
+static double hist_mean(const histogram_t *h, int from, uint64_t *count_out)
+{
+    uint64_t n = 0;
+    double e = 0.0;
+    for (int i = from; i < HIST_BINS; i++) {
+        n += h->count[i];
+        e += h->energy[i];
+    }
+    if (count_out) *count_out = n;
+    return n ? e / (double)n : 0.0;
+}
+
+/* Loudness (bin centre) below which 'frac' of the counted blocks lie */
+static double hist_percentile(const histogram_t *h, int from, uint64_t total, double frac)
+{
+    uint64_t target = (uint64_t)ceil(frac * (double)total);
+    if (target == 0) target = 1;
+
+    uint64_t seen = 0;
+    for (int i = from; i < HIST_BINS; i++) {
+        seen += h->count[i];
+        if (seen >= target) return HIST_MIN_LUFS + (i + 0.5) * HIST_STEP;
+    }
+    return HIST_MIN_LUFS + (HIST_BINS - 0.5) * HIST_STEP;
+}
+
+/* -------- Sub-blocks -------- */
+
+static double ring_mean(const audyn_loudness_t *l, uint32_t n)
+{
+    double e = 0.0;
+    uint32_t pos = l->ring_pos;
+    for (uint32_t i = 0; i < n; i++) {
+        pos = pos ? pos - 1 : SUBBLOCKS_SHORT_TERM - 1;
+        e += l->ring[pos];
+    }
+    return e / (double)n;
+}
+
+static void finish_subblock(audyn_loudness_t *l)
+{
+    l->ring[l->ring_pos] = l->sub_energy / (double)l->sub_len;
+    l->ring_pos = (l->ring_pos + 1) % SUBBLOCKS_SHORT_TERM;
+    l->subblocks++;
+    l->sub_energy = 0.0;
+    l->sub_frames = 0;
+
+    if (l->subblocks >= SUBBLOCKS_MOMENTARY) {
+        double e = ring_mean(l, SUBBLOCKS_MOMENTARY);
+        l->momentary = energy_to_lufs(e);
+        if (l->momentary > l->max_momentary) l->max_momentary = l->momentary;
+        if (l->momentary >= ABSOLUTE_GATE_LUFS) hist_add(&l->integrated, e, l->momentary);
+    }
+    if (l->subblocks >= SUBBLOCKS_SHORT_TERM) {
+        double e = ring_mean(l, SUBBLOCKS_SHORT_TERM);
+        l->short_term = energy_to_lufs(e);
+        if (l->short_term > l->max_short_term) l->max_short_term = l->short_term;
+        if (l->short_term >= ABSOLUTE_GATE_LUFS) hist_add(&l->range, e, l->short_term);
+    }
+}
+
+/* K-weighted energy and peaks for one channel over 'frames' frames */
+static double process_channel(audyn_loudness_t *l, channel_state_t *c,
+                              const float *x, uint32_t stride, uint32_t frames)
+{
+    const biquad_t *s0 = &l->stage[0];
+    const biquad_t *s1 = &l->stage[1];
+    double z10 = c->z1[0], z20 = c->z2[0];
+    double z11 = c->z1[1], z21 = c->z2[1];
+    double energy = 0.0;
+    float tp = c->true_peak;
+    float sp = c->sample_peak;
+    uint32_t pos = c->hist_pos;
+
+    for (uint32_t i = 0; i < frames; i++) {
+        const float v = x[(size_t)i * stride];
+
+        /* K-weighting, two direct form II transposed sections */
+        double in = v;
+        double y = s0->b0 * in + z10;
+        z10 = s0->b1 * in - s0->a1 * y + z20;
+        z20 = s0->b2 * in - s0->a2 * y;
+        in = y;
+        y = s1->b0 * in + z11;
+        z11 = s1->b1 * in - s1->a1 * y + z21;
+        z21 = s1->b2 * in - s1->a2 * y;
+        energy += y * y;
+
+        const float a = fabsf(v);
+        if (a > sp) sp = a;
+
+        if (l->oversampling > 1) {
+            /* Window oldest..newest is hist[pos + 1 .. pos + TP_TAPS] */
+            c->hist[pos] = v;
+            c->hist[pos + TP_TAPS] = v;
+            const float *w = &c->hist[pos + 1];
+            for (uint32_t p = 0; p < TP_PHASES; p += l->tp_stride) {
+                const float *h = tp_coeffs[p];
+                float acc = 0.0f;
+                for (uint32_t t = 0; t < TP_TAPS; t++) acc += h[TP_TAPS - 1 - t] * w[t];
+                acc = fabsf(acc);
+                if (acc > tp) tp = acc;
+            }
+            pos = pos + 1 == TP_TAPS ? 0 : pos + 1;
+        }
+    }
+
+    c->z1[0] = z10; c->z2[0] = z20;
+    c->z1[1] = z11; c->z2[1] = z21;
+    c->hist_pos = pos;
+    c->sample_peak = sp;
+    /* The interpolator can read a little under an isolated sample */
+    c->true_peak = tp > sp ? tp : sp;
+    return energy;
+}
+
+/* -------- Public API -------- */
+
+audyn_loudness_t *audyn_loudness_create(uint32_t channels, uint32_t sample_rate)
+{
+    if (channels == 0 || channels > AUDYN_LOUDNESS_MAX_CHANNELS) {
+        LOG_ERROR("loudness: invalid channels %u (must be 1-%u)",
+                  channels, AUDYN_LOUDNESS_MAX_CHANNELS);
+        return NULL;
+    }
+    if (sample_rate < 8000) {
+        LOG_ERROR("loudness: unsupported sample rate %u", sample_rate);
+        return NULL;
+    }
+
+    audyn_loudness_t *l = calloc(1, sizeof(*l));
+    if (!l) {
+        LOG_ERROR("loudness: failed to allocate meter");
+        return NULL;
+    }
+
+    l->channels = channels;
+    l->sample_rate = sample_rate;
+    for (uint32_t ch = 0; ch < channels; ch++) l->weight[ch] = 1.0;
+    l->sub_len = sample_rate / 10;
+    init_k_weighting(l->stage, (double)sample_rate);
+
+    if (sample_rate >= 192000) {
+        l->oversampling = 1;
+        l->tp_stride = TP_PHASES;
+    } else if (sample_rate >= 96000) {
+        l->oversampling = 2;
+        l->tp_stride = 2;           /* Phases 0 and 2: offsets 0 and 1/2 */
+    } else {
+        l->oversampling = 4;
+        l->tp_stride = 1;
+    }
+
+    l->momentary = -INFINITY;
+    l->short_term = -INFINITY;
+    audyn_loudness_reset_file(l);
+
+    LOG_DEBUG("loudness: %u channels at %u Hz, true peak %ux",
+              channels, sample_rate, l->oversampling);
+    return l;
+}
+
+void audyn_loudness_destroy(audyn_loudness_t *l)
+{
+    free(l);
+}
+
+static const struct {
+    const char *name;
+    float weight;
+} k_roles[] = {
+    { "L", 1.0f }, { "R", 1.0f }, { "C", 1.0f }, { "M", 1.0f },
+    { "Ls", 1.41f }, { "Rs", 1.41f }, { "Lss", 1.41f }, { "Rss", 1.41f },
+    { "Lrs", 1.0f }, { "Rrs", 1.0f },
+    { "LFE", 0.0f },
+};
+
+int audyn_loudness_parse_layout(const char *spec, audyn_loudness_layout_t *out)
+{
+    if (!spec || !out) return -1;
+
+    if (!strcmp(spec, "5.1")) spec = "L,R,C,LFE,Ls,Rs";
+    else if (!strcmp(spec, "7.1")) spec = "L,R,C,LFE,Lss,Rss,Lrs,Rrs";
+
+    char buf[256];
+    if (strlen(spec) >= sizeof(buf)) return -1;
+    snprintf(buf, sizeof(buf), "%s", spec);
+
+    memset(out, 0, sizeof(*out));
+    char *save = NULL;
+    for (char *tok = strtok_r(buf, ",", &save); tok; tok = strtok_r(NULL, ",", &save)) {
+        if (out->channels == AUDYN_LOUDNESS_MAX_CHANNELS) return -1;
+
+        size_t i;
+        for (i = 0; i < sizeof(k_roles) / sizeof(k_roles[0]); i++) {
+            if (!strcasecmp(tok, k_roles[i].name)) break;
+        }
+        float w;
+        if (i < sizeof(k_roles) / sizeof(k_roles[0])) {
+            w = k_roles[i].weight;
+        } else {
+            char *end = NULL;
+            errno = 0;
+            w = strtof(tok, &end);
+            if (errno || end == tok || *end || !(w >= 0.0f && w <= 2.0f)) return -1;
+        }
+        out->weight[out->channels++] = w;
+    }
+    return out->channels > 0 ? 0 : -1;
+}
+
+int audyn_loudness_set_layout(audyn_loudness_t *l, const audyn_loudness_layout_t *layout)
+{
+    if (!l || !layout) return -1;
+
+    if (layout->channels != l->channels) {
+        LOG_ERROR("loudness: layout has %u channels, stream has %u",
+                  layout->channels, l->channels);
+        return -1;
+    }
+    for (uint32_t ch = 0; ch < l->channels; ch++) l->weight[ch] = layout->weight[ch];
+    return 0;
+}
+
+void audyn_loudness_process(audyn_loudness_t *l, const float *pcm, uint32_t frames)
+{
+    if (!l || !pcm) return;
+
+    const uint32_t nch = l->channels;
+    l->frames += frames;
+
+    /* Channel-major over each stretch up to the next sub-block boundary */
+    while (frames > 0) {
+        uint32_t n = l->sub_len - l->sub_frames;
+        if (n > frames) n = frames;
+
+        for (uint32_t ch = 0; ch < nch; ch++) {
+            l->sub_energy += l->weight[ch] * process_channel(l, &l->ch[ch], pcm + ch, nch, n);
+        }
+
+        l->sub_frames += n;
+        if (l->sub_frames == l->sub_len) finish_subblock(l);
+
+        pcm += (size_t)n * nch;
+        frames -= n;
+    }
+}
+
+double audyn_loudness_momentary(const audyn_loudness_t *l)
+{
+    return l ? l->momentary : -INFINITY;
+}
+
+double audyn_loudness_short_term(const audyn_loudness_t *l)
+{
+    return l ? l->short_term : -INFINITY;
+}
+
+void audyn_loudness_get_summary(const audyn_loudness_t *l, audyn_loudness_summary_t *out)
+{
+    if (!l || !out) return;
+
+    memset(out, 0, sizeof(*out));
+    out->frames = l->frames;
+    out->oversampling = l->oversampling;
+    out->max_momentary_lufs = l->max_momentary;
+    out->max_short_term_lufs = l->max_short_term;
+
+    /* Integrated: absolute gate (histogram floor), then relative gate */
+    uint64_t n;
+    double e = hist_mean(&l->integrated, 0, &n);
+    out->integrated_lufs = -INFINITY;
+    if (n > 0) {
+        int from = hist_bin(energy_to_lufs(e) + RELATIVE_GATE_LU);
+        e = hist_mean(&l->integrated, from, &n);
+        if (n > 0) out->integrated_lufs = energy_to_lufs(e);
+    }
+
+    /* Loudness range: relative gate on short-term blocks, 10th-95th */
+    e = hist_mean(&l->range, 0, &n);
+    out->loudness_range_lu = 0.0;
+    if (n > 0) {
+        int from = hist_bin(energy_to_lufs(e) + LRA_GATE_LU);
+        hist_mean(&l->range, from, &n);
+        if (n > 0) {
+            out->loudness_range_lu = hist_percentile(&l->range, from, n, 0.95) -
+                                     hist_percentile(&l->range, from, n, 0.10);
+        }
+    }
+
+    float tp = 0.0f, sp = 0.0f;
+    for (uint32_t ch = 0; ch < l->channels; ch++) {
+        if (l->ch[ch].true_peak > tp) tp = l->ch[ch].true_peak;
+        if (l->ch[ch].sample_peak > sp) sp = l->ch[ch].sample_peak;
+    }
+    out->true_peak_dbtp = lin_to_db(tp);
+    out->sample_peak_dbfs = lin_to_db(sp);
+}
+
+void audyn_loudness_reset_file(audyn_loudness_t *l)
+{
+    if (!l) return;
+
+    l->frames = 0;
+    l->max_momentary = -INFINITY;
+    l->max_short_term = -INFINITY;
+    memset(&l->integrated, 0, sizeof(l->integrated));
+    memset(&l->range, 0, sizeof(l->range));
+    for (uint32_t ch = 0; ch < l->channels; ch++) {
+        l->ch[ch].true_peak = 0.0f;
+        l->ch[ch].sample_peak = 0.0f;
+    }
+}
+
+/* -------- Sidecar -------- */
+
+/* JSON number, or null for a value that never passed the gates */
+static void put_value(FILE *f, const char *key, double v, const char *sep)
+{
+    if (isfinite(v)) fprintf(f, "  \"%s\": %.2f%s\n", key, v, sep);
+    else fprintf(f, "  \"%s\": null%s\n", key, sep);
+}
+
+static void put_string(FILE *f, const char *key, const char *s)
+{
+    fprintf(f, "  \"%s\": \"", key);
+    for (; *s; s++) {
+        unsigned char c = (unsigned char)*s;
+        if (c == '"' || c == '\\') fprintf(f, "\\%c", c);
+        else if (c < 0x20) fprintf(f, "\\u%04x", c);
+        else fputc(c, f);
+    }
+    fputs("\",\n", f);
+}
+
+int audyn_loudness_write_sidecar(const audyn_loudness_summary_t *s,
+                                 const char *audio_path,
+                                 uint32_t sample_rate,
+                                 uint32_t channels)
+{
+    if (!s || !audio_path || !audio_path[0]) return -1;
+
+    char path[1100];
+    char tmp[1110];
+    int n = snprintf(path, sizeof(path), "%s.loudness.json", audio_path);
+    if (n < 0 || (size_t)n >= sizeof(path)) {
+        LOG_ERROR("loudness: sidecar path too long for %s", audio_path);
+        return -1;
+    }
+    snprintf(tmp, sizeof(tmp), "%s.tmp", path);
+
+    FILE *f = fopen(tmp, "w");
+    if (!f) {
+        LOG_ERROR("loudness: cannot create %s: %s", tmp, strerror(errno));
+        return -1;
+    }
+
+    const char *base = strrchr(audio_path, '/');
+    base = base ? base + 1 : audio_path;
+
+    fputs("{\n", f);
+    put_string(f, "file", base);
+    fputs("  \"standard\": \"EBU R128 / ITU-R BS.1770-4\",\n", f);
+    fprintf(f, "  \"sample_rate\": %u,\n", sample_rate);
+    fprintf(f, "  \"channels\": %u,\n", channels);
+    fprintf(f, "  \"duration_s\": %.3f,\n",
+            sample_rate ? (double)s->frames / sample_rate : 0.0);
+    put_value(f, "integrated_lufs", s->integrated_lufs, ",");
+    put_value(f, "loudness_range_lu", s->loudness_range_lu, ",");
+    put_value(f, "true_peak_dbtp", s->true_peak_dbtp, ",");
+    put_value(f, "sample_peak_dbfs", s->sample_peak_dbfs, ",");
+    put_value(f, "max_momentary_lufs", s->max_momentary_lufs, ",");
+    put_value(f, "max_short_term_lufs", s->max_short_term_lufs, ",");
+    fprintf(f, "  \"true_peak_oversampling\": %u\n", s->oversampling);
+    fputs("}\n", f);
+
+    int err = ferror(f);
+    if (fclose(f) != 0 || err) {
+        LOG_ERROR("loudness: write to %s failed", tmp);
+        unlink(tmp);
+        return -1;
+    }
+    if (rename(tmp, path) != 0) {
+        LOG_ERROR("loudness: rename to %s failed: %s", path, strerror(errno));
+        unlink(tmp);
+        return -1;
+    }
+
+    if (isfinite(s->integrated_lufs)) {
+        LOG_INFO("Loudness: %s  I %.1f LUFS  LRA %.1f LU  TP %.1f dBTP",
+                 base, s->integrated_lufs, s->loudness_range_lu, s->true_peak_dbtp);
+    } else {
+        LOG_INFO("Loudness: %s  I -inf (below gate)", base);
+    }
+    return 0;
+}
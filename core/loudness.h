@@ -0,0 +1,130 @@
+/*
+ *  Audyn — Professional Audio Capture & Archival Engine
+ *
+ *  File:
+ *      loudness.h
+ *
+ *  Purpose:
+ *      Streaming EBU R128 / ITU-R BS.1770-4 loudness and true-peak
+ *      measurement on the audio as it is written, so every archived file
+ *      gets its compliance figures without a second pass.
+ *
+ *  Measurement:
+ *      - K-weighting (BS.1770 pre-filter + RLB high-pass), coefficients
+ *        derived for the stream's sample rate
+ *      - 100 ms sub-blocks; momentary = last 400 ms, short-term = last 3 s
+ *      - Integrated: 400 ms blocks at 75% overlap, -70 LUFS absolute and
+ *        -10 LU relative gate (BS.1770-4)
+ *      - Loudness range: short-term values every 100 ms, -70 LUFS and
+ *        -20 LU gates, 10th to 95th percentile (EBU Tech 3342)
+ *      - True peak: BS.1770-4 Annex 2 polyphase interpolator, 4x below
+ *        96 kHz, 2x below 192 kHz, sample peak above; never reported
+ *        below the sample peak
+ *      - Channel weights (BS.1770-4 Table 3) from a layout given with
+ *        set_layout(); without one every channel is weighted 1.0, which
+ *        is right for mono, stereo and bundles of independent channels
+ *
+ *  Per file:
+ *      Gated block statistics live in fixed 0.1 LU histograms, so memory
+ *      does not grow with file length. reset_file() starts a new file's
+ *      figures; filter state and the sliding windows carry on, so blocks
+ *      spanning a rotation count toward the file in which they complete.
+ *
+ *  Threading:
+ *      - NOT thread-safe. One caller thread (the worker).
+ *
+ *  Copyright:
+ *      (c) 2026 B. Wynne
+ *
+ *  Author:
+ *      B. Wynne
+ *
+ *  License:
+ *      GPLv2 or later
+ */
+
+#ifndef AUDYN_LOUDNESS_H
+#define AUDYN_LOUDNESS_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define AUDYN_LOUDNESS_MAX_CHANNELS 32
+
+typedef struct audyn_loudness audyn_loudness_t;
+
+/* Per-channel weights G_i for the block energy sum */
+typedef struct audyn_loudness_layout {
+    uint32_t channels;
+    float weight[AUDYN_LOUDNESS_MAX_CHANNELS];
+} audyn_loudness_layout_t;
+
+/* Figures for the audio since create() or the last reset_file().
+ * Loudness values are -INFINITY when nothing passed the gates. */
+typedef struct audyn_loudness_summary {
+    uint64_t frames;                /* Sample frames measured */
+    double integrated_lufs;
+    double loudness_range_lu;
+    double max_momentary_lufs;
+    double max_short_term_lufs;
+    double true_peak_dbtp;          /* Max over channels */
+    double sample_peak_dbfs;
+    uint32_t oversampling;          /* True-peak factor (1, 2 or 4) */
+} audyn_loudness_summary_t;
+
+/*
+ * Create a meter for interleaved float audio.
+ * Returns meter or NULL on error (logged). NOT real-time safe.
+ */
+audyn_loudness_t *audyn_loudness_create(uint32_t channels, uint32_t sample_rate);
+
+void audyn_loudness_destroy(audyn_loudness_t *l);
+
+/*
+ * Parse a channel layout: "5.1" (L,R,C,LFE,Ls,Rs), "7.1"
+ * (L,R,C,LFE,Lss,Rss,Lrs,Rrs), or a comma-separated list with one entry
+ * per channel:
+ *   L, R, C, M          1.0
+ *   Ls, Rs, Lss, Rss    1.41 (surround/side, 60-120 degrees)
+ *   Lrs, Rrs            1.0  (rear, beyond 120 degrees)
+ *   LFE                 0    (excluded from loudness; peaks still count)
+ *   <number>            that weight, 0-2 (e.g. height channels: 1.0)
+ * Returns 0 on success, -1 on a malformed spec.
+ */
+int audyn_loudness_parse_layout(const char *spec, audyn_loudness_layout_t *out);
+
+/*
+ * Weight channels by layout from the next sub-block on.
+ * Returns 0, or -1 if the layout's channel count differs (logged).
+ */
+int audyn_loudness_set_layout(audyn_loudness_t *l, const audyn_loudness_layout_t *layout);
+
+/* Measure 'frames' interleaved sample frames. No allocation. */
+void audyn_loudness_process(audyn_loudness_t *l, const float *pcm, uint32_t frames);
+
+/* Current momentary (400 ms) and short-term (3 s) loudness, LUFS */
+double audyn_loudness_momentary(const audyn_loudness_t *l);
+double audyn_loudness_short_term(const audyn_loudness_t *l);
+
+void audyn_loudness_get_summary(const audyn_loudness_t *l, audyn_loudness_summary_t *out);
+
+/* Start the next file's figures (histograms, maxima, frame count). */
+void audyn_loudness_reset_file(audyn_loudness_t *l);
+
+/*
+ * Write summary as JSON to "<audio_path>.loudness.json" (via a temporary
+ * file and rename). Returns 0 on success, -1 on error (logged).
+ */
+int audyn_loudness_write_sidecar(const audyn_loudness_summary_t *s,
+                                 const char *audio_path,
+                                 uint32_t sample_rate,
+                                 uint32_t channels);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* AUDYN_LOUDNESS_H */
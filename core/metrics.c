@@ -0,0 +1,450 @@
+/*
+ *  Audyn — Professional Audio Capture & Archival Engine
+ *
+ *  File:
+ *      metrics.c
+ *
+ *  Purpose:
+ *      Per-stage latency histograms and counters with a shared-memory
+ *      endpoint (see metrics.h).
+ *
+ *  Shards:
+ *      A shard is claimed with a CAS on its 'owned' flag and released
+ *      (store-release) by the pthread key destructor when the thread
+ *      exits, so the next owner's first load sees every count the last
+ *      one stored. Threads that find none free record into the overflow
+ *      shard with fetch_add.
+ *
+ *  Copyright:
+ *      (c) 2026 B. Wynne
+ *
+ *  Author:
+ *      B. Wynne
+ *
+ *  License:
+ *      GPLv2 or later
+ */
+
+#define _GNU_SOURCE
+
+#include "metrics.h"
+#include "rt.h"
+#include "log.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdalign.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+/* Fixed offsets promised to readers (metrics.h) */
+_Static_assert(offsetof(audyn_metrics_shm_layout_t, seq) == 32, "metrics: seq offset");
+_Static_assert(offsetof(audyn_metrics_shm_layout_t, update_ns) == 40, "metrics: update_ns offset");
+_Static_assert(offsetof(audyn_metrics_shm_layout_t, n_values) == 56, "metrics: n_values offset");
+_Static_assert(sizeof(audyn_metrics_shm_layout_t) == 64, "metrics: header size");
+_Static_assert(sizeof(audyn_metrics_shm_stage_t) ==
+               AUDYN_METRICS_NAME_BYTES + 8 * (3 + AUDYN_METRICS_BUCKETS), "metrics: stage size");
+_Static_assert(sizeof(audyn_metrics_shm_value_t) == AUDYN_METRICS_NAME_BYTES + 8, "metrics: value size");
+
+#define SUB_COUNT   (1u << AUDYN_METRICS_SUB_BITS)
+
+typedef struct metrics_hist {
+    _Atomic uint64_t count;
+    _Atomic uint64_t sum_ns;
+    _Atomic uint64_t max_ns;
+    _Atomic uint64_t buckets[AUDYN_METRICS_BUCKETS];
+} metrics_hist_t;
+
+typedef struct metrics_shard {
+    alignas(64) _Atomic int owned;
+    int shared;                         /* Overflow shard: atomic adds */
+    _Atomic uint64_t counters[AUDYN_CTR_COUNT];
+    metrics_hist_t hist[AUDYN_STAGE_COUNT];
+} metrics_shard_t;
+
+/* Shards [0, AUDYN_METRICS_SHARDS) are private, the last is the overflow */
+static metrics_shard_t *g_shards;
+static _Atomic int g_enabled;
+static _Atomic uint32_t g_shards_used;
+static uint64_t g_start_ns;
+static pthread_key_t g_key;
+
+static _Thread_local metrics_shard_t *tl_shard;
+
+static const char *const g_stage_names[AUDYN_STAGE_COUNT] = {
+    "rx_push", "queue_dwell", "sink_write", "encode", "fsync", "rotation"
+};
+
+static const char *const g_counter_names[AUDYN_CTR_COUNT] = {
+    "frames_pushed", "drops_pool", "drops_queue", "frames_consumed",
+    "writer_stalls", "encode_drops"
+};
+
+static uint64_t monotonic_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+/* -------- Recording -------- */
+
+static void shard_release(void *p)
+{
+    metrics_shard_t *s = (metrics_shard_t *)p;
+    atomic_store_explicit(&s->owned, 0, memory_order_release);
+}
+
+static metrics_shard_t *shard_claim(void)
+{
+    for (uint32_t i = 0; i < AUDYN_METRICS_SHARDS; i++) {
+        metrics_shard_t *s = &g_shards[i];
+        int expected = 0;
+        if (atomic_load_explicit(&s->owned, memory_order_relaxed) == 0 &&
+            atomic_compare_exchange_strong_explicit(&s->owned, &expected, 1,
+                                                    memory_order_acquire,
+                                                    memory_order_relaxed)) {
+            (void)pthread_setspecific(g_key, s);
+
+            /* Highest shard index claimed so far */
+            uint32_t used = atomic_load_explicit(&g_shards_used, memory_order_relaxed);
+            while (used < i + 1 &&
+                   !atomic_compare_exchange_weak_explicit(&g_shards_used, &used, i + 1,
+                                                          memory_order_relaxed,
+                                                          memory_order_relaxed)) {
+            }
+            return s;
+        }
+    }
+    return &g_shards[AUDYN_METRICS_SHARDS];
+}
+
+static inline metrics_shard_t *my_shard(void)
+{
+    if (!tl_shard) tl_shard = shard_claim();
+    return tl_shard;
+}
+
+/* Single writer: a relaxed load and store instead of a locked add */
+static inline void shard_add(const metrics_shard_t *s, _Atomic uint64_t *v, uint64_t n)
+{
+    if (s->shared) {
+        atomic_fetch_add_explicit(v, n, memory_order_relaxed);
+    } else {
+        atomic_store_explicit(v, atomic_load_explicit(v, memory_order_relaxed) + n,
+                              memory_order_relaxed);
+    }
+}
+
+static inline void shard_max(const metrics_shard_t *s, _Atomic uint64_t *v, uint64_t x)
+{
+    uint64_t cur = atomic_load_explicit(v, memory_order_relaxed);
+    if (x <= cur) return;
+    if (s->shared) {
+        while (cur < x &&
+               !atomic_compare_exchange_weak_explicit(v, &cur, x, memory_order_relaxed,
+                                                      memory_order_relaxed)) {
+        }
+    } else {
+        atomic_store_explicit(v, x, memory_order_relaxed);
+    }
+}
+
+static inline uint32_t bucket_of(uint64_t ns)
+{
+    if (ns < SUB_COUNT) return (uint32_t)ns;
+
+    uint32_t msb = 63u - (uint32_t)__builtin_clzll(ns);
+    if (msb >= AUDYN_METRICS_MAX_EXP) return AUDYN_METRICS_BUCKETS - 1;
+
+    uint32_t sub = (uint32_t)(ns >> (msb - AUDYN_METRICS_SUB_BITS)) & (SUB_COUNT - 1);
+    return ((msb - AUDYN_METRICS_SUB_BITS + 1) << AUDYN_METRICS_SUB_BITS) + sub;
+}
+
+uint64_t audyn_metrics_bucket_lower(uint32_t i)
+{
+    if (i < SUB_COUNT) return i;
+
+    uint32_t msb = (i >> AUDYN_METRICS_SUB_BITS) + AUDYN_METRICS_SUB_BITS - 1;
+    uint64_t sub = i & (SUB_COUNT - 1);
+    return (SUB_COUNT + sub) << (msb - AUDYN_METRICS_SUB_BITS);
+}
+
+int audyn_metrics_enabled(void)
+{
+    return atomic_load_explicit(&g_enabled, memory_order_acquire);
+}
+
+uint64_t audyn_metrics_start(void)
+{
+    return audyn_metrics_enabled() ? monotonic_ns() : 0;
+}
+
+void audyn_metrics_record(audyn_stage_t stage, uint64_t ns)
+{
+    if (!audyn_metrics_enabled() || (unsigned)stage >= AUDYN_STAGE_COUNT) return;
+
+    metrics_shard_t *s = my_shard();
+    metrics_hist_t *h = &s->hist[stage];
+    shard_add(s, &h->buckets[bucket_of(ns)], 1);
+    shard_add(s, &h->count, 1);
+    shard_add(s, &h->sum_ns, ns);
+    shard_max(s, &h->max_ns, ns);
+}
+
+void audyn_metrics_stage_end(audyn_stage_t stage, uint64_t start_ns)
+{
+    if (start_ns == 0) return;
+
+    uint64_t now = monotonic_ns();
+    audyn_metrics_record(stage, now > start_ns ? now - start_ns : 0);
+}
+
+void audyn_metrics_count(audyn_counter_t ctr, uint64_t n)
+{
+    if (!audyn_metrics_enabled() || (unsigned)ctr >= AUDYN_CTR_COUNT) return;
+
+    metrics_shard_t *s = my_shard();
+    shard_add(s, &s->counters[ctr], n);
+}
+
+const char *audyn_metrics_stage_name(audyn_stage_t stage)
+{
+    return ((unsigned)stage < AUDYN_STAGE_COUNT) ? g_stage_names[stage] : "unknown";
+}
+
+const char *audyn_metrics_counter_name(audyn_counter_t ctr)
+{
+    return ((unsigned)ctr < AUDYN_CTR_COUNT) ? g_counter_names[ctr] : "unknown";
+}
+
+int audyn_metrics_init(void)
+{
+    if (audyn_metrics_enabled()) return 0;
+
+    if (pthread_key_create(&g_key, shard_release) != 0) {
+        LOG_ERROR("metrics: pthread_key_create failed");
+        return -1;
+    }
+
+    g_shards = (metrics_shard_t *)audyn_rt_alloc((AUDYN_METRICS_SHARDS + 1) * sizeof(metrics_shard_t));
+    if (!g_shards) {
+        LOG_ERROR("metrics: failed to allocate %u shards", AUDYN_METRICS_SHARDS);
+        pthread_key_delete(g_key);
+        return -1;
+    }
+    g_shards[AUDYN_METRICS_SHARDS].shared = 1;
+    atomic_store_explicit(&g_shards[AUDYN_METRICS_SHARDS].owned, 1, memory_order_relaxed);
+
+    g_start_ns = monotonic_ns();
+    atomic_store_explicit(&g_enabled, 1, memory_order_release);
+
+    LOG_DEBUG("metrics: %u shards, %u buckets per stage",
+              AUDYN_METRICS_SHARDS, AUDYN_METRICS_BUCKETS);
+    return 0;
+}
+
+/* -------- Shared-memory endpoint -------- */
+
+struct audyn_metrics_shm {
+    audyn_metrics_shm_layout_t *map;
+    size_t map_bytes;
+    audyn_metrics_shm_stage_t *stages;      /* In the mapping */
+    audyn_metrics_shm_value_t *values;      /* In the mapping */
+
+    /* Summed outside the write window, so readers retry less */
+    audyn_metrics_shm_stage_t scratch[AUDYN_STAGE_COUNT];
+    uint64_t counters[AUDYN_CTR_COUNT];
+
+    char name[AUDYN_METRICS_SHM_NAME_MAX + 2];  /* Leading '/' + NUL */
+};
+
+/* Canonical "/name" into out; -1 if the name is unusable */
+static int canon_name(const char *name, char *out, size_t out_len)
+{
+    if (!name) return -1;
+    if (name[0] == '/') name++;
+
+    size_t len = strlen(name);
+    if (len == 0 || len > AUDYN_METRICS_SHM_NAME_MAX) return -1;
+    if (strchr(name, '/')) return -1;
+    if (!strcmp(name, ".") || !strcmp(name, "..")) return -1;
+
+    snprintf(out, out_len, "/%s", name);
+    return 0;
+}
+
+int audyn_metrics_shm_check_name(const char *name)
+{
+    char tmp[AUDYN_METRICS_SHM_NAME_MAX + 2];
+    return canon_name(name, tmp, sizeof(tmp));
+}
+
+static void copy_name(char dst[AUDYN_METRICS_NAME_BYTES], const char *src)
+{
+    memset(dst, 0, AUDYN_METRICS_NAME_BYTES);
+    strncpy(dst, src, AUDYN_METRICS_NAME_BYTES - 1);
+}
+
+audyn_metrics_shm_t *audyn_metrics_shm_create(const char *name)
+{
+    audyn_metrics_shm_t *shm = calloc(1, sizeof(*shm));
+    if (!shm) {
+        LOG_ERROR("metrics: failed to allocate endpoint");
+        return NULL;
+    }
+    if (canon_name(name, shm->name, sizeof(shm->name)) != 0) {
+        LOG_ERROR("metrics: invalid endpoint name '%s' (1-%d characters, no '/')",
+                  name ? name : "", AUDYN_METRICS_SHM_NAME_MAX);
+        free(shm);
+        return NULL;
+    }
+
+    shm->map_bytes = sizeof(audyn_metrics_shm_layout_t) +
+                     AUDYN_STAGE_COUNT * sizeof(audyn_metrics_shm_stage_t) +
+                     AUDYN_METRICS_MAX_VALUES * sizeof(audyn_metrics_shm_value_t);
+
+    /* World-readable: the web backend may run as another user */
+    int fd = shm_open(shm->name, O_CREAT | O_RDWR | O_TRUNC, 0644);
+    if (fd < 0) {
+        LOG_ERROR("metrics: shm_open(%s) failed: %s", shm->name, strerror(errno));
+        free(shm);
+        return NULL;
+    }
+    if (ftruncate(fd, (off_t)shm->map_bytes) != 0) {
+        LOG_ERROR("metrics: ftruncate(%s) failed: %s", shm->name, strerror(errno));
+        close(fd);
+        shm_unlink(shm->name);
+        free(shm);
+        return NULL;
+    }
+
+    void *p = mmap(NULL, shm->map_bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (p == MAP_FAILED) {
+        LOG_ERROR("metrics: mmap(%s) failed: %s", shm->name, strerror(errno));
+        shm_unlink(shm->name);
+        free(shm);
+        return NULL;
+    }
+
+    shm->map = (audyn_metrics_shm_layout_t *)p;
+    shm->stages = (audyn_metrics_shm_stage_t *)(shm->map + 1);
+    shm->values = (audyn_metrics_shm_value_t *)(shm->stages + AUDYN_STAGE_COUNT);
+
+    for (uint32_t st = 0; st < AUDYN_STAGE_COUNT; st++) {
+        copy_name(shm->scratch[st].name, g_stage_names[st]);
+        copy_name(shm->stages[st].name, g_stage_names[st]);
+    }
+
+    /* Fresh (zeroed) mapping; publish the header with magic last */
+    audyn_metrics_shm_layout_t *m = shm->map;
+    m->version = AUDYN_METRICS_SHM_VERSION;
+    m->header_bytes = (uint32_t)sizeof(*m);
+    m->pid = (uint32_t)getpid();
+    m->n_stages = AUDYN_STAGE_COUNT;
+    m->n_buckets = AUDYN_METRICS_BUCKETS;
+    m->sub_bits = AUDYN_METRICS_SUB_BITS;
+    m->update_ns = monotonic_ns();
+    m->start_ns = g_start_ns ? g_start_ns : m->update_ns;
+    atomic_store_explicit(&m->state, 1u, memory_order_relaxed);
+    atomic_store_explicit(&m->seq, 0u, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    m->magic = AUDYN_METRICS_SHM_MAGIC;
+
+    LOG_INFO("Metrics endpoint: /dev/shm%s (%zu bytes)", shm->name, shm->map_bytes);
+    return shm;
+}
+
+/* Sum every shard into shm->scratch and shm->counters */
+static void collect(audyn_metrics_shm_t *shm)
+{
+    for (uint32_t st = 0; st < AUDYN_STAGE_COUNT; st++) {
+        audyn_metrics_shm_stage_t *out = &shm->scratch[st];
+        out->count = out->sum_ns = out->max_ns = 0;
+        memset(out->buckets, 0, sizeof(out->buckets));
+    }
+    memset(shm->counters, 0, sizeof(shm->counters));
+
+    if (!g_shards) return;
+
+    for (uint32_t i = 0; i <= AUDYN_METRICS_SHARDS; i++) {
+        metrics_shard_t *s = &g_shards[i];
+        for (uint32_t c = 0; c < AUDYN_CTR_COUNT; c++) {
+            shm->counters[c] += atomic_load_explicit(&s->counters[c], memory_order_relaxed);
+        }
+        for (uint32_t st = 0; st < AUDYN_STAGE_COUNT; st++) {
+            metrics_hist_t *h = &s->hist[st];
+            audyn_metrics_shm_stage_t *out = &shm->scratch[st];
+
+            uint64_t n = atomic_load_explicit(&h->count, memory_order_relaxed);
+            if (n == 0) continue;
+            out->count += n;
+            out->sum_ns += atomic_load_explicit(&h->sum_ns, memory_order_relaxed);
+            uint64_t mx = atomic_load_explicit(&h->max_ns, memory_order_relaxed);
+            if (mx > out->max_ns) out->max_ns = mx;
+            for (uint32_t b = 0; b < AUDYN_METRICS_BUCKETS; b++) {
+                out->buckets[b] += atomic_load_explicit(&h->buckets[b], memory_order_relaxed);
+            }
+        }
+    }
+}
+
+void audyn_metrics_shm_publish(audyn_metrics_shm_t *shm,
+                               const audyn_metric_value_t *values,
+                               uint32_t n_values)
+{
+    if (!shm) return;
+
+    collect(shm);
+
+    uint32_t room = AUDYN_METRICS_MAX_VALUES - AUDYN_CTR_COUNT;
+    if (n_values > room) n_values = room;
+
+    audyn_metrics_shm_layout_t *m = shm->map;
+    const uint64_t seq = atomic_load_explicit(&m->seq, memory_order_relaxed);
+
+    /* Single publisher: seq odd, write, seq even */
+    atomic_store_explicit(&m->seq, seq + 1u, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+
+    memcpy(shm->stages, shm->scratch, sizeof(shm->scratch));
+
+    uint32_t v = 0;
+    for (uint32_t c = 0; c < AUDYN_CTR_COUNT; c++, v++) {
+        copy_name(shm->values[v].name, g_counter_names[c]);
+        shm->values[v].value = shm->counters[c];
+    }
+    for (uint32_t i = 0; i < n_values; i++) {
+        if (!values[i].name) continue;
+        copy_name(shm->values[v].name, values[i].name);
+        shm->values[v].value = values[i].value;
+        v++;
+    }
+    m->n_values = v;
+    m->shards_used = atomic_load_explicit(&g_shards_used, memory_order_relaxed);
+    m->update_ns = monotonic_ns();
+
+    atomic_store_explicit(&m->seq, seq + 2u, memory_order_release);
+}
+
+void audyn_metrics_shm_destroy(audyn_metrics_shm_t *shm)
+{
+    if (!shm) return;
+
+    if (shm->map) {
+        atomic_store_explicit(&shm->map->state, 0u, memory_order_release);
+        munmap(shm->map, shm->map_bytes);
+    }
+    shm_unlink(shm->name);
+
+    LOG_DEBUG("metrics: removed %s", shm->name);
+    free(shm);
+}
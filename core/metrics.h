@@ -0,0 +1,212 @@
+/*
+ *  Audyn — Professional Audio Capture & Archival Engine
+ *
+ *  File:
+ *      metrics.h
+ *
+ *  Purpose:
+ *      Per-stage latency histograms and event counters, published to
+ *      POSIX shared memory (/dev/shm/<name>) for the web backend to
+ *      scrape and render as Prometheus text.
+ *
+ *  Stages:
+ *      - RX_PUSH:     datagram handed to user space -> frame on the audio
+ *                     queue (decode, merge, jitter buffer release)
+ *      - QUEUE_DWELL: frame on the audio queue -> taken by the worker
+ *      - SINK_WRITE:  one sink write call (WAV append, Opus hand-off)
+ *      - ENCODE:      one Opus frame encoded, muxed and written
+ *      - FSYNC:       one fdatasync (or io_uring fsync) on an archive file
+ *      - ROTATION:    worker stall while rotating to the next files
+ *
+ *  Histograms:
+ *      HDR style, log-linear: values below 8 ns have a bucket each, then
+ *      every power of two is split into 8 sub-buckets (relative error
+ *      <= 12.5%) up to 2^40 ns (18 minutes); longer values land in the
+ *      last bucket. Bucket i covers [audyn_metrics_bucket_lower(i),
+ *      audyn_metrics_bucket_lower(i + 1)).
+ *
+ *  Recording:
+ *      Each recording thread claims its own shard on first use and is its
+ *      only writer, so a record is a few relaxed loads and stores on
+ *      thread-private cache lines: no locks, no RMW. Shards are handed
+ *      back at thread exit and reused (counts are cumulative, so a reused
+ *      shard keeps adding). When every shard is taken, threads share an
+ *      overflow shard with atomic adds.
+ *
+ *      With metrics off (no audyn_metrics_init()), audyn_metrics_start()
+ *      returns 0 and every record call returns at once, so instrumented
+ *      paths cost one load and a branch.
+ *
+ *  Layout:
+ *      audyn_metrics_shm_layout_t below, little-endian native, version 1,
+ *      followed by n_stages audyn_metrics_shm_stage_t and n_values
+ *      audyn_metrics_shm_value_t. Names are NUL-padded ASCII. The reader
+ *      protocol (magic written last, seqlock on seq, state 0 on shutdown)
+ *      is the one described in level_shm.h.
+ *
+ *  Threading:
+ *      - init() once; threads record from the moment it returns
+ *      - start()/stage_end()/record()/count() from any thread, real-time safe
+ *      - shm publish() from one thread (the main loop)
+ *
+ *  Dependencies:
+ *      - POSIX shm_open/mmap, pthread keys, C11 atomics
+ *      - Audyn: rt (shard memory), log
+ *
+ *  Copyright:
+ *      (c) 2026 B. Wynne
+ *
+ *  Author:
+ *      B. Wynne
+ *
+ *  License:
+ *      GPLv2 or later
+ */
+
+#ifndef AUDYN_METRICS_H
+#define AUDYN_METRICS_H
+
+#include <stdint.h>
+#include <stdatomic.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum audyn_stage {
+    AUDYN_STAGE_RX_PUSH = 0,
+    AUDYN_STAGE_QUEUE_DWELL,
+    AUDYN_STAGE_SINK_WRITE,
+    AUDYN_STAGE_ENCODE,
+    AUDYN_STAGE_FSYNC,
+    AUDYN_STAGE_ROTATION,
+    AUDYN_STAGE_COUNT
+} audyn_stage_t;
+
+typedef enum audyn_counter {
+    AUDYN_CTR_FRAMES_PUSHED = 0,    /* Input frames put on the audio queue */
+    AUDYN_CTR_DROPS_POOL,           /* Input frames lost: frame pool empty */
+    AUDYN_CTR_DROPS_QUEUE,          /* Input frames lost: audio queue full */
+    AUDYN_CTR_FRAMES_CONSUMED,      /* Frames taken off the queue by workers */
+    AUDYN_CTR_WRITER_STALLS,        /* File writer waited for a free buffer */
+    AUDYN_CTR_ENCODE_DROPS,         /* Sample frames replaced by silence: encoder backlog full */
+    AUDYN_CTR_COUNT
+} audyn_counter_t;
+
+/* Histogram geometry (see Histograms above) */
+#define AUDYN_METRICS_SUB_BITS  3
+#define AUDYN_METRICS_MAX_EXP   40
+#define AUDYN_METRICS_BUCKETS   ((AUDYN_METRICS_MAX_EXP - AUDYN_METRICS_SUB_BITS + 1) << AUDYN_METRICS_SUB_BITS)
+
+/* Recording threads with a private shard (the rest share one) */
+#define AUDYN_METRICS_SHARDS    32
+
+/*
+ * Enable recording. Allocates the shards (pre-faulted, see rt.h).
+ * Returns 0 on success, -1 on error (logged). NOT real-time safe.
+ */
+int audyn_metrics_init(void);
+
+/* 1 once init() has succeeded */
+int audyn_metrics_enabled(void);
+
+/* CLOCK_MONOTONIC in ns, or 0 when metrics are off. */
+uint64_t audyn_metrics_start(void);
+
+/* Record now - start_ns for a stage; no-op when start_ns is 0. */
+void audyn_metrics_stage_end(audyn_stage_t stage, uint64_t start_ns);
+
+/* Record a duration measured by the caller. */
+void audyn_metrics_record(audyn_stage_t stage, uint64_t ns);
+
+/* Add n to a counter. */
+void audyn_metrics_count(audyn_counter_t ctr, uint64_t n);
+
+/* Lower bound (ns) of histogram bucket i; i == AUDYN_METRICS_BUCKETS gives the end. */
+uint64_t audyn_metrics_bucket_lower(uint32_t i);
+
+const char *audyn_metrics_stage_name(audyn_stage_t stage);
+const char *audyn_metrics_counter_name(audyn_counter_t ctr);
+
+/* -------- Shared-memory endpoint -------- */
+
+#define AUDYN_METRICS_SHM_MAGIC     0x544D5941u     /* "AYMT" little-endian */
+#define AUDYN_METRICS_SHM_VERSION   1u
+
+/* Longest accepted endpoint name (same rules as the level feed) */
+#define AUDYN_METRICS_SHM_NAME_MAX  64
+
+/* Stage, counter and value names, NUL-padded */
+#define AUDYN_METRICS_NAME_BYTES    32
+
+/* Most values one publish carries (counters + caller values) */
+#define AUDYN_METRICS_MAX_VALUES    96
+
+/*
+ * Shared header. Offsets are fixed for version 1:
+ *   0 magic, 4 version, 8 header_bytes, 12 pid, 16 state, 20 n_stages,
+ *   24 n_buckets, 28 sub_bits, 32 seq, 40 update_ns, 48 start_ns,
+ *   56 n_values, 60 shards_used
+ */
+typedef struct audyn_metrics_shm_layout {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t header_bytes;              /* sizeof(audyn_metrics_shm_layout_t) */
+    uint32_t pid;                       /* Writer process */
+    _Atomic uint32_t state;             /* 1 = running, 0 = stopped */
+    uint32_t n_stages;                  /* Stage records after the header */
+    uint32_t n_buckets;                 /* Buckets per stage */
+    uint32_t sub_bits;                  /* Sub-buckets per power of two = 2^sub_bits */
+    _Atomic uint64_t seq;               /* Even = stable; seq / 2 = generation */
+    uint64_t update_ns;                 /* CLOCK_MONOTONIC of the last update */
+    uint64_t start_ns;                  /* CLOCK_MONOTONIC when metrics started */
+    uint32_t n_values;                  /* Valid value records */
+    uint32_t shards_used;               /* Shards claimed so far (diagnostic) */
+} audyn_metrics_shm_layout_t;
+
+typedef struct audyn_metrics_shm_stage {
+    char     name[AUDYN_METRICS_NAME_BYTES];
+    uint64_t count;
+    uint64_t sum_ns;
+    uint64_t max_ns;
+    uint64_t buckets[AUDYN_METRICS_BUCKETS];
+} audyn_metrics_shm_stage_t;
+
+typedef struct audyn_metrics_shm_value {
+    char     name[AUDYN_METRICS_NAME_BYTES];
+    uint64_t value;
+} audyn_metrics_shm_value_t;
+
+/* A caller-supplied value for publish() (e.g. a module stats counter) */
+typedef struct audyn_metric_value {
+    const char *name;
+    uint64_t    value;
+} audyn_metric_value_t;
+
+typedef struct audyn_metrics_shm audyn_metrics_shm_t;
+
+/*
+ * Create (or replace) /dev/shm/<name> and map it.
+ * Returns endpoint or NULL on error (logged). NOT real-time safe.
+ */
+audyn_metrics_shm_t *audyn_metrics_shm_create(const char *name);
+
+/*
+ * Sum the shards and publish them with the counters, followed by
+ * n_values caller values (truncated to fit AUDYN_METRICS_MAX_VALUES).
+ */
+void audyn_metrics_shm_publish(audyn_metrics_shm_t *shm,
+                               const audyn_metric_value_t *values,
+                               uint32_t n_values);
+
+/* Check an endpoint name without creating it. Returns 0 if usable, -1 if not. */
+int audyn_metrics_shm_check_name(const char *name);
+
+/* Mark stopped, unmap and unlink (safe with NULL). */
+void audyn_metrics_shm_destroy(audyn_metrics_shm_t *shm);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* AUDYN_METRICS_H */
@@ -0,0 +1,1109 @@
+/*
+ *  Audyn — Professional Audio Capture & Archival Engine
+ *
+ *  File:
+ *      pcm_convert.c
+ *
+ *  Purpose:
+ *      Big-endian L16/L24 PCM to interleaved float decode kernels, float
+ *      to little-endian PCM encode kernels, the L24 passthrough and
+ *      little-endian host PCM to float unpack kernels.
+ *
+ *      See pcm_convert.h for kernel families and selection rules.
+ *
+ *  Implementation notes:
+ *      - SIMD kernels place the sample in the top bits of an int32
+ *        (L16: s << 16, L24: s << 8), convert to float and scale by 2^-31.
+ *        This equals s / 32768 (or s / 8388608) exactly.
+ *      - x86 kernels use per-function target attributes and are selected
+ *        with __builtin_cpu_supports(), so a baseline build still uses
+ *        AVX2 where present.
+ *      - Vector loops never read past the last byte of the payload; the
+ *        final samples are finished by the scalar loop.
+ *
+ *  Copyright:
+ *      (c) 2026 B. Wynne
+ *
+ *  Author:
+ *      B. Wynne
+ *
+ *  License:
+ *      GPLv2 or later
+ */
+
+#include "pcm_convert.h"
+
+#include <stddef.h>
+#include <string.h>
+
+#if !defined(AUDYN_PCM_NO_SIMD) && (defined(__x86_64__) || defined(__i386__)) && \
+    (defined(__GNUC__) || defined(__clang__))
+#define PCM_HAVE_X86 1
+#include <immintrin.h>
+#endif
+
+#if !defined(AUDYN_PCM_NO_SIMD) && (defined(__ARM_NEON) || defined(__ARM_NEON__))
+#define PCM_HAVE_NEON 1
+#include <arm_neon.h>
+#endif
+
+/* -------- Scalar helpers -------- */
+
+#define PCM_SCALE_16  (1.0f / 32768.0f)
+#define PCM_SCALE_24  (1.0f / 8388608.0f)
+#define PCM_SCALE_TOP (1.0f / 2147483648.0f)
+
+static inline float be16_to_f32(const uint8_t *p) {
+    int16_t s = (int16_t)(((uint16_t)p[0] << 8) | (uint16_t)p[1]);
+    return (float)s * PCM_SCALE_16;
+}
+
+static inline float be24_to_f32(const uint8_t *p) {
+    /* 24-bit big-endian signed -> sign-extended int32 */
+    int32_t v = ((int32_t)p[0] << 16) | ((int32_t)p[1] << 8) | (int32_t)p[2];
+    if (v & 0x00800000) v |= (int32_t)0xFF000000;
+    return (float)v * PCM_SCALE_24;
+}
+
+/* -------- Scalar kernels -------- */
+
+static void l16_contig_scalar(const audyn_pcm_decoder_t *dec, const uint8_t *src,
+                              float *dst, uint32_t frames)
+{
+    const size_t n = (size_t)frames * dec->out_channels;
+    for (size_t i = 0; i < n; i++) {
+        dst[i] = be16_to_f32(src + 2 * i);
+    }
+}
+
+static void l24_contig_scalar(const audyn_pcm_decoder_t *dec, const uint8_t *src,
+                              float *dst, uint32_t frames)
+{
+    const size_t n = (size_t)frames * dec->out_channels;
+    for (size_t i = 0; i < n; i++) {
+        dst[i] = be24_to_f32(src + 3 * i);
+    }
+}
+
+static void l16_pair_scalar(const audyn_pcm_decoder_t *dec, const uint8_t *src,
+                            float *dst, uint32_t frames)
+{
+    const size_t stride = dec->stride_bytes;
+    const uint8_t *p = src + (size_t)dec->channel_offset * 2;
+    for (uint32_t f = 0; f < frames; f++, p += stride, dst += 2) {
+        dst[0] = be16_to_f32(p);
+        dst[1] = be16_to_f32(p + 2);
+    }
+}
+
+static void l24_pair_scalar(const audyn_pcm_decoder_t *dec, const uint8_t *src,
+                            float *dst, uint32_t frames)
+{
+    const size_t stride = dec->stride_bytes;
+    const uint8_t *p = src + (size_t)dec->channel_offset * 3;
+    for (uint32_t f = 0; f < frames; f++, p += stride, dst += 2) {
+        dst[0] = be24_to_f32(p);
+        dst[1] = be24_to_f32(p + 3);
+    }
+}
+
+static void l16_stride_scalar(const audyn_pcm_decoder_t *dec, const uint8_t *src,
+                              float *dst, uint32_t frames)
+{
+    const size_t stride = dec->stride_bytes;
+    const uint32_t out_ch = dec->out_channels;
+    const uint8_t *p = src + (size_t)dec->channel_offset * 2;
+    for (uint32_t f = 0; f < frames; f++, p += stride, dst += out_ch) {
+        for (uint32_t c = 0; c < out_ch; c++) {
+            dst[c] = be16_to_f32(p + 2 * c);
+        }
+    }
+}
+
+static void l24_stride_scalar(const audyn_pcm_decoder_t *dec, const uint8_t *src,
+                              float *dst, uint32_t frames)
+{
+    const size_t stride = dec->stride_bytes;
+    const uint32_t out_ch = dec->out_channels;
+    const uint8_t *p = src + (size_t)dec->channel_offset * 3;
+    for (uint32_t f = 0; f < frames; f++, p += stride, dst += out_ch) {
+        for (uint32_t c = 0; c < out_ch; c++) {
+            dst[c] = be24_to_f32(p + 3 * c);
+        }
+    }
+}
+
+/* -------- x86 kernels -------- */
+
+#ifdef PCM_HAVE_X86
+
+__attribute__((target("sse4.1")))
+static void l16_contig_sse4(const audyn_pcm_decoder_t *dec, const uint8_t *src,
+                            float *dst, uint32_t frames)
+{
+    const size_t n = (size_t)frames * dec->out_channels;
+    const __m128i swap = _mm_setr_epi8(1, 0, 3, 2, 5, 4, 7, 6,
+                                       9, 8, 11, 10, 13, 12, 15, 14);
+    const __m128 scale = _mm_set1_ps(PCM_SCALE_16);
+    size_t i = 0;
+
+    for (; i + 8 <= n; i += 8) {
+        __m128i v = _mm_loadu_si128((const __m128i *)(src + 2 * i));
+        v = _mm_shuffle_epi8(v, swap);
+        __m128i lo = _mm_cvtepi16_epi32(v);
+        __m128i hi = _mm_cvtepi16_epi32(_mm_srli_si128(v, 8));
+        _mm_storeu_ps(dst + i,     _mm_mul_ps(_mm_cvtepi32_ps(lo), scale));
+        _mm_storeu_ps(dst + i + 4, _mm_mul_ps(_mm_cvtepi32_ps(hi), scale));
+    }
+    for (; i < n; i++) {
+        dst[i] = be16_to_f32(src + 2 * i);
+    }
+}
+
+__attribute__((target("sse4.1")))
+static void l24_contig_sse4(const audyn_pcm_decoder_t *dec, const uint8_t *src,
+                            float *dst, uint32_t frames)
+{
+    const size_t n = (size_t)frames * dec->out_channels;
+    /* 4 samples from 12 bytes: {0, b2, b1, b0} per lane -> s << 8 */
+    const __m128i shuf = _mm_setr_epi8(-1, 2, 1, 0, -1, 5, 4, 3,
+                                       -1, 8, 7, 6, -1, 11, 10, 9);
+    const __m128 scale = _mm_set1_ps(PCM_SCALE_TOP);
+    size_t i = 0;
+
+    /* 16-byte loads: need 4 bytes beyond the 12 consumed */
+    for (; 3 * i + 28 <= 3 * n; i += 8) {
+        __m128i a = _mm_loadu_si128((const __m128i *)(src + 3 * i));
+        __m128i b = _mm_loadu_si128((const __m128i *)(src + 3 * i + 12));
+        a = _mm_shuffle_epi8(a, shuf);
+        b = _mm_shuffle_epi8(b, shuf);
+        _mm_storeu_ps(dst + i,     _mm_mul_ps(_mm_cvtepi32_ps(a), scale));
+        _mm_storeu_ps(dst + i + 4, _mm_mul_ps(_mm_cvtepi32_ps(b), scale));
+    }
+    for (; i < n; i++) {
+        dst[i] = be24_to_f32(src + 3 * i);
+    }
+}
+
+__attribute__((target("avx2")))
+static void l16_contig_avx2(const audyn_pcm_decoder_t *dec, const uint8_t *src,
+                            float *dst, uint32_t frames)
+{
+    const size_t n = (size_t)frames * dec->out_channels;
+    const __m256i swap = _mm256_setr_epi8(1, 0, 3, 2, 5, 4, 7, 6,
+                                          9, 8, 11, 10, 13, 12, 15, 14,
+                                          1, 0, 3, 2, 5, 4, 7, 6,
+                                          9, 8, 11, 10, 13, 12, 15, 14);
+    const __m256 scale = _mm256_set1_ps(PCM_SCALE_16);
+    size_t i = 0;
+
+    for (; i + 16 <= n; i += 16) {
+        __m256i v = _mm256_loadu_si256((const __m256i *)(src + 2 * i));
+        v = _mm256_shuffle_epi8(v, swap);
+        __m256i lo = _mm256_cvtepi16_epi32(_mm256_castsi256_si128(v));
+        __m256i hi = _mm256_cvtepi16_epi32(_mm256_extracti128_si256(v, 1));
+        _mm256_storeu_ps(dst + i,     _mm256_mul_ps(_mm256_cvtepi32_ps(lo), scale));
+        _mm256_storeu_ps(dst + i + 8, _mm256_mul_ps(_mm256_cvtepi32_ps(hi), scale));
+    }
+    for (; i < n; i++) {
+        dst[i] = be16_to_f32(src + 2 * i);
+    }
+}
+
+__attribute__((target("avx2")))
+static void l24_contig_avx2(const audyn_pcm_decoder_t *dec, const uint8_t *src,
+                            float *dst, uint32_t frames)
+{
+    const size_t n = (size_t)frames * dec->out_channels;
+    const __m256i shuf = _mm256_setr_epi8(-1, 2, 1, 0, -1, 5, 4, 3,
+                                          -1, 8, 7, 6, -1, 11, 10, 9,
+                                          -1, 2, 1, 0, -1, 5, 4, 3,
+                                          -1, 8, 7, 6, -1, 11, 10, 9);
+    const __m256 scale = _mm256_set1_ps(PCM_SCALE_TOP);
+    size_t i = 0;
+
+    /* 8 samples per 24 bytes; upper half loads 16 bytes at +12 */
+    for (; 3 * i + 28 <= 3 * n; i += 8) {
+        __m128i a = _mm_loadu_si128((const __m128i *)(src + 3 * i));
+        __m128i b = _mm_loadu_si128((const __m128i *)(src + 3 * i + 12));
+        __m256i v = _mm256_inserti128_si256(_mm256_castsi128_si256(a), b, 1);
+        v = _mm256_shuffle_epi8(v, shuf);
+        _mm256_storeu_ps(dst + i, _mm256_mul_ps(_mm256_cvtepi32_ps(v), scale));
+    }
+    for (; i < n; i++) {
+        dst[i] = be24_to_f32(src + 3 * i);
+    }
+}
+
+/*
+ * Strided selection via 32-bit gathers: 8 output samples per step, for
+ * out_channels dividing 8. Each gather reads 4 bytes from the sample start,
+ * so the last stream frame is always left to the scalar tail.
+ */
+__attribute__((target("avx2")))
+static void stride_gather_avx2(const audyn_pcm_decoder_t *dec, const uint8_t *src,
+                               float *dst, uint32_t frames, __m256i shuf,
+                               audyn_pcm_decode_fn tail)
+{
+    const uint32_t out_ch = dec->out_channels;
+    const uint32_t bps = dec->bytes_per_sample;
+    const uint32_t stride = dec->stride_bytes;
+    const uint32_t fpv = 8 / out_ch;            /* Stream frames per vector */
+    const __m256 scale = _mm256_set1_ps(PCM_SCALE_TOP);
+
+    int32_t base[8];
+    for (uint32_t k = 0; k < 8; k++) {
+        base[k] = (int32_t)((k / out_ch) * stride + (dec->channel_offset + k % out_ch) * bps);
+    }
+    __m256i idx = _mm256_loadu_si256((const __m256i *)base);
+    const __m256i step = _mm256_set1_epi32((int32_t)(fpv * stride));
+
+    uint32_t f = 0;
+    for (; f + fpv < frames; f += fpv) {
+        __m256i v = _mm256_i32gather_epi32((const int *)src, idx, 1);
+        v = _mm256_shuffle_epi8(v, shuf);
+        _mm256_storeu_ps(dst + (size_t)f * out_ch,
+                         _mm256_mul_ps(_mm256_cvtepi32_ps(v), scale));
+        idx = _mm256_add_epi32(idx, step);
+    }
+
+    if (f < frames) {
+        tail(dec, src + (size_t)f * stride, dst + (size_t)f * out_ch, frames - f);
+    }
+}
+
+__attribute__((target("avx2")))
+static void l16_stride_avx2(const audyn_pcm_decoder_t *dec, const uint8_t *src,
+                            float *dst, uint32_t frames)
+{
+    /* {0, 0, b1, b0} per lane -> s << 16 */
+    const __m256i shuf = _mm256_setr_epi8(-1, -1, 1, 0, -1, -1, 5, 4,
+                                          -1, -1, 9, 8, -1, -1, 13, 12,
+                                          -1, -1, 1, 0, -1, -1, 5, 4,
+                                          -1, -1, 9, 8, -1, -1, 13, 12);
+    stride_gather_avx2(dec, src, dst, frames, shuf, l16_stride_scalar);
+}
+
+__attribute__((target("avx2")))
+static void l24_stride_avx2(const audyn_pcm_decoder_t *dec, const uint8_t *src,
+                            float *dst, uint32_t frames)
+{
+    /* {0, b2, b1, b0} per lane -> s << 8 */
+    const __m256i shuf = _mm256_setr_epi8(-1, 2, 1, 0, -1, 6, 5, 4,
+                                          -1, 10, 9, 8, -1, 14, 13, 12,
+                                          -1, 2, 1, 0, -1, 6, 5, 4,
+                                          -1, 10, 9, 8, -1, 14, 13, 12);
+    stride_gather_avx2(dec, src, dst, frames, shuf, l24_stride_scalar);
+}
+
+#endif /* PCM_HAVE_X86 */
+
+/* -------- NEON kernels -------- */
+
+#ifdef PCM_HAVE_NEON
+
+static void l16_contig_neon(const audyn_pcm_decoder_t *dec, const uint8_t *src,
+                            float *dst, uint32_t frames)
+{
+    const size_t n = (size_t)frames * dec->out_channels;
+    size_t i = 0;
+
+    for (; i + 8 <= n; i += 8) {
+        uint8x16_t b = vld1q_u8(src + 2 * i);
+        int16x8_t s = vreinterpretq_s16_u8(vrev16q_u8(b));
+        float32x4_t lo = vcvtq_f32_s32(vmovl_s16(vget_low_s16(s)));
+        float32x4_t hi = vcvtq_f32_s32(vmovl_s16(vget_high_s16(s)));
+        vst1q_f32(dst + i,     vmulq_n_f32(lo, PCM_SCALE_16));
+        vst1q_f32(dst + i + 4, vmulq_n_f32(hi, PCM_SCALE_16));
+    }
+    for (; i < n; i++) {
+        dst[i] = be16_to_f32(src + 2 * i);
+    }
+}
+
+static void l24_contig_neon(const audyn_pcm_decoder_t *dec, const uint8_t *src,
+                            float *dst, uint32_t frames)
+{
+    const size_t n = (size_t)frames * dec->out_channels;
+    size_t i = 0;
+
+    for (; i + 8 <= n; i += 8) {
+        /* De-interleave 8 samples into MSB / mid / LSB byte planes */
+        uint8x8x3_t b = vld3_u8(src + 3 * i);
+        int16x8_t  msb = vmovl_s8(vreinterpret_s8_u8(b.val[0]));
+        uint16x8_t low = vorrq_u16(vshll_n_u8(b.val[1], 8), vmovl_u8(b.val[2]));
+
+        int32x4_t lo = vorrq_s32(vshlq_n_s32(vmovl_s16(vget_low_s16(msb)), 16),
+                                 vreinterpretq_s32_u32(vmovl_u16(vget_low_u16(low))));
+        int32x4_t hi = vorrq_s32(vshlq_n_s32(vmovl_s16(vget_high_s16(msb)), 16),
+                                 vreinterpretq_s32_u32(vmovl_u16(vget_high_u16(low))));
+
+        vst1q_f32(dst + i,     vmulq_n_f32(vcvtq_f32_s32(lo), PCM_SCALE_24));
+        vst1q_f32(dst + i + 4, vmulq_n_f32(vcvtq_f32_s32(hi), PCM_SCALE_24));
+    }
+    for (; i < n; i++) {
+        dst[i] = be24_to_f32(src + 3 * i);
+    }
+}
+
+#endif /* PCM_HAVE_NEON */
+
+/* -------- L24 passthrough kernels -------- */
+
+static inline void be24_to_le24(const uint8_t *s, uint8_t *d)
+{
+    d[0] = s[2];
+    d[1] = s[1];
+    d[2] = s[0];
+}
+
+static void x24_contig_scalar(const audyn_pcm_decoder_t *dec, const uint8_t *src,
+                              uint8_t *dst, uint32_t frames)
+{
+    const size_t n = (size_t)frames * dec->out_channels;
+    for (size_t i = 0; i < n; i++) {
+        be24_to_le24(src + 3 * i, dst + 3 * i);
+    }
+}
+
+static void x24_stride_scalar(const audyn_pcm_decoder_t *dec, const uint8_t *src,
+                              uint8_t *dst, uint32_t frames)
+{
+    const uint32_t out_ch = dec->out_channels;
+    const uint8_t *p = src + (size_t)dec->channel_offset * 3U;
+    for (uint32_t i = 0; i < frames; i++) {
+        for (uint32_t c = 0; c < out_ch; c++) {
+            be24_to_le24(p + 3U * c, dst);
+            dst += 3;
+        }
+        p += dec->stride_bytes;
+    }
+}
+
+#ifdef PCM_HAVE_X86
+
+__attribute__((target("sse4.1")))
+static void x24_contig_sse4(const audyn_pcm_decoder_t *dec, const uint8_t *src,
+                            uint8_t *dst, uint32_t frames)
+{
+    const size_t n = (size_t)frames * dec->out_channels;
+    /* Reverse each of the first four 3-byte samples; bytes 12-15 are junk
+     * and are overwritten by the next store */
+    const __m128i rev = _mm_setr_epi8(2, 1, 0, 5, 4, 3, 8, 7,
+                                      6, 11, 10, 9, -1, -1, -1, -1);
+    size_t i = 0;
+
+    for (; 3 * i + 16 <= 3 * n; i += 4) {
+        __m128i v = _mm_loadu_si128((const __m128i *)(src + 3 * i));
+        _mm_storeu_si128((__m128i *)(dst + 3 * i), _mm_shuffle_epi8(v, rev));
+    }
+    for (; i < n; i++) {
+        be24_to_le24(src + 3 * i, dst + 3 * i);
+    }
+}
+
+#endif /* PCM_HAVE_X86 */
+
+#ifdef PCM_HAVE_NEON
+
+static void x24_contig_neon(const audyn_pcm_decoder_t *dec, const uint8_t *src,
+                            uint8_t *dst, uint32_t frames)
+{
+    const size_t n = (size_t)frames * dec->out_channels;
+    size_t i = 0;
+
+    for (; i + 8 <= n; i += 8) {
+        uint8x8x3_t b = vld3_u8(src + 3 * i);
+        uint8x8x3_t r;
+        r.val[0] = b.val[2];
+        r.val[1] = b.val[1];
+        r.val[2] = b.val[0];
+        vst3_u8(dst + 3 * i, r);
+    }
+    for (; i < n; i++) {
+        be24_to_le24(src + 3 * i, dst + 3 * i);
+    }
+}
+
+#endif /* PCM_HAVE_NEON */
+
+/* -------- Encode kernels -------- */
+
+#define PCM_ENC_16   32767.0f
+#define PCM_ENC_24   8388608.0f
+#define PCM_S24_MAX  8388607
+
+static inline int16_t f32_to_s16(float x)
+{
+    if (x > 1.0f) x = 1.0f;
+    if (x < -1.0f) x = -1.0f;
+
+    /* Use 32767 scaling so +1.0 maps to INT16_MAX (no integer clamp needed) */
+    return (int16_t)(x * PCM_ENC_16);
+}
+
+static inline int32_t f32_to_s24(float x)
+{
+    if (x > 1.0f) x = 1.0f;
+    if (x < -1.0f) x = -1.0f;
+    int32_t v = (int32_t)(x * PCM_ENC_24);
+    if (v > PCM_S24_MAX) v = PCM_S24_MAX;
+    return v;
+}
+
+static inline void put_s24le(uint8_t *d, int32_t v)
+{
+    d[0] = (uint8_t)(v & 0xFF);
+    d[1] = (uint8_t)((v >> 8) & 0xFF);
+    d[2] = (uint8_t)((v >> 16) & 0xFF);
+}
+
+/* Scalar encoders store whole host-order words (little-endian hosts, as
+ * f32_encode_copy): byte-wise stores keep the compiler from vectorising. */
+static void s16_encode_scalar(const float *src, uint8_t *dst, size_t n)
+{
+    for (size_t i = 0; i < n; i++) {
+        const int16_t v = f32_to_s16(src[i]);
+        memcpy(dst + 2 * i, &v, sizeof(v));
+    }
+}
+
+static void s24_encode_scalar(const float *src, uint8_t *dst, size_t n)
+{
+    if (n == 0) return;
+
+    /* Each 4-byte store's top byte is overwritten by the next sample */
+    for (size_t i = 0; i + 1 < n; i++) {
+        const int32_t v = f32_to_s24(src[i]);
+        memcpy(dst + 3 * i, &v, sizeof(v));
+    }
+    put_s24le(dst + 3 * (n - 1), f32_to_s24(src[n - 1]));
+}
+
+static void f32_encode_copy(const float *src, uint8_t *dst, size_t n)
+{
+    /* Little-endian hosts only (as the rest of the file writers) */
+    memcpy(dst, src, n * sizeof(float));
+}
+
+#ifdef PCM_HAVE_X86
+
+/*
+ * Clamp order matters for NaN: min/max return their second operand when
+ * either is NaN, so NaN propagates to cvtt (-> INT_MIN) exactly like the
+ * scalar (int) cast on x86.
+ */
+
+__attribute__((target("sse4.1")))
+static inline __m128i enc_s24_sse4(__m128 x)
+{
+    x = _mm_max_ps(_mm_set1_ps(-1.0f), _mm_min_ps(_mm_set1_ps(1.0f), x));
+    __m128i v = _mm_cvttps_epi32(_mm_mul_ps(x, _mm_set1_ps(PCM_ENC_24)));
+    /* Lanes are packed to 3 bytes next */
+    return _mm_min_epi32(v, _mm_set1_epi32(PCM_S24_MAX));
+}
+
+/* Pack 16 int32 lanes (low 24 bits each) into 48 contiguous bytes */
+__attribute__((target("sse4.1")))
+static inline void store_s24x16_sse4(uint8_t *d, __m128i a, __m128i b, __m128i c, __m128i e)
+{
+    const __m128i pk = _mm_setr_epi8(0, 1, 2, 4, 5, 6, 8, 9,
+                                     10, 12, 13, 14, -1, -1, -1, -1);
+    a = _mm_shuffle_epi8(a, pk);
+    b = _mm_shuffle_epi8(b, pk);
+    c = _mm_shuffle_epi8(c, pk);
+    e = _mm_shuffle_epi8(e, pk);
+    _mm_storeu_si128((__m128i *)(d),      _mm_or_si128(a, _mm_slli_si128(b, 12)));
+    _mm_storeu_si128((__m128i *)(d + 16), _mm_or_si128(_mm_srli_si128(b, 4), _mm_slli_si128(c, 8)));
+    _mm_storeu_si128((__m128i *)(d + 32), _mm_or_si128(_mm_srli_si128(c, 8), _mm_slli_si128(e, 4)));
+}
+
+__attribute__((target("sse4.1")))
+static void s16_encode_sse4(const float *src, uint8_t *dst, size_t n)
+{
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128 neg = _mm_set1_ps(-1.0f);
+    const __m128 scale = _mm_set1_ps(PCM_ENC_16);
+    size_t i = 0;
+
+    for (; i + 8 <= n; i += 8) {
+        __m128 a = _mm_max_ps(neg, _mm_min_ps(one, _mm_loadu_ps(src + i)));
+        __m128 b = _mm_max_ps(neg, _mm_min_ps(one, _mm_loadu_ps(src + i + 4)));
+        __m128i ia = _mm_cvttps_epi32(_mm_mul_ps(a, scale));
+        __m128i ib = _mm_cvttps_epi32(_mm_mul_ps(b, scale));
+        _mm_storeu_si128((__m128i *)(dst + 2 * i), _mm_packs_epi32(ia, ib));
+    }
+    s16_encode_scalar(src + i, dst + 2 * i, n - i);
+}
+
+__attribute__((target("sse4.1")))
+static void s24_encode_sse4(const float *src, uint8_t *dst, size_t n)
+{
+    size_t i = 0;
+
+    for (; i + 16 <= n; i += 16) {
+        store_s24x16_sse4(dst + 3 * i,
+                          enc_s24_sse4(_mm_loadu_ps(src + i)),
+                          enc_s24_sse4(_mm_loadu_ps(src + i + 4)),
+                          enc_s24_sse4(_mm_loadu_ps(src + i + 8)),
+                          enc_s24_sse4(_mm_loadu_ps(src + i + 12)));
+    }
+    s24_encode_scalar(src + i, dst + 3 * i, n - i);
+}
+
+__attribute__((target("avx2")))
+static void s16_encode_avx2(const float *src, uint8_t *dst, size_t n)
+{
+    const __m256 one = _mm256_set1_ps(1.0f);
+    const __m256 neg = _mm256_set1_ps(-1.0f);
+    const __m256 scale = _mm256_set1_ps(PCM_ENC_16);
+    size_t i = 0;
+
+    for (; i + 16 <= n; i += 16) {
+        __m256 a = _mm256_max_ps(neg, _mm256_min_ps(one, _mm256_loadu_ps(src + i)));
+        __m256 b = _mm256_max_ps(neg, _mm256_min_ps(one, _mm256_loadu_ps(src + i + 8)));
+        __m256i ia = _mm256_cvttps_epi32(_mm256_mul_ps(a, scale));
+        __m256i ib = _mm256_cvttps_epi32(_mm256_mul_ps(b, scale));
+        /* packs works per 128-bit lane: restore sample order */
+        __m256i p = _mm256_permute4x64_epi64(_mm256_packs_epi32(ia, ib), 0xD8);
+        _mm256_storeu_si256((__m256i *)(dst + 2 * i), p);
+    }
+    s16_encode_sse4(src + i, dst + 2 * i, n - i);
+}
+
+__attribute__((target("avx2")))
+static void s24_encode_avx2(const float *src, uint8_t *dst, size_t n)
+{
+    const __m256 one = _mm256_set1_ps(1.0f);
+    const __m256 neg = _mm256_set1_ps(-1.0f);
+    const __m256 scale = _mm256_set1_ps(PCM_ENC_24);
+    const __m256i smax = _mm256_set1_epi32(PCM_S24_MAX);
+    size_t i = 0;
+
+    for (; i + 16 <= n; i += 16) {
+        __m256 a = _mm256_max_ps(neg, _mm256_min_ps(one, _mm256_loadu_ps(src + i)));
+        __m256 b = _mm256_max_ps(neg, _mm256_min_ps(one, _mm256_loadu_ps(src + i + 8)));
+        __m256i ia = _mm256_min_epi32(_mm256_cvttps_epi32(_mm256_mul_ps(a, scale)), smax);
+        __m256i ib = _mm256_min_epi32(_mm256_cvttps_epi32(_mm256_mul_ps(b, scale)), smax);
+        store_s24x16_sse4(dst + 3 * i,
+                          _mm256_castsi256_si128(ia), _mm256_extracti128_si256(ia, 1),
+                          _mm256_castsi256_si128(ib), _mm256_extracti128_si256(ib, 1));
+    }
+    s24_encode_scalar(src + i, dst + 3 * i, n - i);
+}
+
+#endif /* PCM_HAVE_X86 */
+
+#ifdef PCM_HAVE_NEON
+
+static void s16_encode_neon(const float *src, uint8_t *dst, size_t n)
+{
+    size_t i = 0;
+
+    for (; i + 8 <= n; i += 8) {
+        float32x4_t a = vmaxq_f32(vminq_f32(vld1q_f32(src + i), vdupq_n_f32(1.0f)), vdupq_n_f32(-1.0f));
+        float32x4_t b = vmaxq_f32(vminq_f32(vld1q_f32(src + i + 4), vdupq_n_f32(1.0f)), vdupq_n_f32(-1.0f));
+        int16x8_t v = vcombine_s16(vqmovn_s32(vcvtq_s32_f32(vmulq_n_f32(a, PCM_ENC_16))),
+                                   vqmovn_s32(vcvtq_s32_f32(vmulq_n_f32(b, PCM_ENC_16))));
+        vst1q_u8(dst + 2 * i, vreinterpretq_u8_s16(v));
+    }
+    s16_encode_scalar(src + i, dst + 2 * i, n - i);
+}
+
+static void s24_encode_neon(const float *src, uint8_t *dst, size_t n)
+{
+    const int32x4_t smax = vdupq_n_s32(PCM_S24_MAX);
+    size_t i = 0;
+
+    for (; i + 8 <= n; i += 8) {
+        float32x4_t a = vmaxq_f32(vminq_f32(vld1q_f32(src + i), vdupq_n_f32(1.0f)), vdupq_n_f32(-1.0f));
+        float32x4_t b = vmaxq_f32(vminq_f32(vld1q_f32(src + i + 4), vdupq_n_f32(1.0f)), vdupq_n_f32(-1.0f));
+        uint32x4_t ua = vreinterpretq_u32_s32(vminq_s32(vcvtq_s32_f32(vmulq_n_f32(a, PCM_ENC_24)), smax));
+        uint32x4_t ub = vreinterpretq_u32_s32(vminq_s32(vcvtq_s32_f32(vmulq_n_f32(b, PCM_ENC_24)), smax));
+
+        /* Byte planes (LSB, mid, MSB) for 8 samples, interleaved by vst3 */
+        uint8x8x3_t r;
+        r.val[0] = vmovn_u16(vcombine_u16(vmovn_u32(ua), vmovn_u32(ub)));
+        r.val[1] = vmovn_u16(vcombine_u16(vmovn_u32(vshrq_n_u32(ua, 8)), vmovn_u32(vshrq_n_u32(ub, 8))));
+        r.val[2] = vmovn_u16(vcombine_u16(vmovn_u32(vshrq_n_u32(ua, 16)), vmovn_u32(vshrq_n_u32(ub, 16))));
+        vst3_u8(dst + 3 * i, r);
+    }
+    s24_encode_scalar(src + i, dst + 3 * i, n - i);
+}
+
+#endif /* PCM_HAVE_NEON */
+
+/* -------- Unpack kernels (host PCM -> float) -------- */
+
+static inline int32_t rd_le32(const uint8_t *p)
+{
+    uint32_t v;
+    memcpy(&v, p, 4);               /* Hosts are little-endian (x86, ARM) */
+    return (int32_t)v;
+}
+
+static void s16_unpack_scalar(const uint8_t *src, float *dst, size_t n)
+{
+    for (size_t i = 0; i < n; i++) {
+        int16_t s = (int16_t)((uint16_t)src[2 * i] | ((uint16_t)src[2 * i + 1] << 8));
+        dst[i] = (float)s * PCM_SCALE_16;
+    }
+}
+
+static void s24_unpack_scalar(const uint8_t *src, float *dst, size_t n)
+{
+    for (size_t i = 0; i < n; i++) {
+        const uint8_t *p = src + 3 * i;
+        int32_t v = (int32_t)p[0] | ((int32_t)p[1] << 8) | ((int32_t)p[2] << 16);
+        if (v & 0x00800000) v |= (int32_t)0xFF000000;
+        dst[i] = (float)v * PCM_SCALE_24;
+    }
+}
+
+/* Low 24 bits carry the sample; the top byte is ignored, not trusted */
+static void s24_32_unpack_scalar(const uint8_t *src, float *dst, size_t n)
+{
+    for (size_t i = 0; i < n; i++) {
+        int32_t v = (int32_t)((uint32_t)rd_le32(src + 4 * i) << 8);
+        dst[i] = (float)v * PCM_SCALE_TOP;
+    }
+}
+
+/* 32-bit samples round to float's 24-bit mantissa (nearest, like cvtdq2ps) */
+static void s32_unpack_scalar(const uint8_t *src, float *dst, size_t n)
+{
+    for (size_t i = 0; i < n; i++) {
+        dst[i] = (float)rd_le32(src + 4 * i) * PCM_SCALE_TOP;
+    }
+}
+
+static void f32_unpack_copy(const uint8_t *src, float *dst, size_t n)
+{
+    memcpy(dst, src, n * sizeof(float));
+}
+
+#ifdef PCM_HAVE_X86
+
+__attribute__((target("sse4.1")))
+static void s16_unpack_sse4(const uint8_t *src, float *dst, size_t n)
+{
+    const __m128 scale = _mm_set1_ps(PCM_SCALE_16);
+    size_t i = 0;
+
+    for (; i + 8 <= n; i += 8) {
+        __m128i v = _mm_loadu_si128((const __m128i *)(src + 2 * i));
+        __m128i lo = _mm_cvtepi16_epi32(v);
+        __m128i hi = _mm_cvtepi16_epi32(_mm_srli_si128(v, 8));
+        _mm_storeu_ps(dst + i,     _mm_mul_ps(_mm_cvtepi32_ps(lo), scale));
+        _mm_storeu_ps(dst + i + 4, _mm_mul_ps(_mm_cvtepi32_ps(hi), scale));
+    }
+    s16_unpack_scalar(src + 2 * i, dst + i, n - i);
+}
+
+__attribute__((target("sse4.1")))
+static void s24_unpack_sse4(const uint8_t *src, float *dst, size_t n)
+{
+    /* 4 samples from 12 bytes: {0, b0, b1, b2} per lane -> s << 8 */
+    const __m128i shuf = _mm_setr_epi8(-1, 0, 1, 2, -1, 3, 4, 5,
+                                       -1, 6, 7, 8, -1, 9, 10, 11);
+    const __m128 scale = _mm_set1_ps(PCM_SCALE_TOP);
+    size_t i = 0;
+
+    /* 16-byte loads: need 4 bytes beyond the 12 consumed */
+    for (; 3 * i + 28 <= 3 * n; i += 8) {
+        __m128i a = _mm_loadu_si128((const __m128i *)(src + 3 * i));
+        __m128i b = _mm_loadu_si128((const __m128i *)(src + 3 * i + 12));
+        a = _mm_shuffle_epi8(a, shuf);
+        b = _mm_shuffle_epi8(b, shuf);
+        _mm_storeu_ps(dst + i,     _mm_mul_ps(_mm_cvtepi32_ps(a), scale));
+        _mm_storeu_ps(dst + i + 4, _mm_mul_ps(_mm_cvtepi32_ps(b), scale));
+    }
+    s24_unpack_scalar(src + 3 * i, dst + i, n - i);
+}
+
+__attribute__((target("sse4.1")))
+static void s24_32_unpack_sse4(const uint8_t *src, float *dst, size_t n)
+{
+    const __m128 scale = _mm_set1_ps(PCM_SCALE_TOP);
+    size_t i = 0;
+
+    for (; i + 4 <= n; i += 4) {
+        __m128i v = _mm_slli_epi32(_mm_loadu_si128((const __m128i *)(src + 4 * i)), 8);
+        _mm_storeu_ps(dst + i, _mm_mul_ps(_mm_cvtepi32_ps(v), scale));
+    }
+    s24_32_unpack_scalar(src + 4 * i, dst + i, n - i);
+}
+
+__attribute__((target("sse4.1")))
+static void s32_unpack_sse4(const uint8_t *src, float *dst, size_t n)
+{
+    const __m128 scale = _mm_set1_ps(PCM_SCALE_TOP);
+    size_t i = 0;
+
+    for (; i + 4 <= n; i += 4) {
+        __m128i v = _mm_loadu_si128((const __m128i *)(src + 4 * i));
+        _mm_storeu_ps(dst + i, _mm_mul_ps(_mm_cvtepi32_ps(v), scale));
+    }
+    s32_unpack_scalar(src + 4 * i, dst + i, n - i);
+}
+
+__attribute__((target("avx2")))
+static void s16_unpack_avx2(const uint8_t *src, float *dst, size_t n)
+{
+    const __m256 scale = _mm256_set1_ps(PCM_SCALE_16);
+    size_t i = 0;
+
+    for (; i + 16 <= n; i += 16) {
+        __m256i v = _mm256_loadu_si256((const __m256i *)(src + 2 * i));
+        __m256i lo = _mm256_cvtepi16_epi32(_mm256_castsi256_si128(v));
+        __m256i hi = _mm256_cvtepi16_epi32(_mm256_extracti128_si256(v, 1));
+        _mm256_storeu_ps(dst + i,     _mm256_mul_ps(_mm256_cvtepi32_ps(lo), scale));
+        _mm256_storeu_ps(dst + i + 8, _mm256_mul_ps(_mm256_cvtepi32_ps(hi), scale));
+    }
+    s16_unpack_scalar(src + 2 * i, dst + i, n - i);
+}
+
+__attribute__((target("avx2")))
+static void s24_32_unpack_avx2(const uint8_t *src, float *dst, size_t n)
+{
+    const __m256 scale = _mm256_set1_ps(PCM_SCALE_TOP);
+    size_t i = 0;
+
+    for (; i + 8 <= n; i += 8) {
+        __m256i v = _mm256_slli_epi32(_mm256_loadu_si256((const __m256i *)(src + 4 * i)), 8);
+        _mm256_storeu_ps(dst + i, _mm256_mul_ps(_mm256_cvtepi32_ps(v), scale));
+    }
+    s24_32_unpack_scalar(src + 4 * i, dst + i, n - i);
+}
+
+__attribute__((target("avx2")))
+static void s32_unpack_avx2(const uint8_t *src, float *dst, size_t n)
+{
+    const __m256 scale = _mm256_set1_ps(PCM_SCALE_TOP);
+    size_t i = 0;
+
+    for (; i + 8 <= n; i += 8) {
+        __m256i v = _mm256_loadu_si256((const __m256i *)(src + 4 * i));
+        _mm256_storeu_ps(dst + i, _mm256_mul_ps(_mm256_cvtepi32_ps(v), scale));
+    }
+    s32_unpack_scalar(src + 4 * i, dst + i, n - i);
+}
+
+#endif /* PCM_HAVE_X86 */
+
+#ifdef PCM_HAVE_NEON
+
+static void s16_unpack_neon(const uint8_t *src, float *dst, size_t n)
+{
+    size_t i = 0;
+
+    for (; i + 8 <= n; i += 8) {
+        int16x8_t s = vreinterpretq_s16_u8(vld1q_u8(src + 2 * i));
+        float32x4_t lo = vcvtq_f32_s32(vmovl_s16(vget_low_s16(s)));
+        float32x4_t hi = vcvtq_f32_s32(vmovl_s16(vget_high_s16(s)));
+        vst1q_f32(dst + i,     vmulq_n_f32(lo, PCM_SCALE_16));
+        vst1q_f32(dst + i + 4, vmulq_n_f32(hi, PCM_SCALE_16));
+    }
+    s16_unpack_scalar(src + 2 * i, dst + i, n - i);
+}
+
+static void s24_unpack_neon(const uint8_t *src, float *dst, size_t n)
+{
+    size_t i = 0;
+
+    for (; i + 8 <= n; i += 8) {
+        /* Byte planes LSB / mid / MSB for 8 samples */
+        uint8x8x3_t b = vld3_u8(src + 3 * i);
+        int16x8_t  msb = vmovl_s8(vreinterpret_s8_u8(b.val[2]));
+        uint16x8_t low = vorrq_u16(vshll_n_u8(b.val[1], 8), vmovl_u8(b.val[0]));
+
+        int32x4_t lo = vorrq_s32(vshlq_n_s32(vmovl_s16(vget_low_s16(msb)), 16),
+                                 vreinterpretq_s32_u32(vmovl_u16(vget_low_u16(low))));
+        int32x4_t hi = vorrq_s32(vshlq_n_s32(vmovl_s16(vget_high_s16(msb)), 16),
+                                 vreinterpretq_s32_u32(vmovl_u16(vget_high_u16(low))));
+
+        vst1q_f32(dst + i,     vmulq_n_f32(vcvtq_f32_s32(lo), PCM_SCALE_24));
+        vst1q_f32(dst + i + 4, vmulq_n_f32(vcvtq_f32_s32(hi), PCM_SCALE_24));
+    }
+    s24_unpack_scalar(src + 3 * i, dst + i, n - i);
+}
+
+static void s24_32_unpack_neon(const uint8_t *src, float *dst, size_t n)
+{
+    size_t i = 0;
+
+    for (; i + 4 <= n; i += 4) {
+        int32x4_t v = vshlq_n_s32(vreinterpretq_s32_u8(vld1q_u8(src + 4 * i)), 8);
+        vst1q_f32(dst + i, vmulq_n_f32(vcvtq_f32_s32(v), PCM_SCALE_TOP));
+    }
+    s24_32_unpack_scalar(src + 4 * i, dst + i, n - i);
+}
+
+static void s32_unpack_neon(const uint8_t *src, float *dst, size_t n)
+{
+    size_t i = 0;
+
+    for (; i + 4 <= n; i += 4) {
+        int32x4_t v = vreinterpretq_s32_u8(vld1q_u8(src + 4 * i));
+        vst1q_f32(dst + i, vmulq_n_f32(vcvtq_f32_s32(v), PCM_SCALE_TOP));
+    }
+    s32_unpack_scalar(src + 4 * i, dst + i, n - i);
+}
+
+#endif /* PCM_HAVE_NEON */
+
+/* -------- Selection -------- */
+
+audyn_pcm_isa_t audyn_pcm_best_isa(void)
+{
+#if defined(PCM_HAVE_X86)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) return AUDYN_PCM_ISA_AVX2;
+    if (__builtin_cpu_supports("sse4.1")) return AUDYN_PCM_ISA_SSE4;
+    return AUDYN_PCM_ISA_SCALAR;
+#elif defined(PCM_HAVE_NEON)
+    return AUDYN_PCM_ISA_NEON;
+#else
+    return AUDYN_PCM_ISA_SCALAR;
+#endif
+}
+
+const char *audyn_pcm_isa_name(audyn_pcm_isa_t isa)
+{
+    switch (isa) {
+        case AUDYN_PCM_ISA_AUTO:   return "auto";
+        case AUDYN_PCM_ISA_SCALAR: return "scalar";
+        case AUDYN_PCM_ISA_SSE4:   return "sse4.1";
+        case AUDYN_PCM_ISA_AVX2:   return "avx2";
+        case AUDYN_PCM_ISA_NEON:   return "neon";
+        default:                   return "unknown";
+    }
+}
+
+static int isa_available(audyn_pcm_isa_t isa)
+{
+    audyn_pcm_isa_t best = audyn_pcm_best_isa();
+    if (isa == AUDYN_PCM_ISA_SCALAR) return 1;
+    if (isa == best) return 1;
+    /* AVX2-capable x86 CPUs also run the SSE4.1 kernels */
+    return (isa == AUDYN_PCM_ISA_SSE4 && best == AUDYN_PCM_ISA_AVX2);
+}
+
+static void select_scalar(audyn_pcm_decoder_t *dec, int contig, int l24)
+{
+    if (contig) {
+        dec->fn = l24 ? l24_contig_scalar : l16_contig_scalar;
+        dec->name = l24 ? "l24-contig-scalar" : "l16-contig-scalar";
+    } else if (dec->out_channels == 2) {
+        dec->fn = l24 ? l24_pair_scalar : l16_pair_scalar;
+        dec->name = l24 ? "l24-pair-scalar" : "l16-pair-scalar";
+    } else {
+        dec->fn = l24 ? l24_stride_scalar : l16_stride_scalar;
+        dec->name = l24 ? "l24-stride-scalar" : "l16-stride-scalar";
+    }
+}
+
+int audyn_pcm_decoder_init(audyn_pcm_decoder_t *dec,
+                           audyn_pcm_format_t fmt,
+                           uint16_t stream_ch,
+                           uint16_t ch_offset,
+                           uint16_t out_ch,
+                           audyn_pcm_isa_t isa)
+{
+    if (!dec) return -1;
+    if (fmt != AUDYN_PCM_L16 && fmt != AUDYN_PCM_L24) return -1;
+    if (stream_ch == 0 || out_ch == 0) return -1;
+    if ((uint32_t)ch_offset + out_ch > stream_ch) return -1;
+
+    dec->format = fmt;
+    dec->stream_channels = stream_ch;
+    dec->channel_offset = ch_offset;
+    dec->out_channels = out_ch;
+    dec->bytes_per_sample = (fmt == AUDYN_PCM_L24) ? 3U : 2U;
+    dec->stride_bytes = (uint32_t)stream_ch * dec->bytes_per_sample;
+
+    const int contig = (out_ch == stream_ch);
+    const int l24 = (fmt == AUDYN_PCM_L24);
+
+    if (isa == AUDYN_PCM_ISA_AUTO) {
+        isa = audyn_pcm_best_isa();
+    } else if (!isa_available(isa)) {
+        isa = AUDYN_PCM_ISA_SCALAR;
+    }
+
+    select_scalar(dec, contig, l24);
+    dec->extract = contig ? x24_contig_scalar : x24_stride_scalar;
+
+    switch (isa) {
+#ifdef PCM_HAVE_X86
+        case AUDYN_PCM_ISA_AVX2:
+            if (contig) {
+                dec->extract = x24_contig_sse4;
+                dec->fn = l24 ? l24_contig_avx2 : l16_contig_avx2;
+                dec->name = l24 ? "l24-contig-avx2" : "l16-contig-avx2";
+            } else if (8 % out_ch == 0 && (l24 || out_ch >= 4)) {
+                /* L16 pairs: two scalar loads per frame beat a gather */
+                dec->fn = l24 ? l24_stride_avx2 : l16_stride_avx2;
+                dec->name = l24 ? "l24-stride-avx2" : "l16-stride-avx2";
+            }
+            break;
+        case AUDYN_PCM_ISA_SSE4:
+            if (contig) {
+                dec->extract = x24_contig_sse4;
+                dec->fn = l24 ? l24_contig_sse4 : l16_contig_sse4;
+                dec->name = l24 ? "l24-contig-sse4.1" : "l16-contig-sse4.1";
+            }
+            break;
+#endif
+#ifdef PCM_HAVE_NEON
+        case AUDYN_PCM_ISA_NEON:
+            if (contig) {
+                dec->extract = x24_contig_neon;
+                dec->fn = l24 ? l24_contig_neon : l16_contig_neon;
+                dec->name = l24 ? "l24-contig-neon" : "l16-contig-neon";
+            }
+            break;
+#endif
+        default:
+            break;
+    }
+
+    return 0;
+}
+
+int audyn_pcm_encoder_init(audyn_pcm_encoder_t *enc,
+                           audyn_pcm_out_format_t fmt,
+                           audyn_pcm_isa_t isa)
+{
+    if (!enc) return -1;
+
+    if (isa == AUDYN_PCM_ISA_AUTO) {
+        isa = audyn_pcm_best_isa();
+    } else if (!isa_available(isa)) {
+        isa = AUDYN_PCM_ISA_SCALAR;
+    }
+
+    enc->format = fmt;
+
+    switch (fmt) {
+        case AUDYN_PCM_OUT_S16LE:
+            enc->bytes_per_sample = 2;
+            enc->fn = s16_encode_scalar;
+            enc->name = "s16le-scalar";
+            break;
+        case AUDYN_PCM_OUT_S24LE:
+            enc->bytes_per_sample = 3;
+            enc->fn = s24_encode_scalar;
+            enc->name = "s24le-scalar";
+            break;
+        case AUDYN_PCM_OUT_F32LE:
+            enc->bytes_per_sample = 4;
+            enc->fn = f32_encode_copy;
+            enc->name = "f32le-copy";
+            return 0;
+        default:
+            return -1;
+    }
+
+    const int s24 = (fmt == AUDYN_PCM_OUT_S24LE);
+
+    switch (isa) {
+#ifdef PCM_HAVE_X86
+        case AUDYN_PCM_ISA_AVX2:
+            enc->fn = s24 ? s24_encode_avx2 : s16_encode_avx2;
+            enc->name = s24 ? "s24le-avx2" : "s16le-avx2";
+            break;
+        case AUDYN_PCM_ISA_SSE4:
+            enc->fn = s24 ? s24_encode_sse4 : s16_encode_sse4;
+            enc->name = s24 ? "s24le-sse4.1" : "s16le-sse4.1";
+            break;
+#endif
+#ifdef PCM_HAVE_NEON
+        case AUDYN_PCM_ISA_NEON:
+            enc->fn = s24 ? s24_encode_neon : s16_encode_neon;
+            enc->name = s24 ? "s24le-neon" : "s16le-neon";
+            break;
+#endif
+        default:
+            break;
+    }
+
+    return 0;
+}
+
+int audyn_pcm_unpacker_init(audyn_pcm_unpacker_t *up,
+                            audyn_pcm_in_format_t fmt,
+                            audyn_pcm_isa_t isa)
+{
+    if (!up) return -1;
+
+    if (isa == AUDYN_PCM_ISA_AUTO) {
+        isa = audyn_pcm_best_isa();
+    } else if (!isa_available(isa)) {
+        isa = AUDYN_PCM_ISA_SCALAR;
+    }
+
+    /* Kernel table per format: scalar, sse4.1, avx2, neon */
+    static const struct {
+        audyn_pcm_in_format_t fmt;
+        uint32_t bytes;
+        const char *names[4];
+        audyn_pcm_unpack_fn fns[4];
+    } table[] = {
+#if defined(PCM_HAVE_X86)
+#define PCM_UNPACK_SIMD(k) { k##_unpack_scalar, k##_unpack_sse4, k##_unpack_avx2, NULL }
+#elif defined(PCM_HAVE_NEON)
+#define PCM_UNPACK_SIMD(k) { k##_unpack_scalar, NULL, NULL, k##_unpack_neon }
+#else
+#define PCM_UNPACK_SIMD(k) { k##_unpack_scalar, NULL, NULL, NULL }
+#endif
+        { AUDYN_PCM_IN_S16LE, 2,
+          { "s16le-scalar", "s16le-sse4.1", "s16le-avx2", "s16le-neon" },
+          PCM_UNPACK_SIMD(s16) },
+        /* Packed 24-bit: the cross-lane insert makes a 256-bit version
+         * slower than SSE4.1 on long blocks, so AVX2 CPUs run SSE4.1 */
+        { AUDYN_PCM_IN_S24LE, 3,
+          { "s24le-scalar", "s24le-sse4.1", "s24le-sse4.1", "s24le-neon" },
+#if defined(PCM_HAVE_X86)
+          { s24_unpack_scalar, s24_unpack_sse4, s24_unpack_sse4, NULL } },
+#else
+          PCM_UNPACK_SIMD(s24) },
+#endif
+        { AUDYN_PCM_IN_S24_32LE, 4,
+          { "s24_32le-scalar", "s24_32le-sse4.1", "s24_32le-avx2", "s24_32le-neon" },
+          PCM_UNPACK_SIMD(s24_32) },
+        { AUDYN_PCM_IN_S32LE, 4,
+          { "s32le-scalar", "s32le-sse4.1", "s32le-avx2", "s32le-neon" },
+          PCM_UNPACK_SIMD(s32) },
+#undef PCM_UNPACK_SIMD
+    };
+
+    up->format = fmt;
+
+    if (fmt == AUDYN_PCM_IN_F32LE) {
+        up->bytes_per_sample = 4;
+        up->fn = f32_unpack_copy;
+        up->name = "f32le-copy";
+        return 0;
+    }
+
+    for (size_t t = 0; t < sizeof(table) / sizeof(table[0]); t++) {
+        if (table[t].fmt != fmt) continue;
+
+        int k = 0;
+        switch (isa) {
+            case AUDYN_PCM_ISA_SSE4: k = 1; break;
+            case AUDYN_PCM_ISA_AVX2: k = 2; break;
+            case AUDYN_PCM_ISA_NEON: k = 3; break;
+            default:                 k = 0; break;
+        }
+        if (!table[t].fns[k]) k = 0;
+
+        up->bytes_per_sample = table[t].bytes;
+        up->fn = table[t].fns[k];
+        up->name = table[t].names[k];
+        return 0;
+    }
+
+    return -1;
+}
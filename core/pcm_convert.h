@@ -0,0 +1,227 @@
+/*
+ *  Audyn — Professional Audio Capture & Archival Engine
+ *
+ *  File:
+ *      pcm_convert.h
+ *
+ *  Purpose:
+ *      Big-endian L16/L24 PCM to interleaved float decode kernels, float to
+ *      little-endian file PCM encode kernels, an L24 passthrough that
+ *      re-packs payload samples as little-endian 24-bit without a float
+ *      round trip, and little-endian host PCM to float unpack kernels.
+ *
+ *      A decoder is configured once per stream (format, stream channel
+ *      count, channel offset, output channels) and binds the fastest
+ *      kernel for that shape on the running CPU. The per-packet call is
+ *      then a single indirect call with no format or layout branching.
+ *
+ *  Kernels:
+ *      - Contiguous (output channels == stream channels):
+ *          SSE4.1, AVX2 (x86, runtime-detected), NEON (AArch64/ARMv7+NEON)
+ *      - Strided channel selection (e.g. a pair out of a 64-channel stream):
+ *          AVX2 gather on x86 (L24, or L16 with 4/8 output channels),
+ *          specialised scalar (pair / generic) elsewhere
+ *      - Generic scalar reference
+ *
+ *      All kernels are bit-exact with the scalar path: integer samples are
+ *      scaled by powers of two, which is exact in float for 16/24-bit input.
+ *
+ *  Encoders (float -> file PCM):
+ *      - S16LE: clamp, x * 32767, truncate (the historical WAV conversion)
+ *      - S24LE: clamp, x * 8388608, truncate, saturate to 8388607; decoded
+ *        L16/L24 input therefore round-trips exactly
+ *      - F32LE: copied as-is (no clamping)
+ *      SSE4.1 / AVX2 / NEON for S16 and S24, bit-exact with scalar.
+ *
+ *  Unpackers (host PCM -> float, for PipeWire capture):
+ *      - S16LE, S24LE (packed), S24_32LE, S32LE scaled to [-1, 1);
+ *        F32LE copied as-is
+ *      SSE4.1 / AVX2 / NEON for the integer formats, bit-exact with scalar.
+ *
+ *  Build:
+ *      Define AUDYN_PCM_NO_SIMD (make SIMD=0) to compile scalar kernels only.
+ *
+ *  Copyright:
+ *      (c) 2026 B. Wynne
+ *
+ *  Author:
+ *      B. Wynne
+ *
+ *  License:
+ *      GPLv2 or later
+ */
+
+#ifndef AUDYN_PCM_CONVERT_H
+#define AUDYN_PCM_CONVERT_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum audyn_pcm_format {
+    AUDYN_PCM_L16 = 16,             /* 16-bit signed big-endian */
+    AUDYN_PCM_L24 = 24              /* 24-bit signed big-endian */
+} audyn_pcm_format_t;
+
+typedef enum audyn_pcm_isa {
+    AUDYN_PCM_ISA_AUTO = 0,         /* Best available on this CPU */
+    AUDYN_PCM_ISA_SCALAR,
+    AUDYN_PCM_ISA_SSE4,
+    AUDYN_PCM_ISA_AVX2,
+    AUDYN_PCM_ISA_NEON
+} audyn_pcm_isa_t;
+
+typedef struct audyn_pcm_decoder audyn_pcm_decoder_t;
+
+typedef void (*audyn_pcm_decode_fn)(const audyn_pcm_decoder_t *dec,
+                                    const uint8_t *src, float *dst,
+                                    uint32_t frames);
+
+typedef void (*audyn_pcm_extract_fn)(const audyn_pcm_decoder_t *dec,
+                                     const uint8_t *src, uint8_t *dst,
+                                     uint32_t frames);
+
+/* Decoder state (caller-allocated, typically embedded in the input) */
+struct audyn_pcm_decoder {
+    audyn_pcm_decode_fn fn;
+    audyn_pcm_extract_fn extract;   /* L24 only: payload -> packed S24LE */
+    audyn_pcm_format_t  format;
+    uint16_t stream_channels;
+    uint16_t channel_offset;
+    uint16_t out_channels;
+    uint32_t bytes_per_sample;
+    uint32_t stride_bytes;          /* Bytes per stream sample frame */
+    const char *name;               /* Kernel name, e.g. "l24-contig-avx2" */
+};
+
+/*
+ * Configure a decoder and select its kernel.
+ *
+ * Parameters:
+ *   dec          - decoder to initialise
+ *   fmt          - payload format
+ *   stream_ch    - channels in the incoming stream (>= 1)
+ *   ch_offset    - first channel to extract
+ *   out_ch       - channels to extract (ch_offset + out_ch <= stream_ch)
+ *   isa          - AUDYN_PCM_ISA_AUTO, or force a kernel family; an
+ *                  unavailable ISA falls back to scalar
+ *
+ * Returns:
+ *   0 on success, -1 on invalid layout
+ */
+int audyn_pcm_decoder_init(audyn_pcm_decoder_t *dec,
+                           audyn_pcm_format_t fmt,
+                           uint16_t stream_ch,
+                           uint16_t ch_offset,
+                           uint16_t out_ch,
+                           audyn_pcm_isa_t isa);
+
+/*
+ * Decode 'frames' stream sample frames from src into interleaved float dst
+ * (frames * out_channels values in [-1, 1)).
+ */
+static inline void audyn_pcm_decode(const audyn_pcm_decoder_t *dec,
+                                    const uint8_t *src, float *dst,
+                                    uint32_t frames)
+{
+    dec->fn(dec, src, dst, frames);
+}
+
+/*
+ * Copy the selected channels of an L24 payload to dst as packed
+ * little-endian 24-bit (frames * out_channels * 3 bytes), bit-exact with
+ * the stream. Only valid for decoders initialised with AUDYN_PCM_L24.
+ */
+static inline void audyn_pcm_extract_s24le(const audyn_pcm_decoder_t *dec,
+                                           const uint8_t *src, uint8_t *dst,
+                                           uint32_t frames)
+{
+    dec->extract(dec, src, dst, frames);
+}
+
+/* -------- Encoders -------- */
+
+typedef enum audyn_pcm_out_format {
+    AUDYN_PCM_OUT_S16LE = 16,       /* 16-bit signed little-endian */
+    AUDYN_PCM_OUT_S24LE = 24,       /* 24-bit signed little-endian, packed */
+    AUDYN_PCM_OUT_F32LE = 32        /* IEEE 754 float little-endian */
+} audyn_pcm_out_format_t;
+
+typedef void (*audyn_pcm_encode_fn)(const float *src, uint8_t *dst, size_t samples);
+
+typedef struct audyn_pcm_encoder {
+    audyn_pcm_encode_fn    fn;
+    audyn_pcm_out_format_t format;
+    uint32_t bytes_per_sample;
+    const char *name;               /* e.g. "s24le-avx2" */
+} audyn_pcm_encoder_t;
+
+/*
+ * Select an encoder kernel for fmt. Returns 0 on success, -1 on an unknown
+ * format. An unavailable ISA falls back to scalar.
+ */
+int audyn_pcm_encoder_init(audyn_pcm_encoder_t *enc,
+                           audyn_pcm_out_format_t fmt,
+                           audyn_pcm_isa_t isa);
+
+/* Encode 'samples' interleaved floats into samples * bytes_per_sample bytes. */
+static inline void audyn_pcm_encode(const audyn_pcm_encoder_t *enc,
+                                    const float *src, uint8_t *dst,
+                                    size_t samples)
+{
+    enc->fn(src, dst, samples);
+}
+
+/* -------- Unpackers (host PCM -> float) -------- */
+
+/* Little-endian interleaved sample formats delivered by local audio
+ * servers (PipeWire) */
+typedef enum audyn_pcm_in_format {
+    AUDYN_PCM_IN_S16LE = 1,         /* 16-bit signed */
+    AUDYN_PCM_IN_S24LE,             /* 24-bit signed, packed 3 bytes */
+    AUDYN_PCM_IN_S24_32LE,          /* 24-bit signed in the low bits of 4 bytes */
+    AUDYN_PCM_IN_S32LE,             /* 32-bit signed */
+    AUDYN_PCM_IN_F32LE              /* IEEE 754 float */
+} audyn_pcm_in_format_t;
+
+typedef void (*audyn_pcm_unpack_fn)(const uint8_t *src, float *dst, size_t samples);
+
+typedef struct audyn_pcm_unpacker {
+    audyn_pcm_unpack_fn   fn;
+    audyn_pcm_in_format_t format;
+    uint32_t bytes_per_sample;
+    const char *name;               /* e.g. "s24_32le-avx2" */
+} audyn_pcm_unpacker_t;
+
+/*
+ * Select an unpack kernel for fmt. Returns 0 on success, -1 on an unknown
+ * format. An unavailable ISA falls back to scalar. S16/S24 scale exactly
+ * like the L16/L24 decoders; S32 rounds to the nearest float.
+ */
+int audyn_pcm_unpacker_init(audyn_pcm_unpacker_t *up,
+                            audyn_pcm_in_format_t fmt,
+                            audyn_pcm_isa_t isa);
+
+/* Unpack 'samples' interleaved samples (samples * bytes_per_sample bytes). */
+static inline void audyn_pcm_unpack(const audyn_pcm_unpacker_t *up,
+                                    const uint8_t *src, float *dst,
+                                    size_t samples)
+{
+    up->fn(src, dst, samples);
+}
+
+/*
+ * Best ISA available on the running CPU (for logging/benchmarks).
+ */
+audyn_pcm_isa_t audyn_pcm_best_isa(void);
+
+const char *audyn_pcm_isa_name(audyn_pcm_isa_t isa);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* AUDYN_PCM_CONVERT_H */
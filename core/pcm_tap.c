@@ -0,0 +1,218 @@
+/*
+ *  Audyn — Professional Audio Capture & Archival Engine
+ *
+ *  File:
+ *      pcm_tap.c
+ *
+ *  Purpose:
+ *      Live PCM tap in POSIX shared memory (see pcm_tap.h).
+ *
+ *  Copyright:
+ *      (c) 2026 B. Wynne
+ *
+ *  Author:
+ *      B. Wynne
+ *
+ *  License:
+ *      GPLv2 or later
+ */
+
+#define _GNU_SOURCE
+
+#include "pcm_tap.h"
+#include "log.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+/* Fixed offsets promised to readers (pcm_tap.h) */
+_Static_assert(offsetof(audyn_pcm_tap_layout_t, capacity_frames) == 32, "pcm_tap: capacity offset");
+_Static_assert(offsetof(audyn_pcm_tap_layout_t, begin_frames) == 40, "pcm_tap: begin offset");
+_Static_assert(offsetof(audyn_pcm_tap_layout_t, end_frames) == 48, "pcm_tap: end offset");
+_Static_assert(sizeof(audyn_pcm_tap_layout_t) == 64, "pcm_tap: header size");
+
+/* Same channel limit as an AES67 stream description */
+#define PCM_TAP_MAX_CHANNELS 64u
+
+struct audyn_pcm_tap {
+    audyn_pcm_tap_layout_t *map;
+    float *ring;
+    size_t map_bytes;
+    uint32_t channels;
+    uint32_t capacity;          /* Frames, power of two */
+    uint64_t written;           /* Writer's own copy of end_frames */
+    char name[AUDYN_PCM_TAP_NAME_MAX + 2];      /* Leading '/' + NUL */
+};
+
+static uint64_t monotonic_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+/* Canonical "/name" into out; -1 if the name is unusable */
+static int canon_name(const char *name, char *out, size_t out_len)
+{
+    if (!name) return -1;
+    if (name[0] == '/') name++;
+
+    size_t len = strlen(name);
+    if (len == 0 || len > AUDYN_PCM_TAP_NAME_MAX) return -1;
+    if (strchr(name, '/')) return -1;
+    if (!strcmp(name, ".") || !strcmp(name, "..")) return -1;
+
+    snprintf(out, out_len, "/%s", name);
+    return 0;
+}
+
+int audyn_pcm_tap_check_name(const char *name)
+{
+    char tmp[AUDYN_PCM_TAP_NAME_MAX + 2];
+    return canon_name(name, tmp, sizeof(tmp));
+}
+
+audyn_pcm_tap_t *audyn_pcm_tap_create(const char *name,
+                                      uint32_t sample_rate,
+                                      uint32_t channels,
+                                      uint32_t ring_ms)
+{
+    if (channels == 0 || channels > PCM_TAP_MAX_CHANNELS || sample_rate == 0) {
+        LOG_ERROR("pcm_tap: invalid format %u Hz, %u channels (1-%u)",
+                  sample_rate, channels, PCM_TAP_MAX_CHANNELS);
+        return NULL;
+    }
+    if (ring_ms < AUDYN_PCM_TAP_MS_MIN || ring_ms > AUDYN_PCM_TAP_MS_MAX) {
+        LOG_ERROR("pcm_tap: ring length %ums out of range (%u-%u)",
+                  ring_ms, AUDYN_PCM_TAP_MS_MIN, AUDYN_PCM_TAP_MS_MAX);
+        return NULL;
+    }
+
+    audyn_pcm_tap_t *tap = calloc(1, sizeof(*tap));
+    if (!tap) {
+        LOG_ERROR("pcm_tap: failed to allocate structure");
+        return NULL;
+    }
+    if (canon_name(name, tap->name, sizeof(tap->name)) != 0) {
+        LOG_ERROR("pcm_tap: invalid tap name '%s' (1-%d characters, no '/')",
+                  name ? name : "", AUDYN_PCM_TAP_NAME_MAX);
+        free(tap);
+        return NULL;
+    }
+
+    /* Power-of-two frames so a position maps to its slot with a mask */
+    const uint64_t want = ((uint64_t)sample_rate * ring_ms + 999u) / 1000u;
+    uint32_t cap = 1;
+    while (cap < want) cap <<= 1;
+
+    tap->channels = channels;
+    tap->capacity = cap;
+    tap->map_bytes = sizeof(audyn_pcm_tap_layout_t) + (size_t)cap * channels * sizeof(float);
+
+    /* World-readable: the web backend may run as another user */
+    int fd = shm_open(tap->name, O_CREAT | O_RDWR | O_TRUNC, 0644);
+    if (fd < 0) {
+        LOG_ERROR("pcm_tap: shm_open(%s) failed: %s", tap->name, strerror(errno));
+        free(tap);
+        return NULL;
+    }
+    if (ftruncate(fd, (off_t)tap->map_bytes) != 0) {
+        LOG_ERROR("pcm_tap: ftruncate(%s) failed: %s", tap->name, strerror(errno));
+        close(fd);
+        shm_unlink(tap->name);
+        free(tap);
+        return NULL;
+    }
+
+    void *p = mmap(NULL, tap->map_bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (p == MAP_FAILED) {
+        LOG_ERROR("pcm_tap: mmap(%s) failed: %s", tap->name, strerror(errno));
+        shm_unlink(tap->name);
+        free(tap);
+        return NULL;
+    }
+
+    tap->map = (audyn_pcm_tap_layout_t *)p;
+    tap->ring = (float *)((unsigned char *)p + sizeof(audyn_pcm_tap_layout_t));
+
+    /* Fault the ring in now rather than on the worker's first laps */
+    memset(tap->ring, 0, (size_t)cap * channels * sizeof(float));
+
+    /* Fresh (zeroed) mapping; publish the header with magic last */
+    audyn_pcm_tap_layout_t *m = tap->map;
+    m->version = AUDYN_PCM_TAP_VERSION;
+    m->header_bytes = (uint32_t)sizeof(*m);
+    m->pid = (uint32_t)getpid();
+    m->format = AUDYN_PCM_TAP_F32;
+    m->sample_rate = sample_rate;
+    m->channels = channels;
+    m->capacity_frames = cap;
+    atomic_store_explicit(&m->begin_frames, 0u, memory_order_relaxed);
+    atomic_store_explicit(&m->end_frames, 0u, memory_order_relaxed);
+    atomic_store_explicit(&m->update_ns, monotonic_ns(), memory_order_relaxed);
+    atomic_store_explicit(&m->state, 1u, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    m->magic = AUDYN_PCM_TAP_MAGIC;
+
+    LOG_INFO("PCM tap: /dev/shm%s (%u Hz, %u channels, %u frames, %zu bytes)",
+             tap->name, sample_rate, channels, cap, tap->map_bytes);
+    return tap;
+}
+
+void audyn_pcm_tap_write(audyn_pcm_tap_t *tap, const float *interleaved, uint32_t frames)
+{
+    if (!tap || !interleaved || frames == 0) return;
+
+    audyn_pcm_tap_layout_t *m = tap->map;
+    const uint32_t ch = tap->channels;
+    const uint64_t end = tap->written + frames;
+
+    /* Only the last lap of an oversized block survives anyway */
+    if (frames > tap->capacity) {
+        interleaved += (size_t)(frames - tap->capacity) * ch;
+        frames = tap->capacity;
+    }
+    const uint64_t start = end - frames;
+
+    /* Announce the overwrite before touching the slots, so a reader that
+     * sees begin_frames after its copy knows which frames may be torn */
+    atomic_store_explicit(&m->begin_frames, end, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+
+    const uint32_t slot = (uint32_t)(start & (tap->capacity - 1u));
+    uint32_t first = tap->capacity - slot;
+    if (first > frames) first = frames;
+
+    memcpy(tap->ring + (size_t)slot * ch, interleaved, (size_t)first * ch * sizeof(float));
+    if (first < frames) {
+        memcpy(tap->ring, interleaved + (size_t)first * ch,
+               (size_t)(frames - first) * ch * sizeof(float));
+    }
+
+    tap->written = end;
+    atomic_store_explicit(&m->end_frames, end, memory_order_release);
+    atomic_store_explicit(&m->update_ns, monotonic_ns(), memory_order_relaxed);
+}
+
+void audyn_pcm_tap_destroy(audyn_pcm_tap_t *tap)
+{
+    if (!tap) return;
+
+    if (tap->map) {
+        atomic_store_explicit(&tap->map->state, 0u, memory_order_release);
+        munmap(tap->map, tap->map_bytes);
+    }
+    shm_unlink(tap->name);
+
+    LOG_DEBUG("pcm_tap: removed %s", tap->name);
+    free(tap);
+}
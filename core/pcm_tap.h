@@ -0,0 +1,141 @@
+/*
+ *  Audyn — Professional Audio Capture & Archival Engine
+ *
+ *  File:
+ *      pcm_tap.h
+ *
+ *  Purpose:
+ *      Live PCM tap in POSIX shared memory (/dev/shm/<name>).
+ *
+ *      The worker publishes every queue frame of decoded audio into a
+ *      ring that any number of other processes map read-only, so live
+ *      listening, streaming and metering attach to a running recorder at
+ *      no extra network or decode cost and without a second capture
+ *      process. The writer never waits for readers: a reader that falls
+ *      more than the ring's length behind loses audio and can tell how
+ *      much.
+ *
+ *  Layout:
+ *      audyn_pcm_tap_layout_t below, little-endian native, version 1,
+ *      then the ring at header_bytes: capacity_frames interleaved sample
+ *      frames of float32 (format AUDYN_PCM_TAP_F32). Frame n lives in
+ *      slot n & (capacity_frames - 1). Readers check magic, version and
+ *      header_bytes before use.
+ *
+ *  Position protocol (single writer, any number of readers):
+ *      Writer, for frames [w, w + n): begin_frames = w + n, release
+ *      fence, copy the frames into their slots, end_frames = w + n
+ *      (release). Frames below begin_frames - capacity_frames are being
+ *      or have been overwritten.
+ *
+ *      Reader, keeping its own position r:
+ *        1. end = end_frames (acquire). If end - r > capacity_frames the
+ *           reader was lapped: count the gap as lost, r = end - capacity_frames.
+ *        2. Copy frames [r, end).
+ *        3. atomic_thread_fence(memory_order_acquire), then
+ *           begin = begin_frames (relaxed). The fence keeps the copy's
+ *           loads from moving past the reload (an acquire load alone does
+ *           not). Frames below begin - capacity_frames may be torn: drop
+ *           them, count them as lost. r = end.
+ *      A new reader starts at end_frames (live) or any later-validated
+ *      point behind it. Positions are 64-bit frame counts and never wrap.
+ *
+ *      state is 1 while the writer runs and 0 after a clean shutdown (the
+ *      name is unlinked then); update_ns (CLOCK_MONOTONIC of the last
+ *      write) going stale means the writer has stopped or audio stopped
+ *      arriving.
+ *
+ *  Threading:
+ *      - write() from one thread (the worker), real-time safe
+ *
+ *  Dependencies:
+ *      - POSIX shm_open/mmap, C11 atomics
+ *      - Audyn: log
+ *
+ *  Copyright:
+ *      (c) 2026 B. Wynne
+ *
+ *  Author:
+ *      B. Wynne
+ *
+ *  License:
+ *      GPLv2 or later
+ */
+
+#ifndef AUDYN_PCM_TAP_H
+#define AUDYN_PCM_TAP_H
+
+#include <stdint.h>
+#include <stdatomic.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define AUDYN_PCM_TAP_MAGIC     0x50545941u     /* "AYTP" little-endian */
+#define AUDYN_PCM_TAP_VERSION   1u
+
+/* Sample formats */
+#define AUDYN_PCM_TAP_F32       1u              /* Interleaved float32, nominal -1..+1 */
+
+/* Longest accepted tap name (same rules as the level feed) */
+#define AUDYN_PCM_TAP_NAME_MAX  64
+
+/* Ring length limits (ms of audio; rounded up to a power of two frames) */
+#define AUDYN_PCM_TAP_MS_MIN    100u
+#define AUDYN_PCM_TAP_MS_MAX    60000u
+
+/*
+ * Shared header (64 bytes). Offsets are fixed for version 1:
+ *   0 magic, 4 version, 8 header_bytes, 12 pid, 16 state, 20 format,
+ *   24 sample_rate, 28 channels, 32 capacity_frames, 40 begin_frames,
+ *   48 end_frames, 56 update_ns
+ */
+typedef struct audyn_pcm_tap_layout {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t header_bytes;              /* Ring offset */
+    uint32_t pid;                       /* Writer process */
+    _Atomic uint32_t state;             /* 1 = running, 0 = stopped */
+    uint32_t format;                    /* AUDYN_PCM_TAP_F32 */
+    uint32_t sample_rate;
+    uint32_t channels;
+    uint32_t capacity_frames;           /* Power of two */
+    uint32_t reserved;
+    _Atomic uint64_t begin_frames;      /* Frames being written up to */
+    _Atomic uint64_t end_frames;        /* Frames published */
+    _Atomic uint64_t update_ns;         /* CLOCK_MONOTONIC of the last write */
+} audyn_pcm_tap_layout_t;
+
+typedef struct audyn_pcm_tap audyn_pcm_tap_t;
+
+/*
+ * Create (or replace) /dev/shm/<name> with a ring holding at least
+ * ring_ms of audio, and map it. The pages are touched here so writes
+ * never fault.
+ *
+ * Returns tap or NULL on error (logged). NOT real-time safe.
+ */
+audyn_pcm_tap_t *audyn_pcm_tap_create(const char *name,
+                                      uint32_t sample_rate,
+                                      uint32_t channels,
+                                      uint32_t ring_ms);
+
+/*
+ * Publish frames sample frames of interleaved float32 (channels as
+ * created). A block longer than the ring keeps its last capacity_frames.
+ * Real-time safe: copies and atomic stores only.
+ */
+void audyn_pcm_tap_write(audyn_pcm_tap_t *tap, const float *interleaved, uint32_t frames);
+
+/* Check a tap name without creating it. Returns 0 if usable, -1 if not. */
+int audyn_pcm_tap_check_name(const char *name);
+
+/* Mark stopped, unmap and unlink (safe with NULL). */
+void audyn_pcm_tap_destroy(audyn_pcm_tap_t *tap);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* AUDYN_PCM_TAP_H */
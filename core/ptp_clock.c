@@ -16,6 +16,24 @@
  *        - Uses CLOCK_REALTIME
  *        - Assumes system clock is synced by linuxptp (ptp4l/phc2sys)
  *
+ *      Readers do not block in the common case:
+ *        - The RTP epoch and the cached PHC sample are published under
+ *          seqlocks; readers retry on a concurrent update instead of
+ *          taking 'lock', which serialises writers.
+ *        - A reader that still finds an update in progress after
+ *          SEQ_READ_SPINS takes 'lock' (priority inheriting) and reads
+ *          under it instead: the writer may be a preempted lower-priority
+ *          thread on the same CPU as a SCHED_FIFO reader, which would
+ *          otherwise never get to finish.
+ *        - RTP timestamps are unwrapped against a reference point in
+ *          the epoch (within +/-2^31 samples), so conversion keeps no
+ *          per-call state. The reference is moved forward by whichever
+ *          caller finds it 2^30 samples behind, if 'lock' is free.
+ *        - Cached PHC mode re-reads the PHC (a syscall; dynamic clocks
+ *          have no vDSO path) at most every phc_cache_ms, with a
+ *          non-blocking trylock, and extrapolates in between from
+ *          CLOCK_MONOTONIC_RAW at the PHC's measured rate.
+ *
  *  Copyright:
  *      (c) 2026 B. Wynne
  *
@@ -39,6 +57,7 @@
 #include <time.h>
 #include <errno.h>
 #include <pthread.h>
+#include <stdatomic.h>
 #include <stdint.h>
 #include <limits.h>
 
@@ -62,9 +81,12 @@
 /* Nanoseconds per second */
 #define NS_PER_SEC 1000000000ULL
 
-/* Maximum safe sample_delta before overflow risk in ns calculation */
-/* INT64_MAX / NS_PER_SEC = ~9.2e9 samples (~53 hours at 48kHz) */
-#define MAX_SAFE_SAMPLE_DELTA ((int64_t)(INT64_MAX / NS_PER_SEC))
+/* Move the unwrap reference once a timestamp is this far ahead of it */
+#define RTP_ANCHOR_ADVANCE (1 << 30)
+
+/* PHC rate estimate: baseline length and plausibility limit */
+#define PHC_RATE_BASELINE_NS NS_PER_SEC
+#define PHC_RATE_MAX_PPB 500000
 
 /* Internal PTP clock structure */
 struct audyn_ptp_clock {
@@ -73,18 +95,182 @@ struct audyn_ptp_clock {
     clockid_t clock_id;             /* Clock ID for clock_gettime() */
 
     /* Thread safety */
-    pthread_mutex_t lock;           /* Protects epoch and wraparound state */
+    pthread_mutex_t lock;           /* Serialises writers; readers after SEQ_READ_SPINS */
+
+    /* RTP epoch (seqlock) */
+    atomic_uint epoch_seq;          /* Odd while an update is in progress */
+    atomic_int epoch_set;           /* 1 if epoch has been established */
+    atomic_uint epoch_rtp_ts;       /* RTP timestamp at epoch */
+    _Atomic uint64_t epoch_ptp_ns;  /* PTP time at epoch */
+    atomic_uint epoch_sample_rate;  /* Sample rate for epoch */
+    _Atomic uint64_t anchor_samples; /* Unwrap reference, samples after epoch */
+
+    /* Cached PHC reads (hardware mode, seqlock) */
+    uint64_t phc_cache_ns;          /* Refresh interval (0 = read every call) */
+    atomic_uint phc_seq;
+    _Atomic uint64_t phc_ns;        /* PHC at the last read (0 = none yet) */
+    _Atomic uint64_t phc_raw_ns;    /* CLOCK_MONOTONIC_RAW at that read */
+    _Atomic int64_t phc_rate_ppb;   /* PHC rate relative to the raw clock */
+    uint64_t base_phc_ns;           /* Writer: rate baseline */
+    uint64_t base_raw_ns;
+};
 
-    /* RTP epoch tracking */
-    int epoch_set;                  /* 1 if epoch has been established */
-    uint32_t epoch_rtp_ts;          /* RTP timestamp at epoch */
-    uint64_t epoch_ptp_ns;          /* PTP time at epoch */
-    uint32_t epoch_sample_rate;     /* Sample rate for epoch */
+/* -------- Seqlock -------- */
 
-    /* RTP timestamp wraparound handling */
-    uint32_t last_rtp_ts;           /* Last seen RTP timestamp */
-    uint64_t rtp_wraparound_count;  /* Number of 32-bit wraparounds */
-};
+/* Odd-sequence polls before a reader falls back to 'lock' */
+#define SEQ_READ_SPINS 1000
+
+static inline void seq_write_begin(atomic_uint *seq)
+{
+    unsigned s = atomic_load_explicit(seq, memory_order_relaxed);
+    atomic_store_explicit(seq, s + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+}
+
+static inline void seq_write_end(atomic_uint *seq)
+{
+    unsigned s = atomic_load_explicit(seq, memory_order_relaxed);
+    atomic_store_explicit(seq, s + 1, memory_order_release);
+}
+
+/*
+ * Returns 0 with the even start sequence, or -1 if a writer is still
+ * mid-update after SEQ_READ_SPINS polls; the caller then reads under
+ * 'lock', which every writer holds for its whole update.
+ */
+static inline int seq_read_begin(const atomic_uint *seq, unsigned *start)
+{
+    for (unsigned i = 0; i < SEQ_READ_SPINS; i++) {
+        const unsigned s = atomic_load_explicit(seq, memory_order_acquire);
+        if (!(s & 1u)) {
+            *start = s;
+            return 0;
+        }
+    }
+    return -1;
+}
+
+static inline int seq_read_retry(const atomic_uint *seq, unsigned start)
+{
+    atomic_thread_fence(memory_order_acquire);
+    return atomic_load_explicit(seq, memory_order_relaxed) != start;
+}
+
+#define RELAXED_LOAD(p) atomic_load_explicit((p), memory_order_relaxed)
+#define RELAXED_STORE(p, v) atomic_store_explicit((p), (v), memory_order_relaxed)
+
+/* -------- Clock reads -------- */
+
+static uint64_t timespec_ns(const struct timespec *ts)
+{
+    return (uint64_t)ts->tv_sec * NS_PER_SEC + (uint64_t)ts->tv_nsec;
+}
+
+static uint64_t raw_now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC_RAW, &ts);
+    return timespec_ns(&ts);
+}
+
+static int read_clock_ns(audyn_ptp_clock_t *clk, uint64_t *ns)
+{
+    struct timespec ts;
+    if (clock_gettime(clk->clock_id, &ts) != 0) {
+        LOG_ERROR("PTP: clock_gettime failed: %s", strerror(errno));
+        return -1;
+    }
+    *ns = timespec_ns(&ts);
+    return 0;
+}
+
+/*
+ * Read the PHC between two raw clock reads and publish the pair. Caller
+ * holds clk->lock. The rate is re-measured over at least
+ * PHC_RATE_BASELINE_NS; implausible rates (PHC steps) are discarded.
+ */
+static int phc_refresh(audyn_ptp_clock_t *clk, uint64_t *phc_out, uint64_t *raw_out)
+{
+    uint64_t phc;
+    const uint64_t raw_a = raw_now_ns();
+    if (read_clock_ns(clk, &phc) != 0) {
+        return -1;
+    }
+    const uint64_t raw_b = raw_now_ns();
+    const uint64_t raw = raw_a + (raw_b - raw_a) / 2;
+
+    int64_t ppb = RELAXED_LOAD(&clk->phc_rate_ppb);
+    if (clk->base_raw_ns == 0) {
+        clk->base_phc_ns = phc;
+        clk->base_raw_ns = raw;
+    } else if (raw - clk->base_raw_ns >= PHC_RATE_BASELINE_NS) {
+        const int64_t d_raw = (int64_t)(raw - clk->base_raw_ns);
+        const int64_t d_phc = (int64_t)(phc - clk->base_phc_ns);
+        const int64_t m = (int64_t)(((double)(d_phc - d_raw) * 1e9) / (double)d_raw);
+        if (m > -PHC_RATE_MAX_PPB && m < PHC_RATE_MAX_PPB) {
+            ppb = m;
+        }
+        clk->base_phc_ns = phc;
+        clk->base_raw_ns = raw;
+    }
+
+    seq_write_begin(&clk->phc_seq);
+    RELAXED_STORE(&clk->phc_ns, phc);
+    RELAXED_STORE(&clk->phc_raw_ns, raw);
+    RELAXED_STORE(&clk->phc_rate_ppb, ppb);
+    seq_write_end(&clk->phc_seq);
+
+    *phc_out = phc;
+    *raw_out = raw;
+    return 0;
+}
+
+/* Cached PHC time: last read extrapolated along the raw clock. */
+static int phc_cached_now_ns(audyn_ptp_clock_t *clk, uint64_t *ns)
+{
+    const uint64_t now_raw = raw_now_ns();
+    uint64_t phc, raw;
+    int64_t ppb;
+    unsigned seq = 0;
+    int locked = 0;
+
+    do {
+        if (seq_read_begin(&clk->phc_seq, &seq) != 0) {
+            pthread_mutex_lock(&clk->lock);
+            locked = 1;
+        }
+        phc = RELAXED_LOAD(&clk->phc_ns);
+        raw = RELAXED_LOAD(&clk->phc_raw_ns);
+        ppb = RELAXED_LOAD(&clk->phc_rate_ppb);
+    } while (!locked && seq_read_retry(&clk->phc_seq, seq));
+    if (locked) pthread_mutex_unlock(&clk->lock);
+
+    int64_t dt = (int64_t)(now_raw - raw);
+    if (phc == 0 || dt >= (int64_t)clk->phc_cache_ns) {
+        /* Stale: one caller refreshes, the rest extrapolate meanwhile */
+        if (pthread_mutex_trylock(&clk->lock) == 0) {
+            int ret = phc_refresh(clk, &phc, &raw);
+            pthread_mutex_unlock(&clk->lock);
+            if (ret != 0) {
+                return -1;
+            }
+            dt = (int64_t)(now_raw - raw);
+        } else if (phc == 0) {
+            return read_clock_ns(clk, ns);
+        }
+    }
+
+    *ns = (uint64_t)((int64_t)phc + dt + (int64_t)(((double)dt * (double)ppb) / 1e9));
+    return 0;
+}
+
+static int clock_now_ns(audyn_ptp_clock_t *clk, uint64_t *ns)
+{
+    if (clk->phc_cache_ns > 0) {
+        return phc_cached_now_ns(clk, ns);
+    }
+    return read_clock_ns(clk, ns);
+}
 
 /*
  * Create a PTP clock instance.
@@ -102,8 +288,14 @@ audyn_ptp_clock_t *audyn_ptp_clock_create(const audyn_ptp_cfg_t *cfg)
         return NULL;
     }
 
-    /* Initialize mutex */
-    if (pthread_mutex_init(&clk->lock, NULL) != 0) {
+    /* Initialize mutex: priority inheriting, since an RT reader can end
+     * up waiting on a writer (see seq_read_begin) */
+    pthread_mutexattr_t ma;
+    pthread_mutexattr_init(&ma);
+    (void)pthread_mutexattr_setprotocol(&ma, PTHREAD_PRIO_INHERIT);
+    const int mrc = pthread_mutex_init(&clk->lock, &ma);
+    pthread_mutexattr_destroy(&ma);
+    if (mrc != 0) {
         LOG_ERROR("PTP: Failed to initialize mutex");
         free(clk);
         return NULL;
@@ -111,7 +303,6 @@ audyn_ptp_clock_t *audyn_ptp_clock_create(const audyn_ptp_cfg_t *cfg)
 
     clk->mode = cfg->mode;
     clk->phc_fd = -1;
-    clk->epoch_set = 0;
 
     switch (cfg->mode) {
         case AUDYN_PTP_MODE_NONE:
@@ -177,6 +368,12 @@ audyn_ptp_clock_t *audyn_ptp_clock_create(const audyn_ptp_cfg_t *cfg)
             }
             LOG_DEBUG("PTP: PHC clock initial time: %ld.%09ld",
                       (long)ts.tv_sec, ts.tv_nsec);
+
+            if (cfg->phc_cache_ms > 0) {
+                clk->phc_cache_ns = (uint64_t)cfg->phc_cache_ms * 1000000ULL;
+                LOG_INFO("PTP: Cached PHC reads, refreshed every %u ms",
+                         cfg->phc_cache_ms);
+            }
         }
 #else
             LOG_ERROR("PTP: Hardware mode only supported on Linux");
@@ -223,13 +420,11 @@ uint64_t audyn_ptp_clock_now_ns(audyn_ptp_clock_t *clk)
         return 0;
     }
 
-    struct timespec ts;
-    if (clock_gettime(clk->clock_id, &ts) != 0) {
-        LOG_ERROR("PTP: clock_gettime failed: %s", strerror(errno));
+    uint64_t ns;
+    if (clock_now_ns(clk, &ns) != 0) {
         return 0;
     }
-
-    return (uint64_t)ts.tv_sec * NS_PER_SEC + (uint64_t)ts.tv_nsec;
+    return ns;
 }
 
 /*
@@ -241,14 +436,13 @@ int audyn_ptp_clock_gettime(audyn_ptp_clock_t *clk, uint64_t *sec, uint32_t *nse
         return -1;
     }
 
-    struct timespec ts;
-    if (clock_gettime(clk->clock_id, &ts) != 0) {
-        LOG_ERROR("PTP: clock_gettime failed: %s", strerror(errno));
+    uint64_t ns;
+    if (clock_now_ns(clk, &ns) != 0) {
         return -1;
     }
 
-    *sec = (uint64_t)ts.tv_sec;
-    *nsec = (uint32_t)ts.tv_nsec;
+    *sec = ns / NS_PER_SEC;
+    *nsec = (uint32_t)(ns % NS_PER_SEC);
     return 0;
 }
 
@@ -266,12 +460,13 @@ void audyn_ptp_set_rtp_epoch(audyn_ptp_clock_t *clk,
 
     pthread_mutex_lock(&clk->lock);
 
-    clk->epoch_rtp_ts = rtp_ts;
-    clk->epoch_ptp_ns = ptp_ns;
-    clk->epoch_sample_rate = sample_rate;
-    clk->last_rtp_ts = rtp_ts;
-    clk->rtp_wraparound_count = 0;
-    clk->epoch_set = 1;
+    seq_write_begin(&clk->epoch_seq);
+    RELAXED_STORE(&clk->epoch_rtp_ts, rtp_ts);
+    RELAXED_STORE(&clk->epoch_ptp_ns, ptp_ns);
+    RELAXED_STORE(&clk->epoch_sample_rate, sample_rate);
+    RELAXED_STORE(&clk->anchor_samples, 0);
+    RELAXED_STORE(&clk->epoch_set, 1);
+    seq_write_end(&clk->epoch_seq);
 
     pthread_mutex_unlock(&clk->lock);
 
@@ -279,11 +474,18 @@ void audyn_ptp_set_rtp_epoch(audyn_ptp_clock_t *clk,
               rtp_ts, (unsigned long)ptp_ns, sample_rate);
 }
 
+/* samples * 1e9 / rate without overflowing the product */
+static uint64_t samples_to_ns(uint64_t samples, uint32_t rate)
+{
+    return (samples / rate) * NS_PER_SEC + ((samples % rate) * NS_PER_SEC) / rate;
+}
+
 /*
  * Convert RTP timestamp to PTP nanoseconds.
  *
- * Handles 32-bit RTP timestamp wraparound by tracking wraparounds.
- * Thread-safe: acquires internal lock.
+ * The 32-bit timestamp is taken as the nearest extension of the unwrap
+ * reference, so reordered packets either side of a wrap map correctly.
+ * Lock-free: retries if the epoch changes underneath.
  */
 uint64_t audyn_ptp_rtp_to_ns(audyn_ptp_clock_t *clk,
                              uint32_t rtp_ts,
@@ -293,80 +495,64 @@ uint64_t audyn_ptp_rtp_to_ns(audyn_ptp_clock_t *clk,
         return 0;
     }
 
-    pthread_mutex_lock(&clk->lock);
-
-    if (!clk->epoch_set) {
+    int set;
+    uint32_t epoch_rtp, epoch_rate;
+    uint64_t epoch_ns, anchor;
+    unsigned seq = 0;
+    int locked = 0;
+
+    do {
+        if (seq_read_begin(&clk->epoch_seq, &seq) != 0) {
+            pthread_mutex_lock(&clk->lock);
+            locked = 1;
+            seq = atomic_load_explicit(&clk->epoch_seq, memory_order_relaxed);
+        }
+        set = RELAXED_LOAD(&clk->epoch_set);
+        epoch_rtp = RELAXED_LOAD(&clk->epoch_rtp_ts);
+        epoch_ns = RELAXED_LOAD(&clk->epoch_ptp_ns);
+        epoch_rate = RELAXED_LOAD(&clk->epoch_sample_rate);
+        anchor = RELAXED_LOAD(&clk->anchor_samples);
+    } while (!locked && seq_read_retry(&clk->epoch_seq, seq));
+    if (locked) pthread_mutex_unlock(&clk->lock);
+
+    if (!set) {
         /* No epoch set - can't convert */
         LOG_DEBUG("PTP: rtp_to_ns called but no epoch set");
-        pthread_mutex_unlock(&clk->lock);
         return 0;
     }
 
     /* Validate sample rate matches epoch */
-    if (sample_rate != clk->epoch_sample_rate) {
+    if (sample_rate != epoch_rate) {
         LOG_ERROR("PTP: Sample rate mismatch - epoch=%u, requested=%u",
-                  clk->epoch_sample_rate, sample_rate);
-        pthread_mutex_unlock(&clk->lock);
+                  epoch_rate, sample_rate);
         return 0;
     }
 
-    /* Detect RTP timestamp wraparound */
-    /* If the new timestamp is much smaller than the last one, assume wraparound */
-    if (rtp_ts < clk->last_rtp_ts && (clk->last_rtp_ts - rtp_ts) > 0x80000000U) {
-        clk->rtp_wraparound_count++;
-        LOG_DEBUG("PTP: RTP timestamp wraparound detected (count=%lu)",
-                  (unsigned long)clk->rtp_wraparound_count);
-    }
-    clk->last_rtp_ts = rtp_ts;
+    /* Samples from epoch: reference plus the signed 32-bit distance to it */
+    const int32_t d = (int32_t)(rtp_ts - (uint32_t)(epoch_rtp + (uint32_t)anchor));
+    const int64_t samples = (int64_t)anchor + d;
 
-    /* Calculate extended 64-bit RTP timestamp */
-    uint64_t extended_rtp = rtp_ts + (clk->rtp_wraparound_count << 32);
-
-    /* Calculate delta from epoch in samples */
-    int64_t sample_delta;
-    uint64_t extended_epoch = clk->epoch_rtp_ts;  /* Epoch is always in first period */
-
-    if (extended_rtp >= extended_epoch) {
-        sample_delta = (int64_t)(extended_rtp - extended_epoch);
-    } else {
-        /* This shouldn't happen if epoch is first packet, but handle it */
-        sample_delta = -(int64_t)(extended_epoch - extended_rtp);
-    }
-
-    /* Check for potential overflow before multiplication */
-    int64_t abs_sample_delta = sample_delta >= 0 ? sample_delta : -sample_delta;
-    if (abs_sample_delta > MAX_SAFE_SAMPLE_DELTA) {
-        LOG_ERROR("PTP: Sample delta too large (%ld), would overflow - resetting epoch",
-                  (long)sample_delta);
-        /* Reset epoch to current packet to recover */
-        clk->epoch_rtp_ts = rtp_ts;
-        clk->epoch_ptp_ns = audyn_ptp_clock_now_ns(clk);
-        clk->rtp_wraparound_count = 0;
-        clk->last_rtp_ts = rtp_ts;
+    if (d > RTP_ANCHOR_ADVANCE && pthread_mutex_trylock(&clk->lock) == 0) {
+        /* Only if no epoch change slipped in since the read above */
+        if (atomic_load_explicit(&clk->epoch_seq, memory_order_relaxed) == seq) {
+            seq_write_begin(&clk->epoch_seq);
+            RELAXED_STORE(&clk->anchor_samples, (uint64_t)samples);
+            seq_write_end(&clk->epoch_seq);
+        }
         pthread_mutex_unlock(&clk->lock);
-        return clk->epoch_ptp_ns;
     }
 
-    /* Convert sample delta to nanoseconds */
-    /* ns = samples * 1e9 / sample_rate */
-    int64_t ns_delta = (sample_delta * (int64_t)NS_PER_SEC) / (int64_t)sample_rate;
-
-    /* Apply delta to epoch PTP time */
-    uint64_t ptp_ns;
-    if (ns_delta >= 0) {
-        ptp_ns = clk->epoch_ptp_ns + (uint64_t)ns_delta;
-    } else {
-        if ((uint64_t)(-ns_delta) > clk->epoch_ptp_ns) {
-            /* Would go negative - shouldn't happen */
-            LOG_ERROR("PTP: rtp_to_ns resulted in negative time");
-            pthread_mutex_unlock(&clk->lock);
-            return 0;
-        }
-        ptp_ns = clk->epoch_ptp_ns - (uint64_t)(-ns_delta);
+    if (samples >= 0) {
+        return epoch_ns + samples_to_ns((uint64_t)samples, sample_rate);
     }
 
-    pthread_mutex_unlock(&clk->lock);
-    return ptp_ns;
+    /* Packet from before the epoch (reordering at start-up) */
+    const uint64_t back = samples_to_ns((uint64_t)(-samples), sample_rate);
+    if (back > epoch_ns) {
+        LOG_ERROR("PTP: rtp_to_ns resulted in negative time");
+        return 0;
+    }
+    return epoch_ns - back;
 }
 
 /*
@@ -15,6 +15,19 @@
  *      Thread Safety:
  *        - audyn_ptp_set_rtp_epoch() and audyn_ptp_rtp_to_ns() are thread-safe
  *        - Can be called from different threads (e.g., network receive and audio playout)
+ *        - Time reads and RTP conversion do not block while no update is
+ *          in progress: shared state is read under seqlocks, and writers
+ *          only ever trylock from them. A reader that finds an update
+ *          still running after a bounded spin waits on the (priority
+ *          inheriting) writer lock rather than spinning on, so an RT
+ *          reader cannot livelock against a preempted writer
+ *
+ *      Cached PHC reads (hardware mode, phc_cache_ms > 0):
+ *        Reading a PHC is a syscall on every call. With a cache interval
+ *        the PHC is read at most that often and time in between is
+ *        extrapolated from CLOCK_MONOTONIC_RAW at the PHC's rate measured
+ *        over the last second, trading a little accuracy (rate error
+ *        times the interval) for a vDSO read per call.
  *
  *  AES67 Timing:
  *      AES67 uses PTP (IEEE 1588) for synchronization. RTP timestamps in AES67 packets
@@ -58,6 +71,7 @@ typedef struct audyn_ptp_cfg {
     audyn_ptp_mode_t mode;
     const char *phc_device;     /* PHC device path, e.g., "/dev/ptp0" (hardware mode) */
     const char *interface;      /* Network interface for PHC discovery, e.g., "eth0" */
+    uint32_t phc_cache_ms;      /* Hardware: max PHC read interval (0 = every call) */
 } audyn_ptp_cfg_t;
 
 /* Opaque PTP clock handle */
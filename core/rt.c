@@ -0,0 +1,559 @@
+/*
+ *  Audyn — Professional Audio Capture & Archival Engine
+ *
+ *  File:
+ *      rt.c
+ *
+ *  Purpose:
+ *      Real-time mode (see rt.h).
+ *
+ *  Threads:
+ *      Settings are applied by the creator with pthread_setschedparam()
+ *      and pthread_setaffinity_np() rather than through creation
+ *      attributes: an explicit-sched attribute the kernel refuses would
+ *      fail pthread_create() itself, and doing it from the creator makes
+ *      the outcome known before report() runs.
+ *
+ *  Memory:
+ *      RT allocations are anonymous mappings. With huge pages requested a
+ *      MAP_HUGETLB mapping is tried first (reserved pool, system default
+ *      size) and a normal mapping with MADV_HUGEPAGE is the fallback. The
+ *      NUMA binding (MPOL_PREFERRED, moving any pages mlockall already
+ *      populated) is set before the region is touched. Every page is then
+ *      written once, so the first use on an RT thread never faults.
+ *
+ *  Dependencies:
+ *      - pthread, C11 atomics, Linux mmap/mbind
+ *      - Audyn: log
+ *
+ *  Copyright:
+ *      (c) 2026 B. Wynne
+ *
+ *  Author:
+ *      B. Wynne
+ *
+ *  License:
+ *      GPLv2 or later
+ */
+
+#define _GNU_SOURCE
+
+#include "rt.h"
+#include "log.h"
+
+#include <errno.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+
+/* Allocation header, keeps the payload cache-line aligned */
+#define RT_HDR 64u
+#define RT_ALIGN 64u
+
+/* linux/mempolicy.h, without depending on libnuma headers */
+#define RT_MPOL_PREFERRED 1
+#define RT_MPOL_MF_MOVE   (1 << 1)
+
+#define RT_MAX_NUMA_NODE 63
+
+enum { RT_MEM_HEAP = 0, RT_MEM_MAP = 1 };
+
+typedef struct rt_hdr {
+    size_t map_len;                 /* Mapping length (RT_MEM_MAP) */
+    uint32_t kind;
+} rt_hdr_t;
+
+typedef struct rt_role_state {
+    _Atomic uint32_t ok;
+    _Atomic uint32_t failed;
+    _Atomic int first_err;
+} rt_role_state_t;
+
+static int g_active = 0;
+static audyn_rt_cfg_t g_cfg;
+static size_t g_page = 4096;
+static size_t g_huge_page = 0;      /* 0 = no hugetlb size known */
+
+static int g_mlock_ok = 0;
+static int g_mlock_err = 0;
+
+static rt_role_state_t g_role[AUDYN_RT_ROLE_COUNT];
+
+static _Atomic uint64_t g_bytes_total = 0;
+static _Atomic uint64_t g_bytes_hugetlb = 0;
+static _Atomic uint64_t g_bytes_thp = 0;
+static _Atomic uint64_t g_bytes_small = 0;     /* Under one huge page: regular by design */
+static _Atomic uint64_t g_bytes_numa = 0;
+static _Atomic uint32_t g_numa_failed = 0;
+
+static const char *const k_role_names[AUDYN_RT_ROLE_COUNT] = { "rx", "worker", "encoder" };
+
+/* -------- Configuration -------- */
+
+void audyn_rt_cfg_defaults(audyn_rt_cfg_t *cfg)
+{
+    if (!cfg) return;
+    memset(cfg, 0, sizeof(*cfg));
+    cfg->role[AUDYN_RT_ROLE_RX].policy = AUDYN_RT_POLICY_FIFO;
+    cfg->role[AUDYN_RT_ROLE_RX].priority = 70;
+    cfg->role[AUDYN_RT_ROLE_WORKER].policy = AUDYN_RT_POLICY_FIFO;
+    cfg->role[AUDYN_RT_ROLE_WORKER].priority = 60;
+    cfg->role[AUDYN_RT_ROLE_ENCODER].policy = AUDYN_RT_POLICY_DEFAULT;
+    cfg->mlock = 1;
+    cfg->hugepages = 0;
+    cfg->numa_node = -1;
+}
+
+static int parse_uint(const char **s, unsigned long max, unsigned long *out)
+{
+    const char *p = *s;
+    unsigned long v = 0;
+
+    if (*p < '0' || *p > '9') return -1;
+    while (*p >= '0' && *p <= '9') {
+        v = v * 10u + (unsigned long)(*p - '0');
+        if (v > max) return -1;
+        p++;
+    }
+    *s = p;
+    *out = v;
+    return 0;
+}
+
+static int parse_cpu_list(const char *s, uint64_t *mask)
+{
+    uint64_t m[AUDYN_RT_MAX_CPUS / 64];
+    memset(m, 0, sizeof(m));
+
+    for (;;) {
+        unsigned long a, b;
+        if (parse_uint(&s, AUDYN_RT_MAX_CPUS - 1, &a) != 0) return -1;
+        b = a;
+        if (*s == '-') {
+            s++;
+            if (parse_uint(&s, AUDYN_RT_MAX_CPUS - 1, &b) != 0 || b < a) return -1;
+        }
+        for (unsigned long c = a; c <= b; c++) {
+            m[c / 64] |= 1ull << (c % 64);
+        }
+        if (*s == '\0') break;
+        if (*s != ',') return -1;
+        s++;
+    }
+
+    memcpy(mask, m, sizeof(m));
+    return 0;
+}
+
+int audyn_rt_parse_thread_spec(const char *spec, audyn_rt_thread_cfg_t *out)
+{
+    if (!spec || !out || !*spec) return -1;
+
+    audyn_rt_thread_cfg_t t = *out;
+    const char *p = spec;
+
+    size_t n = strcspn(p, ":@");
+    if (n > 0) {
+        if (n == 4 && !strncmp(p, "fifo", 4)) {
+            t.policy = AUDYN_RT_POLICY_FIFO;
+        } else if (n == 2 && !strncmp(p, "rr", 2)) {
+            t.policy = AUDYN_RT_POLICY_RR;
+        } else if (n == 5 && !strncmp(p, "other", 5)) {
+            t.policy = AUDYN_RT_POLICY_OTHER;
+            t.priority = 0;
+        } else {
+            return -1;
+        }
+        p += n;
+    }
+
+    if (*p == ':') {
+        unsigned long prio;
+        p++;
+        if (parse_uint(&p, 99, &prio) != 0) return -1;
+        t.priority = (int)prio;
+    }
+
+    if (*p == '@') {
+        if (parse_cpu_list(p + 1, t.cpus) != 0) return -1;
+    } else if (*p != '\0') {
+        return -1;
+    }
+
+    /* A bare "fifo"/"rr" on a role that had no priority gets a middle one */
+    if ((t.policy == AUDYN_RT_POLICY_FIFO || t.policy == AUDYN_RT_POLICY_RR) &&
+        t.priority == 0) {
+        t.priority = 50;
+    }
+
+    *out = t;
+    return 0;
+}
+
+int audyn_rt_nic_numa_node(const char *ifname)
+{
+    char path[128];
+    int node = -1;
+
+    if (!ifname || !*ifname || strchr(ifname, '/')) return -1;
+
+    snprintf(path, sizeof(path), "/sys/class/net/%s/device/numa_node", ifname);
+    FILE *f = fopen(path, "r");
+    if (!f) return -1;
+    if (fscanf(f, "%d", &node) != 1) node = -1;
+    fclose(f);
+
+    return node < 0 ? -1 : node;
+}
+
+static size_t read_huge_page_size(void)
+{
+    FILE *f = fopen("/proc/meminfo", "r");
+    char line[128];
+    size_t kib = 0;
+
+    if (!f) return 0;
+    while (fgets(line, sizeof(line), f)) {
+        unsigned long v;
+        if (sscanf(line, "Hugepagesize: %lu kB", &v) == 1) {
+            kib = (size_t)v;
+            break;
+        }
+    }
+    fclose(f);
+    return kib * 1024u;
+}
+
+/* -------- Init -------- */
+
+static int valid_thread_cfg(const audyn_rt_thread_cfg_t *t)
+{
+    switch (t->policy) {
+    case AUDYN_RT_POLICY_DEFAULT:
+    case AUDYN_RT_POLICY_OTHER:
+        return t->priority == 0;
+    case AUDYN_RT_POLICY_FIFO:
+    case AUDYN_RT_POLICY_RR:
+        return t->priority >= 1 && t->priority <= 99;
+    }
+    return 0;
+}
+
+int audyn_rt_init(const audyn_rt_cfg_t *cfg)
+{
+    if (!cfg) return -1;
+    if (g_active) {
+        LOG_ERROR("rt: already initialised");
+        return -1;
+    }
+
+    for (int r = 0; r < AUDYN_RT_ROLE_COUNT; r++) {
+        if (!valid_thread_cfg(&cfg->role[r])) {
+            LOG_ERROR("rt: %s threads: priority %d does not fit the policy",
+                      k_role_names[r], cfg->role[r].priority);
+            return -1;
+        }
+    }
+    if (cfg->numa_node > RT_MAX_NUMA_NODE) {
+        LOG_ERROR("rt: NUMA node %d out of range (0-%d)", cfg->numa_node, RT_MAX_NUMA_NODE);
+        return -1;
+    }
+
+    g_cfg = *cfg;
+
+    long ps = sysconf(_SC_PAGESIZE);
+    if (ps > 0) g_page = (size_t)ps;
+    if (cfg->hugepages) {
+        g_huge_page = read_huge_page_size();
+    }
+
+    if (cfg->mlock) {
+        if (mlockall(MCL_CURRENT | MCL_FUTURE) == 0) {
+            g_mlock_ok = 1;
+        } else {
+            g_mlock_err = errno;
+        }
+    }
+
+    g_active = 1;
+    LOG_INFO("rt: real-time mode on");
+    return 0;
+}
+
+/* -------- Threads -------- */
+
+static int has_cpus(const audyn_rt_thread_cfg_t *t)
+{
+    for (size_t i = 0; i < AUDYN_RT_MAX_CPUS / 64; i++) {
+        if (t->cpus[i]) return 1;
+    }
+    return 0;
+}
+
+static int sched_policy_of(audyn_rt_policy_t p)
+{
+    switch (p) {
+    case AUDYN_RT_POLICY_FIFO: return SCHED_FIFO;
+    case AUDYN_RT_POLICY_RR:   return SCHED_RR;
+    default:                   return SCHED_OTHER;
+    }
+}
+
+static const char *policy_name(audyn_rt_policy_t p)
+{
+    switch (p) {
+    case AUDYN_RT_POLICY_FIFO:  return "SCHED_FIFO";
+    case AUDYN_RT_POLICY_RR:    return "SCHED_RR";
+    case AUDYN_RT_POLICY_OTHER: return "SCHED_OTHER";
+    default:                    return "inherited";
+    }
+}
+
+int audyn_rt_thread(pthread_t thread, audyn_rt_role_t role)
+{
+    if (!g_active || role < 0 || role >= AUDYN_RT_ROLE_COUNT) return 0;
+
+    const audyn_rt_thread_cfg_t *t = &g_cfg.role[role];
+    const int want_cpus = has_cpus(t);
+    if (t->policy == AUDYN_RT_POLICY_DEFAULT && !want_cpus) return 0;
+
+    int err = 0;
+
+    if (t->policy != AUDYN_RT_POLICY_DEFAULT) {
+        struct sched_param sp;
+        memset(&sp, 0, sizeof(sp));
+        sp.sched_priority = t->priority;
+        err = pthread_setschedparam(thread, sched_policy_of(t->policy), &sp);
+    }
+
+    if (err == 0 && want_cpus) {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        for (int c = 0; c < AUDYN_RT_MAX_CPUS && c < CPU_SETSIZE; c++) {
+            if (t->cpus[c / 64] & (1ull << (c % 64))) CPU_SET(c, &set);
+        }
+        err = pthread_setaffinity_np(thread, sizeof(set), &set);
+    }
+
+    rt_role_state_t *st = &g_role[role];
+    if (err == 0) {
+        atomic_fetch_add_explicit(&st->ok, 1, memory_order_relaxed);
+        return 0;
+    }
+
+    if (atomic_fetch_add_explicit(&st->failed, 1, memory_order_relaxed) == 0) {
+        atomic_store_explicit(&st->first_err, err, memory_order_relaxed);
+        LOG_WARN("rt: %s thread: %s%s not applied: %s", k_role_names[role],
+                 policy_name(t->policy), want_cpus ? " / affinity" : "", strerror(err));
+    }
+    return -1;
+}
+
+/* -------- Memory -------- */
+
+static size_t round_up(size_t v, size_t to)
+{
+    return (v + to - 1) / to * to;
+}
+
+static void bind_node(void *addr, size_t len)
+{
+    unsigned long mask = 1ul << g_cfg.numa_node;
+
+    if (syscall(SYS_mbind, addr, len, RT_MPOL_PREFERRED, &mask,
+                (unsigned long)(sizeof(mask) * 8u + 1u), RT_MPOL_MF_MOVE) == 0) {
+        atomic_fetch_add_explicit(&g_bytes_numa, len, memory_order_relaxed);
+    } else if (atomic_fetch_add_explicit(&g_numa_failed, 1, memory_order_relaxed) == 0) {
+        LOG_WARN("rt: mbind(node %d) failed: %s", g_cfg.numa_node, strerror(errno));
+    }
+}
+
+static void *map_region(size_t need, size_t *len_out)
+{
+    void *p = MAP_FAILED;
+    size_t len = 0;
+
+    /* Huge pages only for allocations that fill one: queue headers, slot
+     * rings and pool index arrays would each pin a whole reserved page */
+    const int small = g_cfg.hugepages && g_huge_page > 0 && need < g_huge_page;
+
+    if (g_cfg.hugepages && g_huge_page > 0 && !small) {
+        len = round_up(need, g_huge_page);
+        p = mmap(NULL, len, PROT_READ | PROT_WRITE,
+                 MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        if (p != MAP_FAILED) {
+            atomic_fetch_add_explicit(&g_bytes_hugetlb, len, memory_order_relaxed);
+        }
+    }
+
+    if (p == MAP_FAILED) {
+        len = round_up(need, g_page);
+        p = mmap(NULL, len, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (p == MAP_FAILED) return NULL;
+        if (small) {
+            atomic_fetch_add_explicit(&g_bytes_small, len, memory_order_relaxed);
+        }
+#ifdef MADV_HUGEPAGE
+        if (g_cfg.hugepages && !small && madvise(p, len, MADV_HUGEPAGE) == 0) {
+            atomic_fetch_add_explicit(&g_bytes_thp, len, memory_order_relaxed);
+        }
+#endif
+    }
+
+    if (g_cfg.numa_node >= 0) bind_node(p, len);
+
+    /* Pre-fault: one write per page (the mapping is already zero) */
+    for (size_t off = 0; off < len; off += g_page) {
+        ((volatile uint8_t *)p)[off] = 0;
+    }
+
+    atomic_fetch_add_explicit(&g_bytes_total, len, memory_order_relaxed);
+    *len_out = len;
+    return p;
+}
+
+void *audyn_rt_alloc(size_t bytes)
+{
+    if (bytes > SIZE_MAX - 2 * RT_HDR) return NULL;
+    const size_t need = round_up(RT_HDR + bytes, RT_ALIGN);
+
+    uint8_t *base;
+    rt_hdr_t h;
+
+    if (g_active) {
+        size_t len = 0;
+        base = (uint8_t *)map_region(need, &len);
+        if (!base) return NULL;
+        h.map_len = len;
+        h.kind = RT_MEM_MAP;
+    } else {
+        base = (uint8_t *)aligned_alloc(RT_ALIGN, need);
+        if (!base) return NULL;
+        memset(base, 0, need);    /* Zero and fault in */
+        h.map_len = 0;
+        h.kind = RT_MEM_HEAP;
+    }
+
+    memcpy(base, &h, sizeof(h));
+    return base + RT_HDR;
+}
+
+void audyn_rt_free(void *p)
+{
+    if (!p) return;
+
+    uint8_t *base = (uint8_t *)p - RT_HDR;
+    rt_hdr_t h;
+    memcpy(&h, base, sizeof(h));
+
+    if (h.kind == RT_MEM_MAP) {
+        munmap(base, h.map_len);
+    } else {
+        free(base);
+    }
+}
+
+/* -------- Report -------- */
+
+static void format_cpus(const uint64_t *mask, char *buf, size_t len)
+{
+    size_t pos = 0;
+    int c = 0;
+
+    buf[0] = '\0';
+    while (c < AUDYN_RT_MAX_CPUS) {
+        if (!(mask[c / 64] & (1ull << (c % 64)))) { c++; continue; }
+        int e = c;
+        while (e + 1 < AUDYN_RT_MAX_CPUS && (mask[(e + 1) / 64] & (1ull << ((e + 1) % 64)))) e++;
+        int n = (e > c)
+            ? snprintf(buf + pos, len - pos, "%s%d-%d", pos ? "," : "", c, e)
+            : snprintf(buf + pos, len - pos, "%s%d", pos ? "," : "", c);
+        if (n < 0 || (size_t)n >= len - pos) break;
+        pos += (size_t)n;
+        c = e + 1;
+    }
+}
+
+int audyn_rt_report(void)
+{
+    int missed = 0;
+
+    if (!g_active) return 0;
+
+    if (g_cfg.mlock) {
+        if (g_mlock_ok) {
+            LOG_INFO("rt: memory locked (mlockall current + future)");
+        } else {
+            LOG_WARN("rt: mlockall failed: %s (needs CAP_IPC_LOCK or RLIMIT_MEMLOCK)",
+                     strerror(g_mlock_err));
+            missed++;
+        }
+    }
+
+    const uint64_t total = atomic_load_explicit(&g_bytes_total, memory_order_relaxed);
+    const uint64_t huge = atomic_load_explicit(&g_bytes_hugetlb, memory_order_relaxed);
+    const uint64_t thp = atomic_load_explicit(&g_bytes_thp, memory_order_relaxed);
+    const uint64_t small = atomic_load_explicit(&g_bytes_small, memory_order_relaxed);
+    LOG_INFO("rt: pool memory %llu KiB pre-faulted", (unsigned long long)(total / 1024u));
+
+    if (g_cfg.hugepages) {
+        if (huge == total - small) {
+            LOG_INFO("rt: huge pages: %llu KiB on %zu KiB pages, %llu KiB of small "
+                     "allocations on regular pages",
+                     (unsigned long long)(huge / 1024u), g_huge_page / 1024u,
+                     (unsigned long long)(small / 1024u));
+        } else {
+            LOG_WARN("rt: huge pages: %llu KiB reserved, %llu KiB transparent (advised only), "
+                     "%llu KiB regular (%llu KiB of it small allocations)",
+                     (unsigned long long)(huge / 1024u), (unsigned long long)(thp / 1024u),
+                     (unsigned long long)((total - huge - thp) / 1024u),
+                     (unsigned long long)(small / 1024u));
+            missed++;
+        }
+    }
+
+    if (g_cfg.numa_node >= 0) {
+        const uint64_t bound = atomic_load_explicit(&g_bytes_numa, memory_order_relaxed);
+        if (atomic_load_explicit(&g_numa_failed, memory_order_relaxed) == 0) {
+            LOG_INFO("rt: NUMA: %llu KiB preferred on node %d",
+                     (unsigned long long)(bound / 1024u), g_cfg.numa_node);
+        } else {
+            LOG_WARN("rt: NUMA: only %llu of %llu KiB bound to node %d",
+                     (unsigned long long)(bound / 1024u), (unsigned long long)(total / 1024u),
+                     g_cfg.numa_node);
+            missed++;
+        }
+    }
+
+    for (int r = 0; r < AUDYN_RT_ROLE_COUNT; r++) {
+        const audyn_rt_thread_cfg_t *t = &g_cfg.role[r];
+        const uint32_t ok = atomic_load_explicit(&g_role[r].ok, memory_order_relaxed);
+        const uint32_t failed = atomic_load_explicit(&g_role[r].failed, memory_order_relaxed);
+        char cpus[128];
+
+        if (t->policy == AUDYN_RT_POLICY_DEFAULT && !has_cpus(t)) continue;
+        if (ok + failed == 0) continue;     /* No thread of this role */
+
+        format_cpus(t->cpus, cpus, sizeof(cpus));
+        if (failed == 0) {
+            LOG_INFO("rt: %s threads: %u/%u %s prio %d, cpus %s", k_role_names[r],
+                     ok, ok, policy_name(t->policy), t->priority, cpus[0] ? cpus : "any");
+        } else {
+            LOG_WARN("rt: %s threads: %u/%u %s prio %d, cpus %s (%s)", k_role_names[r],
+                     ok, ok + failed, policy_name(t->policy), t->priority,
+                     cpus[0] ? cpus : "any",
+                     strerror(atomic_load_explicit(&g_role[r].first_err, memory_order_relaxed)));
+            missed++;
+        }
+    }
+
+    if (missed > 0) {
+        LOG_WARN("rt: %d requested guarantee%s not obtained", missed, missed == 1 ? "" : "s");
+    }
+    return missed;
+}
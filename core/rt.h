@@ -0,0 +1,133 @@
+/*
+ *  Audyn — Professional Audio Capture & Archival Engine
+ *
+ *  File:
+ *      rt.h
+ *
+ *  Purpose:
+ *      Optional real-time mode: scheduling policy, priority and CPU
+ *      affinity per thread role, mlockall(), and pre-faulted (optionally
+ *      huge-page, NUMA-local) memory for the frame pools and queues.
+ *
+ *  Roles:
+ *      - RX:      packet receive (aes_input legs, aes_mux, PipeWire)
+ *      - WORKER:  capture workers (queue drain, metering, sink writes)
+ *      - ENCODER: Opus encoder pool
+ *      Setup helpers (sink helper, file writer, SAP, logging) keep the
+ *      default policy: they do blocking I/O.
+ *
+ *  Usage:
+ *      audyn_rt_init() once, before pools are allocated and threads
+ *      started. Modules call audyn_rt_thread() on each thread they create
+ *      and allocate pool memory with audyn_rt_alloc(). Both work without
+ *      init() (plain memory, no thread changes). audyn_rt_report() logs
+ *      what was requested and what the kernel granted.
+ *
+ *  Degradation:
+ *      Every guarantee is best effort: a missing capability (CAP_SYS_NICE,
+ *      CAP_IPC_LOCK, reserved huge pages, NUMA) is logged and counted, and
+ *      the request carries on without it. report() returns the count so
+ *      the caller can make misses fatal.
+ *
+ *  Threading:
+ *      - init() before any other thread exists
+ *      - thread()/alloc()/free() from any thread
+ *
+ *  Copyright:
+ *      (c) 2026 B. Wynne
+ *
+ *  Author:
+ *      B. Wynne
+ *
+ *  License:
+ *      GPLv2 or later
+ */
+
+#ifndef AUDYN_RT_H
+#define AUDYN_RT_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <pthread.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define AUDYN_RT_MAX_CPUS 256
+
+typedef enum audyn_rt_role {
+    AUDYN_RT_ROLE_RX = 0,
+    AUDYN_RT_ROLE_WORKER,
+    AUDYN_RT_ROLE_ENCODER,
+    AUDYN_RT_ROLE_COUNT
+} audyn_rt_role_t;
+
+typedef enum audyn_rt_policy {
+    AUDYN_RT_POLICY_DEFAULT = 0,    /* Leave as inherited */
+    AUDYN_RT_POLICY_OTHER,
+    AUDYN_RT_POLICY_FIFO,
+    AUDYN_RT_POLICY_RR
+} audyn_rt_policy_t;
+
+typedef struct audyn_rt_thread_cfg {
+    audyn_rt_policy_t policy;
+    int priority;                   /* 1-99 for FIFO/RR */
+    uint64_t cpus[AUDYN_RT_MAX_CPUS / 64];  /* Affinity mask, all zero = any */
+} audyn_rt_thread_cfg_t;
+
+typedef struct audyn_rt_cfg {
+    audyn_rt_thread_cfg_t role[AUDYN_RT_ROLE_COUNT];
+    int mlock;                      /* mlockall(MCL_CURRENT | MCL_FUTURE) */
+    int hugepages;                  /* Back pool memory with huge pages */
+    int numa_node;                  /* Bind pool memory to node, -1 = no */
+} audyn_rt_cfg_t;
+
+/* Defaults for --rt: mlock, RX FIFO 70, WORKER FIFO 60, ENCODER inherited. */
+void audyn_rt_cfg_defaults(audyn_rt_cfg_t *cfg);
+
+/*
+ * Parse a thread spec "[fifo|rr|other][:<prio>][@<cpu list>]", e.g.
+ * "fifo:80@2", "@4-7", "rr:50@0,2". Parts left out keep their value.
+ * Returns 0 on success, -1 on a malformed spec.
+ */
+int audyn_rt_parse_thread_spec(const char *spec, audyn_rt_thread_cfg_t *out);
+
+/* NUMA node of a network interface's device, or -1 if unknown. */
+int audyn_rt_nic_numa_node(const char *ifname);
+
+/*
+ * Enter RT mode (mlockall now; threads and allocations follow cfg).
+ * Returns 0, or -1 on invalid cfg (logged). Unobtained guarantees are
+ * not errors here: see report(). NOT real-time safe.
+ */
+int audyn_rt_init(const audyn_rt_cfg_t *cfg);
+
+/*
+ * Apply the role's policy, priority and affinity to a thread (normally
+ * straight after pthread_create). No-op without init(). Returns 0 if the
+ * role's settings were all applied, -1 otherwise (logged once per role).
+ */
+int audyn_rt_thread(pthread_t thread, audyn_rt_role_t role);
+
+/*
+ * Allocate zeroed, pre-faulted, 64-byte aligned memory. In RT mode it is
+ * mapped directly (NUMA binding as configured; huge pages for allocations
+ * of at least one huge page, smaller ones stay on regular pages so they
+ * do not each take a reserved page); otherwise it comes from the heap. Release with audyn_rt_free(). NOT real-time safe.
+ */
+void *audyn_rt_alloc(size_t bytes);
+void audyn_rt_free(void *p);
+
+/*
+ * Log the guarantees obtained so far (memory lock, page backing, NUMA,
+ * per-role threads). Returns the number of requested guarantees that
+ * were not obtained (0 when RT mode is off).
+ */
+int audyn_rt_report(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* AUDYN_RT_H */
@@ -7,6 +7,14 @@
  *  Purpose:
  *      SAP (Session Announcement Protocol) listener implementation.
  *
+ *  Directory:
+ *      The receive thread owns the hash index and live list under 'lock'
+ *      and parses SDP outside it. After a change it publishes a new
+ *      snapshot (pointers to shared, refcounted nodes plus a copy of the
+ *      change log); readers only take 'snap_lock' to grab a reference.
+ *      Changes within SAP_PUBLISH_INTERVAL_MS of the last rebuild are left
+ *      pending, and the listener publishes them when the interval ends.
+ *
  *  Copyright:
  *      (c) 2026 B. Wynne
  *
@@ -24,6 +32,9 @@
 #include <unistd.h>
 #include <errno.h>
 #include <pthread.h>
+#include <stdatomic.h>
+#include <strings.h>
+#include <time.h>
 #include <sys/socket.h>
 #include <netinet/in.h>
 #include <arpa/inet.h>
@@ -67,12 +78,42 @@
 #define SAP_MIN_PACKET_SIZE 8   /* Minimum SAP header + IPv4 source */
 #define SAP_MAX_PACKET_SIZE 8192
 
+/* -------- Directory nodes and snapshots -------- */
+
+/*
+ * A published entry. Immutable once it is in a snapshot; a change
+ * replaces the node. Shared by every snapshot that lists it.
+ */
+typedef struct sap_node {
+    atomic_int          refs;
+    int                 live_idx;   /* Writer: position in live[] */
+    time_t              seen;       /* Writer: last announcement (expiry) */
+    sap_stream_entry_t  e;
+} sap_node_t;
+
+struct sap_snapshot {
+    atomic_int      refs;
+    uint64_t        generation;
+    int             count;
+    sap_node_t    **nodes;
+    int             n_changes;
+    sap_change_t   *changes;        /* Oldest first */
+    sap_node_t    **change_nodes;   /* Refs backing changes[].stream */
+};
+
+typedef struct {
+    uint64_t        generation;
+    sap_event_t     event;
+    sap_node_t     *node;
+} sap_change_rec_t;
+
 struct sap_discovery {
     /* Configuration */
     char            bind_interface[64];
     char            multicast_addr[64];
     uint16_t        port;
     int             timeout_sec;
+    int             max_streams;
     sap_callback_fn callback;
     void           *callback_userdata;
 
@@ -82,11 +123,24 @@ struct sap_discovery {
     /* Thread */
     pthread_t       thread;
     volatile int    running;
-    pthread_mutex_t lock;
 
-    /* Stream database */
-    sap_stream_entry_t streams[SAP_MAX_STREAMS];
-    int             stream_count;
+    /* Directory (writer side): index, live list, change log, stats */
+    pthread_mutex_t lock;
+    sap_node_t    **index;          /* Open addressing, linear probe */
+    uint32_t        index_mask;
+    sap_node_t    **live;
+    int             live_count;
+    uint64_t        generation;
+    sap_change_rec_t changes[SAP_CHANGE_LOG];
+    int             change_count;
+    int             seen_dirty;     /* A live node's last_seen is stale */
+    int             publish_pending; /* Changes not in the published snapshot */
+    uint64_t        last_publish_ms; /* CLOCK_MONOTONIC of the last rebuild */
+
+    /* Published snapshot: snap_lock covers only the swap and ref grabs */
+    pthread_mutex_t snap_lock;
+    sap_snapshot_t *current;
+    _Atomic uint64_t published_generation;
 
     /* Statistics */
     sap_stats_t     stats;
@@ -103,39 +157,255 @@ static void set_error(sap_discovery_t *sap, const char *fmt, ...)
     va_end(ap);
 }
 
+static uint64_t monotonic_ms(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000u + (uint64_t)ts.tv_nsec / 1000000u;
+}
+
+static sap_node_t *node_new(const sap_stream_entry_t *e)
+{
+    sap_node_t *n = malloc(sizeof(*n));
+    if (!n) return NULL;
+    atomic_init(&n->refs, 1);
+    n->live_idx = -1;
+    n->seen = e->last_seen;
+    n->e = *e;
+    return n;
+}
+
+static sap_node_t *node_ref(sap_node_t *n)
+{
+    atomic_fetch_add_explicit(&n->refs, 1, memory_order_relaxed);
+    return n;
+}
+
+static void node_unref(sap_node_t *n)
+{
+    if (n && atomic_fetch_sub_explicit(&n->refs, 1, memory_order_acq_rel) == 1) {
+        free(n);
+    }
+}
+
+static void snapshot_free(sap_snapshot_t *s)
+{
+    for (int i = 0; i < s->count; i++) node_unref(s->nodes[i]);
+    for (int i = 0; i < s->n_changes; i++) node_unref(s->change_nodes[i]);
+    free(s);
+}
+
+/* -------- Hash index (writer side, under lock) -------- */
+
+/* FNV-1a over the SAP key: origin address text and message id hash */
+static uint32_t key_hash(const char *origin_ip, uint16_t msg_id_hash)
+{
+    uint32_t h = 2166136261u;
+    for (const char *p = origin_ip; *p; p++) {
+        h = (h ^ (uint8_t)*p) * 16777619u;
+    }
+    h = (h ^ (msg_id_hash & 0xff)) * 16777619u;
+    h = (h ^ (msg_id_hash >> 8)) * 16777619u;
+    return h;
+}
+
+static int key_match(const sap_node_t *n, const char *origin_ip, uint16_t msg_id_hash)
+{
+    return n->e.msg_id_hash == msg_id_hash && strcmp(n->e.origin_ip, origin_ip) == 0;
+}
+
+/* Slot holding the key, or -1 */
+static int index_find(const sap_discovery_t *sap, const char *origin_ip, uint16_t msg_id_hash)
+{
+    uint32_t i = key_hash(origin_ip, msg_id_hash) & sap->index_mask;
+    while (sap->index[i]) {
+        if (key_match(sap->index[i], origin_ip, msg_id_hash)) return (int)i;
+        i = (i + 1) & sap->index_mask;
+    }
+    return -1;
+}
+
+static void index_insert(sap_discovery_t *sap, sap_node_t *n)
+{
+    uint32_t i = key_hash(n->e.origin_ip, n->e.msg_id_hash) & sap->index_mask;
+    while (sap->index[i]) i = (i + 1) & sap->index_mask;
+    sap->index[i] = n;
+}
+
+/* Backward-shift delete: keeps probe chains intact without tombstones */
+static void index_remove_at(sap_discovery_t *sap, uint32_t hole)
+{
+    uint32_t i = hole;
+    sap->index[hole] = NULL;
+    for (;;) {
+        i = (i + 1) & sap->index_mask;
+        sap_node_t *n = sap->index[i];
+        if (!n) return;
+        uint32_t home = key_hash(n->e.origin_ip, n->e.msg_id_hash) & sap->index_mask;
+        /* Move n into the hole unless its home lies cyclically in (hole, i] */
+        if (((i - home) & sap->index_mask) >= ((i - hole) & sap->index_mask)) {
+            sap->index[hole] = n;
+            sap->index[i] = NULL;
+            hole = i;
+        }
+    }
+}
+
+/* -------- Directory changes (writer side, under lock) -------- */
+
+static void log_change(sap_discovery_t *sap, sap_event_t event, sap_node_t *n)
+{
+    /* Generation g lives in slot (g - 1) % SAP_CHANGE_LOG */
+    sap_change_rec_t *rec = &sap->changes[sap->generation % SAP_CHANGE_LOG];
+    sap->generation++;
+
+    if (sap->change_count < SAP_CHANGE_LOG) {
+        sap->change_count++;
+    } else {
+        node_unref(rec->node);      /* Oldest record */
+    }
+    rec->generation = sap->generation;
+    rec->event = event;
+    rec->node = node_ref(n);
+}
+
 /*
- * Find or create stream entry by origin IP and message ID hash.
+ * Build a snapshot of the live list and change log and swap it in.
+ * On allocation failure the previous snapshot stays published; the next
+ * publish includes everything.
  */
-static sap_stream_entry_t *find_or_create_entry(sap_discovery_t *sap,
-                                                 const char *origin_ip,
-                                                 uint16_t msg_id_hash,
-                                                 int *is_new)
-{
-    *is_new = 0;
-
-    /* First, try to find existing entry */
-    for (int i = 0; i < sap->stream_count; i++) {
-        if (sap->streams[i].active &&
-            sap->streams[i].msg_id_hash == msg_id_hash &&
-            strcmp(sap->streams[i].origin_ip, origin_ip) == 0) {
-            return &sap->streams[i];
-        }
+static void publish(sap_discovery_t *sap)
+{
+    const int n_changes = sap->change_count;
+    const size_t size = sizeof(sap_snapshot_t)
+                      + (size_t)sap->live_count * sizeof(sap_node_t *)
+                      + (size_t)n_changes * (sizeof(sap_change_t) + sizeof(sap_node_t *));
+
+    sap_snapshot_t *s = malloc(size);
+    if (!s) {
+        LOG_WARN("SAP: snapshot allocation failed");
+        sap->publish_pending = 1;
+        return;
+    }
+    sap->publish_pending = 0;
+    sap->last_publish_ms = monotonic_ms();
+    atomic_init(&s->refs, 1);
+    s->generation = sap->generation;
+    s->count = sap->live_count;
+    s->changes = (sap_change_t *)(s + 1);
+    s->change_nodes = (sap_node_t **)(s->changes + n_changes);
+    s->nodes = s->change_nodes + n_changes;
+    s->n_changes = n_changes;
+
+    for (int i = 0; i < s->count; i++) {
+        s->nodes[i] = node_ref(sap->live[i]);
     }
 
-    /* Not found - create new entry */
-    if (sap->stream_count >= SAP_MAX_STREAMS) {
-        /* Try to find an inactive slot */
-        for (int i = 0; i < SAP_MAX_STREAMS; i++) {
-            if (!sap->streams[i].active) {
-                *is_new = 1;
-                return &sap->streams[i];
-            }
+    const uint64_t first = sap->generation - (uint64_t)n_changes + 1;
+    for (int i = 0; i < n_changes; i++) {
+        const sap_change_rec_t *rec = &sap->changes[(first + (uint64_t)i - 1) % SAP_CHANGE_LOG];
+        s->changes[i].generation = rec->generation;
+        s->changes[i].event = rec->event;
+        s->changes[i].stream = &rec->node->e;
+        s->change_nodes[i] = node_ref(rec->node);
+    }
+
+    pthread_mutex_lock(&sap->snap_lock);
+    sap_snapshot_t *old = sap->current;
+    sap->current = s;
+    atomic_store_explicit(&sap->published_generation, s->generation, memory_order_release);
+    pthread_mutex_unlock(&sap->snap_lock);
+
+    sap_snapshot_release(old);
+}
+
+/* After a change: publish now, or leave it to the listener within the interval */
+static void publish_change(sap_discovery_t *sap)
+{
+    if (monotonic_ms() - sap->last_publish_ms >= SAP_PUBLISH_INTERVAL_MS) {
+        publish(sap);
+    } else {
+        sap->publish_pending = 1;
+    }
+}
+
+/*
+ * Listener: publish pending changes that are due. Returns the milliseconds
+ * until the rest are due, or -1 if nothing is pending.
+ */
+static int publish_pending_due(sap_discovery_t *sap)
+{
+    int ms = -1;
+
+    pthread_mutex_lock(&sap->lock);
+    if (sap->publish_pending) {
+        const uint64_t since = monotonic_ms() - sap->last_publish_ms;
+        if (since >= SAP_PUBLISH_INTERVAL_MS) {
+            publish(sap);
+        } else {
+            ms = (int)(SAP_PUBLISH_INTERVAL_MS - since);
         }
-        return NULL;  /* No room */
     }
+    /* An allocation failure leaves it pending: retry after an interval */
+    if (ms < 0 && sap->publish_pending) ms = SAP_PUBLISH_INTERVAL_MS;
+    pthread_mutex_unlock(&sap->lock);
+    return ms;
+}
+
+static void live_add(sap_discovery_t *sap, sap_node_t *n)
+{
+    n->live_idx = sap->live_count;
+    sap->live[sap->live_count++] = n;
+}
+
+static void live_remove(sap_discovery_t *sap, sap_node_t *n)
+{
+    sap_node_t *last = sap->live[--sap->live_count];
+    sap->live[n->live_idx] = last;
+    last->live_idx = n->live_idx;
+    n->live_idx = -1;
+}
 
-    *is_new = 1;
-    return &sap->streams[sap->stream_count++];
+/* Swap 'n' for its replacement in index and live list; drops the writer's ref on n */
+static void replace_node(sap_discovery_t *sap, uint32_t slot, sap_node_t *n, sap_node_t *repl)
+{
+    sap->index[slot] = repl;
+    repl->live_idx = n->live_idx;
+    sap->live[n->live_idx] = repl;
+    node_unref(n);
+}
+
+/*
+ * Remove the node at 'slot' and log its deletion.
+ * Returns a ref on the deleted entry (active = 0) for the callback, or NULL.
+ */
+static sap_node_t *delete_at(sap_discovery_t *sap, uint32_t slot)
+{
+    sap_node_t *n = sap->index[slot];
+
+    index_remove_at(sap, slot);
+    live_remove(sap, n);
+    sap->stats.active_streams--;
+
+    /* Deletion record: the last announced entry, inactive */
+    sap_node_t *gone = node_new(&n->e);
+    node_unref(n);
+    if (!gone) {
+        LOG_WARN("SAP: allocation failed, deletion not logged");
+        return NULL;
+    }
+    gone->e.active = 0;
+    log_change(sap, SAP_EVENT_DELETE, gone);
+    return gone;
+}
+
+static void notify(sap_discovery_t *sap, sap_event_t event, sap_node_t *n)
+{
+    if (!n) return;
+    if (sap->callback) {
+        sap->callback(event, &n->e, sap->callback_userdata);
+    }
+    node_unref(n);
 }
 
 /*
@@ -206,82 +476,106 @@ static void process_sap_packet(sap_discovery_t *sap, const uint8_t *data, size_t
         }
     }
 
-    pthread_mutex_lock(&sap->lock);
+    sap_node_t *notify_node = NULL;
+    sap_event_t event = SAP_EVENT_DELETE;
 
     if (is_delete) {
-        /* Handle deletion */
+        pthread_mutex_lock(&sap->lock);
         sap->stats.deletions++;
-        for (int i = 0; i < sap->stream_count; i++) {
-            if (sap->streams[i].active &&
-                sap->streams[i].msg_id_hash == msg_id_hash &&
-                strcmp(sap->streams[i].origin_ip, origin_ip) == 0) {
-
-                sap->streams[i].active = 0;
-                sap->stats.active_streams--;
-
-                if (sap->callback) {
-                    pthread_mutex_unlock(&sap->lock);
-                    sap->callback(SAP_EVENT_DELETE, &sap->streams[i], sap->callback_userdata);
-                    pthread_mutex_lock(&sap->lock);
-                }
-                break;
-            }
+        int slot = index_find(sap, origin_ip, msg_id_hash);
+        if (slot >= 0) {
+            notify_node = delete_at(sap, (uint32_t)slot);
+            publish_change(sap);
         }
-    } else {
-        /* Handle announcement */
-        sap->stats.announcements++;
+        pthread_mutex_unlock(&sap->lock);
 
-        int is_new = 0;
-        sap_stream_entry_t *entry = find_or_create_entry(sap, origin_ip, msg_id_hash, &is_new);
+        notify(sap, event, notify_node);
+        return;
+    }
 
-        if (!entry) {
-            pthread_mutex_unlock(&sap->lock);
-            return;
-        }
+    /* Handle announcement */
+    const size_t raw_max = sizeof(((sap_stream_entry_t *)0)->raw_sdp) - 1;
+    const size_t sdp_copy_len = payload_len < raw_max ? payload_len : raw_max;
+    time_t now = time(NULL);
 
-        /* Parse SDP */
-        sdp_stream_t sdp;
-        if (sdp_parse((const char *)payload, payload_len, &sdp) != 0) {
-            sap->stats.sdp_parse_errors++;
+    pthread_mutex_lock(&sap->lock);
+    sap->stats.announcements++;
+
+    /* Periodic re-announcement with the same SDP: refresh expiry only */
+    int slot = index_find(sap, origin_ip, msg_id_hash);
+    if (slot >= 0) {
+        sap_node_t *n = sap->index[slot];
+        if (strlen(n->e.raw_sdp) == sdp_copy_len &&
+            memcmp(n->e.raw_sdp, payload, sdp_copy_len) == 0) {
+            n->seen = now;
+            sap->seen_dirty = 1;
             pthread_mutex_unlock(&sap->lock);
             return;
         }
+    } else if (sap->live_count >= sap->max_streams) {
+        pthread_mutex_unlock(&sap->lock);
+        LOG_WARN("SAP: directory full (%d streams), ignoring %s", sap->max_streams, origin_ip);
+        return;
+    }
+    pthread_mutex_unlock(&sap->lock);
 
-        /* Update entry */
-        time_t now = time(NULL);
+    /* New or changed: parse without holding the directory */
+    sap_stream_entry_t entry;
+    memset(&entry, 0, sizeof(entry));
 
-        if (is_new) {
-            memset(entry, 0, sizeof(*entry));
-            entry->first_seen = now;
-            entry->msg_id_hash = msg_id_hash;
-            strncpy(entry->origin_ip, origin_ip, sizeof(entry->origin_ip) - 1);
-            sap->stats.active_streams++;
-        }
+    if (sdp_parse((const char *)payload, payload_len, &entry.sdp) != 0) {
+        pthread_mutex_lock(&sap->lock);
+        sap->stats.sdp_parse_errors++;
+        pthread_mutex_unlock(&sap->lock);
+        return;
+    }
+    entry.msg_id_hash = msg_id_hash;
+    strncpy(entry.origin_ip, origin_ip, sizeof(entry.origin_ip) - 1);
+    entry.first_seen = now;
+    entry.last_seen = now;
+    entry.active = 1;
+    memcpy(entry.raw_sdp, payload, sdp_copy_len);
+    entry.raw_sdp[sdp_copy_len] = '\0';
 
-        entry->sdp = sdp;
-        entry->last_seen = now;
-        entry->active = 1;
+    pthread_mutex_lock(&sap->lock);
 
-        /* Store raw SDP */
-        size_t sdp_copy_len = payload_len < sizeof(entry->raw_sdp) - 1 ?
-                              payload_len : sizeof(entry->raw_sdp) - 1;
-        memcpy(entry->raw_sdp, payload, sdp_copy_len);
-        entry->raw_sdp[sdp_copy_len] = '\0';
+    /* Look up again: sap_discovery_cleanup() may have run meanwhile */
+    slot = index_find(sap, origin_ip, msg_id_hash);
+    if (slot >= 0) {
+        entry.first_seen = sap->index[slot]->e.first_seen;
+    } else if (sap->live_count >= sap->max_streams) {
+        pthread_mutex_unlock(&sap->lock);
+        return;
+    }
 
-        sap_event_t event = is_new ? SAP_EVENT_NEW : SAP_EVENT_UPDATE;
+    sap_node_t *n = node_new(&entry);
+    if (!n) {
+        pthread_mutex_unlock(&sap->lock);
+        LOG_WARN("SAP: allocation failed, announcement from %s dropped", origin_ip);
+        return;
+    }
 
-        if (sap->callback) {
-            pthread_mutex_unlock(&sap->lock);
-            sap->callback(event, entry, sap->callback_userdata);
-            pthread_mutex_lock(&sap->lock);
-        }
+    if (slot >= 0) {
+        replace_node(sap, (uint32_t)slot, sap->index[slot], n);
+        event = SAP_EVENT_UPDATE;
+    } else {
+        index_insert(sap, n);
+        live_add(sap, n);
+        sap->stats.active_streams++;
+        event = SAP_EVENT_NEW;
     }
+    log_change(sap, event, n);
+    publish_change(sap);
+    notify_node = node_ref(n);
 
     pthread_mutex_unlock(&sap->lock);
+
+    notify(sap, event, notify_node);
 }
 
 /*
- * Cleanup expired streams.
+ * Cleanup expired streams, and bring last_seen in published entries up
+ * to date for streams that are still being announced.
  */
 static void cleanup_expired(sap_discovery_t *sap)
 {
@@ -290,20 +584,43 @@ static void cleanup_expired(sap_discovery_t *sap)
 
     pthread_mutex_lock(&sap->lock);
 
-    for (int i = 0; i < sap->stream_count; i++) {
-        if (sap->streams[i].active && sap->streams[i].last_seen < cutoff) {
-            sap->streams[i].active = 0;
-            sap->stats.active_streams--;
+    sap_node_t **gone = malloc((size_t)(sap->live_count ? sap->live_count : 1) * sizeof(*gone));
+    int n_gone = 0;
+    int changed = 0;
+
+    for (int i = 0; i < sap->live_count; ) {
+        sap_node_t *n = sap->live[i];
 
-            if (sap->callback) {
-                pthread_mutex_unlock(&sap->lock);
-                sap->callback(SAP_EVENT_DELETE, &sap->streams[i], sap->callback_userdata);
-                pthread_mutex_lock(&sap->lock);
+        if (n->seen < cutoff) {
+            /* delete_at() moves the last live node into slot i */
+            sap_node_t *g = delete_at(sap, (uint32_t)index_find(sap, n->e.origin_ip, n->e.msg_id_hash));
+            if (g && gone) gone[n_gone++] = g;
+            else node_unref(g);
+            changed = 1;
+            continue;
+        }
+
+        if (sap->seen_dirty && n->seen != n->e.last_seen) {
+            sap_node_t *r = node_new(&n->e);
+            if (r) {
+                r->e.last_seen = n->seen;
+                r->seen = n->seen;
+                replace_node(sap, (uint32_t)index_find(sap, n->e.origin_ip, n->e.msg_id_hash), n, r);
+                changed = 1;
             }
         }
+        i++;
     }
+    sap->seen_dirty = 0;
+
+    if (changed) publish(sap);
 
     pthread_mutex_unlock(&sap->lock);
+
+    for (int i = 0; i < n_gone; i++) {
+        notify(sap, SAP_EVENT_DELETE, gone[i]);
+    }
+    free(gone);
 }
 
 /*
@@ -324,7 +641,13 @@ static void *listener_thread(void *arg)
         FD_ZERO(&fds);
         FD_SET(sap->sock, &fds);
 
+        /* Wake for pending changes, else once a second */
         struct timeval tv = { .tv_sec = 1, .tv_usec = 0 };
+        const int due_ms = publish_pending_due(sap);
+        if (due_ms >= 0) {
+            tv.tv_sec = 0;
+            tv.tv_usec = due_ms * 1000;
+        }
 
         int ret = select(sap->sock + 1, &fds, NULL, NULL, &tv);
 
@@ -375,13 +698,36 @@ sap_discovery_t *sap_discovery_create(const sap_discovery_cfg_t *cfg)
         sap->timeout_sec = cfg->timeout_sec > 0 ? cfg->timeout_sec : SAP_STREAM_TIMEOUT;
         sap->callback = cfg->callback;
         sap->callback_userdata = cfg->callback_userdata;
+        sap->max_streams = cfg->max_streams > 0 ? cfg->max_streams : SAP_MAX_STREAMS;
     } else {
         strncpy(sap->multicast_addr, SAP_ADDR_GLOBAL, sizeof(sap->multicast_addr) - 1);
         sap->port = SAP_PORT;
         sap->timeout_sec = SAP_STREAM_TIMEOUT;
+        sap->max_streams = SAP_MAX_STREAMS;
+    }
+
+    /* Index at most half full keeps probe chains short */
+    uint32_t slots = 2;
+    while (slots < 2u * (uint32_t)sap->max_streams) slots <<= 1;
+    sap->index = calloc(slots, sizeof(*sap->index));
+    sap->index_mask = slots - 1;
+    sap->live = calloc((size_t)sap->max_streams, sizeof(*sap->live));
+    if (!sap->index || !sap->live) {
+        free(sap->index);
+        free(sap->live);
+        free(sap);
+        return NULL;
     }
 
     pthread_mutex_init(&sap->lock, NULL);
+    pthread_mutex_init(&sap->snap_lock, NULL);
+
+    /* Readers always find a snapshot, empty until the first announcement */
+    publish(sap);
+    if (!sap->current) {
+        sap_discovery_destroy(sap);
+        return NULL;
+    }
 
     return sap;
 }
@@ -469,6 +815,11 @@ void sap_discovery_stop(sap_discovery_t *sap)
     sap->running = 0;
     pthread_join(sap->thread, NULL);
 
+    /* Readers keep the final directory */
+    pthread_mutex_lock(&sap->lock);
+    if (sap->publish_pending) publish(sap);
+    pthread_mutex_unlock(&sap->lock);
+
     if (sap->sock >= 0) {
         close(sap->sock);
         sap->sock = -1;
@@ -480,6 +831,14 @@ void sap_discovery_destroy(sap_discovery_t *sap)
     if (!sap) return;
 
     sap_discovery_stop(sap);
+
+    sap_snapshot_release(sap->current);
+    for (int i = 0; i < sap->live_count; i++) node_unref(sap->live[i]);
+    for (int i = 0; i < sap->change_count; i++) node_unref(sap->changes[i].node);
+    free(sap->index);
+    free(sap->live);
+
+    pthread_mutex_destroy(&sap->snap_lock);
     pthread_mutex_destroy(&sap->lock);
     free(sap);
 }
@@ -489,10 +848,70 @@ int sap_discovery_is_running(const sap_discovery_t *sap)
     return sap ? sap->running : 0;
 }
 
-int sap_discovery_count(const sap_discovery_t *sap)
+/* -------- Readers -------- */
+
+const sap_snapshot_t *sap_discovery_snapshot(const sap_discovery_t *sap)
+{
+    if (!sap) return NULL;
+
+    sap_discovery_t *w = (sap_discovery_t *)sap;
+    pthread_mutex_lock(&w->snap_lock);
+    sap_snapshot_t *s = w->current;
+    if (s) atomic_fetch_add_explicit(&s->refs, 1, memory_order_relaxed);
+    pthread_mutex_unlock(&w->snap_lock);
+    return s;
+}
+
+void sap_snapshot_release(const sap_snapshot_t *snap)
+{
+    sap_snapshot_t *s = (sap_snapshot_t *)snap;
+    if (s && atomic_fetch_sub_explicit(&s->refs, 1, memory_order_acq_rel) == 1) {
+        snapshot_free(s);
+    }
+}
+
+uint64_t sap_discovery_generation(const sap_discovery_t *sap)
 {
     if (!sap) return 0;
-    return sap->stats.active_streams;
+    return atomic_load_explicit(&sap->published_generation, memory_order_acquire);
+}
+
+uint64_t sap_snapshot_generation(const sap_snapshot_t *snap)
+{
+    return snap ? snap->generation : 0;
+}
+
+int sap_snapshot_count(const sap_snapshot_t *snap)
+{
+    return snap ? snap->count : 0;
+}
+
+const sap_stream_entry_t *sap_snapshot_stream(const sap_snapshot_t *snap, int i)
+{
+    if (!snap || i < 0 || i >= snap->count) return NULL;
+    return &snap->nodes[i]->e;
+}
+
+int sap_snapshot_changes(const sap_snapshot_t *snap, uint64_t since,
+                         const sap_change_t **changes)
+{
+    if (!snap || !changes) return -1;
+    if (since >= snap->generation) return 0;
+
+    /* changes[] covers generations (oldest, snap->generation] */
+    const uint64_t oldest = snap->generation - (uint64_t)snap->n_changes;
+    if (since < oldest) return -1;
+
+    *changes = &snap->changes[since - oldest];
+    return (int)(snap->generation - since);
+}
+
+int sap_discovery_count(const sap_discovery_t *sap)
+{
+    const sap_snapshot_t *s = sap_discovery_snapshot(sap);
+    int count = sap_snapshot_count(s);
+    sap_snapshot_release(s);
+    return count;
 }
 
 int sap_discovery_get_streams(const sap_discovery_t *sap,
@@ -501,16 +920,12 @@ int sap_discovery_get_streams(const sap_discovery_t *sap,
 {
     if (!sap || !streams || max <= 0) return 0;
 
+    const sap_snapshot_t *s = sap_discovery_snapshot(sap);
     int count = 0;
-    pthread_mutex_lock((pthread_mutex_t *)&sap->lock);
-
-    for (int i = 0; i < sap->stream_count && count < max; i++) {
-        if (sap->streams[i].active) {
-            streams[count++] = sap->streams[i];
-        }
+    for (int i = 0; i < sap_snapshot_count(s) && count < max; i++) {
+        streams[count++] = *sap_snapshot_stream(s, i);
     }
-
-    pthread_mutex_unlock((pthread_mutex_t *)&sap->lock);
+    sap_snapshot_release(s);
     return count;
 }
 
@@ -521,22 +936,21 @@ int sap_discovery_find_stream(const sap_discovery_t *sap,
 {
     if (!sap || !addr) return 0;
 
-    pthread_mutex_lock((pthread_mutex_t *)&sap->lock);
-
-    for (int i = 0; i < sap->stream_count; i++) {
-        if (sap->streams[i].active &&
-            strcmp(sap->streams[i].sdp.multicast_addr, addr) == 0 &&
-            (port == 0 || sap->streams[i].sdp.port == port)) {
+    const sap_snapshot_t *s = sap_discovery_snapshot(sap);
+    int found = 0;
+    for (int i = 0; i < sap_snapshot_count(s); i++) {
+        const sap_stream_entry_t *e = sap_snapshot_stream(s, i);
+        if (strcmp(e->sdp.multicast_addr, addr) == 0 &&
+            (port == 0 || e->sdp.port == port)) {
             if (stream) {
-                *stream = sap->streams[i];
+                *stream = *e;
             }
-            pthread_mutex_unlock((pthread_mutex_t *)&sap->lock);
-            return 1;
+            found = 1;
+            break;
         }
     }
-
-    pthread_mutex_unlock((pthread_mutex_t *)&sap->lock);
-    return 0;
+    sap_snapshot_release(s);
+    return found;
 }
 
 int sap_discovery_find_by_name(const sap_discovery_t *sap,
@@ -545,21 +959,20 @@ int sap_discovery_find_by_name(const sap_discovery_t *sap,
 {
     if (!sap || !name) return 0;
 
-    pthread_mutex_lock((pthread_mutex_t *)&sap->lock);
-
-    for (int i = 0; i < sap->stream_count; i++) {
-        if (sap->streams[i].active &&
-            strcasecmp(sap->streams[i].sdp.session_name, name) == 0) {
+    const sap_snapshot_t *s = sap_discovery_snapshot(sap);
+    int found = 0;
+    for (int i = 0; i < sap_snapshot_count(s); i++) {
+        const sap_stream_entry_t *e = sap_snapshot_stream(s, i);
+        if (strcasecmp(e->sdp.session_name, name) == 0) {
             if (stream) {
-                *stream = sap->streams[i];
+                *stream = *e;
             }
-            pthread_mutex_unlock((pthread_mutex_t *)&sap->lock);
-            return 1;
+            found = 1;
+            break;
         }
     }
-
-    pthread_mutex_unlock((pthread_mutex_t *)&sap->lock);
-    return 0;
+    sap_snapshot_release(s);
+    return found;
 }
 
 void sap_discovery_get_stats(const sap_discovery_t *sap, sap_stats_t *stats)
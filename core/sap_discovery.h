@@ -10,6 +10,31 @@
  *      Listens for SAP announcements on the network and maintains
  *      a list of discovered AES67/ST2110 audio streams.
  *
+ *  Directory:
+ *      Streams are indexed by (origin, msg id hash) in a hash table owned
+ *      by the receive thread. Adds, changes and deletes are published as
+ *      an immutable, reference-counted snapshot: readers take one (a
+ *      pointer copy under a lock held only for that and the swap) and
+ *      then read it for as long as they like without blocking the
+ *      receive thread. Entries are shared between snapshots, so
+ *      publishing copies pointers, not entries.
+ *
+ *      A rebuild costs one reference per live entry and per logged
+ *      change, so snapshots are rebuilt at most every
+ *      SAP_PUBLISH_INTERVAL_MS: a burst of changes shares one rebuild,
+ *      and readers see a change at most that long after its callback.
+ *
+ *  Changes:
+ *      Each add/change/delete bumps the directory generation and is kept
+ *      in a log of the last SAP_CHANGE_LOG changes, carried by every
+ *      snapshot. A consumer that remembers the generation it last saw can
+ *      fetch just the changes since (sap_snapshot_changes), and falls back
+ *      to a full read when it is too far behind.
+ *
+ *      Re-announcements that do not change the SDP are not changes:
+ *      last_seen in published entries is refreshed with the periodic
+ *      expiry pass (every 30 seconds).
+ *
  *  Standards:
  *      - RFC 2974 (SAP)
  *      - RFC 4566 (SDP)
@@ -39,8 +64,14 @@ extern "C" {
 #define SAP_ADDR_ADMIN      "239.255.255.255"   /* Admin scope (commonly used) */
 #define SAP_PORT            9875
 
-/* Maximum streams to track */
-#define SAP_MAX_STREAMS     256
+/* Maximum streams to track (default; see sap_discovery_cfg_t) */
+#define SAP_MAX_STREAMS     1024
+
+/* Changes kept for delta readers */
+#define SAP_CHANGE_LOG      1024
+
+/* Shortest gap between snapshot rebuilds (ms) */
+#define SAP_PUBLISH_INTERVAL_MS 100
 
 /* Stream timeout (seconds) - streams not re-announced are removed */
 #define SAP_STREAM_TIMEOUT  300
@@ -81,6 +112,19 @@ typedef enum {
 
 typedef void (*sap_callback_fn)(sap_event_t event, const sap_stream_entry_t *stream, void *userdata);
 
+/*
+ * One directory change. For SAP_EVENT_DELETE, stream is the entry as it
+ * was last announced, with active = 0.
+ */
+typedef struct {
+    uint64_t                    generation;
+    sap_event_t                 event;
+    const sap_stream_entry_t   *stream;     /* Valid while the snapshot is held */
+} sap_change_t;
+
+/* Immutable view of the directory */
+typedef struct sap_snapshot sap_snapshot_t;
+
 /*
  * SAP discovery configuration
  */
@@ -91,6 +135,7 @@ typedef struct {
     int         timeout_sec;        /* Stream timeout in seconds (0 for default 300) */
     sap_callback_fn callback;       /* Optional callback for stream events */
     void       *callback_userdata;  /* User data for callback */
+    int         max_streams;        /* Directory size (0 for SAP_MAX_STREAMS) */
 } sap_discovery_cfg_t;
 
 typedef struct sap_discovery sap_discovery_t;
@@ -170,6 +215,39 @@ int sap_discovery_find_by_name(const sap_discovery_t *sap,
                                 const char *name,
                                 sap_stream_entry_t *stream);
 
+/*
+ * Take the current directory snapshot. Never blocks on the receive
+ * thread's packet processing; never returns NULL for a valid instance.
+ * Release with sap_snapshot_release().
+ */
+const sap_snapshot_t *sap_discovery_snapshot(const sap_discovery_t *sap);
+
+void sap_snapshot_release(const sap_snapshot_t *snap);
+
+/* Generation of the newest published snapshot (cheap poll for changes) */
+uint64_t sap_discovery_generation(const sap_discovery_t *sap);
+
+/* Generation the snapshot reflects */
+uint64_t sap_snapshot_generation(const sap_snapshot_t *snap);
+
+/* Active streams in the snapshot, and the i-th of them (0 <= i < count) */
+int sap_snapshot_count(const sap_snapshot_t *snap);
+const sap_stream_entry_t *sap_snapshot_stream(const sap_snapshot_t *snap, int i);
+
+/*
+ * Changes after generation 'since', oldest first.
+ *
+ * Parameters:
+ *   snap     - snapshot
+ *   since    - last generation the caller has seen (0 = none)
+ *   changes  - receives a pointer to the changes (valid while snap is held)
+ *
+ * Returns the number of changes (0 if up to date), or -1 if the log no
+ * longer reaches back to 'since': read the whole snapshot instead.
+ */
+int sap_snapshot_changes(const sap_snapshot_t *snap, uint64_t since,
+                         const sap_change_t **changes);
+
 /*
  * Get discovery statistics.
  */
@@ -3,6 +3,11 @@
  *
  * State machine with pre-roll ring buffer for threshold-based recording.
  *
+ * Pre-roll is copied into a preallocated PCM ring, so the caller's frames
+ * go back to their pool at once instead of being held for the pre-roll
+ * time. On activation the ring is handed out as one or two spans (two
+ * when it has wrapped), each a frame view into the ring.
+ *
  * Copyright: (c) 2026 B. Wynne
  * License: GPLv2 or later
  */
@@ -21,18 +26,19 @@
 /* Minimum silence floor */
 #define MIN_DB -60.0f
 
-/* Maximum ring buffer slots (5s at 48kHz with 1ms frames = 5000 slots) */
-#define MAX_RING_SLOTS 8192
-
 /*
- * Ring buffer for pre-roll frames.
- * Stores pointers to frames (frames are owned by caller's pool).
+ * Ring buffer for pre-roll audio.
+ * Holds a copy of the samples (interleaved float), not the frames.
  */
 typedef struct ring_buffer {
-    const audyn_audio_frame_t **frames;
-    uint32_t capacity;      /* Number of slots */
-    uint32_t head;          /* Next write position */
-    uint32_t count;         /* Current occupancy */
+    float *pcm;             /* capacity * channels samples */
+    uint32_t channels;
+    uint32_t capacity;      /* Sample frames */
+    uint32_t head;          /* Next write position (sample frames) */
+    uint32_t count;         /* Sample frames held */
+
+    /* Views handed out by ring_get_all() */
+    audyn_audio_frame_t spans[2];
 } ring_buffer_t;
 
 /*
@@ -83,20 +89,19 @@ static const char *mode_names[] = {
 /*
  * Initialize ring buffer.
  */
-static int ring_init(ring_buffer_t *ring, uint32_t capacity)
+static int ring_init(ring_buffer_t *ring, uint32_t capacity, uint32_t channels)
 {
-    if (capacity > MAX_RING_SLOTS) {
-        capacity = MAX_RING_SLOTS;
-    }
+    memset(ring, 0, sizeof(*ring));
 
-    ring->frames = calloc(capacity, sizeof(audyn_audio_frame_t *));
-    if (!ring->frames) {
-        return -1;
+    if (capacity > 0) {
+        ring->pcm = calloc((size_t)capacity * channels, sizeof(float));
+        if (!ring->pcm) {
+            return -1;
+        }
     }
 
+    ring->channels = channels;
     ring->capacity = capacity;
-    ring->head = 0;
-    ring->count = 0;
     return 0;
 }
 
@@ -105,10 +110,8 @@ static int ring_init(ring_buffer_t *ring, uint32_t capacity)
  */
 static void ring_destroy(ring_buffer_t *ring)
 {
-    if (ring->frames) {
-        free(ring->frames);
-        ring->frames = NULL;
-    }
+    free(ring->pcm);
+    ring->pcm = NULL;
     ring->capacity = 0;
     ring->head = 0;
     ring->count = 0;
@@ -124,51 +127,77 @@ static void ring_clear(ring_buffer_t *ring)
 }
 
 /*
- * Push a frame into ring buffer.
- * Overwrites oldest frame if full.
+ * Copy a frame's samples into the ring.
+ * Overwrites the oldest audio if full.
  */
 static void ring_push(ring_buffer_t *ring, const audyn_audio_frame_t *frame)
 {
-    ring->frames[ring->head] = frame;
-    ring->head = (ring->head + 1) % ring->capacity;
+    if (ring->capacity == 0 || frame->channels != ring->channels || !frame->data) {
+        return;
+    }
 
-    if (ring->count < ring->capacity) {
-        ring->count++;
+    const size_t ch = ring->channels;
+    const float *src = frame->data;
+    uint32_t n = frame->sample_frames;
+
+    /* Only the newest 'capacity' sample frames can be kept */
+    if (n >= ring->capacity) {
+        src += (size_t)(n - ring->capacity) * ch;
+        memcpy(ring->pcm, src, (size_t)ring->capacity * ch * sizeof(float));
+        ring->head = 0;
+        ring->count = ring->capacity;
+        return;
+    }
+
+    uint32_t first = ring->capacity - ring->head;
+    if (first > n) first = n;
+
+    memcpy(ring->pcm + (size_t)ring->head * ch, src, (size_t)first * ch * sizeof(float));
+    if (n > first) {
+        memcpy(ring->pcm, src + (size_t)first * ch, (size_t)(n - first) * ch * sizeof(float));
+    }
+
+    ring->head = (ring->head + n) % ring->capacity;
+    ring->count += n;
+    if (ring->count > ring->capacity) {
+        ring->count = ring->capacity;
     }
 }
 
 /*
- * Get all frames from ring buffer in order (oldest first).
- * Returns number of frames copied.
+ * Hand out the ring's audio in order (oldest first) as up to two frame
+ * views. The views stay valid until the ring is next written.
+ * Returns number of views stored in out.
  */
 static int ring_get_all(ring_buffer_t *ring,
                         const audyn_audio_frame_t **out,
                         int max_out)
 {
-    if (ring->count == 0) {
+    if (ring->count == 0 || max_out <= 0) {
         return 0;
     }
 
-    int to_copy = (int)ring->count;
-    if (to_copy > max_out) {
-        to_copy = max_out;
-    }
+    const uint32_t start = (ring->head + ring->capacity - ring->count) % ring->capacity;
+    uint32_t first = ring->capacity - start;
+    if (first > ring->count) first = ring->count;
 
-    /* Calculate start position (oldest frame) */
-    uint32_t start;
-    if (ring->count == ring->capacity) {
-        start = ring->head;  /* Buffer is full, head points to oldest */
-    } else {
-        start = 0;  /* Buffer not full, oldest is at 0 */
-    }
+    uint32_t lens[2] = { first, ring->count - first };
+    float *bases[2] = { ring->pcm + (size_t)start * ring->channels, ring->pcm };
 
-    /* Copy frames in order */
-    for (int i = 0; i < to_copy; i++) {
-        uint32_t idx = (start + i) % ring->capacity;
-        out[i] = ring->frames[idx];
+    int n = 0;
+    for (int i = 0; i < 2 && n < max_out; i++) {
+        if (lens[i] == 0) {
+            continue;
+        }
+        audyn_audio_frame_t *span = &ring->spans[i];
+        memset(span, 0, sizeof(*span));
+        span->data = bases[i];
+        span->sample_frames = lens[i];
+        span->channels = ring->channels;
+        out[n++] = span;
     }
 
-    return to_copy;
+    return n;
 }
 
 /*
@@ -267,6 +296,39 @@ static void transition_to(audyn_vox_t *vox, audyn_vox_state_t new_state)
     }
 }
 
+/*
+ * Pre-roll length in sample frames.
+ */
+static uint32_t preroll_frames(const audyn_vox_config_t *cfg)
+{
+    return (uint32_t)(((uint64_t)cfg->preroll_ms * cfg->sample_rate) / 1000);
+}
+
+/*
+ * Copy configuration and derive thresholds and timers from it.
+ */
+static void apply_config(audyn_vox_t *vox, const audyn_vox_config_t *cfg)
+{
+    vox->cfg = *cfg;
+
+    /* Calculate effective release threshold */
+    if (cfg->release_db == 0.0f) {
+        /* Auto-hysteresis: release = threshold - 5dB */
+        vox->effective_release_db = cfg->threshold_db - AUTO_HYSTERESIS_DB;
+    } else {
+        vox->effective_release_db = cfg->release_db;
+    }
+
+    /* Clamp release to minimum */
+    if (vox->effective_release_db < MIN_DB) {
+        vox->effective_release_db = MIN_DB;
+    }
+
+    /* Calculate timer thresholds in samples */
+    vox->detection_samples = ((uint64_t)cfg->detection_ms * cfg->sample_rate) / 1000;
+    vox->hangover_samples = ((uint64_t)cfg->hangover_ms * cfg->sample_rate) / 1000;
+}
+
 /*
  * Create VOX detector.
  */
@@ -299,39 +361,16 @@ audyn_vox_t *audyn_vox_create(const audyn_vox_config_t *cfg)
         return NULL;
     }
 
-    /* Copy configuration */
-    vox->cfg = *cfg;
-
-    /* Calculate effective release threshold */
-    if (cfg->release_db == 0.0f) {
-        /* Auto-hysteresis: release = threshold - 5dB */
-        vox->effective_release_db = cfg->threshold_db - AUTO_HYSTERESIS_DB;
-    } else {
-        vox->effective_release_db = cfg->release_db;
-    }
-
-    /* Clamp release to minimum */
-    if (vox->effective_release_db < MIN_DB) {
-        vox->effective_release_db = MIN_DB;
-    }
-
-    /* Calculate timer thresholds in samples */
-    vox->detection_samples = ((uint64_t)cfg->detection_ms * cfg->sample_rate) / 1000;
-    vox->hangover_samples = ((uint64_t)cfg->hangover_ms * cfg->sample_rate) / 1000;
-
-    /* Initialize pre-roll ring buffer */
-    /* Calculate slots needed: preroll_ms worth of frames */
-    /* Assuming ~1ms per frame at 48kHz with 48 samples/frame */
-    uint32_t samples_per_frame = 48;  /* Typical */
-    uint32_t preroll_samples = (cfg->preroll_ms * cfg->sample_rate) / 1000;
-    uint32_t ring_slots = (preroll_samples / samples_per_frame) + 1;
-
-    if (ring_init(&vox->preroll, ring_slots) != 0) {
+    /* Initialize pre-roll ring buffer: preroll_ms of audio before the
+     * frame that activates */
+    if (ring_init(&vox->preroll, preroll_frames(cfg), cfg->channels) != 0) {
         LOG_ERROR("VOX: ring buffer allocation failed");
         free(vox);
         return NULL;
     }
 
+    apply_config(vox, cfg);
+
     /* Initialize state */
     vox->state = AUDYN_VOX_IDLE;
     vox->idle_start_samples = 0;
@@ -402,23 +441,24 @@ int audyn_vox_process(audyn_vox_t *vox,
         break;
 
     case AUDYN_VOX_DETECTING:
-        /* Store frame in pre-roll buffer */
-        ring_push(&vox->preroll, frame);
-
         if (!level_exceeds_threshold(vox, level_db)) {
             /* False trigger, back to idle */
+            ring_push(&vox->preroll, frame);
             transition_to(vox, AUDYN_VOX_IDLE);
             vox->stats.frames_gated++;
         } else if (samples_in_state >= vox->detection_samples) {
             /* Detection period complete, activate */
             transition_to(vox, AUDYN_VOX_ACTIVE);
 
-            /* Output all pre-roll frames first */
-            out_count = ring_get_all(&vox->preroll, out_frames, max_out);
+            /* Output the pre-roll spans first, then this frame */
+            out_count = ring_get_all(&vox->preroll, out_frames, max_out - 1);
             ring_clear(&vox->preroll);
+            out_frames[out_count++] = frame;
 
             vox->stats.frames_passed += out_count;
         } else {
+            /* Store frame in pre-roll buffer */
+            ring_push(&vox->preroll, frame);
             vox->stats.frames_gated++;
         }
         break;
@@ -507,13 +547,56 @@ int audyn_vox_flush(audyn_vox_t *vox,
         return 0;
     }
 
-    /* Get any remaining pre-roll frames */
+    /* Get any remaining pre-roll audio (views valid until the next call) */
     int count = ring_get_all(&vox->preroll, out_frames, max_out);
     ring_clear(&vox->preroll);
 
     return count;
 }
 
+/*
+ * Change thresholds, timers, pre-roll and mode in place.
+ */
+int audyn_vox_set_config(audyn_vox_t *vox, const audyn_vox_config_t *cfg)
+{
+    if (!vox || !cfg) {
+        return -1;
+    }
+
+    if (cfg->sample_rate != vox->cfg.sample_rate || cfg->channels != vox->cfg.channels) {
+        LOG_ERROR("VOX: sample rate and channels cannot change at runtime");
+        return -1;
+    }
+
+    if (cfg->preroll_ms > AUDYN_VOX_MAX_PREROLL_MS) {
+        LOG_ERROR("VOX: pre-roll %u exceeds max %u ms",
+                  cfg->preroll_ms, AUDYN_VOX_MAX_PREROLL_MS);
+        return -1;
+    }
+
+    /* A new pre-roll length starts an empty ring; the audio held so far
+     * is dropped rather than re-laid out */
+    const uint32_t frames = preroll_frames(cfg);
+    if (frames != vox->preroll.capacity) {
+        ring_buffer_t ring;
+        if (ring_init(&ring, frames, cfg->channels) != 0) {
+            LOG_ERROR("VOX: ring buffer allocation failed");
+            return -1;
+        }
+        ring_destroy(&vox->preroll);
+        vox->preroll = ring;
+    }
+
+    apply_config(vox, cfg);
+
+    LOG_INFO("VOX: reconfigured (threshold=%.1fdB release=%.1fdB detection=%ums "
+             "hangover=%ums preroll=%ums mode=%s)",
+             cfg->threshold_db, vox->effective_release_db,
+             cfg->detection_ms, cfg->hangover_ms, cfg->preroll_ms,
+             mode_names[cfg->mode]);
+    return 0;
+}
+
 /*
  * Reset VOX detector.
  */
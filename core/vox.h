@@ -89,10 +89,15 @@ void audyn_vox_destroy(audyn_vox_t *vox);
  * Process an audio frame through the VOX detector.
  *
  * The detector uses the provided level measurements to determine voice activity.
- * When transitioning from IDLE to ACTIVE, pre-roll frames are returned first.
+ * When transitioning from IDLE to ACTIVE, the pre-roll is returned first as
+ * one or two spans (views into the detector's own ring, valid until the
+ * next call), followed by frame itself.
+ *
+ * While idle the frame's samples are copied into the pre-roll ring; the
+ * frame is never retained, so the caller may release it on return.
  *
  * @param vox           VOX detector instance
- * @param frame         Audio frame to process (stored in pre-roll buffer)
+ * @param frame         Audio frame to process (copied into pre-roll buffer)
  * @param rms_db_left   RMS level in dB for left/mono channel
  * @param rms_db_right  RMS level in dB for right channel (ignored if mono)
  * @param peak_db_left  Peak level in dB for left/mono channel
@@ -141,7 +146,8 @@ int audyn_vox_should_close_file(audyn_vox_t *vox);
 /*
  * Flush remaining frames from pre-roll buffer.
  *
- * Called on shutdown to retrieve any buffered frames.
+ * Called on shutdown to retrieve any buffered audio (as spans, see
+ * audyn_vox_process).
  *
  * @param vox        VOX detector instance
  * @param out_frames Array to receive frames
@@ -152,6 +158,19 @@ int audyn_vox_flush(audyn_vox_t *vox,
                     const audyn_audio_frame_t **out_frames,
                     int max_out);
 
+/*
+ * Apply a new configuration to a running detector.
+ *
+ * Thresholds, timers and mode take effect from the next frame; the state
+ * machine keeps its state. A changed pre-roll length empties the pre-roll
+ * buffer. sample_rate and channels must match the detector.
+ *
+ * @param vox  VOX detector instance
+ * @param cfg  New configuration
+ * @return     0 on success, -1 on error (detector unchanged)
+ */
+int audyn_vox_set_config(audyn_vox_t *vox, const audyn_vox_config_t *cfg);
+
 /*
  * Reset VOX detector state.
  *
@@ -42,6 +42,9 @@
 /* Default idle sleep if not specified (1ms) */
 #define DEFAULT_IDLE_SLEEP_US 1000
 
+/* Longest park on the queue wakeup before re-checking the running flag */
+#define WAKEUP_WAIT_MS 100
+
 /* Maximum reasonable sample rate */
 #define WORKER_MAX_SAMPLE_RATE 384000
 
@@ -60,6 +63,7 @@ struct audyn_worker {
     _Atomic int           running;      /* 1 while worker should run */
     _Atomic int           started;      /* 1 if thread was ever started */
     _Atomic int           status;       /* 0 ok, nonzero error */
+    int                   event_driven; /* 1 = block on queue wakeup */
 
     pthread_mutex_t       err_mu;
     char                  last_err[256];
@@ -103,12 +107,17 @@ static void *worker_main(void *arg)
     const uint32_t idle_us = w->cfg.idle_sleep_us ? w->cfg.idle_sleep_us : DEFAULT_IDLE_SLEEP_US;
 
     while (atomic_load_explicit(&w->running, memory_order_acquire)) {
-        audyn_audio_frame_t *f =
-            (audyn_audio_frame_t*)audyn_audio_queue_pop(w->q);
-
-        if (!f) {
-            usleep(idle_us);
-            continue;
+        audyn_audio_frame_t *f;
+
+        if (w->event_driven) {
+            f = (audyn_audio_frame_t*)audyn_audio_queue_pop_wait(w->q, 1, WAKEUP_WAIT_MS);
+            if (!f) continue;
+        } else {
+            f = (audyn_audio_frame_t*)audyn_audio_queue_pop(w->q);
+            if (!f) {
+                usleep(idle_us);
+                continue;
+            }
         }
 
         if (audyn_wav_sink_write(w->sink,
@@ -196,6 +205,14 @@ audyn_worker_t *audyn_worker_create(audyn_frame_pool_t *pool,
 
     w->pool = pool;
     w->q = queue;
+
+    if (cfg->idle_sleep_us == 0) {
+        w->event_driven = (audyn_audio_queue_enable_wakeup(queue) == 0);
+        if (!w->event_driven) {
+            LOG_WARN("WORKER: queue wakeup unavailable, polling every %uus",
+                     DEFAULT_IDLE_SLEEP_US);
+        }
+    }
     w->cfg = *cfg;
 
     /* Make owned copy of output path */
@@ -277,6 +294,7 @@ int audyn_worker_stop(audyn_worker_t *w)
     }
 
     atomic_store_explicit(&w->running, 0, memory_order_release);
+    audyn_audio_queue_wake(w->q);
     pthread_join(w->thread, NULL);
     atomic_store_explicit(&w->started, 0, memory_order_release);
     LOG_INFO("WORKER: Stopped");
@@ -69,7 +69,9 @@ typedef struct audyn_worker_cfg {
     uint32_t sample_rate;
     uint16_t channels;
 
-    uint32_t idle_sleep_us;  /* Sleep when no frames (default 1000us if 0) */
+    uint32_t idle_sleep_us;  /* Poll interval when no frames; 0 = block on the
+                              * queue's eventfd wakeup (falls back to 1000us
+                              * polling if it cannot be enabled) */
     int drain_on_stop;       /* If non-zero, drain remaining queue on stop */
 
     audyn_wav_sink_cfg_t wav_cfg;
@@ -20,10 +20,42 @@
  *      The input infers L16 vs L24 by comparing payload length to
  *      (channels * samples_per_packet * bytes_per_sample).
  *
+ *      Conversion kernels (see pcm_convert.h) are selected once at create
+ *      time for the stream layout and CPU; no per-packet format branching.
+ *      With cfg.raw_s24, L24 samples are also handed on as packed S24LE
+ *      (frame->raw) so a 24-bit file can be written without a float round
+ *      trip.
+ *
+ *  Receive Path:
+ *      - One recvmsg() per packet by default
+ *      - Optional batched mode (cfg.rx_batch > 1) drains up to rx_batch
+ *        datagrams per wakeup with recvmmsg(MSG_WAITFORONE); each slot keeps
+ *        its own SO_TIMESTAMPING control buffer so per-packet arrival times
+ *        are preserved
+ *
+ *  Seamless Protection (SMPTE ST 2022-7):
+ *      - Optional second leg (cfg.source_ip_b): the same RTP stream on
+ *        another group/port/interface, e.g. the blue network
+ *      - Both sockets are served by one thread with poll(), or by a thread
+ *        each (cfg.leg_threads). With a thread each, the second leg's
+ *        thread only receives: it copies datagrams into an SPSC hand-off
+ *        ring (AES_HANDOFF_SLOTS) and the primary leg's thread, woken by
+ *        an eventfd, parses, merges and plays out both, so the packet path
+ *        takes no lock and the audio queue keeps a single producer
+ *      - A window of the last AES_MERGE_WINDOW sequence numbers passes the
+ *        first copy of each packet on and drops the other before decode;
+ *        the jitter buffer (required) then reorders across legs, so a
+ *        packet lost on one leg is filled from the other within its depth
+ *
  *  PTP Support:
  *      - Hardware timestamps via SO_TIMESTAMPING (requires network driver support)
  *      - Software timestamps via CLOCK_REALTIME (fallback)
- *      - Optional jitter buffer for packet reordering
+ *      - Optional jitter buffer (cfg.jitter_ms) between packet parsing and
+ *        the audio queue: reorders by sequence, plays out at RTP media time
+ *        (via audyn_ptp_rtp_to_ns()) + depth, conceals gaps with silence
+ *      - Playout also runs on a AES_JB_TICK_MS timer while no packets
+ *        arrive, so audio held in the buffer when a stream stalls reaches
+ *        the queue on schedule, before the worker starts writing silence
  *      - RTP-to-PTP timestamp correlation
  *
  *  Design Guarantees:
@@ -35,7 +67,7 @@
  *
  *  Dependencies:
  *      - POSIX sockets + pthread
- *      - Audyn core: frame_pool, audio_queue, ptp_clock, jitter_buffer
+ *      - Audyn core: frame_pool, audio_queue, ptp_clock, jitter_buffer, rt, metrics
  *      - Audyn core logging: core/log.h
  *
  *  Copyright:
@@ -56,8 +88,12 @@
 #include <stdlib.h>
 #include <stdint.h>
 #include <unistd.h>
+#include <time.h>
 
 #include <pthread.h>
+#include <stdatomic.h>
+#include <poll.h>
+#include <sys/eventfd.h>
 #include <sys/socket.h>
 #include <sys/time.h>
 #include <sys/ioctl.h>
@@ -74,6 +110,9 @@
 #include "log.h"
 #include "ptp_clock.h"
 #include "jitter_buffer.h"
+#include "pcm_convert.h"
+#include "rt.h"
+#include "metrics.h"
 
 /* -------- Limits -------- */
 
@@ -86,6 +125,28 @@
 /* Maximum samples per packet (AES67 allows up to 48 for 1ms at 48kHz) */
 #define AES_MAX_SAMPLES_PER_PACKET 1024
 
+/* Maximum jitter buffer depth */
+#define AES_MAX_JITTER_MS 200
+
+/* Jitter buffer playout period while no packets arrive (receive timeout) */
+#define AES_JB_TICK_MS 5
+
+/* Maximum datagrams drained per recvmmsg() call */
+#define AES_MAX_RX_BATCH 64
+
+/* Per-packet receive and control (cmsg) buffer sizes */
+#define AES_RX_BUF_BYTES  4096
+#define AES_RX_CTRL_BYTES 256
+
+/* Receive legs (ST 2022-7: primary and secondary) */
+#define AES_MAX_LEGS 2
+
+/* Sequence numbers tracked by the leg merge (power of two) */
+#define AES_MERGE_WINDOW 4096
+
+/* Second-leg datagrams in flight to the primary thread (power of two) */
+#define AES_HANDOFF_SLOTS 256
+
 /* -------- RTP parsing helpers -------- */
 
 #define RTP_MIN_HEADER_BYTES 12U
@@ -95,20 +156,55 @@ static inline uint16_t rd_be16(const uint8_t *p) {
     return (uint16_t)((uint16_t)p[0] << 8) | (uint16_t)p[1];
 }
 
-static inline int32_t rd_be24s(const uint8_t *p) {
-    /* 24-bit big-endian signed -> sign-extended int32 */
-    int32_t v = ((int32_t)p[0] << 16) | ((int32_t)p[1] << 8) | (int32_t)p[2];
-    if (v & 0x00800000) v |= 0xFF000000;
-    return v;
-}
+/* A datagram handed from the second leg's thread to the primary's */
+typedef struct aes_handoff_slot {
+    uint64_t arrival_ns;
+    uint64_t rx_ns;
+    uint32_t len;
+    uint16_t batch;                     /* Receive call size, on its first packet */
+    uint8_t  data[AES_RX_BUF_BYTES];
+} aes_handoff_slot_t;
+
+/* One receive path: socket, receive thread, recvmmsg() slots */
+typedef struct aes_leg {
+    audyn_aes_input_t *in;
+    unsigned index;                     /* 0 = primary, 1 = second leg */
+    const char *source_ip;              /* Points at storage owned by the input */
+    uint16_t port;
+    const char *bind_interface;
 
-/* Convert PCM integers to float in [-1, 1) */
-static inline float s16_to_f32(int16_t s) {
-    return (float)s / 32768.0f;
-}
-static inline float s24_to_f32(int32_t s) {
-    return (float)s / 8388608.0f;
-}
+    int sock_fd;
+    pthread_t thread;
+    int thread_started;
+
+    /* Batched receive (allocated at create when rx_batch > 1) */
+    uint8_t *rx_bufs;                   /* rx_batch * AES_RX_BUF_BYTES */
+    uint8_t *rx_ctrl;                   /* rx_batch * AES_RX_CTRL_BYTES */
+    struct iovec *rx_iov;
+    struct mmsghdr *rx_msgs;
+
+    /* Dual-leg accounting (see merge_accept) */
+    int have_seq;
+    uint16_t expected_seq;
+    _Atomic uint64_t packets_rx;
+    _Atomic uint64_t packets_lost;
+    _Atomic uint64_t packets_recovered;
+
+    /* Hand-off to the primary thread (second leg with cfg.leg_threads) */
+    aes_handoff_slot_t *handoff;        /* NULL = the leg handles its own packets */
+    _Atomic uint32_t ho_head;           /* Slots published (this leg's thread) */
+    _Atomic uint32_t ho_tail;           /* Slots consumed (primary thread) */
+    _Atomic int ho_armed;               /* Primary is about to sleep: wake it */
+    int ho_wake_fd;                     /* eventfd */
+    uint16_t ho_batch;                  /* Receive call size for the next slot */
+    _Atomic uint64_t ho_dropped;        /* Ring full (this leg's thread) */
+} aes_leg_t;
+
+/* Merge window slot: which legs delivered this sequence number */
+typedef struct aes_merge_slot {
+    uint16_t seq;
+    uint8_t legs;                       /* Bit per leg */
+} aes_merge_slot_t;
 
 /* Opaque instance */
 struct audyn_aes_input {
@@ -119,12 +215,19 @@ struct audyn_aes_input {
     /* Owned copies of config strings */
     char *source_ip;
     char *bind_interface;
+    char *source_ip_b;
+    char *bind_interface_b;
 
-    int sock_fd;
-
-    pthread_t thread;
+    aes_leg_t legs[AES_MAX_LEGS];
+    unsigned n_legs;
     int thread_started;
 
+    /* Leg merge (dual-leg only) */
+    aes_merge_slot_t *merge;            /* AES_MERGE_WINDOW slots */
+    int merge_started;
+    uint16_t merge_highest;
+    _Atomic uint64_t duplicates;
+
     pthread_mutex_t err_mu;
     char last_error[256];
 
@@ -136,19 +239,58 @@ struct audyn_aes_input {
     int hw_timestamps_enabled;          /* 1 if SO_TIMESTAMPING succeeded */
     int ptp_epoch_set;                  /* 1 if RTP epoch has been set */
 
+    /* Batched receive (per leg, see aes_leg_t) */
+    uint16_t rx_batch;                  /* Effective batch size (1 = recvmsg) */
+
+    /* Optional reorder / playout stage (cfg.jitter_ms > 0) */
+    audyn_jitter_buffer_t *jb;
+    int jb_ptp_mapping;                 /* 1 = PTP clock's RTP mapping is ours */
+    int jb_epoch_set;                   /* Private RTP -> time mapping */
+    uint32_t jb_epoch_rtp;
+    uint64_t jb_epoch_ns;
+    uint32_t jb_next_rtp;               /* RTP timestamp of the next slot */
+    uint64_t jb_last_ns;                /* Playout clock at the last packet */
+    uint64_t jb_last_mono_ns;           /* CLOCK_MONOTONIC at the last packet */
+
+    /* When the packet being handled reached user space (metrics on, else 0) */
+    uint64_t rx_ns;
+
+    /* PCM decode kernels, bound once per stream layout */
+    audyn_pcm_decoder_t dec_l16;
+    audyn_pcm_decoder_t dec_l24;
+
     /* Continuity tracking */
     int have_seq;
     uint16_t expected_seq;
 
     /* Counters */
-    uint64_t packets_rx;
-    uint64_t packets_dropped;
-    uint64_t discontinuities;
-    uint64_t frames_pushed;
-    uint64_t frames_dropped_pool_empty;
-    uint64_t frames_dropped_queue_full;
+    _Atomic uint64_t packets_rx;
+    _Atomic uint64_t packets_dropped;
+    _Atomic uint64_t discontinuities;
+    _Atomic uint64_t frames_pushed;
+    _Atomic uint64_t frames_dropped_pool_empty;
+    _Atomic uint64_t frames_dropped_queue_full;
+    _Atomic uint64_t frames_concealed;
+    _Atomic uint64_t rx_syscalls;
+    _Atomic uint64_t rx_batch_max;
+    _Atomic uint64_t rx_batch_full;
 };
 
+/* Counters have one writer (the receive path; a hand-off leg keeps its own
+ * ho_ counters) and are read live by get_stats(): relaxed load + store, no
+ * locked add. */
+static inline void ctr_add(_Atomic uint64_t *c, uint64_t n) {
+    atomic_store_explicit(c, atomic_load_explicit(c, memory_order_relaxed) + n, memory_order_relaxed);
+}
+
+static inline void ctr_set(_Atomic uint64_t *c, uint64_t v) {
+    atomic_store_explicit(c, v, memory_order_relaxed);
+}
+
+static inline uint64_t ctr_get(const _Atomic uint64_t *c) {
+    return atomic_load_explicit(c, memory_order_relaxed);
+}
+
 static void set_error(audyn_aes_input_t *in, const char *msg) {
     if (!in || !msg) return;
     pthread_mutex_lock(&in->err_mu);
@@ -186,11 +328,12 @@ static int is_ipv4_multicast(const char *ip_str) {
     return (host >= 0xE0000000u) && (host <= 0xEFFFFFFFu);
 }
 
-static int open_socket(audyn_aes_input_t *in) {
-    if (!in) return -1;
+static int open_socket(aes_leg_t *leg) {
+    audyn_aes_input_t *in = leg->in;
 
-    const char *src_ip = in->source_ip;
-    uint16_t port = in->cfg.port;
+    const char *src_ip = leg->source_ip;
+    const char *bind_interface = leg->bind_interface;
+    uint16_t port = leg->port;
 
     int fd = socket(AF_INET, SOCK_DGRAM, 0);
     if (fd < 0) {
@@ -209,10 +352,11 @@ static int open_socket(audyn_aes_input_t *in) {
         }
     }
 
-    /* Set receive timeout for clean shutdown (100ms) */
+    /* Set receive timeout for clean shutdown (100ms), or the jitter buffer
+     * playout tick on a leg that plays out */
     struct timeval tv;
     tv.tv_sec = 0;
-    tv.tv_usec = 100000;
+    tv.tv_usec = (in->jb && !leg->handoff) ? AES_JB_TICK_MS * 1000 : 100000;
     (void)setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
 
 #ifdef __linux__
@@ -260,14 +404,14 @@ static int open_socket(audyn_aes_input_t *in) {
         }
 
         /* Bind multicast to specific interface if configured */
-        if (in->bind_interface && in->bind_interface[0] != '\0') {
+        if (bind_interface && bind_interface[0] != '\0') {
             struct ifreq ifr;
             memset(&ifr, 0, sizeof(ifr));
-            strncpy(ifr.ifr_name, in->bind_interface, IFNAMSIZ - 1);
+            strncpy(ifr.ifr_name, bind_interface, IFNAMSIZ - 1);
 
             if (ioctl(fd, SIOCGIFADDR, &ifr) < 0) {
                 LOG_ERROR("aes_input: failed to get IP for interface '%s': %s",
-                          in->bind_interface, strerror(errno));
+                          bind_interface, strerror(errno));
                 set_error_errno(in, "ioctl(SIOCGIFADDR)");
                 close(fd);
                 return -1;
@@ -276,7 +420,7 @@ static int open_socket(audyn_aes_input_t *in) {
             struct sockaddr_in *ifaddr = (struct sockaddr_in *)&ifr.ifr_addr;
             mreq.imr_interface.s_addr = ifaddr->sin_addr.s_addr;
             LOG_INFO("aes_input: binding multicast to interface '%s' (%s)",
-                     in->bind_interface, inet_ntoa(ifaddr->sin_addr));
+                     bind_interface, inet_ntoa(ifaddr->sin_addr));
         } else {
             mreq.imr_interface.s_addr = htonl(INADDR_ANY);
         }
@@ -288,15 +432,272 @@ static int open_socket(audyn_aes_input_t *in) {
         }
     }
 
-    in->sock_fd = fd;
+    leg->sock_fd = fd;
     return 0;
 }
 
-static int handle_packet(audyn_aes_input_t *in, const uint8_t *pkt, size_t len, uint64_t arrival_ns) {
+/*
+ * Frame timestamp from the PTP clock's RTP mapping, so the worker can
+ * place rotation boundaries on an exact sample. Only a clock owned by this
+ * input holds this stream's epoch (see jb_media_ns); 0 otherwise.
+ */
+static uint64_t frame_media_ns(audyn_aes_input_t *in, uint32_t rtp_ts) {
+    if (!in->jb_ptp_mapping || !in->ptp_epoch_set) {
+        return 0;
+    }
+    return audyn_ptp_rtp_to_ns(in->ptp_clk, rtp_ts, in->cfg.sample_rate);
+}
+
+/*
+ * Convert one packet payload into a frame and push it downstream.
+ * payload == NULL pushes a silence frame (jitter buffer concealment).
+ * The payload length has already been validated against the layout.
+ */
+static int emit_frame(audyn_aes_input_t *in, const uint8_t *payload, size_t payload_len,
+                      uint32_t rtp_ts) {
+    const uint16_t out_ch = in->cfg.channels;
+    const uint16_t spp = in->cfg.samples_per_packet;
+
+    audyn_audio_frame_t *frame = audyn_frame_acquire(in->pool);
+    if (!frame) {
+        ctr_add(&in->frames_dropped_pool_empty, 1);
+        audyn_metrics_count(AUDYN_CTR_DROPS_POOL, 1);
+        return 0;
+    }
+
+    /* Validate the frame shape matches output config. */
+    if (frame->channels != out_ch || frame->data == NULL || frame->sample_frames < (uint32_t)spp) {
+        audyn_frame_return(frame);
+        set_error(in, "frame_pool returned incompatible frame shape");
+        return -1;
+    }
+
+    frame->sample_frames = (uint32_t)spp;
+    frame->raw_frames = 0;
+    frame->media_ns = frame_media_ns(in, rtp_ts);
+
+    if (payload) {
+        /* Payload is interleaved by channel per AES67 PCM conventions.
+         * The decoder extracts only the selected channels from the stream. */
+        const audyn_pcm_decoder_t *dec =
+            (payload_len == (size_t)in->dec_l16.stride_bytes * spp) ? &in->dec_l16 : &in->dec_l24;
+
+        if (in->cfg.raw_s24 && frame->raw && dec == &in->dec_l24) {
+            audyn_pcm_extract_s24le(dec, payload, frame->raw, (uint32_t)spp);
+            frame->raw_frames = (uint32_t)spp;
+        }
+        if (frame->raw_frames == 0 || !in->cfg.raw_only) {
+            audyn_pcm_decode(dec, payload, frame->data, (uint32_t)spp);
+        }
+    } else {
+        memset(frame->data, 0, (size_t)spp * out_ch * sizeof(float));
+        ctr_add(&in->frames_concealed, 1);
+    }
+
+    frame->queued_ns = audyn_metrics_start();
+    if (!audyn_audio_queue_push(in->queue, frame)) {
+        ctr_add(&in->frames_dropped_queue_full, 1);
+        audyn_metrics_count(AUDYN_CTR_DROPS_QUEUE, 1);
+        audyn_frame_return(frame);
+        return 0;
+    }
+
+    ctr_add(&in->frames_pushed, 1);
+    audyn_metrics_count(AUDYN_CTR_FRAMES_PUSHED, 1);
+    if (in->rx_ns != 0 && frame->queued_ns > in->rx_ns) {
+        audyn_metrics_record(AUDYN_STAGE_RX_PUSH, frame->queued_ns - in->rx_ns);
+    }
+    return 0;
+}
+
+/* -------- Jitter buffer stage -------- */
+
+/*
+ * Receive-side clock for playout decisions: the packet's arrival stamp
+ * (socket timestamp or PTP clock), or CLOCK_REALTIME when neither exists.
+ */
+/* Media times further than this from arrival mean the sender's RTP clock
+ * jumped (restart, new source); the private mapping is re-anchored. */
+#define AES_JB_MAX_SKEW_NS (10ULL * 1000000000ULL)
+
+static inline int jb_within_skew(uint64_t media_ns, uint64_t now_ns) {
+    return media_ns + AES_JB_MAX_SKEW_NS >= now_ns && media_ns <= now_ns + AES_JB_MAX_SKEW_NS;
+}
+
+static uint64_t mono_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static uint64_t jb_now_ns(uint64_t arrival_ns) {
+    if (arrival_ns > 0) return arrival_ns;
+
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+/*
+ * Media time of a packet (when its first sample was due), in the same
+ * timebase as jb_now_ns().
+ *
+ * With a PTP clock owned by this input the clock's RTP mapping is used.
+ * Otherwise (no PTP, or inputs sharing a clock through aes_mux, where the
+ * clock holds only one RTP epoch) a private mapping anchored at the first
+ * packet is kept and rebased every second so the 32-bit delta never wraps.
+ * Either mapping is abandoned for a packet that lands outside
+ * AES_JB_MAX_SKEW_NS of its arrival.
+ */
+static uint64_t jb_media_ns(audyn_aes_input_t *in, uint32_t rtp_ts, uint64_t now_ns) {
+    const uint32_t rate = in->cfg.sample_rate;
+
+    if (in->jb_ptp_mapping && in->ptp_epoch_set) {
+        uint64_t t = audyn_ptp_rtp_to_ns(in->ptp_clk, rtp_ts, rate);
+        if (t > 0 && jb_within_skew(t, now_ns)) return t;
+    }
+
+    if (!in->jb_epoch_set || !jb_within_skew(in->jb_epoch_ns, now_ns)) {
+        in->jb_epoch_rtp = rtp_ts;
+        in->jb_epoch_ns = now_ns;
+        in->jb_epoch_set = 1;
+    }
+
+    int32_t delta = (int32_t)(rtp_ts - in->jb_epoch_rtp);
+    if (delta >= (int32_t)rate) {
+        uint32_t secs = (uint32_t)delta / rate;
+        in->jb_epoch_rtp += secs * rate;
+        in->jb_epoch_ns += (uint64_t)secs * 1000000000ULL;
+        delta -= (int32_t)(secs * rate);
+    }
+
+    int64_t off_ns = (int64_t)delta * 1000000000LL / (int64_t)rate;
+    uint64_t t = (uint64_t)((int64_t)in->jb_epoch_ns + off_ns);
+    if (!jb_within_skew(t, now_ns)) {
+        in->jb_epoch_rtp = rtp_ts;
+        in->jb_epoch_ns = now_ns;
+        t = now_ns;
+    }
+    return t;
+}
+
+/* Play out every slot that is due at now_ns */
+static int jb_playout(audyn_aes_input_t *in, uint64_t now_ns) {
+    audyn_jb_packet_t *jp = NULL;
+    while (audyn_jb_poll(in->jb, now_ns, &jp)) {
+        /* A concealed slot follows the one before it */
+        uint32_t slot_rtp = jp ? jp->rtp_ts : in->jb_next_rtp;
+        in->jb_next_rtp = slot_rtp + in->cfg.samples_per_packet;
+        if (emit_frame(in, jp ? jp->payload : NULL, jp ? jp->payload_len : 0, slot_rtp) != 0) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+/*
+ * Insert into the jitter buffer, then play out every slot that is due.
+ * At most depth_ms of audio is held.
+ */
+static int jb_stage(audyn_aes_input_t *in, uint16_t seq, uint32_t rtp_ts,
+                    uint64_t arrival_ns, const uint8_t *payload, size_t payload_len) {
+    const uint64_t now_ns = jb_now_ns(arrival_ns);
+
+    /* Late/duplicate packets are accounted in the jitter buffer stats */
+    (void)audyn_jb_insert(in->jb, seq, rtp_ts, jb_media_ns(in, rtp_ts, now_ns),
+                          payload, (uint32_t)payload_len);
+
+    in->jb_last_ns = now_ns;
+    in->jb_last_mono_ns = mono_ns();
+    return jb_playout(in, now_ns);
+}
+
+/*
+ * Playout with no packet arriving. The playout clock is the last packet's
+ * (socket or PTP timestamp, whatever its timebase) advanced by the
+ * monotonic time since, so held slots come due exactly as they would
+ * have if packets had kept arriving.
+ */
+static int jb_tick(audyn_aes_input_t *in) {
+    if (!in->jb || in->jb_last_mono_ns == 0) return 0;
+
+    const uint64_t elapsed = mono_ns() - in->jb_last_mono_ns;
+    return jb_playout(in, in->jb_last_ns + elapsed);
+}
+
+/* -------- Leg merge (ST 2022-7) -------- */
+
+/* A sequence number leaving the window: one leg alone delivered it */
+static inline void merge_retire(audyn_aes_input_t *in, const aes_merge_slot_t *slot) {
+    if (slot->legs == 1u) ctr_add(&in->legs[0].packets_recovered, 1);
+    else if (slot->legs == 2u) ctr_add(&in->legs[1].packets_recovered, 1);
+}
+
+/*
+ * Returns 1 for the first copy of a packet, 0 for a copy already passed
+ * on by the other leg. Runs before any decode or jitter buffer copy, so
+ * a duplicate costs only the header parse.
+ */
+static int merge_accept(audyn_aes_input_t *in, unsigned leg_idx, uint16_t seq) {
+    aes_leg_t *leg = &in->legs[leg_idx];
+
+    /* Per-leg loss: gaps in this leg's own sequence */
+    if (leg->have_seq) {
+        int16_t gap = (int16_t)(seq - leg->expected_seq);
+        if (gap >= 0) {
+            if (gap < AES_MERGE_WINDOW) ctr_add(&leg->packets_lost, (uint64_t)gap);
+            leg->expected_seq = (uint16_t)(seq + 1);
+        }
+    } else {
+        leg->have_seq = 1;
+        leg->expected_seq = (uint16_t)(seq + 1);
+    }
+
+    int16_t ahead = (int16_t)(seq - in->merge_highest);
+    if (!in->merge_started || ahead <= -AES_MERGE_WINDOW) {
+        /* First packet, or far behind the window (sender restarted) */
+        memset(in->merge, 0, AES_MERGE_WINDOW * sizeof(*in->merge));
+        in->merge_started = 1;
+        in->merge_highest = seq;
+        ahead = 0;
+    }
+
+    /* Slide the window: retire the slots the new sequence numbers reuse */
+    if (ahead > 0) {
+        const unsigned n = ahead > AES_MERGE_WINDOW ? AES_MERGE_WINDOW : (unsigned)ahead;
+        for (unsigned u = 0; u < n; u++) {
+            const uint16_t sn = (uint16_t)(seq - u);
+            aes_merge_slot_t *sl = &in->merge[sn & (AES_MERGE_WINDOW - 1)];
+            merge_retire(in, sl);
+            sl->seq = sn;
+            sl->legs = 0;
+        }
+        in->merge_highest = seq;
+    }
+
+    aes_merge_slot_t *slot = &in->merge[seq & (AES_MERGE_WINDOW - 1)];
+    if (slot->seq != seq) {
+        merge_retire(in, slot);
+        slot->seq = seq;
+        slot->legs = 0;
+    }
+
+    const uint8_t bit = (uint8_t)(1u << leg_idx);
+    if (slot->legs) {
+        slot->legs |= bit;
+        ctr_add(&in->duplicates, 1);
+        return 0;
+    }
+    slot->legs = bit;
+    return 1;
+}
+
+static int handle_packet(audyn_aes_input_t *in, unsigned leg, const uint8_t *pkt, size_t len,
+                         uint64_t arrival_ns) {
     if (!in || !pkt) return -1;
 
     if (len < RTP_MIN_HEADER_BYTES) {
-        in->packets_dropped++;
+        ctr_add(&in->packets_dropped, 1);
         return 0;
     }
 
@@ -312,21 +713,30 @@ static int handle_packet(audyn_aes_input_t *in, const uint8_t *pkt, size_t len,
     const uint8_t payload_type = (uint8_t)(b1 & 0x7F);
 
     if (version != RTP_VERSION_EXPECTED) {
-        in->packets_dropped++;
+        ctr_add(&in->packets_dropped, 1);
         return 0;
     }
 
     if (payload_type != in->cfg.payload_type) {
-        in->packets_dropped++;
+        ctr_add(&in->packets_dropped, 1);
         return 0;
     }
 
+    if (in->cfg.ssrc != 0) {
+        uint32_t ssrc = ((uint32_t)pkt[8] << 24) | ((uint32_t)pkt[9] << 16) |
+                        ((uint32_t)pkt[10] << 8) | (uint32_t)pkt[11];
+        if (ssrc != in->cfg.ssrc) {
+            ctr_add(&in->packets_dropped, 1);
+            return 0;
+        }
+    }
+
     size_t off = RTP_MIN_HEADER_BYTES;
 
     /* CSRC list */
     size_t csrc_bytes = (size_t)csrc_count * 4U;
     if (len < off + csrc_bytes) {
-        in->packets_dropped++;
+        ctr_add(&in->packets_dropped, 1);
         return 0;
     }
     off += csrc_bytes;
@@ -334,14 +744,14 @@ static int handle_packet(audyn_aes_input_t *in, const uint8_t *pkt, size_t len,
     /* Header extension */
     if (extension) {
         if (len < off + 4U) {
-            in->packets_dropped++;
+            ctr_add(&in->packets_dropped, 1);
             return 0;
         }
         uint16_t ext_len_words = rd_be16(pkt + off + 2);
         off += 4U;
         size_t ext_bytes = (size_t)ext_len_words * 4U;
         if (len < off + ext_bytes) {
-            in->packets_dropped++;
+            ctr_add(&in->packets_dropped, 1);
             return 0;
         }
         off += ext_bytes;
@@ -351,12 +761,12 @@ static int handle_packet(audyn_aes_input_t *in, const uint8_t *pkt, size_t len,
     size_t payload_len = len - off;
     if (padding) {
         if (payload_len == 0) {
-            in->packets_dropped++;
+            ctr_add(&in->packets_dropped, 1);
             return 0;
         }
         uint8_t pad_count = pkt[len - 1];
         if (pad_count == 0 || pad_count > payload_len) {
-            in->packets_dropped++;
+            ctr_add(&in->packets_dropped, 1);
             return 0;
         }
         payload_len -= pad_count;
@@ -367,30 +777,11 @@ static int handle_packet(audyn_aes_input_t *in, const uint8_t *pkt, size_t len,
     uint32_t rtp_ts = ((uint32_t)pkt[4] << 24) | ((uint32_t)pkt[5] << 16) |
                       ((uint32_t)pkt[6] << 8) | (uint32_t)pkt[7];
 
-    /* Set RTP epoch on first packet with valid PTP time */
-    if (in->ptp_clk && !in->ptp_epoch_set && arrival_ns > 0) {
-        audyn_ptp_set_rtp_epoch(in->ptp_clk, rtp_ts, arrival_ns, in->cfg.sample_rate);
-        in->ptp_epoch_set = 1;
-        LOG_DEBUG("aes_input: Set RTP epoch - rtp_ts=%u arrival_ns=%lu", rtp_ts, (unsigned long)arrival_ns);
-    }
-
-    if (!in->have_seq) {
-        in->have_seq = 1;
-        in->expected_seq = (uint16_t)(seq + 1);
-    } else {
-        if (seq != in->expected_seq) {
-            in->discontinuities++;
-            in->expected_seq = (uint16_t)(seq + 1);
-        } else {
-            in->expected_seq = (uint16_t)(in->expected_seq + 1);
-        }
-    }
-
     const uint16_t out_ch = in->cfg.channels;           /* Output channels */
     const uint16_t spp = in->cfg.samples_per_packet;
 
     if (out_ch == 0 || spp == 0) {
-        in->packets_dropped++;
+        ctr_add(&in->packets_dropped, 1);
         return 0;
     }
 
@@ -410,70 +801,52 @@ static int handle_packet(audyn_aes_input_t *in, const uint8_t *pkt, size_t len,
                       ch_offset, out_ch, stream_ch);
             logged = 1;
         }
-        in->packets_dropped++;
+        ctr_add(&in->packets_dropped, 1);
         return 0;
     }
 
     /* Infer L16 vs L24 from payload length using stream_channels */
-    enum { FMT_L16 = 16, FMT_L24 = 24 } fmt = 0;
-    size_t bytes_per_sample = 0;
     size_t exp_l16 = (size_t)stream_ch * (size_t)spp * 2U;
     size_t exp_l24 = (size_t)stream_ch * (size_t)spp * 3U;
 
-    if (payload_len == exp_l16) {
-        fmt = FMT_L16;
-        bytes_per_sample = 2U;
-    } else if (payload_len == exp_l24) {
-        fmt = FMT_L24;
-        bytes_per_sample = 3U;
-    } else {
-        in->packets_dropped++;
+    if (payload_len != exp_l16 && payload_len != exp_l24) {
+        ctr_add(&in->packets_dropped, 1);
         return 0;
     }
 
-    audyn_audio_frame_t *frame = audyn_frame_acquire(in->pool);
-    if (!frame) {
-        in->frames_dropped_pool_empty++;
+    /* Second copy of a packet the other leg already delivered */
+    if (in->merge && !merge_accept(in, leg, seq)) {
         return 0;
     }
 
-    /* Validate the frame shape matches output config. */
-    if (frame->channels != out_ch || frame->data == NULL || frame->sample_frames < (uint32_t)spp) {
-        audyn_frame_release(frame);
-        set_error(in, "frame_pool returned incompatible frame shape");
-        return -1;
+    /* Set RTP epoch on first packet with valid PTP time. Only a clock this
+     * input owns: sessions fed by aes_mux share one clock, which holds a
+     * single epoch, and they play out on their private mapping instead. */
+    if (in->jb_ptp_mapping && !in->ptp_epoch_set && arrival_ns > 0) {
+        audyn_ptp_set_rtp_epoch(in->ptp_clk, rtp_ts, arrival_ns, in->cfg.sample_rate);
+        in->ptp_epoch_set = 1;
+        LOG_DEBUG("aes_input: Set RTP epoch - rtp_ts=%u arrival_ns=%lu", rtp_ts, (unsigned long)arrival_ns);
     }
 
-    frame->sample_frames = (uint32_t)spp;
-
-    const uint8_t *p = pkt + off;
-
-    /* Payload is interleaved by channel per AES67 PCM conventions.
-     * Extract only selected channels from the stream. */
-    for (uint32_t i = 0; i < (uint32_t)spp; i++) {
-        for (uint32_t c = 0; c < (uint32_t)out_ch; c++) {
-            /* Index into the incoming stream at (sample i, channel ch_offset + c) */
-            size_t stream_idx = ((size_t)i * (size_t)stream_ch + (size_t)(ch_offset + c)) * bytes_per_sample;
-            float outv;
-            if (fmt == FMT_L16) {
-                int16_t s = (int16_t)rd_be16(p + stream_idx);
-                outv = s16_to_f32(s);
-            } else {
-                int32_t s = rd_be24s(p + stream_idx);
-                outv = s24_to_f32(s);
-            }
-            frame->data[AUDYN_PCM_IDX(i, c, out_ch)] = outv;
+    if (!in->have_seq) {
+        in->have_seq = 1;
+        in->expected_seq = (uint16_t)(seq + 1);
+    } else {
+        if (seq != in->expected_seq) {
+            ctr_add(&in->discontinuities, 1);
+            in->expected_seq = (uint16_t)(seq + 1);
+        } else {
+            in->expected_seq = (uint16_t)(in->expected_seq + 1);
         }
     }
 
-    if (!audyn_audio_queue_push(in->queue, frame)) {
-        in->frames_dropped_queue_full++;
-        audyn_frame_release(frame);
-        return 0;
+    const uint8_t *p = pkt + off;
+
+    if (in->jb) {
+        return jb_stage(in, seq, rtp_ts, arrival_ns, p, payload_len);
     }
 
-    in->frames_pushed++;
-    return 0;
+    return emit_frame(in, p, payload_len, rtp_ts);
 }
 
 /* Extract timestamp from control message */
@@ -509,16 +882,98 @@ static uint64_t extract_timestamp(struct msghdr *msg, audyn_aes_input_t *in) {
     return ts_ns;
 }
 
-static void *rx_thread_main(void *arg) {
-    audyn_aes_input_t *in = (audyn_aes_input_t *)arg;
-    if (!in) return NULL;
+/* Account one receive call that returned n packets. */
+static inline void count_rx_call(audyn_aes_input_t *in, unsigned n) {
+    ctr_add(&in->rx_syscalls, 1);
+    if (n > ctr_get(&in->rx_batch_max)) ctr_set(&in->rx_batch_max, n);
+    if (in->rx_batch > 1 && n == in->rx_batch) ctr_add(&in->rx_batch_full, 1);
+}
 
-#ifdef __linux__
-    (void)pthread_setname_np(pthread_self(), "audyn-aes-rx");
-#endif
+/* A hand-off leg passes the count along with its next packet */
+static inline void note_rx_batch(aes_leg_t *leg, unsigned n) {
+    if (leg->handoff) {
+        leg->ho_batch = (uint16_t)n;
+    } else {
+        count_rx_call(leg->in, n);
+    }
+}
+
+/* Returns -1 if the receive error is fatal to the loop, 0 to retry. */
+static int handle_rx_error(audyn_aes_input_t *in, const char *what) {
+    if (errno == EINTR) return 0;
+    if (stop_is_requested(in)) return -1;
+    if (errno == EAGAIN || errno == EWOULDBLOCK) return 0;
 
-    uint8_t buf[4096];
-    uint8_t ctrl_buf[256];
+    set_error_errno(in, what);
+    LOG_ERROR("aes_input: %s error: %s", what, strerror(errno));
+    usleep(10 * 1000);
+    return 0;
+}
+
+/* Copy a datagram into the hand-off ring; wakes the primary if it sleeps */
+static void handoff_push(aes_leg_t *leg, const uint8_t *pkt, size_t len, uint64_t arrival_ns,
+                         uint64_t rx_ns) {
+    const uint32_t h = atomic_load_explicit(&leg->ho_head, memory_order_relaxed);
+    const uint32_t t = atomic_load_explicit(&leg->ho_tail, memory_order_acquire);
+
+    if (h - t == AES_HANDOFF_SLOTS || len > AES_RX_BUF_BYTES) {
+        ctr_add(&leg->ho_dropped, 1);
+        return;
+    }
+
+    aes_handoff_slot_t *slot = &leg->handoff[h & (AES_HANDOFF_SLOTS - 1)];
+    memcpy(slot->data, pkt, len);
+    slot->len = (uint32_t)len;
+    slot->arrival_ns = arrival_ns;
+    slot->rx_ns = rx_ns;
+    slot->batch = leg->ho_batch;
+    leg->ho_batch = 0;
+    atomic_store_explicit(&leg->ho_head, h + 1, memory_order_seq_cst);
+
+    if (atomic_exchange_explicit(&leg->ho_armed, 0, memory_order_seq_cst)) {
+        const uint64_t one = 1;
+        if (write(leg->ho_wake_fd, &one, sizeof(one)) < 0) {
+            /* Counter already non-zero (EAGAIN): the primary is awake */
+        }
+    }
+}
+
+/* Parse and play out one datagram on the thread that owns the packet path */
+static int process_packet(aes_leg_t *leg, const uint8_t *pkt, size_t len, uint64_t arrival_ns,
+                          uint64_t rx_ns) {
+    audyn_aes_input_t *in = leg->in;
+
+    in->rx_ns = rx_ns;
+    ctr_add(&in->packets_rx, 1);
+    ctr_add(&leg->packets_rx, 1);
+    int rc = handle_packet(in, leg->index, pkt, len, arrival_ns);
+
+    if (rc != 0) {
+        LOG_ERROR("aes_input: fatal packet handling error: %s",
+                  audyn_aes_input_last_error(in) ? audyn_aes_input_last_error(in) : "unknown");
+        request_stop(in);
+        return -1;
+    }
+    return 0;
+}
+
+static int dispatch_packet(aes_leg_t *leg, const uint8_t *pkt, size_t len, uint64_t arrival_ns,
+                           uint64_t rx_ns) {
+    if (leg->handoff) {
+        handoff_push(leg, pkt, len, arrival_ns, rx_ns);
+        return 0;
+    }
+    return process_packet(leg, pkt, len, arrival_ns, rx_ns);
+}
+
+/*
+ * One receive call on a leg: flags 0 blocks up to SO_RCVTIMEO,
+ * MSG_DONTWAIT after poll(). Returns -1 to end the loop, 0 to go on.
+ */
+static int rx_once_single(aes_leg_t *leg, int flags) {
+    audyn_aes_input_t *in = leg->in;
+    uint8_t buf[AES_RX_BUF_BYTES];
+    uint8_t ctrl_buf[AES_RX_CTRL_BYTES];
     struct iovec iov;
     struct msghdr msg;
 
@@ -531,39 +986,252 @@ static void *rx_thread_main(void *arg) {
     msg.msg_control = ctrl_buf;
     msg.msg_controllen = sizeof(ctrl_buf);
 
+    ssize_t n = recvmsg(leg->sock_fd, &msg, flags);
+    if (n < 0) {
+        return handle_rx_error(in, "recvmsg()");
+    }
+    if (n == 0) return 0;
+
+    const uint64_t rx_ns = audyn_metrics_start();
+    note_rx_batch(leg, 1);
+
+    /* Extract timestamp from control messages */
+    uint64_t arrival_ns = extract_timestamp(&msg, in);
+
+    return dispatch_packet(leg, buf, (size_t)n, arrival_ns, rx_ns);
+}
+
+static int rx_once_batched(aes_leg_t *leg, int flags) {
+    audyn_aes_input_t *in = leg->in;
+    const unsigned batch = in->rx_batch;
+
+    /* Reset per-slot lengths clobbered by the previous call */
+    for (unsigned i = 0; i < batch; i++) {
+        leg->rx_msgs[i].msg_hdr.msg_controllen = AES_RX_CTRL_BYTES;
+        leg->rx_msgs[i].msg_hdr.msg_flags = 0;
+        leg->rx_msgs[i].msg_len = 0;
+    }
+
+    /* MSG_WAITFORONE: block (bounded by SO_RCVTIMEO) for the first
+     * datagram, then take whatever else is already queued. */
+    int n = recvmmsg(leg->sock_fd, leg->rx_msgs, batch, flags ? flags : MSG_WAITFORONE, NULL);
+    if (n < 0) {
+        return handle_rx_error(in, "recvmmsg()");
+    }
+    if (n == 0) return 0;
+
+    const uint64_t rx_ns = audyn_metrics_start();
+    note_rx_batch(leg, (unsigned)n);
+
+    for (int i = 0; i < n; i++) {
+        struct mmsghdr *m = &leg->rx_msgs[i];
+        if (m->msg_len == 0) continue;
+
+        uint64_t arrival_ns = extract_timestamp(&m->msg_hdr, in);
+        if (dispatch_packet(leg, leg->rx_bufs + (size_t)i * AES_RX_BUF_BYTES,
+                            (size_t)m->msg_len, arrival_ns, rx_ns) != 0) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+static int rx_once(aes_leg_t *leg, int flags) {
+    return leg->in->rx_batch > 1 ? rx_once_batched(leg, flags) : rx_once_single(leg, flags);
+}
+
+/* A receive wait ended with no packet: play out what the buffer holds */
+static int rx_idle(audyn_aes_input_t *in) {
+    if (!in->jb) return 0;
+
+    if (jb_tick(in) != 0) {
+        LOG_ERROR("aes_input: fatal playout error: %s",
+                  audyn_aes_input_last_error(in) ? audyn_aes_input_last_error(in) : "unknown");
+        request_stop(in);
+        return -1;
+    }
+    return 0;
+}
+
+/* Both legs on one thread: wait on both sockets, drain whichever is ready */
+static void rx_loop_poll(audyn_aes_input_t *in) {
+    struct pollfd pfd[AES_MAX_LEGS];
+
     while (!stop_is_requested(in)) {
-        /* Reset control message buffer for each receive */
-        msg.msg_controllen = sizeof(ctrl_buf);
-        msg.msg_flags = 0;
-
-        ssize_t n = recvmsg(in->sock_fd, &msg, 0);
-        if (n < 0) {
-            if (errno == EINTR) continue;
-            if (stop_is_requested(in)) break;
-            if (errno == EAGAIN || errno == EWOULDBLOCK) continue;
-
-            set_error_errno(in, "recvmsg()");
-            LOG_ERROR("aes_input: recvmsg error: %s", strerror(errno));
-            usleep(10 * 1000);
+        for (unsigned l = 0; l < in->n_legs; l++) {
+            pfd[l].fd = in->legs[l].sock_fd;
+            pfd[l].events = POLLIN;
+            pfd[l].revents = 0;
+        }
+
+        int ready = poll(pfd, in->n_legs, in->jb ? AES_JB_TICK_MS : 100);
+        if (ready < 0) {
+            if (handle_rx_error(in, "poll()") != 0) return;
+            continue;
+        }
+        if (ready == 0) {
+            if (rx_idle(in) != 0) return;
             continue;
         }
-        if (n == 0) continue;
 
-        /* Extract timestamp from control messages */
-        uint64_t arrival_ns = extract_timestamp(&msg, in);
+        for (unsigned l = 0; l < in->n_legs; l++) {
+            if ((pfd[l].revents & POLLIN) && rx_once(&in->legs[l], MSG_DONTWAIT) != 0) {
+                return;
+            }
+        }
+    }
+}
+
+/* Everything the second leg's thread has handed over, in arrival order */
+static int handoff_drain(aes_leg_t *leg) {
+    uint32_t t = atomic_load_explicit(&leg->ho_tail, memory_order_relaxed);
+    const uint32_t h = atomic_load_explicit(&leg->ho_head, memory_order_acquire);
+
+    while (t != h) {
+        const aes_handoff_slot_t *slot = &leg->handoff[t & (AES_HANDOFF_SLOTS - 1)];
+        if (slot->batch) count_rx_call(leg->in, slot->batch);
+        int rc = process_packet(leg, slot->data, slot->len, slot->arrival_ns, slot->rx_ns);
+        t++;
+        atomic_store_explicit(&leg->ho_tail, t, memory_order_release);
+        if (rc != 0) return -1;
+    }
+    return 0;
+}
 
-        in->packets_rx++;
-        if (handle_packet(in, buf, (size_t)n, arrival_ns) != 0) {
-            LOG_ERROR("aes_input: fatal packet handling error: %s",
-                      audyn_aes_input_last_error(in) ? audyn_aes_input_last_error(in) : "unknown");
-            request_stop(in);
-            break;
+/* Primary thread with a hand-off leg: own socket plus the ring's eventfd */
+static void rx_loop_handoff(audyn_aes_input_t *in) {
+    aes_leg_t *a = &in->legs[0];
+    aes_leg_t *b = &in->legs[1];
+    struct pollfd pfd[2];
+
+    while (!stop_is_requested(in)) {
+        if (handoff_drain(b) != 0) return;
+
+        /* Arm the wake-up, then make sure nothing slipped in before it */
+        atomic_store_explicit(&b->ho_armed, 1, memory_order_seq_cst);
+        if (atomic_load_explicit(&b->ho_head, memory_order_seq_cst) !=
+            atomic_load_explicit(&b->ho_tail, memory_order_relaxed)) {
+            continue;
+        }
+
+        pfd[0].fd = a->sock_fd;
+        pfd[0].events = POLLIN;
+        pfd[0].revents = 0;
+        pfd[1].fd = b->ho_wake_fd;
+        pfd[1].events = POLLIN;
+        pfd[1].revents = 0;
+
+        int ready = poll(pfd, 2, in->jb ? AES_JB_TICK_MS : 100);
+        if (ready < 0) {
+            if (handle_rx_error(in, "poll()") != 0) return;
+            continue;
+        }
+        if (ready == 0) {
+            if (rx_idle(in) != 0) return;
+            continue;
+        }
+        if (pfd[1].revents & POLLIN) {
+            uint64_t v;
+            if (read(b->ho_wake_fd, &v, sizeof(v)) < 0) {
+                /* EAGAIN: another wake-up was already consumed */
+            }
+        }
+        if ((pfd[0].revents & POLLIN) && rx_once(a, MSG_DONTWAIT) != 0) {
+            return;
         }
     }
+}
+
+static void *rx_thread_main(void *arg) {
+    aes_leg_t *leg = (aes_leg_t *)arg;
+    audyn_aes_input_t *in = leg->in;
+
+#ifdef __linux__
+    (void)pthread_setname_np(pthread_self(), leg->index ? "audyn-aes-rx-b" : "audyn-aes-rx");
+#endif
+
+    if (in->n_legs > 1 && !in->cfg.leg_threads) {
+        rx_loop_poll(in);
+        return NULL;
+    }
+    if (leg->index == 0 && in->legs[1].handoff) {
+        rx_loop_handoff(in);
+        return NULL;
+    }
+
+    while (!stop_is_requested(in)) {
+        const uint64_t rx_before = ctr_get(&leg->packets_rx);
+        if (rx_once(leg, 0) != 0) break;
+        if (!leg->handoff && ctr_get(&leg->packets_rx) == rx_before && rx_idle(in) != 0) break;
+    }
 
     return NULL;
 }
 
+/* Allocate per-slot buffers for recvmmsg(). */
+static int alloc_rx_batch(aes_leg_t *leg, uint16_t batch) {
+    if (batch <= 1) {
+        return 0;
+    }
+
+    leg->rx_bufs = (uint8_t *)calloc(batch, AES_RX_BUF_BYTES);
+    leg->rx_ctrl = (uint8_t *)calloc(batch, AES_RX_CTRL_BYTES);
+    leg->rx_iov  = (struct iovec *)calloc(batch, sizeof(struct iovec));
+    leg->rx_msgs = (struct mmsghdr *)calloc(batch, sizeof(struct mmsghdr));
+    if (!leg->rx_bufs || !leg->rx_ctrl || !leg->rx_iov || !leg->rx_msgs) {
+        return -1;
+    }
+
+    for (unsigned i = 0; i < batch; i++) {
+        leg->rx_iov[i].iov_base = leg->rx_bufs + (size_t)i * AES_RX_BUF_BYTES;
+        leg->rx_iov[i].iov_len = AES_RX_BUF_BYTES;
+
+        struct msghdr *h = &leg->rx_msgs[i].msg_hdr;
+        h->msg_iov = &leg->rx_iov[i];
+        h->msg_iovlen = 1;
+        h->msg_control = leg->rx_ctrl + (size_t)i * AES_RX_CTRL_BYTES;
+        h->msg_controllen = AES_RX_CTRL_BYTES;
+    }
+    return 0;
+}
+
+static void free_rx_batch(audyn_aes_input_t *in) {
+    for (unsigned l = 0; l < AES_MAX_LEGS; l++) {
+        aes_leg_t *leg = &in->legs[l];
+        free(leg->rx_msgs);
+        free(leg->rx_iov);
+        free(leg->rx_ctrl);
+        free(leg->rx_bufs);
+        leg->rx_msgs = NULL;
+        leg->rx_iov = NULL;
+        leg->rx_ctrl = NULL;
+        leg->rx_bufs = NULL;
+    }
+}
+
+/* Owned strings and per-leg buffers */
+static void free_owned(audyn_aes_input_t *in) {
+    free_rx_batch(in);
+    for (unsigned l = 0; l < AES_MAX_LEGS; l++) {
+        if (in->legs[l].ho_wake_fd >= 0) close(in->legs[l].ho_wake_fd);
+        free(in->legs[l].handoff);
+    }
+    free(in->merge);
+    free(in->bind_interface_b);
+    free(in->source_ip_b);
+    free(in->bind_interface);
+    free(in->source_ip);
+}
+
+static void close_legs(audyn_aes_input_t *in) {
+    for (unsigned l = 0; l < in->n_legs; l++) {
+        if (in->legs[l].sock_fd >= 0) {
+            close(in->legs[l].sock_fd);
+            in->legs[l].sock_fd = -1;
+        }
+    }
+}
+
 /* -------- Public API -------- */
 
 audyn_aes_input_t *
@@ -616,6 +1284,23 @@ audyn_aes_input_create(audyn_frame_pool_t *pool,
                   cfg->payload_type);
         return NULL;
     }
+    if (cfg->jitter_ms > AES_MAX_JITTER_MS) {
+        LOG_ERROR("aes_input: invalid jitter_ms %u (must be 0-%u)",
+                  cfg->jitter_ms, AES_MAX_JITTER_MS);
+        return NULL;
+    }
+    if (cfg->rx_batch > AES_MAX_RX_BATCH) {
+        LOG_ERROR("aes_input: invalid rx_batch %u (must be 0-%u)",
+                  cfg->rx_batch, AES_MAX_RX_BATCH);
+        return NULL;
+    }
+    const int dual = cfg->source_ip_b && cfg->source_ip_b[0] != '\0';
+    if (dual && cfg->jitter_ms == 0) {
+        /* Without a reorder stage a packet recovered from the slower leg
+         * would arrive after its successor */
+        LOG_ERROR("aes_input: a second leg needs jitter_ms > 0 (the merge window)");
+        return NULL;
+    }
 
     audyn_aes_input_t *in = (audyn_aes_input_t *)calloc(1, sizeof(*in));
     if (!in) {
@@ -626,34 +1311,65 @@ audyn_aes_input_create(audyn_frame_pool_t *pool,
     in->pool = pool;
     in->queue = queue;
     in->cfg = *cfg;
+    for (unsigned l = 0; l < AES_MAX_LEGS; l++) in->legs[l].ho_wake_fd = -1;
 
     /* Make owned copies of config strings */
     in->source_ip = strdup(cfg->source_ip);
-    if (!in->source_ip) {
-        LOG_ERROR("aes_input: failed to allocate source_ip");
+    if (cfg->bind_interface && cfg->bind_interface[0] != '\0') {
+        in->bind_interface = strdup(cfg->bind_interface);
+    }
+    if (dual) {
+        in->source_ip_b = strdup(cfg->source_ip_b);
+        if (cfg->bind_interface_b && cfg->bind_interface_b[0] != '\0') {
+            in->bind_interface_b = strdup(cfg->bind_interface_b);
+        }
+        in->merge = (aes_merge_slot_t *)calloc(AES_MERGE_WINDOW, sizeof(*in->merge));
+    }
+    if (!in->source_ip ||
+        (cfg->bind_interface && cfg->bind_interface[0] != '\0' && !in->bind_interface) ||
+        (dual && (!in->source_ip_b || !in->merge)) ||
+        (dual && cfg->bind_interface_b && cfg->bind_interface_b[0] != '\0' &&
+         !in->bind_interface_b)) {
+        LOG_ERROR("aes_input: failed to allocate configuration");
+        free_owned(in);
         free(in);
         return NULL;
     }
 
-    if (cfg->bind_interface && cfg->bind_interface[0] != '\0') {
-        in->bind_interface = strdup(cfg->bind_interface);
-        if (!in->bind_interface) {
-            LOG_ERROR("aes_input: failed to allocate bind_interface");
-            free(in->source_ip);
+    /* Legs: the second defaults to the primary's port and interface */
+    in->n_legs = dual ? 2 : 1;
+    in->rx_batch = cfg->rx_batch > 1 ? cfg->rx_batch : 1;
+    for (unsigned l = 0; l < in->n_legs; l++) {
+        aes_leg_t *leg = &in->legs[l];
+        leg->in = in;
+        leg->index = l;
+        leg->sock_fd = -1;
+        leg->source_ip = l ? in->source_ip_b : in->source_ip;
+        leg->port = (l && cfg->port_b) ? cfg->port_b : cfg->port;
+        leg->bind_interface = (l && in->bind_interface_b) ? in->bind_interface_b
+                                                          : in->bind_interface;
+        if (alloc_rx_batch(leg, in->rx_batch) != 0) {
+            LOG_ERROR("aes_input: failed to allocate rx batch buffers");
+            free_owned(in);
             free(in);
             return NULL;
         }
-    } else {
-        in->bind_interface = NULL;
+        if (l > 0 && cfg->leg_threads) {
+            leg->handoff = (aes_handoff_slot_t *)calloc(AES_HANDOFF_SLOTS, sizeof(*leg->handoff));
+            leg->ho_wake_fd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+            if (!leg->handoff || leg->ho_wake_fd < 0) {
+                LOG_ERROR("aes_input: failed to allocate leg hand-off");
+                free_owned(in);
+                free(in);
+                return NULL;
+            }
+        }
     }
-
-    in->sock_fd = -1;
     in->thread_started = 0;
 
     if (pthread_mutex_init(&in->err_mu, NULL) != 0) {
         LOG_ERROR("aes_input: failed to initialize error mutex");
-        free(in->bind_interface);
-        free(in->source_ip);
+        free_owned(in);
         free(in);
         return NULL;
     }
@@ -661,8 +1377,7 @@ audyn_aes_input_create(audyn_frame_pool_t *pool,
     if (pthread_mutex_init(&in->state_mu, NULL) != 0) {
         LOG_ERROR("aes_input: failed to initialize state mutex");
         pthread_mutex_destroy(&in->err_mu);
-        free(in->bind_interface);
-        free(in->source_ip);
+        free_owned(in);
         free(in);
         return NULL;
     }
@@ -671,6 +1386,47 @@ audyn_aes_input_create(audyn_frame_pool_t *pool,
     in->last_error[0] = '\0';
     in->have_seq = 0;
 
+    /* Layout was validated above; bind kernels for both payload formats */
+    (void)audyn_pcm_decoder_init(&in->dec_l16, AUDYN_PCM_L16, stream_ch,
+                                 cfg->channel_offset, cfg->channels, AUDYN_PCM_ISA_AUTO);
+    (void)audyn_pcm_decoder_init(&in->dec_l24, AUDYN_PCM_L24, stream_ch,
+                                 cfg->channel_offset, cfg->channels, AUDYN_PCM_ISA_AUTO);
+    LOG_DEBUG("aes_input: decode kernels %s / %s",
+              in->dec_l16.name, in->dec_l24.name);
+
+    if (cfg->jitter_ms > 0) {
+        audyn_jb_cfg_t jcfg;
+        memset(&jcfg, 0, sizeof(jcfg));
+        jcfg.sample_rate = cfg->sample_rate;
+        jcfg.channels = stream_ch;
+        jcfg.bits_per_sample = 24;      /* Slots sized for L24 (L16 also fits) */
+        jcfg.samples_per_packet = cfg->samples_per_packet;
+        jcfg.depth_ms = cfg->jitter_ms;
+
+        in->jb = audyn_jb_create(&jcfg);
+        if (!in->jb) {
+            LOG_ERROR("aes_input: failed to create jitter buffer");
+            pthread_mutex_destroy(&in->state_mu);
+            pthread_mutex_destroy(&in->err_mu);
+            free_owned(in);
+            free(in);
+            return NULL;
+        }
+    }
+
+    if (in->rx_batch > 1) {
+        LOG_INFO("aes_input: batched receive enabled (recvmmsg, batch=%u)",
+                 (unsigned)in->rx_batch);
+    }
+
+    if (dual) {
+        LOG_INFO("aes_input: ST 2022-7 second leg %s:%u%s%s (%s)",
+                 in->legs[1].source_ip, (unsigned)in->legs[1].port,
+                 in->legs[1].bind_interface ? " on " : "",
+                 in->legs[1].bind_interface ? in->legs[1].bind_interface : "",
+                 cfg->leg_threads ? "thread per leg" : "shared thread");
+    }
+
     if (in->cfg.stream_channels > 0 && in->cfg.stream_channels != in->cfg.channels) {
         LOG_INFO("aes_input: created (%s:%u PT=%u rate=%u ch=%u spp=%u stream_ch=%u offset=%u)",
                  in->source_ip, (unsigned)in->cfg.port, (unsigned)in->cfg.payload_type,
@@ -695,15 +1451,34 @@ int audyn_aes_input_start(audyn_aes_input_t *in) {
     in->stop_requested = 0;
     pthread_mutex_unlock(&in->state_mu);
 
-    if (open_socket(in) != 0) return -1;
+    for (unsigned l = 0; l < in->n_legs; l++) {
+        if (open_socket(&in->legs[l]) != 0) {
+            close_legs(in);
+            return -1;
+        }
+    }
 
-    int rc = pthread_create(&in->thread, NULL, rx_thread_main, in);
-    if (rc != 0) {
-        errno = rc;
-        set_error_errno(in, "pthread_create()");
-        close(in->sock_fd);
-        in->sock_fd = -1;
-        return -1;
+    /* Sole receiver for this clock: playout can use its RTP mapping */
+    in->jb_ptp_mapping = (in->ptp_clk != NULL);
+
+    /* One thread serves every leg unless each gets its own */
+    const unsigned n_threads = in->cfg.leg_threads ? in->n_legs : 1;
+    for (unsigned l = 0; l < n_threads; l++) {
+        aes_leg_t *leg = &in->legs[l];
+        int rc = pthread_create(&leg->thread, NULL, rx_thread_main, leg);
+        if (rc != 0) {
+            errno = rc;
+            set_error_errno(in, "pthread_create()");
+            request_stop(in);
+            for (unsigned k = 0; k < l; k++) {
+                (void)pthread_join(in->legs[k].thread, NULL);
+                in->legs[k].thread_started = 0;
+            }
+            close_legs(in);
+            return -1;
+        }
+        leg->thread_started = 1;
+        (void)audyn_rt_thread(leg->thread, AUDYN_RT_ROLE_RX);
     }
 
     in->thread_started = 1;
@@ -719,39 +1494,84 @@ void audyn_aes_input_stop(audyn_aes_input_t *in) {
     if (!in) return;
 
     if (!in->thread_started) {
-        if (in->sock_fd >= 0) {
-            close(in->sock_fd);
-            in->sock_fd = -1;
-        }
+        close_legs(in);
         return;
     }
 
     request_stop(in);
 
-    if (in->sock_fd >= 0) {
-        close(in->sock_fd);
-        in->sock_fd = -1;
+    /* Receive calls time out (SO_RCVTIMEO / poll) and see the request */
+    for (unsigned l = 0; l < in->n_legs; l++) {
+        if (in->legs[l].thread_started) {
+            (void)pthread_join(in->legs[l].thread, NULL);
+            in->legs[l].thread_started = 0;
+        }
     }
-
-    (void)pthread_join(in->thread, NULL);
+    close_legs(in);
     in->thread_started = 0;
 
+    /* Whatever the second leg handed over after the primary stopped */
+    if (in->n_legs > 1 && in->legs[1].handoff) {
+        aes_leg_t *b = &in->legs[1];
+        atomic_store_explicit(&b->ho_tail, atomic_load(&b->ho_head), memory_order_relaxed);
+        atomic_store_explicit(&b->ho_armed, 0, memory_order_relaxed);
+    }
+
     LOG_INFO("aes_input: stopped (rx=%llu dropped=%llu disc=%llu pool_drop=%llu q_drop=%llu pushed=%llu)",
-             (unsigned long long)in->packets_rx,
-             (unsigned long long)in->packets_dropped,
-             (unsigned long long)in->discontinuities,
-             (unsigned long long)in->frames_dropped_pool_empty,
-             (unsigned long long)in->frames_dropped_queue_full,
-             (unsigned long long)in->frames_pushed);
+             (unsigned long long)ctr_get(&in->packets_rx),
+             (unsigned long long)(ctr_get(&in->packets_dropped) + ctr_get(&in->legs[1].ho_dropped)),
+             (unsigned long long)ctr_get(&in->discontinuities),
+             (unsigned long long)ctr_get(&in->frames_dropped_pool_empty),
+             (unsigned long long)ctr_get(&in->frames_dropped_queue_full),
+             (unsigned long long)ctr_get(&in->frames_pushed));
+
+    if (in->jb) {
+        audyn_jb_stats_t js;
+        audyn_jb_get_stats(in->jb, &js);
+        LOG_INFO("aes_input: jitter buffer (played=%llu lost=%llu late=%llu reordered=%llu overflows=%llu max_depth=%d concealed=%llu)",
+                 (unsigned long long)js.packets_played,
+                 (unsigned long long)js.packets_lost,
+                 (unsigned long long)js.packets_late,
+                 (unsigned long long)js.packets_reordered,
+                 (unsigned long long)js.buffer_overflows,
+                 (int)js.max_depth,
+                 (unsigned long long)ctr_get(&in->frames_concealed));
+    }
+
+    if (in->n_legs > 1) {
+        /* Settle the packets still in the merge window */
+        for (unsigned i = 0; i < AES_MERGE_WINDOW; i++) {
+            merge_retire(in, &in->merge[i]);
+        }
+        memset(in->merge, 0, AES_MERGE_WINDOW * sizeof(*in->merge));
+        in->merge_started = 0;
+
+        LOG_INFO("aes_input: legs (A: rx=%llu lost=%llu recovered=%llu, B: rx=%llu lost=%llu recovered=%llu, duplicates=%llu)",
+                 (unsigned long long)ctr_get(&in->legs[0].packets_rx),
+                 (unsigned long long)ctr_get(&in->legs[0].packets_lost),
+                 (unsigned long long)ctr_get(&in->legs[0].packets_recovered),
+                 (unsigned long long)ctr_get(&in->legs[1].packets_rx),
+                 (unsigned long long)ctr_get(&in->legs[1].packets_lost),
+                 (unsigned long long)ctr_get(&in->legs[1].packets_recovered),
+                 (unsigned long long)ctr_get(&in->duplicates));
+    }
+
+    if (in->rx_batch > 1 && ctr_get(&in->rx_syscalls) > 0) {
+        LOG_INFO("aes_input: rx batching (calls=%llu avg=%.2f max=%llu full=%llu)",
+                 (unsigned long long)ctr_get(&in->rx_syscalls),
+                 (double)ctr_get(&in->packets_rx) / (double)ctr_get(&in->rx_syscalls),
+                 (unsigned long long)ctr_get(&in->rx_batch_max),
+                 (unsigned long long)ctr_get(&in->rx_batch_full));
+    }
 }
 
 void audyn_aes_input_destroy(audyn_aes_input_t *in) {
     if (!in) return;
     audyn_aes_input_stop(in);
+    audyn_jb_destroy(in->jb);
     pthread_mutex_destroy(&in->err_mu);
     pthread_mutex_destroy(&in->state_mu);
-    free(in->bind_interface);
-    free(in->source_ip);
+    free_owned(in);
     free(in);
 }
 
@@ -765,6 +1585,50 @@ const char *audyn_aes_input_last_error(const audyn_aes_input_t *in) {
     return msg;
 }
 
+int audyn_aes_input_get_jb_stats(const audyn_aes_input_t *in, audyn_jb_stats_t *stats) {
+    if (!stats) return -1;
+    if (!in || !in->jb) {
+        memset(stats, 0, sizeof(*stats));
+        return -1;
+    }
+    audyn_jb_get_stats(in->jb, stats);
+    return 0;
+}
+
+void audyn_aes_input_get_cfg(const audyn_aes_input_t *in, audyn_aes_input_cfg_t *cfg) {
+    if (!cfg) return;
+    if (!in) {
+        memset(cfg, 0, sizeof(*cfg));
+        return;
+    }
+    *cfg = in->cfg;
+    cfg->source_ip = in->source_ip;
+    cfg->bind_interface = in->bind_interface;
+    cfg->source_ip_b = in->source_ip_b;
+    cfg->bind_interface_b = in->bind_interface_b;
+}
+
+int audyn_aes_input_tick(audyn_aes_input_t *in) {
+    if (!in) return -1;
+    if (in->thread_started) {
+        set_error(in, "aes_input_tick() on an input with its own receive thread");
+        return -1;
+    }
+    return jb_tick(in);
+}
+
+int audyn_aes_input_feed(audyn_aes_input_t *in, const uint8_t *pkt, size_t len, uint64_t arrival_ns) {
+    if (!in || !pkt) return -1;
+    if (in->thread_started) {
+        set_error(in, "aes_input_feed() on an input with its own receive thread");
+        return -1;
+    }
+    in->rx_ns = audyn_metrics_start();  /* From the mux hand-off */
+    ctr_add(&in->packets_rx, 1);
+    ctr_add(&in->legs[0].packets_rx, 1);
+    return handle_packet(in, 0, pkt, len, arrival_ns);
+}
+
 void audyn_aes_input_set_ptp_clock(audyn_aes_input_t *in, audyn_ptp_clock_t *clk) {
     if (!in) return;
     if (in->thread_started) {
@@ -812,10 +1676,21 @@ void audyn_aes_input_get_stats(const audyn_aes_input_t *in, audyn_aes_stats_t *s
         return;
     }
 
-    stats->packets_rx = in->packets_rx;
-    stats->packets_dropped = in->packets_dropped;
-    stats->discontinuities = in->discontinuities;
-    stats->frames_pushed = in->frames_pushed;
-    stats->frames_dropped_pool = in->frames_dropped_pool_empty;
-    stats->frames_dropped_queue = in->frames_dropped_queue_full;
+    stats->packets_rx = ctr_get(&in->packets_rx);
+    stats->packets_dropped = ctr_get(&in->packets_dropped) + ctr_get(&in->legs[1].ho_dropped);
+    stats->discontinuities = ctr_get(&in->discontinuities);
+    stats->frames_pushed = ctr_get(&in->frames_pushed);
+    stats->frames_dropped_pool = ctr_get(&in->frames_dropped_pool_empty);
+    stats->frames_dropped_queue = ctr_get(&in->frames_dropped_queue_full);
+    stats->frames_concealed = ctr_get(&in->frames_concealed);
+    stats->rx_syscalls = ctr_get(&in->rx_syscalls);
+    stats->rx_batch_max = ctr_get(&in->rx_batch_max);
+    stats->rx_batch_full = ctr_get(&in->rx_batch_full);
+
+    for (unsigned l = 0; l < AES_MAX_LEGS; l++) {
+        stats->leg_packets_rx[l] = ctr_get(&in->legs[l].packets_rx);
+        stats->leg_packets_lost[l] = ctr_get(&in->legs[l].packets_lost);
+        stats->leg_packets_recovered[l] = ctr_get(&in->legs[l].packets_recovered);
+    }
+    stats->duplicates = ctr_get(&in->duplicates);
 }
@@ -51,6 +51,7 @@
 #include "frame_pool.h"
 #include "audio_queue.h"
 #include "ptp_clock.h"
+#include "jitter_buffer.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -68,6 +69,19 @@ typedef struct audyn_aes_stats {
     uint64_t frames_pushed;           /* Frames successfully pushed to queue */
     uint64_t frames_dropped_pool;     /* Drops due to frame pool exhaustion */
     uint64_t frames_dropped_queue;    /* Drops due to audio queue full */
+    uint64_t frames_concealed;        /* Silence frames inserted for lost packets (jitter buffer) */
+
+    /* Receive batching (average batch = packets_rx / rx_syscalls) */
+    uint64_t rx_syscalls;             /* recvmsg()/recvmmsg() calls that returned data */
+    uint64_t rx_batch_max;            /* Largest number of packets returned by one call */
+    uint64_t rx_batch_full;           /* Calls that filled every batch slot (backlog) */
+
+    /* ST 2022-7 legs ([0] primary, [1] second; zero with one leg).
+     * Recovered packets are counted as they leave the merge window. */
+    uint64_t leg_packets_rx[2];       /* Packets received on each leg */
+    uint64_t leg_packets_lost[2];     /* Sequence gaps in each leg's own stream */
+    uint64_t leg_packets_recovered[2];/* Packets only this leg delivered */
+    uint64_t duplicates;              /* Second copies dropped before decode */
 } audyn_aes_stats_t;
 
 typedef struct audyn_aes_input_cfg {
@@ -87,6 +101,38 @@ typedef struct audyn_aes_input_cfg {
     uint16_t    stream_channels;    /* Total channels in stream (0 = same as channels) */
     uint16_t    channel_offset;     /* First channel to extract (0-based, default 0) */
                                     /* e.g., offset=4, channels=2 extracts channels 5-6 */
+
+    /* Batched receive: drain up to rx_batch datagrams per wakeup with
+     * recvmmsg(). 0 or 1 = one recvmsg() per packet. Max 64. */
+    uint16_t    rx_batch;
+
+    /* Accept only packets from this RTP SSRC (0 = any source) */
+    uint32_t    ssrc;
+
+    /* Jitter buffer depth in ms (0 = disabled, max 200). When enabled,
+     * packets are reordered by sequence number and played out at their
+     * RTP media time + depth; missing packets become silence frames. */
+    uint32_t    jitter_ms;
+
+    /* L24 passthrough: also copy the selected channels of L24 packets into
+     * frame->raw as packed S24LE (pool must have raw buffers enabled with 3
+     * bytes per sample). L16 packets and concealment set raw_frames = 0. */
+    int         raw_s24;
+
+    /* With raw_s24: skip the float decode for frames that carry raw
+     * samples (only when nothing downstream reads frame->data for them). */
+    int         raw_only;
+
+    /* SMPTE ST 2022-7 seamless protection: the same stream (identical
+     * SSRC, sequence numbers and timestamps) on a second path, for example
+     * the blue network. Packets are merged by sequence number, the first
+     * copy wins. Requires jitter_ms > 0: the jitter buffer is the reorder
+     * window across legs, so its depth must cover the path difference.
+     * Not available through audyn_aes_input_feed(). */
+    const char *source_ip_b;        /* Second leg group/source (NULL = single leg) */
+    uint16_t    port_b;             /* 0 = same as port */
+    const char *bind_interface_b;   /* NULL = same as bind_interface */
+    int         leg_threads;        /* 1 = a receive thread per leg (else poll()) */
 } audyn_aes_input_cfg_t;
 
 typedef struct audyn_aes_input audyn_aes_input_t;
@@ -138,6 +184,53 @@ const char *audyn_aes_input_last_error(const audyn_aes_input_t *in);
  */
 void audyn_aes_input_get_stats(const audyn_aes_input_t *in, audyn_aes_stats_t *stats);
 
+/*
+ * Get jitter buffer statistics.
+ *
+ * Safe to call while input is running.
+ *
+ * Returns 0 on success, -1 if the jitter buffer is not enabled.
+ */
+int audyn_aes_input_get_jb_stats(const audyn_aes_input_t *in, audyn_jb_stats_t *stats);
+
+/*
+ * Get the instance configuration.
+ *
+ * String members point at storage owned by the input and remain valid
+ * until audyn_aes_input_destroy().
+ */
+void audyn_aes_input_get_cfg(const audyn_aes_input_t *in, audyn_aes_input_cfg_t *cfg);
+
+/*
+ * Feed one externally received RTP datagram through the input.
+ *
+ * Used when several inputs share receive sockets/threads (see aes_mux.h).
+ * The input must not be started with audyn_aes_input_start() and must only
+ * be fed from a single thread (it is the producer of its audio queue).
+ *
+ * Parameters:
+ *   in         - input instance
+ *   pkt, len   - complete RTP datagram
+ *   arrival_ns - arrival timestamp (0 if unknown)
+ *
+ * Returns:
+ *   0 on success (including packets dropped and counted),
+ *   -1 on fatal error (see audyn_aes_input_get_last_error())
+ */
+int audyn_aes_input_feed(audyn_aes_input_t *in, const uint8_t *pkt, size_t len, uint64_t arrival_ns);
+
+/*
+ * Jitter buffer playout while no datagrams arrive for this input.
+ *
+ * A fed input's buffer is otherwise only played out when a packet is fed,
+ * so audio held when a stream stalls would reach the worker after its
+ * silence fill. Call from the feeding thread every few milliseconds while
+ * the input is idle; no-op without a jitter buffer.
+ *
+ * Returns 0, or -1 on fatal error (see audyn_aes_input_get_last_error())
+ */
+int audyn_aes_input_tick(audyn_aes_input_t *in);
+
 /*
  * Set the PTP clock for packet timestamping.
  *
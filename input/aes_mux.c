@@ -0,0 +1,746 @@
+#define _GNU_SOURCE
+
+/*
+ *  Audyn — Professional Audio Capture & Archival Engine
+ *
+ *  File:
+ *      aes_mux.c
+ *
+ *  Purpose:
+ *      Shared AES67 / RTP receiver for multi-stream capture.
+ *
+ *      Owns the sockets and receive threads for many audyn_aes_input
+ *      sessions and demultiplexes datagrams by destination group, port
+ *      and SSRC. See aes_mux.h for the design overview.
+ *
+ *  Copyright:
+ *      (c) 2026 B. Wynne
+ *
+ *  Author:
+ *      B. Wynne
+ *
+ *  License:
+ *      GPLv2 or later
+ */
+
+#include "aes_mux.h"
+
+#include <stdio.h>
+#include <errno.h>
+#include <string.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <poll.h>
+#include <time.h>
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <sys/socket.h>
+#include <sys/ioctl.h>
+#include <net/if.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+#ifdef __linux__
+#include <linux/net_tstamp.h>
+#endif
+
+#include "log.h"
+#include "rt.h"
+
+/* -------- Limits -------- */
+
+#define MUX_DEFAULT_RX_BATCH 32
+#define MUX_MAX_RX_BATCH     64
+
+#define MUX_RX_BUF_BYTES  4096
+#define MUX_RX_CTRL_BYTES 256
+
+/* poll() timeout; bounds stop latency like SO_RCVTIMEO in aes_input */
+#define MUX_POLL_TIMEOUT_MS 100
+
+/* Jitter buffer playout period for sessions with jitter_ms > 0 (matches
+ * AES_JB_TICK_MS in aes_input) */
+#define MUX_JB_TICK_MS 5
+
+/* -------- Types -------- */
+
+typedef struct mux_session {
+    audyn_aes_input_t *in;          /* Not owned */
+    in_addr_t  group;               /* Network order, 0 = any destination */
+    uint16_t   port;
+    uint32_t   ssrc;                /* 0 = any */
+    int        jitter;              /* Has a jitter buffer: needs playout ticks */
+    int        failed;              /* Fatal feed error, no longer fed */
+    int        next;                /* Next session on same socket, -1 = end */
+} mux_session_t;
+
+typedef struct mux_socket {
+    int       fd;
+    uint16_t  port;
+    int       first_session;
+    unsigned  thread;
+} mux_socket_t;
+
+typedef struct mux_thread {
+    audyn_aes_mux_t *mux;
+    unsigned  index;
+    pthread_t thread;
+    int       started;
+
+    /* recvmmsg() slots (allocated at start) */
+    uint8_t        *bufs;
+    uint8_t        *ctrl;
+    struct iovec   *iov;
+    struct mmsghdr *msgs;
+
+    /* Counters (written by this thread only, read live by get_stats) */
+    _Atomic uint64_t packets_rx;
+    _Atomic uint64_t packets_unrouted;
+    _Atomic uint64_t deliveries;
+    _Atomic uint64_t rx_syscalls;
+} mux_thread_t;
+
+struct audyn_aes_mux {
+    audyn_aes_mux_cfg_t cfg;
+    char *bind_interface;
+    uint16_t rx_batch;
+
+    audyn_ptp_clock_t *ptp_clk;     /* Optional (not owned) */
+    int hw_timestamps_enabled;
+
+    mux_session_t sessions[AUDYN_AES_MUX_MAX_SESSIONS];
+    unsigned      n_sessions;
+
+    mux_socket_t  sockets[AUDYN_AES_MUX_MAX_SOCKETS];
+    unsigned      n_sockets;
+
+    mux_thread_t  threads[AUDYN_AES_MUX_MAX_THREADS];
+    unsigned      n_threads;
+
+    pthread_mutex_t state_mu;
+    int stop_requested;
+    int running;
+};
+
+/* -------- Helpers -------- */
+
+/* Single-writer counters: relaxed load + store, no locked add */
+static inline void ctr_add(_Atomic uint64_t *c, uint64_t n) {
+    atomic_store_explicit(c, atomic_load_explicit(c, memory_order_relaxed) + n, memory_order_relaxed);
+}
+
+static inline uint64_t ctr_get(const _Atomic uint64_t *c) {
+    return atomic_load_explicit(c, memory_order_relaxed);
+}
+
+static int stop_is_requested(audyn_aes_mux_t *mux) {
+    pthread_mutex_lock(&mux->state_mu);
+    int v = mux->stop_requested;
+    pthread_mutex_unlock(&mux->state_mu);
+    return v;
+}
+
+static void set_stop(audyn_aes_mux_t *mux, int v) {
+    pthread_mutex_lock(&mux->state_mu);
+    mux->stop_requested = v;
+    pthread_mutex_unlock(&mux->state_mu);
+}
+
+static int is_ipv4_multicast(in_addr_t a) {
+    uint32_t host = ntohl(a);
+    return (host >= 0xE0000000u) && (host <= 0xEFFFFFFFu);
+}
+
+static inline uint32_t rd_be32(const uint8_t *p) {
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) |
+           ((uint32_t)p[2] << 8) | (uint32_t)p[3];
+}
+
+static void free_thread_slots(mux_thread_t *t) {
+    free(t->msgs);
+    free(t->iov);
+    free(t->ctrl);
+    free(t->bufs);
+    t->msgs = NULL;
+    t->iov = NULL;
+    t->ctrl = NULL;
+    t->bufs = NULL;
+}
+
+static int alloc_thread_slots(mux_thread_t *t, unsigned batch) {
+    t->bufs = (uint8_t *)calloc(batch, MUX_RX_BUF_BYTES);
+    t->ctrl = (uint8_t *)calloc(batch, MUX_RX_CTRL_BYTES);
+    t->iov  = (struct iovec *)calloc(batch, sizeof(struct iovec));
+    t->msgs = (struct mmsghdr *)calloc(batch, sizeof(struct mmsghdr));
+    if (!t->bufs || !t->ctrl || !t->iov || !t->msgs) {
+        free_thread_slots(t);
+        return -1;
+    }
+
+    for (unsigned i = 0; i < batch; i++) {
+        t->iov[i].iov_base = t->bufs + (size_t)i * MUX_RX_BUF_BYTES;
+        t->iov[i].iov_len = MUX_RX_BUF_BYTES;
+
+        struct msghdr *h = &t->msgs[i].msg_hdr;
+        h->msg_iov = &t->iov[i];
+        h->msg_iovlen = 1;
+        h->msg_control = t->ctrl + (size_t)i * MUX_RX_CTRL_BYTES;
+        h->msg_controllen = MUX_RX_CTRL_BYTES;
+    }
+    return 0;
+}
+
+/* -------- Socket setup -------- */
+
+static int join_group(int fd, in_addr_t group, struct in_addr ifaddr) {
+    struct ip_mreq mreq;
+    memset(&mreq, 0, sizeof(mreq));
+    mreq.imr_multiaddr.s_addr = group;
+    mreq.imr_interface = ifaddr;
+
+    if (setsockopt(fd, IPPROTO_IP, IP_ADD_MEMBERSHIP, &mreq, sizeof(mreq)) != 0) {
+        char ga[INET_ADDRSTRLEN];
+        struct in_addr g = { .s_addr = group };
+        inet_ntop(AF_INET, &g, ga, sizeof(ga));
+        LOG_ERROR("aes_mux: IP_ADD_MEMBERSHIP %s failed: %s", ga, strerror(errno));
+        return -1;
+    }
+    return 0;
+}
+
+static int open_mux_socket(audyn_aes_mux_t *mux, mux_socket_t *sk, struct in_addr ifaddr) {
+    int fd = socket(AF_INET, SOCK_DGRAM, 0);
+    if (fd < 0) {
+        LOG_ERROR("aes_mux: socket() failed: %s", strerror(errno));
+        return -1;
+    }
+
+    int yes = 1;
+    (void)setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &yes, sizeof(yes));
+
+    if (mux->cfg.socket_rcvbuf > 0) {
+        int rcv = (int)mux->cfg.socket_rcvbuf;
+        if (setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &rcv, sizeof(rcv)) != 0) {
+            /* Non-fatal */
+            LOG_ERROR("aes_mux: failed to set SO_RCVBUF=%d: %s", rcv, strerror(errno));
+        }
+    }
+
+    /* Destination address is needed to demultiplex groups sharing a port */
+    if (setsockopt(fd, IPPROTO_IP, IP_PKTINFO, &yes, sizeof(yes)) != 0) {
+        LOG_ERROR("aes_mux: IP_PKTINFO failed: %s", strerror(errno));
+        close(fd);
+        return -1;
+    }
+
+#ifdef IP_MULTICAST_ALL
+    /* Only deliver groups joined on this socket, not every group joined
+     * by any socket on the host for this port. */
+    int no = 0;
+    (void)setsockopt(fd, IPPROTO_IP, IP_MULTICAST_ALL, &no, sizeof(no));
+#endif
+
+#ifdef __linux__
+    if (mux->ptp_clk) {
+        int ts_flags;
+        if (audyn_ptp_clock_mode(mux->ptp_clk) == AUDYN_PTP_MODE_HARDWARE) {
+            ts_flags = SOF_TIMESTAMPING_RX_HARDWARE |
+                       SOF_TIMESTAMPING_RAW_HARDWARE |
+                       SOF_TIMESTAMPING_SOFTWARE;
+        } else {
+            ts_flags = SOF_TIMESTAMPING_RX_SOFTWARE | SOF_TIMESTAMPING_SOFTWARE;
+        }
+        if (setsockopt(fd, SOL_SOCKET, SO_TIMESTAMPING, &ts_flags, sizeof(ts_flags)) != 0) {
+            LOG_ERROR("aes_mux: SO_TIMESTAMPING failed on port %u: %s",
+                      (unsigned)sk->port, strerror(errno));
+        }
+    }
+#endif
+
+    struct sockaddr_in sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.sin_family = AF_INET;
+    sa.sin_port = htons(sk->port);
+    sa.sin_addr.s_addr = htonl(INADDR_ANY);
+
+    if (bind(fd, (struct sockaddr *)&sa, sizeof(sa)) != 0) {
+        LOG_ERROR("aes_mux: bind() port %u failed: %s", (unsigned)sk->port, strerror(errno));
+        close(fd);
+        return -1;
+    }
+
+    /* Join each distinct group routed to this socket once */
+    unsigned groups = 0;
+    for (int s = sk->first_session; s >= 0; s = mux->sessions[s].next) {
+        in_addr_t g = mux->sessions[s].group;
+        if (g == 0) continue;
+
+        int seen = 0;
+        for (int p = sk->first_session; p != s; p = mux->sessions[p].next) {
+            if (mux->sessions[p].group == g) { seen = 1; break; }
+        }
+        if (seen) continue;
+
+        if (join_group(fd, g, ifaddr) != 0) {
+            close(fd);
+            return -1;
+        }
+        groups++;
+    }
+
+    sk->fd = fd;
+    LOG_INFO("aes_mux: port %u open (%u group%s, thread %u)",
+             (unsigned)sk->port, groups, groups == 1 ? "" : "s", sk->thread);
+    return 0;
+}
+
+static int resolve_interface(audyn_aes_mux_t *mux, struct in_addr *out) {
+    out->s_addr = htonl(INADDR_ANY);
+    if (!mux->bind_interface) return 0;
+
+    int fd = socket(AF_INET, SOCK_DGRAM, 0);
+    if (fd < 0) {
+        LOG_ERROR("aes_mux: socket() failed: %s", strerror(errno));
+        return -1;
+    }
+
+    struct ifreq ifr;
+    memset(&ifr, 0, sizeof(ifr));
+    strncpy(ifr.ifr_name, mux->bind_interface, IFNAMSIZ - 1);
+
+    if (ioctl(fd, SIOCGIFADDR, &ifr) < 0) {
+        LOG_ERROR("aes_mux: failed to get IP for interface '%s': %s",
+                  mux->bind_interface, strerror(errno));
+        close(fd);
+        return -1;
+    }
+    close(fd);
+
+    struct sockaddr_in *ifaddr = (struct sockaddr_in *)&ifr.ifr_addr;
+    *out = ifaddr->sin_addr;
+    LOG_INFO("aes_mux: binding multicast to interface '%s' (%s)",
+             mux->bind_interface, inet_ntoa(ifaddr->sin_addr));
+    return 0;
+}
+
+/* -------- Receive path -------- */
+
+/* Walk control messages once for destination address and timestamp. */
+static void parse_cmsgs(audyn_aes_mux_t *mux, struct msghdr *msg,
+                        in_addr_t *dst, uint64_t *ts_ns)
+{
+    *dst = 0;
+    *ts_ns = 0;
+
+    struct cmsghdr *cmsg;
+    for (cmsg = CMSG_FIRSTHDR(msg); cmsg != NULL; cmsg = CMSG_NXTHDR(msg, cmsg)) {
+        if (cmsg->cmsg_level == IPPROTO_IP && cmsg->cmsg_type == IP_PKTINFO) {
+            struct in_pktinfo *pi = (struct in_pktinfo *)CMSG_DATA(cmsg);
+            *dst = pi->ipi_addr.s_addr;
+        }
+#ifdef __linux__
+        else if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SO_TIMESTAMPING) {
+            struct timespec *ts = (struct timespec *)CMSG_DATA(cmsg);
+            /* ts[0] = software, ts[1] = deprecated, ts[2] = hardware */
+            if (mux->hw_timestamps_enabled && (ts[2].tv_sec != 0 || ts[2].tv_nsec != 0)) {
+                *ts_ns = (uint64_t)ts[2].tv_sec * 1000000000ULL + (uint64_t)ts[2].tv_nsec;
+            } else if (ts[0].tv_sec != 0 || ts[0].tv_nsec != 0) {
+                *ts_ns = (uint64_t)ts[0].tv_sec * 1000000000ULL + (uint64_t)ts[0].tv_nsec;
+            }
+        }
+#endif
+    }
+
+    /* Fallback to PTP clock if no timestamp from socket */
+    if (*ts_ns == 0 && mux->ptp_clk) {
+        *ts_ns = audyn_ptp_clock_now_ns(mux->ptp_clk);
+    }
+}
+
+static uint64_t mono_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+/* Play out held jitter buffer audio of this thread's sessions */
+static void tick_sessions(mux_thread_t *t) {
+    audyn_aes_mux_t *mux = t->mux;
+
+    for (unsigned i = 0; i < mux->n_sockets; i++) {
+        if (mux->sockets[i].thread != t->index) continue;
+        for (int s = mux->sockets[i].first_session; s >= 0; s = mux->sessions[s].next) {
+            mux_session_t *se = &mux->sessions[s];
+            if (se->failed || !se->jitter) continue;
+            if (audyn_aes_input_tick(se->in) != 0) {
+                char err[256];
+                audyn_aes_input_get_last_error(se->in, err, sizeof(err));
+                LOG_ERROR("aes_mux: session %d disabled after fatal error: %s", s, err);
+                se->failed = 1;
+            }
+        }
+    }
+}
+
+static void route_packet(mux_thread_t *t, mux_socket_t *sk, const uint8_t *pkt,
+                         size_t len, in_addr_t dst, uint64_t arrival_ns)
+{
+    audyn_aes_mux_t *mux = t->mux;
+    uint32_t ssrc = (len >= 12) ? rd_be32(pkt + 8) : 0;
+    int matched = 0;
+
+    for (int s = sk->first_session; s >= 0; s = mux->sessions[s].next) {
+        mux_session_t *se = &mux->sessions[s];
+        if (se->failed) continue;
+        if (se->group != 0 && se->group != dst) continue;
+        if (se->ssrc != 0 && se->ssrc != ssrc) continue;
+
+        matched = 1;
+        ctr_add(&t->deliveries, 1);
+        if (audyn_aes_input_feed(se->in, pkt, len, arrival_ns) != 0) {
+            char err[256];
+            audyn_aes_input_get_last_error(se->in, err, sizeof(err));
+            LOG_ERROR("aes_mux: session %d disabled after fatal error: %s", s, err);
+            se->failed = 1;
+        }
+    }
+
+    if (!matched) {
+        ctr_add(&t->packets_unrouted, 1);
+    }
+}
+
+static void drain_socket(mux_thread_t *t, mux_socket_t *sk) {
+    const unsigned batch = t->mux->rx_batch;
+
+    for (unsigned i = 0; i < batch; i++) {
+        t->msgs[i].msg_hdr.msg_controllen = MUX_RX_CTRL_BYTES;
+        t->msgs[i].msg_hdr.msg_flags = 0;
+        t->msgs[i].msg_len = 0;
+    }
+
+    int n = recvmmsg(sk->fd, t->msgs, batch, MSG_DONTWAIT, NULL);
+    if (n < 0) {
+        if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+            LOG_ERROR("aes_mux: recvmmsg() port %u error: %s",
+                      (unsigned)sk->port, strerror(errno));
+        }
+        return;
+    }
+    if (n == 0) return;
+
+    ctr_add(&t->rx_syscalls, 1);
+
+    for (int i = 0; i < n; i++) {
+        struct mmsghdr *m = &t->msgs[i];
+        if (m->msg_len == 0) continue;
+
+        in_addr_t dst;
+        uint64_t arrival_ns;
+        parse_cmsgs(t->mux, &m->msg_hdr, &dst, &arrival_ns);
+
+        ctr_add(&t->packets_rx, 1);
+        route_packet(t, sk, t->bufs + (size_t)i * MUX_RX_BUF_BYTES,
+                     (size_t)m->msg_len, dst, arrival_ns);
+    }
+}
+
+static void *mux_thread_main(void *arg) {
+    mux_thread_t *t = (mux_thread_t *)arg;
+    audyn_aes_mux_t *mux = t->mux;
+
+#ifdef __linux__
+    char name[16];
+    snprintf(name, sizeof(name), "audyn-mux-rx%u", t->index);
+    (void)pthread_setname_np(pthread_self(), name);
+#endif
+
+    struct pollfd pfds[AUDYN_AES_MUX_MAX_SOCKETS];
+    mux_socket_t *owned[AUDYN_AES_MUX_MAX_SOCKETS];
+    nfds_t nfds = 0;
+    int jitter = 0;
+
+    for (unsigned i = 0; i < mux->n_sockets; i++) {
+        if (mux->sockets[i].thread != t->index) continue;
+        for (int s = mux->sockets[i].first_session; s >= 0; s = mux->sessions[s].next) {
+            jitter |= mux->sessions[s].jitter;
+        }
+        pfds[nfds].fd = mux->sockets[i].fd;
+        pfds[nfds].events = POLLIN;
+        pfds[nfds].revents = 0;
+        owned[nfds] = &mux->sockets[i];
+        nfds++;
+    }
+
+    /* Sessions on a busy socket are played out by their packets, but a
+     * stalled one next to it is not: tick every session on a timer */
+    const int timeout_ms = jitter ? MUX_JB_TICK_MS : MUX_POLL_TIMEOUT_MS;
+    uint64_t next_tick_ns = mono_ns() + MUX_JB_TICK_MS * 1000000ULL;
+
+    while (!stop_is_requested(mux)) {
+        int r = poll(pfds, nfds, timeout_ms);
+        if (r < 0) {
+            if (errno == EINTR) continue;
+            LOG_ERROR("aes_mux: poll() error: %s", strerror(errno));
+            usleep(10 * 1000);
+            continue;
+        }
+
+        for (nfds_t i = 0; r > 0 && i < nfds; i++) {
+            if (pfds[i].revents & POLLIN) {
+                drain_socket(t, owned[i]);
+            }
+        }
+
+        if (jitter) {
+            const uint64_t now = mono_ns();
+            if (now >= next_tick_ns) {
+                next_tick_ns = now + MUX_JB_TICK_MS * 1000000ULL;
+                tick_sessions(t);
+            }
+        }
+    }
+
+    return NULL;
+}
+
+/* -------- Public API -------- */
+
+audyn_aes_mux_t *audyn_aes_mux_create(const audyn_aes_mux_cfg_t *cfg) {
+    if (!cfg) {
+        LOG_ERROR("aes_mux: NULL config");
+        return NULL;
+    }
+    if (cfg->rx_threads > AUDYN_AES_MUX_MAX_THREADS) {
+        LOG_ERROR("aes_mux: invalid rx_threads %u (must be 0-%u)",
+                  cfg->rx_threads, AUDYN_AES_MUX_MAX_THREADS);
+        return NULL;
+    }
+    if (cfg->rx_batch > MUX_MAX_RX_BATCH) {
+        LOG_ERROR("aes_mux: invalid rx_batch %u (must be 0-%u)",
+                  cfg->rx_batch, MUX_MAX_RX_BATCH);
+        return NULL;
+    }
+
+    audyn_aes_mux_t *mux = (audyn_aes_mux_t *)calloc(1, sizeof(*mux));
+    if (!mux) {
+        LOG_ERROR("aes_mux: failed to allocate structure");
+        return NULL;
+    }
+
+    mux->cfg = *cfg;
+    mux->rx_batch = cfg->rx_batch ? cfg->rx_batch : MUX_DEFAULT_RX_BATCH;
+
+    if (cfg->bind_interface && cfg->bind_interface[0] != '\0') {
+        mux->bind_interface = strdup(cfg->bind_interface);
+        if (!mux->bind_interface) {
+            LOG_ERROR("aes_mux: failed to allocate bind_interface");
+            free(mux);
+            return NULL;
+        }
+    }
+    mux->cfg.bind_interface = mux->bind_interface;
+
+    if (pthread_mutex_init(&mux->state_mu, NULL) != 0) {
+        LOG_ERROR("aes_mux: failed to initialize state mutex");
+        free(mux->bind_interface);
+        free(mux);
+        return NULL;
+    }
+
+    for (unsigned i = 0; i < AUDYN_AES_MUX_MAX_SOCKETS; i++) {
+        mux->sockets[i].fd = -1;
+        mux->sockets[i].first_session = -1;
+    }
+
+    return mux;
+}
+
+int audyn_aes_mux_add(audyn_aes_mux_t *mux, audyn_aes_input_t *in) {
+    if (!mux || !in) return -1;
+    if (mux->running) {
+        LOG_ERROR("aes_mux: cannot add sessions while running");
+        return -1;
+    }
+    if (audyn_aes_input_is_running(in)) {
+        LOG_ERROR("aes_mux: input already has its own receive thread");
+        return -1;
+    }
+    if (mux->n_sessions >= AUDYN_AES_MUX_MAX_SESSIONS) {
+        LOG_ERROR("aes_mux: too many sessions (max %u)", AUDYN_AES_MUX_MAX_SESSIONS);
+        return -1;
+    }
+    for (unsigned i = 0; i < mux->n_sessions; i++) {
+        if (mux->sessions[i].in == in) {
+            LOG_ERROR("aes_mux: input added twice");
+            return -1;
+        }
+    }
+
+    audyn_aes_input_cfg_t icfg;
+    audyn_aes_input_get_cfg(in, &icfg);
+
+    struct in_addr a;
+    if (!icfg.source_ip || inet_pton(AF_INET, icfg.source_ip, &a) != 1) {
+        LOG_ERROR("aes_mux: invalid source address '%s'",
+                  icfg.source_ip ? icfg.source_ip : "(null)");
+        return -1;
+    }
+    if (icfg.source_ip_b) {
+        LOG_ERROR("aes_mux: second legs (ST 2022-7) need the input's own receive path");
+        return -1;
+    }
+
+    /* Find or create the socket for this port */
+    unsigned sk_idx = 0;
+    for (; sk_idx < mux->n_sockets; sk_idx++) {
+        if (mux->sockets[sk_idx].port == icfg.port) break;
+    }
+    if (sk_idx == mux->n_sockets) {
+        if (mux->n_sockets >= AUDYN_AES_MUX_MAX_SOCKETS) {
+            LOG_ERROR("aes_mux: too many distinct ports (max %u)", AUDYN_AES_MUX_MAX_SOCKETS);
+            return -1;
+        }
+        mux->sockets[sk_idx].port = icfg.port;
+        mux->sockets[sk_idx].first_session = -1;
+        mux->n_sockets++;
+    }
+
+    int idx = (int)mux->n_sessions++;
+    mux_session_t *se = &mux->sessions[idx];
+    memset(se, 0, sizeof(*se));
+    se->in = in;
+    se->group = is_ipv4_multicast(a.s_addr) ? a.s_addr : 0;
+    se->port = icfg.port;
+    se->ssrc = icfg.ssrc;
+    se->jitter = icfg.jitter_ms > 0;
+
+    /* Append to socket chain (keeps config order for logs) */
+    se->next = -1;
+    int *link = &mux->sockets[sk_idx].first_session;
+    while (*link >= 0) link = &mux->sessions[*link].next;
+    *link = idx;
+
+    return 0;
+}
+
+void audyn_aes_mux_set_ptp_clock(audyn_aes_mux_t *mux, audyn_ptp_clock_t *clk) {
+    if (!mux) return;
+    if (mux->running) {
+        LOG_ERROR("aes_mux: Cannot set PTP clock after start");
+        return;
+    }
+    mux->ptp_clk = clk;
+    mux->hw_timestamps_enabled = clk && audyn_ptp_clock_mode(clk) == AUDYN_PTP_MODE_HARDWARE;
+}
+
+int audyn_aes_mux_start(audyn_aes_mux_t *mux) {
+    if (!mux) return -1;
+    if (mux->running) return 0;
+    if (mux->n_sessions == 0) {
+        LOG_ERROR("aes_mux: no sessions configured");
+        return -1;
+    }
+
+    struct in_addr ifaddr;
+    if (resolve_interface(mux, &ifaddr) != 0) return -1;
+
+    unsigned want = mux->cfg.rx_threads ? mux->cfg.rx_threads : 1;
+    mux->n_threads = (want < mux->n_sockets) ? want : mux->n_sockets;
+
+    for (unsigned i = 0; i < mux->n_sockets; i++) {
+        mux->sockets[i].thread = i % mux->n_threads;
+        if (open_mux_socket(mux, &mux->sockets[i], ifaddr) != 0) {
+            goto fail;
+        }
+    }
+
+    set_stop(mux, 0);
+
+    for (unsigned i = 0; i < mux->n_threads; i++) {
+        mux_thread_t *t = &mux->threads[i];
+        memset(t, 0, sizeof(*t));
+        t->mux = mux;
+        t->index = i;
+
+        if (alloc_thread_slots(t, mux->rx_batch) != 0) {
+            LOG_ERROR("aes_mux: failed to allocate rx batch buffers");
+            goto fail;
+        }
+        int rc = pthread_create(&t->thread, NULL, mux_thread_main, t);
+        if (rc != 0) {
+            LOG_ERROR("aes_mux: pthread_create() failed: %s", strerror(rc));
+            goto fail;
+        }
+        t->started = 1;
+        (void)audyn_rt_thread(t->thread, AUDYN_RT_ROLE_RX);
+    }
+
+    mux->running = 1;
+    LOG_INFO("aes_mux: started (%u sessions, %u sockets, %u threads, batch=%u)",
+             mux->n_sessions, mux->n_sockets, mux->n_threads, (unsigned)mux->rx_batch);
+    return 0;
+
+fail:
+    mux->running = 1;   /* Let stop() unwind partially started state */
+    audyn_aes_mux_stop(mux);
+    return -1;
+}
+
+void audyn_aes_mux_stop(audyn_aes_mux_t *mux) {
+    if (!mux || !mux->running) return;
+
+    set_stop(mux, 1);
+
+    uint64_t rx = 0, unrouted = 0, calls = 0;
+    for (unsigned i = 0; i < mux->n_threads; i++) {
+        mux_thread_t *t = &mux->threads[i];
+        if (t->started) {
+            (void)pthread_join(t->thread, NULL);
+            t->started = 0;
+        }
+        rx += ctr_get(&t->packets_rx);
+        unrouted += ctr_get(&t->packets_unrouted);
+        calls += ctr_get(&t->rx_syscalls);
+        free_thread_slots(t);
+    }
+
+    for (unsigned i = 0; i < mux->n_sockets; i++) {
+        if (mux->sockets[i].fd >= 0) {
+            close(mux->sockets[i].fd);
+            mux->sockets[i].fd = -1;
+        }
+    }
+
+    mux->running = 0;
+
+    LOG_INFO("aes_mux: stopped (rx=%llu unrouted=%llu calls=%llu)",
+             (unsigned long long)rx, (unsigned long long)unrouted,
+             (unsigned long long)calls);
+}
+
+void audyn_aes_mux_destroy(audyn_aes_mux_t *mux) {
+    if (!mux) return;
+    audyn_aes_mux_stop(mux);
+    pthread_mutex_destroy(&mux->state_mu);
+    free(mux->bind_interface);
+    free(mux);
+}
+
+void audyn_aes_mux_get_stats(const audyn_aes_mux_t *mux, audyn_aes_mux_stats_t *stats) {
+    if (!stats) return;
+    memset(stats, 0, sizeof(*stats));
+    if (!mux) return;
+
+    for (unsigned i = 0; i < mux->n_threads; i++) {
+        const mux_thread_t *t = &mux->threads[i];
+        stats->packets_rx += ctr_get(&t->packets_rx);
+        stats->packets_unrouted += ctr_get(&t->packets_unrouted);
+        stats->deliveries += ctr_get(&t->deliveries);
+        stats->rx_syscalls += ctr_get(&t->rx_syscalls);
+    }
+    stats->sockets = mux->n_sockets;
+    stats->sessions = mux->n_sessions;
+    stats->threads = mux->n_threads;
+}
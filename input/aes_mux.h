@@ -0,0 +1,109 @@
+/*
+ *  Audyn — Professional Audio Capture & Archival Engine
+ *
+ *  File:
+ *      aes_mux.h
+ *
+ *  Purpose:
+ *      Shared AES67 / RTP receiver for multi-stream capture.
+ *
+ *      Instead of one socket and one receive thread per audyn_aes_input,
+ *      the mux opens one socket per UDP port, joins every multicast group
+ *      used on that port, and runs a small fixed set of receive threads.
+ *      Each datagram is demultiplexed by (destination group, port, SSRC)
+ *      and fed to the matching input(s) with audyn_aes_input_feed(), which
+ *      performs the usual RTP parsing and PCM conversion into the input's
+ *      own frame pool and audio queue.
+ *
+ *  Design:
+ *      - One socket per distinct port, IP_MULTICAST_ALL disabled
+ *      - Sockets are assigned to receive threads round-robin; every input
+ *        is therefore fed by exactly one thread (SPSC queue contract holds)
+ *      - poll() + recvmmsg() per thread, per-packet IP_PKTINFO and
+ *        SO_TIMESTAMPING control data
+ *      - Several inputs may match one flow (e.g. different channel_offset
+ *        pairs of a wide MADI-over-AES67 stream)
+ *
+ *  Dependencies:
+ *      - POSIX sockets + pthread
+ *      - Audyn: aes_input, ptp_clock, log
+ *
+ *  Copyright:
+ *      (c) 2026 B. Wynne
+ *
+ *  Author:
+ *      B. Wynne
+ *
+ *  License:
+ *      GPLv2 or later
+ */
+
+#ifndef AUDYN_AES_MUX_H
+#define AUDYN_AES_MUX_H
+
+#include <stdint.h>
+
+#include "aes_input.h"
+#include "ptp_clock.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Limits */
+#define AUDYN_AES_MUX_MAX_THREADS   16
+#define AUDYN_AES_MUX_MAX_SESSIONS  256
+#define AUDYN_AES_MUX_MAX_SOCKETS   64
+
+typedef struct audyn_aes_mux_cfg {
+    uint16_t    rx_threads;         /* Receive threads (0 = 1) */
+    uint32_t    socket_rcvbuf;      /* Per-socket SO_RCVBUF (0 = system default) */
+    const char *bind_interface;     /* Interface for multicast joins (NULL = any) */
+    uint16_t    rx_batch;           /* Datagrams per recvmmsg() (0 = 32, max 64) */
+} audyn_aes_mux_cfg_t;
+
+typedef struct audyn_aes_mux_stats {
+    uint64_t packets_rx;            /* Datagrams received on all sockets */
+    uint64_t packets_unrouted;      /* No session matched group/port/SSRC */
+    uint64_t deliveries;            /* Packets fed to sessions (may exceed packets_rx) */
+    uint64_t rx_syscalls;           /* recvmmsg() calls that returned data */
+    uint32_t sockets;
+    uint32_t sessions;
+    uint32_t threads;
+} audyn_aes_mux_stats_t;
+
+typedef struct audyn_aes_mux audyn_aes_mux_t;
+
+audyn_aes_mux_t *audyn_aes_mux_create(const audyn_aes_mux_cfg_t *cfg);
+
+/*
+ * Register an input with the mux.
+ *
+ * Routing uses the input's source_ip (multicast group; unicast addresses
+ * match any destination), port and ssrc (0 = any). The input is NOT owned
+ * and must not be started on its own. Must be called before start.
+ *
+ * Returns 0 on success, -1 on error.
+ */
+int audyn_aes_mux_add(audyn_aes_mux_t *mux, audyn_aes_input_t *in);
+
+/*
+ * Set the PTP clock used for socket timestamping (not owned).
+ * Must be called before audyn_aes_mux_start().
+ */
+void audyn_aes_mux_set_ptp_clock(audyn_aes_mux_t *mux, audyn_ptp_clock_t *clk);
+
+int  audyn_aes_mux_start(audyn_aes_mux_t *mux);
+void audyn_aes_mux_stop(audyn_aes_mux_t *mux);
+void audyn_aes_mux_destroy(audyn_aes_mux_t *mux);
+
+/*
+ * Get mux statistics. Safe to call while running.
+ */
+void audyn_aes_mux_get_stats(const audyn_aes_mux_t *mux, audyn_aes_mux_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* AUDYN_AES_MUX_H */
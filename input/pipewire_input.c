@@ -13,14 +13,19 @@
  *
  *  Behavior:
  *      - Acquires a frame from the frame pool.
- *      - Copies interleaved float32 samples into frame->data.
+ *      - Unpacks the interleaved buffer (F32/S32/S24_32/S24/S16) into
+ *        frame->data with the pcm_convert kernel chosen at create.
  *      - Sets frame->sample_frames to the actual number of samples received.
- *      - If PipeWire delivers more samples than frame capacity, truncates to fit.
+ *      - If PipeWire delivers more samples than frame capacity, the buffer
+ *        is split over as many frames as it needs.
+ *      - S24 buffers are also copied as-is to frame->raw when the pool has
+ *        raw buffers, so a 24-bit WAV is written without a float round trip.
  *      - Downstream consumers (e.g., opus_sink FIFO) handle accumulation.
  *
  *  Dependencies:
  *      - PipeWire: libpipewire-0.3, libspa-0.2
  *      - POSIX: pthread
+ *      - Audyn: pcm_convert
  *
  *  Copyright:
  *      (c) 2026 B. Wynne
@@ -34,9 +39,13 @@
 
 #include "pipewire_input.h"
 #include "log.h"
+#include "rt.h"
+#include "metrics.h"
+#include "pcm_convert.h"
 
 #include <pipewire/pipewire.h>
 #include <spa/param/audio/format-utils.h>
+#include <spa/param/format-utils.h>
 
 #include <pthread.h>
 #include <stdatomic.h>
@@ -74,6 +83,15 @@ struct audyn_pw_input {
 
     uint32_t rate;
     uint32_t channels;
+    audyn_pw_format_t format;
+    uint32_t quantum;
+    uint32_t frame_cap;         /* Pool frame size (sample frames) */
+    uint32_t stride;            /* Bytes per sample frame in the PipeWire buffer */
+    int copy_raw;               /* S24: also fill frame->raw */
+    audyn_pcm_unpacker_t up;    /* Fixed at create: only one format is offered */
+
+    /* Negotiated format matches the request (set from param_changed) */
+    _Atomic int format_ok;
 
     struct pw_main_loop *loop;
     struct pw_context   *ctx;
@@ -89,9 +107,65 @@ struct audyn_pw_input {
     _Atomic uint64_t drops_pool;        /* Drops due to pool exhaustion */
     _Atomic uint64_t drops_queue;       /* Drops due to queue full */
     _Atomic uint64_t drops_empty;       /* Drops due to empty/invalid buffer */
-    _Atomic uint64_t truncations;       /* Times we truncated oversized buffer */
+    _Atomic uint64_t splits;            /* Buffers split over several frames */
+};
+
+/* -------- Formats -------- */
+
+static const struct {
+    const char *name;
+    enum spa_audio_format spa;
+    audyn_pcm_in_format_t pcm;
+} pw_formats[] = {
+    [AUDYN_PW_FORMAT_F32]    = { "F32",    SPA_AUDIO_FORMAT_F32,    AUDYN_PCM_IN_F32LE },
+    [AUDYN_PW_FORMAT_S32]    = { "S32",    SPA_AUDIO_FORMAT_S32,    AUDYN_PCM_IN_S32LE },
+    [AUDYN_PW_FORMAT_S24_32] = { "S24_32", SPA_AUDIO_FORMAT_S24_32, AUDYN_PCM_IN_S24_32LE },
+    [AUDYN_PW_FORMAT_S24]    = { "S24",    SPA_AUDIO_FORMAT_S24,    AUDYN_PCM_IN_S24LE },
+    [AUDYN_PW_FORMAT_S16]    = { "S16",    SPA_AUDIO_FORMAT_S16,    AUDYN_PCM_IN_S16LE },
 };
 
+#define PW_NUM_FORMATS (sizeof(pw_formats) / sizeof(pw_formats[0]))
+
+/* Main loop thread: check what PipeWire settled on before any buffer flows */
+static void on_param_changed(void *userdata, uint32_t id, const struct spa_pod *param)
+{
+    audyn_pw_input_t *in = (audyn_pw_input_t*)userdata;
+    if (!in || id != SPA_PARAM_Format) return;
+
+    if (!param) {
+        atomic_store_explicit(&in->format_ok, 0, memory_order_release);
+        return;
+    }
+
+    uint32_t media_type = 0, media_subtype = 0;
+    if (spa_format_parse(param, &media_type, &media_subtype) < 0 ||
+        media_type != SPA_MEDIA_TYPE_audio ||
+        media_subtype != SPA_MEDIA_SUBTYPE_raw) {
+        return;
+    }
+
+    struct spa_audio_info_raw info;
+    memset(&info, 0, sizeof(info));
+    if (spa_format_audio_raw_parse(param, &info) < 0) {
+        LOG_ERROR("PW: Unparseable stream format");
+        atomic_store_explicit(&in->format_ok, 0, memory_order_release);
+        return;
+    }
+
+    if (info.format != pw_formats[in->format].spa ||
+        info.rate != in->rate || info.channels != in->channels) {
+        LOG_ERROR("PW: Negotiated %uHz %uch (format %u), wanted %uHz %uch %s - dropping buffers",
+                  info.rate, info.channels, (unsigned)info.format,
+                  in->rate, in->channels, pw_formats[in->format].name);
+        atomic_store_explicit(&in->format_ok, 0, memory_order_release);
+        return;
+    }
+
+    LOG_INFO("PW: Format %uHz %uch %s (%s)", info.rate, info.channels,
+             pw_formats[in->format].name, in->up.name);
+    atomic_store_explicit(&in->format_ok, 1, memory_order_release);
+}
+
 static void on_process(void *userdata)
 {
     audyn_pw_input_t *in = (audyn_pw_input_t*)userdata;
@@ -102,6 +176,7 @@ static void on_process(void *userdata)
 
     struct pw_buffer *pw_buf = pw_stream_dequeue_buffer(in->stream);
     if (!pw_buf) return;
+    const uint64_t rx_ns = audyn_metrics_start();
 
     struct spa_buffer *buf = pw_buf->buffer;
     if (!buf || buf->n_datas < 1 || !buf->datas[0].data || !buf->datas[0].chunk) {
@@ -110,62 +185,84 @@ static void on_process(void *userdata)
         return;
     }
 
-    const uint32_t bytes = buf->datas[0].chunk->size;
-    const uint32_t frame_bytes = (uint32_t)(sizeof(float) * in->channels);
-    const uint32_t nframes_in = frame_bytes ? (bytes / frame_bytes) : 0;
-
-    if (nframes_in == 0) {
+    if (!atomic_load_explicit(&in->format_ok, memory_order_acquire)) {
         atomic_fetch_add_explicit(&in->drops_empty, 1, memory_order_relaxed);
         pw_stream_queue_buffer(in->stream, pw_buf);
         return;
     }
 
-    audyn_audio_frame_t *f = audyn_frame_acquire(in->pool);
-    if (!f) {
-        /* Pool exhausted: drop this buffer. */
-        atomic_fetch_add_explicit(&in->drops_pool, 1, memory_order_relaxed);
-        pw_stream_queue_buffer(in->stream, pw_buf);
-        return;
-    }
+    /* Valid region of the buffer: [offset, offset + size) within maxsize */
+    const struct spa_data *d = &buf->datas[0];
+    const uint32_t offset = SPA_MIN(d->chunk->offset, d->maxsize);
+    const uint32_t bytes = SPA_MIN(d->chunk->size, d->maxsize - offset);
+    const uint32_t nframes_in = bytes / in->stride;
 
-    /* Validate channel agreement. */
-    if ((uint32_t)f->channels != in->channels) {
-        audyn_frame_release(f);
+    if (nframes_in == 0) {
         atomic_fetch_add_explicit(&in->drops_empty, 1, memory_order_relaxed);
         pw_stream_queue_buffer(in->stream, pw_buf);
         return;
     }
 
-    const uint32_t nframes_cap = f->sample_frames;
-
     /*
-     * Copy exactly the samples we received from PipeWire.
-     * If PipeWire delivers more than our frame capacity, truncate.
-     * The downstream FIFO (e.g., in opus_sink) will accumulate frames properly.
-     *
-     * This approach follows PipeWire's recommendation: process whatever
-     * buffer size PipeWire delivers, don't enforce fixed sizes here.
+     * Hand on whatever size PipeWire delivers (its recommendation) and let
+     * the downstream FIFO (e.g., in opus_sink) accumulate. With the quantum
+     * matched to the pool (--pw-quantum) this is one full frame per cycle;
+     * a larger buffer is split rather than truncated.
      */
-    const uint32_t nframes_to_copy = (nframes_in > nframes_cap) ? nframes_cap : nframes_in;
-
-    /* Track truncations */
-    if (nframes_in > nframes_cap) {
-        atomic_fetch_add_explicit(&in->truncations, 1, memory_order_relaxed);
+    if (nframes_in > in->frame_cap) {
+        atomic_fetch_add_explicit(&in->splits, 1, memory_order_relaxed);
     }
 
-    const size_t copy_bytes = (size_t)nframes_to_copy * (size_t)frame_bytes;
-    memcpy(f->data, buf->datas[0].data, copy_bytes);
-
-    /* Set actual sample count - downstream consumers use this value */
-    f->sample_frames = nframes_to_copy;
-
-    if (!audyn_audio_queue_push(in->q, f)) {
-        /* Queue full: release frame. */
-        atomic_fetch_add_explicit(&in->drops_queue, 1, memory_order_relaxed);
-        audyn_frame_release(f);
-    } else {
-        /* Successfully captured */
-        atomic_fetch_add_explicit(&in->frames_captured, nframes_to_copy, memory_order_relaxed);
+    const uint8_t *src = (const uint8_t *)d->data + offset;
+    uint32_t left = nframes_in;
+
+    while (left > 0) {
+        audyn_audio_frame_t *f = audyn_frame_acquire(in->pool);
+        if (!f) {
+            /* Pool exhausted: drop the rest of this buffer. */
+            atomic_fetch_add_explicit(&in->drops_pool, 1, memory_order_relaxed);
+            audyn_metrics_count(AUDYN_CTR_DROPS_POOL, 1);
+            break;
+        }
+
+        /* Validate channel agreement. */
+        if ((uint32_t)f->channels != in->channels) {
+            audyn_frame_return(f);
+            atomic_fetch_add_explicit(&in->drops_empty, 1, memory_order_relaxed);
+            break;
+        }
+
+        const uint32_t n = (left > in->frame_cap) ? in->frame_cap : left;
+        const size_t samples = (size_t)n * in->channels;
+
+        audyn_pcm_unpack(&in->up, src, f->data, samples);
+        if (in->copy_raw && f->raw) {
+            memcpy(f->raw, src, samples * 3u);
+            f->raw_frames = n;
+        } else {
+            f->raw_frames = 0;
+        }
+
+        /* Set actual sample count - downstream consumers use this value */
+        f->sample_frames = n;
+        f->media_ns = 0;            /* Worker counts samples from the archive clock */
+
+        f->queued_ns = audyn_metrics_start();
+
+        if (!audyn_audio_queue_push(in->q, f)) {
+            /* Queue full: release frame. */
+            atomic_fetch_add_explicit(&in->drops_queue, 1, memory_order_relaxed);
+            audyn_metrics_count(AUDYN_CTR_DROPS_QUEUE, 1);
+            audyn_frame_return(f);
+        } else {
+            /* Successfully captured */
+            atomic_fetch_add_explicit(&in->frames_captured, n, memory_order_relaxed);
+            audyn_metrics_count(AUDYN_CTR_FRAMES_PUSHED, 1);
+            audyn_metrics_stage_end(AUDYN_STAGE_RX_PUSH, rx_ns);
+        }
+
+        src += (size_t)n * in->stride;
+        left -= n;
     }
 
     pw_stream_queue_buffer(in->stream, pw_buf);
@@ -173,6 +270,7 @@ static void on_process(void *userdata)
 
 static const struct pw_stream_events stream_events = {
     PW_VERSION_STREAM_EVENTS,
+    .param_changed = on_param_changed,
     .process = on_process,
 };
 
@@ -186,13 +284,15 @@ static void *pw_thread_main(void *arg)
 
 audyn_pw_input_t *audyn_pw_input_create(audyn_frame_pool_t *pool,
                                         audyn_audio_queue_t *queue,
-                                        uint32_t sample_rate,
-                                        uint32_t channels)
+                                        const audyn_pw_input_cfg_t *cfg)
 {
-    if (!pool || !queue) {
-        LOG_ERROR("PW: NULL pool or queue");
+    if (!pool || !queue || !cfg) {
+        LOG_ERROR("PW: NULL pool, queue or config");
         return NULL;
     }
+
+    const uint32_t sample_rate = cfg->sample_rate;
+    const uint32_t channels = cfg->channels;
     if (sample_rate == 0 || sample_rate > PW_MAX_SAMPLE_RATE) {
         LOG_ERROR("PW: Invalid sample rate %u (must be 1-%d)", sample_rate, PW_MAX_SAMPLE_RATE);
         return NULL;
@@ -201,6 +301,26 @@ audyn_pw_input_t *audyn_pw_input_create(audyn_frame_pool_t *pool,
         LOG_ERROR("PW: Invalid channel count %u (must be 1-%d)", channels, PW_MAX_CHANNELS);
         return NULL;
     }
+    if ((unsigned)cfg->format >= PW_NUM_FORMATS) {
+        LOG_ERROR("PW: Invalid sample format %d", (int)cfg->format);
+        return NULL;
+    }
+    if (cfg->quantum != 0 &&
+        (cfg->quantum < AUDYN_PW_QUANTUM_MIN || cfg->quantum > AUDYN_PW_QUANTUM_MAX)) {
+        LOG_ERROR("PW: Invalid quantum %u (must be %u-%u)",
+                  cfg->quantum, AUDYN_PW_QUANTUM_MIN, AUDYN_PW_QUANTUM_MAX);
+        return NULL;
+    }
+
+    const uint32_t frame_cap = audyn_frame_pool_frame_capacity(pool);
+    if (frame_cap == 0) {
+        LOG_ERROR("PW: Frame pool has zero-sized frames");
+        return NULL;
+    }
+    if (cfg->quantum > frame_cap) {
+        LOG_WARN("PW: Quantum %u exceeds pool frames (%u); buffers will be split",
+                 cfg->quantum, frame_cap);
+    }
 
     pw_ref_init();
 
@@ -215,6 +335,18 @@ audyn_pw_input_t *audyn_pw_input_create(audyn_frame_pool_t *pool,
     in->q = queue;
     in->rate = sample_rate;
     in->channels = channels;
+    in->format = cfg->format;
+    in->quantum = cfg->quantum;
+    in->frame_cap = frame_cap;
+    in->copy_raw = (cfg->format == AUDYN_PW_FORMAT_S24);
+
+    if (audyn_pcm_unpacker_init(&in->up, pw_formats[cfg->format].pcm, AUDYN_PCM_ISA_AUTO) != 0) {
+        LOG_ERROR("PW: No unpacker for %s", pw_formats[cfg->format].name);
+        free(in);
+        pw_ref_deinit();
+        return NULL;
+    }
+    in->stride = in->up.bytes_per_sample * channels;
 
     /* Initialize atomic counters */
     atomic_init(&in->frames_captured, 0);
@@ -222,7 +354,8 @@ audyn_pw_input_t *audyn_pw_input_create(audyn_frame_pool_t *pool,
     atomic_init(&in->drops_pool, 0);
     atomic_init(&in->drops_queue, 0);
     atomic_init(&in->drops_empty, 0);
-    atomic_init(&in->truncations, 0);
+    atomic_init(&in->splits, 0);
+    atomic_init(&in->format_ok, 0);
 
     in->loop = pw_main_loop_new(NULL);
     if (!in->loop) {
@@ -236,15 +369,31 @@ audyn_pw_input_t *audyn_pw_input_create(audyn_frame_pool_t *pool,
         goto fail;
     }
 
+    struct pw_properties *props = pw_properties_new(
+        PW_KEY_MEDIA_TYPE, "Audio",
+        PW_KEY_MEDIA_CATEGORY, "Capture",
+        PW_KEY_MEDIA_ROLE, "Production",
+        NULL
+    );
+    if (!props) {
+        LOG_ERROR("PW: Failed to create stream properties");
+        goto fail;
+    }
+    if (cfg->quantum) {
+        /* Ask the graph for one pool frame per cycle, at our rate */
+        pw_properties_setf(props, PW_KEY_NODE_LATENCY, "%u/%u", cfg->quantum, sample_rate);
+        pw_properties_setf(props, PW_KEY_NODE_RATE, "1/%u", sample_rate);
+    }
+    if (channels > 2) {
+        /* Multichannel archives keep device channel order, unmixed */
+        pw_properties_set(props, PW_KEY_STREAM_DONT_REMIX, "true");
+    }
+
+    /* Takes ownership of props, also on failure */
     in->stream = pw_stream_new_simple(
         pw_main_loop_get_loop(in->loop),
         "audyn-input",
-        pw_properties_new(
-            PW_KEY_MEDIA_TYPE, "Audio",
-            PW_KEY_MEDIA_CATEGORY, "Capture",
-            PW_KEY_MEDIA_ROLE, "Production",
-            NULL
-        ),
+        props,
         &stream_events,
         in
     );
@@ -255,9 +404,18 @@ audyn_pw_input_t *audyn_pw_input_create(audyn_frame_pool_t *pool,
 
     struct spa_audio_info_raw info;
     memset(&info, 0, sizeof(info));
-    info.format = SPA_AUDIO_FORMAT_F32;
+    info.format = pw_formats[cfg->format].spa;
     info.rate = (uint32_t)sample_rate;
     info.channels = (uint32_t)channels;
+    if (channels == 1) {
+        info.position[0] = SPA_AUDIO_CHANNEL_MONO;
+    } else if (channels == 2) {
+        info.position[0] = SPA_AUDIO_CHANNEL_FL;
+        info.position[1] = SPA_AUDIO_CHANNEL_FR;
+    } else {
+        for (uint32_t c = 0; c < channels; c++)
+            info.position[c] = SPA_AUDIO_CHANNEL_AUX0 + c;
+    }
 
     uint8_t b[1024];
     struct spa_pod_builder pb = SPA_POD_BUILDER_INIT(b, sizeof(b));
@@ -278,7 +436,13 @@ audyn_pw_input_t *audyn_pw_input_create(audyn_frame_pool_t *pool,
         goto fail;
     }
 
-    LOG_INFO("PW: Created input - %uHz %uch F32", sample_rate, channels);
+    if (cfg->quantum) {
+        LOG_INFO("PW: Created input - %uHz %uch %s, quantum %u, frames %u",
+                 sample_rate, channels, pw_formats[cfg->format].name, cfg->quantum, frame_cap);
+    } else {
+        LOG_INFO("PW: Created input - %uHz %uch %s, frames %u",
+                 sample_rate, channels, pw_formats[cfg->format].name, frame_cap);
+    }
     return in;
 
 fail:
@@ -303,6 +467,7 @@ int audyn_pw_input_start(audyn_pw_input_t *in)
     }
 
     in->thread_started = 1;
+    (void)audyn_rt_thread(in->thread, AUDYN_RT_ROLE_RX);
     in->running = 1;
     LOG_INFO("PW: Started capture");
     return 0;
@@ -321,13 +486,13 @@ void audyn_pw_input_stop(audyn_pw_input_t *in)
         in->running = 0;
 
         /* Log final statistics */
-        LOG_DEBUG("PW: Stopped - captured=%lu callbacks=%lu drops_pool=%lu drops_queue=%lu drops_empty=%lu truncations=%lu",
+        LOG_DEBUG("PW: Stopped - captured=%lu callbacks=%lu drops_pool=%lu drops_queue=%lu drops_empty=%lu splits=%lu",
                   (unsigned long)atomic_load(&in->frames_captured),
                   (unsigned long)atomic_load(&in->callbacks),
                   (unsigned long)atomic_load(&in->drops_pool),
                   (unsigned long)atomic_load(&in->drops_queue),
                   (unsigned long)atomic_load(&in->drops_empty),
-                  (unsigned long)atomic_load(&in->truncations));
+                  (unsigned long)atomic_load(&in->splits));
     }
 }
 
@@ -360,5 +525,5 @@ void audyn_pw_input_get_stats(const audyn_pw_input_t *in, audyn_pw_stats_t *stat
     stats->drops_pool = atomic_load_explicit(&in->drops_pool, memory_order_relaxed);
     stats->drops_queue = atomic_load_explicit(&in->drops_queue, memory_order_relaxed);
     stats->drops_empty = atomic_load_explicit(&in->drops_empty, memory_order_relaxed);
-    stats->truncations = atomic_load_explicit(&in->truncations, memory_order_relaxed);
+    stats->splits = atomic_load_explicit(&in->splits, memory_order_relaxed);
 }
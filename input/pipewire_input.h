@@ -6,8 +6,20 @@
  *
  *  Purpose:
  *      PipeWire capture input for Ubuntu 24.04+.
- *      Captures float32 interleaved buffers from PipeWire and enqueues
- *      audyn_audio_frame_t* objects into an SPSC audyn_audio_queue_t.
+ *      Captures interleaved buffers from PipeWire (F32, S32, S24_32, S24 or
+ *      S16) and enqueues audyn_audio_frame_t* objects into an SPSC
+ *      audyn_audio_queue_t.
+ *
+ *  Quantum:
+ *      With cfg.quantum set, the stream asks PipeWire for that many
+ *      frames per cycle (node.latency) at the stream rate (node.rate), so
+ *      with pool frames of the same size each cycle fills exactly one
+ *      frame. Buffers larger than a pool frame are split across frames,
+ *      never truncated.
+ *
+ *  Channels:
+ *      1 = MONO, 2 = FL/FR, more = AUX0..AUXn in device order, with
+ *      remixing off so channel n of the source is channel n of the file.
  *
  *  Real-time Constraints:
  *      - The PipeWire process callback MUST NOT allocate memory or block.
@@ -17,7 +29,7 @@
  *  Dependencies:
  *      - PipeWire: libpipewire-0.3, libspa-0.2
  *      - POSIX: pthread
- *      - Audyn: frame_pool, audio_queue
+ *      - Audyn: frame_pool, audio_queue, pcm_convert
  *
  *  Copyright:
  *      (c) 2026 B. Wynne
@@ -43,6 +55,26 @@ extern "C" {
 
 typedef struct audyn_pw_input audyn_pw_input_t;
 
+/* Sample format requested from PipeWire */
+typedef enum audyn_pw_format {
+    AUDYN_PW_FORMAT_F32 = 0,    /* Float (PipeWire's internal format) */
+    AUDYN_PW_FORMAT_S32,
+    AUDYN_PW_FORMAT_S24_32,     /* 24-bit in 32-bit containers */
+    AUDYN_PW_FORMAT_S24,        /* Packed 24-bit; fills frame->raw when enabled */
+    AUDYN_PW_FORMAT_S16
+} audyn_pw_format_t;
+
+/* PipeWire quantum limits (frames per cycle) */
+#define AUDYN_PW_QUANTUM_MIN    16u
+#define AUDYN_PW_QUANTUM_MAX    8192u
+
+typedef struct audyn_pw_input_cfg {
+    uint32_t sample_rate;       /* 1-384000 */
+    uint32_t channels;          /* 1-32 */
+    audyn_pw_format_t format;   /* Default F32 */
+    uint32_t quantum;           /* Frames per cycle to request (0 = graph default) */
+} audyn_pw_input_cfg_t;
+
 /*
  * PipeWire input statistics.
  *
@@ -54,7 +86,7 @@ typedef struct audyn_pw_stats {
     uint64_t drops_pool;        /* Drops due to frame pool exhaustion */
     uint64_t drops_queue;       /* Drops due to audio queue full */
     uint64_t drops_empty;       /* Drops due to empty/invalid PipeWire buffer */
-    uint64_t truncations;       /* Times buffer was truncated to fit frame */
+    uint64_t splits;            /* Buffers larger than a pool frame (split across frames) */
 } audyn_pw_stats_t;
 
 /*
@@ -63,12 +95,11 @@ typedef struct audyn_pw_stats {
  * Parameters:
  *   pool        - Frame pool for acquiring audio frames (lock-free)
  *   queue       - Audio queue for pushing captured frames (lock-free)
- *   sample_rate - Desired sample rate in Hz (1-384000)
- *   channels    - Desired channel count (1-32)
+ *   cfg         - Stream format and quantum
  *
  * Notes:
- *   - The frame pool defines the fixed frame size (audyn_audio_frame_t::sample_frames)
- *     used for capture. If PipeWire delivers more frames than capacity, data is truncated.
+ *   - The frame pool defines the largest frame. A buffer that does not
+ *     fit is split over several frames; a smaller one fills part of one.
  *   - Downstream consumers (e.g., opus_sink FIFO) accumulate frames as needed.
  *   - Errors are logged via the project's logging system.
  *
@@ -77,8 +108,7 @@ typedef struct audyn_pw_stats {
  */
 audyn_pw_input_t *audyn_pw_input_create(audyn_frame_pool_t *pool,
                                         audyn_audio_queue_t *queue,
-                                        uint32_t sample_rate,
-                                        uint32_t channels);
+                                        const audyn_pw_input_cfg_t *cfg);
 
 /* Start/stop capture (NOT real-time safe). */
 int  audyn_pw_input_start(audyn_pw_input_t *in);
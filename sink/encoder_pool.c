@@ -0,0 +1,388 @@
+/*
+ *  Audyn — Professional Audio Capture & Archival Engine
+ *
+ *  File:
+ *      encoder_pool.c
+ *
+ *  Purpose:
+ *      Shared encoder threads and per-stream SPSC sample lanes.
+ *
+ *  Lane ownership:
+ *      'scheduled' is 1 from the moment a lane is put on the run queue
+ *      until the servicing thread has found it empty and released it.
+ *      Only the thread that flips it 0 -> 1 may queue (producer) or keep
+ *      servicing (pool thread) the lane, so no two threads ever run the
+ *      same lane's callback.
+ *
+ *      'active' counts pool threads that still hold a pointer to the lane.
+ *      A thread that has just released 'scheduled' keeps its count until
+ *      it is done with the lane, even if another thread has already picked
+ *      the lane up again, so it is a counter rather than a flag. It only
+ *      changes under pool->mu; drain()/destroy() wait for it to reach 0.
+ *
+ *  Ring:
+ *      head/tail are free-running frame counters (producer / consumer).
+ *      Samples are published by the release store of head and returned
+ *      to the producer by the release store of tail.
+ *
+ *  Dependencies:
+ *      - pthread, C11 atomics
+ *      - Audyn: log, rt
+ *
+ *  Copyright:
+ *      (c) 2026 B. Wynne
+ *
+ *  Author:
+ *      B. Wynne
+ *
+ *  License:
+ *      GPLv2 or later
+ */
+
+#define _GNU_SOURCE
+
+#include "encoder_pool.h"
+#include "log.h"
+#include "rt.h"
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+struct audyn_enc_lane {
+    audyn_encoder_pool_t *pool;
+    audyn_enc_lane_fn fn;
+    void *user;
+
+    float   *ring;
+    uint32_t cap;               /* Frames */
+    uint16_t channels;
+
+    _Atomic uint64_t head;      /* Frames pushed (producer) */
+    _Atomic uint64_t tail;      /* Frames consumed (pool thread) */
+    _Atomic int scheduled;      /* On the run queue or being serviced */
+    _Atomic uint32_t active;    /* Pool threads holding the lane (changed under pool->mu) */
+    _Atomic int failed;
+
+    /* Approximate arrival time of the oldest queued audio */
+    _Atomic uint64_t pending_ns;
+
+    _Atomic uint32_t backlog_max;
+    _Atomic uint32_t delay_us_last;
+    _Atomic uint32_t delay_us_max;
+
+    audyn_enc_lane_t *next;     /* Run queue link (pool->mu) */
+};
+
+struct audyn_encoder_pool {
+    pthread_mutex_t mu;
+    pthread_cond_t  work_cv;    /* Run queue non-empty / stop */
+    pthread_cond_t  idle_cv;    /* A lane was released (drain waiters) */
+    audyn_enc_lane_t *runq_head;
+    audyn_enc_lane_t *runq_tail;
+    int stop;
+
+    pthread_t *threads;
+    uint32_t nthreads;
+};
+
+static uint64_t mono_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static void atomic_max_u32(_Atomic uint32_t *a, uint32_t v)
+{
+    uint32_t cur = atomic_load_explicit(a, memory_order_relaxed);
+    while (v > cur &&
+           !atomic_compare_exchange_weak_explicit(a, &cur, v, memory_order_relaxed,
+                                                  memory_order_relaxed)) {
+    }
+}
+
+static void runq_push(audyn_encoder_pool_t *pool, audyn_enc_lane_t *lane)
+{
+    pthread_mutex_lock(&pool->mu);
+    lane->next = NULL;
+    if (pool->runq_tail) {
+        pool->runq_tail->next = lane;
+    } else {
+        pool->runq_head = lane;
+    }
+    pool->runq_tail = lane;
+    pthread_cond_signal(&pool->work_cv);
+    pthread_mutex_unlock(&pool->mu);
+}
+
+/* Hand everything queued to the callback (lane owned by this thread). */
+static void lane_service(audyn_enc_lane_t *lane)
+{
+    const size_t ch = lane->channels;
+
+    for (;;) {
+        uint64_t t = atomic_load_explicit(&lane->tail, memory_order_relaxed);
+        const uint64_t h = atomic_load_explicit(&lane->head, memory_order_acquire);
+        if (h == t) break;
+
+        const uint64_t now = mono_ns();
+        const uint64_t since = atomic_exchange_explicit(&lane->pending_ns, now,
+                                                        memory_order_relaxed);
+        if (since > 0 && now > since) {
+            uint64_t us = (now - since) / 1000u;
+            if (us > UINT32_MAX) us = UINT32_MAX;
+            atomic_store_explicit(&lane->delay_us_last, (uint32_t)us, memory_order_relaxed);
+            atomic_max_u32(&lane->delay_us_max, (uint32_t)us);
+        }
+
+        while (t < h) {
+            const uint32_t off = (uint32_t)(t % lane->cap);
+            uint64_t n = h - t;
+            if (n > lane->cap - off) n = lane->cap - off;
+
+            if (!atomic_load_explicit(&lane->failed, memory_order_relaxed) &&
+                lane->fn(lane->user, lane->ring + (size_t)off * ch, (uint32_t)n) != 0) {
+                atomic_store_explicit(&lane->failed, 1, memory_order_relaxed);
+            }
+
+            t += n;
+            atomic_store_explicit(&lane->tail, t, memory_order_release);
+        }
+    }
+}
+
+static void *pool_thread(void *arg)
+{
+    audyn_encoder_pool_t *pool = (audyn_encoder_pool_t *)arg;
+
+    (void)pthread_setname_np(pthread_self(), "audyn-enc");
+
+    pthread_mutex_lock(&pool->mu);
+    for (;;) {
+        while (!pool->runq_head && !pool->stop) {
+            pthread_cond_wait(&pool->work_cv, &pool->mu);
+        }
+        audyn_enc_lane_t *lane = pool->runq_head;
+        if (!lane) break;           /* stop with an empty run queue */
+
+        pool->runq_head = lane->next;
+        if (!pool->runq_head) pool->runq_tail = NULL;
+        atomic_fetch_add(&lane->active, 1);
+        pthread_mutex_unlock(&pool->mu);
+
+        for (;;) {
+            lane_service(lane);
+            atomic_store_explicit(&lane->scheduled, 0, memory_order_seq_cst);
+
+            /* A push that raced with the release saw scheduled == 1 and did
+             * not queue the lane: take it back unless someone else has. */
+            if (atomic_load_explicit(&lane->head, memory_order_seq_cst) ==
+                atomic_load_explicit(&lane->tail, memory_order_relaxed)) {
+                break;
+            }
+            if (atomic_exchange_explicit(&lane->scheduled, 1, memory_order_seq_cst)) {
+                break;
+            }
+        }
+
+        /* Last touch of the lane: drain()/destroy() may free it once the
+         * count reaches 0 */
+        pthread_mutex_lock(&pool->mu);
+        atomic_fetch_sub(&lane->active, 1);
+        pthread_cond_broadcast(&pool->idle_cv);
+    }
+    pthread_mutex_unlock(&pool->mu);
+
+    return NULL;
+}
+
+audyn_encoder_pool_t *audyn_encoder_pool_create(uint32_t threads)
+{
+    if (threads == 0) {
+        long n = sysconf(_SC_NPROCESSORS_ONLN);
+        threads = (n > 0) ? (uint32_t)n : 1u;
+    }
+    if (threads > AUDYN_ENC_POOL_MAX_THREADS) threads = AUDYN_ENC_POOL_MAX_THREADS;
+
+    audyn_encoder_pool_t *pool = (audyn_encoder_pool_t *)calloc(1, sizeof(*pool));
+    if (!pool) {
+        LOG_ERROR("encoder_pool: allocation failed");
+        return NULL;
+    }
+
+    pool->threads = (pthread_t *)calloc(threads, sizeof(pthread_t));
+    if (!pool->threads) {
+        LOG_ERROR("encoder_pool: allocation failed");
+        free(pool);
+        return NULL;
+    }
+
+    pthread_mutex_init(&pool->mu, NULL);
+    pthread_cond_init(&pool->work_cv, NULL);
+    pthread_cond_init(&pool->idle_cv, NULL);
+
+    for (uint32_t i = 0; i < threads; i++) {
+        if (pthread_create(&pool->threads[i], NULL, pool_thread, pool) != 0) {
+            LOG_ERROR("encoder_pool: failed to start thread %u", i);
+            audyn_encoder_pool_destroy(pool);
+            return NULL;
+        }
+        pool->nthreads++;
+        (void)audyn_rt_thread(pool->threads[i], AUDYN_RT_ROLE_ENCODER);
+    }
+
+    LOG_INFO("encoder_pool: %u encoder thread%s", pool->nthreads,
+             pool->nthreads == 1 ? "" : "s");
+    return pool;
+}
+
+void audyn_encoder_pool_destroy(audyn_encoder_pool_t *pool)
+{
+    if (!pool) return;
+
+    pthread_mutex_lock(&pool->mu);
+    pool->stop = 1;
+    pthread_cond_broadcast(&pool->work_cv);
+    pthread_mutex_unlock(&pool->mu);
+
+    for (uint32_t i = 0; i < pool->nthreads; i++) {
+        pthread_join(pool->threads[i], NULL);
+    }
+
+    pthread_cond_destroy(&pool->idle_cv);
+    pthread_cond_destroy(&pool->work_cv);
+    pthread_mutex_destroy(&pool->mu);
+    free(pool->threads);
+    free(pool);
+}
+
+uint32_t audyn_encoder_pool_threads(const audyn_encoder_pool_t *pool)
+{
+    return pool ? pool->nthreads : 0;
+}
+
+/* -------- Lanes -------- */
+
+audyn_enc_lane_t *audyn_enc_lane_create(audyn_encoder_pool_t *pool,
+                                        uint16_t channels,
+                                        uint32_t capacity_frames,
+                                        audyn_enc_lane_fn fn,
+                                        void *user)
+{
+    if (!pool || !fn || channels == 0 || capacity_frames == 0) return NULL;
+
+    audyn_enc_lane_t *lane = (audyn_enc_lane_t *)calloc(1, sizeof(*lane));
+    if (!lane) return NULL;
+
+    lane->ring = (float *)malloc((size_t)capacity_frames * channels * sizeof(float));
+    if (!lane->ring) {
+        free(lane);
+        return NULL;
+    }
+
+    lane->pool = pool;
+    lane->fn = fn;
+    lane->user = user;
+    lane->cap = capacity_frames;
+    lane->channels = channels;
+    atomic_init(&lane->head, 0);
+    atomic_init(&lane->tail, 0);
+    atomic_init(&lane->scheduled, 0);
+    atomic_init(&lane->active, 0);
+    atomic_init(&lane->failed, 0);
+    atomic_init(&lane->pending_ns, 0);
+    atomic_init(&lane->backlog_max, 0);
+    atomic_init(&lane->delay_us_last, 0);
+    atomic_init(&lane->delay_us_max, 0);
+
+    return lane;
+}
+
+int audyn_enc_lane_push(audyn_enc_lane_t *lane, const float *pcm, uint32_t frames)
+{
+    if (!lane) return -1;
+    if (atomic_load_explicit(&lane->failed, memory_order_relaxed)) return -1;
+    if (frames == 0) return 0;
+
+    const uint64_t h = atomic_load_explicit(&lane->head, memory_order_relaxed);
+    const uint64_t t = atomic_load_explicit(&lane->tail, memory_order_acquire);
+    const uint64_t used = h - t;
+
+    if (frames > lane->cap - used) return 1;
+
+    if (used == 0) {
+        atomic_store_explicit(&lane->pending_ns, mono_ns(), memory_order_relaxed);
+    }
+
+    const size_t ch = lane->channels;
+    const uint32_t off = (uint32_t)(h % lane->cap);
+    uint32_t first = lane->cap - off;
+    if (first > frames) first = frames;
+
+    memcpy(lane->ring + (size_t)off * ch, pcm, (size_t)first * ch * sizeof(float));
+    if (frames > first) {
+        memcpy(lane->ring, pcm + (size_t)first * ch,
+               (size_t)(frames - first) * ch * sizeof(float));
+    }
+
+    atomic_store_explicit(&lane->head, h + frames, memory_order_seq_cst);
+    atomic_max_u32(&lane->backlog_max, (uint32_t)(used + frames));
+
+    if (!atomic_exchange_explicit(&lane->scheduled, 1, memory_order_seq_cst)) {
+        runq_push(lane->pool, lane);
+    }
+
+    return 0;
+}
+
+int audyn_enc_lane_drain(audyn_enc_lane_t *lane)
+{
+    if (!lane) return -1;
+
+    audyn_encoder_pool_t *pool = lane->pool;
+
+    pthread_mutex_lock(&pool->mu);
+    while (audyn_enc_lane_busy(lane)) {
+        pthread_cond_wait(&pool->idle_cv, &pool->mu);
+    }
+    pthread_mutex_unlock(&pool->mu);
+
+    return atomic_load(&lane->failed) ? -1 : 0;
+}
+
+int audyn_enc_lane_busy(const audyn_enc_lane_t *lane)
+{
+    if (!lane) return 0;
+
+    audyn_enc_lane_t *l = (audyn_enc_lane_t *)lane;
+    return atomic_load(&l->active) || atomic_load(&l->scheduled) ||
+           atomic_load(&l->tail) != atomic_load(&l->head);
+}
+
+void audyn_enc_lane_destroy(audyn_enc_lane_t *lane)
+{
+    if (!lane) return;
+
+    (void)audyn_enc_lane_drain(lane);
+    free(lane->ring);
+    free(lane);
+}
+
+void audyn_enc_lane_get_stats(const audyn_enc_lane_t *lane, audyn_enc_lane_stats_t *stats)
+{
+    if (!lane || !stats) return;
+
+    audyn_enc_lane_t *l = (audyn_enc_lane_t *)lane;
+    const uint64_t h = atomic_load_explicit(&l->head, memory_order_relaxed);
+    const uint64_t t = atomic_load_explicit(&l->tail, memory_order_relaxed);
+
+    stats->backlog_frames = (h >= t) ? (uint32_t)(h - t) : 0;
+    stats->backlog_max_frames = atomic_load_explicit(&l->backlog_max, memory_order_relaxed);
+    stats->queue_delay_us_last = atomic_load_explicit(&l->delay_us_last, memory_order_relaxed);
+    stats->queue_delay_us_max = atomic_load_explicit(&l->delay_us_max, memory_order_relaxed);
+}
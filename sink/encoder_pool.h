@@ -0,0 +1,127 @@
+/*
+ *  Audyn — Professional Audio Capture & Archival Engine
+ *
+ *  File:
+ *      encoder_pool.h
+ *
+ *  Purpose:
+ *      Shared pool of encoder threads for the compressing sinks.
+ *
+ *      Each stream owns a lane: a bounded single-producer/single-consumer
+ *      ring of interleaved float samples. The producer (the stream's
+ *      worker) copies audio into the ring and returns at once; pool
+ *      threads run the lane's encode callback on whatever is queued. A
+ *      lane is serviced by at most one thread at a time, so the callback
+ *      sees the samples in order and needs no locking of its own.
+ *
+ *  Scheduling:
+ *      A push that finds its lane idle puts the lane on the pool's run
+ *      queue (one mutex-protected list append per idle -> busy transition,
+ *      never held across an encode). A thread drains the lane until it is
+ *      empty and then releases it. Streams therefore share the threads
+ *      fairly at lane granularity.
+ *
+ *  Backpressure:
+ *      push() never waits. When the ring lacks space for the whole block
+ *      nothing is queued and the caller decides (opus_sink queues the same
+ *      number of frames of silence in its place once there is room).
+ *
+ *  Threading:
+ *      - push()/backlog are called by the lane's single producer
+ *      - drain()/destroy() by the same producer (block until idle)
+ *      - busy() by the producer (non-blocking idle check)
+ *      - The callback runs on pool threads
+ *
+ *  Dependencies:
+ *      - pthread, C11 atomics
+ *
+ *  Copyright:
+ *      (c) 2026 B. Wynne
+ *
+ *  Author:
+ *      B. Wynne
+ *
+ *  License:
+ *      GPLv2 or later
+ */
+
+#ifndef AUDYN_ENCODER_POOL_H
+#define AUDYN_ENCODER_POOL_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Upper bound for the thread count (0 = online CPUs, clamped to this) */
+#define AUDYN_ENC_POOL_MAX_THREADS 32
+
+typedef struct audyn_encoder_pool audyn_encoder_pool_t;
+typedef struct audyn_enc_lane audyn_enc_lane_t;
+
+/*
+ * Encode callback: consume 'frames' interleaved sample frames. Called on a
+ * pool thread with contiguous spans, in push order. Return 0 on success;
+ * -1 marks the lane failed (later pushes fail, queued audio is discarded).
+ */
+typedef int (*audyn_enc_lane_fn)(void *user, const float *pcm, uint32_t frames);
+
+typedef struct audyn_enc_lane_stats {
+    uint32_t backlog_frames;        /* Frames queued, not yet handed to the callback */
+    uint32_t backlog_max_frames;    /* High-water mark of backlog_frames */
+    uint32_t queue_delay_us_last;   /* Age of the oldest queued audio at pickup */
+    uint32_t queue_delay_us_max;
+} audyn_enc_lane_stats_t;
+
+/*
+ * Start 'threads' encoder threads (0 = one per online CPU).
+ * Returns pool or NULL on error (logged). NOT real-time safe.
+ */
+audyn_encoder_pool_t *audyn_encoder_pool_create(uint32_t threads);
+
+/* Stop and join all threads. Every lane must have been destroyed. */
+void audyn_encoder_pool_destroy(audyn_encoder_pool_t *pool);
+
+uint32_t audyn_encoder_pool_threads(const audyn_encoder_pool_t *pool);
+
+/*
+ * Create a lane with room for capacity_frames sample frames of 'channels'
+ * interleaved floats. Returns lane or NULL on error.
+ */
+audyn_enc_lane_t *audyn_enc_lane_create(audyn_encoder_pool_t *pool,
+                                        uint16_t channels,
+                                        uint32_t capacity_frames,
+                                        audyn_enc_lane_fn fn,
+                                        void *user);
+
+/*
+ * Queue 'frames' sample frames. Never blocks.
+ * Returns 0 if queued, 1 if the ring is full (nothing queued), -1 if the
+ * lane has failed.
+ */
+int audyn_enc_lane_push(audyn_enc_lane_t *lane, const float *pcm, uint32_t frames);
+
+/*
+ * Block until everything pushed so far has been through the callback.
+ * Returns 0, or -1 if the lane has failed.
+ */
+int audyn_enc_lane_drain(audyn_enc_lane_t *lane);
+
+/*
+ * 1 while pushed audio is queued or a pool thread still holds the lane,
+ * else 0. Never blocks; once it returns 0 with no further pushes,
+ * destroy() does not wait.
+ */
+int audyn_enc_lane_busy(const audyn_enc_lane_t *lane);
+
+/* Drain and free the lane (safe with NULL). */
+void audyn_enc_lane_destroy(audyn_enc_lane_t *lane);
+
+void audyn_enc_lane_get_stats(const audyn_enc_lane_t *lane, audyn_enc_lane_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* AUDYN_ENCODER_POOL_H */
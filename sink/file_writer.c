@@ -0,0 +1,1141 @@
+/*
+ *  Audyn — Professional Audio Capture & Archival Engine
+ *
+ *  File:
+ *      file_writer.c
+ *
+ *  Purpose:
+ *      Append-only file writer with io_uring, writer-thread and stdio
+ *      backends (see file_writer.h).
+ *
+ *  Buffer rotation:
+ *      The caller fills bufs[cur]. A full buffer is marked busy and
+ *      submitted at the next file offset; the caller moves on to the next
+ *      buffer in the ring, waiting only if that one is still in flight.
+ *      With O_DIRECT an early (time budget) submission is rounded down to
+ *      AUDYN_FW_ALIGN and the unaligned tail is carried into the next
+ *      buffer, so every submission stays aligned.
+ *
+ *  Thread backend:
+ *      Writers share one process-wide pool of FW_POOL_THREADS I/O threads,
+ *      started by the first thread-backend open and kept for the life of
+ *      the process, so rotations and seek indexes do not create threads.
+ *      A writer with queued items sits on the pool's run queue; one pool
+ *      thread at a time services it ('t_scheduled', under w->lock), which
+ *      keeps a sync behind the writes queued before it. Lock order:
+ *      w->lock, then the pool lock.
+ *
+ *      Statistics are updated under w->lock for this backend (the pool
+ *      thread counts syncs and errors), see stat_add().
+ *
+ *  Copyright:
+ *      (c) 2026 B. Wynne
+ *
+ *  Author:
+ *      B. Wynne
+ *
+ *  License:
+ *      GPLv2 or later
+ */
+
+#define _GNU_SOURCE
+
+#include "file_writer.h"
+#include "log.h"
+#include "metrics.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <linux/io_uring.h>
+
+#define FW_DEFAULT_SYNC_MS  1000u
+
+/* io_uring user_data tags (buffer index otherwise) */
+#define FW_UD_SYNC          0xFFFFFFFF00000001ull
+#define FW_UD_KICK          0xFFFFFFFF00000002ull
+
+/* Thread backend queue entry for a sync request */
+#define FW_Q_SYNC           (-1)
+
+/* Shared I/O threads for the thread backend */
+#define FW_POOL_THREADS     4
+
+typedef enum fw_buf_state {
+    FW_BUF_FREE = 0,
+    FW_BUF_FILL,
+    FW_BUF_BUSY
+} fw_buf_state_t;
+
+typedef struct fw_buf {
+    uint8_t *data;
+    size_t   len;               /* Valid bytes (submitted length once busy) */
+    size_t   done;              /* Bytes completed (io_uring short writes);
+                                 * starts past a leading sparse hole */
+    uint64_t off;               /* File offset of data[0] once submitted */
+    fw_buf_state_t state;
+} fw_buf_t;
+
+typedef struct fw_uring {
+    int fd;
+    unsigned sq_entries;
+    unsigned *sq_head, *sq_tail, *sq_mask, *sq_array;
+    unsigned *cq_head, *cq_tail, *cq_mask;
+    struct io_uring_sqe *sqes;
+    struct io_uring_cqe *cqes;
+    void  *sq_ptr, *cq_ptr;
+    size_t sq_sz, cq_sz, sqes_sz;
+    uint32_t ops;               /* SQEs submitted, not yet completed */
+} fw_uring_t;
+
+struct audyn_file_writer {
+    audyn_file_writer_cfg_t cfg;
+    audyn_fw_backend_t backend;
+    char    *path;
+    int      fd;
+    FILE    *fp;                /* stdio backend */
+    int      direct;            /* O_DIRECT currently set on fd */
+    int      padded;            /* File may not end at pos: O_DIRECT padding or a
+                                 * trailing sparse hole (truncate on drain) */
+
+    fw_buf_t bufs[AUDYN_FW_MAX_BUFFERS];
+    uint32_t nbufs;
+    size_t   buf_bytes;
+    uint32_t cur;
+
+    uint64_t pos;               /* Logical bytes appended */
+    uint64_t submitted;         /* File offset of the next submission */
+    uint64_t unsynced;          /* Bytes submitted since the last sync request */
+    uint64_t last_sync_ns;
+    uint64_t sync_interval_ns;
+
+    atomic_int failed;          /* Sticky error from any backend */
+    int      sync_pending;      /* Sync requested, not yet completed */
+    uint64_t sync_start_ns;     /* io_uring: sync submitted (metrics on, else 0) */
+
+    /* Thread backend */
+    int             lock_init;
+    pthread_mutex_t lock;
+    pthread_cond_t  cond;
+    int             queue[AUDYN_FW_MAX_BUFFERS + 1];
+    uint32_t        q_head, q_count;
+    uint32_t        t_inflight; /* Queued or executing items */
+    int             t_scheduled;/* On the pool run queue or being serviced */
+    audyn_file_writer_t *t_next;/* Pool run queue link (pool lock) */
+
+    /* io_uring backend */
+    fw_uring_t ring;
+
+    audyn_file_writer_stats_t stats;
+};
+
+/* -------- Helpers -------- */
+
+/* Add to a stats field; under w->lock where a pool thread also updates them */
+static void stat_add(audyn_file_writer_t *w, uint64_t *field, uint64_t n)
+{
+    if (w->backend == AUDYN_FW_THREAD) {
+        pthread_mutex_lock(&w->lock);
+        *field += n;
+        pthread_mutex_unlock(&w->lock);
+    } else {
+        *field += n;
+    }
+}
+
+static uint64_t mono_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+/* fdatasync(), timed for the FSYNC stage */
+static int timed_fdatasync(int fd)
+{
+    const uint64_t t0 = audyn_metrics_start();
+    const int rc = fdatasync(fd);
+    audyn_metrics_stage_end(AUDYN_STAGE_FSYNC, t0);
+    return rc;
+}
+
+static int pwrite_full(int fd, const uint8_t *p, size_t len, uint64_t off)
+{
+    while (len > 0) {
+        ssize_t n = pwrite(fd, p, len, (off_t)off);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return -1;
+        }
+        if (n == 0) {
+            errno = EIO;
+            return -1;
+        }
+        p += n;
+        len -= (size_t)n;
+        off += (uint64_t)n;
+    }
+    return 0;
+}
+
+static void kick_writeback(audyn_file_writer_t *w, uint64_t off, size_t len)
+{
+    /* Start writeback of a completed buffer (page cache only; no wait) */
+    if (!w->direct) {
+        (void)sync_file_range(w->fd, (off64_t)off, (off64_t)len, SYNC_FILE_RANGE_WRITE);
+    }
+}
+
+/* -------- io_uring backend -------- */
+
+static int sys_uring_setup(unsigned entries, struct io_uring_params *p)
+{
+    return (int)syscall(__NR_io_uring_setup, entries, p);
+}
+
+static int sys_uring_enter(int fd, unsigned to_submit, unsigned min_complete, unsigned flags)
+{
+    return (int)syscall(__NR_io_uring_enter, fd, to_submit, min_complete, flags, NULL, 0);
+}
+
+static void uring_teardown(fw_uring_t *r)
+{
+    if (r->sqes && r->sqes != MAP_FAILED) munmap(r->sqes, r->sqes_sz);
+    if (r->cq_ptr && r->cq_ptr != MAP_FAILED && r->cq_ptr != r->sq_ptr) munmap(r->cq_ptr, r->cq_sz);
+    if (r->sq_ptr && r->sq_ptr != MAP_FAILED) munmap(r->sq_ptr, r->sq_sz);
+    if (r->fd >= 0) close(r->fd);
+    memset(r, 0, sizeof(*r));
+    r->fd = -1;
+}
+
+static int uring_setup(fw_uring_t *r, unsigned entries)
+{
+    struct io_uring_params p;
+    memset(&p, 0, sizeof(p));
+    memset(r, 0, sizeof(*r));
+    r->fd = -1;
+
+    int fd = sys_uring_setup(entries, &p);
+    if (fd < 0) {
+        LOG_DEBUG("file_writer: io_uring_setup failed: %s", strerror(errno));
+        return -1;
+    }
+    r->fd = fd;
+
+    /* IORING_OP_WRITE and IOSQE_ASYNC need 5.6+; FAST_POLL (5.7) is the
+     * nearest feature bit that implies both */
+    if (!(p.features & IORING_FEAT_FAST_POLL)) {
+        LOG_DEBUG("file_writer: io_uring too old (features=0x%x)", p.features);
+        uring_teardown(r);
+        return -1;
+    }
+
+    r->sq_sz = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+    r->cq_sz = p.cq_off.cqes + p.cq_entries * sizeof(struct io_uring_cqe);
+    if (p.features & IORING_FEAT_SINGLE_MMAP) {
+        if (r->cq_sz > r->sq_sz) r->sq_sz = r->cq_sz;
+        r->cq_sz = r->sq_sz;
+    }
+
+    r->sq_ptr = mmap(NULL, r->sq_sz, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                     fd, IORING_OFF_SQ_RING);
+    if (r->sq_ptr == MAP_FAILED) {
+        uring_teardown(r);
+        return -1;
+    }
+    if (p.features & IORING_FEAT_SINGLE_MMAP) {
+        r->cq_ptr = r->sq_ptr;
+    } else {
+        r->cq_ptr = mmap(NULL, r->cq_sz, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                         fd, IORING_OFF_CQ_RING);
+        if (r->cq_ptr == MAP_FAILED) {
+            uring_teardown(r);
+            return -1;
+        }
+    }
+
+    r->sqes_sz = p.sq_entries * sizeof(struct io_uring_sqe);
+    r->sqes = mmap(NULL, r->sqes_sz, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                   fd, IORING_OFF_SQES);
+    if (r->sqes == MAP_FAILED) {
+        uring_teardown(r);
+        return -1;
+    }
+
+    uint8_t *sq = (uint8_t *)r->sq_ptr;
+    uint8_t *cq = (uint8_t *)r->cq_ptr;
+    r->sq_head  = (unsigned *)(sq + p.sq_off.head);
+    r->sq_tail  = (unsigned *)(sq + p.sq_off.tail);
+    r->sq_mask  = (unsigned *)(sq + p.sq_off.ring_mask);
+    r->sq_array = (unsigned *)(sq + p.sq_off.array);
+    r->cq_head  = (unsigned *)(cq + p.cq_off.head);
+    r->cq_tail  = (unsigned *)(cq + p.cq_off.tail);
+    r->cq_mask  = (unsigned *)(cq + p.cq_off.ring_mask);
+    r->cqes     = (struct io_uring_cqe *)(cq + p.cq_off.cqes);
+    r->sq_entries = p.sq_entries;
+
+    return 0;
+}
+
+static int uring_reap(audyn_file_writer_t *w, unsigned wait_min);
+
+static struct io_uring_sqe *uring_get_sqe(audyn_file_writer_t *w)
+{
+    fw_uring_t *r = &w->ring;
+
+    for (;;) {
+        unsigned tail = *r->sq_tail;
+        unsigned head = __atomic_load_n(r->sq_head, __ATOMIC_ACQUIRE);
+        if (tail - head < r->sq_entries) {
+            unsigned idx = tail & *r->sq_mask;
+            struct io_uring_sqe *sqe = &r->sqes[idx];
+            memset(sqe, 0, sizeof(*sqe));
+            r->sq_array[idx] = idx;
+            return sqe;
+        }
+        /* Ring sized for the worst case; only reached if the kernel lags */
+        if (uring_reap(w, 1) != 0) return NULL;
+    }
+}
+
+static int uring_submit_sqe(audyn_file_writer_t *w)
+{
+    fw_uring_t *r = &w->ring;
+
+    __atomic_store_n(r->sq_tail, *r->sq_tail + 1, __ATOMIC_RELEASE);
+    r->ops++;
+
+    for (;;) {
+        int rc = sys_uring_enter(r->fd, 1, 0, 0);
+        if (rc >= 0) return 0;
+        if (errno == EINTR) continue;
+        if (errno == EAGAIN || errno == EBUSY) {
+            /* Completion queue pressure: reap, then resubmit */
+            if (uring_reap(w, 1) != 0) return -1;
+            continue;
+        }
+        LOG_ERROR("file_writer: io_uring_enter failed for '%s': %s", w->path, strerror(errno));
+        return -1;
+    }
+}
+
+static int uring_queue_write(audyn_file_writer_t *w, uint32_t idx)
+{
+    fw_buf_t *b = &w->bufs[idx];
+    struct io_uring_sqe *sqe = uring_get_sqe(w);
+    if (!sqe) return -1;
+
+    sqe->opcode = IORING_OP_WRITE;
+    sqe->fd = w->fd;
+    sqe->addr = (uint64_t)(uintptr_t)(b->data + b->done);
+    sqe->len = (uint32_t)(b->len - b->done);
+    sqe->off = b->off + b->done;
+    /* Buffered writes can block inline in the submitter; force the async
+     * worker so the caller never waits on the page cache */
+    sqe->flags = w->direct ? 0 : IOSQE_ASYNC;
+    sqe->user_data = idx;
+
+    return uring_submit_sqe(w);
+}
+
+static int uring_queue_kick(audyn_file_writer_t *w, uint64_t off, size_t len)
+{
+    struct io_uring_sqe *sqe = uring_get_sqe(w);
+    if (!sqe) return -1;
+
+    sqe->opcode = IORING_OP_SYNC_FILE_RANGE;
+    sqe->fd = w->fd;
+    sqe->off = off;
+    sqe->len = (uint32_t)len;
+    sqe->sync_range_flags = SYNC_FILE_RANGE_WRITE;
+    sqe->user_data = FW_UD_KICK;
+
+    return uring_submit_sqe(w);
+}
+
+static int uring_queue_sync(audyn_file_writer_t *w)
+{
+    struct io_uring_sqe *sqe = uring_get_sqe(w);
+    if (!sqe) return -1;
+
+    sqe->opcode = IORING_OP_FSYNC;
+    sqe->fd = w->fd;
+    sqe->fsync_flags = IORING_FSYNC_DATASYNC;
+    /* Drain: runs after every write submitted before it */
+    sqe->flags = IOSQE_IO_DRAIN;
+    sqe->user_data = FW_UD_SYNC;
+    w->sync_start_ns = audyn_metrics_start();
+
+    return uring_submit_sqe(w);
+}
+
+static void uring_complete(audyn_file_writer_t *w, uint64_t ud, int res)
+{
+    if (ud == FW_UD_KICK) {
+        /* Best effort; some filesystems reject sync_file_range */
+        return;
+    }
+
+    if (ud == FW_UD_SYNC) {
+        w->sync_pending = 0;
+        audyn_metrics_stage_end(AUDYN_STAGE_FSYNC, w->sync_start_ns);
+        if (res < 0) {
+            LOG_ERROR("file_writer: fdatasync failed for '%s': %s", w->path, strerror(-res));
+            w->stats.errors++;
+            w->failed = 1;
+        } else {
+            w->stats.syncs++;
+        }
+        return;
+    }
+
+    if (ud >= w->nbufs) return;
+    fw_buf_t *b = &w->bufs[ud];
+
+    if (res <= 0) {
+        LOG_ERROR("file_writer: write failed for '%s' at %llu: %s", w->path,
+                  (unsigned long long)b->off, res < 0 ? strerror(-res) : "short write");
+        w->stats.errors++;
+        w->failed = 1;
+        b->state = FW_BUF_FREE;
+        return;
+    }
+
+    b->done += (size_t)res;
+    if (b->done < b->len) {
+        /* Short write: resubmit the remainder */
+        if (uring_queue_write(w, (uint32_t)ud) != 0) {
+            w->stats.errors++;
+            w->failed = 1;
+            b->state = FW_BUF_FREE;
+        }
+        return;
+    }
+
+    if (!w->direct) (void)uring_queue_kick(w, b->off, b->len);
+    b->state = FW_BUF_FREE;
+}
+
+/* Process completions; wait for at least wait_min if > 0 */
+static int uring_reap(audyn_file_writer_t *w, unsigned wait_min)
+{
+    fw_uring_t *r = &w->ring;
+
+    while (wait_min > 0) {
+        int rc = sys_uring_enter(r->fd, 0, wait_min, IORING_ENTER_GETEVENTS);
+        if (rc >= 0) break;
+        if (errno == EINTR) continue;
+        LOG_ERROR("file_writer: io_uring wait failed for '%s': %s", w->path, strerror(errno));
+        w->failed = 1;
+        return -1;
+    }
+
+    unsigned head = *r->cq_head;
+    for (;;) {
+        unsigned tail = __atomic_load_n(r->cq_tail, __ATOMIC_ACQUIRE);
+        if (head == tail) break;
+        struct io_uring_cqe *cqe = &r->cqes[head & *r->cq_mask];
+        uint64_t ud = cqe->user_data;
+        int res = cqe->res;
+        head++;
+        __atomic_store_n(r->cq_head, head, __ATOMIC_RELEASE);
+        if (r->ops > 0) r->ops--;
+        /* May queue follow-up SQEs (kick, short-write remainder) */
+        uring_complete(w, ud, res);
+    }
+    return 0;
+}
+
+/* -------- Thread backend -------- */
+
+static struct {
+    pthread_once_t  once;
+    pthread_mutex_t mu;
+    pthread_cond_t  cv;
+    audyn_file_writer_t *runq_head;
+    audyn_file_writer_t *runq_tail;
+    uint32_t nthreads;
+} g_pool = {
+    PTHREAD_ONCE_INIT, PTHREAD_MUTEX_INITIALIZER, PTHREAD_COND_INITIALIZER,
+    NULL, NULL, 0
+};
+
+/* Run everything queued on w; caller is the pool thread that dequeued it */
+static void writer_service(audyn_file_writer_t *w)
+{
+    pthread_mutex_lock(&w->lock);
+    while (w->q_count > 0) {
+        int item = w->queue[w->q_head];
+        w->q_head = (w->q_head + 1) % (AUDYN_FW_MAX_BUFFERS + 1);
+        w->q_count--;
+        pthread_mutex_unlock(&w->lock);
+
+        int rc;
+        if (item == FW_Q_SYNC) {
+            rc = timed_fdatasync(w->fd);
+            if (rc != 0) {
+                LOG_ERROR("file_writer: fdatasync failed for '%s': %s", w->path, strerror(errno));
+            }
+        } else {
+            fw_buf_t *b = &w->bufs[item];
+            rc = pwrite_full(w->fd, b->data + b->done, b->len - b->done, b->off + b->done);
+            if (rc != 0) {
+                LOG_ERROR("file_writer: write failed for '%s' at %llu: %s", w->path,
+                          (unsigned long long)b->off, strerror(errno));
+            } else {
+                kick_writeback(w, b->off + b->done, b->len - b->done);
+            }
+        }
+
+        pthread_mutex_lock(&w->lock);
+        if (item == FW_Q_SYNC) {
+            w->sync_pending = 0;
+            if (rc == 0) w->stats.syncs++;
+        } else {
+            w->bufs[item].state = FW_BUF_FREE;
+        }
+        if (rc != 0) {
+            w->stats.errors++;
+            w->failed = 1;
+        }
+        w->t_inflight--;
+        pthread_cond_broadcast(&w->cond);
+    }
+    /* Last touch of w: close() may free it once this is seen under the lock */
+    w->t_scheduled = 0;
+    pthread_cond_broadcast(&w->cond);
+    pthread_mutex_unlock(&w->lock);
+}
+
+static void *pool_thread(void *arg)
+{
+    (void)arg;
+    (void)pthread_setname_np(pthread_self(), "audyn-fw-io");
+
+    pthread_mutex_lock(&g_pool.mu);
+    for (;;) {
+        while (!g_pool.runq_head) {
+            pthread_cond_wait(&g_pool.cv, &g_pool.mu);
+        }
+        audyn_file_writer_t *w = g_pool.runq_head;
+        g_pool.runq_head = w->t_next;
+        if (!g_pool.runq_head) g_pool.runq_tail = NULL;
+        pthread_mutex_unlock(&g_pool.mu);
+
+        writer_service(w);
+
+        pthread_mutex_lock(&g_pool.mu);
+    }
+    return NULL;
+}
+
+static void pool_start(void)
+{
+    for (uint32_t i = 0; i < FW_POOL_THREADS; i++) {
+        pthread_t t;
+        if (pthread_create(&t, NULL, pool_thread, NULL) != 0) break;
+        (void)pthread_detach(t);
+        g_pool.nthreads++;
+    }
+    if (g_pool.nthreads > 0) {
+        LOG_DEBUG("file_writer: %u shared I/O threads", g_pool.nthreads);
+    }
+}
+
+static void thread_enqueue(audyn_file_writer_t *w, int item)
+{
+    /* Caller holds w->lock. At most nbufs buffers + one sync are queued. */
+    uint32_t slot = (w->q_head + w->q_count) % (AUDYN_FW_MAX_BUFFERS + 1);
+    w->queue[slot] = item;
+    w->q_count++;
+    w->t_inflight++;
+
+    if (!w->t_scheduled) {
+        w->t_scheduled = 1;
+        pthread_mutex_lock(&g_pool.mu);
+        w->t_next = NULL;
+        if (g_pool.runq_tail) {
+            g_pool.runq_tail->t_next = w;
+        } else {
+            g_pool.runq_head = w;
+        }
+        g_pool.runq_tail = w;
+        pthread_cond_signal(&g_pool.cv);
+        pthread_mutex_unlock(&g_pool.mu);
+    }
+}
+
+/* -------- Backend dispatch -------- */
+
+/* Write bufs[idx] from byte 'head' (bytes before it are left as a hole) */
+static void backend_submit(audyn_file_writer_t *w, uint32_t idx, size_t head)
+{
+    fw_buf_t *b = &w->bufs[idx];
+    b->done = head;
+
+    if (w->backend == AUDYN_FW_URING) {
+        w->stats.writes++;
+        b->state = FW_BUF_BUSY;
+        if (uring_queue_write(w, idx) != 0) {
+            w->stats.errors++;
+            w->failed = 1;
+            b->state = FW_BUF_FREE;
+        }
+    } else {
+        pthread_mutex_lock(&w->lock);
+        w->stats.writes++;
+        b->state = FW_BUF_BUSY;
+        thread_enqueue(w, (int)idx);
+        pthread_mutex_unlock(&w->lock);
+    }
+}
+
+static void backend_request_sync(audyn_file_writer_t *w)
+{
+    if (w->backend == AUDYN_FW_URING) {
+        if (w->sync_pending) return;
+        w->sync_pending = 1;
+        if (uring_queue_sync(w) != 0) {
+            w->sync_pending = 0;
+            w->stats.errors++;
+            w->failed = 1;
+        }
+    } else {
+        pthread_mutex_lock(&w->lock);
+        if (!w->sync_pending) {
+            w->sync_pending = 1;
+            thread_enqueue(w, FW_Q_SYNC);
+        }
+        pthread_mutex_unlock(&w->lock);
+    }
+}
+
+/* Wait until buffer idx is free; returns 1 if the caller had to wait */
+static int backend_wait_free(audyn_file_writer_t *w, uint32_t idx)
+{
+    int waited = 0;
+
+    if (w->backend == AUDYN_FW_URING) {
+        while (w->bufs[idx].state == FW_BUF_BUSY) {
+            waited = 1;
+            if (uring_reap(w, 1) != 0) {
+                w->bufs[idx].state = FW_BUF_FREE;
+                break;
+            }
+        }
+    } else {
+        pthread_mutex_lock(&w->lock);
+        while (w->bufs[idx].state == FW_BUF_BUSY) {
+            waited = 1;
+            pthread_cond_wait(&w->cond, &w->lock);
+        }
+        pthread_mutex_unlock(&w->lock);
+    }
+    return waited;
+}
+
+/* Wait for every submitted write and sync to complete */
+static void backend_wait_idle(audyn_file_writer_t *w)
+{
+    if (w->backend == AUDYN_FW_URING) {
+        while (w->ring.ops > 0) {
+            if (uring_reap(w, 1) != 0) break;
+        }
+    } else {
+        pthread_mutex_lock(&w->lock);
+        while (w->t_inflight > 0 || w->t_scheduled) {
+            pthread_cond_wait(&w->cond, &w->lock);
+        }
+        pthread_mutex_unlock(&w->lock);
+    }
+}
+
+/* -------- Sparse holes -------- */
+
+static int is_zero(const uint8_t *p, size_t n)
+{
+    return n == 0 || (p[0] == 0 && memcmp(p, p + 1, n - 1) == 0);
+}
+
+/*
+ * All-zero AUDYN_FW_ALIGN pages (at absolute file offsets) at the start and
+ * end of a submission of len bytes at off. On return data[*head, *end) is
+ * what has to be written; the rest reads back as zeros without a write,
+ * since the writer never writes a range twice. Page granularity keeps
+ * O_DIRECT submissions aligned.
+ */
+static void sparse_trim(const uint8_t *data, uint64_t off, size_t len,
+                        size_t *head, size_t *end)
+{
+    size_t h = 0;
+    while (h < len) {
+        size_t seg = AUDYN_FW_ALIGN - (size_t)((off + h) % AUDYN_FW_ALIGN);
+        if (seg > len - h) seg = len - h;
+        if (!is_zero(data + h, seg)) break;
+        h += seg;
+    }
+
+    size_t e = len;
+    while (e > h) {
+        size_t seg = (size_t)((off + e) % AUDYN_FW_ALIGN);
+        if (seg == 0) seg = AUDYN_FW_ALIGN;
+        if (seg > e - h) seg = e - h;
+        if (!is_zero(data + e - seg, seg)) break;
+        e -= seg;
+    }
+
+    *head = h;
+    *end = e;
+}
+
+/*
+ * Submit the current buffer and advance to the next.
+ *
+ * final = 0: with O_DIRECT only the aligned prefix is submitted and the
+ *            tail moves to the next buffer.
+ * final = 1: the whole buffer is submitted (zero-padded with O_DIRECT).
+ */
+static void submit_current(audyn_file_writer_t *w, int final)
+{
+    fw_buf_t *b = &w->bufs[w->cur];
+    size_t sub = b->len;
+    size_t tail = 0;
+
+    if (b->len == 0) return;
+
+    if (w->direct) {
+        if (final) {
+            size_t padded = (b->len + AUDYN_FW_ALIGN - 1) & ~(size_t)(AUDYN_FW_ALIGN - 1);
+            if (padded != b->len) {
+                memset(b->data + b->len, 0, padded - b->len);
+                w->padded = 1;
+            }
+            sub = padded;
+        } else {
+            sub = b->len & ~(size_t)(AUDYN_FW_ALIGN - 1);
+            tail = b->len - sub;
+            if (sub == 0) return;
+        }
+    }
+
+    /* Sparse: skip zero pages at either end; data_len excludes padding */
+    const size_t data_len = sub < b->len ? sub : b->len;
+    size_t head = 0;
+    size_t end = sub;
+    if (w->cfg.sparse) sparse_trim(b->data, w->submitted, sub, &head, &end);
+
+    b->off = w->submitted;
+    b->len = end;
+    w->submitted += sub;
+    if (end < sub) w->padded = 1;   /* Size comes from the truncate on drain */
+
+    if (end > head) {
+        if (w->cfg.sparse) {
+            stat_add(w, &w->stats.hole_bytes, (head < data_len ? head : data_len) +
+                                              (end < data_len ? data_len - end : 0));
+        }
+        w->unsynced += end - head;
+        backend_submit(w, w->cur, head);
+    } else {
+        stat_add(w, &w->stats.hole_bytes, data_len);
+        b->state = FW_BUF_FREE;     /* Nothing but zeros: no I/O at all */
+    }
+
+    uint32_t next = (w->cur + 1) % w->nbufs;
+    if (backend_wait_free(w, next)) {
+        stat_add(w, &w->stats.stalls, 1);
+        audyn_metrics_count(AUDYN_CTR_WRITER_STALLS, 1);
+    }
+
+    fw_buf_t *nb = &w->bufs[next];
+    nb->len = 0;
+    if (tail > 0) {
+        /* In-flight writes only read b->data, so copying the tail is safe */
+        memcpy(nb->data, b->data + sub, tail);
+        nb->len = tail;
+    }
+    nb->state = FW_BUF_FILL;
+    w->cur = next;
+}
+
+/* Submit everything, wait for completion, fix up O_DIRECT padding */
+static void drain(audyn_file_writer_t *w)
+{
+    if (w->backend == AUDYN_FW_STDIO) {
+        if (fflush(w->fp) != 0) {
+            LOG_ERROR("file_writer: fflush failed for '%s': %s", w->path, strerror(errno));
+            w->stats.errors++;
+            w->failed = 1;
+        }
+        return;
+    }
+
+    submit_current(w, 1);
+    backend_wait_idle(w);
+
+    if (w->padded) {
+        if (ftruncate(w->fd, (off_t)w->pos) != 0) {
+            LOG_ERROR("file_writer: truncate failed for '%s': %s", w->path, strerror(errno));
+            stat_add(w, &w->stats.errors, 1);
+            w->failed = 1;
+        }
+        w->padded = 0;
+    }
+    w->submitted = w->pos;
+}
+
+static void maybe_sync(audyn_file_writer_t *w)
+{
+    const uint64_t now = mono_ns();
+    const int time_due = (now - w->last_sync_ns >= w->sync_interval_ns);
+    const int bytes_due = (w->cfg.durable && w->cfg.sync_bytes > 0 &&
+                           w->unsynced >= w->cfg.sync_bytes);
+
+    if (!time_due && !bytes_due) return;
+
+    if (!w->cfg.durable) {
+        /* Bound how long audio sits only in our buffers */
+        if (w->backend != AUDYN_FW_STDIO) submit_current(w, 0);
+    } else if (w->backend == AUDYN_FW_STDIO) {
+        if (fflush(w->fp) != 0 || timed_fdatasync(w->fd) != 0) {
+            LOG_ERROR("file_writer: sync failed for '%s': %s", w->path, strerror(errno));
+            w->stats.errors++;
+            w->failed = 1;
+        } else {
+            w->stats.syncs++;
+        }
+    } else {
+        if (time_due) submit_current(w, 0);
+        backend_request_sync(w);
+    }
+
+    w->last_sync_ns = now;
+    w->unsynced = 0;
+}
+
+/* -------- Public API -------- */
+
+static void free_writer(audyn_file_writer_t *w)
+{
+    for (uint32_t i = 0; i < w->nbufs; i++) {
+        free(w->bufs[i].data);
+    }
+    free(w->path);
+    free(w);
+}
+
+static int open_fd(audyn_file_writer_t *w, const char *path)
+{
+    int flags = O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC;
+
+    if (w->cfg.direct && w->backend != AUDYN_FW_STDIO) {
+        w->fd = open(path, flags | O_DIRECT, 0666);
+        if (w->fd >= 0) {
+            w->direct = 1;
+            return 0;
+        }
+        if (errno != EINVAL) {
+            return -1;
+        }
+        LOG_WARN("file_writer: O_DIRECT not supported for '%s', using buffered I/O", path);
+    }
+
+    w->fd = open(path, flags, 0666);
+    return (w->fd >= 0) ? 0 : -1;
+}
+
+audyn_file_writer_t *audyn_file_writer_open(const char *path,
+                                            const audyn_file_writer_cfg_t *cfg)
+{
+    if (!path || !*path) {
+        LOG_ERROR("file_writer: NULL or empty path");
+        return NULL;
+    }
+
+    audyn_file_writer_t *w = (audyn_file_writer_t *)calloc(1, sizeof(*w));
+    if (!w) {
+        LOG_ERROR("file_writer: Failed to allocate writer");
+        return NULL;
+    }
+
+    if (cfg) w->cfg = *cfg;
+    w->fd = -1;
+    w->ring.fd = -1;
+
+    w->path = strdup(path);
+    if (!w->path) {
+        LOG_ERROR("file_writer: Failed to allocate path string");
+        free(w);
+        return NULL;
+    }
+
+    w->buf_bytes = w->cfg.buffer_bytes ? w->cfg.buffer_bytes : AUDYN_FW_DEFAULT_BUFFER;
+    w->buf_bytes = (w->buf_bytes + AUDYN_FW_ALIGN - 1) & ~(size_t)(AUDYN_FW_ALIGN - 1);
+    w->nbufs = w->cfg.buffers ? w->cfg.buffers : AUDYN_FW_DEFAULT_BUFFERS;
+    if (w->nbufs < 2) w->nbufs = 2;
+    if (w->nbufs > AUDYN_FW_MAX_BUFFERS) w->nbufs = AUDYN_FW_MAX_BUFFERS;
+
+    const uint32_t sync_ms = w->cfg.sync_interval_ms ? w->cfg.sync_interval_ms : FW_DEFAULT_SYNC_MS;
+    w->sync_interval_ns = (uint64_t)sync_ms * 1000000ULL;
+    w->last_sync_ns = mono_ns();
+
+    /* Resolve backend */
+    w->backend = w->cfg.backend;
+    if (w->backend == AUDYN_FW_AUTO || w->backend == AUDYN_FW_URING) {
+        if (uring_setup(&w->ring, w->nbufs * 2 + 4) == 0) {
+            w->backend = AUDYN_FW_URING;
+        } else {
+            if (w->cfg.backend == AUDYN_FW_URING) {
+                LOG_WARN("file_writer: io_uring unavailable, using writer thread");
+            }
+            w->backend = AUDYN_FW_THREAD;
+        }
+    }
+
+    if (w->backend == AUDYN_FW_STDIO) {
+        w->fp = fopen(path, "wb");
+        if (!w->fp) {
+            LOG_ERROR("file_writer: Failed to open '%s': %s", path, strerror(errno));
+            free_writer(w);
+            return NULL;
+        }
+        w->fd = fileno(w->fp);
+        return w;
+    }
+
+    if (open_fd(w, path) != 0) {
+        LOG_ERROR("file_writer: Failed to open '%s': %s", path, strerror(errno));
+        uring_teardown(&w->ring);
+        free_writer(w);
+        return NULL;
+    }
+
+    for (uint32_t i = 0; i < w->nbufs; i++) {
+        void *p = NULL;
+        if (posix_memalign(&p, AUDYN_FW_ALIGN, w->buf_bytes) != 0) {
+            LOG_ERROR("file_writer: Failed to allocate %zu byte buffer", w->buf_bytes);
+            close(w->fd);
+            uring_teardown(&w->ring);
+            free_writer(w);
+            return NULL;
+        }
+        w->bufs[i].data = (uint8_t *)p;
+    }
+    w->cur = 0;
+    w->bufs[0].state = FW_BUF_FILL;
+
+    if (w->backend == AUDYN_FW_THREAD) {
+        pthread_once(&g_pool.once, pool_start);
+        if (g_pool.nthreads == 0) {
+            LOG_ERROR("file_writer: Failed to start writer threads");
+            close(w->fd);
+            free_writer(w);
+            return NULL;
+        }
+        pthread_mutex_init(&w->lock, NULL);
+        pthread_cond_init(&w->cond, NULL);
+        w->lock_init = 1;
+    }
+
+    return w;
+}
+
+int audyn_file_writer_write(audyn_file_writer_t *w, const void *data, size_t len)
+{
+    if (!w || (!data && len > 0)) return -1;
+    if (w->failed) return -1;
+    if (len == 0) return 0;
+
+    if (w->backend == AUDYN_FW_STDIO) {
+        if (fwrite(data, 1, len, w->fp) != len) {
+            LOG_ERROR("file_writer: Write failed for '%s': %s", w->path, strerror(errno));
+            w->stats.errors++;
+            w->failed = 1;
+            return -1;
+        }
+        w->stats.writes++;
+    } else {
+        const uint8_t *p = (const uint8_t *)data;
+        size_t left = len;
+
+        while (left > 0) {
+            fw_buf_t *b = &w->bufs[w->cur];
+            size_t n = w->buf_bytes - b->len;
+            if (n > left) n = left;
+            memcpy(b->data + b->len, p, n);
+            b->len += n;
+            p += n;
+            left -= n;
+            if (b->len == w->buf_bytes) {
+                submit_current(w, 0);
+            }
+        }
+
+        if (w->backend == AUDYN_FW_URING && w->ring.ops > 0) {
+            (void)uring_reap(w, 0);
+        }
+    }
+
+    w->pos += len;
+    stat_add(w, &w->stats.bytes, len);
+    if (w->backend == AUDYN_FW_STDIO) w->unsynced += len;
+
+    maybe_sync(w);
+
+    return w->failed ? -1 : 0;
+}
+
+int audyn_file_writer_pwrite(audyn_file_writer_t *w, uint64_t offset,
+                             const void *data, size_t len)
+{
+    if (!w || !data) return -1;
+    if (offset + len > w->pos) {
+        LOG_ERROR("file_writer: pwrite beyond end of '%s'", w->path);
+        return -1;
+    }
+
+    drain(w);
+
+    if (w->direct) {
+        int fl = fcntl(w->fd, F_GETFL);
+        if (fl < 0 || fcntl(w->fd, F_SETFL, fl & ~O_DIRECT) != 0) {
+            LOG_ERROR("file_writer: Failed to clear O_DIRECT on '%s': %s", w->path, strerror(errno));
+            w->failed = 1;
+            return -1;
+        }
+        w->direct = 0;
+    }
+
+    if (pwrite_full(w->fd, (const uint8_t *)data, len, offset) != 0) {
+        LOG_ERROR("file_writer: pwrite failed for '%s': %s", w->path, strerror(errno));
+        stat_add(w, &w->stats.errors, 1);
+        w->failed = 1;
+        return -1;
+    }
+
+    return w->failed ? -1 : 0;
+}
+
+int audyn_file_writer_sync(audyn_file_writer_t *w)
+{
+    if (!w) return -1;
+
+    if (w->backend == AUDYN_FW_STDIO) {
+        if (fflush(w->fp) != 0 || timed_fdatasync(w->fd) != 0) {
+            LOG_ERROR("file_writer: sync failed for '%s': %s", w->path, strerror(errno));
+            w->stats.errors++;
+            w->failed = 1;
+        } else {
+            w->stats.syncs++;
+        }
+    } else {
+        submit_current(w, 0);
+        backend_request_sync(w);
+    }
+
+    w->last_sync_ns = mono_ns();
+    w->unsynced = 0;
+    return w->failed ? -1 : 0;
+}
+
+int audyn_file_writer_close(audyn_file_writer_t *w)
+{
+    if (!w) return -1;
+
+    drain(w);
+
+    if (w->cfg.durable) {
+        if (timed_fdatasync(w->fd) != 0) {
+            LOG_ERROR("file_writer: fdatasync failed for '%s': %s", w->path, strerror(errno));
+            stat_add(w, &w->stats.errors, 1);
+            w->failed = 1;
+        } else {
+            stat_add(w, &w->stats.syncs, 1);
+        }
+    }
+
+    /* drain() waited until no pool thread holds the writer */
+    if (w->lock_init) {
+        pthread_cond_destroy(&w->cond);
+        pthread_mutex_destroy(&w->lock);
+    }
+
+    if (w->backend == AUDYN_FW_URING) {
+        uring_teardown(&w->ring);
+    }
+
+    int rc = w->failed ? -1 : 0;
+
+    if (w->fp) {
+        if (fclose(w->fp) != 0) rc = -1;
+    } else if (w->fd >= 0) {
+        if (close(w->fd) != 0) rc = -1;
+    }
+
+    LOG_DEBUG("file_writer: Closed '%s' (%s) - bytes=%llu writes=%llu syncs=%llu stalls=%llu",
+              w->path, audyn_file_writer_backend_name(w),
+              (unsigned long long)w->stats.bytes,
+              (unsigned long long)w->stats.writes,
+              (unsigned long long)w->stats.syncs,
+              (unsigned long long)w->stats.stalls);
+
+    free_writer(w);
+    return rc;
+}
+
+uint64_t audyn_file_writer_size(const audyn_file_writer_t *w)
+{
+    return w ? w->pos : 0;
+}
+
+const char *audyn_file_writer_backend_name(const audyn_file_writer_t *w)
+{
+    if (!w) return "none";
+    switch (w->backend) {
+    case AUDYN_FW_URING:  return w->direct ? "io_uring+direct" : "io_uring";
+    case AUDYN_FW_THREAD: return w->direct ? "thread+direct" : "thread";
+    case AUDYN_FW_STDIO:  return "stdio";
+    default:              return "auto";
+    }
+}
+
+void audyn_file_writer_get_stats(const audyn_file_writer_t *w,
+                                 audyn_file_writer_stats_t *stats)
+{
+    if (!w || !stats) return;
+
+    if (w->backend == AUDYN_FW_THREAD) {
+        audyn_file_writer_t *mw = (audyn_file_writer_t *)w;
+        pthread_mutex_lock(&mw->lock);
+        *stats = w->stats;
+        pthread_mutex_unlock(&mw->lock);
+    } else {
+        *stats = w->stats;
+    }
+}
+
+int audyn_file_writer_parse_backend(const char *name, audyn_fw_backend_t *out)
+{
+    if (!name || !out) return -1;
+
+    if (!strcmp(name, "auto")) {
+        *out = AUDYN_FW_AUTO;
+    } else if (!strcmp(name, "uring") || !strcmp(name, "io_uring")) {
+        *out = AUDYN_FW_URING;
+    } else if (!strcmp(name, "thread")) {
+        *out = AUDYN_FW_THREAD;
+    } else if (!strcmp(name, "stdio")) {
+        *out = AUDYN_FW_STDIO;
+    } else {
+        return -1;
+    }
+    return 0;
+}
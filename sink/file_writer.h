@@ -0,0 +1,178 @@
+/*
+ *  Audyn — Professional Audio Capture & Archival Engine
+ *
+ *  File:
+ *      file_writer.h
+ *
+ *  Purpose:
+ *      Pluggable append-only file writer shared by the WAV and Opus sinks.
+ *
+ *      The sinks format their data and hand bytes to the writer; the writer
+ *      decides how those bytes reach the disk. Asynchronous backends copy
+ *      into large aligned buffers and submit whole buffers in the
+ *      background, so the calling (worker) thread does not wait on the
+ *      disk during normal operation.
+ *
+ *  Backends:
+ *      - io_uring: buffers are submitted as IORING_OP_WRITE from the
+ *        calling thread and reaped opportunistically; no extra thread.
+ *        Uses the raw syscalls (no liburing dependency).
+ *      - thread:   pwrite()/fdatasync() on a small pool of I/O threads
+ *        shared by every open writer (no thread per file)
+ *      - stdio:    buffered fwrite() in the calling thread (fallback)
+ *      AUTO picks io_uring when the kernel allows it, else the thread.
+ *
+ *  Durability:
+ *      The partially filled buffer is submitted once per sync_interval_ms,
+ *      bounding how much audio sits only in the writer's memory. Instead
+ *      of fsync() per write, a durable writer also issues fdatasync() once
+ *      per time budget or byte budget (sync_bytes), whichever comes first,
+ *      and once on close. Without O_DIRECT each completed
+ *      buffer also starts page-cache writeback (sync_file_range), which
+ *      keeps dirty memory and close-time flushes small.
+ *
+ *  O_DIRECT:
+ *      Optional for the async backends. Buffer addresses, lengths and file
+ *      offsets are kept AUDYN_FW_ALIGN aligned; the final partial block is
+ *      zero-padded and the file truncated to its true length on close.
+ *      Falls back to buffered I/O if the filesystem refuses O_DIRECT.
+ *
+ *  Sparse:
+ *      Optional for the async backends. All-zero pages at the start or end
+ *      of a submission are not written, so long runs of digital silence
+ *      become filesystem holes (no I/O, no disk blocks) that read back as
+ *      zeros; the file is truncated to its true length on close. The file
+ *      size may lag the appended length while a trailing hole is open.
+ *
+ *  Blocking:
+ *      The caller only waits when every buffer is still in flight (the
+ *      disk is slower than the stream for buffers * buffer_bytes), on
+ *      pwrite() (header patch: drains first) and on close(). Waits for a
+ *      free buffer are counted in stats.stalls.
+ *
+ *  Threading:
+ *      - NOT thread-safe. One caller thread per writer.
+ *
+ *  Dependencies:
+ *      - Linux: io_uring (5.6+ for IORING_OP_WRITE), sync_file_range,
+ *        pthread
+ *
+ *  Copyright:
+ *      (c) 2026 B. Wynne
+ *
+ *  Author:
+ *      B. Wynne
+ *
+ *  License:
+ *      GPLv2 or later
+ */
+
+#ifndef AUDYN_FILE_WRITER_H
+#define AUDYN_FILE_WRITER_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* O_DIRECT alignment for buffers, lengths and offsets */
+#define AUDYN_FW_ALIGN              4096u
+
+/* Defaults used when cfg fields are zero */
+#define AUDYN_FW_DEFAULT_BUFFER     (1024u * 1024u)
+#define AUDYN_FW_DEFAULT_BUFFERS    4u
+#define AUDYN_FW_MAX_BUFFERS        32u
+
+typedef enum audyn_fw_backend {
+    AUDYN_FW_AUTO = 0,              /* io_uring if available, else thread */
+    AUDYN_FW_STDIO,                 /* fwrite() in the caller's thread */
+    AUDYN_FW_THREAD,                /* Shared background I/O threads */
+    AUDYN_FW_URING                  /* io_uring submission/completion */
+} audyn_fw_backend_t;
+
+typedef struct audyn_file_writer_cfg {
+    audyn_fw_backend_t backend;
+    uint32_t buffer_bytes;          /* Per buffer (0 = 1 MiB, rounded up to ALIGN) */
+    uint32_t buffers;               /* Buffers in rotation (0 = 4, min 2) */
+    int      direct;                /* 1 = O_DIRECT (async backends only) */
+    int      sparse;                /* 1 = leave all-zero pages as holes (async backends only) */
+
+    /* Durability */
+    int      durable;               /* 1 = fdatasync on budget and on close */
+    uint32_t sync_interval_ms;      /* Partial-buffer flush / sync time budget (0 = 1000) */
+    uint64_t sync_bytes;            /* Durable byte budget (0 = time budget only) */
+} audyn_file_writer_cfg_t;
+
+typedef struct audyn_file_writer_stats {
+    uint64_t bytes;                 /* Bytes appended by the caller */
+    uint64_t writes;                /* Write submissions (buffers / fwrite calls) */
+    uint64_t syncs;                 /* Completed fdatasync() calls */
+    uint64_t stalls;                /* Caller waited for a free buffer */
+    uint64_t errors;                /* Failed writes or syncs */
+    uint64_t hole_bytes;            /* Appended bytes left as holes (sparse) */
+} audyn_file_writer_stats_t;
+
+typedef struct audyn_file_writer audyn_file_writer_t;
+
+/*
+ * Create (truncate) path and start the chosen backend.
+ *
+ * Parameters:
+ *   path - output file path
+ *   cfg  - writer configuration (NULL = AUTO, no syncing)
+ *
+ * Returns writer on success, NULL on error (logged).
+ */
+audyn_file_writer_t *audyn_file_writer_open(const char *path,
+                                            const audyn_file_writer_cfg_t *cfg);
+
+/*
+ * Append len bytes at the current end of file.
+ *
+ * Returns 0 on success, -1 on error. Errors from earlier background
+ * writes are reported here (and by close()).
+ */
+int audyn_file_writer_write(audyn_file_writer_t *w, const void *data, size_t len);
+
+/*
+ * Overwrite bytes at an absolute offset inside the already written region
+ * (header patching). Drains all pending data first, so this blocks; intended
+ * for use just before close(). Appends after a pwrite() are not O_DIRECT.
+ */
+int audyn_file_writer_pwrite(audyn_file_writer_t *w, uint64_t offset,
+                             const void *data, size_t len);
+
+/*
+ * Submit buffered data and request a durability point. Asynchronous for the
+ * io_uring and thread backends; fflush() + fdatasync() for stdio.
+ */
+int audyn_file_writer_sync(audyn_file_writer_t *w);
+
+/*
+ * Drain, fdatasync if durable, close and free the writer.
+ * Returns 0 if every write and sync succeeded, -1 otherwise.
+ */
+int audyn_file_writer_close(audyn_file_writer_t *w);
+
+/* Logical file size (bytes appended) */
+uint64_t audyn_file_writer_size(const audyn_file_writer_t *w);
+
+/* Backend actually in use ("io_uring", "thread" or "stdio") */
+const char *audyn_file_writer_backend_name(const audyn_file_writer_t *w);
+
+void audyn_file_writer_get_stats(const audyn_file_writer_t *w,
+                                 audyn_file_writer_stats_t *stats);
+
+/*
+ * Parse a backend name ("auto", "uring", "io_uring", "thread", "stdio").
+ * Returns 0 on success, -1 if unknown.
+ */
+int audyn_file_writer_parse_backend(const char *name, audyn_fw_backend_t *out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* AUDYN_FILE_WRITER_H */
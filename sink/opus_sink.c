@@ -27,8 +27,45 @@
  *      at -preskip and add frame_samples_48k for each encoded frame. The first audio packet
  *      thus typically has granulepos = 960 - 312 = 648 (for 20 ms frames).
  *
+ *  Input FIFO:
+ *      A fixed ring of OPUS_FIFO_PERIODS encoder frames, allocated at
+ *      create time. Input is copied in as far as it fits and every complete
+ *      frame is encoded before more is copied, so any block size is
+ *      accepted without growing the ring. Frames are encoded in place from
+ *      the ring, from a scratch frame when one straddles the wrap, or
+ *      straight from the caller's block while the ring is empty.
+ *
+ *  DTX:
+ *      With cfg.dtx, a frame of digital silence after the encoder has
+ *      answered one with a DTX packet (<= 2 bytes, TOC only) is given a
+ *      copy of that packet and skips opus_encode_float(). The first frame
+ *      with a non-zero sample goes back through the encoder.
+ *
+ *  File I/O:
+ *      Ogg pages are appended through file_writer (io_uring / writer thread /
+ *      stdio), so page writes and durability syncs do not stall the caller.
+ *
+ *  Seek index:
+ *      Each audio page is noted with the granule of the page before it (the
+ *      first sample it decodes to) and its file offset, from whichever
+ *      thread writes pages.
+ *
+ *  Encoder stage:
+ *      With cfg.encoder_pool, write() copies the block into a per-sink lane
+ *      and returns; encode_append() (FIFO, opus_encode_float, Ogg muxing,
+ *      page writes) then runs on an encoder pool thread. The lane
+ *      serialises the callbacks, and flush()/close() drain it before
+ *      touching the encoder or Ogg state from the caller's thread. Stats
+ *      are shared between the two sides under stats_mu.
+ *
+ *      A block that finds the lane full is replaced by the same number of
+ *      frames of silence, queued ahead of the next block that fits (or
+ *      encoded by flush()/close()), so the granule position never falls
+ *      behind the audio clock.
+ *
  *  Dependencies:
- *      - Standard C/POSIX: stdio, stdlib, string, time, unistd
+ *      - Standard C/POSIX: stdio, stdlib, string, time, unistd, pthread
+ *      - Audyn: file_writer, encoder_pool, seek_index, metrics, log
  *      - libopus: <opus/opus.h>
  *      - libogg:  <ogg/ogg.h>
  *
@@ -43,8 +80,14 @@
  */
 
 #include "opus_sink.h"
+#include "file_writer.h"
+#include "encoder_pool.h"
+#include "seek_index.h"
+#include "metrics.h"
 #include "log.h"
 
+#include <pthread.h>
+#include <stdatomic.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -59,13 +102,18 @@
 #define AUDYN_OPUS_BITRATE_MIN 6000
 #define AUDYN_OPUS_BITRATE_MAX 510000
 
-/* Maximum FIFO size in frames to prevent runaway memory usage */
+/* Maximum buffered audio in frames (encoder lane capacity bound) */
 #define FIFO_MAX_FRAMES (48000 * 10)  /* 10 seconds at 48kHz */
 
+/* Input ring capacity in Opus frames (>= 2 so a copy always makes progress) */
+#define OPUS_FIFO_PERIODS 4u
+
+/* Default encoder lane capacity (pool mode) */
+#define OPUS_DEFAULT_QUEUE_MS 2000u
+
 struct audyn_opus_sink
 {
-    FILE *fp;
-    int fd;
+    audyn_file_writer_t *fw;    /* NULL when closed */
 
     audyn_opus_cfg_t cfg;
     char *path;                 /* Output file path (for error messages) */
@@ -79,12 +127,18 @@ struct audyn_opus_sink
     unsigned char *pkt;
     int pkt_cap;
 
-    /* Input accumulator (interleaved float32) */
+    /* Input ring (interleaved float32), fixed at create */
     float *fifo;
     uint32_t fifo_cap_frames;   /* capacity in frames (per channel) */
+    uint32_t fifo_rd_frames;    /* read position in frames */
     uint32_t fifo_len_frames;   /* current length in frames */
+    float *scratch;             /* one encoder frame, for spans across the wrap */
     uint32_t frame_size;        /* encoder frame size in frames (per channel), e.g. 960 @ 48k */
 
+    /* DTX packet for digital silence (cfg.dtx; dtx_len 0 = none yet) */
+    unsigned char dtx_pkt[2];
+    int dtx_len;
+
     /* Ogg packet numbering / granule position (always in 48kHz units for Ogg Opus) */
     ogg_int64_t granulepos_48k;
     ogg_int64_t packetno;
@@ -92,16 +146,41 @@ struct audyn_opus_sink
     /* OpusHead preskip (48k units) */
     uint16_t preskip_48k;
 
+    /* Seek index (NULL without cfg.seek_interval_ms) */
+    audyn_seek_index_t *seek;
+    ogg_int64_t last_page_granule;  /* Granule of the last audio page written */
+
     /* Tracking for clean EOS */
     int wrote_audio;
     int eos_written;
 
     int closed;
 
-    /* Statistics */
+    /* Runtime encoder settings (set_encoder): written by any thread,
+     * applied by the encoding thread before its next packet */
+    _Atomic uint32_t ctl_req;
+    uint32_t ctl_done;          /* Encoding thread only */
+    _Atomic uint32_t ctl_bitrate;
+    _Atomic int ctl_complexity;
+
+    /* Encoder stage (pool mode); NULL = encode in write() */
+    audyn_enc_lane_t *lane;
+    int dropping;               /* Producer: inside a run of dropped blocks */
+    uint64_t gap_frames;        /* Producer: dropped frames not yet queued as silence */
+    float *silence;             /* frame_size zero frames (pool mode) */
+
+    /* Statistics (stats_mu: updated by the encoding thread, read anywhere) */
+    pthread_mutex_t stats_mu;
     audyn_opus_stats_t stats;
 };
 
+static uint64_t mono_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
 static void le16(unsigned char *p, uint16_t v)
 {
     p[0] = (unsigned char)(v & 0xFF);
@@ -160,18 +239,23 @@ static ogg_uint32_t make_serial(void)
 
 static int write_page(struct audyn_opus_sink *s, const ogg_page *og)
 {
-    if (!s || !s->fp || !og) return -1;
+    if (!s || !s->fw || !og) return -1;
+
+    /* Header pages carry granule 0 and precede the index; audio pages
+     * without a completed packet carry -1 and are no seek point */
+    const ogg_int64_t granule = ogg_page_granulepos(og);
+    if (s->seek && granule != -1) {
+        (void)audyn_seek_index_note(s->seek, (uint64_t)s->last_page_granule,
+                                    audyn_file_writer_size(s->fw));
+        s->last_page_granule = granule;
+    }
 
-    if (fwrite(og->header, 1, (size_t)og->header_len, s->fp) != (size_t)og->header_len)
+    /* Durable writers fdatasync on the writer's time/byte budget */
+    if (audyn_file_writer_write(s->fw, og->header, (size_t)og->header_len) != 0)
         return -1;
-    if (fwrite(og->body, 1, (size_t)og->body_len, s->fp) != (size_t)og->body_len)
+    if (audyn_file_writer_write(s->fw, og->body, (size_t)og->body_len) != 0)
         return -1;
 
-    if (s->cfg.enable_fsync) {
-        (void)fflush(s->fp);
-        if (s->fd >= 0) (void)fsync(s->fd);
-    }
-
     return 0;
 }
 
@@ -280,38 +364,60 @@ static int write_opus_headers(struct audyn_opus_sink *s)
     return 0;
 }
 
-static int ensure_fifo_capacity(struct audyn_opus_sink *s, uint32_t want_frames)
+/* Copy up to 'frames' frames into the ring; returns frames copied */
+static uint32_t fifo_push(struct audyn_opus_sink *s, const float *src, uint32_t frames)
 {
-    if (want_frames <= s->fifo_cap_frames)
-        return 0;
+    const size_t ch = (size_t)s->cfg.channels;
+    const uint32_t room = s->fifo_cap_frames - s->fifo_len_frames;
+    if (frames > room) frames = room;
+
+    uint32_t wr = s->fifo_rd_frames + s->fifo_len_frames;
+    if (wr >= s->fifo_cap_frames) wr -= s->fifo_cap_frames;
 
-    uint32_t new_cap = s->fifo_cap_frames ? s->fifo_cap_frames : (s->frame_size * 2);
-    while (new_cap < want_frames) {
-        if (new_cap < (1u << 20)) new_cap *= 2;
-        else { new_cap = want_frames; break; }
+    uint32_t first = s->fifo_cap_frames - wr;
+    if (first > frames) first = frames;
+
+    memcpy(s->fifo + (size_t)wr * ch, src, (size_t)first * ch * sizeof(float));
+    if (frames > first) {
+        memcpy(s->fifo, src + (size_t)first * ch,
+               (size_t)(frames - first) * ch * sizeof(float));
     }
+    s->fifo_len_frames += frames;
+    return frames;
+}
 
-    const size_t samples = (size_t)new_cap * (size_t)s->cfg.channels;
-    float *nf = (float *)realloc(s->fifo, samples * sizeof(float));
-    if (!nf) return -1;
+/*
+ * Oldest 'frames' frames as one contiguous span: in place when they do not
+ * wrap, else stitched into scratch. Pads with silence past fifo_len_frames.
+ */
+static const float *fifo_span(struct audyn_opus_sink *s, uint32_t frames)
+{
+    const size_t ch = (size_t)s->cfg.channels;
+    const uint32_t avail = s->fifo_len_frames < frames ? s->fifo_len_frames : frames;
 
-    s->fifo = nf;
-    s->fifo_cap_frames = new_cap;
-    return 0;
+    if (avail == frames && s->fifo_rd_frames + frames <= s->fifo_cap_frames)
+        return s->fifo + (size_t)s->fifo_rd_frames * ch;
+
+    uint32_t first = s->fifo_cap_frames - s->fifo_rd_frames;
+    if (first > avail) first = avail;
+
+    memcpy(s->scratch, s->fifo + (size_t)s->fifo_rd_frames * ch,
+           (size_t)first * ch * sizeof(float));
+    memcpy(s->scratch + (size_t)first * ch, s->fifo,
+           (size_t)(avail - first) * ch * sizeof(float));
+    memset(s->scratch + (size_t)avail * ch, 0,
+           (size_t)(frames - avail) * ch * sizeof(float));
+    return s->scratch;
 }
 
 static void fifo_consume_frames(struct audyn_opus_sink *s, uint32_t frames)
 {
-    if (frames == 0 || frames > s->fifo_len_frames) return;
+    if (frames > s->fifo_len_frames) frames = s->fifo_len_frames;
 
-    const size_t ch = (size_t)s->cfg.channels;
-    const size_t remain_frames = (size_t)(s->fifo_len_frames - frames);
-    if (remain_frames > 0) {
-        memmove(s->fifo,
-                s->fifo + (size_t)frames * ch,
-                remain_frames * ch * sizeof(float));
-    }
+    s->fifo_rd_frames += frames;
+    if (s->fifo_rd_frames >= s->fifo_cap_frames) s->fifo_rd_frames -= s->fifo_cap_frames;
     s->fifo_len_frames -= frames;
+    if (s->fifo_len_frames == 0) s->fifo_rd_frames = 0;
 }
 
 static ogg_int64_t frames_to_48k(uint32_t frames, uint32_t sample_rate)
@@ -320,6 +426,8 @@ static ogg_int64_t frames_to_48k(uint32_t frames, uint32_t sample_rate)
     return (ogg_int64_t)((uint64_t)frames * 48000ull / (uint64_t)sample_rate);
 }
 
+static int lane_encode(void *user, const float *pcm, uint32_t frames);
+
 audyn_opus_sink_t *
 audyn_opus_sink_create(const char *path, const audyn_opus_cfg_t *cfg)
 {
@@ -346,7 +454,7 @@ audyn_opus_sink_create(const char *path, const audyn_opus_cfg_t *cfg)
     }
 
     s->cfg = *cfg;
-    s->fd = -1;
+    pthread_mutex_init(&s->stats_mu, NULL);
 
     /* Store path for error messages */
     s->path = strdup(path);
@@ -385,25 +493,21 @@ audyn_opus_sink_create(const char *path, const audyn_opus_cfg_t *cfg)
     }
 
     /* Open file */
-    s->fp = fopen(path, "wb");
-    if (!s->fp) {
+    audyn_file_writer_cfg_t wcfg = s->cfg.writer;
+    if (s->cfg.enable_fsync) wcfg.durable = 1;
+
+    s->fw = audyn_file_writer_open(path, &wcfg);
+    if (!s->fw) {
         LOG_ERROR("OPUS: Failed to open file '%s' for writing", path);
         free(s->path);
         free(s);
         return NULL;
     }
 
-    /* Get file descriptor for fsync, validate it */
-    s->fd = fileno(s->fp);
-    if (s->fd < 0) {
-        LOG_DEBUG("OPUS: fileno() returned -1, fsync will be disabled");
-        s->cfg.enable_fsync = 0;
-    }
-
     /* Init ogg stream */
     if (ogg_stream_init(&s->os, (int)make_serial()) != 0) {
         LOG_ERROR("OPUS: Failed to initialize Ogg stream for '%s'", path);
-        fclose(s->fp);
+        (void)audyn_file_writer_close(s->fw);
         free(s->path);
         free(s);
         return NULL;
@@ -421,7 +525,7 @@ audyn_opus_sink_create(const char *path, const audyn_opus_cfg_t *cfg)
     if (!s->enc || err != OPUS_OK) {
         LOG_ERROR("OPUS: Failed to create encoder: %s", opus_strerror(err));
         ogg_stream_clear(&s->os);
-        fclose(s->fp);
+        (void)audyn_file_writer_close(s->fw);
         free(s->path);
         free(s);
         return NULL;
@@ -431,6 +535,7 @@ audyn_opus_sink_create(const char *path, const audyn_opus_cfg_t *cfg)
     (void)opus_encoder_ctl(s->enc, OPUS_SET_BITRATE((opus_int32)s->cfg.bitrate));
     (void)opus_encoder_ctl(s->enc, OPUS_SET_VBR(s->cfg.vbr ? 1 : 0));
     (void)opus_encoder_ctl(s->enc, OPUS_SET_COMPLEXITY(s->cfg.complexity));
+    if (s->cfg.dtx) (void)opus_encoder_ctl(s->enc, OPUS_SET_DTX(1));
 
     /* Packet buffer: maximum payload is small, but allow headroom */
     s->pkt_cap = 4096;
@@ -439,22 +544,26 @@ audyn_opus_sink_create(const char *path, const audyn_opus_cfg_t *cfg)
         LOG_ERROR("OPUS: Failed to allocate packet buffer");
         opus_encoder_destroy(s->enc);
         ogg_stream_clear(&s->os);
-        fclose(s->fp);
+        (void)audyn_file_writer_close(s->fw);
         free(s->path);
         free(s);
         return NULL;
     }
 
-    /* FIFO buffer: start at 2x frame_size */
-    s->fifo = NULL;
-    s->fifo_cap_frames = 0;
+    /* Input ring and wrap scratch: fixed size, no allocation while encoding */
+    s->fifo_cap_frames = s->frame_size * OPUS_FIFO_PERIODS;
+    s->fifo_rd_frames = 0;
     s->fifo_len_frames = 0;
-    if (ensure_fifo_capacity(s, s->frame_size * 2) != 0) {
+    s->fifo = (float *)malloc((size_t)s->fifo_cap_frames * s->cfg.channels * sizeof(float));
+    s->scratch = (float *)malloc((size_t)s->frame_size * s->cfg.channels * sizeof(float));
+    if (!s->fifo || !s->scratch) {
         LOG_ERROR("OPUS: Failed to allocate FIFO buffer");
+        free(s->fifo);
+        free(s->scratch);
         free(s->pkt);
         opus_encoder_destroy(s->enc);
         ogg_stream_clear(&s->os);
-        fclose(s->fp);
+        (void)audyn_file_writer_close(s->fw);
         free(s->path);
         free(s);
         return NULL;
@@ -470,101 +579,255 @@ audyn_opus_sink_create(const char *path, const audyn_opus_cfg_t *cfg)
     /* Initialize statistics */
     memset(&s->stats, 0, sizeof(s->stats));
 
-    LOG_INFO("OPUS: Created sink '%s' - %uHz %uch %ubps %s complexity=%d",
+    /* Optional: without an index players fall back to scanning */
+    if (s->cfg.seek_interval_ms > 0) {
+        audyn_seek_index_cfg_t icfg;
+        memset(&icfg, 0, sizeof(icfg));
+        icfg.kind = AUDYN_SEEK_OPUS;
+        icfg.sample_rate = 48000;
+        icfg.channels = s->cfg.channels;
+        icfg.interval = 48u * s->cfg.seek_interval_ms;
+        icfg.audio_offset = audyn_file_writer_size(s->fw);
+        icfg.preskip = s->preskip_48k;
+        icfg.writer = s->cfg.writer;
+        s->seek = audyn_seek_index_open(path, &icfg);
+        if (!s->seek) {
+            LOG_WARN("OPUS: No seek index for '%s'", path);
+        }
+    }
+
+    /* Encoder stage: hand encoding to the shared pool */
+    if (s->cfg.encoder_pool) {
+        const uint32_t queue_ms = s->cfg.queue_ms ? s->cfg.queue_ms : OPUS_DEFAULT_QUEUE_MS;
+        uint64_t cap = (uint64_t)sr * queue_ms / 1000u;
+        if (cap < s->frame_size) cap = s->frame_size;
+        if (cap > FIFO_MAX_FRAMES) cap = FIFO_MAX_FRAMES;
+
+        s->lane = audyn_enc_lane_create(s->cfg.encoder_pool, s->cfg.channels,
+                                        (uint32_t)cap, lane_encode, s);
+        s->silence = (float *)calloc((size_t)s->frame_size * s->cfg.channels, sizeof(float));
+        if (!s->lane || !s->silence) {
+            LOG_ERROR("OPUS: Failed to create encoder lane for '%s'", path);
+            audyn_opus_sink_destroy(s);
+            return NULL;
+        }
+    }
+
+    LOG_INFO("OPUS: Created sink '%s' - %uHz %uch %ubps %s complexity=%d (%s, %s)",
              path, sr, s->cfg.channels, s->cfg.bitrate,
-             s->cfg.vbr ? "VBR" : "CBR", s->cfg.complexity);
+             s->cfg.vbr ? "VBR" : "CBR", s->cfg.complexity,
+             audyn_file_writer_backend_name(s->fw),
+             s->lane ? "encoder pool" : "inline encode");
 
     return s;
 }
 
-int
-audyn_opus_sink_write(audyn_opus_sink_t *s,
-                      const float *interleaved_f32,
-                      uint32_t frames)
+static int frame_is_silent(const float *pcm, size_t samples)
 {
-    if (!s || s->closed) {
-        LOG_ERROR("OPUS: Write called on NULL or closed sink");
-        return -1;
+    for (size_t i = 0; i < samples; i++) {
+        if (pcm[i] != 0.0f) return 0;
     }
-    if (!interleaved_f32 || frames == 0) return 0;
+    return 1;
+}
 
-    /* Check for integer overflow */
-    if (frames > UINT32_MAX - s->fifo_len_frames) {
-        LOG_ERROR("OPUS: FIFO length overflow (current=%u, adding=%u)",
-                  s->fifo_len_frames, frames);
-        return -1;
+/*
+ * Encode one frame_size span into an Ogg packet and write out full pages.
+ * The last packet (eos) forces the remaining pages out.
+ */
+static int encode_frame(struct audyn_opus_sink *s, const float *pcm, int eos)
+{
+    const uint64_t t0 = mono_ns();
+
+    /* Packet boundary: pick up settings changed since the last packet */
+    const uint32_t req = atomic_load_explicit(&s->ctl_req, memory_order_acquire);
+    if (req != s->ctl_done) {
+        s->ctl_done = req;
+        s->cfg.bitrate = atomic_load_explicit(&s->ctl_bitrate, memory_order_relaxed);
+        s->cfg.complexity = atomic_load_explicit(&s->ctl_complexity, memory_order_relaxed);
+        (void)opus_encoder_ctl(s->enc, OPUS_SET_BITRATE((opus_int32)s->cfg.bitrate));
+        (void)opus_encoder_ctl(s->enc, OPUS_SET_COMPLEXITY(s->cfg.complexity));
+        s->dtx_len = 0;
+        LOG_INFO("OPUS: %s now %ubps complexity %d", s->path, s->cfg.bitrate, s->cfg.complexity);
+    }
+
+    const int silent = s->cfg.dtx &&
+                       frame_is_silent(pcm, (size_t)s->frame_size * s->cfg.channels);
+    const int repeat = silent && s->dtx_len > 0;
+
+    int nb;
+    if (repeat) {
+        memcpy(s->pkt, s->dtx_pkt, (size_t)s->dtx_len);
+        nb = s->dtx_len;
+    } else {
+        nb = opus_encode_float(s->enc,
+                               pcm,
+                               (int)s->frame_size,
+                               s->pkt,
+                               s->pkt_cap);
+        if (nb < 0) {
+            LOG_ERROR("OPUS: Encode failed: %s", opus_strerror(nb));
+            return -1;
+        }
+
+        s->dtx_len = 0;
+        if (silent && nb <= (int)sizeof(s->dtx_pkt)) {
+            memcpy(s->dtx_pkt, s->pkt, (size_t)nb);
+            s->dtx_len = nb;
+        }
     }
 
-    const uint32_t new_len = s->fifo_len_frames + frames;
+    ogg_packet op;
+    memset(&op, 0, sizeof(op));
+    op.packet = s->pkt;
+    op.bytes = nb;
+    op.b_o_s = 0;
+    op.e_o_s = eos ? 1 : 0;
+
+    s->granulepos_48k += frames_to_48k(s->frame_size, s->cfg.sample_rate);
+    if (s->granulepos_48k < 0) s->granulepos_48k = 0; /* should only happen for first packet */
+    op.granulepos = s->granulepos_48k;
+    op.packetno = s->packetno++;
 
-    /* Enforce maximum FIFO size to prevent runaway memory usage */
-    if (new_len > FIFO_MAX_FRAMES) {
-        LOG_ERROR("OPUS: FIFO size limit exceeded (requested=%u, max=%d)",
-                  new_len, FIFO_MAX_FRAMES);
-        s->stats.fifo_overflows++;
+    if (ogg_stream_packetin(&s->os, &op) != 0) {
+        LOG_ERROR("OPUS: Failed to submit packet to Ogg stream");
         return -1;
     }
 
-    if (ensure_fifo_capacity(s, new_len) != 0) {
-        LOG_ERROR("OPUS: Failed to expand FIFO to %u frames", new_len);
+    s->wrote_audio = 1;
+    if (eos) s->eos_written = 1;
+
+    if (flush_pages(s, eos) != 0) {
+        LOG_ERROR("OPUS: Failed to flush Ogg pages");
         return -1;
     }
 
+    /* Update statistics */
+    const uint64_t dt = mono_ns() - t0;
+    audyn_metrics_record(AUDYN_STAGE_ENCODE, dt);
+    uint64_t us = dt / 1000u;
+    if (us > UINT32_MAX) us = UINT32_MAX;
+
+    pthread_mutex_lock(&s->stats_mu);
+    s->stats.frames_encoded += s->frame_size;
+    s->stats.packets_encoded++;
+    if (repeat) s->stats.packets_repeated++;
+    s->stats.bytes_encoded += (uint64_t)nb;
+    s->stats.encode_us_last = (uint32_t)us;
+    if ((uint32_t)us > s->stats.encode_us_max) s->stats.encode_us_max = (uint32_t)us;
+    pthread_mutex_unlock(&s->stats_mu);
+
+    return 0;
+}
+
+/*
+ * Feed a block through the FIFO and encode every complete Opus frame. Runs
+ * in write() (inline mode) or on an encoder pool thread (lane callback).
+ */
+static int encode_append(struct audyn_opus_sink *s,
+                         const float *interleaved_f32,
+                         uint32_t frames)
+{
     const size_t ch = (size_t)s->cfg.channels;
-    memcpy(s->fifo + (size_t)s->fifo_len_frames * ch,
-           interleaved_f32,
-           (size_t)frames * ch * sizeof(float));
-    s->fifo_len_frames = new_len;
 
-    /* Track input frames */
-    s->stats.frames_in += frames;
+    while (frames > 0) {
+        /* Ring empty: encode whole frames straight from the caller's block */
+        while (s->fifo_len_frames == 0 && frames >= s->frame_size) {
+            if (encode_frame(s, interleaved_f32, 0) != 0) return -1;
+            interleaved_f32 += (size_t)s->frame_size * ch;
+            frames -= s->frame_size;
+        }
+        if (frames == 0) break;
 
-    /* Encode while we have a full Opus frame */
-    while (s->fifo_len_frames >= s->frame_size) {
-        const float *pcm = s->fifo; /* interleaved */
+        const uint32_t n = fifo_push(s, interleaved_f32, frames);
+        interleaved_f32 += (size_t)n * ch;
+        frames -= n;
 
-        const int nb = opus_encode_float(s->enc,
-                                        pcm,
-                                        (int)s->frame_size,
-                                        s->pkt,
-                                        s->pkt_cap);
-        if (nb < 0) {
-            LOG_ERROR("OPUS: Encode failed: %s", opus_strerror(nb));
-            return -1;
+        while (s->fifo_len_frames >= s->frame_size) {
+            if (encode_frame(s, fifo_span(s, s->frame_size), 0) != 0) return -1;
+            fifo_consume_frames(s, s->frame_size);
         }
+    }
 
-        ogg_packet op;
-        memset(&op, 0, sizeof(op));
-        op.packet = s->pkt;
-        op.bytes = nb;
-        op.b_o_s = 0;
-        op.e_o_s = 0;
+    return 0;
+}
 
-        s->granulepos_48k += frames_to_48k(s->frame_size, s->cfg.sample_rate);
-        if (s->granulepos_48k < 0) s->granulepos_48k = 0; /* should only happen for first packet */
-        op.granulepos = s->granulepos_48k;
-        op.packetno = s->packetno++;
+/* encoder_pool lane callback */
+static int lane_encode(void *user, const float *pcm, uint32_t frames)
+{
+    return encode_append((struct audyn_opus_sink *)user, pcm, frames);
+}
 
-        if (ogg_stream_packetin(&s->os, &op) != 0) {
-            LOG_ERROR("OPUS: Failed to submit packet to Ogg stream");
-            return -1;
-        }
+/* Queue dropped audio as silence, in order, as far as the lane has room */
+static int push_gap(struct audyn_opus_sink *s)
+{
+    while (s->gap_frames > 0) {
+        const uint32_t n = s->gap_frames < s->frame_size ? (uint32_t)s->gap_frames
+                                                         : s->frame_size;
+        const int rc = audyn_enc_lane_push(s->lane, s->silence, n);
+        if (rc != 0) return rc;
+        s->gap_frames -= n;
+    }
+    return 0;
+}
 
-        s->wrote_audio = 1;
+/* Encode the rest of the gap here (lane idle: the caller owns the state) */
+static int encode_gap(struct audyn_opus_sink *s)
+{
+    while (s->gap_frames > 0) {
+        const uint32_t n = s->gap_frames < s->frame_size ? (uint32_t)s->gap_frames
+                                                         : s->frame_size;
+        if (encode_append(s, s->silence, n) != 0) return -1;
+        s->gap_frames -= n;
+    }
+    return 0;
+}
 
-        /* Update statistics */
-        s->stats.frames_encoded += s->frame_size;
-        s->stats.packets_encoded++;
-        s->stats.bytes_encoded += (uint64_t)nb;
+int
+audyn_opus_sink_write(audyn_opus_sink_t *s,
+                      const float *interleaved_f32,
+                      uint32_t frames)
+{
+    if (!s || s->closed) {
+        LOG_ERROR("OPUS: Write called on NULL or closed sink");
+        return -1;
+    }
+    if (!interleaved_f32 || frames == 0) return 0;
 
-        if (flush_pages(s, 0) != 0) {
-            LOG_ERROR("OPUS: Failed to flush Ogg pages");
-            return -1;
-        }
+    /* Track input frames */
+    pthread_mutex_lock(&s->stats_mu);
+    s->stats.frames_in += frames;
+    pthread_mutex_unlock(&s->stats_mu);
 
-        fifo_consume_frames(s, s->frame_size);
+    if (!s->lane) {
+        return encode_append(s, interleaved_f32, frames);
     }
 
+    int rc = push_gap(s);
+    if (rc == 0) rc = audyn_enc_lane_push(s->lane, interleaved_f32, frames);
+    if (rc < 0) {
+        LOG_ERROR("OPUS: Encoder failed for '%s'", s->path ? s->path : "(unknown)");
+        return -1;
+    }
+    if (rc > 0) {
+        /* Encoder threads are behind: drop rather than stall the worker,
+         * but keep the timeline by queueing silence in its place */
+        if (!s->dropping) {
+            LOG_WARN("OPUS: Encoder backlog full for '%s', replacing audio with silence",
+                     s->path ? s->path : "(unknown)");
+            s->dropping = 1;
+        }
+        s->gap_frames += frames;
+        pthread_mutex_lock(&s->stats_mu);
+        s->stats.frames_dropped += frames;
+        pthread_mutex_unlock(&s->stats_mu);
+        audyn_metrics_count(AUDYN_CTR_ENCODE_DROPS, frames);
+        return 0;
+    }
+
+    if (s->dropping) {
+        LOG_INFO("OPUS: Encoder caught up for '%s'", s->path ? s->path : "(unknown)");
+        s->dropping = 0;
+    }
     return 0;
 }
 
@@ -572,7 +835,20 @@ int
 audyn_opus_sink_flush(audyn_opus_sink_t *s)
 {
     if (!s || s->closed) return -1;
-    return flush_pages(s, 1);
+
+    /* The Ogg state belongs to the encoder thread until the lane is idle */
+    if (s->lane && audyn_enc_lane_drain(s->lane) != 0) return -1;
+    if (encode_gap(s) != 0) return -1;
+
+    if (flush_pages(s, 1) != 0) return -1;
+    return s->cfg.enable_fsync ? audyn_file_writer_sync(s->fw) : 0;
+}
+
+int
+audyn_opus_sink_busy(const audyn_opus_sink_t *s)
+{
+    if (!s || s->closed || !s->lane) return 0;
+    return audyn_enc_lane_busy(s->lane);
 }
 
 static int write_eos_marker(struct audyn_opus_sink *s)
@@ -602,41 +878,8 @@ static int pad_and_encode_final(struct audyn_opus_sink *s)
     if (s->fifo_len_frames == 0)
         return 0;
 
-    /* Pad to a full frame with zeros */
-    const uint32_t need = s->frame_size - s->fifo_len_frames;
-    const uint32_t new_len = s->fifo_len_frames + need;
-    if (ensure_fifo_capacity(s, new_len) != 0) return -1;
-
-    const size_t ch = (size_t)s->cfg.channels;
-    memset(s->fifo + (size_t)s->fifo_len_frames * ch, 0, (size_t)need * ch * sizeof(float));
-    s->fifo_len_frames = new_len;
-
-    const int nb = opus_encode_float(s->enc,
-                                    s->fifo,
-                                    (int)s->frame_size,
-                                    s->pkt,
-                                    s->pkt_cap);
-    if (nb < 0) return -1;
-
-    ogg_packet op;
-    memset(&op, 0, sizeof(op));
-    op.packet = s->pkt;
-    op.bytes = nb;
-    op.b_o_s = 0;
-    op.e_o_s = 1; /* end of stream */
-
-    s->granulepos_48k += frames_to_48k(s->frame_size, s->cfg.sample_rate);
-    if (s->granulepos_48k < 0) s->granulepos_48k = 0;
-    op.granulepos = s->granulepos_48k;
-    op.packetno = s->packetno++;
-
-    if (ogg_stream_packetin(&s->os, &op) != 0)
-        return -1;
-
-    s->wrote_audio = 1;
-    s->eos_written = 1;
-
-    if (flush_pages(s, 1) != 0)
+    /* Remaining partial frame, padded to a full frame with zeros */
+    if (encode_frame(s, fifo_span(s, s->frame_size), 1) != 0)
         return -1;
 
     fifo_consume_frames(s, s->frame_size);
@@ -649,6 +892,13 @@ audyn_opus_sink_close(audyn_opus_sink_t *s)
     if (!s) return -1;
     if (s->closed) return 0;
 
+    /* Let the encoder thread finish queued audio, then own the state here */
+    if (s->lane) {
+        audyn_enc_lane_destroy(s->lane);
+        s->lane = NULL;
+    }
+    (void)encode_gap(s);
+
     /* Best-effort: encode any remaining partial audio */
     (void)pad_and_encode_final(s);
 
@@ -669,14 +919,19 @@ audyn_opus_sink_close(audyn_opus_sink_t *s)
         s->enc = NULL;
     }
 
-    if (s->fp) {
-        (void)fflush(s->fp);
-        if (s->cfg.enable_fsync && s->fd >= 0) (void)fsync(s->fd);
-        (void)fclose(s->fp);
-        s->fp = NULL;
-        s->fd = -1;
+    int rc = 0;
+    if (s->fw) {
+        /* Drains, fdatasyncs if durable, closes */
+        if (audyn_file_writer_close(s->fw) != 0) {
+            LOG_ERROR("OPUS: Close failed for '%s'", s->path ? s->path : "(unknown)");
+            rc = -1;
+        }
+        s->fw = NULL;
     }
 
+    (void)audyn_seek_index_close(s->seek);
+    s->seek = NULL;
+
     s->closed = 1;
 
     LOG_DEBUG("OPUS: Closed '%s' - frames_in=%lu encoded=%lu packets=%lu bytes=%lu",
@@ -686,9 +941,31 @@ audyn_opus_sink_close(audyn_opus_sink_t *s)
               (unsigned long)s->stats.packets_encoded,
               (unsigned long)s->stats.bytes_encoded);
 
+    return rc;
+}
+
+int
+audyn_opus_sink_set_encoder(audyn_opus_sink_t *s, uint32_t bitrate, int complexity)
+{
+    if (!s) return -1;
+    if (bitrate < AUDYN_OPUS_BITRATE_MIN || bitrate > AUDYN_OPUS_BITRATE_MAX ||
+        complexity < 0 || complexity > 10) {
+        LOG_ERROR("OPUS: Invalid encoder settings %ubps complexity %d", bitrate, complexity);
+        return -1;
+    }
+
+    atomic_store_explicit(&s->ctl_bitrate, bitrate, memory_order_relaxed);
+    atomic_store_explicit(&s->ctl_complexity, complexity, memory_order_relaxed);
+    atomic_fetch_add_explicit(&s->ctl_req, 1u, memory_order_release);
     return 0;
 }
 
+void
+audyn_opus_sink_set_start(audyn_opus_sink_t *s, uint64_t clock_ns, uint64_t ptp_ns)
+{
+    if (s) audyn_seek_index_set_start(s->seek, clock_ns, ptp_ns);
+}
+
 void
 audyn_opus_sink_destroy(audyn_opus_sink_t *s)
 {
@@ -706,11 +983,20 @@ audyn_opus_sink_destroy(audyn_opus_sink_t *s)
         s->fifo = NULL;
     }
 
+    if (s->scratch) {
+        free(s->scratch);
+        s->scratch = NULL;
+    }
+
+    free(s->silence);
+    s->silence = NULL;
+
     if (s->path) {
         free(s->path);
         s->path = NULL;
     }
 
+    pthread_mutex_destroy(&s->stats_mu);
     free(s);
 }
 
@@ -718,5 +1004,17 @@ void
 audyn_opus_sink_get_stats(const audyn_opus_sink_t *s, audyn_opus_stats_t *stats)
 {
     if (!s || !stats) return;
+
+    pthread_mutex_lock((pthread_mutex_t *)&s->stats_mu);
     *stats = s->stats;
+    pthread_mutex_unlock((pthread_mutex_t *)&s->stats_mu);
+
+    if (s->lane) {
+        audyn_enc_lane_stats_t ls;
+        audyn_enc_lane_get_stats(s->lane, &ls);
+        stats->backlog_frames = ls.backlog_frames;
+        stats->backlog_max_frames = ls.backlog_max_frames;
+        stats->queue_delay_us_last = ls.queue_delay_us_last;
+        stats->queue_delay_us_max = ls.queue_delay_us_max;
+    }
 }
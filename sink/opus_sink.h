@@ -20,13 +20,18 @@
  *      - Output: standards-compliant ".opus" file
  *
  *  Threading Model:
- *      - Single-threaded; not thread-safe.
- *      - Expected to be used by exactly one consumer thread.
+ *      - Not thread-safe: one calling thread per sink.
+ *      - With cfg.encoder_pool set, write() only copies the audio into the
+ *        sink's lane (see encoder_pool.h) and encoding, muxing and page
+ *        writes run on the shared encoder threads; flush() and close()
+ *        wait for the lane to drain. Without a pool everything runs in
+ *        the calling thread.
  *
  *  Dependencies:
  *      - Standard C: stdint.h
  *      - libopus:    encoder (linked in implementation)
  *      - libogg:     container (linked in implementation)
+ *      - Audyn:      file_writer, encoder_pool, seek_index (plain C types only)
  *
  *      Note: This header intentionally does NOT include <opus/opus.h> or <ogg/ogg.h>
  *      to keep compile-time dependencies minimal. The public API exposes only
@@ -47,6 +52,9 @@
 
 #include <stdint.h>
 
+#include "file_writer.h"
+#include "encoder_pool.h"
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -63,7 +71,17 @@ typedef struct audyn_opus_stats
     uint64_t frames_encoded;    /* Total frames encoded (may differ due to padding) */
     uint64_t packets_encoded;   /* Total Opus packets written */
     uint64_t bytes_encoded;     /* Total compressed bytes written */
-    uint64_t fifo_overflows;    /* FIFO overflow events (data dropped) */
+    uint64_t fifo_overflows;    /* FIFO overflow events (fixed ring: stays 0) */
+    uint64_t packets_repeated;  /* Silent frames given the last DTX packet unencoded */
+
+    /* Encoder stage */
+    uint64_t frames_dropped;    /* Frames replaced by silence: encoder backlog full (pool mode) */
+    uint32_t encode_us_last;    /* Encode + mux + page write time of the last Opus frame */
+    uint32_t encode_us_max;
+    uint32_t backlog_frames;    /* Frames waiting for an encoder thread (pool mode) */
+    uint32_t backlog_max_frames;
+    uint32_t queue_delay_us_last; /* Wait before an encoder thread picked the audio up */
+    uint32_t queue_delay_us_max;
 } audyn_opus_stats_t;
 
 /*
@@ -94,6 +112,11 @@ typedef enum audyn_opus_application_e
  *   - Bitrate is clamped to valid range (6000-510000 bps)
  *   - Complexity is clamped to 0-10
  *   - Invalid application mode defaults to AUDYN_OPUS_APP_AUDIO
+ *   - dtx: the encoder sends 1-2 byte packets for silence. Once it has
+ *     done so for a frame of digital silence (all samples zero), further
+ *     silent frames reuse that packet without running the encoder. Every
+ *     frame still gets its packet and granule, so the file's duration and
+ *     seek positions stay sample-accurate.
  */
 typedef struct audyn_opus_cfg
 {
@@ -106,9 +129,18 @@ typedef struct audyn_opus_cfg
     int      vbr;                      /* 1 = enable VBR (recommended), 0 = CBR */
     int      complexity;               /* 0..10 (default 5) */
     audyn_opus_application_t application;
+    int      dtx;                      /* 1 = DTX; digital silence is not re-encoded (see below) */
+
+    /* Durability / I/O */
+    int      enable_fsync;             /* 1 = durable: fdatasync on the writer's budget and on close */
+    audyn_file_writer_cfg_t writer;    /* I/O backend (zeroed = AUTO) */
 
-    /* Durability */
-    int      enable_fsync;             /* 1 = fsync after page flush, 0 = no fsync (default 0) */
+    /* Encoder stage */
+    audyn_encoder_pool_t *encoder_pool; /* Shared encoder threads (NULL = encode inline) */
+    uint32_t queue_ms;                 /* Lane capacity in ms of audio (0 = 2000) */
+
+    /* Seek index ("<path>.seek", see seek_index.h) */
+    uint32_t seek_interval_ms;         /* Entry spacing (0 = no index) */
 
 } audyn_opus_cfg_t;
 
@@ -137,12 +169,17 @@ audyn_opus_sink_create(const char *path, const audyn_opus_cfg_t *cfg);
  *
  * Returns:
  *      0 on success
- *     -1 on error (encoder or I/O failure, FIFO overflow)
+ *     -1 on error (encoder or I/O failure)
  *
  * Notes:
+ *      - In pool mode the audio is queued and 0 is returned at once; if the
+ *        lane is full the block is replaced by as many frames of silence
+ *        (queued once there is room, in order) and counted in
+ *        frames_dropped, so the file's timeline stays continuous.
+ *        -1 is returned once the encoder thread has hit an error.
  *      - The sink may buffer packets until an Ogg page is ready to flush.
  *      - The caller retains ownership of interleaved_f32.
- *      - Internal FIFO is limited to ~10 seconds at 48kHz to prevent runaway memory.
+ *      - Any block size is accepted; the input FIFO is a fixed ring.
  *      - Errors are logged via the project's logging system.
  */
 int
@@ -152,7 +189,8 @@ audyn_opus_sink_write(audyn_opus_sink_t *sink,
 
 
 /*
- * Flush any buffered Ogg pages to disk.
+ * Flush any buffered Ogg pages to the file writer; with enable_fsync also
+ * requests an (asynchronous) fdatasync.
  *
  * Returns:
  *      0 on success
@@ -162,6 +200,39 @@ int
 audyn_opus_sink_flush(audyn_opus_sink_t *sink);
 
 
+/*
+ * Change the encoder bitrate (6000-510000 bps) and complexity (0-10) of
+ * an open sink. Real-time safe from any thread: the encoding thread
+ * applies the new settings before its next packet, so the change lands
+ * on a packet boundary and audio already queued is encoded with them.
+ *
+ * Returns:
+ *      0 on success
+ *     -1 on invalid settings (sink unchanged)
+ */
+int
+audyn_opus_sink_set_encoder(audyn_opus_sink_t *sink, uint32_t bitrate, int complexity);
+
+
+/*
+ * Record the archive clock and PTP media time of the first sample in the
+ * seek index header (0 = unknown). Call before the first write(); the
+ * lane hand-off orders it before any page write in pool mode. No-op
+ * without a seek index.
+ */
+void
+audyn_opus_sink_set_start(audyn_opus_sink_t *sink, uint64_t clock_ns, uint64_t ptp_ns);
+
+
+/*
+ * Pool mode: 1 while written audio is still waiting for or inside the
+ * encoder thread, else 0 (always 0 in inline mode). Never blocks; lets a
+ * caller defer close() on a finished file until it will not wait.
+ */
+int
+audyn_opus_sink_busy(const audyn_opus_sink_t *sink);
+
+
 /*
  * Finalize the Ogg stream and close the file.
  *
@@ -0,0 +1,208 @@
+/*
+ *  Audyn — Professional Audio Capture & Archival Engine
+ *
+ *  File:
+ *      seek_index.c
+ *
+ *  Purpose:
+ *      Seek index sidecar writer (see seek_index.h).
+ *
+ *  Notes:
+ *      - Entries are due every cfg.interval samples, measured from the
+ *        first one; a note past several intervals (a large write or a
+ *        long Opus page) adds one entry, not one per missed interval.
+ *      - A write error stops the index but never the audio file: the
+ *        sidecar is an optimisation the player can do without.
+ *
+ *  Copyright:
+ *      (c) 2026 B. Wynne
+ *
+ *  Author:
+ *      B. Wynne
+ *
+ *  License:
+ *      GPLv2 or later
+ */
+
+#include "seek_index.h"
+#include "log.h"
+
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Index writer buffers: 4 KiB holds 252 entries (minutes of audio) */
+#define SEEK_BUFFER_BYTES   4096u
+#define SEEK_BUFFERS        2u
+
+_Static_assert(sizeof(audyn_seek_index_header_t) == 64, "seek index header is 64 bytes");
+_Static_assert(offsetof(audyn_seek_index_header_t, audio_offset) == 24, "seek header layout");
+_Static_assert(offsetof(audyn_seek_index_header_t, preskip) == 48, "seek header layout");
+_Static_assert(sizeof(audyn_seek_entry_t) == 16, "seek entry is 16 bytes");
+
+struct audyn_seek_index {
+    audyn_file_writer_t *fw;
+    char *path;                 /* Sidecar path (for error messages) */
+    audyn_seek_index_header_t hdr;
+    uint64_t next_sample;       /* Next entry due at this sample */
+    int started;                /* Header written */
+    int failed;
+};
+
+static unsigned char *put_u16le(unsigned char *p, uint16_t v)
+{
+    p[0] = (unsigned char)(v & 0xffu);
+    p[1] = (unsigned char)((v >> 8) & 0xffu);
+    return p + 2;
+}
+
+static unsigned char *put_u32le(unsigned char *p, uint32_t v)
+{
+    p[0] = (unsigned char)(v & 0xffu);
+    p[1] = (unsigned char)((v >> 8) & 0xffu);
+    p[2] = (unsigned char)((v >> 16) & 0xffu);
+    p[3] = (unsigned char)((v >> 24) & 0xffu);
+    return p + 4;
+}
+
+static unsigned char *put_u64le(unsigned char *p, uint64_t v)
+{
+    p = put_u32le(p, (uint32_t)(v & 0xFFFFFFFFull));
+    return put_u32le(p, (uint32_t)(v >> 32));
+}
+
+static int write_header(audyn_seek_index_t *idx)
+{
+    const audyn_seek_index_header_t *h = &idx->hdr;
+    unsigned char buf[sizeof(audyn_seek_index_header_t)];
+    memset(buf, 0, sizeof(buf));
+
+    unsigned char *p = buf;
+    p = put_u32le(p, h->magic);
+    p = put_u16le(p, h->version);
+    p = put_u16le(p, h->header_bytes);
+    *p = h->kind;
+    p += 4;
+    p = put_u32le(p, h->sample_rate);
+    p = put_u16le(p, h->channels);
+    p = put_u16le(p, h->block_align);
+    p = put_u32le(p, h->interval);
+    p = put_u64le(p, h->audio_offset);
+    p = put_u64le(p, h->start_clock_ns);
+    p = put_u64le(p, h->start_ptp_ns);
+    (void)put_u32le(p, h->preskip);
+
+    idx->started = 1;
+    return audyn_file_writer_write(idx->fw, buf, sizeof(buf));
+}
+
+audyn_seek_index_t *audyn_seek_index_open(const char *audio_path,
+                                          const audyn_seek_index_cfg_t *cfg)
+{
+    if (!audio_path || !cfg || cfg->interval == 0 ||
+        (cfg->kind != AUDYN_SEEK_WAV && cfg->kind != AUDYN_SEEK_OPUS)) {
+        LOG_ERROR("seek_index: invalid configuration");
+        return NULL;
+    }
+
+    audyn_seek_index_t *idx = (audyn_seek_index_t *)calloc(1, sizeof(*idx));
+    if (!idx) {
+        LOG_ERROR("seek_index: allocation failed");
+        return NULL;
+    }
+
+    const size_t len = strlen(audio_path) + sizeof(AUDYN_SEEK_SUFFIX);
+    idx->path = (char *)malloc(len);
+    if (!idx->path) {
+        LOG_ERROR("seek_index: allocation failed");
+        free(idx);
+        return NULL;
+    }
+    snprintf(idx->path, len, "%s%s", audio_path, AUDYN_SEEK_SUFFIX);
+
+    /* Same backend as the audio, small buffers; the index can be rebuilt,
+     * so it is never fdatasynced */
+    audyn_file_writer_cfg_t wcfg = cfg->writer;
+    wcfg.buffer_bytes = SEEK_BUFFER_BYTES;
+    wcfg.buffers = SEEK_BUFFERS;
+    wcfg.direct = 0;
+    wcfg.durable = 0;
+    wcfg.sync_bytes = 0;
+
+    idx->fw = audyn_file_writer_open(idx->path, &wcfg);
+    if (!idx->fw) {
+        LOG_ERROR("seek_index: cannot create '%s'", idx->path);
+        free(idx->path);
+        free(idx);
+        return NULL;
+    }
+
+    audyn_seek_index_header_t *h = &idx->hdr;
+    h->magic = AUDYN_SEEK_MAGIC;
+    h->version = AUDYN_SEEK_VERSION;
+    h->header_bytes = (uint16_t)sizeof(*h);
+    h->kind = (uint8_t)cfg->kind;
+    h->sample_rate = cfg->sample_rate;
+    h->channels = cfg->channels;
+    h->block_align = cfg->block_align;
+    h->interval = cfg->interval;
+    h->audio_offset = cfg->audio_offset;
+    h->preskip = cfg->preskip;
+    return idx;
+}
+
+void audyn_seek_index_set_start(audyn_seek_index_t *idx,
+                                uint64_t start_clock_ns,
+                                uint64_t start_ptp_ns)
+{
+    if (!idx || idx->started) return;
+    idx->hdr.start_clock_ns = start_clock_ns;
+    idx->hdr.start_ptp_ns = start_ptp_ns;
+}
+
+int audyn_seek_index_note(audyn_seek_index_t *idx, uint64_t sample, uint64_t offset)
+{
+    if (!idx || idx->failed) return idx ? -1 : 0;
+    if (idx->started && sample < idx->next_sample) return 0;
+
+    if (!idx->started && write_header(idx) != 0) {
+        goto fail;
+    }
+
+    unsigned char e[sizeof(audyn_seek_entry_t)];
+    put_u64le(put_u64le(e, sample), offset);
+    if (audyn_file_writer_write(idx->fw, e, sizeof(e)) != 0) {
+        goto fail;
+    }
+
+    /* Due points stay on the interval grid of the first entry */
+    const uint64_t iv = idx->hdr.interval;
+    if (sample >= idx->next_sample) {
+        idx->next_sample += ((sample - idx->next_sample) / iv + 1u) * iv;
+    }
+    return 0;
+
+fail:
+    LOG_ERROR("seek_index: write failed for '%s', index stopped", idx->path);
+    idx->failed = 1;
+    return -1;
+}
+
+int audyn_seek_index_close(audyn_seek_index_t *idx)
+{
+    if (!idx) return 0;
+
+    int rc = idx->failed ? -1 : 0;
+    if (!idx->started && !idx->failed && write_header(idx) != 0) {
+        LOG_ERROR("seek_index: write failed for '%s'", idx->path);
+        rc = -1;
+    }
+    if (audyn_file_writer_close(idx->fw) != 0) {
+        LOG_ERROR("seek_index: close failed for '%s'", idx->path);
+        rc = -1;
+    }
+    free(idx->path);
+    free(idx);
+    return rc;
+}
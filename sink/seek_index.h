@@ -0,0 +1,137 @@
+/*
+ *  Audyn — Professional Audio Capture & Archival Engine
+ *
+ *  File:
+ *      seek_index.h
+ *
+ *  Purpose:
+ *      Seek index sidecar ("<audio file>.seek") written next to WAV and
+ *      Ogg Opus archives while they are recorded. Each entry maps a
+ *      sample position to the byte offset where decoding can start, so a
+ *      player seeks with one index lookup and a byte-range read instead
+ *      of scanning or transcoding the file.
+ *
+ *  Layout (version 1, little-endian):
+ *      64-byte header (audyn_seek_index_header_t), then 16-byte entries
+ *      (audyn_seek_entry_t) in increasing sample order, one per interval.
+ *      The file only grows: the header is written with the first entry
+ *      and never rewritten, so readers can use it while recording, taking
+ *      as many whole entries as the file size holds.
+ *
+ *  Entries:
+ *      - WAV:  sample = sample frame at the stream rate; offset = its first
+ *              byte (audio_offset + sample * block_align)
+ *      - Opus: sample = granule position of the page before (48 kHz,
+ *              after pre-skip); offset = start of the Ogg page from which
+ *              decoding yields audio after that position. Players still
+ *              decode about 80 ms of pre-roll before the wanted time.
+ *
+ *  I/O:
+ *      Appends go through a small file_writer of the caller's backend, so
+ *      noting a position never blocks the sink's thread.
+ *
+ *  Threading:
+ *      - Not thread-safe: one calling thread, the sink's writing thread.
+ *
+ *  Dependencies:
+ *      - Audyn: file_writer, log
+ *
+ *  Copyright:
+ *      (c) 2026 B. Wynne
+ *
+ *  Author:
+ *      B. Wynne
+ *
+ *  License:
+ *      GPLv2 or later
+ */
+
+#ifndef AUDYN_SEEK_INDEX_H
+#define AUDYN_SEEK_INDEX_H
+
+#include <stdint.h>
+
+#include "file_writer.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define AUDYN_SEEK_MAGIC        0x4B535941u     /* "AYSK" little-endian */
+#define AUDYN_SEEK_VERSION      1u
+
+/* Sidecar name: audio path + this suffix */
+#define AUDYN_SEEK_SUFFIX       ".seek"
+
+typedef enum audyn_seek_kind {
+    AUDYN_SEEK_WAV  = 1,
+    AUDYN_SEEK_OPUS = 2
+} audyn_seek_kind_t;
+
+/* On-disk header (64 bytes) */
+typedef struct audyn_seek_index_header {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t header_bytes;      /* sizeof(audyn_seek_index_header_t) */
+    uint8_t  kind;              /* audyn_seek_kind_t */
+    uint8_t  reserved0[3];
+    uint32_t sample_rate;       /* Unit of entry samples (Opus: 48000) */
+    uint16_t channels;
+    uint16_t block_align;       /* WAV bytes per sample frame; 0 for Opus */
+    uint32_t interval;          /* Samples between entries */
+    uint64_t audio_offset;      /* First audio byte (after the WAV header / Opus header pages) */
+    uint64_t start_clock_ns;    /* Archive clock of the first sample (0 = unknown) */
+    uint64_t start_ptp_ns;      /* PTP media time of the first sample (0 = unknown) */
+    uint32_t preskip;           /* Opus pre-skip (48 kHz samples); 0 for WAV */
+    uint8_t  reserved1[12];
+} audyn_seek_index_header_t;
+
+typedef struct audyn_seek_entry {
+    uint64_t sample;
+    uint64_t offset;
+} audyn_seek_entry_t;
+
+typedef struct audyn_seek_index_cfg {
+    audyn_seek_kind_t kind;
+    uint32_t sample_rate;       /* Entry sample unit */
+    uint16_t channels;
+    uint16_t block_align;
+    uint32_t interval;          /* Samples between entries (> 0) */
+    uint64_t audio_offset;
+    uint32_t preskip;
+    audyn_file_writer_cfg_t writer; /* Backend to use (buffers are sized here) */
+} audyn_seek_index_cfg_t;
+
+typedef struct audyn_seek_index audyn_seek_index_t;
+
+/*
+ * Create "<audio_path>.seek". Nothing is written until the first entry.
+ * Returns index or NULL on error (logged). NOT real-time safe.
+ */
+audyn_seek_index_t *audyn_seek_index_open(const char *audio_path,
+                                          const audyn_seek_index_cfg_t *cfg);
+
+/*
+ * Record the file's start time. Only effective before the first
+ * audyn_seek_index_note(); later calls are ignored.
+ */
+void audyn_seek_index_set_start(audyn_seek_index_t *idx,
+                                uint64_t start_clock_ns,
+                                uint64_t start_ptp_ns);
+
+/*
+ * Report that decoding can start at byte offset for sample. Appends an
+ * entry when sample has reached the next interval (the first call always
+ * does). Returns 0, or -1 on a write error (logged; the index stops).
+ */
+int audyn_seek_index_note(audyn_seek_index_t *idx, uint64_t sample, uint64_t offset);
+
+/* Flush, close and free (safe with NULL). The sidecar of a file without
+ * audio holds just the header. Returns 0 on success, -1 on error. */
+int audyn_seek_index_close(audyn_seek_index_t *idx);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* AUDYN_SEEK_INDEX_H */
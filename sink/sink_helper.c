@@ -0,0 +1,156 @@
+/*
+ *  Audyn — Professional Audio Capture & Archival Engine
+ *
+ *  File:
+ *      sink_helper.c
+ *
+ *  Purpose:
+ *      Background thread for sink setup and teardown (see sink_helper.h).
+ *
+ *  Completion:
+ *      'done' is stored under the mutex and broadcast on done_cv, so
+ *      wait() cannot miss it; done() is a plain acquire load for callers
+ *      that poll.
+ *
+ *  Dependencies:
+ *      - pthread, C11 atomics
+ *      - Audyn: log
+ *
+ *  Copyright:
+ *      (c) 2026 B. Wynne
+ *
+ *  Author:
+ *      B. Wynne
+ *
+ *  License:
+ *      GPLv2 or later
+ */
+
+#define _GNU_SOURCE
+
+#include "sink_helper.h"
+#include "log.h"
+
+#include <pthread.h>
+#include <stdlib.h>
+
+struct audyn_sink_helper {
+    pthread_mutex_t mu;
+    pthread_cond_t  work_cv;        /* Queue non-empty / stop */
+    pthread_cond_t  done_cv;        /* A waitable job finished */
+
+    audyn_sink_job_t *head;
+    audyn_sink_job_t *tail;
+    int stop;
+
+    pthread_t thread;
+};
+
+static void *helper_thread(void *arg)
+{
+    audyn_sink_helper_t *h = (audyn_sink_helper_t *)arg;
+
+    (void)pthread_setname_np(pthread_self(), "audyn-sink");
+
+    pthread_mutex_lock(&h->mu);
+    for (;;) {
+        while (!h->head && !h->stop) {
+            pthread_cond_wait(&h->work_cv, &h->mu);
+        }
+        audyn_sink_job_t *job = h->head;
+        if (!job) break;            /* stop with an empty queue */
+
+        h->head = job->next;
+        if (!h->head) h->tail = NULL;
+        pthread_mutex_unlock(&h->mu);
+
+        /* Read before the callback: a detached job may be freed by it */
+        const int detached = job->detached;
+        job->fn(job);
+
+        pthread_mutex_lock(&h->mu);
+        if (!detached) {
+            atomic_store_explicit(&job->done, 1, memory_order_release);
+            pthread_cond_broadcast(&h->done_cv);
+        }
+    }
+    pthread_mutex_unlock(&h->mu);
+
+    return NULL;
+}
+
+void audyn_sink_job_init(audyn_sink_job_t *job, audyn_sink_job_fn fn, int detached)
+{
+    job->fn = fn;
+    job->detached = detached;
+    atomic_store_explicit(&job->done, 0, memory_order_relaxed);
+    job->next = NULL;
+}
+
+audyn_sink_helper_t *audyn_sink_helper_create(void)
+{
+    audyn_sink_helper_t *h = (audyn_sink_helper_t *)calloc(1, sizeof(*h));
+    if (!h) {
+        LOG_ERROR("sink_helper: allocation failed");
+        return NULL;
+    }
+
+    pthread_mutex_init(&h->mu, NULL);
+    pthread_cond_init(&h->work_cv, NULL);
+    pthread_cond_init(&h->done_cv, NULL);
+
+    if (pthread_create(&h->thread, NULL, helper_thread, h) != 0) {
+        LOG_ERROR("sink_helper: failed to start thread");
+        pthread_cond_destroy(&h->done_cv);
+        pthread_cond_destroy(&h->work_cv);
+        pthread_mutex_destroy(&h->mu);
+        free(h);
+        return NULL;
+    }
+
+    LOG_DEBUG("sink_helper: started");
+    return h;
+}
+
+void audyn_sink_helper_submit(audyn_sink_helper_t *h, audyn_sink_job_t *job)
+{
+    job->next = NULL;
+
+    pthread_mutex_lock(&h->mu);
+    if (h->tail) h->tail->next = job;
+    else h->head = job;
+    h->tail = job;
+    pthread_cond_signal(&h->work_cv);
+    pthread_mutex_unlock(&h->mu);
+}
+
+int audyn_sink_helper_done(const audyn_sink_job_t *job)
+{
+    return atomic_load_explicit(&job->done, memory_order_acquire);
+}
+
+void audyn_sink_helper_wait(audyn_sink_helper_t *h, audyn_sink_job_t *job)
+{
+    pthread_mutex_lock(&h->mu);
+    while (!atomic_load_explicit(&job->done, memory_order_acquire)) {
+        pthread_cond_wait(&h->done_cv, &h->mu);
+    }
+    pthread_mutex_unlock(&h->mu);
+}
+
+void audyn_sink_helper_destroy(audyn_sink_helper_t *h)
+{
+    if (!h) return;
+
+    pthread_mutex_lock(&h->mu);
+    h->stop = 1;
+    pthread_cond_broadcast(&h->work_cv);
+    pthread_mutex_unlock(&h->mu);
+
+    pthread_join(h->thread, NULL);
+
+    pthread_cond_destroy(&h->done_cv);
+    pthread_cond_destroy(&h->work_cv);
+    pthread_mutex_destroy(&h->mu);
+    free(h);
+}
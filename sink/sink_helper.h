@@ -0,0 +1,88 @@
+/*
+ *  Audyn — Professional Audio Capture & Archival Engine
+ *
+ *  File:
+ *      sink_helper.h
+ *
+ *  Purpose:
+ *      Background thread for the slow ends of a file's life: creating the
+ *      archive directory, opening and initialising the next sink ahead of
+ *      its rotation boundary, and finalising (header patch, fsync, close)
+ *      the previous one. Capture workers hand these off and keep draining
+ *      their queues; at the boundary they only swap pointers.
+ *
+ *      One helper serves every worker in the process. Jobs run in
+ *      submission order, one at a time.
+ *
+ *  Jobs:
+ *      Callers embed an audyn_sink_job_t in their own struct and recover
+ *      it in the callback. The queue is an intrusive list, so submit()
+ *      never allocates or fails. A waitable job must stay valid until
+ *      done() reports it finished; a detached job is never touched by the
+ *      helper once its callback starts, so the callback may free it.
+ *
+ *  Threading:
+ *      - submit()/done()/wait() from any thread
+ *      - destroy() runs the jobs still queued, then joins
+ *
+ *  Dependencies:
+ *      - pthread, C11 atomics
+ *
+ *  Copyright:
+ *      (c) 2026 B. Wynne
+ *
+ *  Author:
+ *      B. Wynne
+ *
+ *  License:
+ *      GPLv2 or later
+ */
+
+#ifndef AUDYN_SINK_HELPER_H
+#define AUDYN_SINK_HELPER_H
+
+#include <stdatomic.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct audyn_sink_helper audyn_sink_helper_t;
+
+typedef struct audyn_sink_job audyn_sink_job_t;
+
+typedef void (*audyn_sink_job_fn)(audyn_sink_job_t *job);
+
+struct audyn_sink_job {
+    audyn_sink_job_fn fn;
+    int detached;                   /* Callback owns (and may free) the job */
+    atomic_int done;                /* Set after fn returns (waitable jobs) */
+    audyn_sink_job_t *next;         /* Internal */
+};
+
+/* Prepare a job for submission (safe to reuse once done). */
+void audyn_sink_job_init(audyn_sink_job_t *job, audyn_sink_job_fn fn, int detached);
+
+/*
+ * Start the helper thread.
+ * Returns helper or NULL on error (logged). NOT real-time safe.
+ */
+audyn_sink_helper_t *audyn_sink_helper_create(void);
+
+/* Queue a job. Never blocks on running jobs (one short mutex hold). */
+void audyn_sink_helper_submit(audyn_sink_helper_t *h, audyn_sink_job_t *job);
+
+/* Non-blocking: 1 once a waitable job has finished. */
+int audyn_sink_helper_done(const audyn_sink_job_t *job);
+
+/* Block until a waitable job has finished. */
+void audyn_sink_helper_wait(audyn_sink_helper_t *h, audyn_sink_job_t *job);
+
+/* Run every queued job, stop the thread and free (safe with NULL). */
+void audyn_sink_helper_destroy(audyn_sink_helper_t *h);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* AUDYN_SINK_HELPER_H */
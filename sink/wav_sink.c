@@ -5,16 +5,30 @@
  *      wav_sink.c
  *
  *  Purpose:
- *      Implements a minimal PCM16 WAV writer (RIFF/WAVE).
+ *      Implements a minimal WAV writer (RIFF/WAVE): PCM16, packed PCM24
+ *      and IEEE float32.
  *
  *  Notes:
- *      - Input samples: float32 interleaved (-1..+1) (values are clamped)
- *      - Output: little-endian PCM16
+ *      - Input samples: float32 interleaved (-1..+1) (clamped for PCM), or
+ *        packed S24LE bytes for the PCM24 passthrough
+ *      - Output: little-endian PCM16 / PCM24 / float32, converted with the
+ *        pcm_convert encoder kernels
+ *      - Float files carry an 18-byte fmt chunk (WAVE_FORMAT_IEEE_FLOAT)
+ *        and the fact chunk required for non-PCM data
  *      - Classic RIFF/WAVE has a < 4 GiB data limit; we enforce it.
+ *      - RF64/BW64 (EBU Tech 3306 / ITU-R BS.2088): a 28-byte JUNK chunk is
+ *        reserved after "WAVE" at open. On close, files that fit in 32-bit
+ *        sizes stay plain RIFF/WAVE (readers skip JUNK); larger files are
+ *        promoted in place: RIFF -> RF64/BW64, JUNK -> ds64 with the 64-bit
+ *        sizes, 32-bit size fields set to 0xFFFFFFFF.
+ *      - File I/O goes through file_writer (io_uring / writer thread /
+ *        stdio); header sizes are patched with a positioned write on close.
+ *      - Seek index entries are noted before each write, at the frame the
+ *        write starts with, so entries fall on write boundaries.
  *
  *  Dependencies:
- *      - POSIX: fileno(), fsync()
- *      - Standard C: stdio.h, stdint.h, errno.h
+ *      - Audyn: file_writer, pcm_convert, seek_index, log
+ *      - Standard C: stdint.h, stdlib.h, string.h
  *
  *  Copyright:
  *      (c) 2026 B. Wynne
@@ -27,13 +41,13 @@
  */
 
 #include "wav_sink.h"
+#include "file_writer.h"
+#include "pcm_convert.h"
+#include "seek_index.h"
 #include "log.h"
 
-#include <errno.h>
-#include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
-#include <unistd.h>
 
 /* Maximum reasonable channel count (8.1 surround is 9 channels) */
 #define WAV_MAX_CHANNELS 32
@@ -41,66 +55,167 @@
 /* Maximum reasonable sample rate (384kHz is high-end pro audio) */
 #define WAV_MAX_SAMPLE_RATE 384000
 
+/* ds64 payload: riffSize, dataSize, sampleCount (u64 each), tableLength (u32) */
+#define WAV_DS64_SIZE 28
+
+/* Largest header: RIFF(12) + JUNK/ds64(8+28) + fmt(8+18) + fact(8+4) + data(8) */
+#define WAV_MAX_HEADER (12 + 8 + WAV_DS64_SIZE + 8 + 18 + 8 + 4 + 8)
+
+/* Samples converted per file_writer call */
+#define WAV_CONVERT_SAMPLES 4096
+
+/* fmt chunk format tags */
+#define WAV_TAG_PCM         1
+#define WAV_TAG_IEEE_FLOAT  3
+
 struct audyn_wav_sink {
     audyn_wav_sink_cfg_t cfg;
-    FILE    *fp;
-    int      fd;                /* File descriptor for fsync */
+    audyn_file_writer_t *fw;    /* NULL when closed */
     char    *path;              /* Output path (for error messages) */
     uint32_t sample_rate;
     uint16_t channels;
     uint64_t bytes_written;     /* data chunk bytes written */
+    uint32_t header_bytes;      /* Offset of the first sample byte */
+    audyn_seek_index_t *seek;   /* NULL without cfg.seek_interval_ms */
+
+    /* Sample encoding (fixed by cfg.format) */
+    audyn_pcm_encoder_t enc;
+    uint8_t *conv;              /* WAV_CONVERT_SAMPLES * enc.bytes_per_sample */
 
     /* Statistics */
     audyn_wav_stats_t stats;
 };
 
-static int write_u16le(FILE *fp, uint16_t v)
+static unsigned char *put_u16le(unsigned char *p, uint16_t v)
 {
-    const unsigned char b[2] = {
-        (unsigned char)(v & 0xffu),
-        (unsigned char)((v >> 8) & 0xffu)
-    };
-    return (fwrite(b, 1, 2, fp) == 2) ? 0 : -1;
+    p[0] = (unsigned char)(v & 0xffu);
+    p[1] = (unsigned char)((v >> 8) & 0xffu);
+    return p + 2;
 }
 
-static int write_u32le(FILE *fp, uint32_t v)
+static unsigned char *put_u32le(unsigned char *p, uint32_t v)
 {
-    const unsigned char b[4] = {
-        (unsigned char)(v & 0xffu),
-        (unsigned char)((v >> 8) & 0xffu),
-        (unsigned char)((v >> 16) & 0xffu),
-        (unsigned char)((v >> 24) & 0xffu)
-    };
-    return (fwrite(b, 1, 4, fp) == 4) ? 0 : -1;
+    p[0] = (unsigned char)(v & 0xffu);
+    p[1] = (unsigned char)((v >> 8) & 0xffu);
+    p[2] = (unsigned char)((v >> 16) & 0xffu);
+    p[3] = (unsigned char)((v >> 24) & 0xffu);
+    return p + 4;
 }
 
-static int write_header_placeholder(audyn_wav_sink_t *s)
+static unsigned char *put_tag(unsigned char *p, const char *tag)
+{
+    memcpy(p, tag, 4);
+    return p + 4;
+}
+
+static unsigned char *put_u64le(unsigned char *p, uint64_t v)
+{
+    p = put_u32le(p, (uint32_t)(v & 0xFFFFFFFFull));
+    return put_u32le(p, (uint32_t)(v >> 32));
+}
+
+/*
+ * Build the complete header for data_bytes of sample data. With
+ * data_bytes = 0 this is the placeholder written at open; at close the same
+ * layout is rebuilt with final sizes and written over it.
+ */
+static size_t build_header(const audyn_wav_sink_t *s, unsigned char *hdr, uint64_t data_bytes)
 {
+    unsigned char *p = hdr;
+    const int reserve = (s->cfg.container != AUDYN_WAV_RIFF);
+    const int is_float = (s->cfg.format == AUDYN_WAV_FLOAT32);
+    const uint32_t fmt_size = is_float ? 18u : 16u;
+    const uint32_t header_bytes = 12u + (reserve ? 8u + WAV_DS64_SIZE : 0u) +
+                                  8u + fmt_size + (is_float ? 12u : 0u) + 8u;
+    const uint32_t block_align = (uint32_t)s->channels * s->enc.bytes_per_sample;
+    const uint64_t sample_frames = data_bytes / block_align;
+
+    /* RIFF size covers everything after the size field, incl. pad byte */
+    const uint64_t riff_size = (uint64_t)header_bytes - 8u + data_bytes + (data_bytes & 1u);
+    const int promote = reserve && (riff_size > 0xFFFFFFFFull || data_bytes > 0xFFFFFFFFull);
+
     /* RIFF header */
-    if (fwrite("RIFF", 1, 4, s->fp) != 4) return -1;
-    if (write_u32le(s->fp, 0) != 0) return -1; /* riff size placeholder */
-    if (fwrite("WAVE", 1, 4, s->fp) != 4) return -1;
+    if (promote) {
+        p = put_tag(p, s->cfg.container == AUDYN_WAV_BW64 ? "BW64" : "RF64");
+        p = put_u32le(p, 0xFFFFFFFFu);
+    } else {
+        p = put_tag(p, "RIFF");
+        p = put_u32le(p, (uint32_t)riff_size);   /* 0 in the placeholder */
+    }
+    p = put_tag(p, "WAVE");
+
+    /* ds64 (promoted) or JUNK reserving its space */
+    if (reserve) {
+        if (promote) {
+            p = put_tag(p, "ds64");
+            p = put_u32le(p, WAV_DS64_SIZE);
+            p = put_u64le(p, riff_size);
+            p = put_u64le(p, data_bytes);
+            p = put_u64le(p, sample_frames);
+            p = put_u32le(p, 0);                 /* no table entries */
+        } else {
+            p = put_tag(p, "JUNK");
+            p = put_u32le(p, WAV_DS64_SIZE);
+            memset(p, 0, WAV_DS64_SIZE);
+            p += WAV_DS64_SIZE;
+        }
+    }
 
     /* fmt chunk */
-    if (fwrite("fmt ", 1, 4, s->fp) != 4) return -1;
-    if (write_u32le(s->fp, 16) != 0) return -1;          /* PCM fmt chunk size */
-    if (write_u16le(s->fp, 1) != 0) return -1;           /* PCM */
-    if (write_u16le(s->fp, s->channels) != 0) return -1; /* channels */
-    if (write_u32le(s->fp, s->sample_rate) != 0) return -1;
+    p = put_tag(p, "fmt ");
+    p = put_u32le(p, fmt_size);
+    p = put_u16le(p, is_float ? WAV_TAG_IEEE_FLOAT : WAV_TAG_PCM);
+    p = put_u16le(p, s->channels);
+    p = put_u32le(p, s->sample_rate);
+
+    const uint16_t bits = (uint16_t)(s->enc.bytes_per_sample * 8u);
+    const uint32_t byte_rate = s->sample_rate * block_align;
+
+    p = put_u32le(p, byte_rate);
+    p = put_u16le(p, (uint16_t)block_align);
+    p = put_u16le(p, bits);
+    if (is_float) {
+        p = put_u16le(p, 0);              /* cbSize: no extension */
+
+        /* fact: sample frames per channel (ds64 holds it when promoted) */
+        p = put_tag(p, "fact");
+        p = put_u32le(p, 4);
+        p = put_u32le(p, promote ? 0xFFFFFFFFu : (uint32_t)sample_frames);
+    }
 
-    const uint16_t bits = 16;
-    const uint32_t byte_rate = s->sample_rate * (uint32_t)s->channels * (bits / 8u);
-    const uint16_t block_align = (uint16_t)(s->channels * (bits / 8u));
+    /* data chunk */
+    p = put_tag(p, "data");
+    p = put_u32le(p, promote ? 0xFFFFFFFFu : (uint32_t)data_bytes);
 
-    if (write_u32le(s->fp, byte_rate) != 0) return -1;
-    if (write_u16le(s->fp, block_align) != 0) return -1;
-    if (write_u16le(s->fp, bits) != 0) return -1;
+    return (size_t)(p - hdr);
+}
 
-    /* data chunk */
-    if (fwrite("data", 1, 4, s->fp) != 4) return -1;
-    if (write_u32le(s->fp, 0) != 0) return -1; /* data size placeholder */
+static audyn_pcm_out_format_t wav_pcm_format(audyn_wav_format_t fmt)
+{
+    switch (fmt) {
+        case AUDYN_WAV_PCM24:   return AUDYN_PCM_OUT_S24LE;
+        case AUDYN_WAV_FLOAT32: return AUDYN_PCM_OUT_F32LE;
+        default:                return AUDYN_PCM_OUT_S16LE;
+    }
+}
 
-    return ferror(s->fp) ? -1 : 0;
+const char *audyn_wav_format_name(audyn_wav_format_t fmt)
+{
+    switch (fmt) {
+        case AUDYN_WAV_PCM16:   return "PCM16";
+        case AUDYN_WAV_PCM24:   return "PCM24";
+        case AUDYN_WAV_FLOAT32: return "FLOAT32";
+        default:                return "unknown";
+    }
+}
+
+static int write_header_placeholder(audyn_wav_sink_t *s)
+{
+    unsigned char hdr[WAV_MAX_HEADER];
+    const size_t len = build_header(s, hdr, 0);
+
+    s->header_bytes = (uint32_t)len;
+    return audyn_file_writer_write(s->fw, hdr, len);
 }
 
 audyn_wav_sink_t *audyn_wav_sink_create(const audyn_wav_sink_cfg_t *cfg)
@@ -118,7 +233,16 @@ audyn_wav_sink_t *audyn_wav_sink_create(const audyn_wav_sink_cfg_t *cfg)
         s->cfg.enable_fsync = 0;
     }
 
-    s->fd = -1;
+    /* Unknown formats are rejected by open() */
+    (void)audyn_pcm_encoder_init(&s->enc, wav_pcm_format(s->cfg.format), AUDYN_PCM_ISA_AUTO);
+
+    s->conv = (uint8_t *)malloc((size_t)WAV_CONVERT_SAMPLES * sizeof(float));
+    if (!s->conv) {
+        LOG_ERROR("WAV: Failed to allocate conversion buffer");
+        free(s);
+        return NULL;
+    }
+
     memset(&s->stats, 0, sizeof(s->stats));
 
     return s;
@@ -127,11 +251,12 @@ audyn_wav_sink_t *audyn_wav_sink_create(const audyn_wav_sink_cfg_t *cfg)
 void audyn_wav_sink_destroy(audyn_wav_sink_t *s)
 {
     if (!s) return;
-    if (s->fp) (void)audyn_wav_sink_close(s);
+    if (s->fw) (void)audyn_wav_sink_close(s);
     if (s->path) {
         free(s->path);
         s->path = NULL;
     }
+    free(s->conv);
     free(s);
 }
 
@@ -158,7 +283,7 @@ int audyn_wav_sink_open(audyn_wav_sink_t *s,
     }
 
     /* Close any previously-open file (defensive). */
-    if (s->fp) (void)audyn_wav_sink_close(s);
+    if (s->fw) (void)audyn_wav_sink_close(s);
 
     /* Free old path if any */
     if (s->path) {
@@ -166,10 +291,16 @@ int audyn_wav_sink_open(audyn_wav_sink_t *s,
         s->path = NULL;
     }
 
-    if (s->cfg.format != AUDYN_WAV_PCM16) {
+    if (s->cfg.format != AUDYN_WAV_PCM16 && s->cfg.format != AUDYN_WAV_PCM24 &&
+        s->cfg.format != AUDYN_WAV_FLOAT32) {
         LOG_ERROR("WAV: Unsupported format %d", s->cfg.format);
         return -1;
     }
+    if (s->cfg.container != AUDYN_WAV_RIFF && s->cfg.container != AUDYN_WAV_RF64 &&
+        s->cfg.container != AUDYN_WAV_BW64) {
+        LOG_ERROR("WAV: Unsupported container %d", s->cfg.container);
+        return -1;
+    }
 
     /* Store path for error messages */
     s->path = strdup(path);
@@ -178,21 +309,17 @@ int audyn_wav_sink_open(audyn_wav_sink_t *s,
         return -1;
     }
 
-    s->fp = fopen(path, "wb");
-    if (!s->fp) {
-        LOG_ERROR("WAV: Failed to open '%s': %s", path, strerror(errno));
+    audyn_file_writer_cfg_t wcfg = s->cfg.writer;
+    if (s->cfg.enable_fsync) wcfg.durable = 1;
+
+    s->fw = audyn_file_writer_open(path, &wcfg);
+    if (!s->fw) {
+        LOG_ERROR("WAV: Failed to open '%s'", path);
         free(s->path);
         s->path = NULL;
         return -1;
     }
 
-    /* Get file descriptor for fsync */
-    s->fd = fileno(s->fp);
-    if (s->fd < 0) {
-        LOG_DEBUG("WAV: fileno() returned -1, fsync disabled");
-        s->cfg.enable_fsync = 0;
-    }
-
     s->sample_rate = sample_rate;
     s->channels = channels;
     s->bytes_written = 0;
@@ -202,40 +329,43 @@ int audyn_wav_sink_open(audyn_wav_sink_t *s,
 
     if (write_header_placeholder(s) != 0) {
         LOG_ERROR("WAV: Failed to write header to '%s'", path);
-        fclose(s->fp);
-        s->fp = NULL;
-        s->fd = -1;
+        (void)audyn_file_writer_close(s->fw);
+        s->fw = NULL;
         return -1;
     }
 
-    LOG_INFO("WAV: Opened '%s' - %uHz %uch PCM16", path, sample_rate, channels);
-
-    return 0;
-}
-
-static inline int16_t f32_to_i16(float x)
-{
-    if (x > 1.0f) x = 1.0f;
-    if (x < -1.0f) x = -1.0f;
+    /* The index is optional: a failure costs seeking, not the recording */
+    if (s->cfg.seek_interval_ms > 0) {
+        audyn_seek_index_cfg_t icfg;
+        memset(&icfg, 0, sizeof(icfg));
+        icfg.kind = AUDYN_SEEK_WAV;
+        icfg.sample_rate = sample_rate;
+        icfg.channels = channels;
+        icfg.block_align = (uint16_t)(channels * s->enc.bytes_per_sample);
+        icfg.interval = (uint32_t)(((uint64_t)sample_rate * s->cfg.seek_interval_ms + 999u) / 1000u);
+        icfg.audio_offset = s->header_bytes;
+        icfg.writer = s->cfg.writer;
+        s->seek = audyn_seek_index_open(path, &icfg);
+        if (!s->seek) {
+            LOG_WARN("WAV: No seek index for '%s'", path);
+        }
+    }
 
-    /* Use 32767 scaling so +1.0 maps to INT16_MAX. */
-    int v = (int)(x * 32767.0f);
+    LOG_INFO("WAV: Opened '%s' - %uHz %uch %s (%s)", path, sample_rate, channels,
+             audyn_wav_format_name(s->cfg.format), audyn_file_writer_backend_name(s->fw));
 
-    if (v > 32767) v = 32767;
-    if (v < -32768) v = -32768;
-    return (int16_t)v;
+    return 0;
 }
 
-int audyn_wav_sink_write(audyn_wav_sink_t *s,
-                         const float *interleaved_f32,
-                         uint32_t frames,
-                         uint16_t channels)
+/* Validate a write and enforce the classic RIFF size limit */
+static int check_write(audyn_wav_sink_t *s, const void *data,
+                       uint32_t frames, uint16_t channels)
 {
-    if (!s || !s->fp) {
+    if (!s || !s->fw) {
         LOG_ERROR("WAV: Write called on NULL or closed sink");
         return -1;
     }
-    if (!interleaved_f32) {
+    if (!data) {
         LOG_ERROR("WAV: NULL audio data");
         return -1;
     }
@@ -245,46 +375,57 @@ int audyn_wav_sink_write(audyn_wav_sink_t *s,
         return -1;
     }
 
-    if (frames == 0)
-        return 0;
-
     /* Check for potential overflow: frames * channels must fit in size_t */
     if (frames > SIZE_MAX / channels) {
         LOG_ERROR("WAV: Frame count overflow (%u frames * %u channels)", frames, channels);
         return -1;
     }
 
-    const size_t samples = (size_t)frames * (size_t)channels;
-
-    /* RIFF/WAVE classic size limit: data chunk size must fit in uint32. */
-    const uint64_t add_bytes = (uint64_t)samples * (uint64_t)sizeof(int16_t);
-    if (s->bytes_written + add_bytes > 0xFFFFFFFFull) {
+    /* RIFF/WAVE classic size limit: RIFF size must fit in uint32
+     * (RF64/BW64 containers are promoted on close instead). */
+    const uint64_t add_bytes = (uint64_t)frames * channels * s->enc.bytes_per_sample;
+    if (s->cfg.container == AUDYN_WAV_RIFF &&
+        s->bytes_written + add_bytes + s->header_bytes - 8u + 1u > 0xFFFFFFFFull) {
         LOG_ERROR("WAV: Size limit exceeded for '%s' (needs RF64)",
                   s->path ? s->path : "(unknown)");
         s->stats.size_limit_hit = 1;
         return -1;
     }
 
-    enum { CHUNK = 4096 };
+    return 0;
+}
+
+int audyn_wav_sink_write(audyn_wav_sink_t *s,
+                         const float *interleaved_f32,
+                         uint32_t frames,
+                         uint16_t channels)
+{
+    if (check_write(s, interleaved_f32, frames, channels) != 0)
+        return -1;
+
+    if (frames == 0)
+        return 0;
+
+    if (s->seek)
+        (void)audyn_seek_index_note(s->seek, s->stats.frames_written,
+                                    s->header_bytes + s->bytes_written);
+
+    const size_t samples = (size_t)frames * (size_t)channels;
+    const size_t bps = s->enc.bytes_per_sample;
     size_t i = 0;
-    int16_t tmp[CHUNK];
 
     while (i < samples) {
         size_t n = samples - i;
-        if (n > CHUNK) n = CHUNK;
+        if (n > WAV_CONVERT_SAMPLES) n = WAV_CONVERT_SAMPLES;
 
-        for (size_t j = 0; j < n; ++j) {
-            tmp[j] = f32_to_i16(interleaved_f32[i + j]);
-        }
+        audyn_pcm_encode(&s->enc, interleaved_f32 + i, s->conv, n);
 
-        const size_t wrote = fwrite(tmp, sizeof(int16_t), n, s->fp);
-        if (wrote != n) {
-            LOG_ERROR("WAV: Write failed for '%s': %s",
-                      s->path ? s->path : "(unknown)", strerror(errno));
+        if (audyn_file_writer_write(s->fw, s->conv, n * bps) != 0) {
+            LOG_ERROR("WAV: Write failed for '%s'", s->path ? s->path : "(unknown)");
             return -1;
         }
 
-        s->bytes_written += (uint64_t)(n * sizeof(int16_t));
+        s->bytes_written += (uint64_t)(n * bps);
         i += n;
     }
 
@@ -292,104 +433,107 @@ int audyn_wav_sink_write(audyn_wav_sink_t *s,
     s->stats.frames_written += frames;
     s->stats.bytes_written = s->bytes_written;
 
-    if (s->cfg.enable_fsync)
-        return audyn_wav_sink_sync(s);
-
+    /* Durable writers sync on the writer's time/byte budget, not per write */
     return 0;
 }
 
-int audyn_wav_sink_sync(audyn_wav_sink_t *s)
+int audyn_wav_sink_write_s24le(audyn_wav_sink_t *s,
+                               const uint8_t *packed,
+                               uint32_t frames,
+                               uint16_t channels)
 {
-    if (!s || !s->fp)
+    if (check_write(s, packed, frames, channels) != 0)
         return -1;
 
-    if (fflush(s->fp) != 0) {
-        LOG_ERROR("WAV: fflush failed for '%s': %s",
-                  s->path ? s->path : "(unknown)", strerror(errno));
+    if (s->cfg.format != AUDYN_WAV_PCM24) {
+        LOG_ERROR("WAV: S24LE passthrough needs PCM24 (file is %s)",
+                  audyn_wav_format_name(s->cfg.format));
         return -1;
     }
 
-    if (s->fd >= 0) {
-        if (fsync(s->fd) != 0) {
-            LOG_ERROR("WAV: fsync failed for '%s': %s",
-                      s->path ? s->path : "(unknown)", strerror(errno));
-            return -1;
-        }
+    if (frames == 0)
+        return 0;
+
+    if (s->seek)
+        (void)audyn_seek_index_note(s->seek, s->stats.frames_written,
+                                    s->header_bytes + s->bytes_written);
+
+    /* Already in file byte order: no conversion or copy */
+    const size_t bytes = (size_t)frames * channels * 3u;
+    if (audyn_file_writer_write(s->fw, packed, bytes) != 0) {
+        LOG_ERROR("WAV: Write failed for '%s'", s->path ? s->path : "(unknown)");
+        return -1;
     }
 
+    s->bytes_written += (uint64_t)bytes;
+    s->stats.frames_written += frames;
+    s->stats.bytes_written = s->bytes_written;
+
     return 0;
 }
 
-int audyn_wav_sink_close(audyn_wav_sink_t *s)
+void audyn_wav_sink_set_start(audyn_wav_sink_t *s, uint64_t clock_ns, uint64_t ptp_ns)
 {
-    if (!s || !s->fp)
-        return -1;
-
-    const char *path = s->path ? s->path : "(unknown)";
+    if (s) audyn_seek_index_set_start(s->seek, clock_ns, ptp_ns);
+}
 
-    if (fflush(s->fp) != 0) {
-        LOG_ERROR("WAV: fflush failed for '%s': %s", path, strerror(errno));
-        fclose(s->fp);
-        s->fp = NULL;
-        s->fd = -1;
+int audyn_wav_sink_sync(audyn_wav_sink_t *s)
+{
+    if (!s || !s->fw)
         return -1;
-    }
 
-    if (s->bytes_written > 0xFFFFFFFFull) {
-        LOG_ERROR("WAV: Size limit exceeded for '%s'", path);
-        fclose(s->fp);
-        s->fp = NULL;
-        s->fd = -1;
+    if (audyn_file_writer_sync(s->fw) != 0) {
+        LOG_ERROR("WAV: sync failed for '%s'", s->path ? s->path : "(unknown)");
         return -1;
     }
 
-    const uint32_t data_size = (uint32_t)s->bytes_written;
-
-    /* RIFF size = 4 ("WAVE") + (8+fmt) + (8+data) */
-    const uint32_t riff_size = 4u + (8u + 16u) + (8u + data_size);
+    return 0;
+}
 
-    /* Patch RIFF size at offset 4. */
-    if (fseek(s->fp, 4L, SEEK_SET) != 0 || write_u32le(s->fp, riff_size) != 0) {
-        LOG_ERROR("WAV: Failed to patch RIFF size for '%s'", path);
-        fclose(s->fp);
-        s->fp = NULL;
-        s->fd = -1;
+int audyn_wav_sink_close(audyn_wav_sink_t *s)
+{
+    if (!s || !s->fw)
         return -1;
-    }
 
-    /* Patch data size at offset 40 (PCM16, no extra chunks). */
-    if (fseek(s->fp, 40L, SEEK_SET) != 0 || write_u32le(s->fp, data_size) != 0) {
-        LOG_ERROR("WAV: Failed to patch data size for '%s'", path);
-        fclose(s->fp);
-        s->fp = NULL;
-        s->fd = -1;
-        return -1;
+    const char *path = s->path ? s->path : "(unknown)";
+    int rc = 0;
+
+    /* RIFF chunks are word aligned: pad odd-length data */
+    if (s->bytes_written & 1u) {
+        const unsigned char pad = 0;
+        if (audyn_file_writer_write(s->fw, &pad, 1) != 0) {
+            LOG_ERROR("WAV: Failed to write pad byte for '%s'", path);
+            rc = -1;
+        }
     }
 
-    if (fflush(s->fp) != 0) {
-        LOG_ERROR("WAV: fflush after patch failed for '%s': %s", path, strerror(errno));
-        fclose(s->fp);
-        s->fp = NULL;
-        s->fd = -1;
-        return -1;
+    /* Rewrite the header in place with final sizes (same length as the
+     * placeholder). The writer drains pending data first. */
+    unsigned char hdr[WAV_MAX_HEADER];
+    const size_t len = build_header(s, hdr, s->bytes_written);
+    if (rc == 0 && audyn_file_writer_pwrite(s->fw, 0, hdr, len) != 0) {
+        LOG_ERROR("WAV: Failed to patch header for '%s'", path);
+        rc = -1;
     }
 
-    /* fsync after patching if enabled */
-    if (s->cfg.enable_fsync && s->fd >= 0) {
-        if (fsync(s->fd) != 0) {
-            LOG_ERROR("WAV: fsync failed for '%s': %s", path, strerror(errno));
-            /* Continue to close anyway */
-        }
+    /* Drains, fdatasyncs if durable, closes */
+    if (audyn_file_writer_close(s->fw) != 0) {
+        LOG_ERROR("WAV: Close failed for '%s'", path);
+        rc = -1;
     }
+    s->fw = NULL;
+
+    (void)audyn_seek_index_close(s->seek);
+    s->seek = NULL;
 
-    fclose(s->fp);
-    s->fp = NULL;
-    s->fd = -1;
+    if (rc != 0)
+        return -1;
 
-    LOG_DEBUG("WAV: Closed '%s' - frames=%lu bytes=%lu",
+    LOG_DEBUG("WAV: Closed '%s' - frames=%lu bytes=%lu%s",
               path,
               (unsigned long)s->stats.frames_written,
-              (unsigned long)s->stats.bytes_written);
+              (unsigned long)s->stats.bytes_written,
+              (len > 4 && memcmp(hdr, "RIFF", 4) != 0) ? " (64-bit sizes)" : "");
 
     return 0;
 }
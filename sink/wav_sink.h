@@ -5,22 +5,37 @@
  *      wav_sink.h
  *
  *  Purpose:
- *      Minimal-dependency WAV writer sink (PCM16, RIFF/WAVE).
+ *      Minimal-dependency WAV writer sink (PCM16, PCM24, float32; RIFF/WAVE).
  *
  *  Design:
- *      - Writes a 44-byte RIFF/WAVE header with placeholder sizes on open()
- *      - Appends little-endian PCM16 sample data on write()
+ *      - Writes a RIFF/WAVE header with placeholder sizes on open()
+ *      - Appends little-endian sample data on write(); PCM16 and PCM24 are
+ *        clamped, float32 is stored unmodified (WAVE_FORMAT_IEEE_FLOAT)
+ *      - write_s24le() appends already packed 24-bit samples (PCM24 only),
+ *        so L24 input can be archived without a float round trip
  *      - Seeks back and patches RIFF and data chunk sizes on close()
  *
  *  Format Limits:
  *      - Classic RIFF/WAVE uses 32-bit sizes; payload is limited to < 4 GiB.
- *      - This sink returns an error if the data chunk would exceed UINT32_MAX.
+ *        With AUDYN_WAV_RIFF this sink returns an error at that point.
+ *      - AUDYN_WAV_RF64 / AUDYN_WAV_BW64 reserve a JUNK chunk so the file can
+ *        be promoted to RF64/BW64 (ds64 chunk) on close and grow without
+ *        limit. Files under 4 GiB stay readable as plain RIFF/WAVE.
  *
  *  Threading:
  *      - NOT thread-safe. Intended to be used from a single consumer thread.
  *
+ *  I/O:
+ *      - Bytes go through file_writer (see file_writer.h); the backend,
+ *        O_DIRECT and sync budget are taken from cfg.writer.
+ *
+ *  Seek Index:
+ *      - With cfg.seek_interval_ms set, a "<path>.seek" sidecar (see
+ *        seek_index.h) gets an entry per interval as samples are written.
+ *
  *  Dependencies:
  *      - Standard C: stdint.h
+ *      - Audyn: file_writer, pcm_convert, seek_index
  *
  *  Copyright:
  *      (c) 2026 B. Wynne
@@ -37,17 +52,30 @@
 
 #include <stdint.h>
 
+#include "file_writer.h"
+
 #ifdef __cplusplus
 extern "C" {
 #endif
 
 typedef enum audyn_wav_format {
-    AUDYN_WAV_PCM16 = 1
+    AUDYN_WAV_PCM16 = 1,            /* 16-bit integer */
+    AUDYN_WAV_PCM24,                /* 24-bit integer, packed (3 bytes) */
+    AUDYN_WAV_FLOAT32               /* 32-bit IEEE float */
 } audyn_wav_format_t;
 
+typedef enum audyn_wav_container {
+    AUDYN_WAV_RIFF = 0,             /* Classic 44-byte header, < 4 GiB */
+    AUDYN_WAV_RF64,                 /* JUNK reserved, RF64 when > 4 GiB */
+    AUDYN_WAV_BW64                  /* As RF64 with the BW64 (BS.2088) id */
+} audyn_wav_container_t;
+
 typedef struct audyn_wav_sink_cfg {
     audyn_wav_format_t format;
-    int enable_fsync; /* if non-zero, fsync() after each write() and close() */
+    audyn_wav_container_t container;
+    int enable_fsync; /* if non-zero, durable: fdatasync on the writer's budget and on close */
+    audyn_file_writer_cfg_t writer;   /* I/O backend (zeroed = AUTO) */
+    uint32_t seek_interval_ms;        /* Seek index entry spacing (0 = no index) */
 } audyn_wav_sink_cfg_t;
 
 /*
@@ -56,7 +84,7 @@ typedef struct audyn_wav_sink_cfg {
 typedef struct audyn_wav_stats {
     uint64_t frames_written;    /* Total frames written */
     uint64_t bytes_written;     /* Total data bytes written (excluding header) */
-    int      size_limit_hit;    /* 1 if 4GB limit was hit */
+    int      size_limit_hit;    /* 1 if the classic RIFF 4GB limit was hit */
 } audyn_wav_stats_t;
 
 typedef struct audyn_wav_sink audyn_wav_sink_t;
@@ -85,10 +113,10 @@ int  audyn_wav_sink_open(audyn_wav_sink_t *s,
 int  audyn_wav_sink_close(audyn_wav_sink_t *s);
 
 /*
- * Write interleaved float32 samples to WAV as PCM16.
+ * Write interleaved float32 samples in the configured format.
  *
  * Parameters:
- *   - interleaved_f32: [-1.0, +1.0] nominal (values are clamped)
+ *   - interleaved_f32: [-1.0, +1.0] nominal (clamped for PCM16/PCM24)
  *   - frames: number of sample frames (time indices)
  *   - channels: must match the channels passed to open()
  *
@@ -101,7 +129,25 @@ int  audyn_wav_sink_write(audyn_wav_sink_t *s,
                           uint32_t frames,
                           uint16_t channels);
 
-/* Flush + optionally fsync to disk. */
+/*
+ * Write packed little-endian 24-bit samples as-is (frames * channels * 3
+ * bytes). Only valid for AUDYN_WAV_PCM24.
+ *
+ * Returns 0 on success, -1 on error.
+ */
+int  audyn_wav_sink_write_s24le(audyn_wav_sink_t *s,
+                                const uint8_t *packed,
+                                uint32_t frames,
+                                uint16_t channels);
+
+/*
+ * Record the archive clock and PTP media time of the file's first sample
+ * in the seek index header (0 = unknown). Call before the first write;
+ * no-op without a seek index.
+ */
+void audyn_wav_sink_set_start(audyn_wav_sink_t *s, uint64_t clock_ns, uint64_t ptp_ns);
+
+/* Submit buffered data and request fdatasync (asynchronous on io_uring/thread). */
 int  audyn_wav_sink_sync(audyn_wav_sink_t *s);
 
 /*
@@ -113,6 +159,9 @@ int  audyn_wav_sink_sync(audyn_wav_sink_t *s);
  */
 void audyn_wav_sink_get_stats(const audyn_wav_sink_t *s, audyn_wav_stats_t *stats);
 
+/* "PCM16", "PCM24", "FLOAT32" */
+const char *audyn_wav_format_name(audyn_wav_format_t fmt);
+
 #ifdef __cplusplus
 }
 #endif
@@ -182,6 +182,15 @@ async def set_capture_config(
         logger.warning("Failed to persist config to file storage")
 
     logger.info(f"Config updated by {user.email}: {updates}")
+
+    # Running recorders take the new archive timing from their next file
+    archive_changes = {key: updates[key] for key in ("archive_period", "archive_layout") if key in updates}
+    if archive_changes:
+        from ..services.recorder_manager import get_recorder_manager  # Imports this module
+        failed = await get_recorder_manager().reconfigure_all(archive_changes)
+        if failed:
+            logger.warning(f"Archive settings apply to recorders {failed} after a restart")
+
     return {"message": "Configuration updated", "config": _current_config}
 
 
@@ -176,7 +176,14 @@ async def update_recorder_config(
     recorder = get_recorder(recorder_id)
 
     if recorder.state == RecorderState.RECORDING:
-        raise HTTPException(status_code=400, detail="Cannot update config while recording")
+        # Bitrate and VOX changes apply to the running process; anything
+        # else needs a restart
+        if not await get_recorder_manager().apply_config(recorder_id, config):
+            raise HTTPException(status_code=400, detail="Cannot update config while recording")
+        recorder.config = config
+        _save_recorders()
+        logger.info(f"Recorder {recorder_id} config updated live by {user.email}")
+        return {"message": "Configuration updated", "recorder": recorder}
 
     # Validate and populate source configuration
     if config.source_type == SourceType.AES67 and config.source_id:
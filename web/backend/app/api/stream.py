@@ -12,6 +12,7 @@ from fastapi import APIRouter, Depends, HTTPException, Request
 from fastapi.responses import StreamingResponse, Response
 from pathlib import Path
 import os
+import struct
 import subprocess
 import asyncio
 import logging
@@ -20,6 +21,9 @@ from typing import Optional, AsyncGenerator
 
 from ..auth.entra import get_current_user, User
 from ..services.config_store import load_global_config
+from ..services.seek_index import stream_from as seek_index_stream_from
+from ..services.pcm_tap import PcmTap
+from ..services.recorder_manager import get_recorder_manager
 
 logger = logging.getLogger(__name__)
 
@@ -308,7 +312,9 @@ async def stream_preview(
 ):
     """
     Stream audio file for browser preview.
-    Transcodes to MP3 for broad browser compatibility.
+    Transcodes to MP3 for broad browser compatibility. Seeks into a file
+    with a seek index (audyn --seek-index) are served from the file itself,
+    as WAV or Ogg Opus starting at the requested time, without ffmpeg.
 
     Args:
         file_path: Relative path to audio file within archive
@@ -349,16 +355,21 @@ async def stream_preview(
         logger.info(f"Streaming growing file: {full_path}")
 
     # Use appropriate streaming method
+    media_type = "audio/mpeg"
     if start > 0:
-        # Seeking requested - use standard transcode
-        generator = transcode_to_mp3(full_path, start)
+        # Seeking requested - byte-range read via the seek index, else transcode
+        spliced = await seek_index_stream_from(full_path, start)
+        if spliced:
+            generator, media_type = spliced
+        else:
+            generator = transcode_to_mp3(full_path, start)
     else:
         # Start from beginning - use growing file aware transcode
         generator = transcode_growing_file(full_path, "mp3", follow=follow)
 
     return StreamingResponse(
         generator,
-        media_type="audio/mpeg",
+        media_type=media_type,
         headers={
             # No Content-Length for growing files - use chunked encoding
             "Transfer-Encoding": "chunked",
@@ -430,17 +441,118 @@ async def stream_raw(
     )
 
 
+def live_wav_header(sample_rate: int, channels: int) -> bytes:
+    """Float WAV header with open-ended sizes for a live stream."""
+    block_align = channels * 4
+    return struct.pack(
+        "<4sI4s4sIHHIIHH4sI",
+        b"RIFF", 0xFFFFFFFF, b"WAVE",
+        b"fmt ", 16, 3, channels, sample_rate,
+        sample_rate * block_align, block_align, 32,
+        b"data", 0xFFFFFFFF,
+    )
+
+
+async def stream_live_wav(tap: PcmTap) -> AsyncGenerator[bytes, None]:
+    """Live tap as an endless float32 WAV."""
+    yield live_wav_header(tap.sample_rate, tap.channels)
+    async for chunk in tap.stream():
+        yield chunk
+
+
+async def transcode_live(tap: PcmTap, output_format: str = "mp3") -> AsyncGenerator[bytes, None]:
+    """Live tap piped through FFmpeg for browsers."""
+    cmd = [
+        "ffmpeg", "-hide_banner", "-loglevel", "warning",
+        "-f", "f32le", "-ar", str(tap.sample_rate), "-ac", str(tap.channels),
+        "-i", "pipe:0",
+    ]
+    if output_format == "mp3":
+        cmd.extend(["-c:a", "libmp3lame", "-b:a", "192k", "-f", "mp3"])
+    else:  # aac
+        cmd.extend(["-c:a", "aac", "-b:a", "192k", "-f", "adts"])
+    # Low-latency output: no muxer buffering
+    cmd.extend(["-flush_packets", "1", "-"])
+
+    process = await asyncio.create_subprocess_exec(
+        *cmd,
+        stdin=asyncio.subprocess.PIPE,
+        stdout=asyncio.subprocess.PIPE,
+        stderr=asyncio.subprocess.DEVNULL
+    )
+
+    async def feed():
+        try:
+            async for chunk in tap.stream():
+                process.stdin.write(chunk)
+                await process.stdin.drain()
+        except (BrokenPipeError, ConnectionResetError):
+            pass
+        finally:
+            if not process.stdin.is_closing():
+                process.stdin.close()
+
+    feeder = asyncio.create_task(feed())
+    try:
+        while True:
+            chunk = await process.stdout.read(STREAM_CHUNK_SIZE)
+            if not chunk:
+                break
+            yield chunk
+    finally:
+        feeder.cancel()
+        if process.returncode is None:
+            process.terminate()
+            try:
+                await asyncio.wait_for(process.wait(), timeout=2.0)
+            except asyncio.TimeoutError:
+                process.kill()
+
+
 @router.get("/live")
-async def stream_live(user: User = Depends(get_current_user)):
+async def stream_live(
+    recorder_id: int,
+    format: str = "mp3",
+    user: User = Depends(get_current_user)
+):
     """
-    Stream live audio from current capture.
-    Returns real-time audio transcoded to MP3.
+    Stream live audio from a running recorder or level monitor.
+
+    Reads the process's shared-memory PCM tap (audyn --tap-shm), so any
+    number of listeners share the capture already running; none of them
+    can slow it down. Starts at the live edge.
+
+    Args:
+        recorder_id: Recorder to listen to
+        format: mp3 (default), aac, or wav (float32, no transcoding)
     """
-    # TODO: Implement live streaming from Audyn process
-    # This would tap into the audio queue and transcode in real-time
-    raise HTTPException(
-        status_code=501,
-        detail="Live streaming not yet implemented"
+    if format not in ("mp3", "aac", "wav"):
+        raise HTTPException(status_code=400, detail="Format must be mp3, aac or wav")
+
+    name = get_recorder_manager().live_tap(recorder_id)
+    if not name:
+        raise HTTPException(status_code=404, detail="Recorder is not capturing")
+
+    tap = PcmTap(name)
+    if not tap.open():
+        raise HTTPException(status_code=503, detail="Live tap not available")
+
+    if format == "wav":
+        generator = stream_live_wav(tap)
+        media_type = "audio/wav"
+    else:
+        generator = transcode_live(tap, format)
+        media_type = "audio/mpeg" if format == "mp3" else "audio/aac"
+
+    return StreamingResponse(
+        generator,
+        media_type=media_type,
+        headers={
+            "Transfer-Encoding": "chunked",
+            "Cache-Control": "no-cache, no-store, must-revalidate",
+            "Pragma": "no-cache",
+            "Expires": "0",
+        }
     )
 
 
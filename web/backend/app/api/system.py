@@ -11,9 +11,11 @@ from typing import Optional
 from datetime import datetime
 
 from fastapi import APIRouter, Depends, HTTPException, File, UploadFile, Form
+from fastapi.responses import PlainTextResponse
 from pydantic import BaseModel
 
 from ..auth.entra import get_current_user, User
+from ..services.recorder_manager import get_recorder_manager
 from ..services.config_store import (
     load_system_config, save_system_config,
     load_ssl_config, save_ssl_config,
@@ -1116,6 +1118,17 @@ async def list_interfaces(user: User = Depends(get_current_user)):
     return get_network_interfaces()
 
 
+@router.get("/metrics", response_class=PlainTextResponse)
+async def get_metrics(user: User = Depends(get_current_user)):
+    """
+    Prometheus text exposition of every running recorder: per-stage latency
+    histograms (rx_push, queue_dwell, sink_write, encode, fsync, rotation)
+    and engine counters, read from each process's --metrics-shm endpoint.
+    """
+    return PlainTextResponse(get_recorder_manager().metrics_text(),
+                             media_type="text/plain; version=0.0.4")
+
+
 @router.get("/timezones", response_model=list[str])
 async def list_timezones(user: User = Depends(get_current_user)):
     """List available timezones."""
@@ -0,0 +1,120 @@
+"""
+Level Feed Reader
+
+Reads the binary level feed that audyn publishes with --levels-shm
+(/dev/shm/<name>, see core/level_shm.h). The file is mapped once and
+polled at UI rate; each read is a seqlock'd copy with no syscall, pipe or
+JSON parsing.
+
+Copyright: (c) 2026 B. Wynne
+License: GPLv2 or later
+"""
+
+import mmap
+import os
+import struct
+import time
+import logging
+from typing import Optional
+
+logger = logging.getLogger(__name__)
+
+SHM_DIR = "/dev/shm"
+
+# Layout version 1 (core/level_shm.h)
+MAGIC = 0x4C565941
+VERSION = 1
+HEADER = struct.Struct("<8I")          # magic .. state
+SEQ = struct.Struct("<Q")              # offset 32
+UPDATE_NS = struct.Struct("<Q")        # offset 40
+LEVEL = struct.Struct("<4fi")          # rms_linear, rms_db, peak_linear, peak_db, clipping
+SEQ_OFFSET = 32
+UPDATE_OFFSET = 40
+LEVELS_OFFSET = 48
+MAX_CHANNELS = 32
+
+# Retries before giving up on a read that keeps racing the writer
+READ_RETRIES = 16
+
+
+def feed_name(kind: str, recorder_id: int) -> str:
+    """Feed name for a recorder ("rec") or monitor ("mon") process."""
+    return f"audyn-{kind}-{recorder_id}"
+
+
+class LevelFeed:
+    """Read-only mapping of one audyn level feed."""
+
+    def __init__(self, name: str):
+        self.name = name
+        self._map: Optional[mmap.mmap] = None
+        self._channels = 0
+        self._last_seq = -1
+        self._last = None
+
+    def _open(self) -> bool:
+        path = os.path.join(SHM_DIR, self.name)
+        try:
+            fd = os.open(path, os.O_RDONLY)
+        except FileNotFoundError:
+            return False
+        try:
+            size = os.fstat(fd).st_size
+            if size < LEVELS_OFFSET + LEVEL.size:
+                return False
+            m = mmap.mmap(fd, size, prot=mmap.PROT_READ)
+        finally:
+            os.close(fd)
+
+        magic, version, header_bytes, channels = HEADER.unpack_from(m, 0)[:4]
+        if magic != MAGIC or version != VERSION or header_bytes > size or \
+                not 1 <= channels <= MAX_CHANNELS:
+            m.close()
+            return False
+
+        self._map = m
+        self._channels = channels
+        self._last_seq = -1
+        return True
+
+    def close(self):
+        if self._map is not None:
+            self._map.close()
+            self._map = None
+
+    def read(self) -> Optional[list[tuple[float, float, bool]]]:
+        """
+        Current (rms_db, peak_db, clipping) per channel, or None if the
+        feed does not exist (yet) or the writer has stopped.
+        """
+        if self._map is None and not self._open():
+            return None
+
+        m = self._map
+        state = HEADER.unpack_from(m, 0)[7]
+        if state == 0:
+            # Writer shut down; the next process recreates the name
+            self.close()
+            return None
+
+        for _ in range(READ_RETRIES):
+            seq1 = SEQ.unpack_from(m, SEQ_OFFSET)[0]
+            if seq1 & 1:
+                continue
+            if seq1 == self._last_seq:
+                return self._last
+            levels = [LEVEL.unpack_from(m, LEVELS_OFFSET + i * LEVEL.size)
+                      for i in range(self._channels)]
+            if SEQ.unpack_from(m, SEQ_OFFSET)[0] == seq1:
+                self._last_seq = seq1
+                self._last = [(l[1], l[3], bool(l[4])) for l in levels]
+                return self._last
+
+        # Writer busy for the whole window: keep the previous values
+        return self._last
+
+    def age_ns(self) -> Optional[int]:
+        """Time since the last update (CLOCK_MONOTONIC), or None."""
+        if self._map is None:
+            return None
+        return time.monotonic_ns() - UPDATE_NS.unpack_from(self._map, UPDATE_OFFSET)[0]
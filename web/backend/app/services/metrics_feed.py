@@ -0,0 +1,256 @@
+"""
+Metrics Feed Reader
+
+Reads the per-stage latency histograms and counters that audyn publishes
+with --metrics-shm (/dev/shm/<name>, see core/metrics.h) and renders them
+as Prometheus text exposition. Same mapping and seqlock protocol as the
+level feed.
+
+Copyright: (c) 2026 B. Wynne
+License: GPLv2 or later
+"""
+
+import mmap
+import os
+import re
+import struct
+import time
+import logging
+from typing import Optional
+
+logger = logging.getLogger(__name__)
+
+SHM_DIR = "/dev/shm"
+
+# Layout version 1 (core/metrics.h)
+MAGIC = 0x544D5941
+VERSION = 1
+HEADER = struct.Struct("<8I")          # magic .. sub_bits
+SEQ = struct.Struct("<Q")              # offset 32
+TIMES = struct.Struct("<2Q")           # update_ns, start_ns at 40
+COUNTS = struct.Struct("<2I")          # n_values, shards_used at 56
+SEQ_OFFSET = 32
+TIMES_OFFSET = 40
+COUNTS_OFFSET = 56
+NAME_BYTES = 32
+STAGE_HEAD = struct.Struct(f"<{NAME_BYTES}s3Q")
+VALUE = struct.Struct(f"<{NAME_BYTES}sQ")
+MAX_VALUES = 96
+
+# Retries before giving up on a read that keeps racing the writer
+READ_RETRIES = 16
+
+# Exported histogram bounds (seconds). The HDR buckets are finer; each is
+# counted under the first bound at or above its upper edge.
+LE_BOUNDS = [
+    1e-6, 2.5e-6, 5e-6, 1e-5, 2.5e-5, 5e-5, 1e-4, 2.5e-4, 5e-4,
+    1e-3, 2.5e-3, 5e-3, 1e-2, 2.5e-2, 5e-2, 0.1, 0.25, 0.5, 1.0, 2.5, 5.0, 10.0,
+]
+QUANTILES = [0.5, 0.9, 0.99, 0.999]
+
+# Per-stream values in multi-stream mode: "s<index>.<name>"
+STREAM_PREFIX = re.compile(r"^s(\d+)\.(.+)$")
+
+
+def metrics_name(kind: str, recorder_id: int) -> str:
+    """Metrics endpoint name for a recorder ("rec") or monitor ("mon") process."""
+    return f"audyn-metrics-{kind}-{recorder_id}"
+
+
+def bucket_lower(i: int, sub_bits: int) -> int:
+    """Lower bound (ns) of HDR bucket i (core/metrics.c)."""
+    sub_count = 1 << sub_bits
+    if i < sub_count:
+        return i
+    msb = (i >> sub_bits) + sub_bits - 1
+    return (sub_count + (i & (sub_count - 1))) << (msb - sub_bits)
+
+
+class MetricsFeed:
+    """Read-only mapping of one audyn metrics endpoint."""
+
+    def __init__(self, name: str):
+        self.name = name
+        self._map: Optional[mmap.mmap] = None
+        self._n_stages = 0
+        self._n_buckets = 0
+        self._sub_bits = 0
+        self.upper: list[int] = []          # Bucket upper edges (ns)
+        self._last_seq = -1
+        self._last = None
+
+    def _stage_bytes(self) -> int:
+        return STAGE_HEAD.size + 8 * self._n_buckets
+
+    def _open(self) -> bool:
+        path = os.path.join(SHM_DIR, self.name)
+        try:
+            fd = os.open(path, os.O_RDONLY)
+        except FileNotFoundError:
+            return False
+        try:
+            size = os.fstat(fd).st_size
+            if size < HEADER.size:
+                return False
+            m = mmap.mmap(fd, size, prot=mmap.PROT_READ)
+        finally:
+            os.close(fd)
+
+        magic, version, header_bytes, _pid, _state, n_stages, n_buckets, sub_bits = \
+            HEADER.unpack_from(m, 0)
+        self._n_stages = n_stages
+        self._n_buckets = n_buckets
+        need = header_bytes + n_stages * self._stage_bytes() + MAX_VALUES * VALUE.size
+        if magic != MAGIC or version != VERSION or need > size or not 0 < sub_bits < 8:
+            m.close()
+            return False
+
+        self._map = m
+        self._sub_bits = sub_bits
+        self._header_bytes = header_bytes
+        self.upper = [bucket_lower(i + 1, sub_bits) for i in range(n_buckets)]
+        self._last_seq = -1
+        return True
+
+    def close(self):
+        if self._map is not None:
+            self._map.close()
+            self._map = None
+
+    def _copy(self) -> dict:
+        m = self._map
+        stages = {}
+        off = self._header_bytes
+        bucket = struct.Struct(f"<{self._n_buckets}Q")
+        for _ in range(self._n_stages):
+            name, count, sum_ns, max_ns = STAGE_HEAD.unpack_from(m, off)
+            buckets = bucket.unpack_from(m, off + STAGE_HEAD.size)
+            stages[name.rstrip(b"\0").decode()] = {
+                "count": count, "sum_ns": sum_ns, "max_ns": max_ns, "buckets": buckets,
+            }
+            off += self._stage_bytes()
+
+        n_values, shards_used = COUNTS.unpack_from(m, COUNTS_OFFSET)
+        values = {}
+        for i in range(min(n_values, MAX_VALUES)):
+            name, value = VALUE.unpack_from(m, off + i * VALUE.size)
+            values[name.rstrip(b"\0").decode()] = value
+
+        update_ns, start_ns = TIMES.unpack_from(m, TIMES_OFFSET)
+        return {
+            "pid": HEADER.unpack_from(m, 0)[3],
+            "uptime_s": (update_ns - start_ns) / 1e9,
+            "update_ns": update_ns,
+            "shards_used": shards_used,
+            "stages": stages,
+            "values": values,
+        }
+
+    def read(self) -> Optional[dict]:
+        """
+        Latest snapshot ({"stages": {name: {count, sum_ns, max_ns, buckets}},
+        "values": {name: value}, ...}), or None if the endpoint does not
+        exist (yet) or the writer has stopped.
+        """
+        if self._map is None and not self._open():
+            return None
+
+        m = self._map
+        state = HEADER.unpack_from(m, 0)[4]
+        if state == 0:
+            # Writer shut down; the next process recreates the name
+            self.close()
+            return None
+
+        for _ in range(READ_RETRIES):
+            seq1 = SEQ.unpack_from(m, SEQ_OFFSET)[0]
+            if seq1 & 1:
+                continue
+            if seq1 == self._last_seq:
+                return self._last
+            snap = self._copy()
+            if SEQ.unpack_from(m, SEQ_OFFSET)[0] == seq1:
+                self._last_seq = seq1
+                self._last = snap
+                return snap
+
+        # Writer busy for the whole window: keep the previous snapshot
+        return self._last
+
+    def quantile(self, stage: dict, q: float) -> float:
+        """Upper edge (seconds) of the bucket holding quantile q, 0 if empty."""
+        total = stage["count"]
+        if total == 0:
+            return 0.0
+        rank = q * total
+        seen = 0
+        for i, n in enumerate(stage["buckets"]):
+            seen += n
+            if n and seen >= rank:
+                return min(self.upper[i], stage["max_ns"]) / 1e9
+        return stage["max_ns"] / 1e9
+
+    def age_ns(self) -> Optional[int]:
+        """Time since the last publish (CLOCK_MONOTONIC), or None."""
+        if self._map is None:
+            return None
+        return time.monotonic_ns() - TIMES.unpack_from(self._map, TIMES_OFFSET)[0]
+
+
+def _labels(base: dict, **extra) -> str:
+    items = {**base, **extra}
+    return ",".join(f'{k}="{v}"' for k, v in items.items())
+
+
+def render_prometheus(feeds: list[tuple[dict, MetricsFeed]]) -> str:
+    """Prometheus text exposition for (labels, feed) pairs."""
+    hist, maxes, quants, values, ups = [], [], [], {}, []
+
+    for labels, feed in feeds:
+        snap = feed.read()
+        ups.append(f"audyn_metrics_up{{{_labels(labels)}}} {1 if snap else 0}")
+        if not snap:
+            continue
+
+        for stage, st in snap["stages"].items():
+            lab = _labels(labels, stage=stage)
+            edges = iter(zip(feed.upper, st["buckets"]))
+            cum = 0
+            pending = next(edges, None)
+            for le in LE_BOUNDS:
+                le_ns = le * 1e9
+                while pending is not None and pending[0] <= le_ns:
+                    cum += pending[1]
+                    pending = next(edges, None)
+                hist.append(f'audyn_stage_duration_seconds_bucket{{{lab},le="{le:g}"}} {cum}')
+            hist.append(f'audyn_stage_duration_seconds_bucket{{{lab},le="+Inf"}} {st["count"]}')
+            hist.append(f"audyn_stage_duration_seconds_sum{{{lab}}} {st['sum_ns'] / 1e9:.9f}")
+            hist.append(f"audyn_stage_duration_seconds_count{{{lab}}} {st['count']}")
+            maxes.append(f"audyn_stage_duration_max_seconds{{{lab}}} {st['max_ns'] / 1e9:.9f}")
+            for q in QUANTILES:
+                quants.append(f'audyn_stage_duration_quantile_seconds{{{lab},quantile="{q:g}"}} '
+                              f"{feed.quantile(st, q):.9f}")
+
+        for name, value in snap["values"].items():
+            extra = {}
+            m = STREAM_PREFIX.match(name)
+            if m:
+                extra["stream"] = m.group(1)
+                name = m.group(2)
+            metric = f"audyn_{name}" if name.endswith("_max") else f"audyn_{name}_total"
+            values.setdefault(metric, []).append(f"{metric}{{{_labels(labels, **extra)}}} {value}")
+
+    out = [
+        "# HELP audyn_metrics_up 1 if the recorder's metrics endpoint is readable",
+        "# TYPE audyn_metrics_up gauge", *ups,
+        "# HELP audyn_stage_duration_seconds Per-stage latency",
+        "# TYPE audyn_stage_duration_seconds histogram", *hist,
+        "# HELP audyn_stage_duration_max_seconds Longest duration seen per stage",
+        "# TYPE audyn_stage_duration_max_seconds gauge", *maxes,
+        "# HELP audyn_stage_duration_quantile_seconds Per-stage quantiles (HDR, <= 12.5% error)",
+        "# TYPE audyn_stage_duration_quantile_seconds gauge", *quants,
+    ]
+    for metric, lines in values.items():
+        out.append(f"# TYPE {metric} {'gauge' if metric.endswith('_max') else 'counter'}")
+        out.extend(lines)
+    return "\n".join(out) + "\n"
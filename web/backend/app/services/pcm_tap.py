@@ -0,0 +1,161 @@
+"""
+PCM Tap Reader
+
+Reads the live PCM ring that audyn publishes with --tap-shm (/dev/shm/<name>,
+see core/pcm_tap.h): interleaved float32 at the stream rate, written by the
+capture worker without ever waiting for readers. Any number of listeners
+map the same ring; one that falls behind by more than the ring length skips
+ahead and counts the lost frames instead of stalling the recorder.
+
+Copyright: (c) 2026 B. Wynne
+License: GPLv2 or later
+"""
+
+import asyncio
+import mmap
+import os
+import struct
+import time
+import logging
+from typing import AsyncGenerator, Optional
+
+logger = logging.getLogger(__name__)
+
+SHM_DIR = "/dev/shm"
+
+# Layout version 1 (core/pcm_tap.h)
+MAGIC = 0x50545941
+VERSION = 1
+FORMAT_F32 = 1
+HEADER = struct.Struct("<10I")         # magic .. reserved
+POSITIONS = struct.Struct("<3Q")       # begin_frames, end_frames, update_ns at 40
+POSITIONS_OFFSET = 40
+STATE_OFFSET = 16
+MAX_CHANNELS = 64
+
+# Reader poll interval (s); the ring holds seconds, so this only sets latency
+POLL_INTERVAL = 0.02
+# Treat the writer as gone after this long without a write
+STALE_NS = 5_000_000_000
+
+
+def tap_name(kind: str, recorder_id: int) -> str:
+    """Tap name for a recorder ("rec") or monitor ("mon") process."""
+    return f"audyn-tap-{kind}-{recorder_id}"
+
+
+class PcmTap:
+    """Read-only mapping of one audyn PCM tap, with its own read position."""
+
+    def __init__(self, name: str):
+        self.name = name
+        self._map: Optional[mmap.mmap] = None
+        self.sample_rate = 0
+        self.channels = 0
+        self._capacity = 0
+        self._ring = 0
+        self._pos = 0
+        self.lost_frames = 0
+
+    def open(self) -> bool:
+        """Map the tap and start at its live edge. False if not available."""
+        if self._map is not None:
+            return True
+        path = os.path.join(SHM_DIR, self.name)
+        try:
+            fd = os.open(path, os.O_RDONLY)
+        except FileNotFoundError:
+            return False
+        try:
+            size = os.fstat(fd).st_size
+            if size < HEADER.size + POSITIONS.size:
+                return False
+            m = mmap.mmap(fd, size, prot=mmap.PROT_READ)
+        finally:
+            os.close(fd)
+
+        (magic, version, header_bytes, _pid, state, fmt, rate, channels,
+         capacity, _reserved) = HEADER.unpack_from(m, 0)
+        if magic != MAGIC or version != VERSION or fmt != FORMAT_F32 or \
+                state == 0 or rate == 0 or not 1 <= channels <= MAX_CHANNELS or \
+                capacity == 0 or capacity & (capacity - 1) or \
+                header_bytes + capacity * channels * 4 > size:
+            m.close()
+            return False
+
+        self._map = m
+        self.sample_rate = rate
+        self.channels = channels
+        self._capacity = capacity
+        self._ring = header_bytes
+        self._pos = POSITIONS.unpack_from(m, POSITIONS_OFFSET)[1]
+        self.lost_frames = 0
+        return True
+
+    def close(self):
+        if self._map is not None:
+            self._map.close()
+            self._map = None
+
+    def running(self) -> bool:
+        """Writer alive and still writing."""
+        if self._map is None:
+            return False
+        if struct.unpack_from("<I", self._map, STATE_OFFSET)[0] == 0:
+            return False
+        update_ns = POSITIONS.unpack_from(self._map, POSITIONS_OFFSET)[2]
+        return time.monotonic_ns() - update_ns < STALE_NS
+
+    def read(self) -> bytes:
+        """Interleaved float32 frames published since the last read."""
+        if self._map is None:
+            return b""
+
+        m = self._map
+        cap = self._capacity
+        frame_bytes = self.channels * 4
+
+        end = POSITIONS.unpack_from(m, POSITIONS_OFFSET)[1]
+        if end - self._pos > cap:
+            # Lapped by the writer: skip to the oldest frame still held
+            self.lost_frames += end - cap - self._pos
+            self._pos = end - cap
+        if end <= self._pos:
+            return b""
+
+        parts = []
+        pos = self._pos
+        while pos < end:
+            slot = pos & (cap - 1)
+            n = min(end - pos, cap - slot)
+            off = self._ring + slot * frame_bytes
+            parts.append(m[off:off + n * frame_bytes])
+            pos += n
+        data = b"".join(parts)
+
+        # Frames the writer started overwriting during the copy are torn.
+        # Step 3 of the protocol in core/pcm_tap.h: native readers place an
+        # acquire fence between the copy and this reload.
+        begin = POSITIONS.unpack_from(m, POSITIONS_OFFSET)[0]
+        torn = begin - cap - self._pos
+        if torn > 0:
+            torn = min(torn, end - self._pos)
+            self.lost_frames += torn
+            data = data[torn * frame_bytes:]
+
+        self._pos = end
+        return data
+
+    async def stream(self) -> AsyncGenerator[bytes, None]:
+        """Live float32 chunks until the writer stops."""
+        try:
+            while self.running():
+                data = self.read()
+                if data:
+                    yield data
+                else:
+                    await asyncio.sleep(POLL_INTERVAL)
+        finally:
+            if self.lost_frames:
+                logger.info(f"PCM tap {self.name}: listener lost {self.lost_frames} frames")
+            self.close()
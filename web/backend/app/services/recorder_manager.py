@@ -21,6 +21,9 @@ from pathlib import Path
 from ..models import RecorderConfig, SourceType, ChannelLevel
 from ..services.config_store import load_global_config
 from ..api.control import CaptureConfig
+from .level_feed import LevelFeed, feed_name
+from .metrics_feed import MetricsFeed, metrics_name, render_prometheus
+from .pcm_tap import tap_name
 
 logger = logging.getLogger(__name__)
 
@@ -40,6 +43,44 @@ def get_global_config():
 MOCK_AUDYN = Path(__file__).parent.parent.parent / "scripts" / "mock_audyn.sh"
 AUDYN_BIN = os.getenv("AUDYN_BIN", str(MOCK_AUDYN) if MOCK_AUDYN.exists() else "/usr/bin/audyn")
 
+# Read levels from the binary shared-memory feed (--levels-shm) instead of
+# parsing JSON lines from stdout. The mock binary only speaks JSON.
+USE_LEVEL_SHM = os.getenv("AUDYN_LEVELS_SHM", "0" if AUDYN_BIN == str(MOCK_AUDYN) else "1") == "1"
+
+# Per-stage latency histograms and counters (--metrics-shm), scraped by
+# /api/system/metrics
+USE_METRICS_SHM = os.getenv("AUDYN_METRICS_SHM", "0" if AUDYN_BIN == str(MOCK_AUDYN) else "1") == "1"
+
+# Seek index spacing for archive files (--seek-index, ms; 0 = none), used
+# by /api/stream/preview to seek without ffmpeg
+SEEK_INDEX_MS = int(os.getenv("AUDYN_SEEK_INDEX_MS", "0" if AUDYN_BIN == str(MOCK_AUDYN) else "1000"))
+
+# Live PCM tap (--tap-shm) on recorders and monitors, served by
+# /api/stream/live without a second capture process
+USE_TAP_SHM = os.getenv("AUDYN_TAP_SHM", "0" if AUDYN_BIN == str(MOCK_AUDYN) else "1") == "1"
+
+# Store long silent spans cheaply (--sparse-silence): WAV silence as
+# filesystem holes, Opus DTX. Off unless asked for.
+USE_SPARSE_SILENCE = os.getenv("AUDYN_SPARSE_SILENCE", "0") == "1"
+
+# Runtime reconfiguration over the recorder's stdin (--control): settings
+# in CONTROL_KEYS change without restarting capture
+USE_CONTROL = os.getenv("AUDYN_CONTROL", "0" if AUDYN_BIN == str(MOCK_AUDYN) else "1") == "1"
+
+# RecorderConfig field -> audyn control key
+CONTROL_KEYS = {
+    "bitrate": "bitrate",
+    "vox_threshold_db": "vox_threshold",
+    "vox_release_db": "vox_release",
+    "vox_detection_ms": "vox_detection",
+    "vox_hangover_ms": "vox_hangover",
+    "vox_preroll_ms": "vox_preroll",
+    "vox_level_mode": "vox_level",
+}
+
+# Seconds to wait for audyn to apply a change (it does so within one frame)
+CONTROL_TIMEOUT = 2.0
+
 
 @dataclass
 class RecorderProcess:
@@ -52,6 +93,11 @@ class RecorderProcess:
     monitor_task: Optional[asyncio.Task] = None
     stdout_task: Optional[asyncio.Task] = None
     levels: list = field(default_factory=list)  # Current audio levels
+    feed: Optional[LevelFeed] = None            # Shared-memory level feed
+    metrics: Optional[MetricsFeed] = None       # Shared-memory metrics endpoint
+    vox: bool = False                           # Started with --vox
+    control_replies: asyncio.Queue = field(default_factory=asyncio.Queue)
+    control_lock: asyncio.Lock = field(default_factory=asyncio.Lock)
 
 
 @dataclass
@@ -62,6 +108,25 @@ class MonitorProcess:
     config: Optional[RecorderConfig] = None
     stdout_task: Optional[asyncio.Task] = None
     levels: list = field(default_factory=list)
+    feed: Optional[LevelFeed] = None
+
+
+def levels_from_feed(feed: LevelFeed) -> list:
+    """Current levels of a shared-memory feed as ChannelLevel entries."""
+    values = feed.read()
+    if not values:
+        return []
+    names = ["L", "R"] if len(values) <= 2 else [str(i + 1) for i in range(len(values))]
+    return [
+        ChannelLevel(
+            name=names[i],
+            level_db=rms_db,
+            level_linear=10 ** (rms_db / 20),
+            peak_db=peak_db,
+            clipping=clipping
+        )
+        for i, (rms_db, peak_db, clipping) in enumerate(values)
+    ]
 
 
 class RecorderManager:
@@ -142,8 +207,23 @@ class RecorderManager:
         if config.format and config.format.value in ["opus", "mp3"]:
             cmd.extend(["--bitrate", str(config.bitrate or 128000)])
 
+        if SEEK_INDEX_MS > 0:
+            cmd.extend(["--seek-index", str(SEEK_INDEX_MS)])
+
+        if USE_SPARSE_SILENCE:
+            cmd.append("--sparse-silence")
+
         # Always enable level metering for web UI
-        cmd.append("--levels")
+        if USE_LEVEL_SHM:
+            cmd.extend(["--levels-shm", feed_name("rec", recorder_id)])
+        else:
+            cmd.append("--levels")
+
+        if USE_METRICS_SHM:
+            cmd.extend(["--metrics-shm", metrics_name("rec", recorder_id)])
+
+        if USE_TAP_SHM:
+            cmd.extend(["--tap-shm", tap_name("rec", recorder_id)])
 
         # VOX settings (only if globally enabled and per-recorder enabled)
         if global_cfg and global_cfg.vox_facility_enabled and config.vox_enabled:
@@ -156,6 +236,9 @@ class RecorderManager:
             cmd.extend(["--vox-preroll", str(config.vox_preroll_ms)])
             cmd.extend(["--vox-level", config.vox_level_mode.value])
 
+        if USE_CONTROL:
+            cmd.append("--control")
+
         return cmd
 
     async def start_recorder(self, recorder_id: int, config: RecorderConfig, studio_id: str = None) -> bool:
@@ -186,9 +269,12 @@ class RecorderManager:
             logger.info(f"Starting recorder {recorder_id}: {' '.join(cmd)}")
 
             try:
+                # stdout carries JSON levels and/or control replies
+                read_stdout = USE_CONTROL or not USE_LEVEL_SHM
                 process = await asyncio.create_subprocess_exec(
                     *cmd,
-                    stdout=asyncio.subprocess.PIPE,
+                    stdin=asyncio.subprocess.PIPE if USE_CONTROL else asyncio.subprocess.DEVNULL,
+                    stdout=asyncio.subprocess.PIPE if read_stdout else asyncio.subprocess.DEVNULL,
                     stderr=asyncio.subprocess.PIPE
                 )
 
@@ -196,7 +282,8 @@ class RecorderManager:
                     recorder_id=recorder_id,
                     process=process,
                     config=config,
-                    start_time=datetime.now()
+                    start_time=datetime.now(),
+                    vox="--vox" in cmd
                 )
 
                 # Start monitor task (stderr)
@@ -204,10 +291,15 @@ class RecorderManager:
                     self._monitor_process(recorder_id)
                 )
 
-                # Start stdout reader for level data
-                rec_proc.stdout_task = asyncio.create_task(
-                    self._read_levels(recorder_id)
-                )
+                # Level data: mapped feed (read on demand) or stdout reader
+                if USE_LEVEL_SHM:
+                    rec_proc.feed = LevelFeed(feed_name("rec", recorder_id))
+                if read_stdout:
+                    rec_proc.stdout_task = asyncio.create_task(
+                        self._read_levels(recorder_id)
+                    )
+                if USE_METRICS_SHM:
+                    rec_proc.metrics = MetricsFeed(metrics_name("rec", recorder_id))
 
                 self._processes[recorder_id] = rec_proc
                 logger.info(f"Recorder {recorder_id} started with PID {process.pid}")
@@ -249,6 +341,10 @@ class RecorderManager:
                     proc.process.kill()
                     await proc.process.wait()
 
+                if proc.feed:
+                    proc.feed.close()
+                if proc.metrics:
+                    proc.metrics.close()
                 del self._processes[recorder_id]
                 logger.info(f"Recorder {recorder_id} stopped")
                 return True
@@ -311,7 +407,7 @@ class RecorderManager:
             logger.error(f"Monitor error for recorder {recorder_id}: {e}")
 
     async def _read_levels(self, recorder_id: int):
-        """Read and parse level JSON from stdout."""
+        """Read and parse level JSON and control replies from stdout."""
         if recorder_id not in self._processes:
             return
 
@@ -328,7 +424,12 @@ class RecorderManager:
                     )
                     if line:
                         line_str = line.decode().strip()
-                        if line_str.startswith('{') and '"type":"levels"' in line_str:
+                        if line_str.startswith('{"type":"control"'):
+                            try:
+                                proc.control_replies.put_nowait(json.loads(line_str))
+                            except json.JSONDecodeError:
+                                pass
+                        elif line_str.startswith('{') and '"type":"levels"' in line_str:
                             try:
                                 data = json.loads(line_str)
                                 self._update_levels(recorder_id, data)
@@ -344,6 +445,75 @@ class RecorderManager:
         except Exception as e:
             logger.error(f"Level reader error for recorder {recorder_id}: {e}")
 
+    async def reconfigure(self, recorder_id: int, changes: dict) -> bool:
+        """
+        Send control keys (e.g. {"bitrate": 96000}) to a running recorder.
+        True once audyn has applied all of them; False if it rejected them
+        or has no control channel (nothing is changed then).
+        """
+        if not changes:
+            return True
+        proc = self._processes.get(recorder_id)
+        if not USE_CONTROL or not proc or not proc.process or \
+                proc.process.returncode is not None or not proc.process.stdin:
+            return False
+
+        args = " ".join(f"{key}={getattr(value, 'value', value)}" for key, value in changes.items())
+        async with proc.control_lock:
+            # Replies only follow commands; anything queued is stale
+            while not proc.control_replies.empty():
+                proc.control_replies.get_nowait()
+            try:
+                proc.process.stdin.write(f"set {args}\n".encode())
+                await proc.process.stdin.drain()
+                reply = await asyncio.wait_for(proc.control_replies.get(), timeout=CONTROL_TIMEOUT)
+            except (asyncio.TimeoutError, ConnectionError) as e:
+                logger.warning(f"Recorder {recorder_id}: no control reply for '{args}': {e!r}")
+                return False
+
+        if not reply.get("ok"):
+            logger.warning(f"Recorder {recorder_id} rejected '{args}': {reply.get('error')}")
+            return False
+        logger.info(f"Recorder {recorder_id} reconfigured: {args}")
+        return True
+
+    async def apply_config(self, recorder_id: int, config: RecorderConfig) -> bool:
+        """
+        Apply a changed config to a running recorder without restarting it.
+        False if any changed field needs a restart or audyn refused it.
+        """
+        proc = self._processes.get(recorder_id)
+        if not proc or not proc.config:
+            return False
+
+        old = proc.config.model_dump()
+        new = config.model_dump()
+        changed = {k for k in new if new[k] != old.get(k)}
+        if not changed <= CONTROL_KEYS.keys():
+            return False
+
+        # Settings the running process does not use take effect at the next start
+        changes = {}
+        for name in changed:
+            if name == "bitrate" and proc.config.format.value != "opus":
+                continue
+            if name.startswith("vox_") and not proc.vox:
+                continue
+            changes[CONTROL_KEYS[name]] = new[name]
+
+        if not await self.reconfigure(recorder_id, changes):
+            return False
+        proc.config = config
+        return True
+
+    async def reconfigure_all(self, changes: dict) -> list[int]:
+        """Send control keys to every running recorder; returns the ids that failed."""
+        failed = []
+        for recorder_id in list(self._processes.keys()):
+            if self.is_running(recorder_id) and not await self.reconfigure(recorder_id, changes):
+                failed.append(recorder_id)
+        return failed
+
     def _update_levels(self, recorder_id: int, data: dict):
         """Update stored levels for a recorder from JSON data."""
         if recorder_id not in self._processes:
@@ -379,15 +549,37 @@ class RecorderManager:
         """Get current audio levels for a recorder (from recording or monitor)."""
         # Prefer recording process levels if running
         if recorder_id in self._processes:
-            levels = self._processes[recorder_id].levels
+            proc = self._processes[recorder_id]
+            levels = levels_from_feed(proc.feed) if proc.feed else proc.levels
             if levels:
                 return levels
         # Fall back to monitor levels
         if recorder_id in self._monitors:
-            return self._monitors[recorder_id].levels
+            mon = self._monitors[recorder_id]
+            return levels_from_feed(mon.feed) if mon.feed else mon.levels
         return []
 
-    def _build_monitor_command(self, config: RecorderConfig) -> list[str]:
+    def live_tap(self, recorder_id: int) -> Optional[str]:
+        """PCM tap name of the recorder's running process (recording
+        preferred over monitoring), or None."""
+        if not USE_TAP_SHM:
+            return None
+        if self.is_running(recorder_id):
+            return tap_name("rec", recorder_id)
+        if self.is_monitoring(recorder_id):
+            return tap_name("mon", recorder_id)
+        return None
+
+    def metrics_text(self) -> str:
+        """Prometheus text for every running recorder's metrics endpoint."""
+        feeds = [
+            ({"recorder": str(rid)}, proc.metrics)
+            for rid, proc in sorted(self._processes.items())
+            if proc.metrics
+        ]
+        return render_prometheus(feeds)
+
+    def _build_monitor_command(self, recorder_id: int, config: RecorderConfig) -> list[str]:
         """Build command line for level monitoring (no recording)."""
         cmd = [AUDYN_BIN]
 
@@ -415,7 +607,13 @@ class RecorderManager:
         cmd.extend(["-c", str(config.channels or 2)])
 
         # Enable level metering
-        cmd.append("--levels")
+        if USE_LEVEL_SHM:
+            cmd.extend(["--levels-shm", feed_name("mon", recorder_id)])
+        else:
+            cmd.append("--levels")
+
+        if USE_TAP_SHM:
+            cmd.extend(["--tap-shm", tap_name("mon", recorder_id)])
 
         return cmd
 
@@ -435,13 +633,13 @@ class RecorderManager:
                 if mon.process and mon.process.returncode is None:
                     return True  # Already running
 
-            cmd = self._build_monitor_command(config)
+            cmd = self._build_monitor_command(recorder_id, config)
             logger.info(f"Starting monitor {recorder_id}: {' '.join(cmd)}")
 
             try:
                 process = await asyncio.create_subprocess_exec(
                     *cmd,
-                    stdout=asyncio.subprocess.PIPE,
+                    stdout=asyncio.subprocess.DEVNULL if USE_LEVEL_SHM else asyncio.subprocess.PIPE,
                     stderr=asyncio.subprocess.DEVNULL
                 )
 
@@ -451,10 +649,13 @@ class RecorderManager:
                     config=config
                 )
 
-                # Start stdout reader for level data
-                mon_proc.stdout_task = asyncio.create_task(
-                    self._read_monitor_levels(recorder_id)
-                )
+                # Level data: mapped feed (read on demand) or stdout reader
+                if USE_LEVEL_SHM:
+                    mon_proc.feed = LevelFeed(feed_name("mon", recorder_id))
+                else:
+                    mon_proc.stdout_task = asyncio.create_task(
+                        self._read_monitor_levels(recorder_id)
+                    )
 
                 self._monitors[recorder_id] = mon_proc
                 logger.info(f"Monitor {recorder_id} started with PID {process.pid}")
@@ -489,6 +690,8 @@ class RecorderManager:
                     mon.process.kill()
                     await mon.process.wait()
 
+                if mon.feed:
+                    mon.feed.close()
                 del self._monitors[recorder_id]
                 return True
 
@@ -0,0 +1,266 @@
+"""
+Seek Index Reader
+
+Reads the "<file>.seek" sidecar that audyn writes next to WAV and Ogg Opus
+archives with --seek-index (see sink/seek_index.h) and uses it to serve a
+file from any time with one lookup and a byte-range read: no ffmpeg, no
+bisecting the Ogg stream.
+
+  - WAV:  a fresh 44-byte header, then the data from the wanted frame
+  - Opus: the original header pages, then the pages from the seek point
+          at or before the wanted time (less decoder pre-roll), with
+          granules, sequence numbers and CRCs rewritten and the OpusHead
+          pre-skip set so playback starts exactly at the wanted time
+
+Copyright: (c) 2026 B. Wynne
+License: GPLv2 or later
+"""
+
+import bisect
+import os
+import struct
+import zlib
+import logging
+from pathlib import Path
+from typing import AsyncGenerator, Optional
+
+logger = logging.getLogger(__name__)
+
+SEEK_SUFFIX = ".seek"
+
+# Layout version 1 (sink/seek_index.h)
+MAGIC = 0x4B535941
+VERSION = 1
+HEADER = struct.Struct("<IHHB3xIHHIQQQI12x")
+ENTRY = struct.Struct("<QQ")
+KIND_WAV = 1
+KIND_OPUS = 2
+
+# Opus decoders converge within 80 ms; start that far before the target
+OPUS_PREROLL = 3840
+# opus_sink encodes fixed 20 ms frames (48 kHz units)
+OPUS_FRAME = 960
+# OpusHead pre-skip is 16 bits
+OPUS_MAX_PRESKIP = 0xFFFF
+
+READ_CHUNK = 64 * 1024
+
+# Ogg page header: "OggS", version, type, granule, serial, sequence, crc, segments
+OGG_HEADER = struct.Struct("<4sBBqIIIB")
+OGG_CONTINUED = 0x01
+
+# Ogg CRC-32 (poly 0x04C11DB7, MSB first, no reflection) via zlib's
+# reflected CRC-32 on bit-reversed bytes
+_REVERSE = bytes(int(f"{i:08b}"[::-1], 2) for i in range(256))
+
+
+def _ogg_crc(page: bytes) -> int:
+    reg = zlib.crc32(page.translate(_REVERSE), 0xFFFFFFFF) ^ 0xFFFFFFFF
+    return int(f"{reg:032b}"[::-1], 2)
+
+
+class SeekIndex:
+    """Parsed sidecar: header fields plus (sample, offset) entries."""
+
+    def __init__(self, data: bytes):
+        (magic, version, header_bytes, self.kind, self.sample_rate, self.channels,
+         self.block_align, self.interval, self.audio_offset, self.start_clock_ns,
+         self.start_ptp_ns, self.preskip) = HEADER.unpack_from(data, 0)
+        if magic != MAGIC or version != VERSION or header_bytes < HEADER.size:
+            raise ValueError("not an audyn seek index")
+        if self.kind not in (KIND_WAV, KIND_OPUS) or self.sample_rate == 0:
+            raise ValueError("unsupported seek index")
+        if self.kind == KIND_WAV and (self.channels == 0 or self.block_align == 0):
+            raise ValueError("bad WAV seek index")
+
+        # Still recording: only whole entries count
+        n = (len(data) - header_bytes) // ENTRY.size
+        entries = [ENTRY.unpack_from(data, header_bytes + i * ENTRY.size) for i in range(n)]
+        self.samples = [e[0] for e in entries]
+        self.offsets = [e[1] for e in entries]
+
+    def find(self, sample: int) -> Optional[int]:
+        """Index of the last entry at or before sample, or None."""
+        i = bisect.bisect_right(self.samples, sample) - 1
+        return i if i >= 0 else None
+
+
+def load_seek_index(audio_path: Path) -> Optional[SeekIndex]:
+    """Sidecar of audio_path, or None if there is none or it is unusable."""
+    path = Path(str(audio_path) + SEEK_SUFFIX)
+    try:
+        data = path.read_bytes()
+    except OSError:
+        return None
+    if len(data) < HEADER.size:
+        return None
+    try:
+        return SeekIndex(data)
+    except ValueError as e:
+        logger.warning(f"Ignoring seek index {path}: {e}")
+        return None
+
+
+def _wav_header(idx: SeekIndex, data_bytes: int) -> bytes:
+    """Classic 44-byte header; 4-byte samples are float (audyn writes no int32)."""
+    bytes_per_sample = idx.block_align // idx.channels
+    tag = 3 if bytes_per_sample == 4 else 1
+    data_bytes = min(data_bytes, 0xFFFFFFFF - 36)
+    return struct.pack(
+        "<4sI4s4sIHHIIHH4sI",
+        b"RIFF", 36 + data_bytes, b"WAVE",
+        b"fmt ", 16, tag, idx.channels, idx.sample_rate,
+        idx.sample_rate * idx.block_align, idx.block_align, bytes_per_sample * 8,
+        b"data", data_bytes,
+    )
+
+
+async def _wav_from(path: Path, idx: SeekIndex, start: float) -> AsyncGenerator[bytes, None]:
+    offset = idx.audio_offset + int(start * idx.sample_rate) * idx.block_align
+    size = os.path.getsize(path)
+    remaining = max(0, size - offset) // idx.block_align * idx.block_align
+
+    yield _wav_header(idx, remaining)
+    with open(path, "rb") as f:
+        f.seek(offset)
+        while remaining > 0:
+            chunk = f.read(min(READ_CHUNK, remaining))
+            if not chunk:
+                break
+            remaining -= len(chunk)
+            yield chunk
+
+
+def _ogg_pages(f, limit: Optional[int] = None):
+    """Complete Ogg pages from f's position (up to limit bytes)."""
+    buf = b""
+    read = 0
+    while True:
+        want = READ_CHUNK if limit is None else min(READ_CHUNK, limit - read)
+        chunk = f.read(want) if want > 0 else b""
+        read += len(chunk)
+        buf += chunk
+
+        pos = 0
+        while pos + OGG_HEADER.size <= len(buf):
+            if buf[pos:pos + 4] != b"OggS":
+                return
+            nseg = buf[pos + 26]
+            head = OGG_HEADER.size + nseg
+            if pos + head > len(buf):
+                break
+            end = pos + head + sum(buf[pos + OGG_HEADER.size:pos + head])
+            if end > len(buf):
+                break
+            yield buf[pos:end]
+            pos = end
+        buf = buf[pos:]
+
+        if not chunk:
+            return
+
+
+def _rewrite_page(page: bytes, granule: Optional[int], seq: int,
+                  drop_head: bool = False) -> bytes:
+    """Page with a new granule (None = keep) and sequence number; with
+    drop_head, the continued packet tail at its start is removed."""
+    (capture, ver, htype, gpos, serial, _seq, _crc, nseg) = OGG_HEADER.unpack_from(page, 0)
+    lacing = page[OGG_HEADER.size:OGG_HEADER.size + nseg]
+    body = page[OGG_HEADER.size + nseg:]
+
+    if drop_head:
+        # The tail ends at the first lacing value below 255
+        n = 0
+        while n < len(lacing) and lacing[n] == 255:
+            n += 1
+        n = min(n + 1, len(lacing))
+        body = body[sum(lacing[:n]):]
+        lacing = lacing[n:]
+        htype &= ~OGG_CONTINUED
+
+    if granule is not None and gpos != -1:
+        gpos = granule
+    hdr = OGG_HEADER.pack(capture, ver, htype, gpos, serial, seq, 0, len(lacing))
+    out = bytearray(hdr + lacing + body)
+    struct.pack_into("<I", out, 22, _ogg_crc(bytes(out)))
+    return bytes(out)
+
+
+def _opus_start(f, idx: SeekIndex, i: int, goal: int) -> Optional[tuple[int, int, bool]]:
+    """
+    Walk pages from entry i to the last one decoding from at or before
+    goal. Returns (offset, first sample, opens with a continued packet).
+    """
+    sample, offset = idx.samples[i], idx.offsets[i]
+    f.seek(offset)
+    chosen = None
+    for page in _ogg_pages(f):
+        continued = bool(page[5] & OGG_CONTINUED)
+        # A page opening with the tail of a packet decodes from the next one
+        begin = sample + (OPUS_FRAME if continued else 0)
+        if chosen is not None and begin > goal:
+            break
+        granule = OGG_HEADER.unpack_from(page, 0)[3]
+        if granule != -1:
+            chosen = (offset, begin, continued)
+            sample = granule
+        offset += len(page)
+    return chosen
+
+
+async def _opus_from(path: Path, idx: SeekIndex, start: float) -> Optional[AsyncGenerator[bytes, None]]:
+    target = int(start * 48000)
+    goal = max(0, target - OPUS_PREROLL)
+    i = idx.find(goal)
+    if i is None:
+        return None
+
+    with open(path, "rb") as f:
+        chosen = _opus_start(f, idx, i, goal)
+    if chosen is None:
+        return None
+
+    offset, base, continued = chosen
+    preskip = target - base
+    if preskip < 0 or preskip > OPUS_MAX_PRESKIP:
+        return None
+
+    async def gen():
+        with open(path, "rb") as f:
+            seq = 0
+            for page in _ogg_pages(f, idx.audio_offset):
+                if page[OGG_HEADER.size + page[26]:][:8] == b"OpusHead":
+                    nseg = page[26]
+                    body = bytearray(page[OGG_HEADER.size + nseg:])
+                    struct.pack_into("<H", body, 10, preskip)
+                    page = page[:OGG_HEADER.size + nseg] + bytes(body)
+                yield _rewrite_page(page, None, seq)
+                seq += 1
+
+            f.seek(offset)
+            drop = continued
+            for page in _ogg_pages(f):
+                granule = OGG_HEADER.unpack_from(page, 0)[3]
+                yield _rewrite_page(page, granule - base, seq, drop_head=drop)
+                drop = False
+                seq += 1
+
+    return gen()
+
+
+async def stream_from(path: Path, start: float) -> Optional[tuple[AsyncGenerator[bytes, None], str]]:
+    """
+    (generator, media type) serving path from start seconds, or None when
+    there is no usable index (the caller falls back to transcoding).
+    """
+    idx = load_seek_index(path)
+    if idx is None or start < 0:
+        return None
+
+    if idx.kind == KIND_WAV:
+        return _wav_from(path, idx, start), "audio/wav"
+
+    gen = await _opus_from(path, idx, start)
+    if gen is None:
+        return None
+    return gen, "audio/ogg"